@@ -1,8 +1,18 @@
 @echo off
 
+set CommonCompilerFlags=-DHANDMADE_INTERNAL=1 -DHANDMADE_SLOW=1 -FC -Zi
+set CommonLinkerFlags=-incremental:no user32.lib Gdi32.lib winmm.lib
+
 mkdir Handmade\build
 pushd Handmade\build
 
 pwd
-cl -FC -Zi ..\code\win32_handmade.cpp user32.lib Gdi32.lib
+REM NOTE: The game is its own DLL so the running executable can reload it. The PDB gets a random name because the
+REM   debugger keeps the old one locked, and the lock file keeps the executable from loading a half-written DLL.
+del *.pdb > NUL 2> NUL
+echo WAITING FOR PDB > lock.tmp
+cl %CommonCompilerFlags% ..\code\handmade.cpp -Fmhandmade.map -LD /link -incremental:no -PDB:handmade_%random%.pdb -EXPORT:GameUpdateAndRender
+del lock.tmp
+cl %CommonCompilerFlags% ..\code\win32_handmade.cpp -Fmwin32_handmade.map /link %CommonLinkerFlags%
+cl %CommonCompilerFlags% ..\code\handmade_packer.cpp /link -incremental:no
 popd
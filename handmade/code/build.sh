@@ -0,0 +1,20 @@
+#!/bin/bash
+
+#NOTE: Builds the headless Linux harness and the benchmarks. Windows builds still go through build.bat.
+
+CodeDir="$(cd "$(dirname "$0")" && pwd)"
+CommonCompilerFlags="-O2 -g -Wall -Wno-unused-function -Wno-unused-variable -DHANDMADE_INTERNAL=1 -DHANDMADE_SLOW=1"
+
+mkdir -p "$CodeDir/../build"
+pushd "$CodeDir/../build" > /dev/null
+
+#NOTE: The lock file tells a running harness not to reload the game module until it has been completely written.
+echo "WAITING FOR SO" > lock.tmp
+g++ $CommonCompilerFlags -fPIC -shared "$CodeDir/handmade.cpp" -o handmade.so -lm -lpthread
+rm -f lock.tmp
+
+g++ $CommonCompilerFlags "$CodeDir/linux_handmade.cpp" -o linux_handmade -lm -lpthread -ldl
+g++ $CommonCompilerFlags "$CodeDir/handmade_bench.cpp" -o handmade_bench -lm -lpthread -ldl
+g++ $CommonCompilerFlags "$CodeDir/handmade_packer.cpp" -o handmade_packer
+
+popd > /dev/null
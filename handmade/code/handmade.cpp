@@ -0,0 +1,389 @@
+#include "handmade.h"
+#include "handmade_render.cpp"
+#include "handmade_render_group.cpp"
+#include "handmade_sound.cpp"
+#include "handmade_audio.cpp"
+#include "handmade_asset.cpp"
+#include "handmade_world.cpp"
+#include "handmade_entity.cpp"
+#include "handmade_collision.cpp"
+
+// =====================================================================================================================
+
+internal void GameOutputSound(game_state *GameState, memory_arena *TempArena,
+        game_sound_output_buffer *SoundBuffer)
+{
+    TIMED_FUNCTION();
+
+    Assert(SoundBuffer->SampleCount <= MAX_SOUND_SAMPLES_PER_UPDATE);
+
+    temporary_memory MixerMemory = BeginTemporaryMemory(TempArena);
+
+    int SampleCount = SoundBuffer->SampleCount;
+    real32 *ToneSamples = PushArray(TempArena, SampleCount, real32, 16);
+    real32 *MixLeft = PushArray(TempArena, SampleCount, real32, 16);
+    real32 *MixRight = PushArray(TempArena, SampleCount, real32, 16);
+    ClearMixBuffers(MixLeft, MixRight, SampleCount);
+
+    SetOscillatorFrequency(&GameState->Tone, (real32)GameState->ToneHz, SoundBuffer->SamplesPerSecond);
+    GenerateSine(&GameState->Tone, ToneSamples, SampleCount);
+    AddMonoToMix(ToneSamples, MixLeft, MixRight, SampleCount);
+
+    MixPlayingSounds(&GameState->AudioState, MixLeft, MixRight, SampleCount, MixVoiceChunkSSE2);
+    OutputStereoMix(MixLeft, MixRight, SoundBuffer);
+
+    EndTemporaryMemory(MixerMemory);
+}
+
+// =====================================================================================================================
+
+internal void MakeBlipSound(game_state *GameState, int SamplesPerSecond)
+{
+    //NOTE: Fallback for when there is no packed "blip" sound: a short decaying 880Hz tone.
+    loaded_sound *Blip = &GameState->Blip;
+    Blip->SampleCount = SamplesPerSecond / 10;
+    Blip->ChannelCount = 1;
+    Blip->Samples[0] = PushArray(&GameState->WorldArena, Blip->SampleCount, int16);
+    for (uint32 SampleIndex = 0; SampleIndex < Blip->SampleCount; ++SampleIndex)
+    {
+        real32 t = (real32)SampleIndex / (real32)SamplesPerSecond;
+        real32 Envelope = 1.0f - ((real32)SampleIndex / (real32)Blip->SampleCount);
+        Blip->Samples[0][SampleIndex] = (int16)(8000.0f * Envelope * sinf(2.0f * Pi32 * 880.0f * t));
+    }
+}
+
+// =====================================================================================================================
+
+internal void MakeTestWorld(game_state *GameState)
+{
+    //NOTE: A block of one-chunk rooms around the origin, with a door in the middle of every wall.
+    world *World = &GameState->World;
+    InitializeWorld(World, &GameState->WorldArena, 1024);
+    for (int32 TileY = -4 * TILE_CHUNK_DIM; TileY < 4 * TILE_CHUNK_DIM; ++TileY)
+    {
+        for (int32 TileX = -4 * TILE_CHUNK_DIM; TileX < 4 * TILE_CHUNK_DIM; ++TileX)
+        {
+            int32 RoomX = TileX & TILE_CHUNK_MASK;
+            int32 RoomY = TileY & TILE_CHUNK_MASK;
+            bool32 IsWall = ((RoomX == 0) && (RoomY != TILE_CHUNK_DIM / 2)) ||
+                ((RoomY == 0) && (RoomX != TILE_CHUNK_DIM / 2));
+            SetTileValue(World, TileX, TileY, IsWall ? TileValue_Wall : TileValue_Floor);
+        }
+    }
+
+    GameState->CameraP.OffsetX = 0.5f * TILE_CHUNK_SIDE_IN_METERS;
+    GameState->CameraP.OffsetY = 0.5f * TILE_CHUNK_SIDE_IN_METERS;
+}
+
+// =====================================================================================================================
+
+internal void PushWorldTiles(render_group *RenderGroup, int32 Layer, world *World, world_position CameraP)
+{
+    //NOTE: The camera is in the middle of the screen and world Y is up. Only the walls are drawn; the floor lets the
+    //  gradient show through.
+    real32 PixelsPerMeter = PIXELS_PER_METER;
+    real32 CenterX = 0.5f * (real32)RenderGroup->Width;
+    real32 CenterY = 0.5f * (real32)RenderGroup->Height;
+    int32 HalfTilesX = (int32)(CenterX / (PixelsPerMeter * TILE_SIDE_IN_METERS)) + 1;
+    int32 HalfTilesY = (int32)(CenterY / (PixelsPerMeter * TILE_SIDE_IN_METERS)) + 1;
+
+    tile_position CameraTile = GetTilePosition(CameraP);
+    color4 WallColor = {0.25f, 0.25f, 0.3f, 1.0f};
+    for (int32 RelY = -HalfTilesY; RelY <= HalfTilesY; ++RelY)
+    {
+        for (int32 RelX = -HalfTilesX; RelX <= HalfTilesX; ++RelX)
+        {
+            if (GetTileValue(World, CameraTile.TileX + RelX, CameraTile.TileY + RelY) == TileValue_Wall)
+            {
+                real32 MinX = CenterX + PixelsPerMeter * ((real32)RelX * TILE_SIDE_IN_METERS - CameraTile.TileOffsetX);
+                real32 MaxY = CenterY - PixelsPerMeter * ((real32)RelY * TILE_SIDE_IN_METERS - CameraTile.TileOffsetY);
+                real32 Side = PixelsPerMeter * TILE_SIDE_IN_METERS;
+                PushRectangle(RenderGroup, Layer, MinX, MaxY - Side, MinX + Side, MaxY, WallColor, true);
+            }
+        }
+    }
+}
+
+// =====================================================================================================================
+
+internal void SpawnTestEntities(game_state *GameState, uint32 Count)
+{
+    //NOTE: Motes scattered over the test world, drifting in random directions at up to two meters a second.
+    uint32 RandomState = 0x2545F491;
+    for (uint32 EntityIndex = 0; EntityIndex < Count; ++EntityIndex)
+    {
+        real32 Random[4];
+        for (int RandomIndex = 0; RandomIndex < (int)ArrayCount(Random); ++RandomIndex)
+        {
+            RandomState ^= RandomState << 13;
+            RandomState ^= RandomState >> 17;
+            RandomState ^= RandomState << 5;
+            Random[RandomIndex] = (real32)(RandomState >> 8) * (1.0f / 16777216.0f);
+        }
+
+        world_position Origin = {};
+        real32 WorldSide = 8.0f * TILE_CHUNK_SIDE_IN_METERS;
+        world_position P = MapIntoChunkSpace(Origin, WorldSide * (Random[0] - 0.5f),
+                WorldSide * (Random[1] - 0.5f));
+        AddEntity(&GameState->Entities, P, 4.0f * (Random[2] - 0.5f), 4.0f * (Random[3] - 0.5f),
+                EntityFlag_Visible);
+    }
+}
+
+// =====================================================================================================================
+
+internal void PushHighEntities(render_group *RenderGroup, int32 Layer, entity_store *Store, world_position CameraP)
+{
+    real32 PixelsPerMeter = PIXELS_PER_METER;
+    real32 HalfSide = MOTE_HALF_SIDE * PixelsPerMeter;
+    world_difference Camera = SubtractPositions(CameraP, Store->HighOrigin);
+    real32 CenterX = 0.5f * (real32)RenderGroup->Width - PixelsPerMeter * Camera.dX;
+    real32 CenterY = 0.5f * (real32)RenderGroup->Height + PixelsPerMeter * Camera.dY;
+
+    color4 MoteColor = {1.0f, 0.9f, 0.5f, 0.75f};
+    for (uint32 HighIndex = 0; HighIndex < Store->HighCount; ++HighIndex)
+    {
+        if (Store->LowFlags[Store->HighLowIndex[HighIndex]] & EntityFlag_Visible)
+        {
+            real32 X = CenterX + PixelsPerMeter * Store->HighPX[HighIndex];
+            real32 Y = CenterY - PixelsPerMeter * Store->HighPY[HighIndex];
+            PushRectangle(RenderGroup, Layer, X - HalfSide, Y - HalfSide, X + HalfSide, Y + HalfSide, MoteColor,
+                    true);
+        }
+    }
+}
+
+// =====================================================================================================================
+
+internal void CollideHighEntities(game_state *GameState, memory_arena *TempArena)
+{
+    //NOTE: Motes that run into each other swap velocities, and the player shoves any mote it touches straight away
+    //  from itself.
+    entity_store *Store = &GameState->Entities;
+    collision_grid *Grid = &GameState->EntityGrid;
+    BuildCollisionGrid(Grid, Store->HighPX, Store->HighPY, Store->HighCount);
+
+    temporary_memory CollisionMemory = BeginTemporaryMemory(TempArena);
+    uint32 MaxPairCount = 4 * Store->HighCount + 16;
+    collision_pair *Pairs = PushArray(TempArena, MaxPairCount, collision_pair);
+
+    uint32 PairCount = FindCollidingEntities(Grid, Pairs, MaxPairCount);
+    for (uint32 PairIndex = 0; PairIndex < PairCount; ++PairIndex)
+    {
+        uint32 A = Pairs[PairIndex].A;
+        uint32 B = Pairs[PairIndex].B;
+        real32 dX = Store->HighPX[B] - Store->HighPX[A];
+        real32 dY = Store->HighPY[B] - Store->HighPY[A];
+        real32 Closing = (Store->HighVX[B] - Store->HighVX[A]) * dX + (Store->HighVY[B] - Store->HighVY[A]) * dY;
+        if (Closing < 0.0f)
+        {
+            real32 VX = Store->HighVX[A];
+            real32 VY = Store->HighVY[A];
+            Store->HighVX[A] = Store->HighVX[B];
+            Store->HighVY[A] = Store->HighVY[B];
+            Store->HighVX[B] = VX;
+            Store->HighVY[B] = VY;
+        }
+    }
+
+    world_difference Player = SubtractPositions(GameState->CameraP, Store->HighOrigin);
+    real32 MinX = Player.dX - PLAYER_HALF_SIDE;
+    real32 MinY = Player.dY - PLAYER_HALF_SIDE;
+    real32 MaxX = Player.dX + PLAYER_HALF_SIDE;
+    real32 MaxY = Player.dY + PLAYER_HALF_SIDE;
+    PairCount = QueryCollisionBoxes(Grid, 1, &MinX, &MinY, &MaxX, &MaxY, Pairs, MaxPairCount);
+    for (uint32 PairIndex = 0; PairIndex < PairCount; ++PairIndex)
+    {
+        uint32 HighIndex = Pairs[PairIndex].B;
+        real32 dX = Store->HighPX[HighIndex] - Player.dX;
+        real32 dY = Store->HighPY[HighIndex] - Player.dY;
+        real32 Length = sqrtf(dX * dX + dY * dY);
+        if (Length > 0.0f)
+        {
+            Store->HighVX[HighIndex] = 3.0f * dX / Length;
+            Store->HighVY[HighIndex] = 3.0f * dY / Length;
+        }
+    }
+
+    EndTemporaryMemory(CollisionMemory);
+}
+
+// =====================================================================================================================
+
+extern "C" GAME_UPDATE_AND_RENDER(GameUpdateAndRender)
+{
+    Platform = Memory->PlatformAPI;
+    GlobalDebugTable = Memory->DebugTable;
+
+    //NOTE: Has to come after the debug table is picked up, or a freshly loaded module would drop this block's begin.
+    TIMED_FUNCTION();
+
+    Assert(sizeof(game_state) <= Memory->PermanentStorageSize);
+    Assert(sizeof(transient_state) <= Memory->TransientStorageSize);
+
+    game_state *GameState = (game_state *)Memory->PermanentStorage;
+    if (!Memory->IsInitialized)
+    {
+        InitializeArena(&GameState->WorldArena, (char *)"World", Memory->PermanentStorageSize - sizeof(game_state),
+                (uint8 *)Memory->PermanentStorage + sizeof(game_state));
+        RegisterArena(&Memory->ArenaRegistry, &GameState->WorldArena);
+
+        GameState->ToneHz = 256;
+        GameState->Tone.Volume = 5000.0f;
+
+        InitializeAudioState(&GameState->AudioState);
+
+        OpenAssetFile(&GameState->Assets, &Memory->PlatformAPI, (char *)"handmade.hma");
+        if (!GetSound(&GameState->Assets, FindAsset(&GameState->Assets, (char *)"blip", HMAAsset_Sound),
+                &GameState->Blip))
+        {
+            MakeBlipSound(GameState, SoundBuffer->SamplesPerSecond);
+        }
+        GameState->HeroBitmap = FindAsset(&GameState->Assets, (char *)"hero", HMAAsset_Bitmap);
+
+        MakeTestWorld(GameState);
+        InitializeEntityStore(&GameState->Entities, &GameState->WorldArena, 4096, 2);
+        SpawnTestEntities(GameState, 2000);
+
+        //NOTE: Covers everywhere a high entity can be before it is demoted, relative to the camera's chunk.
+        real32 GridMin = -(real32)(GameState->Entities.HighChunkRadius + 1) * TILE_CHUNK_SIDE_IN_METERS;
+        int32 GridCellCount = (2 * GameState->Entities.HighChunkRadius + 3) * TILE_CHUNK_DIM / 2;
+        InitializeCollisionGrid(&GameState->EntityGrid, &GameState->WorldArena, GameState->Entities.MaxEntityCount,
+                GridMin, GridMin, 2.0f * TILE_SIDE_IN_METERS, GridCellCount, GridCellCount, MOTE_HALF_SIDE);
+
+        //TODO: This may be more appropriate to do in the platform layer
+        Memory->IsInitialized = true;
+    }
+
+    //NOTE: The frame's work falls into the blocks handmade_bench's frame sequences budget: Simulation, Render, and
+    //  GameOutputSound for the audio fill. Simulation comes in two pieces, either side of the transient setup.
+    {
+        TIMED_BLOCK("Simulation");
+        for (int ControllerIndex = 0; ControllerIndex < (int)ArrayCount(Input->Controllers); ++ControllerIndex)
+        {
+            game_controller_input *Controller = GetController(Input, ControllerIndex);
+            if (!Controller->IsConnected)
+            {
+                continue;
+            }
+
+            if (Controller->ActionDown.EndedDown && Controller->ActionDown.HalfTransitionCount)
+            {
+                real32 Pan = Controller->IsAnalog ? Controller->StickAverageX : 0.0f;
+                PlaySound(&GameState->AudioState, &GameState->Blip, 1.0f, Pan, 1.0f, false);
+            }
+
+            if (Controller->IsAnalog)
+            {
+                //NOTE: Use analog movement tuning
+                GameState->BlueOffset += (int)(8.0f * Controller->StickAverageX);
+                GameState->GreenOffset += (int)(8.0f * Controller->StickAverageY);
+                GameState->ToneHz = 512 + (int)(256.0f * Controller->StickAverageY);
+                real32 Step = PLAYER_ANALOG_SPEED * Input->dtForFrame;
+                GameState->CameraP = MoveAgainstWalls(&GameState->World, GameState->CameraP, PLAYER_HALF_SIDE,
+                        PLAYER_HALF_SIDE, Step * Controller->StickAverageX, Step * Controller->StickAverageY);
+            }
+            else
+            {
+                //NOTE: Use digital movement tuning
+                real32 Step = PLAYER_DIGITAL_SPEED * Input->dtForFrame;
+                real32 CameraDX = 0.0f;
+                real32 CameraDY = 0.0f;
+                if (Controller->MoveLeft.EndedDown)
+                {
+                    GameState->BlueOffset -= 1;
+                    CameraDX -= Step;
+                }
+                if (Controller->MoveRight.EndedDown)
+                {
+                    GameState->BlueOffset += 1;
+                    CameraDX += Step;
+                }
+                if (Controller->MoveUp.EndedDown)
+                {
+                    GameState->GreenOffset += 1;
+                    CameraDY += Step;
+                }
+                if (Controller->MoveDown.EndedDown)
+                {
+                    GameState->GreenOffset -= 1;
+                    CameraDY -= Step;
+                }
+                GameState->CameraP = MoveAgainstWalls(&GameState->World, GameState->CameraP, PLAYER_HALF_SIDE,
+                        PLAYER_HALF_SIDE, CameraDX, CameraDY);
+            }
+        }
+    }
+
+    transient_state *TranState = (transient_state *)Memory->TransientStorage;
+    if (!TranState->IsInitialized)
+    {
+        InitializeArena(&TranState->TranArena, (char *)"Transient",
+                Memory->TransientStorageSize - sizeof(transient_state),
+                (uint8 *)Memory->TransientStorage + sizeof(transient_state));
+        RegisterArena(&Memory->ArenaRegistry, &TranState->TranArena);
+
+        //NOTE: No bigger than it takes to hold the whole file, since looped input snapshots all of it.
+        memory_index AssetCacheSize = GetAssetCacheSizeForAll(&GameState->Assets);
+        if (AssetCacheSize > Megabytes(64))
+        {
+            AssetCacheSize = Megabytes(64);
+        }
+        InitializeGameAssets(&TranState->Assets, &GameState->Assets, Memory->LowPriorityQueue,
+                &TranState->TranArena, AssetCacheSize);
+
+        TranState->IsInitialized = true;
+    }
+    BeginAssetFrame(&TranState->Assets);
+
+    temporary_memory FrameMemory = BeginTemporaryMemory(&TranState->TranArena);
+
+    {
+        TIMED_BLOCK("Simulation");
+        UpdateEntities(&GameState->Entities, GameState->CameraP, Input->dtForFrame, IntegrateHighEntitiesSSE2);
+        CollideHighEntities(GameState, &TranState->TranArena);
+    }
+
+    //TODO: Allow sample offsets here for more robust platform options
+    GameOutputSound(GameState, &TranState->TranArena, SoundBuffer);
+
+    {
+        TIMED_BLOCK("Render");
+        render_group *RenderGroup = AllocateRenderGroup(&TranState->TranArena, Megabytes(4), Buffer->Width,
+                Buffer->Height);
+        PushWeirdGradient(RenderGroup, 0, GameState->BlueOffset, GameState->GreenOffset);
+        PushWorldTiles(RenderGroup, 0, &GameState->World, GameState->CameraP);
+        PushHighEntities(RenderGroup, 1, &GameState->Entities, GameState->CameraP);
+
+        real32 PlayerHalfSide = PIXELS_PER_METER * PLAYER_HALF_SIDE;
+        color4 PlayerColor = {0.2f, 0.6f, 1.0f, 1.0f};
+        PushRectangle(RenderGroup, 1, 0.5f * (real32)Buffer->Width - PlayerHalfSide,
+                0.5f * (real32)Buffer->Height - PlayerHalfSide, 0.5f * (real32)Buffer->Width + PlayerHalfSide,
+                0.5f * (real32)Buffer->Height + PlayerHalfSide, PlayerColor, true);
+
+        if (GameState->HeroBitmap)
+        {
+            //NOTE: Drifts with the gradient at a quarter of its speed, so it moves in sub-pixel steps. Until the cache
+            //  has streamed the bitmap in, a translucent box stands in for it.
+            real32 HeroX = 0.5f * (real32)Buffer->Width + 0.25f * (real32)(GameState->BlueOffset % 512);
+            real32 HeroY = 0.5f * (real32)Buffer->Height - 0.25f * (real32)(GameState->GreenOffset % 512);
+            loaded_bitmap *Hero = RequestBitmap(&TranState->Assets, GameState->HeroBitmap);
+            if (Hero)
+            {
+                PushBitmap(RenderGroup, 1, Hero, HeroX - 0.5f * (real32)Hero->Width,
+                        HeroY - 0.5f * (real32)Hero->Height, BlendMode_AlphaBlendSRGB);
+            }
+            else
+            {
+                color4 Placeholder = {1.0f, 0.0f, 1.0f, 0.5f};
+                PushRectangle(RenderGroup, 1, HeroX - 16.0f, HeroY - 16.0f, HeroX + 16.0f, HeroY + 16.0f, Placeholder,
+                        true);
+            }
+        }
+
+        RenderGroupToOutput(RenderGroup, Buffer, Memory->HighPriorityQueue, &TranState->TranArena);
+    }
+
+    EndTemporaryMemory(FrameMemory);
+    CheckArena(&TranState->TranArena);
+}
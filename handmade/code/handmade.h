@@ -0,0 +1,65 @@
+#if !defined(HANDMADE_H)
+#define HANDMADE_H
+
+#include "handmade_platform.h"
+
+#include "handmade_intrinsics.h"
+#include "handmade_render.h"
+#include "handmade_render_group.h"
+#include "handmade_sound.h"
+#include "handmade_audio.h"
+#include "handmade_asset.h"
+#include "handmade_world.h"
+#include "handmade_entity.h"
+#include "handmade_collision.h"
+
+//NOTE: How many backbuffer pixels a meter of world takes up.
+#define PIXELS_PER_METER 32.0f
+
+//NOTE: Half the side of the boxes the player and the motes collide as, in meters.
+#define PLAYER_HALF_SIDE 0.375f
+#define MOTE_HALF_SIDE 0.25f
+
+//NOTE: How fast the player moves, in meters a second: a held direction key, and a stick pushed all the way over.
+#define PLAYER_DIGITAL_SPEED 3.75f
+#define PLAYER_ANALOG_SPEED 15.0f
+
+//NOTE: game_state sits at the start of permanent storage, which the platform owns, so it outlives any one load of the
+//  game module. Nothing in it may point into the module itself: no function pointers, no string literals.
+struct game_state
+{
+    int ToneHz;
+    int BlueOffset;
+    int GreenOffset;
+    oscillator Tone;
+
+    audio_state AudioState;
+    loaded_sound Blip;
+
+    //NOTE: Mapped for the life of the process. Since it is never remapped, the views handed out of it stay valid
+    //  across module reloads and looped-back input.
+    asset_file Assets;
+    asset_id HeroBitmap;
+
+    //NOTE: The camera stays centered on the player, so this is the player's position too.
+    world World;
+    world_position CameraP;
+    entity_store Entities;
+    collision_grid EntityGrid;
+
+    memory_arena WorldArena;
+};
+
+struct transient_state
+{
+    bool32 IsInitialized;
+
+    //NOTE: Everything in here is scratch that only has to live for one frame, except the asset cache, which can
+    //  always be refilled from the asset file.
+    memory_arena TranArena;
+    game_assets Assets;
+};
+
+global_variable platform_api Platform;
+
+#endif
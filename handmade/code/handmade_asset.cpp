@@ -0,0 +1,522 @@
+internal bool32 IsAssetRangeValid(uint64 FileSize, uint64 Offset, uint64 Size)
+{
+    bool32 Result = ((Offset <= FileSize) && (Size <= (FileSize - Offset)));
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 ValidateAsset(hma_asset *Asset, uint64 FileSize)
+{
+    //NOTE: Everything the getters later rely on is checked here, once, so they can trust the table blindly.
+    bool32 Result = IsAssetRangeValid(FileSize, Asset->DataOffset, Asset->DataSize) &&
+            ((Asset->DataOffset % HMA_DATA_ALIGNMENT) == 0) &&
+            (Asset->Name[HMA_NAME_COUNT - 1] == 0) &&
+            (Asset->NameHash == HashAssetName(Asset->Name));
+
+    if (Result)
+    {
+        if (Asset->Type == HMAAsset_Bitmap)
+        {
+            uint64 ExpectedSize = (uint64)Asset->Bitmap.Width * (uint64)Asset->Bitmap.Height * 4;
+            Result = ((Asset->Bitmap.Width > 0) && (Asset->Bitmap.Width <= 0x7FFF) &&
+                    (Asset->Bitmap.Height > 0) && (Asset->Bitmap.Height <= 0x7FFF) &&
+                    (Asset->DataSize == ExpectedSize));
+        }
+        else if (Asset->Type == HMAAsset_Sound)
+        {
+            uint64 ExpectedSize = (uint64)Asset->Sound.SampleCount * (uint64)Asset->Sound.ChannelCount * sizeof(int16);
+            Result = ((Asset->Sound.ChannelCount >= 1) && (Asset->Sound.ChannelCount <= 2) &&
+                    (Asset->DataSize == ExpectedSize));
+        }
+        else
+        {
+            Result = false;
+        }
+    }
+
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 OpenAssetFile(asset_file *File, platform_api *PlatformAPI, char *FileName)
+{
+    //NOTE: On failure the file is left closed and every lookup comes back empty.
+    *File = {};
+    File->Mapping = PlatformAPI->MapFile(FileName);
+
+    bool32 Valid = false;
+    if (File->Mapping.Memory && (File->Mapping.Size >= sizeof(hma_header)))
+    {
+        uint64 FileSize = File->Mapping.Size;
+        hma_header *Header = (hma_header *)File->Mapping.Memory;
+        Valid = ((Header->MagicValue == HMA_MAGIC_VALUE) &&
+                (Header->Version == HMA_VERSION) &&
+                (Header->FileSize == FileSize) &&
+                ((Header->Assets % 8) == 0) &&
+                IsAssetRangeValid(FileSize, Header->Assets, (uint64)Header->AssetCount * sizeof(hma_asset)));
+
+        if (Valid)
+        {
+            hma_asset *Assets = (hma_asset *)((uint8 *)File->Mapping.Memory + Header->Assets);
+            for (uint32 AssetIndex = 0; Valid && (AssetIndex < Header->AssetCount); ++AssetIndex)
+            {
+                Valid = ValidateAsset(Assets + AssetIndex, FileSize);
+            }
+
+            if (Valid)
+            {
+                File->Header = Header;
+                File->Assets = Assets;
+                File->AssetCount = Header->AssetCount;
+            }
+        }
+    }
+
+    if (!Valid)
+    {
+        if (File->Mapping.Memory)
+        {
+            PlatformAPI->UnmapFile(&File->Mapping);
+        }
+        *File = {};
+    }
+
+    return(Valid);
+}
+
+// =====================================================================================================================
+
+internal void CloseAssetFile(asset_file *File, platform_api *PlatformAPI)
+{
+    if (File->Mapping.Memory)
+    {
+        PlatformAPI->UnmapFile(&File->Mapping);
+    }
+    *File = {};
+}
+
+// =====================================================================================================================
+
+internal asset_id FindAsset(asset_file *File, char *Name, hma_asset_type Type)
+{
+    //NOTE: Linear, but only the hash is compared until something matches. Meant for load time, not per frame; hold
+    //  on to the asset_id.
+    asset_id Result = 0;
+    uint32 NameHash = HashAssetName(Name);
+    for (uint32 AssetIndex = 0; AssetIndex < File->AssetCount; ++AssetIndex)
+    {
+        hma_asset *Asset = File->Assets + AssetIndex;
+        if ((Asset->NameHash == NameHash) && (Asset->Type == (uint32)Type) && (strcmp(Asset->Name, Name) == 0))
+        {
+            Result = AssetIndex + 1;
+            break;
+        }
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline hma_asset *GetAssetEntry(asset_file *File, asset_id ID, hma_asset_type Type)
+{
+    hma_asset *Result = 0;
+    if ((ID > 0) && (ID <= File->AssetCount) && (File->Assets[ID - 1].Type == (uint32)Type))
+    {
+        Result = File->Assets + (ID - 1);
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 GetBitmap(asset_file *File, asset_id ID, loaded_bitmap *Bitmap)
+{
+    hma_asset *Asset = GetAssetEntry(File, ID, HMAAsset_Bitmap);
+    if (Asset)
+    {
+        Bitmap->Width = (int32)Asset->Bitmap.Width;
+        Bitmap->Height = (int32)Asset->Bitmap.Height;
+        Bitmap->Pitch = Bitmap->Width * 4;
+        Bitmap->Memory = (uint8 *)File->Mapping.Memory + Asset->DataOffset;
+    }
+    else
+    {
+        *Bitmap = {};
+    }
+    return(Asset != 0);
+}
+
+// =====================================================================================================================
+
+internal bool32 GetSound(asset_file *File, asset_id ID, loaded_sound *Sound)
+{
+    hma_asset *Asset = GetAssetEntry(File, ID, HMAAsset_Sound);
+    *Sound = {};
+    if (Asset)
+    {
+        int16 *Samples = (int16 *)((uint8 *)File->Mapping.Memory + Asset->DataOffset);
+        Sound->SampleCount = Asset->Sound.SampleCount;
+        Sound->ChannelCount = Asset->Sound.ChannelCount;
+        for (uint32 ChannelIndex = 0; ChannelIndex < Sound->ChannelCount; ++ChannelIndex)
+        {
+            Sound->Samples[ChannelIndex] = Samples + ChannelIndex * Sound->SampleCount;
+        }
+    }
+    return(Asset != 0);
+}
+
+// =====================================================================================================================
+
+inline void *GetAssetBlockMemory(asset_memory_block *Block)
+{
+    //NOTE: The header gets a whole alignment unit to itself so the memory after it stays aligned.
+    void *Result = (uint8 *)Block + ASSET_MEMORY_ALIGNMENT;
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal asset_memory_block *InsertAssetMemoryBlock(asset_memory_block *Prev, void *Memory, memory_index Size)
+{
+    //NOTE: Size is the whole span, header included.
+    Assert(Size >= 2 * ASSET_MEMORY_ALIGNMENT);
+    asset_memory_block *Block = (asset_memory_block *)Memory;
+    Block->Size = Size - ASSET_MEMORY_ALIGNMENT;
+    Block->Used = false;
+    Block->Prev = Prev;
+    Block->Next = Prev->Next;
+    Block->Prev->Next = Block;
+    Block->Next->Prev = Block;
+    return(Block);
+}
+
+// =====================================================================================================================
+
+internal bool32 MergeAssetMemoryBlocks(game_assets *Assets, asset_memory_block *First, asset_memory_block *Second)
+{
+    //NOTE: Neighbours in the list are neighbours in memory, since the budget is one contiguous block.
+    bool32 Result = false;
+    if ((First != &Assets->BlockSentinel) && (Second != &Assets->BlockSentinel) && !First->Used && !Second->Used)
+    {
+        Assert(((uint8 *)GetAssetBlockMemory(First) + First->Size) == (uint8 *)Second);
+        First->Size += ASSET_MEMORY_ALIGNMENT + Second->Size;
+        First->Next = Second->Next;
+        First->Next->Prev = First;
+        Result = true;
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void ReleaseAssetMemory(game_assets *Assets, asset_memory_block *Block)
+{
+    Assert(Block->Used);
+    Block->Used = false;
+    Assets->MemoryUsed -= Block->Size;
+
+    if (MergeAssetMemoryBlocks(Assets, Block->Prev, Block))
+    {
+        Block = Block->Prev;
+    }
+    MergeAssetMemoryBlocks(Assets, Block, Block->Next);
+}
+
+// =====================================================================================================================
+
+inline void UnlinkAssetSlot(asset_slot *Slot)
+{
+    Slot->LRUPrev->LRUNext = Slot->LRUNext;
+    Slot->LRUNext->LRUPrev = Slot->LRUPrev;
+    Slot->LRUPrev = Slot->LRUNext = 0;
+}
+
+// =====================================================================================================================
+
+inline void LinkAssetSlotAtFront(game_assets *Assets, asset_slot *Slot)
+{
+    asset_slot *Sentinel = &Assets->LRUSentinel;
+    Slot->LRUPrev = Sentinel;
+    Slot->LRUNext = Sentinel->LRUNext;
+    Slot->LRUPrev->LRUNext = Slot;
+    Slot->LRUNext->LRUPrev = Slot;
+}
+
+// =====================================================================================================================
+
+internal void EvictAsset(game_assets *Assets, asset_slot *Slot)
+{
+    Assert(Slot->State == AssetState_Loaded);
+    UnlinkAssetSlot(Slot);
+    ReleaseAssetMemory(Assets, Slot->Block);
+    Slot->Block = 0;
+    Slot->State = AssetState_Unloaded;
+    ++Assets->Stats.Evictions;
+}
+
+// =====================================================================================================================
+
+internal asset_memory_block *AcquireAssetMemory(game_assets *Assets, memory_index Size)
+{
+    //NOTE: First fit. Whenever nothing fits, the least recently used asset goes and we look again, until either
+    //  something fits or the only assets left were requested this frame.
+    Size = (Size + ASSET_MEMORY_ALIGNMENT - 1) & ~(memory_index)(ASSET_MEMORY_ALIGNMENT - 1);
+    if (Size == 0)
+    {
+        Size = ASSET_MEMORY_ALIGNMENT;
+    }
+
+    asset_memory_block *Result = 0;
+    while (!Result)
+    {
+        for (asset_memory_block *Block = Assets->BlockSentinel.Next; Block != &Assets->BlockSentinel;
+                Block = Block->Next)
+        {
+            if (!Block->Used && (Block->Size >= Size))
+            {
+                Result = Block;
+                break;
+            }
+        }
+
+        if (Result)
+        {
+            memory_index Remaining = Result->Size - Size;
+            if (Remaining >= 2 * ASSET_MEMORY_ALIGNMENT)
+            {
+                Result->Size = Size;
+                InsertAssetMemoryBlock(Result, (uint8 *)GetAssetBlockMemory(Result) + Size, Remaining);
+            }
+            Result->Used = true;
+            Assets->MemoryUsed += Result->Size;
+        }
+        else
+        {
+            asset_slot *Victim = Assets->LRUSentinel.LRUPrev;
+            if ((Victim == &Assets->LRUSentinel) || (Victim->LastUsedFrame == Assets->FrameIndex))
+            {
+                break;
+            }
+            EvictAsset(Assets, Victim);
+        }
+    }
+
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal memory_index GetAssetCacheSizeForAll(asset_file *File)
+{
+    //NOTE: Enough for every asset in the file to be resident at once, block headers and rounding included.
+    memory_index Result = 0;
+    if (File->AssetCount)
+    {
+        Result = (memory_index)File->Mapping.Size + (File->AssetCount + 1) * 2 * ASSET_MEMORY_ALIGNMENT;
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void InitializeGameAssets(game_assets *Assets, asset_file *File, platform_work_queue *LoadQueue,
+        memory_arena *Arena, memory_index MemorySize)
+{
+    //NOTE: Has to be called on the frame thread, which is the only one that may request assets afterwards.
+    *Assets = {};
+    Assets->File = File;
+    Assets->LoadQueue = LoadQueue;
+    Assets->FrameThreadID = GetThreadID();
+
+    uint32 SlotCount = File->AssetCount ? File->AssetCount : 1;
+    Assets->Slots = PushArray(Arena, SlotCount, asset_slot);
+    ZeroSize(SlotCount * sizeof(asset_slot), Assets->Slots);
+    Assets->LRUSentinel.LRUPrev = Assets->LRUSentinel.LRUNext = &Assets->LRUSentinel;
+
+    Assets->BlockSentinel.Prev = Assets->BlockSentinel.Next = &Assets->BlockSentinel;
+    Assets->BlockSentinel.Used = true;
+    Assets->MemorySize = MemorySize & ~(memory_index)(ASSET_MEMORY_ALIGNMENT - 1);
+    if (Assets->MemorySize >= 2 * ASSET_MEMORY_ALIGNMENT)
+    {
+        void *Memory = PushSize(Arena, Assets->MemorySize, ASSET_MEMORY_ALIGNMENT);
+        InsertAssetMemoryBlock(&Assets->BlockSentinel, Memory, Assets->MemorySize);
+    }
+}
+
+// =====================================================================================================================
+
+internal PLATFORM_WORK_QUEUE_CALLBACK(LoadAssetWork)
+{
+    //NOTE: Runs on a low priority worker. Reading the source is what pulls the file in from disk.
+    asset_load_task *Task = (asset_load_task *)Data;
+    TIMED_FUNCTION((uint32)Task->Size);
+
+    uint64 StartCycles = __rdtsc();
+    memcpy(Task->Dest, Task->Source, (size_t)Task->Size);
+    Task->LoadCycles = __rdtsc() - StartCycles;
+    Task->ThreadID = GetThreadID();
+
+    CompletePreviousWritesBeforeFutureWrites;
+    Task->State = AssetLoadTask_Done;
+}
+
+// =====================================================================================================================
+
+internal void BeginAssetFrame(game_assets *Assets)
+{
+    //NOTE: Once per frame, before anything is requested. Whatever finished loading since last frame becomes resident
+    //  here, so an asset never changes from missing to present in the middle of a frame.
+    TIMED_FUNCTION();
+
+    ++Assets->FrameIndex;
+    for (uint32 TaskIndex = 0; TaskIndex < ASSET_LOAD_TASK_COUNT; ++TaskIndex)
+    {
+        asset_load_task *Task = Assets->Tasks + TaskIndex;
+        if (Task->State == AssetLoadTask_Done)
+        {
+            CompletePreviousReadsBeforeFutureReads;
+
+            asset_slot *Slot = Assets->Slots + (Task->ID - 1);
+            Assert(Slot->State == AssetState_Queued);
+            Slot->State = AssetState_Loaded;
+            LinkAssetSlotAtFront(Assets, Slot);
+
+            asset_cache_stats *Stats = &Assets->Stats;
+            ++Stats->LoadsCompleted;
+            Stats->LoadCycles += Task->LoadCycles;
+            Stats->BytesLoaded += Task->Size;
+            if (Task->ThreadID == Assets->FrameThreadID)
+            {
+                ++Stats->LoadsOnFrameThread;
+            }
+
+            Task->State = AssetLoadTask_Free;
+        }
+    }
+}
+
+// =====================================================================================================================
+
+internal void QueueAssetLoad(game_assets *Assets, asset_id ID)
+{
+    asset_slot *Slot = Assets->Slots + (ID - 1);
+    hma_asset *Entry = Assets->File->Assets + (ID - 1);
+    Assert(Slot->State == AssetState_Unloaded);
+
+    asset_load_task *Task = 0;
+    for (uint32 Attempt = 0; Attempt < ASSET_LOAD_TASK_COUNT; ++Attempt)
+    {
+        asset_load_task *Candidate = Assets->Tasks + ((Assets->NextTaskIndex + Attempt) % ASSET_LOAD_TASK_COUNT);
+        if (Candidate->State == AssetLoadTask_Free)
+        {
+            Task = Candidate;
+            Assets->NextTaskIndex = (uint32)((Candidate - Assets->Tasks) + 1) % ASSET_LOAD_TASK_COUNT;
+            break;
+        }
+    }
+
+    asset_memory_block *Block = Task ? AcquireAssetMemory(Assets, (memory_index)Entry->DataSize) : 0;
+    if (Block)
+    {
+        void *Memory = GetAssetBlockMemory(Block);
+        if (Entry->Type == HMAAsset_Bitmap)
+        {
+            Slot->Bitmap.Width = (int32)Entry->Bitmap.Width;
+            Slot->Bitmap.Height = (int32)Entry->Bitmap.Height;
+            Slot->Bitmap.Pitch = Slot->Bitmap.Width * 4;
+            Slot->Bitmap.Memory = Memory;
+        }
+        else
+        {
+            Slot->Sound = {};
+            Slot->Sound.SampleCount = Entry->Sound.SampleCount;
+            Slot->Sound.ChannelCount = Entry->Sound.ChannelCount;
+            for (uint32 ChannelIndex = 0; ChannelIndex < Slot->Sound.ChannelCount; ++ChannelIndex)
+            {
+                Slot->Sound.Samples[ChannelIndex] = (int16 *)Memory + ChannelIndex * Slot->Sound.SampleCount;
+            }
+        }
+        Slot->Block = Block;
+        Slot->State = AssetState_Queued;
+
+        Task->ID = ID;
+        Task->Source = (uint8 *)Assets->File->Mapping.Memory + Entry->DataOffset;
+        Task->Dest = Memory;
+        Task->Size = Entry->DataSize;
+        Task->State = AssetLoadTask_Queued;
+        Platform.AddEntry(Assets->LoadQueue, LoadAssetWork, Task);
+
+        ++Assets->Stats.LoadsQueued;
+    }
+    else
+    {
+        ++Assets->Stats.RequestsDeferred;
+    }
+}
+
+// =====================================================================================================================
+
+internal asset_slot *RequestAsset(game_assets *Assets, asset_id ID, hma_asset_type Type, bool32 CountRequest)
+{
+    asset_slot *Result = 0;
+    if (GetAssetEntry(Assets->File, ID, Type))
+    {
+        asset_slot *Slot = Assets->Slots + (ID - 1);
+        Slot->LastUsedFrame = Assets->FrameIndex;
+        if (Slot->State == AssetState_Loaded)
+        {
+            UnlinkAssetSlot(Slot);
+            LinkAssetSlotAtFront(Assets, Slot);
+            Result = Slot;
+        }
+        else if (Slot->State == AssetState_Unloaded)
+        {
+            QueueAssetLoad(Assets, ID);
+        }
+
+        if (CountRequest)
+        {
+            if (Result)
+            {
+                ++Assets->Stats.Hits;
+            }
+            else
+            {
+                ++Assets->Stats.Misses;
+            }
+        }
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal loaded_bitmap *RequestBitmap(game_assets *Assets, asset_id ID)
+{
+    //NOTE: 0 until the bitmap is resident; draw a placeholder in the meantime. Only good until the end of the frame.
+    asset_slot *Slot = RequestAsset(Assets, ID, HMAAsset_Bitmap, true);
+    loaded_bitmap *Result = Slot ? &Slot->Bitmap : 0;
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal loaded_sound *RequestSound(game_assets *Assets, asset_id ID)
+{
+    asset_slot *Slot = RequestAsset(Assets, ID, HMAAsset_Sound, true);
+    loaded_sound *Result = Slot ? &Slot->Sound : 0;
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void PrefetchAsset(game_assets *Assets, asset_id ID)
+{
+    //NOTE: Starts the load of something that will be wanted soon. Doesn't count as a hit or a miss.
+    if ((ID > 0) && (ID <= Assets->File->AssetCount))
+    {
+        RequestAsset(Assets, ID, (hma_asset_type)Assets->File->Assets[ID - 1].Type, false);
+    }
+}
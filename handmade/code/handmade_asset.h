@@ -0,0 +1,131 @@
+#if !defined(HANDMADE_ASSET_H)
+#define HANDMADE_ASSET_H
+
+//NOTE: Runtime side of the packed asset file (see handmade_file_formats.h).
+//  The whole file is mapped read-only and checked once when it is opened. After that, getting at an asset is just
+//  pointer arithmetic: loaded_bitmap and loaded_sound come back pointing straight into the mapping, so nothing is
+//  decoded or copied, and the pages are only read from disk the first time they are touched.
+
+#include "handmade_file_formats.h"
+
+//NOTE: Index into the file's asset table plus one, so that 0 can mean "not found".
+typedef uint32 asset_id;
+
+struct asset_file
+{
+    platform_file_mapping Mapping;
+
+    hma_header *Header;
+    hma_asset *Assets;
+    uint32 AssetCount;
+};
+
+//NOTE: Streaming cache.
+//  For when the assets don't all fit in memory at once. The game asks for an asset every frame it wants it; if the
+//  asset is resident it comes straight back, otherwise a load is queued on the low priority queue and the game gets 0
+//  and draws a placeholder this frame. The load copies the asset out of the mapping into a block of the cache's
+//  fixed budget, which is where the page faults (the actual disk reads) happen, on the worker.
+//
+//  Only the frame thread touches the slots, the LRU list and the allocator. A worker only ever writes the task it was
+//  given and the block the task points at, then marks the task done; the frame thread picks finished tasks up at the
+//  start of its next frame. So requesting never takes a lock and never waits on a load.
+//
+//  When the budget runs out, the least recently used resident assets are evicted, but never one that was requested
+//  in the current frame. Anything that holds on to an asset across frames has to keep requesting it.
+
+#define ASSET_MEMORY_ALIGNMENT 64
+#define ASSET_LOAD_TASK_COUNT 64
+
+enum asset_state
+{
+    AssetState_Unloaded,
+    AssetState_Queued,
+    AssetState_Loaded,
+};
+
+struct asset_memory_block
+{
+    //NOTE: In front of every block in the budget, used or free, kept in address order so a freed block can merge
+    //  with its neighbours. Size doesn't include the header.
+    asset_memory_block *Prev;
+    asset_memory_block *Next;
+    memory_index Size;
+    bool32 Used;
+};
+
+struct asset_slot
+{
+    uint32 State;
+    uint32 LastUsedFrame;
+    asset_memory_block *Block;
+
+    //NOTE: Only linked in while the asset is loaded. Most recently used is at the front.
+    asset_slot *LRUPrev;
+    asset_slot *LRUNext;
+
+    union
+    {
+        loaded_bitmap Bitmap;
+        loaded_sound Sound;
+    };
+};
+
+enum asset_load_task_state
+{
+    AssetLoadTask_Free,
+    AssetLoadTask_Queued,
+    AssetLoadTask_Done,
+};
+
+struct asset_load_task
+{
+    //NOTE: Belongs to the worker while it is queued, to the frame thread otherwise.
+    uint32 volatile State;
+    asset_id ID;
+
+    void *Source;
+    void *Dest;
+    uint64 Size;
+
+    uint64 ThreadID;
+    uint64 LoadCycles;
+};
+
+struct asset_cache_stats
+{
+    uint64 Hits;
+    uint64 Misses;
+    uint64 Evictions;
+
+    uint64 LoadsQueued;
+    uint64 LoadsCompleted;
+    uint64 LoadsOnFrameThread;
+    uint64 LoadCycles;
+    uint64 BytesLoaded;
+
+    //NOTE: Misses that couldn't even queue a load this frame, because every task was busy or nothing could be
+    //  evicted to make room. They are retried the next time the asset is requested.
+    uint64 RequestsDeferred;
+};
+
+struct game_assets
+{
+    asset_file *File;
+    platform_work_queue *LoadQueue;
+    uint64 FrameThreadID;
+    uint32 FrameIndex;
+
+    asset_slot *Slots;
+    asset_slot LRUSentinel;
+
+    asset_memory_block BlockSentinel;
+    memory_index MemorySize;
+    memory_index MemoryUsed;
+
+    uint32 NextTaskIndex;
+    asset_load_task Tasks[ASSET_LOAD_TASK_COUNT];
+
+    asset_cache_stats Stats;
+};
+
+#endif
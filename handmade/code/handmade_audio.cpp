@@ -0,0 +1,352 @@
+#define MIX_VOICE_CHUNK(name) void name(playing_sound *Voice, real32 *MixLeft, real32 *MixRight, int ChunkCount, \
+        real32 LeftGain, real32 RightGain)
+typedef MIX_VOICE_CHUNK(mix_voice_chunk);
+
+// =====================================================================================================================
+
+internal void InitializeAudioState(audio_state *AudioState)
+{
+    AudioState->FirstPlayingSound = 0;
+    AudioState->FirstFreePlayingSound = 0;
+    for (int VoiceIndex = MAX_PLAYING_SOUNDS - 1; VoiceIndex >= 0; --VoiceIndex)
+    {
+        playing_sound *Voice = AudioState->Pool + VoiceIndex;
+        Voice->Next = AudioState->FirstFreePlayingSound;
+        AudioState->FirstFreePlayingSound = Voice;
+    }
+    AudioState->PlayingSoundCount = 0;
+    AudioState->DroppedPlayCount = 0;
+    AudioState->PoolInitialized = true;
+}
+
+// =====================================================================================================================
+
+internal playing_sound *PlaySound(audio_state *AudioState, loaded_sound *Sound, real32 Volume, real32 Pan,
+        real32 dSample, bool32 Looping)
+{
+    Assert(AudioState->PoolInitialized);
+    Assert(dSample > 0.0f);
+
+    playing_sound *Result = AudioState->FirstFreePlayingSound;
+    if (Result)
+    {
+        AudioState->FirstFreePlayingSound = Result->Next;
+
+        Result->Sound = Sound;
+        Result->Volume = Volume;
+        Result->Pan = Pan;
+        Result->dSample = dSample;
+        Result->Looping = Looping;
+        Result->SamplesPlayed = 0.0;
+
+        Result->Next = AudioState->FirstPlayingSound;
+        AudioState->FirstPlayingSound = Result;
+        ++AudioState->PlayingSoundCount;
+    }
+    else
+    {
+        //NOTE: The pool is full. Dropping the new sound is cheaper and less noticeable than cutting one off.
+        ++AudioState->DroppedPlayCount;
+    }
+
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void StopSound(audio_state *AudioState, playing_sound *Voice)
+{
+    for (playing_sound **VoicePtr = &AudioState->FirstPlayingSound; *VoicePtr; VoicePtr = &(*VoicePtr)->Next)
+    {
+        if (*VoicePtr == Voice)
+        {
+            *VoicePtr = Voice->Next;
+            Voice->Next = AudioState->FirstFreePlayingSound;
+            AudioState->FirstFreePlayingSound = Voice;
+            --AudioState->PlayingSoundCount;
+            break;
+        }
+    }
+}
+
+// =====================================================================================================================
+
+inline int32 ClampSourceIndex(int32 Index, int32 LastIndex)
+{
+    int32 Result = (Index > LastIndex) ? LastIndex : Index;
+    return(Result);
+}
+
+// =====================================================================================================================
+//NOTE: Scalar voice mixing, the reference for the SSE2 path.
+
+internal MIX_VOICE_CHUNK(MixVoiceChunkScalar)
+{
+    loaded_sound *Sound = Voice->Sound;
+    int16 *SourceLeft = Sound->Samples[0];
+    int16 *SourceRight = (Sound->ChannelCount > 1) ? Sound->Samples[1] : Sound->Samples[0];
+    int32 LastIndex = (int32)Sound->SampleCount - 1;
+
+    for (int SampleIndex = 0; SampleIndex < ChunkCount; ++SampleIndex)
+    {
+        real64 Position = Voice->SamplesPlayed + (real64)SampleIndex * (real64)Voice->dSample;
+        int32 Index0 = ClampSourceIndex((int32)Position, LastIndex);
+        int32 Index1 = ClampSourceIndex(Index0 + 1, LastIndex);
+        real32 Fraction = (real32)(Position - (real64)(int32)Position);
+
+        real32 Left = (real32)SourceLeft[Index0] + ((real32)SourceLeft[Index1] - (real32)SourceLeft[Index0]) * Fraction;
+        real32 Right = (real32)SourceRight[Index0] +
+            ((real32)SourceRight[Index1] - (real32)SourceRight[Index0]) * Fraction;
+
+        MixLeft[SampleIndex] += Left * LeftGain;
+        MixRight[SampleIndex] += Right * RightGain;
+    }
+}
+
+// =====================================================================================================================
+//NOTE: SSE2 voice mixing, 4 output samples per iteration.
+
+inline __m128i LoadSamplePairs4x(int16 *Source, int32 *Index)
+{
+    //NOTE: SSE2 has no gather. Each lane needs Source[Index] and Source[Index + 1], which sit next to each other, so
+    //  one 32-bit load per lane gets both: the low half is the first sample, the high half the second.
+    int32 Pair[4];
+    for (int Lane = 0; Lane < 4; ++Lane)
+    {
+        memcpy(&Pair[Lane], Source + Index[Lane], sizeof(int32));
+    }
+    __m128i Result = _mm_setr_epi32(Pair[0], Pair[1], Pair[2], Pair[3]);
+    return(Result);
+}
+
+inline __m128 InterpolateSamplePairs4x(__m128i Pairs, __m128 Fraction)
+{
+    __m128 A = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(Pairs, 16), 16));
+    __m128 B = _mm_cvtepi32_ps(_mm_srai_epi32(Pairs, 16));
+    __m128 Result = _mm_add_ps(A, _mm_mul_ps(_mm_sub_ps(B, A), Fraction));
+    return(Result);
+}
+
+inline __m128 LoadContiguousSamples4x(int16 *Source)
+{
+    __m128i Packed = _mm_loadl_epi64((__m128i *)Source);
+    __m128i Widened = _mm_srai_epi32(_mm_unpacklo_epi16(Packed, Packed), 16);
+    __m128 Result = _mm_cvtepi32_ps(Widened);
+    return(Result);
+}
+
+internal MIX_VOICE_CHUNK(MixVoiceChunkSSE2)
+{
+    loaded_sound *Sound = Voice->Sound;
+    int16 *SourceLeft = Sound->Samples[0];
+    int16 *SourceRight = (Sound->ChannelCount > 1) ? Sound->Samples[1] : Sound->Samples[0];
+    bool32 IsStereo = (Sound->ChannelCount > 1);
+    int32 LastIndex = (int32)Sound->SampleCount - 1;
+
+    __m128 LeftGain4x = _mm_set1_ps(LeftGain);
+    __m128 RightGain4x = _mm_set1_ps(RightGain);
+
+    int SampleIndex = 0;
+    if ((Voice->dSample == 1.0f) && (Voice->SamplesPlayed == (real64)(int32)Voice->SamplesPlayed))
+    {
+        //NOTE: Unpitched and sample-aligned, which is the common case: straight loads, no interpolation.
+        int16 *Left = SourceLeft + (int32)Voice->SamplesPlayed;
+        int16 *Right = SourceRight + (int32)Voice->SamplesPlayed;
+        for (; (SampleIndex + 4) <= ChunkCount; SampleIndex += 4)
+        {
+            __m128 L = LoadContiguousSamples4x(Left + SampleIndex);
+            __m128 R = IsStereo ? LoadContiguousSamples4x(Right + SampleIndex) : L;
+            _mm_storeu_ps(MixLeft + SampleIndex,
+                    _mm_add_ps(_mm_loadu_ps(MixLeft + SampleIndex), _mm_mul_ps(L, LeftGain4x)));
+            _mm_storeu_ps(MixRight + SampleIndex,
+                    _mm_add_ps(_mm_loadu_ps(MixRight + SampleIndex), _mm_mul_ps(R, RightGain4x)));
+        }
+    }
+    else
+    {
+        //NOTE: The paired loads read one sample past the position, so the vector loop stops while that is still
+        //  inside the sound and the scalar tail (which clamps) finishes the chunk.
+        real32 dSample = Voice->dSample;
+        int VectorCount = 0;
+        real64 LastSafePosition = (real64)(LastIndex - 1);
+        if (Voice->SamplesPlayed <= LastSafePosition)
+        {
+            real64 SafeCount = floor((LastSafePosition - Voice->SamplesPlayed) / (real64)dSample) + 1.0;
+            VectorCount = (SafeCount < (real64)ChunkCount) ? (int)SafeCount : ChunkCount;
+        }
+
+        __m128 LaneOffsets = _mm_mul_ps(_mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f), _mm_set1_ps(dSample));
+        for (; (SampleIndex + 4) <= VectorCount; SampleIndex += 4)
+        {
+            //NOTE: The position is kept in double and only the offset within these four samples goes through
+            //  float, so long sounds don't lose pitch accuracy.
+            real64 Position = Voice->SamplesPlayed + (real64)SampleIndex * (real64)dSample;
+            int32 BaseIndex = (int32)Position;
+            __m128 Offsets = _mm_add_ps(_mm_set1_ps((real32)(Position - (real64)BaseIndex)), LaneOffsets);
+            __m128i Whole = _mm_cvttps_epi32(Offsets);
+            __m128 Fraction = _mm_sub_ps(Offsets, _mm_cvtepi32_ps(Whole));
+
+            alignas(16) int32 Index[4];
+            _mm_store_si128((__m128i *)Index, _mm_add_epi32(Whole, _mm_set1_epi32(BaseIndex)));
+
+            __m128 L = InterpolateSamplePairs4x(LoadSamplePairs4x(SourceLeft, Index), Fraction);
+            __m128 R = IsStereo ? InterpolateSamplePairs4x(LoadSamplePairs4x(SourceRight, Index), Fraction) : L;
+
+            _mm_storeu_ps(MixLeft + SampleIndex,
+                    _mm_add_ps(_mm_loadu_ps(MixLeft + SampleIndex), _mm_mul_ps(L, LeftGain4x)));
+            _mm_storeu_ps(MixRight + SampleIndex,
+                    _mm_add_ps(_mm_loadu_ps(MixRight + SampleIndex), _mm_mul_ps(R, RightGain4x)));
+        }
+    }
+
+    if (SampleIndex < ChunkCount)
+    {
+        playing_sound Tail = *Voice;
+        Tail.SamplesPlayed = Voice->SamplesPlayed + (real64)SampleIndex * (real64)Voice->dSample;
+        MixVoiceChunkScalar(&Tail, MixLeft + SampleIndex, MixRight + SampleIndex, ChunkCount - SampleIndex,
+                LeftGain, RightGain);
+    }
+}
+
+// =====================================================================================================================
+
+internal bool32 MixPlayingSound(playing_sound *Voice, real32 *MixLeft, real32 *MixRight, int SampleCount,
+        mix_voice_chunk *MixVoiceChunk)
+{
+    //NOTE: Returns true once a non-looping sound has run out.
+    loaded_sound *Sound = Voice->Sound;
+    real32 LeftGain = Voice->Volume * ((Voice->Pan > 0.0f) ? (1.0f - Voice->Pan) : 1.0f);
+    real32 RightGain = Voice->Volume * ((Voice->Pan < 0.0f) ? (1.0f + Voice->Pan) : 1.0f);
+
+    bool32 Finished = (Sound->SampleCount == 0);
+    int SamplesMixed = 0;
+    while (!Finished && (SamplesMixed < SampleCount))
+    {
+        if (Voice->SamplesPlayed >= (real64)Sound->SampleCount)
+        {
+            if (Voice->Looping)
+            {
+                Voice->SamplesPlayed = fmod(Voice->SamplesPlayed, (real64)Sound->SampleCount);
+            }
+            else
+            {
+                Finished = true;
+                break;
+            }
+        }
+
+        //NOTE: A chunk runs up to the end of the source, so the kernels never have to think about looping.
+        real64 SourceRemaining = (real64)Sound->SampleCount - Voice->SamplesPlayed;
+        int ChunkCount = SampleCount - SamplesMixed;
+        real64 ChunkToEnd = ceil(SourceRemaining / (real64)Voice->dSample);
+        if (ChunkToEnd < (real64)ChunkCount)
+        {
+            ChunkCount = (int)ChunkToEnd;
+        }
+
+        MixVoiceChunk(Voice, MixLeft + SamplesMixed, MixRight + SamplesMixed, ChunkCount, LeftGain, RightGain);
+        Voice->SamplesPlayed += (real64)ChunkCount * (real64)Voice->dSample;
+        SamplesMixed += ChunkCount;
+    }
+
+    return(Finished);
+}
+
+// =====================================================================================================================
+
+internal void ClearMixBuffers(real32 *MixLeft, real32 *MixRight, int SampleCount)
+{
+    __m128 Zero = _mm_setzero_ps();
+    int SampleIndex = 0;
+    for (; (SampleIndex + 4) <= SampleCount; SampleIndex += 4)
+    {
+        _mm_storeu_ps(MixLeft + SampleIndex, Zero);
+        _mm_storeu_ps(MixRight + SampleIndex, Zero);
+    }
+    for (; SampleIndex < SampleCount; ++SampleIndex)
+    {
+        MixLeft[SampleIndex] = 0.0f;
+        MixRight[SampleIndex] = 0.0f;
+    }
+}
+
+// =====================================================================================================================
+
+internal void AddMonoToMix(real32 *Source, real32 *MixLeft, real32 *MixRight, int SampleCount)
+{
+    int SampleIndex = 0;
+    for (; (SampleIndex + 4) <= SampleCount; SampleIndex += 4)
+    {
+        __m128 Value = _mm_loadu_ps(Source + SampleIndex);
+        _mm_storeu_ps(MixLeft + SampleIndex, _mm_add_ps(_mm_loadu_ps(MixLeft + SampleIndex), Value));
+        _mm_storeu_ps(MixRight + SampleIndex, _mm_add_ps(_mm_loadu_ps(MixRight + SampleIndex), Value));
+    }
+    for (; SampleIndex < SampleCount; ++SampleIndex)
+    {
+        MixLeft[SampleIndex] += Source[SampleIndex];
+        MixRight[SampleIndex] += Source[SampleIndex];
+    }
+}
+
+// =====================================================================================================================
+
+internal void MixPlayingSounds(audio_state *AudioState, real32 *MixLeft, real32 *MixRight, int SampleCount,
+        mix_voice_chunk *MixVoiceChunk)
+{
+    TIMED_FUNCTION();
+
+    for (playing_sound **VoicePtr = &AudioState->FirstPlayingSound; *VoicePtr;)
+    {
+        playing_sound *Voice = *VoicePtr;
+        if (MixPlayingSound(Voice, MixLeft, MixRight, SampleCount, MixVoiceChunk))
+        {
+            *VoicePtr = Voice->Next;
+            Voice->Next = AudioState->FirstFreePlayingSound;
+            AudioState->FirstFreePlayingSound = Voice;
+            --AudioState->PlayingSoundCount;
+        }
+        else
+        {
+            VoicePtr = &Voice->Next;
+        }
+    }
+}
+
+// =====================================================================================================================
+
+internal void OutputStereoMix(real32 *MixLeft, real32 *MixRight, game_sound_output_buffer *SoundBuffer)
+{
+    TIMED_FUNCTION((uint32)SoundBuffer->SampleCount);
+
+    //NOTE: The clamp happens in float, because a loud enough mix would overflow the int32 conversion. After that
+    //  _mm_packs_epi32 narrows to int16 and the unpacks do the interleaving.
+    int16 *Dest = SoundBuffer->Samples;
+    __m128 Min = _mm_set1_ps(-32768.0f);
+    __m128 Max = _mm_set1_ps(32767.0f);
+
+    int SampleIndex = 0;
+    for (; (SampleIndex + 8) <= SoundBuffer->SampleCount; SampleIndex += 8)
+    {
+        __m128 L0 = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(MixLeft + SampleIndex), Min), Max);
+        __m128 L1 = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(MixLeft + SampleIndex + 4), Min), Max);
+        __m128 R0 = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(MixRight + SampleIndex), Min), Max);
+        __m128 R1 = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(MixRight + SampleIndex + 4), Min), Max);
+
+        __m128i L = _mm_packs_epi32(_mm_cvtps_epi32(L0), _mm_cvtps_epi32(L1));
+        __m128i R = _mm_packs_epi32(_mm_cvtps_epi32(R0), _mm_cvtps_epi32(R1));
+
+        _mm_storeu_si128((__m128i *)(Dest + 2 * SampleIndex), _mm_unpacklo_epi16(L, R));
+        _mm_storeu_si128((__m128i *)(Dest + 2 * SampleIndex + 8), _mm_unpackhi_epi16(L, R));
+    }
+
+    int16 *SampleOut = Dest + 2 * SampleIndex;
+    for (; SampleIndex < SoundBuffer->SampleCount; ++SampleIndex)
+    {
+        real32 Left = MixLeft[SampleIndex];
+        real32 Right = MixRight[SampleIndex];
+        Left = (Left > 32767.0f) ? 32767.0f : ((Left < -32768.0f) ? -32768.0f : Left);
+        Right = (Right > 32767.0f) ? 32767.0f : ((Right < -32768.0f) ? -32768.0f : Right);
+        *SampleOut++ = (int16)lrintf(Left);
+        *SampleOut++ = (int16)lrintf(Right);
+    }
+}
@@ -0,0 +1,45 @@
+#if !defined(HANDMADE_AUDIO_H)
+#define HANDMADE_AUDIO_H
+
+//NOTE: Software mixer.
+//  Voices come out of a fixed pool that lives inside audio_state, so starting a sound never allocates. Every voice is
+//  accumulated into a pair of float mix buffers, and the mix is clamped and interleaved into the int16 output in a
+//  single pass at the end.
+
+#define MAX_PLAYING_SOUNDS 1024
+
+struct loaded_sound
+{
+    //NOTE: Channels are stored separately, not interleaved. A mono sound only has Samples[0].
+    uint32 SampleCount;
+    uint32 ChannelCount;
+    int16 *Samples[2];
+};
+
+struct playing_sound
+{
+    loaded_sound *Sound;
+
+    real32 Volume;
+    real32 Pan;      //NOTE: -1 is all the way left, 1 is all the way right.
+    real32 dSample;  //NOTE: Source samples per output sample, 1 plays at the recorded pitch.
+    bool32 Looping;
+
+    real64 SamplesPlayed;
+
+    playing_sound *Next;
+};
+
+struct audio_state
+{
+    playing_sound Pool[MAX_PLAYING_SOUNDS];
+
+    playing_sound *FirstPlayingSound;
+    playing_sound *FirstFreePlayingSound;
+    bool32 PoolInitialized;
+
+    uint32 PlayingSoundCount;
+    uint32 DroppedPlayCount;
+};
+
+#endif
@@ -0,0 +1,6366 @@
+//NOTE: The benchmarks call straight into game internals, so unlike the harness they build the game in statically.
+#include "handmade.cpp"
+
+#define LINUX_HANDMADE_NO_MAIN 1
+#include "linux_handmade.cpp"
+
+#define HANDMADE_PACKER_NO_MAIN 1
+#include "handmade_packer.cpp"
+
+#include <sys/resource.h>
+
+//NOTE: Benchmarks for the hot paths of the game core, run on top of the headless Linux platform layer.
+//  Every benchmark checks its fast paths against the reference path before it times anything, and fails the run if
+//  they disagree, so a fast number can never come from a wrong answer.
+
+#define BENCH_FUNCTION(name) bool32 name(void)
+typedef BENCH_FUNCTION(bench_function);
+
+struct bench_mode
+{
+    char *Name;
+    bench_function *Function;
+};
+
+struct bench_timer
+{
+    int RepeatCount;
+    real64 MinMS;
+    real64 TotalMS;
+};
+
+// =====================================================================================================================
+
+internal void BenchBeginRepeat(bench_timer *Timer)
+{
+    Timer->RepeatCount = 0;
+    Timer->MinMS = 0.0;
+    Timer->TotalMS = 0.0;
+}
+
+// =====================================================================================================================
+
+internal void BenchAddRepeat(bench_timer *Timer, uint64 StartCounter, uint64 EndCounter)
+{
+    real64 MS = LinuxGetMSElapsed(StartCounter, EndCounter);
+    if ((Timer->RepeatCount == 0) || (MS < Timer->MinMS))
+    {
+        Timer->MinMS = MS;
+    }
+    Timer->TotalMS += MS;
+    ++Timer->RepeatCount;
+}
+
+// =====================================================================================================================
+
+internal real64 BenchAverageMS(bench_timer *Timer)
+{
+    real64 Result = Timer->RepeatCount ? (Timer->TotalMS / (real64)Timer->RepeatCount) : 0.0;
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal int BenchCompareCycles(const void *A, const void *B)
+{
+    uint64 CyclesA = *(uint64 *)A;
+    uint64 CyclesB = *(uint64 *)B;
+    int Result = (CyclesA < CyclesB) ? -1 : ((CyclesA > CyclesB) ? 1 : 0);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal int BenchCompareReals(const void *A, const void *B)
+{
+    real64 RealA = *(real64 *)A;
+    real64 RealB = *(real64 *)B;
+    int Result = (RealA < RealB) ? -1 : ((RealA > RealB) ? 1 : 0);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal uint64 BenchGetPercentile(uint64 *SortedCycles, int Count, int Percent)
+{
+    //NOTE: Nearest rank, so every percentile is a frame that actually happened.
+    int Rank = (Count * Percent + 99) / 100;
+    if (Rank < 1)
+    {
+        Rank = 1;
+    }
+    uint64 Result = SortedCycles[Rank - 1];
+    return(Result);
+}
+
+// =====================================================================================================================
+
+
+global_variable uint32 GlobalBenchRandomState = 0x12345678;
+
+internal uint32 BenchRandom(void)
+{
+    //NOTE: xorshift32, deterministic so that a failing check can be reproduced.
+    uint32 X = GlobalBenchRandomState;
+    X ^= X << 13;
+    X ^= X >> 17;
+    X ^= X << 5;
+    GlobalBenchRandomState = X;
+    return(X);
+}
+
+internal int BenchRandomBetween(int Min, int Max)
+{
+    int Result = Min + (int)(BenchRandom() % (uint32)(Max - Min + 1));
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal game_offscreen_buffer BenchAllocateBuffer(int Width, int Height, int PitchPadding)
+{
+    game_offscreen_buffer Result = {};
+    Result.Width = Width;
+    Result.Height = Height;
+    Result.BytesPerPixel = 4;
+    Result.Pitch = Width * Result.BytesPerPixel + PitchPadding;
+    Result.Memory = LinuxAllocateMemory(Result.Pitch * Height);
+    return(Result);
+}
+
+internal void BenchFreeBuffer(game_offscreen_buffer *Buffer)
+{
+    munmap(Buffer->Memory, Buffer->Pitch * Buffer->Height);
+    Buffer->Memory = 0;
+}
+
+internal void BenchFillBytes(game_offscreen_buffer *Buffer, uint8 Value)
+{
+    memset(Buffer->Memory, Value, Buffer->Pitch * Buffer->Height);
+}
+
+internal bool32 BenchBuffersMatch(game_offscreen_buffer *A, game_offscreen_buffer *B)
+{
+    Assert(A->Pitch == B->Pitch && A->Height == B->Height);
+    bool32 Result = (memcmp(A->Memory, B->Memory, A->Pitch * A->Height) == 0);
+    return(Result);
+}
+
+// =====================================================================================================================
+//NOTE: Render kernels
+
+internal bool32 BenchCheckRenderKernels(render_kernel_level Level)
+{
+    render_kernels Reference = GetRenderKernels(RenderKernel_Scalar);
+    render_kernels Test = GetRenderKernels(Level);
+
+    //NOTE: Odd widths and padded pitches make sure the vector loops and their scalar tails both get exercised, and
+    //  the padding has to come back untouched.
+    for (int Width = 1; Width <= 70; ++Width)
+    {
+        int Height = 1 + (Width % 7);
+        int PitchPadding = 4 * (Width % 3);
+
+        game_offscreen_buffer Expected = BenchAllocateBuffer(Width, Height, PitchPadding);
+        game_offscreen_buffer Actual = BenchAllocateBuffer(Width, Height, PitchPadding);
+
+        for (int Trial = 0; Trial < 16; ++Trial)
+        {
+            int BlueOffset = (int)BenchRandom() - 0x7FFFFFFF / 2;
+            int GreenOffset = (int)BenchRandom() - 0x7FFFFFFF / 2;
+            uint32 Color = BenchRandom();
+
+            rectangle2i Clip = ClipRectangle(&Expected,
+                    BenchRandomBetween(-4, Width), BenchRandomBetween(-4, Height),
+                    BenchRandomBetween(0, Width + 4), BenchRandomBetween(0, Height + 4));
+
+            BenchFillBytes(&Expected, 0xCD);
+            BenchFillBytes(&Actual, 0xCD);
+            if (HasArea(Clip))
+            {
+                Reference.FillRectangle(&Expected, Clip.MinX, Clip.MinY, Clip.MaxX, Clip.MaxY, Color);
+                Test.FillRectangle(&Actual, Clip.MinX, Clip.MinY, Clip.MaxX, Clip.MaxY, Color);
+            }
+            if (!BenchBuffersMatch(&Expected, &Actual))
+            {
+                fprintf(stderr, "%s FillRectangle mismatch at %dx%d\n", GetRenderKernelLevelName(Level), Width, Height);
+                return(false);
+            }
+
+            BenchFillBytes(&Expected, 0xCD);
+            BenchFillBytes(&Actual, 0xCD);
+            if (HasArea(Clip))
+            {
+                Reference.RenderWeirdGradient(&Expected, Clip.MinX, Clip.MinY, Clip.MaxX, Clip.MaxY,
+                        BlueOffset, GreenOffset);
+                Test.RenderWeirdGradient(&Actual, Clip.MinX, Clip.MinY, Clip.MaxX, Clip.MaxY,
+                        BlueOffset, GreenOffset);
+            }
+            if (!BenchBuffersMatch(&Expected, &Actual))
+            {
+                fprintf(stderr, "%s RenderWeirdGradient mismatch at %dx%d\n",
+                        GetRenderKernelLevelName(Level), Width, Height);
+                return(false);
+            }
+        }
+
+        BenchFreeBuffer(&Expected);
+        BenchFreeBuffer(&Actual);
+    }
+
+    return(true);
+}
+
+// =====================================================================================================================
+
+internal BENCH_FUNCTION(BenchRender)
+{
+    int Sizes[][2] =
+    {
+        {1280, 720},
+        {1920, 1080},
+        {3840, 2160},
+    };
+
+    printf("render kernels (best %s)\n", GetRenderKernelLevelName(GetBestRenderKernelLevel()));
+    for (int LevelIndex = 0; LevelIndex < RenderKernel_Count; ++LevelIndex)
+    {
+        render_kernel_level Level = (render_kernel_level)LevelIndex;
+        if (IsRenderKernelLevelSupported(Level) && !BenchCheckRenderKernels(Level))
+        {
+            return(false);
+        }
+    }
+
+    for (int SizeIndex = 0; SizeIndex < (int)ArrayCount(Sizes); ++SizeIndex)
+    {
+        game_offscreen_buffer Buffer = BenchAllocateBuffer(Sizes[SizeIndex][0], Sizes[SizeIndex][1], 0);
+        real64 PixelCount = (real64)Buffer.Width * (real64)Buffer.Height;
+
+        for (int LevelIndex = 0; LevelIndex < RenderKernel_Count; ++LevelIndex)
+        {
+            render_kernel_level Level = (render_kernel_level)LevelIndex;
+            if (!IsRenderKernelLevelSupported(Level))
+            {
+                continue;
+            }
+            render_kernels Kernels = GetRenderKernels(Level);
+
+            bench_timer Gradient;
+            BenchBeginRepeat(&Gradient);
+            for (int Repeat = 0; Repeat < 50; ++Repeat)
+            {
+                uint64 Start = LinuxGetWallClock();
+                Kernels.RenderWeirdGradient(&Buffer, 0, 0, Buffer.Width, Buffer.Height, Repeat, Repeat);
+                BenchAddRepeat(&Gradient, Start, LinuxGetWallClock());
+            }
+
+            bench_timer Clear;
+            BenchBeginRepeat(&Clear);
+            for (int Repeat = 0; Repeat < 50; ++Repeat)
+            {
+                uint64 Start = LinuxGetWallClock();
+                Kernels.FillRectangle(&Buffer, 0, 0, Buffer.Width, Buffer.Height, 0xFF00FF00 + Repeat);
+                BenchAddRepeat(&Clear, Start, LinuxGetWallClock());
+            }
+
+            printf("  %4dx%-4d %-6s  gradient %7.03fms (%8.01f Mpix/s)  clear %7.03fms (%8.01f Mpix/s)\n",
+                    Buffer.Width, Buffer.Height, GetRenderKernelLevelName(Level),
+                    Gradient.MinMS, PixelCount / (Gradient.MinMS * 1000.0),
+                    Clear.MinMS, PixelCount / (Clear.MinMS * 1000.0));
+        }
+
+        BenchFreeBuffer(&Buffer);
+    }
+
+    return(true);
+}
+
+// =====================================================================================================================
+//NOTE: Tiled renderer scaling
+
+internal BENCH_FUNCTION(BenchThreads)
+{
+    int ProcessorCount = LinuxGetProcessorCount();
+    int ThreadCounts[] = {1, 2, 4, 8, ProcessorCount};
+
+    Platform.AddEntry = LinuxAddEntry;
+    Platform.CompleteAllWork = LinuxCompleteAllWork;
+
+    memory_index ArenaSize = Megabytes(1);
+    memory_arena Arena;
+    InitializeArena(&Arena, (char *)"Threads", ArenaSize, LinuxAllocateMemory(ArenaSize));
+
+    int Sizes[][2] =
+    {
+        {1280, 720},
+        {3840, 2160},
+    };
+
+    printf("tiled renderer (%d processors, %dx%d tiles)\n", ProcessorCount, RENDER_TILE_SIZE, RENDER_TILE_SIZE);
+    for (int SizeIndex = 0; SizeIndex < (int)ArrayCount(Sizes); ++SizeIndex)
+    {
+        game_offscreen_buffer Buffer = BenchAllocateBuffer(Sizes[SizeIndex][0], Sizes[SizeIndex][1], 0);
+        game_offscreen_buffer Expected = BenchAllocateBuffer(Sizes[SizeIndex][0], Sizes[SizeIndex][1], 0);
+        RenderWeirdGradient(&Expected, 17, 23);
+
+        temporary_memory GroupMemory = BeginTemporaryMemory(&Arena);
+        render_group *Group = AllocateRenderGroup(&Arena, Kilobytes(4), Buffer.Width, Buffer.Height);
+        PushWeirdGradient(Group, 0, 17, 23);
+
+        real64 SingleThreadMS = 0.0;
+        for (int CountIndex = 0; CountIndex < (int)ArrayCount(ThreadCounts); ++CountIndex)
+        {
+            int ThreadCount = ThreadCounts[CountIndex];
+            if ((CountIndex == (ArrayCount(ThreadCounts) - 1)) && (ThreadCount <= 8) &&
+                    ((ThreadCount & (ThreadCount - 1)) == 0))
+            {
+                //NOTE: N already showed up as one of the fixed counts.
+                continue;
+            }
+
+            //NOTE: The queues (and their workers) are leaked on purpose, there is no way to retire a worker.
+            platform_work_queue *Queue = (platform_work_queue *)LinuxAllocateMemory(sizeof(platform_work_queue));
+            LinuxMakeQueue(Queue, ThreadCount - 1);
+
+            BenchFillBytes(&Buffer, 0);
+            RenderGroupToOutput(Group, &Buffer, Queue, &Arena);
+            if (!BenchBuffersMatch(&Buffer, &Expected))
+            {
+                fprintf(stderr, "tiled output with %d threads differs from the single pass\n", ThreadCount);
+                return(false);
+            }
+
+            bench_timer Timer;
+            BenchBeginRepeat(&Timer);
+            for (int Repeat = 0; Repeat < 100; ++Repeat)
+            {
+                uint64 Start = LinuxGetWallClock();
+                RenderGroupToOutput(Group, &Buffer, Queue, &Arena);
+                BenchAddRepeat(&Timer, Start, LinuxGetWallClock());
+            }
+
+            if (ThreadCount == 1)
+            {
+                SingleThreadMS = Timer.MinMS;
+            }
+            printf("  %4dx%-4d %3d threads  best %7.03fms  avg %7.03fms  speedup %5.02fx\n",
+                    Buffer.Width, Buffer.Height, ThreadCount, Timer.MinMS, BenchAverageMS(&Timer),
+                    SingleThreadMS / Timer.MinMS);
+        }
+
+        EndTemporaryMemory(GroupMemory);
+        BenchFreeBuffer(&Buffer);
+        BenchFreeBuffer(&Expected);
+    }
+
+    return(true);
+}
+
+// =====================================================================================================================
+//NOTE: Tone synthesis
+
+internal void BenchOutputSoundSinf(real32 *tSine, int WavePeriod, int16 *SampleOut, int SampleCount)
+{
+    //NOTE: This is the per-sample sinf path the oscillator replaced, kept here as the baseline.
+    int16 ToneVolume = 5000;
+    for (int SampleIndex = 0; SampleIndex < SampleCount; ++SampleIndex)
+    {
+        real32 SineValue = sinf(*tSine);
+        int16 SampleValue = (int16)(SineValue * ToneVolume);
+        *SampleOut++ = SampleValue;
+        *SampleOut++ = SampleValue;
+
+        *tSine += 2.0f * Pi32 * 1.0f / (real32)WavePeriod;
+    }
+}
+
+// =====================================================================================================================
+
+internal BENCH_FUNCTION(BenchSound)
+{
+    int SamplesPerSecond = 48000;
+    int SampleCount = SamplesPerSecond;
+    real32 ToneHz = 256.0f;
+
+    real32 *MonoSamples = (real32 *)LinuxAllocateMemory(SampleCount * sizeof(real32));
+    real32 *ReferenceSamples = (real32 *)LinuxAllocateMemory(SampleCount * sizeof(real32));
+    int16 *StereoSamples = (int16 *)LinuxAllocateMemory(SampleCount * 2 * sizeof(int16));
+
+    game_sound_output_buffer SoundBuffer = {};
+    SoundBuffer.SamplesPerSecond = SamplesPerSecond;
+    SoundBuffer.SampleCount = SampleCount;
+    SoundBuffer.Samples = StereoSamples;
+
+    //NOTE: The SSE2 generator has to agree with the scalar one, including across odd batch sizes.
+    oscillator Reference = {};
+    Reference.Volume = 5000.0f;
+    SetOscillatorFrequency(&Reference, ToneHz, SamplesPerSecond);
+    oscillator Test = Reference;
+    for (int BatchSize = 1; BatchSize < 64; ++BatchSize)
+    {
+        GenerateSineScalar(&Reference, ReferenceSamples, BatchSize);
+        GenerateSine(&Test, MonoSamples, BatchSize);
+        for (int SampleIndex = 0; SampleIndex < BatchSize; ++SampleIndex)
+        {
+            if (fabsf(ReferenceSamples[SampleIndex] - MonoSamples[SampleIndex]) > 1e-3f)
+            {
+                fprintf(stderr, "SSE2 sine differs from scalar at batch size %d\n", BatchSize);
+                return(false);
+            }
+        }
+        if (Reference.Phase != Test.Phase)
+        {
+            fprintf(stderr, "SSE2 sine phase differs from scalar at batch size %d\n", BatchSize);
+            return(false);
+        }
+    }
+
+    printf("tone synthesis (%d samples per batch)\n", SampleCount);
+
+    bench_timer Sinf;
+    BenchBeginRepeat(&Sinf);
+    real32 tSine = 0.0f;
+    for (int Repeat = 0; Repeat < 20; ++Repeat)
+    {
+        uint64 Start = LinuxGetWallClock();
+        BenchOutputSoundSinf(&tSine, SamplesPerSecond / (int)ToneHz, StereoSamples, SampleCount);
+        BenchAddRepeat(&Sinf, Start, LinuxGetWallClock());
+    }
+
+    bench_timer Scalar;
+    BenchBeginRepeat(&Scalar);
+    for (int Repeat = 0; Repeat < 20; ++Repeat)
+    {
+        uint64 Start = LinuxGetWallClock();
+        GenerateSineScalar(&Reference, MonoSamples, SampleCount);
+        OutputMonoAsStereo(MonoSamples, &SoundBuffer);
+        BenchAddRepeat(&Scalar, Start, LinuxGetWallClock());
+    }
+
+    bench_timer SSE2;
+    BenchBeginRepeat(&SSE2);
+    for (int Repeat = 0; Repeat < 20; ++Repeat)
+    {
+        uint64 Start = LinuxGetWallClock();
+        GenerateSine(&Test, MonoSamples, SampleCount);
+        OutputMonoAsStereo(MonoSamples, &SoundBuffer);
+        BenchAddRepeat(&SSE2, Start, LinuxGetWallClock());
+    }
+
+    printf("  sinf per sample      %7.03fms  %8.02f Msamples/s\n", Sinf.MinMS, SampleCount / (Sinf.MinMS * 1000.0));
+    printf("  wavetable scalar     %7.03fms  %8.02f Msamples/s\n", Scalar.MinMS, SampleCount / (Scalar.MinMS * 1000.0));
+    printf("  wavetable SSE2       %7.03fms  %8.02f Msamples/s\n", SSE2.MinMS, SampleCount / (SSE2.MinMS * 1000.0));
+
+    //NOTE: Long-session drift. Play four hours of tone through the generator in frame-sized batches, then check the
+    //  phase against the closed form and the waveform against a double-precision sine at that phase.
+    int Hours = 4;
+    int BatchSize = SamplesPerSecond / 60;
+    uint64 TotalSamples = (uint64)Hours * 3600 * SamplesPerSecond;
+    Assert((TotalSamples % BatchSize) == 0);
+
+    oscillator LongRun = {};
+    LongRun.Volume = 1.0f;
+    SetOscillatorFrequency(&LongRun, ToneHz, SamplesPerSecond);
+    real32 LongRunTSine = 0.0f;
+    real32 LongRunStep = 2.0f * Pi32 * ToneHz / (real32)SamplesPerSecond;
+    for (uint64 SampleIndex = 0; SampleIndex < TotalSamples; SampleIndex += BatchSize)
+    {
+        GenerateSine(&LongRun, MonoSamples, BatchSize);
+        for (int Index = 0; Index < BatchSize; ++Index)
+        {
+            LongRunTSine += LongRunStep;
+        }
+    }
+
+    uint32 ExpectedPhase = (uint32)(TotalSamples * (uint64)LongRun.PhaseStep);
+    real64 OscillatorCycles = (real64)TotalSamples * (real64)LongRun.PhaseStep / 4294967296.0;
+    real64 IdealCycles = (real64)TotalSamples * (real64)ToneHz / (real64)SamplesPerSecond;
+    real64 TSineCycles = (real64)LongRunTSine / (2.0 * 3.14159265358979323846);
+
+    uint32 Phase = LongRun.Phase;
+    GenerateSine(&LongRun, MonoSamples, BatchSize);
+    real64 MaxAmplitudeError = 0.0;
+    for (int Index = 0; Index < BatchSize; ++Index)
+    {
+        real64 Expected = sin(2.0 * 3.14159265358979323846 * (real64)Phase / 4294967296.0);
+        real64 Error = fabs(Expected - (real64)MonoSamples[Index]);
+        if (Error > MaxAmplitudeError)
+        {
+            MaxAmplitudeError = Error;
+        }
+        Phase += LongRun.PhaseStep;
+    }
+
+    printf("  after %d hours: phase drift %.06f cycles (oscillator) vs %.01f cycles (float tSine), "
+            "amplitude error %.02e\n", Hours, OscillatorCycles - IdealCycles, TSineCycles - IdealCycles,
+            MaxAmplitudeError);
+
+    //NOTE: The accumulator is exact, so the only drift allowed is the frequency quantization (under 2^-33 of a cycle
+    //  per sample), and the table has to stay within linear interpolation error of a real sine.
+    if ((LongRun.Phase - LongRun.PhaseStep * BatchSize) != ExpectedPhase)
+    {
+        fprintf(stderr, "oscillator phase drifted from the closed form\n");
+        return(false);
+    }
+    if (fabs(OscillatorCycles - IdealCycles) > ((real64)TotalSamples / 8589934592.0))
+    {
+        fprintf(stderr, "oscillator frequency drift is over the quantization bound\n");
+        return(false);
+    }
+    if (MaxAmplitudeError > 1e-5)
+    {
+        fprintf(stderr, "oscillator amplitude error is over 1e-5\n");
+        return(false);
+    }
+
+    return(true);
+}
+
+// =====================================================================================================================
+//NOTE: Mixer
+
+internal loaded_sound BenchMakeNoiseSound(uint32 SampleCount, uint32 ChannelCount)
+{
+    loaded_sound Result = {};
+    Result.SampleCount = SampleCount;
+    Result.ChannelCount = ChannelCount;
+    for (uint32 ChannelIndex = 0; ChannelIndex < ChannelCount; ++ChannelIndex)
+    {
+        Result.Samples[ChannelIndex] = (int16 *)LinuxAllocateMemory(SampleCount * sizeof(int16));
+        for (uint32 SampleIndex = 0; SampleIndex < SampleCount; ++SampleIndex)
+        {
+            Result.Samples[ChannelIndex][SampleIndex] = (int16)BenchRandomBetween(-8000, 8000);
+        }
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void BenchStartVoices(audio_state *AudioState, loaded_sound *Sounds, int SoundCount, int VoiceCount,
+        bool32 Pitched, bool32 Looping)
+{
+    InitializeAudioState(AudioState);
+    for (int VoiceIndex = 0; VoiceIndex < VoiceCount; ++VoiceIndex)
+    {
+        real32 dSample = Pitched ? (0.5f + 0.01f * (real32)BenchRandomBetween(0, 150)) : 1.0f;
+        real32 Pan = 0.01f * (real32)BenchRandomBetween(-100, 100);
+        playing_sound *Voice = PlaySound(AudioState, Sounds + (VoiceIndex % SoundCount), 0.1f, Pan, dSample, Looping);
+        Voice->SamplesPlayed = (real64)BenchRandomBetween(0, (int)Voice->Sound->SampleCount - 1);
+    }
+}
+
+// =====================================================================================================================
+
+internal BENCH_FUNCTION(BenchMixer)
+{
+    int BlockSize = 1024;
+    real32 *MixLeft = (real32 *)LinuxAllocateMemory(BlockSize * sizeof(real32));
+    real32 *MixRight = (real32 *)LinuxAllocateMemory(BlockSize * sizeof(real32));
+    real32 *ReferenceLeft = (real32 *)LinuxAllocateMemory(BlockSize * sizeof(real32));
+    real32 *ReferenceRight = (real32 *)LinuxAllocateMemory(BlockSize * sizeof(real32));
+    int16 *Output = (int16 *)LinuxAllocateMemory(BlockSize * 2 * sizeof(int16));
+
+    audio_state *AudioState = (audio_state *)LinuxAllocateMemory(sizeof(audio_state));
+    audio_state *ReferenceState = (audio_state *)LinuxAllocateMemory(sizeof(audio_state));
+
+    game_sound_output_buffer SoundBuffer = {};
+    SoundBuffer.SamplesPerSecond = 48000;
+    SoundBuffer.SampleCount = BlockSize;
+    SoundBuffer.Samples = Output;
+
+    //NOTE: Short sounds for the check, so that several blocks run through loop wraps and sound ends.
+    loaded_sound ShortSounds[4];
+    for (int SoundIndex = 0; SoundIndex < (int)ArrayCount(ShortSounds); ++SoundIndex)
+    {
+        ShortSounds[SoundIndex] = BenchMakeNoiseSound(300 + 97 * SoundIndex, 1 + (SoundIndex & 1));
+    }
+
+    for (int Pitched = 0; Pitched <= 1; ++Pitched)
+    {
+        for (int Looping = 0; Looping <= 1; ++Looping)
+        {
+            uint32 RandomState = GlobalBenchRandomState;
+            BenchStartVoices(AudioState, ShortSounds, ArrayCount(ShortSounds), 64, Pitched, Looping);
+            GlobalBenchRandomState = RandomState;
+            BenchStartVoices(ReferenceState, ShortSounds, ArrayCount(ShortSounds), 64, Pitched, Looping);
+
+            for (int Block = 0; Block < 4; ++Block)
+            {
+                ClearMixBuffers(MixLeft, MixRight, BlockSize);
+                ClearMixBuffers(ReferenceLeft, ReferenceRight, BlockSize);
+                MixPlayingSounds(AudioState, MixLeft, MixRight, BlockSize, MixVoiceChunkSSE2);
+                MixPlayingSounds(ReferenceState, ReferenceLeft, ReferenceRight, BlockSize, MixVoiceChunkScalar);
+
+                for (int SampleIndex = 0; SampleIndex < BlockSize; ++SampleIndex)
+                {
+                    if ((fabsf(MixLeft[SampleIndex] - ReferenceLeft[SampleIndex]) > 0.5f) ||
+                            (fabsf(MixRight[SampleIndex] - ReferenceRight[SampleIndex]) > 0.5f))
+                    {
+                        fprintf(stderr, "SSE2 mix differs from scalar (pitched %d, looping %d, block %d, sample %d)\n",
+                                Pitched, Looping, Block, SampleIndex);
+                        return(false);
+                    }
+                }
+                if (AudioState->PlayingSoundCount != ReferenceState->PlayingSoundCount)
+                {
+                    fprintf(stderr, "SSE2 mix retired a different number of voices than scalar\n");
+                    return(false);
+                }
+            }
+        }
+    }
+
+    loaded_sound Sounds[8];
+    for (int SoundIndex = 0; SoundIndex < (int)ArrayCount(Sounds); ++SoundIndex)
+    {
+        Sounds[SoundIndex] = BenchMakeNoiseSound(48000, 1 + (SoundIndex & 1));
+    }
+
+    printf("mixer (%d samples per block, pool of %d voices)\n", BlockSize, MAX_PLAYING_SOUNDS);
+    int VoiceCounts[] = {256, 512, 1024};
+    for (int CountIndex = 0; CountIndex < (int)ArrayCount(VoiceCounts); ++CountIndex)
+    {
+        int VoiceCount = VoiceCounts[CountIndex];
+        for (int Pitched = 0; Pitched <= 1; ++Pitched)
+        {
+            for (int KernelIndex = 0; KernelIndex < 2; ++KernelIndex)
+            {
+                mix_voice_chunk *Kernel = KernelIndex ? MixVoiceChunkSSE2 : MixVoiceChunkScalar;
+                BenchStartVoices(AudioState, Sounds, ArrayCount(Sounds), VoiceCount, Pitched, true);
+
+                bench_timer Timer;
+                BenchBeginRepeat(&Timer);
+                for (int Repeat = 0; Repeat < 20; ++Repeat)
+                {
+                    uint64 Start = LinuxGetWallClock();
+                    ClearMixBuffers(MixLeft, MixRight, BlockSize);
+                    MixPlayingSounds(AudioState, MixLeft, MixRight, BlockSize, Kernel);
+                    OutputStereoMix(MixLeft, MixRight, &SoundBuffer);
+                    BenchAddRepeat(&Timer, Start, LinuxGetWallClock());
+                }
+
+                printf("  %4d voices %-9s %-6s  %7.03fms per block  %7.01fns per voice per block\n",
+                        VoiceCount, Pitched ? "pitched" : "unpitched", KernelIndex ? "SSE2" : "Scalar",
+                        Timer.MinMS, (Timer.MinMS * 1000000.0) / (real64)VoiceCount);
+            }
+        }
+    }
+
+    return(true);
+}
+
+// =====================================================================================================================
+//NOTE: Game module reloading
+
+internal game_memory BenchAllocateGameMemory(void)
+{
+    game_memory Result = {};
+    Result.PermanentStorageSize = Megabytes(4);
+    Result.PermanentStorage = LinuxAllocateMemory(Result.PermanentStorageSize);
+    Result.TransientStorageSize = Megabytes(16);
+    Result.TransientStorage = LinuxAllocateMemory(Result.TransientStorageSize);
+    Result.PlatformAPI.AddEntry = LinuxAddEntry;
+    Result.PlatformAPI.CompleteAllWork = LinuxCompleteAllWork;
+    Result.PlatformAPI.MapFile = LinuxMapFile;
+    Result.PlatformAPI.UnmapFile = LinuxUnmapFile;
+    return(Result);
+}
+
+internal void BenchFreeGameMemory(game_memory *Memory)
+{
+    munmap(Memory->PermanentStorage, Memory->PermanentStorageSize);
+    munmap(Memory->TransientStorage, Memory->TransientStorageSize);
+}
+
+internal BENCH_FUNCTION(BenchReload)
+{
+    linux_state State = {};
+    LinuxGetEXEFileName(&State);
+
+    char SourceSOName[LINUX_STATE_FILE_NAME_COUNT];
+    LinuxBuildEXEPathFileName(&State, (char *)"handmade.so", sizeof(SourceSOName), SourceSOName);
+    char TempSOName[LINUX_STATE_FILE_NAME_COUNT];
+    LinuxBuildEXEPathFileName(&State, (char *)"handmade_bench_temp.so", sizeof(TempSOName), TempSOName);
+
+    linux_game_code Game = LinuxLoadGameCode(SourceSOName, TempSOName);
+    if (!Game.IsValid)
+    {
+        fprintf(stderr, "unable to load GameUpdateAndRender from %s\n", SourceSOName);
+        return(false);
+    }
+
+    //NOTE: Run the same frames twice: once through the statically built game, once through the module with a reload
+    //  in the middle. If everything the game needs really lives in game memory, the reload is invisible and both
+    //  runs end on the same picture and the same samples.
+    int FrameCount = 8;
+    int ReloadFrame = FrameCount / 2;
+
+    game_memory MemoryA = BenchAllocateGameMemory();
+    game_memory MemoryB = BenchAllocateGameMemory();
+    game_offscreen_buffer BufferA = BenchAllocateBuffer(320, 180, 0);
+    game_offscreen_buffer BufferB = BenchAllocateBuffer(320, 180, 0);
+
+    int SampleCount = 800;
+    int16 *SamplesA = (int16 *)LinuxAllocateMemory(SampleCount * 2 * sizeof(int16));
+    int16 *SamplesB = (int16 *)LinuxAllocateMemory(SampleCount * 2 * sizeof(int16));
+    game_sound_output_buffer SoundA = {48000, SampleCount, SamplesA};
+    game_sound_output_buffer SoundB = {48000, SampleCount, SamplesB};
+
+    game_input Input = {};
+    Input.dtForFrame = 1.0f / 60.0f;
+    game_controller_input *Keyboard = GetController(&Input, 0);
+    Keyboard->IsConnected = true;
+    Keyboard->MoveRight.EndedDown = true;
+    Keyboard->MoveUp.EndedDown = true;
+
+    for (int FrameIndex = 0; FrameIndex < FrameCount; ++FrameIndex)
+    {
+        //NOTE: The blip only fires on a press, so press on the first frame and keep it held.
+        Keyboard->ActionDown.EndedDown = true;
+        Keyboard->ActionDown.HalfTransitionCount = (FrameIndex == 0) ? 1 : 0;
+
+        if (FrameIndex == ReloadFrame)
+        {
+            LinuxUnloadGameCode(&Game);
+            Game = LinuxLoadGameCode(SourceSOName, TempSOName);
+            if (!Game.IsValid)
+            {
+                fprintf(stderr, "reloading %s failed\n", SourceSOName);
+                return(false);
+            }
+        }
+
+        GameUpdateAndRender(&MemoryA, &Input, &BufferA, &SoundA);
+        Game.UpdateAndRender(&MemoryB, &Input, &BufferB, &SoundB);
+    }
+
+    if (!BenchBuffersMatch(&BufferA, &BufferB) ||
+            (memcmp(SamplesA, SamplesB, SampleCount * 2 * sizeof(int16)) != 0))
+    {
+        fprintf(stderr, "game state did not survive a reload: output differs from the static build\n");
+        return(false);
+    }
+
+    //NOTE: The platform layer reloads between frames, so the whole unload, copy and load has to fit in one.
+    real64 FrameBudgetMS = 1000.0 / 60.0;
+    bench_timer Timer;
+    BenchBeginRepeat(&Timer);
+    real64 MaxMS = 0.0;
+    for (int Repeat = 0; Repeat < 50; ++Repeat)
+    {
+        uint64 Start = LinuxGetWallClock();
+        LinuxUnloadGameCode(&Game);
+        Game = LinuxLoadGameCode(SourceSOName, TempSOName);
+        uint64 End = LinuxGetWallClock();
+        BenchAddRepeat(&Timer, Start, End);
+
+        real64 MS = LinuxGetMSElapsed(Start, End);
+        if (MS > MaxMS)
+        {
+            MaxMS = MS;
+        }
+    }
+    LinuxUnloadGameCode(&Game);
+    unlink(TempSOName);
+
+    printf("game module reload (%s)\n", SourceSOName);
+    printf("  min %.03fms  avg %.03fms  max %.03fms  (budget %.03fms)\n",
+            Timer.MinMS, BenchAverageMS(&Timer), MaxMS, FrameBudgetMS);
+
+    BenchFreeGameMemory(&MemoryA);
+    BenchFreeGameMemory(&MemoryB);
+    BenchFreeBuffer(&BufferA);
+    BenchFreeBuffer(&BufferB);
+
+    bool32 Result = (MaxMS <= FrameBudgetMS);
+    if (!Result)
+    {
+        fprintf(stderr, "reloading the game module took longer than a frame\n");
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+//NOTE: Present stage
+
+internal present_state *BenchAllocatePresentState(present_mode Mode)
+{
+    memory_index StorageSize = GetPresentStorageSize();
+    memory_arena Arena;
+    InitializeArena(&Arena, (char *)"Present", StorageSize, LinuxAllocateMemory(StorageSize));
+    present_state *Result = PushStruct(&Arena, present_state, 64);
+    InitializePresentState(Result, &Arena, Mode);
+    return(Result);
+}
+
+internal void BenchFillRandom(game_offscreen_buffer *Buffer)
+{
+    uint8 *Row = (uint8 *)Buffer->Memory;
+    for (int Y = 0; Y < Buffer->Height; ++Y)
+    {
+        uint32 *Pixel = (uint32 *)Row;
+        for (int X = 0; X < Buffer->Width; ++X)
+        {
+            *Pixel++ = BenchRandom();
+        }
+        Row += Buffer->Pitch;
+    }
+}
+
+internal bool32 BenchCheckIntegerPresent(present_state *State, game_offscreen_buffer *Source, int DisplayWidth,
+        int DisplayHeight)
+{
+    //NOTE: Every display pixel has exactly one right answer: the source pixel it is a copy of, or black. The display
+    //  starts out as garbage so that a bar that never got cleared shows up too.
+    game_offscreen_buffer Display = BenchAllocateBuffer(DisplayWidth, DisplayHeight, 0);
+    BenchFillBytes(&Display, 0xA5);
+    State->LayoutIsValid = false;
+    PresentBuffer(State, Source, &Display, 0, 0);
+
+    present_layout *Layout = &State->Layout;
+    bool32 Result = (Layout->Mode == PresentMode_Integer);
+    for (int Y = 0; Result && (Y < Display.Height); ++Y)
+    {
+        uint32 *DisplayRow = (uint32 *)((uint8 *)Display.Memory + Y * Display.Pitch);
+        for (int X = 0; X < Display.Width; ++X)
+        {
+            uint32 Expected = 0;
+            if ((X >= Layout->MinX) && (X < Layout->MaxX) && (Y >= Layout->MinY) && (Y < Layout->MaxY))
+            {
+                uint32 *SourceRow = (uint32 *)((uint8 *)Source->Memory +
+                        ((Y - Layout->MinY) / Layout->Scale) * Source->Pitch);
+                Expected = SourceRow[(X - Layout->MinX) / Layout->Scale];
+            }
+
+            if (DisplayRow[X] != Expected)
+            {
+                fprintf(stderr, "integer present %dx%d -> %dx%d (%s) wrong at %d,%d: %08x, expected %08x\n",
+                        Source->Width, Source->Height, DisplayWidth, DisplayHeight,
+                        State->UseSSE2 ? "SSE2" : "scalar", X, Y, DisplayRow[X], Expected);
+                Result = false;
+                break;
+            }
+        }
+    }
+
+    BenchFreeBuffer(&Display);
+    return(Result);
+}
+
+internal bool32 BenchCheckBilinearPresent(present_state *State, game_offscreen_buffer *Source, int DisplayWidth,
+        int DisplayHeight, platform_api *PlatformAPI, platform_work_queue *Queue)
+{
+    //NOTE: The scalar path is the reference. The SSE2 path, single-threaded and split across the queue, must match
+    //  it exactly.
+    game_offscreen_buffer Expected = BenchAllocateBuffer(DisplayWidth, DisplayHeight, 0);
+    game_offscreen_buffer Display = BenchAllocateBuffer(DisplayWidth, DisplayHeight, 0);
+
+    State->UseSSE2 = false;
+    State->LayoutIsValid = false;
+    BenchFillBytes(&Expected, 0xA5);
+    PresentBuffer(State, Source, &Expected, 0, 0);
+
+    State->UseSSE2 = true;
+    State->LayoutIsValid = false;
+    BenchFillBytes(&Display, 0x5A);
+    PresentBuffer(State, Source, &Display, 0, 0);
+    bool32 Result = BenchBuffersMatch(&Display, &Expected);
+
+    State->LayoutIsValid = false;
+    BenchFillBytes(&Display, 0x5A);
+    PresentBuffer(State, Source, &Display, PlatformAPI, Queue);
+    Result = Result && BenchBuffersMatch(&Display, &Expected);
+
+    if (!Result)
+    {
+        fprintf(stderr, "bilinear present %dx%d -> %dx%d differs from the scalar reference\n",
+                Source->Width, Source->Height, DisplayWidth, DisplayHeight);
+    }
+
+    BenchFreeBuffer(&Expected);
+    BenchFreeBuffer(&Display);
+    return(Result);
+}
+
+internal bool32 BenchCheckFlatBilinearPresent(present_state *State)
+{
+    //NOTE: Blending a color with itself has to give back that color, whatever the weights are.
+    uint32 Color = 0x80C0FF40;
+    game_offscreen_buffer Source = BenchAllocateBuffer(97, 53, 12);
+    FillRectangleScalar(&Source, 0, 0, Source.Width, Source.Height, Color);
+    game_offscreen_buffer Display = BenchAllocateBuffer(641, 479, 0);
+    State->LayoutIsValid = false;
+    PresentBuffer(State, &Source, &Display, 0, 0);
+
+    bool32 Result = true;
+    present_layout *Layout = &State->Layout;
+    for (int Y = Layout->MinY; Result && (Y < Layout->MaxY); ++Y)
+    {
+        uint32 *Row = (uint32 *)((uint8 *)Display.Memory + Y * Display.Pitch);
+        for (int X = Layout->MinX; X < Layout->MaxX; ++X)
+        {
+            if (Row[X] != Color)
+            {
+                fprintf(stderr, "bilinear present changed a flat color at %d,%d: %08x\n", X, Y, Row[X]);
+                Result = false;
+                break;
+            }
+        }
+    }
+
+    BenchFreeBuffer(&Source);
+    BenchFreeBuffer(&Display);
+    return(Result);
+}
+
+internal BENCH_FUNCTION(BenchPresent)
+{
+    platform_api PlatformAPI = {};
+    PlatformAPI.AddEntry = LinuxAddEntry;
+    PlatformAPI.CompleteAllWork = LinuxCompleteAllWork;
+
+    //NOTE: Leaked on purpose, like every other bench queue.
+    int ProcessorCount = LinuxGetProcessorCount();
+    platform_work_queue *Queue = (platform_work_queue *)LinuxAllocateMemory(sizeof(platform_work_queue));
+    LinuxMakeQueue(Queue, ProcessorCount - 1);
+
+    present_state *Integer = BenchAllocatePresentState(PresentMode_Integer);
+    present_state *Bilinear = BenchAllocatePresentState(PresentMode_Bilinear);
+
+    int CheckSizes[][4] =
+    {
+        {1280, 720, 1920, 1080},
+        {1280, 720, 2560, 1440},
+        {1280, 720, 3840, 2160},
+        {1280, 720, 2000, 1600},
+        {317, 211, 1000, 700},
+        {160, 90, 1280, 720},
+        {101, 100, 759, 505},
+        {317, 211, 317, 211},
+        {640, 480, 300, 200},
+    };
+    for (int SizeIndex = 0; SizeIndex < (int)ArrayCount(CheckSizes); ++SizeIndex)
+    {
+        game_offscreen_buffer Source = BenchAllocateBuffer(CheckSizes[SizeIndex][0], CheckSizes[SizeIndex][1], 8);
+        BenchFillRandom(&Source);
+
+        bool32 IntegerFits = ((CheckSizes[SizeIndex][2] >= Source.Width) &&
+                (CheckSizes[SizeIndex][3] >= Source.Height));
+        for (int UseSSE2 = 0; IntegerFits && (UseSSE2 < 2); ++UseSSE2)
+        {
+            Integer->UseSSE2 = UseSSE2;
+            if (!BenchCheckIntegerPresent(Integer, &Source, CheckSizes[SizeIndex][2], CheckSizes[SizeIndex][3]))
+            {
+                return(false);
+            }
+        }
+
+        if (!BenchCheckBilinearPresent(Bilinear, &Source, CheckSizes[SizeIndex][2], CheckSizes[SizeIndex][3],
+                    &PlatformAPI, Queue))
+        {
+            return(false);
+        }
+
+        BenchFreeBuffer(&Source);
+    }
+    Integer->UseSSE2 = true;
+    if (!BenchCheckFlatBilinearPresent(Bilinear))
+    {
+        return(false);
+    }
+
+    int DisplaySizes[][2] =
+    {
+        {1920, 1080},
+        {2560, 1440},
+        {3840, 2160},
+    };
+
+    game_offscreen_buffer Source = BenchAllocateBuffer(1280, 720, 0);
+    RenderWeirdGradient(&Source, 17, 23);
+
+    printf("present 1280x720 (%d threads for the queued runs)\n", ProcessorCount);
+    for (int SizeIndex = 0; SizeIndex < (int)ArrayCount(DisplaySizes); ++SizeIndex)
+    {
+        game_offscreen_buffer Display = BenchAllocateBuffer(DisplaySizes[SizeIndex][0], DisplaySizes[SizeIndex][1], 0);
+        real64 PixelCount = (real64)Display.Width * (real64)Display.Height;
+
+        present_state *States[] = {Integer, Bilinear, Bilinear, Bilinear};
+        bool32 UseSSE2[] = {true, false, true, true};
+        bool32 UseQueue[] = {false, false, false, true};
+        for (int RunIndex = 0; RunIndex < (int)ArrayCount(States); ++RunIndex)
+        {
+            present_state *State = States[RunIndex];
+            State->UseSSE2 = UseSSE2[RunIndex];
+            platform_work_queue *RunQueue = UseQueue[RunIndex] ? Queue : 0;
+
+            bench_timer Timer;
+            BenchBeginRepeat(&Timer);
+            for (int Repeat = 0; Repeat < 20; ++Repeat)
+            {
+                uint64 Start = LinuxGetWallClock();
+                PresentBuffer(State, &Source, &Display, &PlatformAPI, RunQueue);
+                BenchAddRepeat(&Timer, Start, LinuxGetWallClock());
+            }
+
+            char Scale[16] = "";
+            if (State->Layout.Mode == PresentMode_Integer)
+            {
+                snprintf(Scale, sizeof(Scale), " x%d", State->Layout.Scale);
+            }
+            char Label[64];
+            snprintf(Label, sizeof(Label), "%s%s %s%s", GetPresentModeName(State->Layout.Mode), Scale,
+                    State->UseSSE2 ? "SSE2" : "scalar", RunQueue ? " queued" : "");
+            printf("  -> %4dx%-4d %-26s best %7.03fms  avg %7.03fms  (%7.01f Mpix/s)\n",
+                    Display.Width, Display.Height, Label, Timer.MinMS, BenchAverageMS(&Timer),
+                    PixelCount / (Timer.MinMS * 1000.0));
+        }
+
+        BenchFreeBuffer(&Display);
+    }
+    BenchFreeBuffer(&Source);
+
+    return(true);
+}
+
+// =====================================================================================================================
+//NOTE: Profiler
+
+internal void BenchProfilerLeaf(void)
+{
+    TIMED_FUNCTION();
+}
+
+internal void BenchProfilerOuter(void)
+{
+    TIMED_FUNCTION();
+    for (int LeafIndex = 0; LeafIndex < 3; ++LeafIndex)
+    {
+        BenchProfilerLeaf();
+    }
+
+    {
+        TIMED_BLOCK("BenchProfilerCounted", 5);
+    }
+}
+
+internal PLATFORM_WORK_QUEUE_CALLBACK(BenchProfilerWork)
+{
+    TIMED_FUNCTION();
+}
+
+internal debug_node *BenchFindDebugNode(debug_state *State, char *BlockName, uint32 ParentIndex)
+{
+    debug_node *Result = 0;
+    for (uint32 NodeIndex = 1; NodeIndex < State->NodeCount; ++NodeIndex)
+    {
+        debug_node *Node = State->Nodes + NodeIndex;
+        if ((strcmp(Node->BlockName, BlockName) == 0) && (Node->ParentIndex == ParentIndex))
+        {
+            Result = Node;
+            break;
+        }
+    }
+    return(Result);
+}
+
+internal uint64 BenchCountDebugHits(debug_state *State, char *BlockName)
+{
+    uint64 Result = 0;
+    for (uint32 NodeIndex = 1; NodeIndex < State->NodeCount; ++NodeIndex)
+    {
+        if (strcmp(State->Nodes[NodeIndex].BlockName, BlockName) == 0)
+        {
+            Result += State->Nodes[NodeIndex].TotalHitCount;
+        }
+    }
+    return(Result);
+}
+
+internal bool32 BenchCheckProfilerTree(debug_state *State, int FrameCount)
+{
+    //NOTE: Each frame calls Outer twice; Outer calls Leaf three times and has a counted block worth 5 hits.
+    debug_node *Outer = BenchFindDebugNode(State, (char *)"BenchProfilerOuter", 0);
+    if (!Outer)
+    {
+        fprintf(stderr, "profiler lost the outer block\n");
+        return(false);
+    }
+
+    uint32 OuterIndex = (uint32)(Outer - State->Nodes);
+    debug_node *Leaf = BenchFindDebugNode(State, (char *)"BenchProfilerLeaf", OuterIndex);
+    debug_node *Counted = BenchFindDebugNode(State, (char *)"BenchProfilerCounted", OuterIndex);
+    if (!Leaf || !Counted)
+    {
+        fprintf(stderr, "profiler did not nest the inner blocks under the outer one\n");
+        return(false);
+    }
+
+    bool32 Result = ((Outer->TotalHitCount == (uint64)(2 * FrameCount)) &&
+            (Leaf->TotalHitCount == (uint64)(6 * FrameCount)) &&
+            (Counted->TotalHitCount == (uint64)(10 * FrameCount)) &&
+            (Leaf->Depth == 2) && (Counted->Depth == 2) &&
+            ((Leaf->TotalCycles + Counted->TotalCycles) <= Outer->TotalCycles) &&
+            (State->MismatchedEventCount == 0) && (State->NodeOverflowCount == 0));
+    if (!Result)
+    {
+        fprintf(stderr, "profiler collated the wrong hits: outer %llu, leaf %llu, counted %llu, %u unmatched\n",
+                (unsigned long long)Outer->TotalHitCount, (unsigned long long)Leaf->TotalHitCount,
+                (unsigned long long)Counted->TotalHitCount, State->MismatchedEventCount);
+    }
+    return(Result);
+}
+
+internal bool32 BenchCheckProfilerTrace(debug_state *State, char *FileName)
+{
+    //NOTE: Not a JSON parser, just enough to know every collated block made it out and the file is closed off.
+    bool32 Result = false;
+    FILE *File = fopen(FileName, "rb");
+    if (File)
+    {
+        fseek(File, 0, SEEK_END);
+        long FileSize = ftell(File);
+        fseek(File, 0, SEEK_SET);
+
+        char *Contents = (char *)LinuxAllocateMemory((memory_index)FileSize + 1);
+        if (Contents && (fread(Contents, 1, (size_t)FileSize, File) == (size_t)FileSize))
+        {
+            uint64 CompleteEventCount = 0;
+            for (char *Scan = strstr(Contents, "\"ph\":\"X\""); Scan; Scan = strstr(Scan + 1, "\"ph\":\"X\""))
+            {
+                ++CompleteEventCount;
+            }
+
+            Result = ((strncmp(Contents, "{\"displayTimeUnit\"", 18) == 0) &&
+                    (strstr(Contents, "\"BenchProfilerOuter\"") != 0) &&
+                    (strcmp(Contents + FileSize - 3, "]}\n") == 0) &&
+                    (CompleteEventCount == State->TraceEventCount));
+            munmap(Contents, (memory_index)FileSize + 1);
+        }
+        fclose(File);
+    }
+    return(Result);
+}
+
+internal BENCH_FUNCTION(BenchProfiler)
+{
+    //NOTE: The bench runs without a debug table, so every TIMED_BLOCK in the game falls through. This mode installs
+    //  one for itself and takes it away again at the end. The table is leaked on purpose: worker threads that recorded
+    //  into it keep their thread-local ring pointers.
+    memory_index DebugStorageSize = Megabytes(64);
+    memory_arena DebugArena;
+    InitializeArena(&DebugArena, (char *)"Debug", DebugStorageSize, LinuxAllocateMemory(DebugStorageSize));
+    debug_table *Table = PushStruct(&DebugArena, debug_table, 64);
+    debug_state *State = PushStruct(&DebugArena, debug_state, 64);
+    InitializeDebugState(State, Table, &DebugArena);
+    GlobalDebugTable = Table;
+    GlobalDebugThreadRing = 0;
+
+    bool32 Result = true;
+
+    //NOTE: Odd frames are drained partway through as well, the way a game module reload drains them, and that
+    //  mustn't split the frame: the last frame still has to show both calls.
+    int FrameCount = 4;
+    CollateDebugFrame(State, (real64)LinuxGetWallClock() / 1000000000.0);
+    for (int FrameIndex = 0; FrameIndex < FrameCount; ++FrameIndex)
+    {
+        BenchProfilerOuter();
+        if (FrameIndex & 1)
+        {
+            CollateDebugRings(State);
+        }
+        BenchProfilerOuter();
+        CollateDebugFrame(State, (real64)LinuxGetWallClock() / 1000000000.0);
+    }
+    Result = Result && BenchCheckProfilerTree(State, FrameCount);
+
+    debug_node *LastOuter = BenchFindDebugNode(State, (char *)"BenchProfilerOuter", 0);
+    if (Result && ((State->FrameCount != (uint32)(FrameCount + 1)) || (LastOuter->FrameHitCount != 2)))
+    {
+        fprintf(stderr, "profiler split a frame that was drained partway through\n");
+        Result = false;
+    }
+
+    //NOTE: Blocks recorded on worker threads have to come back through their own rings. Whatever the main thread
+    //  picks up inside LinuxCompleteAllWork lands under that block instead of the root, so count hits by name.
+    int WorkerCount = 3;
+    int WorkCount = 64;
+    platform_work_queue *Queue = (platform_work_queue *)LinuxAllocateMemory(sizeof(platform_work_queue));
+    LinuxMakeQueue(Queue, WorkerCount);
+    for (int WorkIndex = 0; WorkIndex < WorkCount; ++WorkIndex)
+    {
+        LinuxAddEntry(Queue, BenchProfilerWork, 0);
+    }
+    LinuxCompleteAllWork(Queue);
+    CollateDebugFrame(State, (real64)LinuxGetWallClock() / 1000000000.0);
+
+    uint64 WorkHitCount = BenchCountDebugHits(State, (char *)"BenchProfilerWork");
+    if (Result && ((WorkHitCount != (uint64)WorkCount) || State->MismatchedEventCount))
+    {
+        fprintf(stderr, "profiler collated %llu of %d blocks from the work queue\n",
+                (unsigned long long)WorkHitCount, WorkCount);
+        Result = false;
+    }
+
+    //NOTE: Overhead. A block can't cost less than its two __rdtsc calls, and those are slower under a hypervisor
+    //  than on bare metal, so the 20 cycle budget is for everything a block does on top of them. The whole cost is
+    //  printed alongside, so the split is visible in the output and not just here.
+    //  Both are measured in the same batch so that a noisy stretch hits both alike, and the quietest batch wins.
+    debug_thread_ring *Ring = GlobalDebugThreadRing;
+    uint64 ClockCycles = (uint64)-1;
+    uint64 BlockCycles = (uint64)-1;
+    for (int Batch = 0; Batch < 256; ++Batch)
+    {
+        uint64 Start = __rdtsc();
+        for (int ClockIndex = 0; ClockIndex < 4096; ++ClockIndex)
+        {
+            __rdtsc();
+        }
+        uint64 Cycles = (__rdtsc() - Start) / 4096;
+        if (Cycles < ClockCycles)
+        {
+            ClockCycles = Cycles;
+        }
+
+        //NOTE: 4096 blocks is 8192 events, which fits in the ring without the collator, so just empty it in between.
+        Ring->ReadIndex = Ring->WriteIndex;
+        Start = __rdtsc();
+        for (int BlockIndex = 0; BlockIndex < 4096; ++BlockIndex)
+        {
+            TIMED_BLOCK("BenchProfilerEmpty");
+        }
+        Cycles = (__rdtsc() - Start) / 4096;
+        if (Cycles < BlockCycles)
+        {
+            BlockCycles = Cycles;
+        }
+    }
+    Ring->ReadIndex = Ring->WriteIndex;
+
+    uint64 BlockBudgetCycles = 20;
+    uint64 BookkeepingCycles = (BlockCycles > 2 * ClockCycles) ? (BlockCycles - 2 * ClockCycles) : 0;
+    printf("profiler\n");
+    printf("  empty block %llu cycles in all: 2 x __rdtsc at %llu, plus %llu of bookkeeping\n",
+            (unsigned long long)BlockCycles, (unsigned long long)ClockCycles, (unsigned long long)BookkeepingCycles);
+    printf("  budget %llu cycles of bookkeeping on top of the clock reads, so %llu cycles a block on this machine\n",
+            (unsigned long long)BlockBudgetCycles, (unsigned long long)(2 * ClockCycles + BlockBudgetCycles));
+    if (BookkeepingCycles > BlockBudgetCycles)
+    {
+        fprintf(stderr, "a timed block costs more than the budget\n");
+        Result = false;
+    }
+
+    linux_state LinuxState = {};
+    LinuxGetEXEFileName(&LinuxState);
+    char TraceFileName[LINUX_STATE_FILE_NAME_COUNT];
+    LinuxBuildEXEPathFileName(&LinuxState, (char *)"handmade_bench_trace.json", sizeof(TraceFileName), TraceFileName);
+    if (!WriteDebugChromeTrace(State, TraceFileName) || !BenchCheckProfilerTrace(State, TraceFileName))
+    {
+        fprintf(stderr, "profiler trace %s is missing blocks or malformed\n", TraceFileName);
+        Result = false;
+    }
+    unlink(TraceFileName);
+
+    GlobalDebugTable = 0;
+    GlobalDebugThreadRing = 0;
+
+    return(Result);
+}
+
+// =====================================================================================================================
+//NOTE: Packed assets
+
+enum bench_bitmap_format
+{
+    BenchBitmap_24BottomUp,
+    BenchBitmap_32TopDown,
+    BenchBitmap_32AlphaBottomUp,
+
+    BenchBitmap_FormatCount,
+};
+
+struct bench_asset_source
+{
+    char FileName[256];
+    char Name[HMA_NAME_COUNT];
+    hma_asset_type Type;
+
+    //NOTE: What the asset should come out as, in .hma form, worked out from the generated source values rather than
+    //  from the file.
+    uint32 Width;
+    uint32 Height;
+    uint32 SampleCount;
+    uint32 ChannelCount;
+    void *Expected;
+    uint64 ExpectedSize;
+};
+
+internal bool32 BenchWriteFile(char *FileName, void *Memory, uint64 Size)
+{
+    FILE *File = fopen(FileName, "wb");
+    bool32 Result = (File != 0);
+    if (File)
+    {
+        Result = (fwrite(Memory, 1, (size_t)Size, File) == (size_t)Size);
+        Result = (fclose(File) == 0) && Result;
+    }
+    return(Result);
+}
+
+internal bool32 BenchWriteBMP(bench_asset_source *Source, bench_bitmap_format Format)
+{
+    //NOTE: The alpha format uses a V4 header and RGBA byte order, so the masks are not the usual ones.
+    uint32 Width = Source->Width;
+    uint32 Height = Source->Height;
+    uint32 BytesPerPixel = (Format == BenchBitmap_24BottomUp) ? 3 : 4;
+    uint32 HeaderSize = (Format == BenchBitmap_32AlphaBottomUp) ? 108 : 40;
+    uint32 Pitch = (Width * BytesPerPixel + 3) & ~3u;
+    uint32 BitmapOffset = 14 + HeaderSize;
+    uint64 FileSize = BitmapOffset + (uint64)Pitch * Height;
+
+    uint8 *Contents = (uint8 *)LinuxAllocateMemory((memory_index)FileSize);
+    bitmap_header *Header = (bitmap_header *)Contents;
+    Header->FileType = BITMAP_FILE_TYPE;
+    Header->FileSize = (uint32)FileSize;
+    Header->BitmapOffset = BitmapOffset;
+    Header->Size = HeaderSize;
+    Header->Width = (int32)Width;
+    Header->Height = (Format == BenchBitmap_32TopDown) ? -(int32)Height : (int32)Height;
+    Header->Planes = 1;
+    Header->BitsPerPixel = (uint16)(BytesPerPixel * 8);
+    Header->Compression = BITMAP_COMPRESSION_RGB;
+    if (Format == BenchBitmap_32AlphaBottomUp)
+    {
+        Header->Compression = BITMAP_COMPRESSION_BITFIELDS;
+        bitmap_masks *Masks = (bitmap_masks *)(Contents + 14 + 40);
+        Masks->RedMask = 0x000000FF;
+        Masks->GreenMask = 0x0000FF00;
+        Masks->BlueMask = 0x00FF0000;
+        Masks->AlphaMask = 0xFF000000;
+    }
+
+    uint32 *Expected = (uint32 *)Source->Expected;
+    for (uint32 Y = 0; Y < Height; ++Y)
+    {
+        uint32 FileY = (Format == BenchBitmap_32TopDown) ? Y : (Height - 1 - Y);
+        uint8 *Row = Contents + BitmapOffset + (uint64)FileY * Pitch;
+        for (uint32 X = 0; X < Width; ++X)
+        {
+            uint32 Random = BenchRandom();
+            uint32 Red = (Random >> 0) & 0xFF;
+            uint32 Green = (Random >> 8) & 0xFF;
+            uint32 Blue = (Random >> 16) & 0xFF;
+            uint32 Alpha = (Random >> 24) & 0xFF;
+
+            uint8 *Pixel = Row + X * BytesPerPixel;
+            if (Format == BenchBitmap_32AlphaBottomUp)
+            {
+                Pixel[0] = (uint8)Red;
+                Pixel[1] = (uint8)Green;
+                Pixel[2] = (uint8)Blue;
+                Pixel[3] = (uint8)Alpha;
+
+                //NOTE: Round to nearest, independently of the packer's integer trick.
+                Red = (uint32)((real32)(Red * Alpha) / 255.0f + 0.5f);
+                Green = (uint32)((real32)(Green * Alpha) / 255.0f + 0.5f);
+                Blue = (uint32)((real32)(Blue * Alpha) / 255.0f + 0.5f);
+            }
+            else
+            {
+                //NOTE: Plain 32-bit has a fourth byte that means nothing; junk in it must not turn into alpha.
+                Pixel[0] = (uint8)Blue;
+                Pixel[1] = (uint8)Green;
+                Pixel[2] = (uint8)Red;
+                if (BytesPerPixel == 4)
+                {
+                    Pixel[3] = (uint8)Alpha;
+                }
+                Alpha = 255;
+            }
+            Expected[Y * Width + X] = (Alpha << 24) | (Red << 16) | (Green << 8) | (Blue << 0);
+        }
+    }
+
+    bool32 Result = BenchWriteFile(Source->FileName, Contents, FileSize);
+    munmap(Contents, (memory_index)FileSize);
+    return(Result);
+}
+
+internal bool32 BenchWriteWAV(bench_asset_source *Source, bool32 OddChunk)
+{
+    //NOTE: An odd-sized chunk in front of the data makes the loader deal with chunk padding.
+    uint32 ChannelCount = Source->ChannelCount;
+    uint32 DataSize = Source->SampleCount * ChannelCount * sizeof(int16);
+    uint32 ExtraChunkSize = OddChunk ? 7 : 0;
+    uint32 ExtraSize = OddChunk ? (uint32)sizeof(wave_chunk) + ExtraChunkSize + 1 : 0;
+    uint64 FileSize = sizeof(wave_header) + sizeof(wave_chunk) + sizeof(wave_fmt) + ExtraSize +
+            sizeof(wave_chunk) + DataSize;
+
+    uint8 *Contents = (uint8 *)LinuxAllocateMemory((memory_index)FileSize);
+    uint8 *At = Contents;
+
+    wave_header *Header = (wave_header *)At;
+    Header->RIFFID = RIFF_CODE('R', 'I', 'F', 'F');
+    Header->Size = (uint32)(FileSize - 8);
+    Header->WAVEID = RIFF_CODE('W', 'A', 'V', 'E');
+    At += sizeof(wave_header);
+
+    wave_chunk *Chunk = (wave_chunk *)At;
+    Chunk->ID = RIFF_CODE('f', 'm', 't', ' ');
+    Chunk->Size = sizeof(wave_fmt);
+    At += sizeof(wave_chunk);
+
+    wave_fmt *Format = (wave_fmt *)At;
+    Format->wFormatTag = WAVE_FORMAT_PCM;
+    Format->nChannels = (uint16)ChannelCount;
+    Format->nSamplesPerSec = 48000;
+    Format->nAvgBytesPerSec = 48000 * ChannelCount * sizeof(int16);
+    Format->nBlockAlign = (uint16)(ChannelCount * sizeof(int16));
+    Format->wBitsPerSample = 16;
+    At += sizeof(wave_fmt);
+
+    if (OddChunk)
+    {
+        Chunk = (wave_chunk *)At;
+        Chunk->ID = RIFF_CODE('L', 'I', 'S', 'T');
+        Chunk->Size = ExtraChunkSize;
+        At += sizeof(wave_chunk) + ExtraChunkSize + 1;
+    }
+
+    Chunk = (wave_chunk *)At;
+    Chunk->ID = RIFF_CODE('d', 'a', 't', 'a');
+    Chunk->Size = DataSize;
+    At += sizeof(wave_chunk);
+
+    int16 *Interleaved = (int16 *)At;
+    int16 *Expected = (int16 *)Source->Expected;
+    for (uint32 SampleIndex = 0; SampleIndex < Source->SampleCount; ++SampleIndex)
+    {
+        for (uint32 ChannelIndex = 0; ChannelIndex < ChannelCount; ++ChannelIndex)
+        {
+            int16 Sample = (int16)BenchRandom();
+            memcpy(Interleaved + SampleIndex * ChannelCount + ChannelIndex, &Sample, sizeof(Sample));
+            Expected[ChannelIndex * Source->SampleCount + SampleIndex] = Sample;
+        }
+    }
+
+    bool32 Result = BenchWriteFile(Source->FileName, Contents, FileSize);
+    munmap(Contents, (memory_index)FileSize);
+    return(Result);
+}
+
+internal void *BenchNaiveLoadAsset(bench_asset_source *Source)
+{
+    //NOTE: What loading looks like without the packer: open, read and decode every file on its own.
+    void *Result = 0;
+    entire_file File = ReadEntireFile(Source->FileName);
+    if (File.Contents)
+    {
+        if (Source->Type == HMAAsset_Bitmap)
+        {
+            packer_bitmap Bitmap;
+            if (LoadBMP(&File, &Bitmap, Source->FileName))
+            {
+                Result = Bitmap.Pixels;
+            }
+        }
+        else
+        {
+            packer_sound Sound;
+            if (LoadWAV(&File, &Sound, Source->FileName))
+            {
+                Result = Sound.Samples;
+            }
+        }
+        FreeEntireFile(&File);
+    }
+    return(Result);
+}
+
+internal uint64 BenchTouchMemory(void *Memory, uint64 Size)
+{
+    //NOTE: Reads every byte so every page of the mapping actually gets faulted in.
+    uint64 Result = 0;
+    uint8 *Bytes = (uint8 *)Memory;
+    for (uint64 Offset = 0; (Offset + 8) <= Size; Offset += 8)
+    {
+        uint64 Value;
+        memcpy(&Value, Bytes + Offset, sizeof(Value));
+        Result += Value;
+    }
+    for (uint64 Offset = Size & ~(uint64)7; Offset < Size; ++Offset)
+    {
+        Result += Bytes[Offset];
+    }
+    return(Result);
+}
+
+struct bench_asset_set
+{
+    char Directory[64];
+    char PackFileName[128];
+
+    int SourceCount;
+    int BitmapCount;
+    uint64 SourceBytes;
+    bench_asset_source *Sources;
+    char **SourceFileNames;
+};
+
+internal bool32 BenchCreateAssetSet(bench_asset_set *Set, int SourceCount)
+{
+    //NOTE: Two in three are bitmaps, in all the formats the packer reads; the rest are sounds, mono and stereo. The
+    //  files go in a fresh temporary directory, which BenchDestroyAssetSet takes away again.
+    *Set = {};
+    snprintf(Set->Directory, sizeof(Set->Directory), "/tmp/handmade_bench_assets_XXXXXX");
+    if (!mkdtemp(Set->Directory))
+    {
+        fprintf(stderr, "couldn't make a temporary directory for the asset files\n");
+        return(false);
+    }
+    snprintf(Set->PackFileName, sizeof(Set->PackFileName), "%s/bench.hma", Set->Directory);
+
+    Set->SourceCount = SourceCount;
+    Set->Sources = (bench_asset_source *)LinuxAllocateMemory(SourceCount * sizeof(bench_asset_source));
+    Set->SourceFileNames = (char **)LinuxAllocateMemory(SourceCount * sizeof(char *));
+
+    bool32 Result = true;
+    for (int SourceIndex = 0; Result && (SourceIndex < SourceCount); ++SourceIndex)
+    {
+        bench_asset_source *Source = Set->Sources + SourceIndex;
+        if ((SourceIndex % 3) != 2)
+        {
+            Source->Type = HMAAsset_Bitmap;
+            Source->Width = (uint32)BenchRandomBetween(1, 256);
+            Source->Height = (uint32)BenchRandomBetween(1, 256);
+            Source->ExpectedSize = (uint64)Source->Width * Source->Height * sizeof(uint32);
+            snprintf(Source->Name, sizeof(Source->Name), "bitmap_%03d", SourceIndex);
+            snprintf(Source->FileName, sizeof(Source->FileName), "%s/%s.bmp", Set->Directory, Source->Name);
+            Source->Expected = LinuxAllocateMemory((memory_index)Source->ExpectedSize);
+            Result = BenchWriteBMP(Source, (bench_bitmap_format)(Set->BitmapCount % BenchBitmap_FormatCount));
+            ++Set->BitmapCount;
+        }
+        else
+        {
+            Source->Type = HMAAsset_Sound;
+            Source->SampleCount = (uint32)BenchRandomBetween(1, 48000);
+            Source->ChannelCount = (uint32)BenchRandomBetween(1, 2);
+            Source->ExpectedSize = (uint64)Source->SampleCount * Source->ChannelCount * sizeof(int16);
+            snprintf(Source->Name, sizeof(Source->Name), "sound_%03d", SourceIndex);
+            snprintf(Source->FileName, sizeof(Source->FileName), "%s/%s.WAV", Set->Directory, Source->Name);
+            Source->Expected = LinuxAllocateMemory((memory_index)Source->ExpectedSize);
+            Result = BenchWriteWAV(Source, (SourceIndex % 2));
+        }
+        Set->SourceFileNames[SourceIndex] = Source->FileName;
+        Set->SourceBytes += Source->ExpectedSize;
+    }
+
+    if (!Result)
+    {
+        fprintf(stderr, "couldn't write the asset sources to %s\n", Set->Directory);
+    }
+    return(Result);
+}
+
+internal void BenchDestroyAssetSet(bench_asset_set *Set)
+{
+    for (int SourceIndex = 0; SourceIndex < Set->SourceCount; ++SourceIndex)
+    {
+        bench_asset_source *Source = Set->Sources + SourceIndex;
+        unlink(Source->FileName);
+        if (Source->Expected)
+        {
+            munmap(Source->Expected, (memory_index)Source->ExpectedSize);
+        }
+    }
+    unlink(Set->PackFileName);
+    rmdir(Set->Directory);
+    munmap(Set->Sources, Set->SourceCount * sizeof(bench_asset_source));
+    munmap(Set->SourceFileNames, Set->SourceCount * sizeof(char *));
+    *Set = {};
+}
+
+internal BENCH_FUNCTION(BenchAssets)
+{
+    //NOTE: A few hundred small, mixed assets, about what a level would load.
+    bench_asset_set Set;
+    bool32 Result = BenchCreateAssetSet(&Set, 300);
+    int SourceCount = Set.SourceCount;
+    bench_asset_source *Sources = Set.Sources;
+    char *PackFileName = Set.PackFileName;
+    void **Loaded = (void **)LinuxAllocateMemory(SourceCount * sizeof(void *));
+
+    uint64 PackStart = LinuxGetWallClock();
+    Result = Result && PackAssets(PackFileName, SourceCount, Set.SourceFileNames);
+    real64 PackMS = LinuxGetMSElapsed(PackStart, LinuxGetWallClock());
+
+    platform_api PlatformAPI = {};
+    PlatformAPI.MapFile = LinuxMapFile;
+    PlatformAPI.UnmapFile = LinuxUnmapFile;
+
+    //NOTE: Both ways in have to hand back exactly what was generated.
+    asset_file File = {};
+    if (Result && !OpenAssetFile(&File, &PlatformAPI, PackFileName))
+    {
+        fprintf(stderr, "%s didn't pass validation\n", PackFileName);
+        Result = false;
+    }
+    uint64 PackSize = File.Mapping.Size;
+    for (int SourceIndex = 0; Result && (SourceIndex < SourceCount); ++SourceIndex)
+    {
+        bench_asset_source *Source = Sources + SourceIndex;
+        asset_id ID = FindAsset(&File, Source->Name, Source->Type);
+
+        void *Mapped = 0;
+        if (Source->Type == HMAAsset_Bitmap)
+        {
+            loaded_bitmap Bitmap;
+            if (GetBitmap(&File, ID, &Bitmap) && ((uint32)Bitmap.Width == Source->Width) &&
+                    ((uint32)Bitmap.Height == Source->Height) && (Bitmap.Pitch == Bitmap.Width * 4))
+            {
+                Mapped = Bitmap.Memory;
+            }
+        }
+        else
+        {
+            loaded_sound Sound;
+            if (GetSound(&File, ID, &Sound) && (Sound.SampleCount == Source->SampleCount) &&
+                    (Sound.ChannelCount == Source->ChannelCount) &&
+                    ((Sound.ChannelCount == 1) || (Sound.Samples[1] == Sound.Samples[0] + Sound.SampleCount)))
+            {
+                Mapped = Sound.Samples[0];
+            }
+        }
+
+        void *Naive = BenchNaiveLoadAsset(Source);
+        bool32 MappedMatches = (Mapped && (((memory_index)Mapped % HMA_DATA_ALIGNMENT) == 0) &&
+                (memcmp(Mapped, Source->Expected, (size_t)Source->ExpectedSize) == 0));
+        bool32 NaiveMatches = (Naive && (memcmp(Naive, Source->Expected, (size_t)Source->ExpectedSize) == 0));
+        if (!MappedMatches || !NaiveMatches)
+        {
+            fprintf(stderr, "%s: %s load doesn't match what was written\n", Source->FileName,
+                    MappedMatches ? "per-file" : "packed");
+            Result = false;
+        }
+        free(Naive);
+    }
+    if (Result)
+    {
+        CloseAssetFile(&File, &PlatformAPI);
+        asset_id Missing = FindAsset(&File, Sources[0].Name, HMAAsset_Bitmap);
+        if (Missing)
+        {
+            fprintf(stderr, "a closed asset file still found assets\n");
+            Result = false;
+        }
+    }
+
+    if (Result)
+    {
+        //NOTE: Everything was just written, so the page cache is warm for both; this is the cost of the loading
+        //  itself, not of the disk. The mapped runs remap the file every time, so they still pay for the page faults.
+        bench_timer NaiveTimer;
+        bench_timer MapTimer;
+        bench_timer TouchTimer;
+        BenchBeginRepeat(&NaiveTimer);
+        BenchBeginRepeat(&MapTimer);
+        BenchBeginRepeat(&TouchTimer);
+        uint64 Checksum = 0;
+        for (int Repeat = 0; Repeat < 10; ++Repeat)
+        {
+            uint64 Start = LinuxGetWallClock();
+            for (int SourceIndex = 0; SourceIndex < SourceCount; ++SourceIndex)
+            {
+                Loaded[SourceIndex] = BenchNaiveLoadAsset(Sources + SourceIndex);
+            }
+            BenchAddRepeat(&NaiveTimer, Start, LinuxGetWallClock());
+            for (int SourceIndex = 0; SourceIndex < SourceCount; ++SourceIndex)
+            {
+                free(Loaded[SourceIndex]);
+            }
+
+            for (int Touch = 0; Touch < 2; ++Touch)
+            {
+                Start = LinuxGetWallClock();
+                OpenAssetFile(&File, &PlatformAPI, PackFileName);
+                for (int SourceIndex = 0; SourceIndex < SourceCount; ++SourceIndex)
+                {
+                    bench_asset_source *Source = Sources + SourceIndex;
+                    asset_id ID = FindAsset(&File, Source->Name, Source->Type);
+                    if (Source->Type == HMAAsset_Bitmap)
+                    {
+                        loaded_bitmap Bitmap;
+                        GetBitmap(&File, ID, &Bitmap);
+                        Loaded[SourceIndex] = Bitmap.Memory;
+                    }
+                    else
+                    {
+                        loaded_sound Sound;
+                        GetSound(&File, ID, &Sound);
+                        Loaded[SourceIndex] = Sound.Samples[0];
+                    }
+
+                    if (Touch)
+                    {
+                        Checksum += BenchTouchMemory(Loaded[SourceIndex], Source->ExpectedSize);
+                    }
+                }
+                BenchAddRepeat(Touch ? &TouchTimer : &MapTimer, Start, LinuxGetWallClock());
+                CloseAssetFile(&File, &PlatformAPI);
+            }
+        }
+
+        printf("assets (%d sources: %d bitmaps, %d sounds, %.01fMB of pixels and samples)\n", SourceCount,
+                Set.BitmapCount, SourceCount - Set.BitmapCount, (real64)Set.SourceBytes / (1024.0 * 1024.0));
+        printf("  pack %.03fms -> %.01fMB\n", PackMS, (real64)PackSize / (1024.0 * 1024.0));
+        printf("  per-file read + decode    best %8.03fms  avg %8.03fms\n", NaiveTimer.MinMS,
+                BenchAverageMS(&NaiveTimer));
+        printf("  map + views               best %8.03fms  avg %8.03fms  (%.0fx)\n", MapTimer.MinMS,
+                BenchAverageMS(&MapTimer), NaiveTimer.MinMS / MapTimer.MinMS);
+        printf("  map + views + touch all   best %8.03fms  avg %8.03fms  (%.01fx)  [checksum %llx]\n",
+                TouchTimer.MinMS, BenchAverageMS(&TouchTimer), NaiveTimer.MinMS / TouchTimer.MinMS,
+                (unsigned long long)Checksum);
+    }
+
+    BenchDestroyAssetSet(&Set);
+    munmap(Loaded, SourceCount * sizeof(void *));
+
+    return(Result);
+}
+
+// =====================================================================================================================
+//NOTE: Asset streaming
+
+internal uint64 BenchGetThreadPageFaults(uint64 *MinorFaults)
+{
+    //NOTE: Major faults are the ones that had to wait for the disk.
+    rusage Usage;
+    getrusage(RUSAGE_THREAD, &Usage);
+    *MinorFaults = (uint64)Usage.ru_minflt;
+    return((uint64)Usage.ru_majflt);
+}
+
+internal void BenchDropFileCache(char *FileName)
+{
+    //NOTE: Best effort at making the loads come off the disk. Pages that are still dirty can't be dropped, so write
+    //  them back first.
+    int FileHandle = open(FileName, O_RDONLY);
+    if (FileHandle >= 0)
+    {
+        fdatasync(FileHandle);
+        posix_fadvise(FileHandle, 0, 0, POSIX_FADV_DONTNEED);
+        close(FileHandle);
+    }
+}
+
+internal BENCH_FUNCTION(BenchStreaming)
+{
+    bench_asset_set Set;
+    bool32 Result = (BenchCreateAssetSet(&Set, 300) &&
+            PackAssets(Set.PackFileName, Set.SourceCount, Set.SourceFileNames));
+
+    platform_api PlatformAPI = {};
+    PlatformAPI.MapFile = LinuxMapFile;
+    PlatformAPI.UnmapFile = LinuxUnmapFile;
+    asset_file File = {};
+    if (Result && !OpenAssetFile(&File, &PlatformAPI, Set.PackFileName))
+    {
+        fprintf(stderr, "%s didn't pass validation\n", Set.PackFileName);
+        Result = false;
+    }
+    if (!Result)
+    {
+        BenchDestroyAssetSet(&Set);
+        return(false);
+    }
+
+    //NOTE: Validating the file already brought the asset table in; only the asset data should be cold.
+    BenchDropFileCache(Set.PackFileName);
+
+    //NOTE: Leaked on purpose, like every other bench queue.
+    platform_work_queue *LoadQueue = (platform_work_queue *)LinuxAllocateMemory(sizeof(platform_work_queue));
+    LinuxMakeQueue(LoadQueue, 1);
+    Platform.AddEntry = LinuxAddEntry;
+    Platform.CompleteAllWork = LinuxCompleteAllWork;
+
+    //NOTE: A quarter of what it would take to hold everything, so the sliding working set below keeps evicting.
+    memory_index CacheSize = GetAssetCacheSizeForAll(&File) / 4;
+    memory_index ArenaSize = CacheSize + Set.SourceCount * sizeof(asset_slot) + Kilobytes(64);
+    memory_arena Arena;
+    InitializeArena(&Arena, (char *)"AssetCache", ArenaSize, LinuxAllocateMemory(ArenaSize));
+    game_assets *Assets = PushStruct(&Arena, game_assets, 64);
+    InitializeGameAssets(Assets, &File, LoadQueue, &Arena, CacheSize);
+
+    asset_id *IDs = PushArray(&Arena, Set.SourceCount, asset_id);
+    for (int SourceIndex = 0; SourceIndex < Set.SourceCount; ++SourceIndex)
+    {
+        IDs[SourceIndex] = FindAsset(&File, Set.Sources[SourceIndex].Name, Set.Sources[SourceIndex].Type);
+    }
+
+    //NOTE: Each frame asks for a handful of assets out of a window that slides through the whole file. The sleep
+    //  stands in for the rest of the frame and the wait for the flip, which is when the load thread gets to run.
+    int FrameCount = 600;
+    int RequestsPerFrame = 16;
+    int WorkingSetSize = 48;
+    uint64 RequestCount = 0;
+    uint64 PlaceholderCount = 0;
+    uint64 MismatchCount = 0;
+    uint64 FrameMajorFaults = 0;
+    uint64 FrameMinorFaults = 0;
+    real64 MaxRequestMS = 0.0;
+    bench_timer RequestTimer;
+    BenchBeginRepeat(&RequestTimer);
+    uint64 RunStartCycles = __rdtsc();
+    uint64 RunStart = LinuxGetWallClock();
+    for (int FrameIndex = 0; FrameIndex < FrameCount; ++FrameIndex)
+    {
+        void *Returned[64];
+        int Picked[64];
+        Assert(RequestsPerFrame <= (int)ArrayCount(Returned));
+        int WindowStart = FrameIndex / 2;
+        for (int RequestIndex = 0; RequestIndex < RequestsPerFrame; ++RequestIndex)
+        {
+            Picked[RequestIndex] = (WindowStart + (int)(BenchRandom() % (uint32)WorkingSetSize)) % Set.SourceCount;
+        }
+
+        uint64 MinorBefore;
+        uint64 MajorBefore = BenchGetThreadPageFaults(&MinorBefore);
+        uint64 Start = LinuxGetWallClock();
+
+        BeginAssetFrame(Assets);
+        for (int RequestIndex = 0; RequestIndex < RequestsPerFrame; ++RequestIndex)
+        {
+            int SourceIndex = Picked[RequestIndex];
+            if (Set.Sources[SourceIndex].Type == HMAAsset_Bitmap)
+            {
+                loaded_bitmap *Bitmap = RequestBitmap(Assets, IDs[SourceIndex]);
+                Returned[RequestIndex] = Bitmap ? Bitmap->Memory : 0;
+            }
+            else
+            {
+                loaded_sound *Sound = RequestSound(Assets, IDs[SourceIndex]);
+                Returned[RequestIndex] = Sound ? Sound->Samples[0] : 0;
+            }
+        }
+
+        uint64 End = LinuxGetWallClock();
+        uint64 MinorAfter;
+        uint64 MajorAfter = BenchGetThreadPageFaults(&MinorAfter);
+        FrameMajorFaults += MajorAfter - MajorBefore;
+        FrameMinorFaults += MinorAfter - MinorBefore;
+        BenchAddRepeat(&RequestTimer, Start, End);
+        real64 RequestMS = LinuxGetMSElapsed(Start, End);
+        if (RequestMS > MaxRequestMS)
+        {
+            MaxRequestMS = RequestMS;
+        }
+
+        //NOTE: Whatever did come back has to be the whole asset, not something still being copied in.
+        for (int RequestIndex = 0; RequestIndex < RequestsPerFrame; ++RequestIndex)
+        {
+            bench_asset_source *Source = Set.Sources + Picked[RequestIndex];
+            ++RequestCount;
+            if (!Returned[RequestIndex])
+            {
+                ++PlaceholderCount;
+            }
+            else if (memcmp(Returned[RequestIndex], Source->Expected, (size_t)Source->ExpectedSize) != 0)
+            {
+                ++MismatchCount;
+            }
+        }
+        if (Assets->MemoryUsed > Assets->MemorySize)
+        {
+            fprintf(stderr, "asset cache is using %llu bytes of a %llu byte budget\n",
+                    (unsigned long long)Assets->MemoryUsed, (unsigned long long)Assets->MemorySize);
+            Result = false;
+            break;
+        }
+
+        usleep(1000);
+    }
+
+    //NOTE: Nothing can be left queued when the mapping goes away.
+    LinuxCompleteAllWork(LoadQueue);
+    BeginAssetFrame(Assets);
+
+    //NOTE: Loads are timed in cycles on the load thread; the run itself tells us how many of those go in a ms.
+    real64 CyclesPerMS = (real64)(__rdtsc() - RunStartCycles) / LinuxGetMSElapsed(RunStart, LinuxGetWallClock());
+    asset_cache_stats *Stats = &Assets->Stats;
+    real64 AverageLoadMS = 0.0;
+    if (Stats->LoadsCompleted)
+    {
+        AverageLoadMS = ((real64)Stats->LoadCycles / (real64)Stats->LoadsCompleted) / CyclesPerMS;
+    }
+
+    printf("streaming (%d assets, %.01fMB cache for %.01fMB of data, 1 load thread)\n", Set.SourceCount,
+            (real64)CacheSize / (1024.0 * 1024.0), (real64)Set.SourceBytes / (1024.0 * 1024.0));
+    printf("  %d frames x %d requests: %llu hits, %llu misses (%.01f%% hit rate), %llu evictions, %llu deferred\n",
+            FrameCount, RequestsPerFrame, (unsigned long long)Stats->Hits, (unsigned long long)Stats->Misses,
+            100.0 * (real64)Stats->Hits / (real64)(RequestCount ? RequestCount : 1),
+            (unsigned long long)Stats->Evictions, (unsigned long long)Stats->RequestsDeferred);
+    printf("  load thread: %llu loads, %.01fMB, avg %.03fms per load\n", (unsigned long long)Stats->LoadsCompleted,
+            (real64)Stats->BytesLoaded / (1024.0 * 1024.0), AverageLoadMS);
+    printf("  frame thread: requests avg %.03fms  max %.03fms per frame, %llu major / %llu minor page faults, "
+            "%llu loads run on it\n", BenchAverageMS(&RequestTimer), MaxRequestMS,
+            (unsigned long long)FrameMajorFaults, (unsigned long long)FrameMinorFaults,
+            (unsigned long long)Stats->LoadsOnFrameThread);
+
+    if (Result && ((Stats->Hits + Stats->Misses) != RequestCount || (Stats->Misses != PlaceholderCount)))
+    {
+        fprintf(stderr, "asset cache counted %llu hits and %llu misses for %llu requests (%llu placeholders)\n",
+                (unsigned long long)Stats->Hits, (unsigned long long)Stats->Misses,
+                (unsigned long long)RequestCount, (unsigned long long)PlaceholderCount);
+        Result = false;
+    }
+    if (Result && MismatchCount)
+    {
+        fprintf(stderr, "%llu requests returned assets that don't match the source\n",
+                (unsigned long long)MismatchCount);
+        Result = false;
+    }
+    if (Result && (Stats->LoadsOnFrameThread || FrameMajorFaults))
+    {
+        fprintf(stderr, "the frame thread waited on the disk\n");
+        Result = false;
+    }
+    if (Result && (!Stats->Hits || !Stats->Evictions || (Stats->LoadsCompleted != Stats->LoadsQueued)))
+    {
+        fprintf(stderr, "the stress run didn't exercise the cache: %llu hits, %llu evictions, %llu of %llu loads\n",
+                (unsigned long long)Stats->Hits, (unsigned long long)Stats->Evictions,
+                (unsigned long long)Stats->LoadsCompleted, (unsigned long long)Stats->LoadsQueued);
+        Result = false;
+    }
+
+    //NOTE: Everything still resident at the end has to be intact too, and the allocator has to add up.
+    memory_index ResidentSize = 0;
+    for (int SourceIndex = 0; Result && (SourceIndex < Set.SourceCount); ++SourceIndex)
+    {
+        asset_slot *Slot = Assets->Slots + (IDs[SourceIndex] - 1);
+        if (Slot->State == AssetState_Loaded)
+        {
+            bench_asset_source *Source = Set.Sources + SourceIndex;
+            void *Memory = GetAssetBlockMemory(Slot->Block);
+            ResidentSize += Slot->Block->Size;
+            if (memcmp(Memory, Source->Expected, (size_t)Source->ExpectedSize) != 0)
+            {
+                fprintf(stderr, "%s was corrupted while resident\n", Source->Name);
+                Result = false;
+            }
+        }
+    }
+    if (Result && (ResidentSize != Assets->MemoryUsed))
+    {
+        fprintf(stderr, "asset cache thinks %llu bytes are used, the resident assets add up to %llu\n",
+                (unsigned long long)Assets->MemoryUsed, (unsigned long long)ResidentSize);
+        Result = false;
+    }
+
+    CloseAssetFile(&File, &PlatformAPI);
+    munmap(Arena.Base, Arena.Size);
+    BenchDestroyAssetSet(&Set);
+
+    return(Result);
+}
+
+// =====================================================================================================================
+//NOTE: Sprite blitter
+
+internal loaded_bitmap BenchMakeSprite(int Width, int Height, int PitchPadding, int TransparentPercent)
+{
+    //NOTE: Random premultiplied texels: some fully transparent, some opaque, the rest anywhere in between.
+    loaded_bitmap Result = {};
+    Result.Width = Width;
+    Result.Height = Height;
+    Result.Pitch = Width * 4 + PitchPadding;
+    Result.Memory = LinuxAllocateMemory(Result.Pitch * Height);
+    for (int Y = 0; Y < Height; ++Y)
+    {
+        uint32 *Texel = (uint32 *)((uint8 *)Result.Memory + Y * Result.Pitch);
+        for (int X = 0; X < Width; ++X)
+        {
+            uint32 Roll = BenchRandom() % 100;
+            uint32 Alpha = (Roll < (uint32)TransparentPercent) ? 0 : ((Roll < 70) ? 255 : (BenchRandom() & 0xFF));
+            uint32 Color = BenchRandom();
+            uint32 R = MultiplyDivide255((Color >> 16) & 0xFF, Alpha);
+            uint32 G = MultiplyDivide255((Color >> 8) & 0xFF, Alpha);
+            uint32 B = MultiplyDivide255((Color >> 0) & 0xFF, Alpha);
+            *Texel++ = (Alpha << 24) | (R << 16) | (G << 8) | B;
+        }
+    }
+    return(Result);
+}
+
+internal void BenchFreeSprite(loaded_bitmap *Bitmap)
+{
+    munmap(Bitmap->Memory, Bitmap->Pitch * Bitmap->Height);
+    Bitmap->Memory = 0;
+}
+
+// =====================================================================================================================
+
+internal bool32 BenchCheckBlendReference(void)
+{
+    //NOTE: The scalar per-pixel math against the same formulas in double precision, so the reference the SIMD
+    //  kernels are held to is itself right.
+    for (uint32 A = 0; A < 256; ++A)
+    {
+        for (uint32 B = 0; B < 256; ++B)
+        {
+            uint32 Expected = (uint32)floor((real64)(A * B) / 255.0 + 0.5);
+            if (MultiplyDivide255(A, B) != Expected)
+            {
+                fprintf(stderr, "MultiplyDivide255(%u, %u) is %u, should be %u\n", A, B, MultiplyDivide255(A, B),
+                        Expected);
+                return(false);
+            }
+        }
+    }
+
+    for (int Trial = 0; Trial < 100000; ++Trial)
+    {
+        uint32 Alpha = BenchRandom() & 0xFF;
+        uint32 Source = Alpha << 24;
+        for (int Shift = 0; Shift < 24; Shift += 8)
+        {
+            Source |= MultiplyDivide255(BenchRandom() & 0xFF, Alpha) << Shift;
+        }
+        uint32 Dest = BenchRandom();
+
+        uint32 Blended = BlendPixel(Dest, Source, BlendMode_AlphaBlend);
+        uint32 BlendedSRGB = BlendPixel(Dest, Source, BlendMode_AlphaBlendSRGB);
+        uint32 Tested = BlendPixel(Dest, Source, BlendMode_AlphaTest);
+        if (Tested != ((Alpha >= 128) ? Source : Dest))
+        {
+            fprintf(stderr, "alpha test of %08x over %08x gave %08x\n", Source, Dest, Tested);
+            return(false);
+        }
+
+        real64 InvAlpha = 1.0 - (real64)Alpha / 255.0;
+        for (int Shift = 0; Shift < 32; Shift += 8)
+        {
+            real64 S = (real64)((Source >> Shift) & 0xFF);
+            real64 D = (real64)((Dest >> Shift) & 0xFF);
+
+            int Expected = (int)floor(S + D * InvAlpha + 0.5);
+            int Actual = (int)((Blended >> Shift) & 0xFF);
+            if (Actual != Expected)
+            {
+                fprintf(stderr, "blend of %08x over %08x gave %08x\n", Source, Dest, Blended);
+                return(false);
+            }
+
+            real64 Linear = (Shift == 24) ? (S + D * InvAlpha) :
+                255.0 * sqrt((S / 255.0) * (S / 255.0) + (D / 255.0) * (D / 255.0) * InvAlpha);
+            int ActualSRGB = (int)((BlendedSRGB >> Shift) & 0xFF);
+            if (fabs((real64)ActualSRGB - Linear) > 0.51)
+            {
+                fprintf(stderr, "sRGB blend of %08x over %08x gave %08x\n", Source, Dest, BlendedSRGB);
+                return(false);
+            }
+        }
+    }
+
+    return(true);
+}
+
+// =====================================================================================================================
+
+internal uint64 BenchSumChannel(game_offscreen_buffer *Buffer, int Shift)
+{
+    uint64 Result = 0;
+    for (int Y = 0; Y < Buffer->Height; ++Y)
+    {
+        uint32 *Pixel = (uint32 *)((uint8 *)Buffer->Memory + Y * Buffer->Pitch);
+        for (int X = 0; X < Buffer->Width; ++X)
+        {
+            Result += (Pixel[X] >> Shift) & 0xFF;
+        }
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 BenchCheckSpritePlacement(void)
+{
+    //NOTE: Runs on whatever level is active; BenchCheckSpriteKernels holds the others to it afterwards.
+    game_offscreen_buffer Buffer = BenchAllocateBuffer(64, 48, 12);
+    bool32 Result = true;
+
+    //NOTE: Rectangle edges land on the nearest pixel boundary.
+    BenchFillBytes(&Buffer, 0);
+    color4 White = {1.0f, 1.0f, 1.0f, 1.0f};
+    DrawRectangle(&Buffer, 0.4f, 0.6f, 2.5f, 2.49f, White, false);
+    for (int Y = 0; Y < 4; ++Y)
+    {
+        uint32 *Pixel = (uint32 *)((uint8 *)Buffer.Memory + Y * Buffer.Pitch);
+        for (int X = 0; X < 4; ++X)
+        {
+            uint32 Expected = ((Y == 1) && (X < 2)) ? 0xFFFFFFFF : 0;
+            if (Pixel[X] != Expected)
+            {
+                fprintf(stderr, "rectangle snapping: pixel %d,%d is %08x, should be %08x\n", X, Y, Pixel[X],
+                        Expected);
+                Result = false;
+            }
+        }
+    }
+
+    //NOTE: An opaque white sprite dropped anywhere on black spreads its coverage over the pixels it straddles, but
+    //  the total stays what it was, give or take the rounding in each filter pass.
+    loaded_bitmap Sprite = BenchMakeSprite(5, 3, 8, 0);
+    for (int Y = 0; Y < Sprite.Height; ++Y)
+    {
+        for (int X = 0; X < Sprite.Width; ++X)
+        {
+            *(uint32 *)((uint8 *)Sprite.Memory + Y * Sprite.Pitch + X * 4) = 0xFFFFFFFF;
+        }
+    }
+    for (int Trial = 0; Result && (Trial < 1000); ++Trial)
+    {
+        real32 X = 10.0f + (real32)(BenchRandom() % 4096) / 256.0f;
+        real32 Y = 10.0f + (real32)(BenchRandom() % 4096) / 256.0f;
+        BenchFillBytes(&Buffer, 0);
+        DrawBitmap(&Buffer, &Sprite, X, Y, BlendMode_AlphaBlend);
+
+        int64 Expected = 255 * Sprite.Width * Sprite.Height;
+        int64 Actual = (int64)BenchSumChannel(&Buffer, 8);
+        int64 Tolerance = (Sprite.Width + 1) * (Sprite.Height + 1);
+        if ((Actual < (Expected - Tolerance)) || (Actual > (Expected + Tolerance)))
+        {
+            fprintf(stderr, "sprite at %.4f,%.4f covers %lld, should be about %lld\n", X, Y, (long long)Actual,
+                    (long long)Expected);
+            Result = false;
+        }
+
+        //NOTE: Whole-pixel positions have to copy the sprite exactly.
+        BenchFillBytes(&Buffer, 0);
+        DrawBitmap(&Buffer, &Sprite, floorf(X), floorf(Y), BlendMode_AlphaBlend);
+        if ((int64)BenchSumChannel(&Buffer, 16) != Expected)
+        {
+            fprintf(stderr, "sprite at %d,%d didn't copy exactly\n", (int)floorf(X), (int)floorf(Y));
+            Result = false;
+        }
+    }
+    BenchFreeSprite(&Sprite);
+
+    //NOTE: Clipping. Drawing through a window into a bigger buffer has to leave exactly what drawing into the whole
+    //  buffer leaves inside the window, and nothing outside it.
+    game_offscreen_buffer Whole = BenchAllocateBuffer(64, 48, 12);
+    game_offscreen_buffer Original = BenchAllocateBuffer(64, 48, 12);
+    BenchFillRandom(&Original);
+    for (int Trial = 0; Result && (Trial < 2000); ++Trial)
+    {
+        loaded_bitmap Clipped = BenchMakeSprite(BenchRandomBetween(1, 40), BenchRandomBetween(1, 30),
+                4 * BenchRandomBetween(0, 2), 30);
+        blend_mode Mode = (blend_mode)(BenchRandom() % BlendMode_Count);
+        real32 X = (real32)BenchRandomBetween(-40, 50) + (real32)(BenchRandom() % 256) / 256.0f;
+        real32 Y = (real32)BenchRandomBetween(-30, 40) + (real32)(BenchRandom() % 256) / 256.0f;
+
+        int WindowMinX = BenchRandomBetween(0, 30);
+        int WindowMinY = BenchRandomBetween(0, 20);
+        game_offscreen_buffer Window = Buffer;
+        Window.Memory = (uint8 *)Buffer.Memory + WindowMinY * Buffer.Pitch + WindowMinX * Buffer.BytesPerPixel;
+        Window.Width = BenchRandomBetween(1, Buffer.Width - WindowMinX);
+        Window.Height = BenchRandomBetween(1, Buffer.Height - WindowMinY);
+
+        memcpy(Whole.Memory, Original.Memory, Whole.Pitch * Whole.Height);
+        memcpy(Buffer.Memory, Original.Memory, Buffer.Pitch * Buffer.Height);
+        DrawBitmap(&Whole, &Clipped, X, Y, Mode);
+        DrawBitmap(&Window, &Clipped, X - (real32)WindowMinX, Y - (real32)WindowMinY, Mode);
+
+        for (int PixelY = 0; Result && (PixelY < Buffer.Height); ++PixelY)
+        {
+            uint32 *Actual = (uint32 *)((uint8 *)Buffer.Memory + PixelY * Buffer.Pitch);
+            uint32 *Drawn = (uint32 *)((uint8 *)Whole.Memory + PixelY * Whole.Pitch);
+            uint32 *Untouched = (uint32 *)((uint8 *)Original.Memory + PixelY * Original.Pitch);
+            for (int PixelX = 0; PixelX < Buffer.Width; ++PixelX)
+            {
+                bool32 Inside = ((PixelX >= WindowMinX) && (PixelX < (WindowMinX + Window.Width)) &&
+                                 (PixelY >= WindowMinY) && (PixelY < (WindowMinY + Window.Height)));
+                uint32 Expected = Inside ? Drawn[PixelX] : Untouched[PixelX];
+                if (Actual[PixelX] != Expected)
+                {
+                    fprintf(stderr, "clipped sprite: pixel %d,%d is %08x, should be %08x\n", PixelX, PixelY,
+                            Actual[PixelX], Expected);
+                    Result = false;
+                    break;
+                }
+            }
+        }
+        if (Result && (memcmp((uint8 *)Buffer.Memory + Buffer.Width * 4, (uint8 *)Original.Memory + Buffer.Width * 4,
+                        Buffer.Pitch - Buffer.Width * 4) != 0))
+        {
+            fprintf(stderr, "clipped sprite wrote into the pitch padding\n");
+            Result = false;
+        }
+        BenchFreeSprite(&Clipped);
+    }
+
+    BenchFreeBuffer(&Original);
+    BenchFreeBuffer(&Whole);
+    BenchFreeBuffer(&Buffer);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 BenchCheckSpriteKernels(render_kernel_level Level)
+{
+    //NOTE: Odd sizes, odd pitches, every sub-pixel phase and sprites hanging off every edge, so the vector loops, the
+    //  edge columns and the edge rows all get compared against the scalar kernels.
+    game_offscreen_buffer Expected = BenchAllocateBuffer(71, 37, 4);
+    game_offscreen_buffer Actual = BenchAllocateBuffer(71, 37, 4);
+    bool32 Result = true;
+
+    for (int Trial = 0; Result && (Trial < 4000); ++Trial)
+    {
+        loaded_bitmap Sprite = BenchMakeSprite(BenchRandomBetween(1, 45), BenchRandomBetween(1, 20),
+                4 * BenchRandomBetween(0, 3), 25);
+        blend_mode Mode = (blend_mode)(BenchRandom() % BlendMode_Count);
+        real32 X = (real32)BenchRandomBetween(-46, 72) + (real32)(BenchRandom() % 256) / 256.0f;
+        real32 Y = (real32)BenchRandomBetween(-21, 38) + (real32)(BenchRandom() % 256) / 256.0f;
+        if (Trial & 1)
+        {
+            X = floorf(X);
+        }
+        if (Trial & 2)
+        {
+            Y = floorf(Y);
+        }
+
+        BenchFillRandom(&Expected);
+        memcpy(Actual.Memory, Expected.Memory, Expected.Pitch * Expected.Height);
+
+        SetRenderKernelLevel(RenderKernel_Scalar);
+        DrawBitmap(&Expected, &Sprite, X, Y, Mode);
+        SetRenderKernelLevel(Level);
+        DrawBitmap(&Actual, &Sprite, X, Y, Mode);
+        if (!BenchBuffersMatch(&Expected, &Actual))
+        {
+            fprintf(stderr, "%s DrawBitmap mismatch: %dx%d at %.4f,%.4f mode %d\n", GetRenderKernelLevelName(Level),
+                    Sprite.Width, Sprite.Height, X, Y, (int)Mode);
+            Result = false;
+        }
+        BenchFreeSprite(&Sprite);
+
+        color4 Color = {(real32)(BenchRandom() % 256) / 255.0f, (real32)(BenchRandom() % 256) / 255.0f,
+            (real32)(BenchRandom() % 256) / 255.0f, (real32)(BenchRandom() % 256) / 255.0f};
+        real32 MinX = (real32)BenchRandomBetween(-10, 72) + (real32)(BenchRandom() % 256) / 256.0f;
+        real32 MinY = (real32)BenchRandomBetween(-10, 38) + (real32)(BenchRandom() % 256) / 256.0f;
+        real32 MaxX = MinX + (real32)BenchRandomBetween(0, 40);
+        real32 MaxY = MinY + (real32)BenchRandomBetween(0, 20);
+        bool32 SRGB = (Trial & 4) != 0;
+
+        SetRenderKernelLevel(RenderKernel_Scalar);
+        DrawRectangle(&Expected, MinX, MinY, MaxX, MaxY, Color, SRGB);
+        SetRenderKernelLevel(Level);
+        DrawRectangle(&Actual, MinX, MinY, MaxX, MaxY, Color, SRGB);
+        if (Result && !BenchBuffersMatch(&Expected, &Actual))
+        {
+            fprintf(stderr, "%s DrawRectangle mismatch\n", GetRenderKernelLevelName(Level));
+            Result = false;
+        }
+    }
+
+    SetRenderKernelLevel(GetBestRenderKernelLevel());
+    BenchFreeBuffer(&Expected);
+    BenchFreeBuffer(&Actual);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal BENCH_FUNCTION(BenchSprites)
+{
+    int SpriteCount = 500;
+    int SpriteSize = 64;
+
+    printf("sprites (best %s)\n", GetRenderKernelLevelName(GetBestRenderKernelLevel()));
+    SetRenderKernelLevel(RenderKernel_Scalar);
+    if (!BenchCheckBlendReference() || !BenchCheckSpritePlacement())
+    {
+        SetRenderKernelLevel(GetBestRenderKernelLevel());
+        return(false);
+    }
+    for (int LevelIndex = RenderKernel_SSE2; LevelIndex < RenderKernel_Count; ++LevelIndex)
+    {
+        render_kernel_level Level = (render_kernel_level)LevelIndex;
+        if (IsRenderKernelLevelSupported(Level) && !BenchCheckSpriteKernels(Level))
+        {
+            return(false);
+        }
+    }
+
+    game_offscreen_buffer Buffer = BenchAllocateBuffer(1920, 1080, 0);
+    loaded_bitmap Sprite = BenchMakeSprite(SpriteSize, SpriteSize, 0, 30);
+    real32 *Positions = (real32 *)LinuxAllocateMemory(SpriteCount * 2 * sizeof(real32));
+    for (int SpriteIndex = 0; SpriteIndex < SpriteCount; ++SpriteIndex)
+    {
+        Positions[2 * SpriteIndex + 0] = (real32)BenchRandomBetween(0, Buffer.Width - SpriteSize - 1);
+        Positions[2 * SpriteIndex + 1] = (real32)BenchRandomBetween(0, Buffer.Height - SpriteSize - 1);
+    }
+
+    char *ModeNames[BlendMode_Count] = {(char *)"opaque", (char *)"alpha-test", (char *)"blend", (char *)"blend-sRGB"};
+    printf("  %d %dx%d sprites into %dx%d, Mpix/s\n", SpriteCount, SpriteSize, SpriteSize, Buffer.Width,
+            Buffer.Height);
+    printf("  %-6s %-9s", "", "");
+    for (int ModeIndex = 0; ModeIndex < BlendMode_Count; ++ModeIndex)
+    {
+        printf(" %11s", ModeNames[ModeIndex]);
+    }
+    printf("\n");
+
+    for (int LevelIndex = 0; LevelIndex < RenderKernel_Count; ++LevelIndex)
+    {
+        render_kernel_level Level = (render_kernel_level)LevelIndex;
+        if (!IsRenderKernelLevelSupported(Level))
+        {
+            continue;
+        }
+        SetRenderKernelLevel(Level);
+
+        for (int SubPixel = 0; SubPixel < 2; ++SubPixel)
+        {
+            //NOTE: Sub-pixel sprites are offset by a fraction on both axes, so they filter and cover one more row and
+            //  column than whole-pixel ones.
+            real32 Offset = SubPixel ? 0.375f : 0.0f;
+            real64 PixelCount = (real64)SpriteCount * (real64)(SpriteSize + SubPixel) * (real64)(SpriteSize + SubPixel);
+
+            printf("  %-6s %-9s", GetRenderKernelLevelName(Level), SubPixel ? "sub-pixel" : "whole");
+            for (int ModeIndex = 0; ModeIndex < BlendMode_Count; ++ModeIndex)
+            {
+                bench_timer Timer;
+                BenchBeginRepeat(&Timer);
+                for (int Repeat = 0; Repeat < 10; ++Repeat)
+                {
+                    FillRectangle(&Buffer, 0, 0, Buffer.Width, Buffer.Height, 0xFF204060);
+                    uint64 Start = LinuxGetWallClock();
+                    for (int SpriteIndex = 0; SpriteIndex < SpriteCount; ++SpriteIndex)
+                    {
+                        DrawBitmap(&Buffer, &Sprite, Positions[2 * SpriteIndex + 0] + Offset,
+                                Positions[2 * SpriteIndex + 1] + Offset, (blend_mode)ModeIndex);
+                    }
+                    BenchAddRepeat(&Timer, Start, LinuxGetWallClock());
+                }
+                printf(" %11.01f", PixelCount / (Timer.MinMS * 1000.0));
+            }
+            printf("\n");
+        }
+    }
+
+    SetRenderKernelLevel(GetBestRenderKernelLevel());
+    munmap(Positions, SpriteCount * 2 * sizeof(real32));
+    BenchFreeSprite(&Sprite);
+    BenchFreeBuffer(&Buffer);
+    return(true);
+}
+
+// =====================================================================================================================
+//NOTE: Render commands
+
+struct bench_command
+{
+    render_command_type Type;
+    int32 Layer;
+    real32 X;
+    real32 Y;
+    real32 Width;
+    real32 Height;
+    color4 Color;
+    uint32 Value;
+    bool32 SRGB;
+    blend_mode Mode;
+    loaded_bitmap *Bitmap;
+};
+
+internal void BenchMakeCommands(bench_command *Commands, int CommandCount, loaded_bitmap *Sprites, int SpriteCount,
+        int Width, int Height)
+{
+    for (int CommandIndex = 0; CommandIndex < CommandCount; ++CommandIndex)
+    {
+        //NOTE: A few commands land partly or wholly off the target so that culling gets exercised too.
+        bench_command *Command = Commands + CommandIndex;
+        *Command = {};
+        Command->Layer = BenchRandomBetween(-2, 3);
+        Command->X = (real32)BenchRandomBetween(-80, Width + 16) + (real32)(BenchRandom() % 256) / 256.0f;
+        Command->Y = (real32)BenchRandomBetween(-80, Height + 16) + (real32)(BenchRandom() % 256) / 256.0f;
+        Command->Width = (real32)BenchRandomBetween(0, 96);
+        Command->Height = (real32)BenchRandomBetween(0, 96);
+        Command->Color.R = (real32)(BenchRandom() % 256) / 255.0f;
+        Command->Color.G = (real32)(BenchRandom() % 256) / 255.0f;
+        Command->Color.B = (real32)(BenchRandom() % 256) / 255.0f;
+        Command->Color.A = (real32)(BenchRandom() % 256) / 255.0f;
+        Command->Value = BenchRandom();
+        Command->SRGB = (BenchRandom() & 1);
+        Command->Mode = (blend_mode)(BenchRandom() % BlendMode_Count);
+        Command->Bitmap = Sprites + (BenchRandom() % SpriteCount);
+
+        uint32 Roll = BenchRandom() % 100;
+        if (Roll < 1)
+        {
+            Command->Type = RenderCommand_render_command_clear;
+            Command->Value |= 0xFF000000;
+        }
+        else if (Roll < 3)
+        {
+            Command->Type = RenderCommand_render_command_weird_gradient;
+        }
+        else if (Roll < 50)
+        {
+            Command->Type = RenderCommand_render_command_rectangle;
+        }
+        else
+        {
+            Command->Type = RenderCommand_render_command_bitmap;
+        }
+    }
+}
+
+// =====================================================================================================================
+
+internal void BenchPushCommands(render_group *Group, bench_command *Commands, int CommandCount)
+{
+    for (int CommandIndex = 0; CommandIndex < CommandCount; ++CommandIndex)
+    {
+        bench_command *Command = Commands + CommandIndex;
+        switch (Command->Type)
+        {
+            case RenderCommand_render_command_clear:
+            {
+                PushClear(Group, Command->Value);
+            } break;
+
+            case RenderCommand_render_command_rectangle:
+            {
+                PushRectangle(Group, Command->Layer, Command->X, Command->Y, Command->X + Command->Width,
+                        Command->Y + Command->Height, Command->Color, Command->SRGB);
+            } break;
+
+            case RenderCommand_render_command_bitmap:
+            {
+                PushBitmap(Group, Command->Layer, Command->Bitmap, Command->X, Command->Y, Command->Mode);
+            } break;
+
+            case RenderCommand_render_command_weird_gradient:
+            {
+                PushWeirdGradient(Group, Command->Layer, (int)(Command->Value & 0xFF), (int)(Command->Value >> 24));
+            } break;
+        }
+    }
+}
+
+// =====================================================================================================================
+
+internal void BenchDrawCommandsImmediate(game_offscreen_buffer *Buffer, bench_command *Commands, int CommandCount)
+{
+    //NOTE: What the render group has to match: clears first, then every layer from the bottom up, each one in the
+    //  order its commands were pushed.
+    for (int CommandIndex = 0; CommandIndex < CommandCount; ++CommandIndex)
+    {
+        bench_command *Command = Commands + CommandIndex;
+        if (Command->Type == RenderCommand_render_command_clear)
+        {
+            FillRectangle(Buffer, 0, 0, Buffer->Width, Buffer->Height, Command->Value);
+        }
+    }
+
+    for (int32 Layer = -2; Layer <= 3; ++Layer)
+    {
+        for (int CommandIndex = 0; CommandIndex < CommandCount; ++CommandIndex)
+        {
+            bench_command *Command = Commands + CommandIndex;
+            if (Command->Layer != Layer)
+            {
+                continue;
+            }
+
+            if (Command->Type == RenderCommand_render_command_rectangle)
+            {
+                DrawRectangle(Buffer, Command->X, Command->Y, Command->X + Command->Width,
+                        Command->Y + Command->Height, Command->Color, Command->SRGB);
+            }
+            else if (Command->Type == RenderCommand_render_command_bitmap)
+            {
+                DrawBitmap(Buffer, Command->Bitmap, Command->X, Command->Y, Command->Mode);
+            }
+            else if (Command->Type == RenderCommand_render_command_weird_gradient)
+            {
+                RenderWeirdGradient(Buffer, (int)(Command->Value & 0xFF), (int)(Command->Value >> 24));
+            }
+        }
+    }
+}
+
+// =====================================================================================================================
+
+internal BENCH_FUNCTION(BenchCommands)
+{
+    bool32 Result = true;
+
+    Platform.AddEntry = LinuxAddEntry;
+    Platform.CompleteAllWork = LinuxCompleteAllWork;
+
+    //NOTE: Leaked like the ones in BenchThreads.
+    int ThreadCount = 4;
+    platform_work_queue *Queue = (platform_work_queue *)LinuxAllocateMemory(sizeof(platform_work_queue));
+    LinuxMakeQueue(Queue, ThreadCount - 1);
+
+    memory_index ArenaSize = Megabytes(16);
+    memory_arena Arena;
+    InitializeArena(&Arena, (char *)"Commands", ArenaSize, LinuxAllocateMemory(ArenaSize));
+
+    loaded_bitmap Sprites[4];
+    for (int SpriteIndex = 0; SpriteIndex < (int)ArrayCount(Sprites); ++SpriteIndex)
+    {
+        Sprites[SpriteIndex] = BenchMakeSprite(BenchRandomBetween(1, 64), BenchRandomBetween(1, 64),
+                SpriteIndex, 30);
+    }
+
+    int CommandCount = 4000;
+    bench_command *Commands = PushArray(&Arena, CommandCount, bench_command);
+    game_offscreen_buffer Expected = BenchAllocateBuffer(1280, 720, 0);
+    game_offscreen_buffer Actual = BenchAllocateBuffer(1280, 720, 0);
+
+    printf("render commands (%s kernels)\n", GetRenderKernelLevelName(GetBestRenderKernelLevel()));
+    for (int Trial = 0; Result && (Trial < 8); ++Trial)
+    {
+        int TrialCommandCount = (Trial == 0) ? CommandCount : BenchRandomBetween(0, 200);
+        BenchMakeCommands(Commands, TrialCommandCount, Sprites, ArrayCount(Sprites), Expected.Width,
+                Expected.Height);
+
+        BenchFillRandom(&Expected);
+        memcpy(Actual.Memory, Expected.Memory, Expected.Pitch * Expected.Height);
+        BenchDrawCommandsImmediate(&Expected, Commands, TrialCommandCount);
+
+        temporary_memory GroupMemory = BeginTemporaryMemory(&Arena);
+        render_group *Group = AllocateRenderGroup(&Arena, Megabytes(1), Actual.Width, Actual.Height);
+        BenchPushCommands(Group, Commands, TrialCommandCount);
+        RenderGroupToOutput(Group, &Actual, (Trial & 1) ? Queue : 0, &Arena);
+        if (!BenchBuffersMatch(&Expected, &Actual))
+        {
+            fprintf(stderr, "render group output differs from immediate drawing (trial %d, %d commands)\n",
+                    Trial, TrialCommandCount);
+            Result = false;
+        }
+        else if (Trial == 0)
+        {
+            printf("  %d pushed: %u recorded, %u culled, %u dropped, %u bytes\n", TrialCommandCount,
+                    Group->SortEntryCount, Group->CulledCommandCount, Group->DroppedCommandCount,
+                    GetRenderGroupBytesUsed(Group));
+        }
+        EndTemporaryMemory(GroupMemory);
+    }
+
+    if (Result)
+    {
+        //NOTE: Commands that don't fit are dropped whole; what did fit still has to draw.
+        temporary_memory GroupMemory = BeginTemporaryMemory(&Arena);
+        render_group *Group = AllocateRenderGroup(&Arena, Kilobytes(4), Actual.Width, Actual.Height);
+        BenchPushCommands(Group, Commands, CommandCount);
+        RenderGroupToOutput(Group, &Actual, Queue, &Arena);
+        if ((Group->DroppedCommandCount == 0) || (GetRenderGroupBytesUsed(Group) > Group->MaxPushBufferSize) ||
+                ((Group->SortEntryCount + Group->CulledCommandCount + Group->DroppedCommandCount) !=
+                 (uint32)CommandCount))
+        {
+            fprintf(stderr, "overflowing render group lost track of its commands\n");
+            Result = false;
+        }
+        EndTemporaryMemory(GroupMemory);
+    }
+
+    if (Result)
+    {
+        BenchMakeCommands(Commands, CommandCount, Sprites, ArrayCount(Sprites), Actual.Width, Actual.Height);
+
+        bench_timer Record;
+        BenchBeginRepeat(&Record);
+        uint32 BytesUsed = 0;
+        uint32 Recorded = 0;
+        for (int Repeat = 0; Repeat < 100; ++Repeat)
+        {
+            temporary_memory GroupMemory = BeginTemporaryMemory(&Arena);
+            render_group *Group = AllocateRenderGroup(&Arena, Megabytes(1), Actual.Width, Actual.Height);
+            uint64 Start = LinuxGetWallClock();
+            BenchPushCommands(Group, Commands, CommandCount);
+            BenchAddRepeat(&Record, Start, LinuxGetWallClock());
+            BytesUsed = GetRenderGroupBytesUsed(Group);
+            Recorded = Group->SortEntryCount;
+            EndTemporaryMemory(GroupMemory);
+        }
+        printf("  record   %d commands  best %7.03fms  avg %7.03fms  %7.02f Mcommands/s  %5.01f bytes/command\n",
+                CommandCount, Record.MinMS, BenchAverageMS(&Record), CommandCount / (Record.MinMS * 1000.0),
+                (real64)BytesUsed / (real64)Recorded);
+
+        bench_timer Immediate;
+        BenchBeginRepeat(&Immediate);
+        for (int Repeat = 0; Repeat < 10; ++Repeat)
+        {
+            uint64 Start = LinuxGetWallClock();
+            BenchDrawCommandsImmediate(&Expected, Commands, CommandCount);
+            BenchAddRepeat(&Immediate, Start, LinuxGetWallClock());
+        }
+        printf("  immediate        best %7.03fms  avg %7.03fms\n", Immediate.MinMS, BenchAverageMS(&Immediate));
+
+        for (int Threaded = 0; Threaded < 2; ++Threaded)
+        {
+            bench_timer Execute;
+            BenchBeginRepeat(&Execute);
+            for (int Repeat = 0; Repeat < 10; ++Repeat)
+            {
+                temporary_memory GroupMemory = BeginTemporaryMemory(&Arena);
+                render_group *Group = AllocateRenderGroup(&Arena, Megabytes(1), Actual.Width, Actual.Height);
+                BenchPushCommands(Group, Commands, CommandCount);
+                uint64 Start = LinuxGetWallClock();
+                RenderGroupToOutput(Group, &Actual, Threaded ? Queue : 0, &Arena);
+                BenchAddRepeat(&Execute, Start, LinuxGetWallClock());
+                EndTemporaryMemory(GroupMemory);
+            }
+            printf("  tiled %d thread%s best %7.03fms  avg %7.03fms\n", Threaded ? ThreadCount : 1,
+                    Threaded ? "s" : " ", Execute.MinMS, BenchAverageMS(&Execute));
+        }
+    }
+
+    for (int SpriteIndex = 0; SpriteIndex < (int)ArrayCount(Sprites); ++SpriteIndex)
+    {
+        BenchFreeSprite(&Sprites[SpriteIndex]);
+    }
+    BenchFreeBuffer(&Expected);
+    BenchFreeBuffer(&Actual);
+    munmap(Arena.Base, ArenaSize);
+    return(Result);
+}
+
+// =====================================================================================================================
+//NOTE: Sound ring and audio feed
+
+struct bench_ring_consumer
+{
+    sound_ring *Ring;
+    uint32 TotalSampleCount;
+    uint32 MismatchCount;
+};
+
+internal void *BenchRingConsumerProc(void *Parameter)
+{
+    //NOTE: Its own random state, BenchRandom isn't safe to share with the producer.
+    bench_ring_consumer *Consumer = (bench_ring_consumer *)Parameter;
+    uint32 RandomState = 0x9E3779B9;
+    int16 Chunk[2 * 2048];
+
+    uint32 Expected = 0;
+    while (Expected < Consumer->TotalSampleCount)
+    {
+        uint32 Queued = GetSoundRingQueued(Consumer->Ring);
+        if (!Queued)
+        {
+            sched_yield();
+            continue;
+        }
+
+        RandomState ^= RandomState << 13;
+        RandomState ^= RandomState >> 17;
+        RandomState ^= RandomState << 5;
+        uint32 Count = 1 + (RandomState % 2048);
+        if (Count > Queued)
+        {
+            Count = Queued;
+        }
+
+        ReadSoundRing(Consumer->Ring, Chunk, Count);
+        for (uint32 SampleIndex = 0; SampleIndex < Count; ++SampleIndex, ++Expected)
+        {
+            if ((Chunk[2 * SampleIndex + 0] != (int16)Expected) ||
+                    (Chunk[2 * SampleIndex + 1] != (int16)(Expected >> 16)))
+            {
+                ++Consumer->MismatchCount;
+            }
+        }
+    }
+
+    return(0);
+}
+
+// =====================================================================================================================
+
+internal bool32 BenchCheckSoundRingThreaded(sound_ring *Ring)
+{
+    //NOTE: A counting sequence pushed and pulled in random sized chunks from two threads has to come out whole and
+    //  in order.
+    bench_ring_consumer Consumer = {};
+    Consumer.Ring = Ring;
+    Consumer.TotalSampleCount = 1 << 24;
+
+    pthread_t ConsumerThread;
+    uint64 Start = LinuxGetWallClock();
+    pthread_create(&ConsumerThread, 0, BenchRingConsumerProc, &Consumer);
+
+    int16 Chunk[2 * 2048];
+    uint32 Next = 0;
+    while (Next < Consumer.TotalSampleCount)
+    {
+        uint32 Count = GetSoundRingProduceCount(Ring, Ring->SampleCount, (uint32)BenchRandomBetween(1, 2048));
+        if (Count > (Consumer.TotalSampleCount - Next))
+        {
+            Count = Consumer.TotalSampleCount - Next;
+        }
+        if (!Count)
+        {
+            sched_yield();
+            continue;
+        }
+
+        for (uint32 SampleIndex = 0; SampleIndex < Count; ++SampleIndex, ++Next)
+        {
+            Chunk[2 * SampleIndex + 0] = (int16)Next;
+            Chunk[2 * SampleIndex + 1] = (int16)(Next >> 16);
+        }
+        WriteSoundRing(Ring, Chunk, Count);
+    }
+
+    pthread_join(ConsumerThread, 0);
+    real64 MS = LinuxGetMSElapsed(Start, LinuxGetWallClock());
+
+    bool32 Result = (Consumer.MismatchCount == 0) && (GetSoundRingQueued(Ring) == 0);
+    if (!Result)
+    {
+        fprintf(stderr, "sound ring handed back %u mismatched samples\n", Consumer.MismatchCount);
+    }
+    printf("  ring     %u samples across two threads  %7.03fms  %8.02f Msamples/s\n", Consumer.TotalSampleCount, MS,
+            (real64)Consumer.TotalSampleCount / (MS * 1000.0));
+    return(Result);
+}
+
+// =====================================================================================================================
+
+struct bench_feed_scenario
+{
+    char *Name;
+    uint32 LatencyMS;
+    int HitchEvery;
+    int HitchMS;
+    int AudioStallMS;
+
+    bool32 ExpectUnderruns;
+    bool32 ExpectLateWakes;
+};
+
+internal bool32 BenchSimulateSoundFeed(bench_feed_scenario *Scenario, sound_ring *Ring, int16 *DeviceSamples,
+        int16 *Staging)
+{
+    //NOTE: The frame loop, the audio thread and the device are all simulated on one clock, in quarter millisecond
+    //  steps, so every run is the same run. The frame loop produces a counting sequence (never zero), and every
+    //  sample the device's play cursor passes is checked: it has to be the next one in the sequence or silence, and
+    //  there can only be silence when there was supposed to be an underrun.
+    uint32 SamplesPerSecond = 48000;
+    uint32 DeviceSampleCount = SamplesPerSecond;
+    uint32 WriteLead = SamplesPerSecond / 200;
+    uint32 SamplesPerFrame = SamplesPerSecond / 60;
+
+    sound_feed Feed;
+    InitializeSoundRing(Ring, Ring->SampleCount, Ring->Samples);
+    InitializeSoundFeed(&Feed, SamplesPerSecond, DeviceSampleCount, Scenario->LatencyMS, SOUND_FEED_PERIOD_MS);
+    memset(DeviceSamples, 0, DeviceSampleCount * 2 * sizeof(int16));
+
+    uint64 NextWakeUS = 0;
+    uint64 NextFrameUS = 0;
+    int FrameIndex = 0;
+    uint32 Produced = 0;
+    uint32 ExpectedPlayed = 0;
+    uint64 PlayedSampleCount = 0;
+    uint32 PlayedSilenceCount = 0;
+    uint32 OutOfOrderCount = 0;
+    bool32 AudioStalled = false;
+
+    for (uint64 TimeUS = 0; TimeUS < 5000000; TimeUS += 250)
+    {
+        uint64 PlayedNow = (TimeUS * SamplesPerSecond) / 1000000;
+        for (; PlayedSampleCount < PlayedNow; ++PlayedSampleCount)
+        {
+            int16 *Sample = DeviceSamples + 2 * (PlayedSampleCount % DeviceSampleCount);
+            if ((Sample[0] == 0) && (Sample[1] == 0))
+            {
+                if (ExpectedPlayed)
+                {
+                    ++PlayedSilenceCount;
+                }
+            }
+            else
+            {
+                if ((Sample[0] != (int16)((ExpectedPlayed % 30000) + 1)) || (Sample[1] != -Sample[0]))
+                {
+                    ++OutOfOrderCount;
+                }
+                ++ExpectedPlayed;
+            }
+        }
+
+        if (TimeUS >= NextFrameUS)
+        {
+            uint32 Count = GetSoundRingProduceCount(Ring, SamplesPerFrame + Feed.LatencySampleCount,
+                    SamplesPerSecond);
+            for (uint32 SampleIndex = 0; SampleIndex < Count; ++SampleIndex, ++Produced)
+            {
+                Staging[2 * SampleIndex + 0] = (int16)((Produced % 30000) + 1);
+                Staging[2 * SampleIndex + 1] = (int16)-Staging[2 * SampleIndex + 0];
+            }
+            WriteSoundRing(Ring, Staging, Count);
+
+            NextFrameUS += 1000000 / 60;
+            if (Scenario->HitchEvery && ((FrameIndex % Scenario->HitchEvery) == (Scenario->HitchEvery - 1)))
+            {
+                NextFrameUS += (uint64)Scenario->HitchMS * 1000;
+            }
+            ++FrameIndex;
+        }
+
+        if (TimeUS >= NextWakeUS)
+        {
+            uint32 PlayCursor = (uint32)(PlayedNow % DeviceSampleCount);
+            uint32 WriteCursor = (uint32)((PlayedNow + WriteLead) % DeviceSampleCount);
+            sound_feed_write Write = PlanSoundFeedWrite(&Feed, Ring, PlayCursor, WriteCursor);
+            uint32 FirstCount = DeviceSampleCount - Write.DevicePosition;
+            if (FirstCount > Write.SampleCount)
+            {
+                FirstCount = Write.SampleCount;
+            }
+            FillSoundFeedRegion(Ring, &Write, DeviceSamples + 2 * Write.DevicePosition, FirstCount);
+            FillSoundFeedRegion(Ring, &Write, DeviceSamples, Write.SampleCount - FirstCount);
+            EndSoundFeedWrite(&Feed, &Write);
+
+            //NOTE: Real wakes are never exactly on time, so every one lands somewhere in the half millisecond after
+            //  it was due. One stall, two seconds in, stands in for the audio thread not getting scheduled at all.
+            NextWakeUS += 1000 * Feed.PeriodMS + (BenchRandom() % 2) * 250;
+            if (Scenario->AudioStallMS && !AudioStalled && (TimeUS >= 2000000))
+            {
+                NextWakeUS += (uint64)Scenario->AudioStallMS * 1000;
+                AudioStalled = true;
+            }
+        }
+    }
+
+    bool32 Result = true;
+    if ((Feed.UnderrunCount != 0) != (Scenario->ExpectUnderruns != 0))
+    {
+        fprintf(stderr, "%s: %u underruns, expected %s\n", Scenario->Name, Feed.UnderrunCount,
+                Scenario->ExpectUnderruns ? "some" : "none");
+        Result = false;
+    }
+    if ((Feed.LateWakeCount != 0) != (Scenario->ExpectLateWakes != 0))
+    {
+        fprintf(stderr, "%s: %u late wakes, expected %s\n", Scenario->Name, Feed.LateWakeCount,
+                Scenario->ExpectLateWakes ? "some" : "none");
+        Result = false;
+    }
+    if (!Scenario->ExpectLateWakes)
+    {
+        //NOTE: A late wake means the device played whatever was left in its buffer, so only without one is every
+        //  played sample accounted for.
+        if (OutOfOrderCount)
+        {
+            fprintf(stderr, "%s: %u samples played out of order\n", Scenario->Name, OutOfOrderCount);
+            Result = false;
+        }
+        if (!Scenario->ExpectUnderruns && PlayedSilenceCount)
+        {
+            fprintf(stderr, "%s: %u samples of silence without an underrun\n", Scenario->Name, PlayedSilenceCount);
+            Result = false;
+        }
+    }
+
+    printf("  %-22s %3ums latency: %4u wakes, %u late, %2u underruns, %8.03fms silence, %7.03fs played\n",
+            Scenario->Name, Scenario->LatencyMS, Feed.WakeCount, Feed.LateWakeCount, Feed.UnderrunCount,
+            1000.0 * (real64)Feed.SilenceSampleCount / (real64)SamplesPerSecond,
+            (real64)ExpectedPlayed / (real64)SamplesPerSecond);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal BENCH_FUNCTION(BenchAudioFeed)
+{
+    memory_index ArenaSize = Megabytes(1);
+    memory_arena Arena;
+    InitializeArena(&Arena, (char *)"AudioFeed", ArenaSize, LinuxAllocateMemory(ArenaSize));
+
+    sound_ring *Ring = PushStruct(&Arena, sound_ring, 64);
+    InitializeSoundRing(Ring, SOUND_RING_SAMPLE_COUNT, PushArray(&Arena, 2 * SOUND_RING_SAMPLE_COUNT, int16, 64));
+    int16 *DeviceSamples = PushArray(&Arena, 2 * 48000, int16, 64);
+    int16 *Staging = PushArray(&Arena, 2 * 48000, int16, 64);
+
+    printf("audio feed\n");
+    bool32 Result = BenchCheckSoundRingThreaded(Ring);
+
+    //NOTE: A hitch shorter than the latency target is absorbed by the ring; one longer than the ring's depth plus
+    //  the device's isn't. An audio thread that sleeps through everything the device had queued is a late wake.
+    bench_feed_scenario Scenarios[] =
+    {
+        {(char *)"steady", 40, 0, 0, 0, false, false},
+        {(char *)"steady tight", 5, 0, 0, 0, false, false},
+        {(char *)"hitch under latency", 40, 30, 35, 0, false, false},
+        {(char *)"hitch over latency", 20, 30, 80, 0, true, false},
+        {(char *)"audio thread stall", 10, 0, 0, 40, false, true},
+    };
+    for (int ScenarioIndex = 0; ScenarioIndex < (int)ArrayCount(Scenarios); ++ScenarioIndex)
+    {
+        Result = BenchSimulateSoundFeed(Scenarios + ScenarioIndex, Ring, DeviceSamples, Staging) && Result;
+    }
+
+    munmap(Arena.Base, ArenaSize);
+    return(Result);
+}
+
+// =====================================================================================================================
+//NOTE: Tile-map world
+
+internal bool32 BenchCheckWorldTiles(memory_arena *Arena)
+{
+    bool32 Result = true;
+    temporary_memory CheckMemory = BeginTemporaryMemory(Arena);
+
+    //NOTE: One region straddles the origin, the other sits in the corner where tile coordinates run out, so both the
+    //  sign handling and the far edges of the hash key get exercised.
+    int RegionDim = 16 * TILE_CHUNK_DIM;
+    int32 RegionMinX[2] = {-RegionDim / 2, INT32_MAX - (RegionDim - 1)};
+    int32 RegionMinY[2] = {-RegionDim / 2, INT32_MIN};
+    uint32 *Reference[2];
+    for (int RegionIndex = 0; RegionIndex < 2; ++RegionIndex)
+    {
+        Reference[RegionIndex] = PushArray(Arena, RegionDim * RegionDim, uint32);
+        ZeroSize(RegionDim * RegionDim * sizeof(uint32), Reference[RegionIndex]);
+    }
+
+    world World;
+    InitializeWorld(&World, Arena, 2 * 16 * 16);
+    for (int WriteIndex = 0; Result && (WriteIndex < 100000); ++WriteIndex)
+    {
+        int RegionIndex = WriteIndex & 1;
+        int X = BenchRandomBetween(0, RegionDim - 1);
+        int Y = BenchRandomBetween(0, RegionDim - 1);
+        uint32 Value = BenchRandom();
+        Reference[RegionIndex][Y * RegionDim + X] = Value;
+        if (!SetTileValue(&World, RegionMinX[RegionIndex] + X, RegionMinY[RegionIndex] + Y, Value))
+        {
+            fprintf(stderr, "world ran out of chunks after %u\n", World.ChunkCount);
+            Result = false;
+        }
+    }
+
+    for (int RegionIndex = 0; Result && (RegionIndex < 2); ++RegionIndex)
+    {
+        for (int Y = 0; Result && (Y < RegionDim); ++Y)
+        {
+            for (int X = 0; X < RegionDim; ++X)
+            {
+                int32 TileX = RegionMinX[RegionIndex] + X;
+                int32 TileY = RegionMinY[RegionIndex] + Y;
+                if (GetTileValue(&World, TileX, TileY) != Reference[RegionIndex][Y * RegionDim + X])
+                {
+                    fprintf(stderr, "tile %d, %d reads back wrong\n", TileX, TileY);
+                    Result = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    //NOTE: Just outside the first region there are no chunks at all.
+    for (int Edge = -1; Result && (Edge <= RegionDim); ++Edge)
+    {
+        int32 Min = RegionMinX[0] - 1;
+        int32 Max = RegionMinX[0] + RegionDim;
+        int32 Along = RegionMinX[0] + Edge;
+        if (GetTileValue(&World, Min, Along) || GetTileValue(&World, Max, Along) ||
+                GetTileValue(&World, Along, Min) || GetTileValue(&World, Along, Max))
+        {
+            fprintf(stderr, "tiles outside the written region aren't empty\n");
+            Result = false;
+        }
+    }
+    EndTemporaryMemory(CheckMemory);
+
+    if (Result)
+    {
+        //NOTE: Fill a world with scattered chunks until it says no; everything it said yes to must still be there.
+        CheckMemory = BeginTemporaryMemory(Arena);
+        uint32 MaxChunkCount = 1000;
+        InitializeWorld(&World, Arena, MaxChunkCount);
+        int32 *Created = PushArray(Arena, 2 * MaxChunkCount, int32);
+        uint32 CreatedCount = 0;
+        for (;;)
+        {
+            int32 ChunkX = (int32)BenchRandom();
+            int32 ChunkY = (CreatedCount & 1) ? (int32)BenchRandom() : BenchRandomBetween(-4, 4);
+            uint32 ChunkCount = World.ChunkCount;
+            tile_chunk *Chunk = GetOrCreateTileChunk(&World, ChunkX, ChunkY);
+            if (!Chunk)
+            {
+                break;
+            }
+            if (World.ChunkCount != ChunkCount)
+            {
+                Created[2 * CreatedCount + 0] = ChunkX;
+                Created[2 * CreatedCount + 1] = ChunkY;
+                ++CreatedCount;
+            }
+        }
+
+        if ((CreatedCount != MaxChunkCount) || (World.ChunkCount != MaxChunkCount))
+        {
+            fprintf(stderr, "full world holds %u chunks, expected %u\n", CreatedCount, MaxChunkCount);
+            Result = false;
+        }
+        for (uint32 CreatedIndex = 0; Result && (CreatedIndex < CreatedCount); ++CreatedIndex)
+        {
+            int32 ChunkX = Created[2 * CreatedIndex + 0];
+            int32 ChunkY = Created[2 * CreatedIndex + 1];
+            tile_chunk *Chunk = GetTileChunk(&World, ChunkX, ChunkY);
+            if (!Chunk || (Chunk->ChunkX != ChunkX) || (Chunk->ChunkY != ChunkY) ||
+                    (GetOrCreateTileChunk(&World, ChunkX, ChunkY) != Chunk))
+            {
+                fprintf(stderr, "chunk %d, %d went missing from a full world\n", ChunkX, ChunkY);
+                Result = false;
+            }
+        }
+        EndTemporaryMemory(CheckMemory);
+    }
+
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline bool32 BenchPositionsEqual(world_position A, world_position B)
+{
+    bool32 Result = ((A.ChunkX == B.ChunkX) && (A.ChunkY == B.ChunkY) &&
+            (A.OffsetX == B.OffsetX) && (A.OffsetY == B.OffsetY));
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline real32 BenchRandomOffset(void)
+{
+    //NOTE: Anywhere in a chunk, with bits all the way down to the bottom of the mantissa.
+    real32 Result;
+    do
+    {
+        Result = (real32)(BenchRandom() >> 8) * ldexpf(1.0f, -20 - (int)(BenchRandom() % 24));
+    } while (Result >= TILE_CHUNK_SIDE_IN_METERS);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 BenchCheckWorldPositions(void)
+{
+    bool32 Result = true;
+
+    //NOTE: Stepping across chunk boundaries in half meters lands exactly where integer math says it should.
+    int32 BaseChunks[] = {0, -1, 1, (1 << 27) - 1, -(1 << 27), INT32_MAX - 8, INT32_MIN + 8};
+    for (int BaseIndex = 0; Result && (BaseIndex < (int)ArrayCount(BaseChunks)); ++BaseIndex)
+    {
+        world_position Base = {BaseChunks[BaseIndex], BaseChunks[BaseIndex], 8.0f, 0.0f};
+        for (int HalfMeters = -100; HalfMeters <= 100; ++HalfMeters)
+        {
+            world_position Moved = MapIntoChunkSpace(Base, 0.5f * (real32)HalfMeters, -0.5f * (real32)HalfMeters);
+
+            int32 ChunkHalfMeters = 2 * TILE_CHUNK_DIM;
+            int32 TotalX = 16 + HalfMeters;
+            int32 TotalY = -HalfMeters;
+            int32 ChunkDeltaX = (TotalX >= 0) ? (TotalX / ChunkHalfMeters) : -((ChunkHalfMeters - 1 - TotalX) /
+                    ChunkHalfMeters);
+            int32 ChunkDeltaY = (TotalY >= 0) ? (TotalY / ChunkHalfMeters) : -((ChunkHalfMeters - 1 - TotalY) /
+                    ChunkHalfMeters);
+            world_position Expected =
+            {
+                Base.ChunkX + ChunkDeltaX, Base.ChunkY + ChunkDeltaY,
+                0.5f * (real32)(TotalX - ChunkDeltaX * ChunkHalfMeters),
+                0.5f * (real32)(TotalY - ChunkDeltaY * ChunkHalfMeters),
+            };
+            if (!BenchPositionsEqual(Moved, Expected))
+            {
+                fprintf(stderr, "moving %.1fm from chunk %d lands at %d + %f, expected %d + %f\n",
+                        0.5f * (real32)HalfMeters, Base.ChunkX, Moved.ChunkX, Moved.OffsetX, Expected.ChunkX,
+                        Expected.OffsetX);
+                Result = false;
+                break;
+            }
+        }
+    }
+
+    //NOTE: A long walk in 1/256m steps, then the same walk backwards, ends exactly where it started however far out
+    //  it happens. The same walk on a plain float coordinate is shown for comparison.
+    int StepCount = 10000;
+    real32 *Steps = (real32 *)LinuxAllocateMemory(2 * StepCount * sizeof(real32));
+    for (int StepIndex = 0; StepIndex < 2 * StepCount; ++StepIndex)
+    {
+        Steps[StepIndex] = (real32)BenchRandomBetween(-4096, 4096) * (1.0f / 256.0f);
+    }
+    int32 WalkChunks[] = {0, 1 << 16, -(1 << 20)};
+    for (int WalkIndex = 0; Result && (WalkIndex < (int)ArrayCount(WalkChunks)); ++WalkIndex)
+    {
+        world_position Start = {WalkChunks[WalkIndex], -WalkChunks[WalkIndex], 3.5f, 12.25f};
+        world_position P = Start;
+        real32 FloatStartX = (real32)WalkChunks[WalkIndex] * TILE_CHUNK_SIDE_IN_METERS + Start.OffsetX;
+        real32 FloatX = FloatStartX;
+        for (int StepIndex = 0; StepIndex < StepCount; ++StepIndex)
+        {
+            P = MapIntoChunkSpace(P, Steps[2 * StepIndex], Steps[2 * StepIndex + 1]);
+            FloatX += Steps[2 * StepIndex];
+        }
+        for (int StepIndex = StepCount - 1; StepIndex >= 0; --StepIndex)
+        {
+            P = MapIntoChunkSpace(P, -Steps[2 * StepIndex], -Steps[2 * StepIndex + 1]);
+            FloatX -= Steps[2 * StepIndex];
+        }
+        printf("  walk at chunk %11d: %s, plain float off by %gm\n", WalkChunks[WalkIndex],
+                BenchPositionsEqual(P, Start) ? "exact" : "DRIFTED", fabsf(FloatX - FloatStartX));
+        if (!BenchPositionsEqual(P, Start))
+        {
+            Result = false;
+        }
+    }
+    munmap(Steps, 2 * StepCount * sizeof(real32));
+
+    for (int Trial = 0; Result && (Trial < 100000); ++Trial)
+    {
+        //NOTE: Moves don't depend on which chunk they start from.
+        int32 FarX = (int32)BenchRandom() >> 1;
+        int32 FarY = (int32)BenchRandom() >> 1;
+        world_position Near = {0, 0, BenchRandomOffset(), BenchRandomOffset()};
+        world_position Far = {FarX, FarY, Near.OffsetX, Near.OffsetY};
+        real32 dX = (real32)BenchRandomBetween(-1000000, 1000000) * (1.0f / 4096.0f);
+        real32 dY = BenchRandomOffset() - BenchRandomOffset();
+        world_position NearMoved = MapIntoChunkSpace(Near, dX, dY);
+        world_position FarMoved = MapIntoChunkSpace(Far, dX, dY);
+        NearMoved.ChunkX += FarX;
+        NearMoved.ChunkY += FarY;
+        if (!BenchPositionsEqual(NearMoved, FarMoved))
+        {
+            fprintf(stderr, "the same move from chunk %d, %d differs from the one at the origin\n", FarX, FarY);
+            Result = false;
+        }
+
+        //NOTE: Nearby positions are exactly as far apart far from the origin as near it.
+        world_difference Difference = SubtractPositions(FarMoved, Far);
+        world_difference NearDifference = SubtractPositions(MapIntoChunkSpace(Near, dX, dY), Near);
+        if ((Difference.dX != NearDifference.dX) || (Difference.dY != NearDifference.dY))
+        {
+            fprintf(stderr, "distances far from the origin don't match the same ones near it\n");
+            Result = false;
+        }
+
+        //NOTE: Chunk-relative to tile-relative and back is lossless.
+        world_position P = {(int32)BenchRandom() >> 5, (int32)BenchRandom() >> 5, BenchRandomOffset(),
+            BenchRandomOffset()};
+        tile_position Tile = GetTilePosition(P);
+        if (!BenchPositionsEqual(GetWorldPosition(Tile), P) ||
+                (Tile.TileOffsetX < 0.0f) || (Tile.TileOffsetX >= TILE_SIDE_IN_METERS) ||
+                (Tile.TileOffsetY < 0.0f) || (Tile.TileOffsetY >= TILE_SIDE_IN_METERS) ||
+                ((Tile.TileX >> TILE_CHUNK_SHIFT) != P.ChunkX) || ((Tile.TileY >> TILE_CHUNK_SHIFT) != P.ChunkY))
+        {
+            fprintf(stderr, "chunk %d + %.9g doesn't round-trip through tile %d + %.9g\n", P.ChunkX, P.OffsetX,
+                    Tile.TileX, Tile.TileOffsetX);
+            Result = false;
+        }
+    }
+
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void BenchGetProbeLengths(world *World, real64 *AverageProbes, uint32 *MaxProbes)
+{
+    uint64 TotalProbes = 0;
+    *MaxProbes = 0;
+    for (uint32 ChunkIndex = 0; ChunkIndex < World->ChunkCount; ++ChunkIndex)
+    {
+        tile_chunk *Chunk = World->Chunks + ChunkIndex;
+        uint32 Probes = 1;
+        uint32 SlotIndex = GetChunkHomeSlot(World, Chunk->ChunkX, Chunk->ChunkY);
+        while (World->Slots[SlotIndex].ChunkIndex != (ChunkIndex + 1))
+        {
+            SlotIndex = (SlotIndex + 1) & World->SlotMask;
+            ++Probes;
+        }
+        TotalProbes += Probes;
+        if (Probes > *MaxProbes)
+        {
+            *MaxProbes = Probes;
+        }
+    }
+    *AverageProbes = World->ChunkCount ? ((real64)TotalProbes / (real64)World->ChunkCount) : 0.0;
+}
+
+// =====================================================================================================================
+
+internal BENCH_FUNCTION(BenchWorld)
+{
+    memory_index ArenaSize = Megabytes(96);
+    memory_arena Arena;
+    InitializeArena(&Arena, (char *)"World", ArenaSize, LinuxAllocateMemory(ArenaSize));
+
+    printf("tile-map world\n");
+    bool32 Result = BenchCheckWorldTiles(&Arena);
+    Result = Result && BenchCheckWorldPositions();
+
+    if (Result)
+    {
+        //NOTE: 128x128 chunks, 4M tiles, straddling the origin, against the same tiles in one flat array.
+        int ChunkDim = 128;
+        int TileDim = ChunkDim * TILE_CHUNK_DIM;
+        int32 MinTile = -TileDim / 2;
+        uint32 *Flat = PushArray(&Arena, TileDim * TileDim, uint32, 64);
+        for (int TileIndex = 0; TileIndex < TileDim * TileDim; ++TileIndex)
+        {
+            Flat[TileIndex] = BenchRandom() & 3;
+        }
+
+        world World;
+        InitializeWorld(&World, &Arena, ChunkDim * ChunkDim);
+        uint64 BuildStart = LinuxGetWallClock();
+        for (int Y = 0; Y < TileDim; ++Y)
+        {
+            for (int X = 0; X < TileDim; ++X)
+            {
+                SetTileValue(&World, MinTile + X, MinTile + Y, Flat[Y * TileDim + X]);
+            }
+        }
+        real64 BuildMS = LinuxGetMSElapsed(BuildStart, LinuxGetWallClock());
+
+        real64 AverageProbes;
+        uint32 MaxProbes;
+        BenchGetProbeLengths(&World, &AverageProbes, &MaxProbes);
+        printf("  %d tiles in %u chunks: built in %.03fms, %.02f probes per chunk on average, %u at most\n",
+                TileDim * TileDim, World.ChunkCount, BuildMS, AverageProbes, MaxProbes);
+
+        int LookupCount = 1 << 22;
+        int32 *Lookups = PushArray(&Arena, 2 * LookupCount, int32, 64);
+        for (int LookupIndex = 0; LookupIndex < LookupCount; ++LookupIndex)
+        {
+            Lookups[2 * LookupIndex + 0] = BenchRandomBetween(0, TileDim - 1);
+            Lookups[2 * LookupIndex + 1] = BenchRandomBetween(0, TileDim - 1);
+        }
+
+        bench_timer Random;
+        bench_timer RandomFlat;
+        BenchBeginRepeat(&Random);
+        BenchBeginRepeat(&RandomFlat);
+        for (int Repeat = 0; Result && (Repeat < 5); ++Repeat)
+        {
+            uint64 Start = LinuxGetWallClock();
+            uint64 Sum = 0;
+            for (int LookupIndex = 0; LookupIndex < LookupCount; ++LookupIndex)
+            {
+                Sum += GetTileValue(&World, MinTile + Lookups[2 * LookupIndex + 0],
+                        MinTile + Lookups[2 * LookupIndex + 1]);
+            }
+            BenchAddRepeat(&Random, Start, LinuxGetWallClock());
+
+            Start = LinuxGetWallClock();
+            uint64 FlatSum = 0;
+            for (int LookupIndex = 0; LookupIndex < LookupCount; ++LookupIndex)
+            {
+                FlatSum += Flat[Lookups[2 * LookupIndex + 1] * TileDim + Lookups[2 * LookupIndex + 0]];
+            }
+            BenchAddRepeat(&RandomFlat, Start, LinuxGetWallClock());
+
+            if (Sum != FlatSum)
+            {
+                fprintf(stderr, "random lookups disagree with the flat array\n");
+                Result = false;
+            }
+        }
+        printf("  random  %d lookups   best %7.03fms  %6.02f ns/tile  (flat %6.02f ns/tile)\n", LookupCount,
+                Random.MinMS, 1000000.0 * Random.MinMS / LookupCount,
+                1000000.0 * RandomFlat.MinMS / LookupCount);
+
+        //NOTE: A camera 80x45 tiles across panning diagonally over the map, read a tile at a time, a chunk at a
+        //  time, and straight out of the flat array.
+        int ViewDimX = 80;
+        int ViewDimY = 45;
+        int FrameCount = 600;
+        int ViewTileCount = ViewDimX * ViewDimY * FrameCount;
+        bench_timer Camera[3];
+        uint64 Sums[3];
+        for (int Method = 0; Method < 3; ++Method)
+        {
+            BenchBeginRepeat(&Camera[Method]);
+            for (int Repeat = 0; Repeat < 5; ++Repeat)
+            {
+                uint64 Start = LinuxGetWallClock();
+                uint64 Sum = 0;
+                for (int Frame = 0; Frame < FrameCount; ++Frame)
+                {
+                    int ViewX = (3 * Frame) % (TileDim - ViewDimX);
+                    int ViewY = (2 * Frame) % (TileDim - ViewDimY);
+                    if (Method == 0)
+                    {
+                        for (int Y = ViewY; Y < ViewY + ViewDimY; ++Y)
+                        {
+                            for (int X = ViewX; X < ViewX + ViewDimX; ++X)
+                            {
+                                Sum += GetTileValue(&World, MinTile + X, MinTile + Y);
+                            }
+                        }
+                    }
+                    else if (Method == 1)
+                    {
+                        int32 MinX = MinTile + ViewX;
+                        int32 MinY = MinTile + ViewY;
+                        int32 MaxX = MinX + ViewDimX;
+                        int32 MaxY = MinY + ViewDimY;
+                        for (int32 ChunkY = MinY >> TILE_CHUNK_SHIFT; ChunkY <= ((MaxY - 1) >> TILE_CHUNK_SHIFT);
+                                ++ChunkY)
+                        {
+                            for (int32 ChunkX = MinX >> TILE_CHUNK_SHIFT;
+                                    ChunkX <= ((MaxX - 1) >> TILE_CHUNK_SHIFT); ++ChunkX)
+                            {
+                                tile_chunk *Chunk = GetTileChunk(&World, ChunkX, ChunkY);
+                                int32 ChunkMinX = ChunkX * TILE_CHUNK_DIM;
+                                int32 ChunkMinY = ChunkY * TILE_CHUNK_DIM;
+                                int32 FromX = (MinX > ChunkMinX) ? MinX : ChunkMinX;
+                                int32 FromY = (MinY > ChunkMinY) ? MinY : ChunkMinY;
+                                int32 ToX = (MaxX < ChunkMinX + TILE_CHUNK_DIM) ? MaxX : ChunkMinX + TILE_CHUNK_DIM;
+                                int32 ToY = (MaxY < ChunkMinY + TILE_CHUNK_DIM) ? MaxY : ChunkMinY + TILE_CHUNK_DIM;
+                                for (int32 Y = FromY; Y < ToY; ++Y)
+                                {
+                                    uint32 *Row = GetChunkTile(Chunk, 0, Y);
+                                    for (int32 X = FromX; X < ToX; ++X)
+                                    {
+                                        Sum += Row[X & TILE_CHUNK_MASK];
+                                    }
+                                }
+                            }
+                        }
+                    }
+                    else
+                    {
+                        for (int Y = ViewY; Y < ViewY + ViewDimY; ++Y)
+                        {
+                            uint32 *Row = Flat + Y * TileDim;
+                            for (int X = ViewX; X < ViewX + ViewDimX; ++X)
+                            {
+                                Sum += Row[X];
+                            }
+                        }
+                    }
+                }
+                BenchAddRepeat(&Camera[Method], Start, LinuxGetWallClock());
+                Sums[Method] = Sum;
+            }
+        }
+        if ((Sums[0] != Sums[2]) || (Sums[1] != Sums[2]))
+        {
+            fprintf(stderr, "camera lookups disagree with the flat array\n");
+            Result = false;
+        }
+
+        char *MethodNames[] = {(char *)"per tile ", (char *)"per chunk", (char *)"flat     "};
+        for (int Method = 0; Method < 3; ++Method)
+        {
+            printf("  camera %s %d frames  best %7.03fms  %6.02f ns/tile\n", MethodNames[Method], FrameCount,
+                    Camera[Method].MinMS, 1000000.0 * Camera[Method].MinMS / ViewTileCount);
+        }
+    }
+
+    munmap(Arena.Base, ArenaSize);
+    return(Result);
+}
+
+// =====================================================================================================================
+//NOTE: Entities
+
+inline world_position BenchRandomWorldPosition(real32 Side)
+{
+    world_position Origin = {};
+    world_position Result = MapIntoChunkSpace(Origin, Side * ((real32)BenchRandom() / 4294967296.0f - 0.5f),
+            Side * ((real32)BenchRandom() / 4294967296.0f - 0.5f));
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 BenchCheckEntityHandles(memory_arena *Arena)
+{
+    //NOTE: Each entity's VX is its serial number, so whatever a handle finds can be checked against what it was
+    //  handed out for.
+    bool32 Result = true;
+    temporary_memory CheckMemory = BeginTemporaryMemory(Arena);
+
+    uint32 MaxEntityCount = 5000;
+    entity_store Store;
+    InitializeEntityStore(&Store, Arena, MaxEntityCount, 1);
+    entity_handle *Handles = PushArray(Arena, 2 * MaxEntityCount, entity_handle);
+    bool32 *Live = PushArray(Arena, 2 * MaxEntityCount, bool32);
+    uint32 HandleCount = 0;
+    for (int Round = 0; Result && (Round < 2); ++Round)
+    {
+        while (Store.LowCount < MaxEntityCount)
+        {
+            Handles[HandleCount] = AddEntity(&Store, BenchRandomWorldPosition(100.0f), (real32)HandleCount, 0.0f, 0);
+            Live[HandleCount++] = true;
+        }
+        entity_handle Overflow = AddEntity(&Store, BenchRandomWorldPosition(100.0f), 0.0f, 0.0f, 0);
+        if (Overflow.SlotIndex)
+        {
+            fprintf(stderr, "full entity store handed out another handle\n");
+            Result = false;
+        }
+
+        for (uint32 HandleIndex = 0; HandleIndex < HandleCount; ++HandleIndex)
+        {
+            if (Live[HandleIndex] && (BenchRandom() & 1))
+            {
+                Live[HandleIndex] = false;
+                if (!RemoveEntity(&Store, Handles[HandleIndex]) || RemoveEntity(&Store, Handles[HandleIndex]))
+                {
+                    fprintf(stderr, "entity %u didn't come out exactly once\n", HandleIndex);
+                    Result = false;
+                }
+            }
+        }
+    }
+
+    uint32 LiveCount = 0;
+    for (uint32 HandleIndex = 0; Result && (HandleIndex < HandleCount); ++HandleIndex)
+    {
+        uint32 LowIndex;
+        bool32 Found = GetEntityLowIndex(&Store, Handles[HandleIndex], &LowIndex);
+        if (Found != Live[HandleIndex])
+        {
+            fprintf(stderr, "handle %u is %s after removals\n", HandleIndex, Found ? "still live" : "lost");
+            Result = false;
+        }
+        else if (Found)
+        {
+            ++LiveCount;
+            uint32 HighIndex = Store.LowHighIndex[LowIndex];
+            if ((Store.LowVX[LowIndex] != (real32)HandleIndex) ||
+                    (Store.LowSlot[LowIndex] != Handles[HandleIndex].SlotIndex) ||
+                    (HighIndex && (Store.HighLowIndex[HighIndex - 1] != LowIndex)))
+            {
+                fprintf(stderr, "handle %u finds the wrong entity\n", HandleIndex);
+                Result = false;
+            }
+        }
+    }
+    if (Result && (LiveCount != Store.LowCount))
+    {
+        fprintf(stderr, "%u live handles for %u entities\n", LiveCount, Store.LowCount);
+        Result = false;
+    }
+
+    EndTemporaryMemory(CheckMemory);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 BenchCheckEntityIntegration(memory_arena *Arena)
+{
+    bool32 Result = true;
+    for (uint32 Count = 0; Result && (Count < 40); ++Count)
+    {
+        temporary_memory CheckMemory = BeginTemporaryMemory(Arena);
+        entity_store Stores[2];
+        for (int StoreIndex = 0; StoreIndex < 2; ++StoreIndex)
+        {
+            InitializeEntityStore(Stores + StoreIndex, Arena, Count, 1000);
+        }
+        for (uint32 EntityIndex = 0; EntityIndex < Count; ++EntityIndex)
+        {
+            world_position P = BenchRandomWorldPosition(1000.0f);
+            real32 VX = (real32)BenchRandomBetween(-100000, 100000) / 997.0f;
+            real32 VY = (real32)BenchRandomBetween(-100000, 100000) / 991.0f;
+            AddEntity(Stores + 0, P, VX, VY, 0);
+            AddEntity(Stores + 1, P, VX, VY, 0);
+        }
+
+        IntegrateHighEntitiesScalar(Stores + 0, 0.0173f);
+        IntegrateHighEntitiesSSE2(Stores + 1, 0.0173f);
+        if ((Stores[0].HighCount != Count) ||
+                memcmp(Stores[0].HighPX, Stores[1].HighPX, Count * sizeof(real32)) ||
+                memcmp(Stores[0].HighPY, Stores[1].HighPY, Count * sizeof(real32)))
+        {
+            fprintf(stderr, "SSE2 entity integration differs from scalar with %u entities\n", Count);
+            Result = false;
+        }
+        EndTemporaryMemory(CheckMemory);
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 BenchCheckEntityTiers(memory_arena *Arena)
+{
+    //NOTE: A camera sweeps across a field of drifting entities. Whichever tiers an entity passes through on the way,
+    //  it has to end up where its velocity says, and the high set has to be exactly the entities near the camera.
+    bool32 Result = true;
+    temporary_memory CheckMemory = BeginTemporaryMemory(Arena);
+
+    uint32 EntityCount = 20000;
+    real32 Side = 1024.0f;
+    real32 dt = 1.0f / 60.0f;
+    int FrameCount = 600;
+    entity_store Store;
+    InitializeEntityStore(&Store, Arena, EntityCount, 2);
+
+    entity_handle *Handles = PushArray(Arena, EntityCount, entity_handle);
+    world_position *Starts = PushArray(Arena, EntityCount, world_position);
+    for (uint32 EntityIndex = 0; EntityIndex < EntityCount; ++EntityIndex)
+    {
+        Starts[EntityIndex] = BenchRandomWorldPosition(Side);
+        real32 VX = (real32)BenchRandomBetween(-300, 300) / 64.0f;
+        real32 VY = (real32)BenchRandomBetween(-300, 300) / 64.0f;
+        Handles[EntityIndex] = AddEntity(&Store, Starts[EntityIndex], VX, VY,
+                (EntityIndex % 16) ? 0 : EntityFlag_NeverHigh);
+    }
+
+    world_position CameraP = {};
+    for (int Frame = 0; Frame < FrameCount; ++Frame)
+    {
+        CameraP = MapIntoChunkSpace(CameraP, 0.5f, 0.25f);
+        UpdateEntities(&Store, CameraP, dt, IntegrateHighEntitiesSSE2);
+    }
+
+    //NOTE: One more round of low ticks with time standing still, so every low entity has been looked at since
+    //  anything last moved.
+    uint32 MaxHighCount = 0;
+    for (int Frame = 0; Frame < LOW_ENTITY_TICK_INTERVAL; ++Frame)
+    {
+        UpdateEntities(&Store, CameraP, 0.0f, IntegrateHighEntitiesSSE2);
+        MaxHighCount = (Store.HighCount > MaxHighCount) ? Store.HighCount : MaxHighCount;
+    }
+
+    real32 MaxError = 0.0f;
+    for (uint32 EntityIndex = 0; Result && (EntityIndex < EntityCount); ++EntityIndex)
+    {
+        uint32 LowIndex;
+        world_position P;
+        if (!GetEntityLowIndex(&Store, Handles[EntityIndex], &LowIndex) ||
+                !GetEntityPosition(&Store, Handles[EntityIndex], &P))
+        {
+            fprintf(stderr, "entity %u went missing\n", EntityIndex);
+            Result = false;
+            break;
+        }
+
+        real32 Seconds = (real32)Store.Time;
+        world_position Expected = MapIntoChunkSpace(Starts[EntityIndex], Store.LowVX[LowIndex] * Seconds,
+                Store.LowVY[LowIndex] * Seconds);
+        bool32 IsHigh = (Store.LowHighIndex[LowIndex] != 0);
+        if (IsHigh)
+        {
+            uint32 HighIndex = Store.LowHighIndex[LowIndex] - 1;
+            Expected = MapIntoChunkSpace(Starts[EntityIndex], Store.HighVX[HighIndex] * Seconds,
+                    Store.HighVY[HighIndex] * Seconds);
+        }
+        world_difference Error = SubtractPositions(P, Expected);
+        real32 Distance = fabsf(Error.dX) + fabsf(Error.dY);
+        MaxError = (Distance > MaxError) ? Distance : MaxError;
+
+        bool32 NeverHigh = (Store.LowFlags[LowIndex] & EntityFlag_NeverHigh);
+        bool32 InRegion = IsInHighRegion(&Store, P, Store.HighChunkRadius);
+        bool32 InDemoteRegion = IsInHighRegion(&Store, P, Store.HighChunkRadius + 1);
+        if ((IsHigh && (NeverHigh || !InDemoteRegion)) || (!IsHigh && !NeverHigh && InRegion))
+        {
+            fprintf(stderr, "entity %u is %s at chunk distance %d, %d\n", EntityIndex, IsHigh ? "high" : "low",
+                    P.ChunkX - CameraP.ChunkX, P.ChunkY - CameraP.ChunkY);
+            Result = false;
+        }
+    }
+
+    printf("  tiers: %u entities, %u promotions, %u demotions, at most %u high, worst drift %.04fm over %.01fs\n",
+            EntityCount, Store.PromoteCount, Store.DemoteCount, MaxHighCount, MaxError, Store.Time);
+    if (Result && ((MaxError > 0.01f) || !Store.PromoteCount || !Store.DemoteCount))
+    {
+        fprintf(stderr, "entities drifted from where their velocity puts them, or the tiers never changed\n");
+        Result = false;
+    }
+
+    EndTemporaryMemory(CheckMemory);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+//NOTE: What an entity would look like as one struct, for comparison.
+struct bench_aos_entity
+{
+    world_position LowP;
+    real32 PX;
+    real32 PY;
+    real32 VX;
+    real32 VY;
+    uint32 Flags;
+    entity_handle Handle;
+    uint32 HighIndex;
+    real64 UpdatedAt;
+    uint32 Reserved[2];
+};
+
+internal BENCH_FUNCTION(BenchEntities)
+{
+    memory_index ArenaSize = Megabytes(192);
+    memory_arena Arena;
+    InitializeArena(&Arena, (char *)"Entities", ArenaSize, LinuxAllocateMemory(ArenaSize));
+
+    printf("entities (%u bytes per entity as one struct)\n", (uint32)sizeof(bench_aos_entity));
+    bool32 Result = BenchCheckEntityHandles(&Arena);
+    Result = Result && BenchCheckEntityIntegration(&Arena);
+    Result = Result && BenchCheckEntityTiers(&Arena);
+
+    uint32 Counts[] = {10000, 100000, 1000000};
+    for (int CountIndex = 0; Result && (CountIndex < (int)ArrayCount(Counts)); ++CountIndex)
+    {
+        uint32 Count = Counts[CountIndex];
+        temporary_memory CountMemory = BeginTemporaryMemory(&Arena);
+
+        //NOTE: Everything high, to time the integration on its own.
+        entity_store Store;
+        InitializeEntityStore(&Store, &Arena, Count, 1 << 20);
+        bench_aos_entity *Structs = PushArray(&Arena, Count, bench_aos_entity, 64);
+        for (uint32 EntityIndex = 0; EntityIndex < Count; ++EntityIndex)
+        {
+            world_position P = BenchRandomWorldPosition(4096.0f);
+            real32 VX = (real32)BenchRandomBetween(-300, 300) / 64.0f;
+            real32 VY = (real32)BenchRandomBetween(-300, 300) / 64.0f;
+            AddEntity(&Store, P, VX, VY, 0);
+
+            bench_aos_entity *Struct = Structs + EntityIndex;
+            *Struct = {};
+            Struct->LowP = P;
+            Struct->PX = Store.HighPX[EntityIndex];
+            Struct->PY = Store.HighPY[EntityIndex];
+            Struct->VX = VX;
+            Struct->VY = VY;
+        }
+
+        bench_timer Timers[3];
+        for (int Method = 0; Method < 3; ++Method)
+        {
+            BenchBeginRepeat(&Timers[Method]);
+            for (int Repeat = 0; Repeat < 20; ++Repeat)
+            {
+                uint64 Start = LinuxGetWallClock();
+                if (Method == 0)
+                {
+                    for (uint32 EntityIndex = 0; EntityIndex < Count; ++EntityIndex)
+                    {
+                        bench_aos_entity *Struct = Structs + EntityIndex;
+                        Struct->PX = Struct->PX + Struct->VX * 0.001f;
+                        Struct->PY = Struct->PY + Struct->VY * 0.001f;
+                    }
+                }
+                else if (Method == 1)
+                {
+                    IntegrateHighEntitiesScalar(&Store, 0.001f);
+                }
+                else
+                {
+                    IntegrateHighEntitiesSSE2(&Store, 0.001f);
+                }
+                BenchAddRepeat(&Timers[Method], Start, LinuxGetWallClock());
+            }
+        }
+        printf("  %7u integrate  struct %8.03fms  arrays %8.03fms  SSE2 %8.03fms  (%5.02f ns/entity)\n", Count,
+                Timers[0].MinMS, Timers[1].MinMS, Timers[2].MinMS, 1000000.0 * Timers[2].MinMS / Count);
+
+        //NOTE: A whole frame with the entities spread out the way a game would have them: a few hundred near the
+        //  camera, the rest low.
+        EndTemporaryMemory(CountMemory);
+        CountMemory = BeginTemporaryMemory(&Arena);
+        InitializeEntityStore(&Store, &Arena, Count, 2);
+        real32 Side = 16.0f * sqrtf((real32)Count);
+        for (uint32 EntityIndex = 0; EntityIndex < Count; ++EntityIndex)
+        {
+            AddEntity(&Store, BenchRandomWorldPosition(Side), (real32)BenchRandomBetween(-300, 300) / 64.0f,
+                    (real32)BenchRandomBetween(-300, 300) / 64.0f, 0);
+        }
+
+        world_position CameraP = {};
+        bench_timer Frame;
+        BenchBeginRepeat(&Frame);
+        uint32 HighTotal = 0;
+        int FrameCount = 240;
+        for (int FrameIndex = 0; FrameIndex < FrameCount; ++FrameIndex)
+        {
+            CameraP = MapIntoChunkSpace(CameraP, 0.25f, 0.125f);
+            uint64 Start = LinuxGetWallClock();
+            UpdateEntities(&Store, CameraP, 1.0f / 60.0f, IntegrateHighEntitiesSSE2);
+            BenchAddRepeat(&Frame, Start, LinuxGetWallClock());
+            HighTotal += Store.HighCount;
+        }
+        printf("  %7u frame      best %7.03fms  avg %7.03fms  %5u high on average, %u promotions, %u demotions\n",
+                Count, Frame.MinMS, BenchAverageMS(&Frame), HighTotal / FrameCount, Store.PromoteCount,
+                Store.DemoteCount);
+
+        EndTemporaryMemory(CountMemory);
+    }
+
+    munmap(Arena.Base, ArenaSize);
+    return(Result);
+}
+
+// =====================================================================================================================
+//NOTE: Collision
+
+struct bench_collision_scene
+{
+    uint32 EntityCount;
+    real32 *PX;
+    real32 *PY;
+    real32 HalfExtent;
+
+    uint32 QueryCount;
+    real32 *QueryMinX;
+    real32 *QueryMinY;
+    real32 *QueryMaxX;
+    real32 *QueryMaxY;
+
+    uint32 RayCount;
+    real32 *RayX;
+    real32 *RayY;
+    real32 *RaydX;
+    real32 *RaydY;
+    uint32 *RayIgnore;
+};
+
+// =====================================================================================================================
+
+inline real32 BenchRandomReal(real32 Min, real32 Max)
+{
+    real32 Result = Min + (Max - Min) * ((real32)(BenchRandom() >> 8) * (1.0f / 16777216.0f));
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void BenchMakeCollisionScene(bench_collision_scene *Scene, memory_arena *Arena, uint32 EntityCount,
+        real32 Side, real32 HalfExtent, uint32 QueryCount, real32 QuerySize, uint32 RayCount, real32 RayLength,
+        bool32 Uneven)
+{
+    //NOTE: Spread over a Side-wide square centered on the origin. An uneven scene also has a dense clump in the middle
+    //  and some stragglers out past the edges, to exercise the crowded cells and the clamped border cells.
+    Scene->EntityCount = EntityCount;
+    Scene->HalfExtent = HalfExtent;
+    Scene->PX = PushArray(Arena, EntityCount, real32, 64);
+    Scene->PY = PushArray(Arena, EntityCount, real32, 64);
+    for (uint32 EntityIndex = 0; EntityIndex < EntityCount; ++EntityIndex)
+    {
+        uint32 Kind = Uneven ? (BenchRandom() % 10) : 2;
+        real32 Extent = (Kind == 0) ? 2.0f : ((Kind == 1) ? 0.6f : 0.5f) * Side;
+        Scene->PX[EntityIndex] = BenchRandomReal(-Extent, Extent);
+        Scene->PY[EntityIndex] = BenchRandomReal(-Extent, Extent);
+    }
+
+    Scene->QueryCount = QueryCount;
+    Scene->QueryMinX = PushArray(Arena, QueryCount, real32, 64);
+    Scene->QueryMinY = PushArray(Arena, QueryCount, real32, 64);
+    Scene->QueryMaxX = PushArray(Arena, QueryCount, real32, 64);
+    Scene->QueryMaxY = PushArray(Arena, QueryCount, real32, 64);
+    for (uint32 QueryIndex = 0; QueryIndex < QueryCount; ++QueryIndex)
+    {
+        real32 X = BenchRandomReal(-0.6f * Side, 0.6f * Side);
+        real32 Y = BenchRandomReal(-0.6f * Side, 0.6f * Side);
+        Scene->QueryMinX[QueryIndex] = X;
+        Scene->QueryMinY[QueryIndex] = Y;
+        Scene->QueryMaxX[QueryIndex] = X + BenchRandomReal(0.0f, QuerySize);
+        Scene->QueryMaxY[QueryIndex] = Y + BenchRandomReal(0.0f, QuerySize);
+    }
+
+    Scene->RayCount = RayCount;
+    Scene->RayX = PushArray(Arena, RayCount, real32, 64);
+    Scene->RayY = PushArray(Arena, RayCount, real32, 64);
+    Scene->RaydX = PushArray(Arena, RayCount, real32, 64);
+    Scene->RaydY = PushArray(Arena, RayCount, real32, 64);
+    Scene->RayIgnore = PushArray(Arena, RayCount, uint32, 64);
+    for (uint32 RayIndex = 0; RayIndex < RayCount; ++RayIndex)
+    {
+        //NOTE: Some rays are entities casting their own moves, some are axis aligned, some start out past the grid.
+        uint32 Kind = BenchRandom() % 4;
+        uint32 Entity = BenchRandom() % EntityCount;
+        Scene->RayIgnore[RayIndex] = (Kind == 0) ? Entity : COLLISION_NO_HIT;
+        Scene->RayX[RayIndex] = (Kind == 0) ? Scene->PX[Entity] : BenchRandomReal(-0.6f * Side, 0.6f * Side);
+        Scene->RayY[RayIndex] = (Kind == 0) ? Scene->PY[Entity] : BenchRandomReal(-0.6f * Side, 0.6f * Side);
+        Scene->RaydX[RayIndex] = (Kind == 1) ? 0.0f : BenchRandomReal(-RayLength, RayLength);
+        Scene->RaydY[RayIndex] = (Kind == 2) ? 0.0f : BenchRandomReal(-RayLength, RayLength);
+    }
+}
+
+// =====================================================================================================================
+
+internal void BenchInitializeSceneGrid(collision_grid *Grid, memory_arena *Arena, bench_collision_scene *Scene,
+        real32 Side)
+{
+    real32 CellSize = 2.0f;
+    int32 CellCount = (int32)ceilf(Side / CellSize);
+    InitializeCollisionGrid(Grid, Arena, Scene->EntityCount, -0.5f * CellSize * (real32)CellCount,
+            -0.5f * CellSize * (real32)CellCount, CellSize, CellCount, CellCount, Scene->HalfExtent);
+}
+
+// =====================================================================================================================
+
+internal int BenchComparePairs(const void *A, const void *B)
+{
+    collision_pair *PairA = (collision_pair *)A;
+    collision_pair *PairB = (collision_pair *)B;
+    int Result = (PairA->A != PairB->A) ? ((PairA->A < PairB->A) ? -1 : 1) :
+        ((PairA->B != PairB->B) ? ((PairA->B < PairB->B) ? -1 : 1) : 0);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal uint32 BenchBruteQueryBoxes(bench_collision_scene *Scene, collision_pair *Pairs, uint32 MaxPairCount)
+{
+    uint32 PairCount = 0;
+    real32 Half = Scene->HalfExtent;
+    for (uint32 QueryIndex = 0; QueryIndex < Scene->QueryCount; ++QueryIndex)
+    {
+        for (uint32 EntityIndex = 0; EntityIndex < Scene->EntityCount; ++EntityIndex)
+        {
+            if ((Scene->QueryMinX[QueryIndex] < Scene->PX[EntityIndex] + Half) &&
+                    (Scene->PX[EntityIndex] - Half < Scene->QueryMaxX[QueryIndex]) &&
+                    (Scene->QueryMinY[QueryIndex] < Scene->PY[EntityIndex] + Half) &&
+                    (Scene->PY[EntityIndex] - Half < Scene->QueryMaxY[QueryIndex]) && (PairCount < MaxPairCount))
+            {
+                Pairs[PairCount].A = QueryIndex;
+                Pairs[PairCount].B = EntityIndex;
+                ++PairCount;
+            }
+        }
+    }
+    return(PairCount);
+}
+
+// =====================================================================================================================
+
+internal uint32 BenchBruteCollidingEntities(bench_collision_scene *Scene, collision_pair *Pairs,
+        uint32 MaxPairCount)
+{
+    uint32 PairCount = 0;
+    real32 Half = Scene->HalfExtent;
+    for (uint32 A = 0; A < Scene->EntityCount; ++A)
+    {
+        for (uint32 B = A + 1; B < Scene->EntityCount; ++B)
+        {
+            if ((Scene->PX[A] - Half < Scene->PX[B] + Half) && (Scene->PX[B] - Half < Scene->PX[A] + Half) &&
+                    (Scene->PY[A] - Half < Scene->PY[B] + Half) && (Scene->PY[B] - Half < Scene->PY[A] + Half) &&
+                    (PairCount < MaxPairCount))
+            {
+                Pairs[PairCount].A = A;
+                Pairs[PairCount].B = B;
+                ++PairCount;
+            }
+        }
+    }
+    return(PairCount);
+}
+
+// =====================================================================================================================
+
+internal void BenchBruteCastRays(bench_collision_scene *Scene, uint32 *HitEntity, real32 *HitT)
+{
+    real32 Half = Scene->HalfExtent;
+    for (uint32 RayIndex = 0; RayIndex < Scene->RayCount; ++RayIndex)
+    {
+        HitEntity[RayIndex] = COLLISION_NO_HIT;
+        HitT[RayIndex] = 1.0f;
+        real32 BestT = 2.0f;
+        for (uint32 EntityIndex = 0; EntityIndex < Scene->EntityCount; ++EntityIndex)
+        {
+            real32 t;
+            if ((EntityIndex != Scene->RayIgnore[RayIndex]) &&
+                    IntersectRayBox(Scene->RayX[RayIndex], Scene->RayY[RayIndex], Scene->RaydX[RayIndex],
+                        Scene->RaydY[RayIndex], Scene->PX[EntityIndex] - Half, Scene->PY[EntityIndex] - Half,
+                        Scene->PX[EntityIndex] + Half, Scene->PY[EntityIndex] + Half, &t) && (t < BestT))
+            {
+                BestT = t;
+                HitEntity[RayIndex] = EntityIndex;
+                HitT[RayIndex] = t;
+            }
+        }
+    }
+}
+
+// =====================================================================================================================
+
+internal bool32 BenchCheckCollisionGrid(collision_grid *Grid, bench_collision_scene *Scene, memory_arena *Arena)
+{
+    //NOTE: Everything the grid answers has to match brute force exactly, pair for pair and hit for hit.
+    bool32 Result = true;
+    temporary_memory CheckMemory = BeginTemporaryMemory(Arena);
+
+    uint32 MaxPairCount = 1 << 20;
+    collision_pair *Expected = PushArray(Arena, MaxPairCount, collision_pair);
+    collision_pair *Actual = PushArray(Arena, MaxPairCount, collision_pair);
+
+    uint32 ExpectedCount = BenchBruteQueryBoxes(Scene, Expected, MaxPairCount);
+    uint32 ActualCount = QueryCollisionBoxes(Grid, Scene->QueryCount, Scene->QueryMinX, Scene->QueryMinY,
+            Scene->QueryMaxX, Scene->QueryMaxY, Actual, MaxPairCount);
+    qsort(Actual, ActualCount, sizeof(collision_pair), BenchComparePairs);
+    if ((ExpectedCount != ActualCount) || memcmp(Expected, Actual, ActualCount * sizeof(collision_pair)))
+    {
+        fprintf(stderr, "box queries found %u pairs, brute force %u\n", ActualCount, ExpectedCount);
+        Result = false;
+    }
+
+    ExpectedCount = BenchBruteCollidingEntities(Scene, Expected, MaxPairCount);
+    ActualCount = FindCollidingEntities(Grid, Actual, MaxPairCount);
+    qsort(Actual, ActualCount, sizeof(collision_pair), BenchComparePairs);
+    if ((ExpectedCount != ActualCount) || memcmp(Expected, Actual, ActualCount * sizeof(collision_pair)))
+    {
+        fprintf(stderr, "entity pairs found %u, brute force %u\n", ActualCount, ExpectedCount);
+        Result = false;
+    }
+
+    uint32 *ExpectedHit = PushArray(Arena, Scene->RayCount, uint32);
+    uint32 *ActualHit = PushArray(Arena, Scene->RayCount, uint32);
+    real32 *ExpectedT = PushArray(Arena, Scene->RayCount, real32);
+    real32 *ActualT = PushArray(Arena, Scene->RayCount, real32);
+    BenchBruteCastRays(Scene, ExpectedHit, ExpectedT);
+    CastCollisionRays(Grid, Scene->RayCount, Scene->RayX, Scene->RayY, Scene->RaydX, Scene->RaydY, Scene->RayIgnore,
+            ActualHit, ActualT);
+    for (uint32 RayIndex = 0; Result && (RayIndex < Scene->RayCount); ++RayIndex)
+    {
+        if ((ExpectedHit[RayIndex] != ActualHit[RayIndex]) || (ExpectedT[RayIndex] != ActualT[RayIndex]))
+        {
+            fprintf(stderr, "ray %u hit entity %d at %f, brute force %d at %f\n", RayIndex, (int32)ActualHit[RayIndex],
+                    ActualT[RayIndex], (int32)ExpectedHit[RayIndex], ExpectedT[RayIndex]);
+            Result = false;
+        }
+    }
+
+    if (Grid->DroppedPairCount)
+    {
+        fprintf(stderr, "grid dropped %u pairs\n", Grid->DroppedPairCount);
+        Result = false;
+    }
+
+    EndTemporaryMemory(CheckMemory);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 BenchCheckWallSliding(memory_arena *Arena)
+{
+    bool32 Result = true;
+    temporary_memory CheckMemory = BeginTemporaryMemory(Arena);
+
+    //NOTE: Far out, to show nothing here leans on being near the origin. A wall runs up the x = 4 column and along
+    //  the y = 3 row, relative to the base tile.
+    int32 BaseX = 1 << 24;
+    int32 BaseY = -(1 << 24);
+    world World;
+    InitializeWorld(&World, Arena, 256);
+    for (int32 Along = -10; Along <= 10; ++Along)
+    {
+        SetTileValue(&World, BaseX + 4, BaseY + Along, TileValue_Wall);
+    }
+
+    real32 Half = PLAYER_HALF_SIDE;
+    tile_position Start = {BaseX + 2, BaseY, 0.5f, 0.5f};
+    world_position P = MoveAgainstWalls(&World, GetWorldPosition(Start), Half, Half, 3.0f, 1.0f);
+    tile_position End = GetTilePosition(P);
+    real32 EndX = (real32)(End.TileX - BaseX) + End.TileOffsetX;
+    real32 EndY = (real32)(End.TileY - BaseY) + End.TileOffsetY;
+    if ((EndX >= 4.0f - Half) || (EndX < 4.0f - Half - 0.01f) || (fabsf(EndY - 1.5f) > 0.0001f))
+    {
+        fprintf(stderr, "sliding along a wall ended at %f, %f, expected %f, 1.5\n", EndX, EndY, 4.0f - Half);
+        Result = false;
+    }
+
+    for (int32 Along = -10; Along <= 10; ++Along)
+    {
+        SetTileValue(&World, BaseX + Along, BaseY + 3, TileValue_Wall);
+    }
+    P = MoveAgainstWalls(&World, GetWorldPosition(Start), Half, Half, 3.0f, 3.0f);
+    End = GetTilePosition(P);
+    EndX = (real32)(End.TileX - BaseX) + End.TileOffsetX;
+    EndY = (real32)(End.TileY - BaseY) + End.TileOffsetY;
+    if ((EndX >= 4.0f - Half) || (EndX < 4.0f - Half - 0.01f) || (EndY >= 3.0f - Half) ||
+            (EndY < 3.0f - Half - 0.01f))
+    {
+        fprintf(stderr, "moving into a corner ended at %f, %f\n", EndX, EndY);
+        Result = false;
+    }
+
+    //NOTE: A long random walk through a room strewn with wall tiles never ends a move overlapping one.
+    int32 RoomDim = 32;
+    for (int32 Y = 0; Y < RoomDim; ++Y)
+    {
+        for (int32 X = 0; X < RoomDim; ++X)
+        {
+            bool32 IsWall = (X == 0) || (Y == 0) || (X == RoomDim - 1) || (Y == RoomDim - 1) ||
+                ((BenchRandom() % 10) == 0);
+            SetTileValue(&World, BaseX + 100 + X, BaseY + Y, ((X == 16) && (Y == 16)) ? TileValue_Floor :
+                    (IsWall ? TileValue_Wall : TileValue_Floor));
+        }
+    }
+    tile_position RoomStart = {BaseX + 116, BaseY + 16, 0.5f, 0.5f};
+    P = GetWorldPosition(RoomStart);
+    real32 Travelled = 0.0f;
+    for (int Move = 0; Result && (Move < 20000); ++Move)
+    {
+        real32 dX = BenchRandomReal(-0.5f, 0.5f);
+        real32 dY = BenchRandomReal(-0.5f, 0.5f);
+        world_position NewP = MoveAgainstWalls(&World, P, Half, Half, dX, dY);
+        world_difference Moved = SubtractPositions(NewP, P);
+        Travelled += sqrtf(Moved.dX * Moved.dX + Moved.dY * Moved.dY);
+        if (sqrtf(Moved.dX * Moved.dX + Moved.dY * Moved.dY) > sqrtf(dX * dX + dY * dY) + 0.0001f)
+        {
+            fprintf(stderr, "move %d went further than asked\n", Move);
+            Result = false;
+        }
+        P = NewP;
+
+        tile_position Tile = GetTilePosition(P);
+        for (int32 dTileY = -1; dTileY <= 1; ++dTileY)
+        {
+            for (int32 dTileX = -1; dTileX <= 1; ++dTileX)
+            {
+                real32 MinX = (real32)dTileX - Tile.TileOffsetX;
+                real32 MinY = (real32)dTileY - Tile.TileOffsetY;
+                if ((GetTileValue(&World, Tile.TileX + dTileX, Tile.TileY + dTileY) == TileValue_Wall) &&
+                        (-Half < MinX + 1.0f) && (MinX < Half) && (-Half < MinY + 1.0f) && (MinY < Half))
+                {
+                    fprintf(stderr, "move %d ended inside a wall\n", Move);
+                    Result = false;
+                }
+            }
+        }
+    }
+    printf("  wall sliding: random walk covered %.0fm without entering a wall\n", Travelled);
+
+    EndTemporaryMemory(CheckMemory);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal BENCH_FUNCTION(BenchCollision)
+{
+    memory_index ArenaSize = Megabytes(256);
+    memory_arena Arena;
+    InitializeArena(&Arena, (char *)"Collision", ArenaSize, LinuxAllocateMemory(ArenaSize));
+
+    printf("collision\n");
+    bool32 Result = true;
+    {
+        temporary_memory CheckMemory = BeginTemporaryMemory(&Arena);
+        bench_collision_scene Scene;
+        BenchMakeCollisionScene(&Scene, &Arena, 4000, 80.0f, 0.5f, 1000, 8.0f, 2000, 30.0f, true);
+        collision_grid Grid;
+        BenchInitializeSceneGrid(&Grid, &Arena, &Scene, 80.0f);
+        BuildCollisionGrid(&Grid, Scene.PX, Scene.PY, Scene.EntityCount);
+        Result = BenchCheckCollisionGrid(&Grid, &Scene, &Arena);
+
+        //NOTE: Nudges small enough that no box edge crosses a cell edge take the in-place path, and the answers still
+        //  match.
+        for (uint32 EntityIndex = 0; EntityIndex < Scene.EntityCount; ++EntityIndex)
+        {
+            real32 X = Scene.PX[EntityIndex];
+            real32 MinInCell = (X - Scene.HalfExtent) - Grid.CellSize * floorf((X - Scene.HalfExtent) / Grid.CellSize);
+            real32 MaxInCell = (X + Scene.HalfExtent) - Grid.CellSize * floorf((X + Scene.HalfExtent) / Grid.CellSize);
+            if ((MinInCell > 0.01f) && (MinInCell < Grid.CellSize - 0.01f) &&
+                    (MaxInCell > 0.01f) && (MaxInCell < Grid.CellSize - 0.01f))
+            {
+                Scene.PX[EntityIndex] = X + ((BenchRandom() & 1) ? 0.001f : -0.001f);
+            }
+        }
+        uint32 RefreshCount = Grid.RefreshCount;
+        BuildCollisionGrid(&Grid, Scene.PX, Scene.PY, Scene.EntityCount);
+        if (Grid.RefreshCount != RefreshCount + 1)
+        {
+            fprintf(stderr, "grid rebuilt although nothing changed cells\n");
+            Result = false;
+        }
+        Result = Result && BenchCheckCollisionGrid(&Grid, &Scene, &Arena);
+
+        //NOTE: Then moves that do cross cells rebuild.
+        for (uint32 EntityIndex = 0; EntityIndex < Scene.EntityCount; ++EntityIndex)
+        {
+            Scene.PX[EntityIndex] += BenchRandomReal(-1.5f, 1.5f);
+            Scene.PY[EntityIndex] += BenchRandomReal(-1.5f, 1.5f);
+        }
+        uint32 RebuildCount = Grid.RebuildCount;
+        BuildCollisionGrid(&Grid, Scene.PX, Scene.PY, Scene.EntityCount);
+        if (Grid.RebuildCount != RebuildCount + 1)
+        {
+            fprintf(stderr, "grid didn't rebuild after entities changed cells\n");
+            Result = false;
+        }
+        Result = Result && BenchCheckCollisionGrid(&Grid, &Scene, &Arena);
+        EndTemporaryMemory(CheckMemory);
+    }
+    Result = Result && BenchCheckWallSliding(&Arena);
+
+    //NOTE: Constant density, one entity per 16 square meters, as the count goes up.
+    uint32 Counts[] = {1000, 10000, 100000};
+    for (int CountIndex = 0; Result && (CountIndex < (int)ArrayCount(Counts)); ++CountIndex)
+    {
+        temporary_memory CountMemory = BeginTemporaryMemory(&Arena);
+        uint32 Count = Counts[CountIndex];
+        real32 Side = 4.0f * sqrtf((real32)Count);
+        uint32 QueryCount = 10000;
+        bench_collision_scene Scene;
+        BenchMakeCollisionScene(&Scene, &Arena, Count, Side, 0.5f, QueryCount, 4.0f, QueryCount, 16.0f, false);
+        collision_grid Grid;
+        BenchInitializeSceneGrid(&Grid, &Arena, &Scene, Side);
+
+        //NOTE: Flipping between two sets of positions half a cell apart makes every build a full rebuild.
+        real32 *ShiftedX = PushArray(&Arena, Count, real32, 64);
+        for (uint32 EntityIndex = 0; EntityIndex < Count; ++EntityIndex)
+        {
+            ShiftedX[EntityIndex] = Scene.PX[EntityIndex] + 1.0f;
+        }
+        bench_timer Rebuild;
+        bench_timer Refresh;
+        BenchBeginRepeat(&Rebuild);
+        BenchBeginRepeat(&Refresh);
+        for (int Repeat = 0; Repeat < 10; ++Repeat)
+        {
+            uint64 Start = LinuxGetWallClock();
+            BuildCollisionGrid(&Grid, (Repeat & 1) ? Scene.PX : ShiftedX, Scene.PY, Count);
+            BenchAddRepeat(&Rebuild, Start, LinuxGetWallClock());
+        }
+        for (int Repeat = 0; Repeat < 10; ++Repeat)
+        {
+            uint64 Start = LinuxGetWallClock();
+            BuildCollisionGrid(&Grid, Scene.PX, Scene.PY, Count);
+            BenchAddRepeat(&Refresh, Start, LinuxGetWallClock());
+        }
+        printf("  %6u entities  rebuild %7.03fms  refresh %7.03fms  %u entries\n", Count, Rebuild.MinMS,
+                Refresh.MinMS, Grid.EntryCount);
+
+        uint32 MaxPairCount = 1 << 22;
+        collision_pair *Pairs = PushArray(&Arena, MaxPairCount, collision_pair);
+        uint32 *HitEntity = PushArray(&Arena, QueryCount, uint32);
+        real32 *HitT = PushArray(&Arena, QueryCount, real32);
+        bool32 DoBrute = (Count <= 10000);
+        for (int Method = 0; Method < 3; ++Method)
+        {
+            bench_timer GridTimer;
+            bench_timer BruteTimer;
+            BenchBeginRepeat(&GridTimer);
+            BenchBeginRepeat(&BruteTimer);
+            uint32 Found = 0;
+            for (int Repeat = 0; Repeat < 5; ++Repeat)
+            {
+                uint64 Start = LinuxGetWallClock();
+                if (Method == 0)
+                {
+                    Found = QueryCollisionBoxes(&Grid, QueryCount, Scene.QueryMinX, Scene.QueryMinY,
+                            Scene.QueryMaxX, Scene.QueryMaxY, Pairs, MaxPairCount);
+                }
+                else if (Method == 1)
+                {
+                    Found = FindCollidingEntities(&Grid, Pairs, MaxPairCount);
+                }
+                else
+                {
+                    CastCollisionRays(&Grid, QueryCount, Scene.RayX, Scene.RayY, Scene.RaydX, Scene.RaydY,
+                            Scene.RayIgnore, HitEntity, HitT);
+                    Found = 0;
+                    for (uint32 RayIndex = 0; RayIndex < QueryCount; ++RayIndex)
+                    {
+                        Found += (HitEntity[RayIndex] != COLLISION_NO_HIT);
+                    }
+                }
+                BenchAddRepeat(&GridTimer, Start, LinuxGetWallClock());
+
+                if (DoBrute && (Repeat < 2))
+                {
+                    Start = LinuxGetWallClock();
+                    if (Method == 0)
+                    {
+                        BenchBruteQueryBoxes(&Scene, Pairs, MaxPairCount);
+                    }
+                    else if (Method == 1)
+                    {
+                        BenchBruteCollidingEntities(&Scene, Pairs, MaxPairCount);
+                    }
+                    else
+                    {
+                        BenchBruteCastRays(&Scene, HitEntity, HitT);
+                    }
+                    BenchAddRepeat(&BruteTimer, Start, LinuxGetWallClock());
+                }
+            }
+
+            char *MethodNames[] = {(char *)"box queries", (char *)"entity pairs", (char *)"ray casts"};
+            uint32 Operations = (Method == 1) ? Count : QueryCount;
+            printf("  %6u entities  %-12s %8.03fms  %7.02f M/s  %7u found", Count, MethodNames[Method],
+                    GridTimer.MinMS, Operations / (GridTimer.MinMS * 1000.0), Found);
+            if (DoBrute)
+            {
+                printf("  (brute force %9.03fms)", BruteTimer.MinMS);
+            }
+            printf("\n");
+        }
+
+        EndTemporaryMemory(CountMemory);
+    }
+
+    munmap(Arena.Base, ArenaSize);
+    return(Result);
+}
+
+// =====================================================================================================================
+//NOTE: Dirty rectangles
+
+struct bench_dirty_scene
+{
+    char *Name;
+    int MoverCount;
+    bool32 Scrolls;
+
+    //NOTE: A scrolling scene stops scrolling on this frame, if it is set.
+    int StopFrame;
+};
+
+// =====================================================================================================================
+
+internal void BenchPushDirtyScene(render_group *Group, bench_dirty_scene *Scene, loaded_bitmap *Sprite, int Frame)
+{
+    //NOTE: A floor of static tiles and a static sprite, with a few movers drifting over it in sub-pixel steps. A
+    //  scrolling scene moves the floor too, so every pixel changes every frame.
+    PushClear(Group, 0xFF202020);
+    int ScrollFrame = (Scene->StopFrame && (Frame > Scene->StopFrame)) ? Scene->StopFrame : Frame;
+    real32 Scroll = Scene->Scrolls ? 0.75f * (real32)ScrollFrame : 0.0f;
+    for (int TileY = -1; TileY < (Group->Height / 40) + 1; ++TileY)
+    {
+        for (int TileX = -1; TileX < (Group->Width / 40) + 1; ++TileX)
+        {
+            real32 X = 40.0f * (real32)TileX + Scroll;
+            real32 Y = 40.0f * (real32)TileY;
+            real32 Shade = ((TileX + TileY) & 1) ? 0.3f : 0.4f;
+            color4 Color = {Shade, Shade, 0.5f * Shade, 1.0f};
+            PushRectangle(Group, 0, X + 1.0f, Y + 1.0f, X + 39.0f, Y + 39.0f, Color, false);
+        }
+    }
+    PushBitmap(Group, 1, Sprite, 100.0f, 100.0f, BlendMode_AlphaBlend);
+
+    for (int MoverIndex = 0; MoverIndex < Scene->MoverCount; ++MoverIndex)
+    {
+        real32 X = (real32)((37 * MoverIndex) % (Group->Width - 100)) + 0.37f * (real32)Frame;
+        real32 Y = (real32)((91 * MoverIndex) % (Group->Height - 100)) + 0.21f * (real32)Frame;
+        color4 Color = {1.0f, 0.5f, 0.2f, 0.75f};
+        PushRectangle(Group, 2, X, Y, X + 24.0f, Y + 24.0f, Color, true);
+        if (MoverIndex == 0)
+        {
+            PushBitmap(Group, 2, Sprite, Y, X, BlendMode_AlphaBlendSRGB);
+        }
+    }
+}
+
+// =====================================================================================================================
+
+internal BENCH_FUNCTION(BenchDirty)
+{
+    bool32 Result = true;
+
+    Platform.AddEntry = LinuxAddEntry;
+    Platform.CompleteAllWork = LinuxCompleteAllWork;
+    platform_api PlatformAPI = Platform;
+
+    //NOTE: Leaked like the ones in BenchThreads.
+    int ThreadCount = 4;
+    platform_work_queue *Queue = (platform_work_queue *)LinuxAllocateMemory(sizeof(platform_work_queue));
+    LinuxMakeQueue(Queue, ThreadCount - 1);
+
+    memory_index ArenaSize = Megabytes(16) + 4 * GetPresentStorageSize();
+    memory_arena Arena;
+    InitializeArena(&Arena, (char *)"Dirty", ArenaSize, LinuxAllocateMemory(ArenaSize));
+    game_dirty_region *Dirty = PushStruct(&Arena, game_dirty_region, 64);
+    present_state *TrackedPresent = PushStruct(&Arena, present_state, 64);
+    present_state *FullPresent = PushStruct(&Arena, present_state, 64);
+    InitializePresentState(TrackedPresent, &Arena, PresentMode_Integer);
+    InitializePresentState(FullPresent, &Arena, PresentMode_Integer);
+
+    loaded_bitmap Sprite = BenchMakeSprite(48, 40, 0, 30);
+    game_offscreen_buffer Tracked = BenchAllocateBuffer(1280, 720, 0);
+    game_offscreen_buffer Full = BenchAllocateBuffer(1280, 720, 0);
+    Tracked.Dirty = Dirty;
+    int DisplaySizes[][2] = {{2560, 1440}, {1920, 1080}, {1000, 563}};
+    game_offscreen_buffer TrackedDisplay = BenchAllocateBuffer(2560, 1440, 0);
+    game_offscreen_buffer FullDisplay = BenchAllocateBuffer(2560, 1440, 0);
+
+    bench_dirty_scene Scenes[] =
+    {
+        {(char *)"static", 0, false, 0},
+        {(char *)"1 mover", 1, false, 0},
+        {(char *)"16 movers", 16, false, 0},
+        {(char *)"scrolling", 4, true, 0},
+        {(char *)"stopping", 0, true, 4},
+    };
+
+    printf("dirty rectangles\n");
+
+    //NOTE: Correctness first. Every frame of every scene, drawn with tracking, has to come out exactly as it does
+    //  drawn whole, and so does every display it is presented to. Halfway through, the backbuffer gets trashed and
+    //  invalidated, and the display changes size, and both have to be recovered from. A scene that stops scrolling
+    //  has to be back to redrawing nothing within a probe interval.
+    for (int SceneIndex = 0; Result && (SceneIndex < (int)ArrayCount(Scenes)); ++SceneIndex)
+    {
+        for (int SizeIndex = 0; Result && (SizeIndex < (int)ArrayCount(DisplaySizes)); ++SizeIndex)
+        {
+            TrackedPresent->RequestedMode = (SizeIndex == 0) ? PresentMode_Integer : PresentMode_Bilinear;
+            FullPresent->RequestedMode = TrackedPresent->RequestedMode;
+            Dirty->Invalidate = true;
+            Dirty->WholeFrameCount = 0;
+            int StillFrame = Scenes[SceneIndex].StopFrame ?
+                (Scenes[SceneIndex].StopFrame + WHOLE_FRAME_PROBE_INTERVAL + 1) : 0;
+            for (int Frame = 0; Result && (Frame < 40); ++Frame)
+            {
+                int SizeSlot = (Frame < 20) ? SizeIndex : ((SizeIndex + 1) % (int)ArrayCount(DisplaySizes));
+                TrackedDisplay.Width = FullDisplay.Width = DisplaySizes[SizeSlot][0];
+                TrackedDisplay.Height = FullDisplay.Height = DisplaySizes[SizeSlot][1];
+                TrackedDisplay.Pitch = FullDisplay.Pitch = TrackedDisplay.Width * 4;
+                if (Frame == 30)
+                {
+                    BenchFillRandom(&Tracked);
+                    Dirty->Invalidate = true;
+                }
+
+                temporary_memory GroupMemory = BeginTemporaryMemory(&Arena);
+                render_group *Group = AllocateRenderGroup(&Arena, Megabytes(1), Tracked.Width, Tracked.Height);
+                BenchPushDirtyScene(Group, Scenes + SceneIndex, &Sprite, Frame);
+                RenderGroupToOutput(Group, &Tracked, (Frame & 1) ? Queue : 0, &Arena);
+                RenderGroupToOutput(Group, &Full, Queue, &Arena);
+                EndTemporaryMemory(GroupMemory);
+
+                PresentBuffer(TrackedPresent, &Tracked, &TrackedDisplay, &PlatformAPI, (Frame & 2) ? Queue : 0);
+                PresentBuffer(FullPresent, &Full, &FullDisplay, &PlatformAPI, Queue);
+
+                if (!BenchBuffersMatch(&Tracked, &Full) || !BenchBuffersMatch(&TrackedDisplay, &FullDisplay))
+                {
+                    fprintf(stderr, "%s, frame %d at %dx%d: tracked %s differs from drawing it whole\n",
+                            Scenes[SceneIndex].Name, Frame, TrackedDisplay.Width, TrackedDisplay.Height,
+                            BenchBuffersMatch(&Tracked, &Full) ? "display" : "backbuffer");
+                    Result = false;
+                }
+                else if ((Frame > StillFrame) && (Frame != 20) && (Frame != 30) &&
+                        (Scenes[SceneIndex].MoverCount == 0) &&
+                        (Dirty->RenderedPixelCount || TrackedPresent->PresentedPixelCount))
+                {
+                    fprintf(stderr, "%s redrew %u pixels and presented %u on frame %d\n", Scenes[SceneIndex].Name,
+                            Dirty->RenderedPixelCount, TrackedPresent->PresentedPixelCount, Frame);
+                    Result = false;
+                }
+            }
+        }
+    }
+
+    //NOTE: Then what it saves: four seconds of frames per scene, presented at 2x, against drawing and presenting
+    //  every frame whole. Full motion is where tracking can only lose, so there its median frame has to render no
+    //  slower than drawing whole, give or take noise, and its mean, which carries the probe frames, only a little.
+    TrackedDisplay.Width = FullDisplay.Width = 2560;
+    TrackedDisplay.Height = FullDisplay.Height = 1440;
+    TrackedDisplay.Pitch = FullDisplay.Pitch = 2560 * 4;
+    TrackedPresent->RequestedMode = FullPresent->RequestedMode = PresentMode_Integer;
+    for (int SceneIndex = 0; Result && (SceneIndex < (int)ArrayCount(Scenes)); ++SceneIndex)
+    {
+        bench_timer TrackedRender, TrackedPresentTimer, FullRender, FullPresentTimer;
+        BenchBeginRepeat(&TrackedRender);
+        BenchBeginRepeat(&TrackedPresentTimer);
+        BenchBeginRepeat(&FullRender);
+        BenchBeginRepeat(&FullPresentTimer);
+        uint64 RenderedPixels = 0;
+        uint64 PresentedPixels = 0;
+        int FrameCount = 240;
+        uint64 TrackedRenderNanoseconds[240];
+        uint64 FullRenderNanoseconds[240];
+        Dirty->Invalidate = true;
+        Dirty->WholeFrameCount = 0;
+        for (int Frame = 0; Frame < FrameCount; ++Frame)
+        {
+            temporary_memory GroupMemory = BeginTemporaryMemory(&Arena);
+            render_group *Group = AllocateRenderGroup(&Arena, Megabytes(1), Tracked.Width, Tracked.Height);
+            BenchPushDirtyScene(Group, Scenes + SceneIndex, &Sprite, Frame);
+
+            uint64 Start = LinuxGetWallClock();
+            RenderGroupToOutput(Group, &Tracked, Queue, &Arena);
+            uint64 Rendered = LinuxGetWallClock();
+            PresentBuffer(TrackedPresent, &Tracked, &TrackedDisplay, &PlatformAPI, Queue);
+            uint64 End = LinuxGetWallClock();
+            if (Frame > 0)
+            {
+                BenchAddRepeat(&TrackedRender, Start, Rendered);
+                BenchAddRepeat(&TrackedPresentTimer, Rendered, End);
+                TrackedRenderNanoseconds[Frame - 1] = Rendered - Start;
+                RenderedPixels += Dirty->RenderedPixelCount;
+                PresentedPixels += TrackedPresent->PresentedPixelCount;
+            }
+
+            Start = LinuxGetWallClock();
+            RenderGroupToOutput(Group, &Full, Queue, &Arena);
+            Rendered = LinuxGetWallClock();
+            PresentBuffer(FullPresent, &Full, &FullDisplay, &PlatformAPI, Queue);
+            End = LinuxGetWallClock();
+            if (Frame > 0)
+            {
+                BenchAddRepeat(&FullRender, Start, Rendered);
+                BenchAddRepeat(&FullPresentTimer, Rendered, End);
+                FullRenderNanoseconds[Frame - 1] = Rendered - Start;
+            }
+            EndTemporaryMemory(GroupMemory);
+        }
+
+        real64 Frames = (real64)(FrameCount - 1);
+        printf("  %-10s rendered %5.01f%%  presented %5.01f%%  render %6.03fms (whole %6.03fms)  "
+                "present %6.03fms (whole %6.03fms)\n", Scenes[SceneIndex].Name,
+                100.0 * (real64)RenderedPixels / (Frames * Tracked.Width * Tracked.Height),
+                100.0 * (real64)PresentedPixels / (Frames * TrackedDisplay.Width * TrackedDisplay.Height),
+                BenchAverageMS(&TrackedRender), BenchAverageMS(&FullRender),
+                BenchAverageMS(&TrackedPresentTimer), BenchAverageMS(&FullPresentTimer));
+
+        if (Scenes[SceneIndex].Scrolls && !Scenes[SceneIndex].StopFrame)
+        {
+            qsort(TrackedRenderNanoseconds, FrameCount - 1, sizeof(uint64), BenchCompareCycles);
+            qsort(FullRenderNanoseconds, FrameCount - 1, sizeof(uint64), BenchCompareCycles);
+            real64 P50SlowdownPercent = 100.0 *
+                ((real64)BenchGetPercentile(TrackedRenderNanoseconds, FrameCount - 1, 50) /
+                 (real64)BenchGetPercentile(FullRenderNanoseconds, FrameCount - 1, 50) - 1.0);
+            real64 MeanSlowdownPercent = 100.0 * (BenchAverageMS(&TrackedRender) / BenchAverageMS(&FullRender) - 1.0);
+            real64 P50BudgetPercent = 3.0;
+            real64 MeanBudgetPercent = 5.0;
+            printf("  %-10s tracking renders %+.02f%% p50, %+.02f%% mean against whole (budget %.0f%% and %.0f%%)\n",
+                    "", P50SlowdownPercent, MeanSlowdownPercent, P50BudgetPercent, MeanBudgetPercent);
+            if ((P50SlowdownPercent > P50BudgetPercent) || (MeanSlowdownPercent > MeanBudgetPercent))
+            {
+                fprintf(stderr, "%s rendered slower with tracking than whole\n", Scenes[SceneIndex].Name);
+                Result = false;
+            }
+        }
+    }
+
+    BenchFreeBuffer(&Tracked);
+    BenchFreeBuffer(&Full);
+    TrackedDisplay.Width = FullDisplay.Width = 2560;
+    TrackedDisplay.Height = FullDisplay.Height = 1440;
+    TrackedDisplay.Pitch = FullDisplay.Pitch = 2560 * 4;
+    BenchFreeBuffer(&TrackedDisplay);
+    BenchFreeBuffer(&FullDisplay);
+    BenchFreeSprite(&Sprite);
+    munmap(Arena.Base, ArenaSize);
+    return(Result);
+}
+
+// =====================================================================================================================
+//NOTE: Frame sequences
+//  The whole game core, headless, over fixed input sequences, with every frame's cost split by subsystem through the
+//  profiler's blocks. Results come out as JSON lines, one per scene and subsystem, and a results file from an earlier
+//  run can be handed back in as the baseline: any subsystem whose median frame comes in over the baseline's by more
+//  than the margin fails the run, and so does a baseline that is missing any scene and subsystem the run measured, so
+//  the check can't quietly switch itself off. The median is what gets budgeted; p99 of a few hundred frames is a
+//  handful of frames, which is too few to fail a run on. Cycle counts only mean something on the machine that made
+//  the baseline.
+//
+//  A -playback recording is timed on top of the built-in scenes. It has to come from a linux_handmade built with the
+//  same flags, and the bench has to run in the directory it was recorded in so the asset file is the same one.
+
+struct bench_frame_options
+{
+    int FrameCount;
+    char *PlaybackFileName;
+    char *ResultsFileName;
+    char *BaselineFileName;
+    real64 MarginPercent;
+};
+
+global_variable bench_frame_options GlobalFrameOptions = {300, 0, 0, 0, 25.0};
+
+enum bench_frame_scene
+{
+    BenchFrameScene_Idle,
+    BenchFrameScene_Walk,
+    BenchFrameScene_Playback,
+
+    BenchFrameScene_Count,
+};
+
+enum bench_frame_subsystem
+{
+    BenchFrame_Simulation,
+    BenchFrame_Audio,
+    BenchFrame_Render,
+    BenchFrame_Present,
+    BenchFrame_Frame,
+
+    BenchFrame_SubsystemCount,
+};
+
+struct bench_frame_subsystem_info
+{
+    char *Name;
+
+    //NOTE: The block a subsystem is timed by, and how many times it has to be hit a frame. The whole frame is timed
+    //  by the bench itself.
+    char *BlockName;
+    uint32 HitsPerFrame;
+};
+
+global_variable bench_frame_subsystem_info GlobalFrameSubsystems[BenchFrame_SubsystemCount] =
+{
+    {(char *)"simulation", (char *)"Simulation", 2},
+    {(char *)"audio", (char *)"GameOutputSound", 1},
+    {(char *)"render", (char *)"Render", 1},
+    {(char *)"present", (char *)"PresentBuffer", 1},
+    {(char *)"frame", 0, 0},
+};
+
+struct bench_frame_result
+{
+    char Scene[32];
+    char Subsystem[32];
+    int FrameCount;
+    uint64 P50Cycles;
+    uint64 P99Cycles;
+    uint64 MaxCycles;
+    real64 P50MS;
+    real64 P99MS;
+    real64 MaxMS;
+};
+
+struct bench_frame_run
+{
+    debug_state *DebugState;
+    debug_table *DebugTable;
+    platform_work_queue *HighPriorityQueue;
+    platform_work_queue *LowPriorityQueue;
+    present_state *PresentState;
+    game_offscreen_buffer Display;
+
+    int ResultCount;
+    bench_frame_result Results[BenchFrameScene_Count * BenchFrame_SubsystemCount];
+};
+
+// =====================================================================================================================
+
+internal bool32 BenchRunFrameScene(bench_frame_run *Run, bench_frame_scene Scene, char *SceneName)
+{
+    //NOTE: Game memory goes where the harness puts it, so a recording's snapshot lands on the addresses it was taken
+    //  at. Every scene starts from fresh memory and initializes on an untimed first frame, same as the harness.
+#if HANDMADE_INTERNAL
+    void *BaseAddress = (void *)Terabytes(2);
+#else
+    void *BaseAddress = 0;
+#endif
+    game_memory Memory = {};
+    Memory.PermanentStorageSize = Megabytes(64);
+    Memory.TransientStorageSize = Gigabytes(1);
+    memory_index MemorySize = Memory.PermanentStorageSize + Memory.TransientStorageSize;
+    Memory.PermanentStorage = LinuxReserveMemory(BaseAddress, MemorySize);
+    Memory.TransientStorage = (uint8 *)Memory.PermanentStorage + Memory.PermanentStorageSize;
+    Memory.HighPriorityQueue = Run->HighPriorityQueue;
+    Memory.LowPriorityQueue = Run->LowPriorityQueue;
+    Memory.PlatformAPI.AddEntry = LinuxAddEntry;
+    Memory.PlatformAPI.CompleteAllWork = LinuxCompleteAllWork;
+    Memory.PlatformAPI.MapFile = LinuxMapFile;
+    Memory.PlatformAPI.UnmapFile = LinuxUnmapFile;
+    Memory.DebugTable = Run->DebugTable;
+    GlobalNextFileMappingAddress = BaseAddress ? ((uint8 *)BaseAddress + Terabytes(1)) : 0;
+
+    game_offscreen_buffer Buffer = BenchAllocateBuffer(1280, 720, 0);
+    Buffer.Dirty = (game_dirty_region *)LinuxAllocateMemory(sizeof(game_dirty_region));
+    Buffer.Dirty->Invalidate = true;
+
+    int SampleCount = 800;
+    int16 *Samples = (int16 *)LinuxAllocateMemory(SampleCount * 2 * sizeof(int16));
+    game_sound_output_buffer SoundBuffer = {48000, SampleCount, Samples};
+
+    game_input Input[2] = {};
+    game_input *NewInput = &Input[0];
+    game_input *OldInput = &Input[1];
+    NewInput->dtForFrame = OldInput->dtForFrame = 1.0f / 60.0f;
+    GetController(NewInput, 0)->IsConnected = true;
+
+    GameUpdateAndRender(&Memory, NewInput, &Buffer, &SoundBuffer);
+    LinuxCompleteAllWork(Run->LowPriorityQueue);
+    CollateDebugFrame(Run->DebugState, (real64)LinuxGetWallClock() / 1000000000.0);
+
+    bool32 Result = true;
+    int FrameCount = GlobalFrameOptions.FrameCount;
+    linux_state LinuxState = {};
+    if (Scene == BenchFrameScene_Playback)
+    {
+        if (LinuxBeginInputPlayBack(&LinuxState, &Memory, GlobalFrameOptions.PlaybackFileName))
+        {
+            FrameCount = (int)LinuxState.ReplayMapping->FrameCount;
+            Buffer.Dirty->Invalidate = true;
+        }
+        else
+        {
+            fprintf(stderr, "unable to play back %s, or it was recorded by a different build\n",
+                    GlobalFrameOptions.PlaybackFileName);
+            Result = false;
+            FrameCount = 0;
+        }
+    }
+
+    uint64 *Cycles[BenchFrame_SubsystemCount];
+    for (int SubsystemIndex = 0; SubsystemIndex < BenchFrame_SubsystemCount; ++SubsystemIndex)
+    {
+        Cycles[SubsystemIndex] = (uint64 *)LinuxAllocateMemory((FrameCount + 1) * sizeof(uint64));
+    }
+
+    uint64 TotalFrameCycles = 0;
+    real64 TotalFrameMS = 0.0;
+    for (int FrameIndex = 0; Result && (FrameIndex < FrameCount); ++FrameIndex)
+    {
+        //NOTE: Loads finish between frames, the way they do while the harness records or plays back, so every run
+        //  sees the assets arrive on the same frames.
+        LinuxCompleteAllWork(Run->LowPriorityQueue);
+        if (Scene == BenchFrameScene_Walk)
+        {
+            LinuxScriptKeyboard(GetController(OldInput, 0), GetController(NewInput, 0), FrameIndex + 1);
+        }
+        else if (Scene == BenchFrameScene_Playback)
+        {
+            LinuxPlayBackInput(&LinuxState, &Memory, NewInput);
+        }
+        else
+        {
+            GetController(NewInput, 0)->IsConnected = true;
+        }
+
+        uint64 StartCounter = LinuxGetWallClock();
+        uint64 StartCycleCount = __rdtsc();
+        GameUpdateAndRender(&Memory, NewInput, &Buffer, &SoundBuffer);
+        PresentBuffer(Run->PresentState, &Buffer, &Run->Display, &Memory.PlatformAPI, Run->HighPriorityQueue);
+        uint64 EndCycleCount = __rdtsc();
+        uint64 EndCounter = LinuxGetWallClock();
+
+        Cycles[BenchFrame_Frame][FrameIndex] = EndCycleCount - StartCycleCount;
+        TotalFrameCycles += EndCycleCount - StartCycleCount;
+        TotalFrameMS += LinuxGetMSElapsed(StartCounter, EndCounter);
+
+        if ((Scene == BenchFrameScene_Playback) && !LinuxCheckPlayBackFrame(&LinuxState, &Buffer))
+        {
+            fprintf(stderr, "%s diverged from the recording on frame %d\n", SceneName, FrameIndex);
+            Result = false;
+        }
+
+        CollateDebugFrame(Run->DebugState, (real64)LinuxGetWallClock() / 1000000000.0);
+        debug_state *DebugState = Run->DebugState;
+        for (int SubsystemIndex = 0; SubsystemIndex < BenchFrame_SubsystemCount; ++SubsystemIndex)
+        {
+            bench_frame_subsystem_info *Info = GlobalFrameSubsystems + SubsystemIndex;
+            if (Info->BlockName)
+            {
+                uint64 SubsystemCycles = 0;
+                uint32 HitCount = 0;
+                for (uint32 NodeIndex = 1; NodeIndex < DebugState->NodeCount; ++NodeIndex)
+                {
+                    debug_node *Node = DebugState->Nodes + NodeIndex;
+                    if (strcmp(Node->BlockName, Info->BlockName) == 0)
+                    {
+                        SubsystemCycles += Node->FrameCycles;
+                        HitCount += Node->FrameHitCount;
+                    }
+                }
+
+                //NOTE: A block that went missing or got hit twice would make the numbers for the wrong work.
+                if (HitCount != Info->HitsPerFrame)
+                {
+                    fprintf(stderr, "%s frame %d hit %s %u times, expected %u\n", SceneName, FrameIndex,
+                            Info->BlockName, HitCount, Info->HitsPerFrame);
+                    Result = false;
+                }
+                Cycles[SubsystemIndex][FrameIndex] = SubsystemCycles;
+            }
+        }
+
+        game_input *Temp = NewInput;
+        NewInput = OldInput;
+        OldInput = Temp;
+    }
+
+    if (Result && (Run->DebugState->MismatchedEventCount || Run->DebugState->NodeOverflowCount))
+    {
+        fprintf(stderr, "%s: the profiler lost track of some blocks, so the split can't be trusted\n", SceneName);
+        Result = false;
+    }
+
+    if (Result && FrameCount)
+    {
+        real64 CyclesPerMS = (TotalFrameMS > 0.0) ? ((real64)TotalFrameCycles / TotalFrameMS) : 1.0;
+        for (int SubsystemIndex = 0; SubsystemIndex < BenchFrame_SubsystemCount; ++SubsystemIndex)
+        {
+            qsort(Cycles[SubsystemIndex], FrameCount, sizeof(uint64), BenchCompareCycles);
+
+            Assert(Run->ResultCount < (int)ArrayCount(Run->Results));
+            bench_frame_result *Frame = Run->Results + Run->ResultCount++;
+            snprintf(Frame->Scene, sizeof(Frame->Scene), "%s", SceneName);
+            snprintf(Frame->Subsystem, sizeof(Frame->Subsystem), "%s", GlobalFrameSubsystems[SubsystemIndex].Name);
+            Frame->FrameCount = FrameCount;
+            Frame->P50Cycles = BenchGetPercentile(Cycles[SubsystemIndex], FrameCount, 50);
+            Frame->P99Cycles = BenchGetPercentile(Cycles[SubsystemIndex], FrameCount, 99);
+            Frame->MaxCycles = Cycles[SubsystemIndex][FrameCount - 1];
+            Frame->P50MS = (real64)Frame->P50Cycles / CyclesPerMS;
+            Frame->P99MS = (real64)Frame->P99Cycles / CyclesPerMS;
+            Frame->MaxMS = (real64)Frame->MaxCycles / CyclesPerMS;
+        }
+    }
+
+    if (LinuxState.IsPlayingBack)
+    {
+        LinuxEndInputPlayBack(&LinuxState);
+    }
+    for (int SubsystemIndex = 0; SubsystemIndex < BenchFrame_SubsystemCount; ++SubsystemIndex)
+    {
+        munmap(Cycles[SubsystemIndex], (FrameCount + 1) * sizeof(uint64));
+    }
+
+    //NOTE: The asset file is mapped at a fixed address too, so it has to go before the next scene maps it again.
+    LinuxCompleteAllWork(Run->LowPriorityQueue);
+    CloseAssetFile(&((game_state *)Memory.PermanentStorage)->Assets, &Memory.PlatformAPI);
+    munmap(Memory.PermanentStorage, MemorySize);
+    munmap(Samples, SampleCount * 2 * sizeof(int16));
+    munmap(Buffer.Dirty, sizeof(game_dirty_region));
+    BenchFreeBuffer(&Buffer);
+    GlobalNextFileMappingAddress = 0;
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 BenchWriteFrameResults(bench_frame_run *Run, char *FileName)
+{
+    bool32 Result = false;
+    FILE *File = fopen(FileName, "wb");
+    if (File)
+    {
+        Result = true;
+        for (int ResultIndex = 0; ResultIndex < Run->ResultCount; ++ResultIndex)
+        {
+            bench_frame_result *Frame = Run->Results + ResultIndex;
+            if (fprintf(File, "{\"scene\":\"%s\",\"subsystem\":\"%s\",\"frames\":%d,\"p50_cycles\":%llu,"
+                        "\"p99_cycles\":%llu,\"max_cycles\":%llu,\"p50_ms\":%.04f,\"p99_ms\":%.04f,"
+                        "\"max_ms\":%.04f}\n", Frame->Scene, Frame->Subsystem, Frame->FrameCount,
+                        (unsigned long long)Frame->P50Cycles, (unsigned long long)Frame->P99Cycles,
+                        (unsigned long long)Frame->MaxCycles, Frame->P50MS, Frame->P99MS, Frame->MaxMS) < 0)
+            {
+                Result = false;
+            }
+        }
+        Result = (fclose(File) == 0) && Result;
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal int BenchReadFrameResults(char *FileName, bench_frame_result *Results, int MaxResultCount)
+{
+    //NOTE: Not a JSON parser. A baseline is a results file this mode wrote, so lines are read back in the layout
+    //  they were written in, and anything else is skipped. Returns -1 if the file can't be opened.
+    int Result = -1;
+    FILE *File = fopen(FileName, "rb");
+    if (File)
+    {
+        Result = 0;
+        char Line[512];
+        while ((Result < MaxResultCount) && fgets(Line, sizeof(Line), File))
+        {
+            bench_frame_result *Frame = Results + Result;
+            unsigned long long P50Cycles, P99Cycles, MaxCycles;
+            if (sscanf(Line, "{\"scene\":\"%31[^\"]\",\"subsystem\":\"%31[^\"]\",\"frames\":%d,\"p50_cycles\":%llu,"
+                        "\"p99_cycles\":%llu,\"max_cycles\":%llu,\"p50_ms\":%lf,\"p99_ms\":%lf,\"max_ms\":%lf}",
+                        Frame->Scene, Frame->Subsystem, &Frame->FrameCount, &P50Cycles, &P99Cycles, &MaxCycles,
+                        &Frame->P50MS, &Frame->P99MS, &Frame->MaxMS) == 9)
+            {
+                Frame->P50Cycles = P50Cycles;
+                Frame->P99Cycles = P99Cycles;
+                Frame->MaxCycles = MaxCycles;
+                ++Result;
+            }
+        }
+        fclose(File);
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal BENCH_FUNCTION(BenchFrames)
+{
+    //NOTE: Same as the profiler mode, the debug table is installed for the run and leaked on purpose afterwards.
+    memory_index DebugStorageSize = Megabytes(64);
+    memory_arena DebugArena;
+    InitializeArena(&DebugArena, (char *)"Debug", DebugStorageSize, LinuxAllocateMemory(DebugStorageSize));
+
+    bench_frame_run *Run = (bench_frame_run *)LinuxAllocateMemory(sizeof(bench_frame_run));
+    Run->DebugTable = PushStruct(&DebugArena, debug_table, 64);
+    Run->DebugState = PushStruct(&DebugArena, debug_state, 64);
+    InitializeDebugState(Run->DebugState, Run->DebugTable, &DebugArena);
+    GlobalDebugTable = Run->DebugTable;
+    GlobalDebugThreadRing = 0;
+
+    //NOTE: Leaked on purpose, like every other bench queue. The split matches the harness: every processor renders,
+    //  and loads get two threads of their own.
+    int ProcessorCount = LinuxGetProcessorCount();
+    Run->HighPriorityQueue = (platform_work_queue *)LinuxAllocateMemory(sizeof(platform_work_queue));
+    LinuxMakeQueue(Run->HighPriorityQueue, ProcessorCount - 1);
+    Run->LowPriorityQueue = (platform_work_queue *)LinuxAllocateMemory(sizeof(platform_work_queue));
+    LinuxMakeQueue(Run->LowPriorityQueue, 2);
+
+    Run->PresentState = BenchAllocatePresentState(PresentMode_Bilinear);
+    Run->Display = BenchAllocateBuffer(1920, 1080, 0);
+
+    char *SceneNames[BenchFrameScene_Count] = {(char *)"idle", (char *)"walk", (char *)"playback"};
+    int SceneCount = GlobalFrameOptions.PlaybackFileName ? BenchFrameScene_Count : BenchFrameScene_Playback;
+
+    bool32 Result = true;
+    for (int SceneIndex = 0; Result && (SceneIndex < SceneCount); ++SceneIndex)
+    {
+        Result = BenchRunFrameScene(Run, (bench_frame_scene)SceneIndex, SceneNames[SceneIndex]);
+    }
+
+    int MaxBaselineCount = 256;
+    bench_frame_result *Baseline = 0;
+    int BaselineCount = 0;
+    if (Result && GlobalFrameOptions.BaselineFileName)
+    {
+        Baseline = (bench_frame_result *)LinuxAllocateMemory(MaxBaselineCount * sizeof(bench_frame_result));
+        BaselineCount = BenchReadFrameResults(GlobalFrameOptions.BaselineFileName, Baseline, MaxBaselineCount);
+        if (BaselineCount < 0)
+        {
+            fprintf(stderr, "unable to read the baseline %s\n", GlobalFrameOptions.BaselineFileName);
+            Result = false;
+        }
+        else if (BaselineCount == 0)
+        {
+            //NOTE: Otherwise a file that isn't a results file at all would budget nothing and pass.
+            fprintf(stderr, "the baseline %s has no results in it\n", GlobalFrameOptions.BaselineFileName);
+            Result = false;
+        }
+    }
+
+    if (Result)
+    {
+        printf("frames 1280x720 -> %dx%d bilinear, %d threads", Run->Display.Width, Run->Display.Height,
+                ProcessorCount);
+        if (Baseline)
+        {
+            printf(", budget %s + %.0f%%", GlobalFrameOptions.BaselineFileName, GlobalFrameOptions.MarginPercent);
+        }
+        printf("\n");
+
+        for (int ResultIndex = 0; ResultIndex < Run->ResultCount; ++ResultIndex)
+        {
+            bench_frame_result *Frame = Run->Results + ResultIndex;
+            char Budget[64] = "";
+            bool32 HasBaseline = false;
+            for (int BaselineIndex = 0; BaselineIndex < BaselineCount; ++BaselineIndex)
+            {
+                bench_frame_result *Base = Baseline + BaselineIndex;
+                if ((strcmp(Base->Scene, Frame->Scene) == 0) && (strcmp(Base->Subsystem, Frame->Subsystem) == 0))
+                {
+                    HasBaseline = true;
+                    real64 BudgetCycles = (real64)Base->P50Cycles * (1.0 + GlobalFrameOptions.MarginPercent / 100.0);
+                    bool32 OverBudget = ((real64)Frame->P50Cycles > BudgetCycles);
+                    snprintf(Budget, sizeof(Budget), "  budget %8.03fmc%s", BudgetCycles / 1000000.0,
+                            OverBudget ? "  OVER" : "");
+                    if (OverBudget)
+                    {
+                        fprintf(stderr, "%s %s median %.03fmc is over its budget of %.03fmc\n", Frame->Scene,
+                                Frame->Subsystem, (real64)Frame->P50Cycles / 1000000.0, BudgetCycles / 1000000.0);
+                        Result = false;
+                    }
+                }
+            }
+
+            //NOTE: A subsystem the baseline doesn't know about would otherwise go unbudgeted without anyone noticing.
+            if (Baseline && !HasBaseline)
+            {
+                snprintf(Budget, sizeof(Budget), "  NO BASELINE");
+                fprintf(stderr, "%s %s has no entry in the baseline %s\n", Frame->Scene, Frame->Subsystem,
+                        GlobalFrameOptions.BaselineFileName);
+                Result = false;
+            }
+
+            printf("  %-8s %-10s p50 %7.03fms  p99 %7.03fms  max %7.03fms  p50 %8.03fmc%s\n", Frame->Scene,
+                    Frame->Subsystem, Frame->P50MS, Frame->P99MS, Frame->MaxMS,
+                    (real64)Frame->P50Cycles / 1000000.0, Budget);
+        }
+    }
+
+    if (GlobalFrameOptions.ResultsFileName && Run->ResultCount &&
+            !BenchWriteFrameResults(Run, GlobalFrameOptions.ResultsFileName))
+    {
+        fprintf(stderr, "unable to write the results to %s\n", GlobalFrameOptions.ResultsFileName);
+        Result = false;
+    }
+
+    if (Baseline)
+    {
+        munmap(Baseline, MaxBaselineCount * sizeof(bench_frame_result));
+    }
+    BenchFreeBuffer(&Run->Display);
+    munmap(Run, sizeof(bench_frame_run));
+
+    GlobalDebugTable = 0;
+    GlobalDebugThreadRing = 0;
+
+    return(Result);
+}
+
+// =====================================================================================================================
+//NOTE: Controller polling
+
+struct bench_pad_device
+{
+    controller_reading Readings[CONTROLLER_POLL_SLOT_COUNT];
+    bool32 IsConnected[CONTROLLER_POLL_SLOT_COUNT];
+    uint32 ReadCount[CONTROLLER_POLL_SLOT_COUNT];
+};
+
+internal CONTROLLER_POLL_READ(BenchReadPadDevice)
+{
+    bench_pad_device *Device = (bench_pad_device *)Context;
+    ++Device->ReadCount[SlotIndex];
+    *Reading = Device->Readings[SlotIndex];
+    return(Device->IsConnected[SlotIndex]);
+}
+
+internal CONTROLLER_POLL_READ(BenchReadTogglingPad)
+{
+    //NOTE: The first two slots are plugged in. Every read flips the first button, and the stick is all the way
+    //  over, which comes out of the dead zone as exactly 1, so every running total is a function of the read count.
+    bench_pad_device *Device = (bench_pad_device *)Context;
+    bool32 Result = (SlotIndex < 2);
+    if (Result)
+    {
+        ++Device->ReadCount[SlotIndex];
+        Reading->ButtonsDown = Device->ReadCount[SlotIndex] & 1;
+        Reading->StickX = 32767;
+        Reading->StickY = -32768;
+    }
+    return(Result);
+}
+
+internal bool32 BenchCheckStickDeadZone(void)
+{
+    int16 DeadZone = CONTROLLER_POLL_DEFAULT_DEAD_ZONE;
+    real32 LastStick = -1.0f;
+    for (int32 Value = -32768; Value <= 32767; ++Value)
+    {
+        real32 Stick = ProcessControllerStickValue((int16)Value, DeadZone);
+        bool32 InDeadZone = ((Value >= -DeadZone) && (Value <= DeadZone));
+        if ((InDeadZone != (Stick == 0.0f)) || (Stick < LastStick) || (Stick < -1.0f) || (Stick > 1.0f))
+        {
+            fprintf(stderr, "stick value %d came out of the dead zone as %f\n", Value, Stick);
+            return(false);
+        }
+        LastStick = Stick;
+    }
+
+    //NOTE: No jump at the edge of the dead zone, and full deflection is still full.
+    bool32 Result = ((ProcessControllerStickValue(32767, DeadZone) == 1.0f) &&
+            (ProcessControllerStickValue(-32768, DeadZone) == -1.0f) &&
+            (ProcessControllerStickValue((int16)(DeadZone + 1), DeadZone) < 0.001f) &&
+            (ProcessControllerStickValue((int16)(-DeadZone - 1), DeadZone) > -0.001f));
+    if (!Result)
+    {
+        fprintf(stderr, "the dead zone doesn't rescale the stick to the full range\n");
+    }
+    return(Result);
+}
+
+struct bench_pad_expected
+{
+    //NOTE: What the game should see at the next frame, worked out from the device side.
+    int HalfTransitionCount[ControllerButton_Count];
+    uint32 ButtonsDown;
+    uint32 SampleCount;
+    real64 StickSumX;
+    real64 StickSumY;
+    real32 StickX;
+    real32 StickY;
+    bool32 IsConnected;
+};
+
+internal bool32 BenchCheckControllerFrame(bench_pad_expected *Expected, game_controller_input *Controller,
+        int SlotIndex, int Pass)
+{
+    real32 StickX = Expected->SampleCount ? (real32)(Expected->StickSumX / Expected->SampleCount) : Expected->StickX;
+    real32 StickY = Expected->SampleCount ? (real32)(Expected->StickSumY / Expected->SampleCount) : Expected->StickY;
+    bool32 Result = ((Controller->IsConnected == Expected->IsConnected) &&
+            (fabsf(Controller->StickAverageX - StickX) < 0.00001f) &&
+            (fabsf(Controller->StickAverageY - StickY) < 0.00001f));
+    for (int ButtonIndex = 0; ButtonIndex < ControllerButton_Count; ++ButtonIndex)
+    {
+        game_button_state *Button = Controller->Buttons + ButtonIndex;
+        if ((Button->HalfTransitionCount != Expected->HalfTransitionCount[ButtonIndex]) ||
+                (Button->EndedDown != (bool32)((Expected->ButtonsDown >> ButtonIndex) & 1)))
+        {
+            Result = false;
+        }
+    }
+
+    if (!Result)
+    {
+        fprintf(stderr, "slot %d at pass %d: the frame's input doesn't match what the device did\n", SlotIndex, Pass);
+    }
+    return(Result);
+}
+
+internal bool32 BenchCheckControllerPoller(void)
+{
+    //NOTE: Driven on a made-up clock, one pass per poll period, so every connected slot is due every pass. Frames
+    //  come at random: sometimes several polls apart, sometimes with no poll in between at all. The second slot
+    //  drops out for 600ms in the middle, and the last two slots are never plugged in.
+    uint64 ClockFrequency = 1000000000ULL;
+    uint32 PollHz = 1000;
+    uint64 Period = ClockFrequency / PollHz;
+    int16 DeadZone = CONTROLLER_POLL_DEFAULT_DEAD_ZONE;
+
+    bench_pad_device Device = {};
+    controller_poller *Poller = (controller_poller *)LinuxAllocateMemory(sizeof(controller_poller));
+    InitializeControllerPoller(Poller, BenchReadPadDevice, &Device, ClockFrequency, PollHz, DeadZone);
+
+    bench_pad_expected Expected[CONTROLLER_POLL_SLOT_COUNT] = {};
+    controller_slot_state LastSlots[CONTROLLER_POLL_SLOT_COUNT] = {};
+    int PassCount = 20000;
+    int DropPass = 5000;
+    int ReturnPass = 5600;
+    int ReconnectPass = 0;
+    int NextFramePass = 0;
+
+    bool32 Result = true;
+    for (int Pass = 0; Result && (Pass < PassCount); ++Pass)
+    {
+        Device.IsConnected[0] = true;
+        Device.IsConnected[1] = ((Pass < DropPass) || (Pass >= ReturnPass));
+        for (int SlotIndex = 0; SlotIndex < 2; ++SlotIndex)
+        {
+            controller_reading *Reading = Device.Readings + SlotIndex;
+            if ((BenchRandom() % 4) == 0)
+            {
+                Reading->ButtonsDown ^= 1 << BenchRandomBetween(0, ControllerButton_Count - 1);
+            }
+            Reading->StickX = (int16)BenchRandomBetween(-32768, 32767);
+            Reading->StickY = (int16)BenchRandomBetween(-32768, 32767);
+        }
+
+        uint32 ReadCounts[CONTROLLER_POLL_SLOT_COUNT];
+        memcpy(ReadCounts, Device.ReadCount, sizeof(ReadCounts));
+        PollControllers(Poller, (uint64)Pass * Period);
+
+        for (int SlotIndex = 0; SlotIndex < CONTROLLER_POLL_SLOT_COUNT; ++SlotIndex)
+        {
+            if (Device.ReadCount[SlotIndex] != ReadCounts[SlotIndex])
+            {
+                bench_pad_expected *Slot = Expected + SlotIndex;
+                bool32 IsConnected = Device.IsConnected[SlotIndex];
+                uint32 ButtonsDown = IsConnected ? Device.Readings[SlotIndex].ButtonsDown : 0;
+                for (int ButtonIndex = 0; ButtonIndex < ControllerButton_Count; ++ButtonIndex)
+                {
+                    Slot->HalfTransitionCount[ButtonIndex] += ((ButtonsDown ^ Slot->ButtonsDown) >> ButtonIndex) & 1;
+                }
+                Slot->ButtonsDown = ButtonsDown;
+                Slot->StickX = 0.0f;
+                Slot->StickY = 0.0f;
+                if (IsConnected)
+                {
+                    Slot->StickX = ProcessControllerStickValue(Device.Readings[SlotIndex].StickX, DeadZone);
+                    Slot->StickY = ProcessControllerStickValue(Device.Readings[SlotIndex].StickY, DeadZone);
+                    Slot->StickSumX += Slot->StickX;
+                    Slot->StickSumY += Slot->StickY;
+                    ++Slot->SampleCount;
+                    if ((SlotIndex == 1) && (Pass >= ReturnPass) && !ReconnectPass)
+                    {
+                        ReconnectPass = Pass;
+                    }
+                }
+                Slot->IsConnected = IsConnected;
+            }
+        }
+
+        while (Result && (Pass == NextFramePass))
+        {
+            controller_snapshot *Snapshot = ReadControllerSnapshot(Poller);
+            for (int SlotIndex = 0; SlotIndex < CONTROLLER_POLL_SLOT_COUNT; ++SlotIndex)
+            {
+                game_controller_input Controller;
+                ApplyControllerSlot(LastSlots + SlotIndex, Snapshot->Slots + SlotIndex, &Controller);
+                LastSlots[SlotIndex] = Snapshot->Slots[SlotIndex];
+                Result = Result && BenchCheckControllerFrame(Expected + SlotIndex, &Controller, SlotIndex, Pass);
+
+                bench_pad_expected *Slot = Expected + SlotIndex;
+                memset(Slot->HalfTransitionCount, 0, sizeof(Slot->HalfTransitionCount));
+                Slot->SampleCount = 0;
+                Slot->StickSumX = 0.0;
+                Slot->StickSumY = 0.0;
+            }
+            NextFramePass += BenchRandomBetween(0, 24);
+        }
+    }
+
+    //NOTE: An empty slot backs off to once a second, but never stops being asked, and a controller that comes back
+    //  is seen again within one backoff.
+    uint32 MaxEmptyReadCount = 2 + 10 + (uint32)(PassCount / CONTROLLER_POLL_MAX_BACKOFF_MS);
+    uint32 MinEmptyReadCount = (uint32)(PassCount / CONTROLLER_POLL_MAX_BACKOFF_MS);
+    for (int SlotIndex = 2; Result && (SlotIndex < CONTROLLER_POLL_SLOT_COUNT); ++SlotIndex)
+    {
+        if ((Device.ReadCount[SlotIndex] > MaxEmptyReadCount) || (Device.ReadCount[SlotIndex] < MinEmptyReadCount))
+        {
+            fprintf(stderr, "empty slot %d was read %u times in %d polls, expected %u to %u\n", SlotIndex,
+                    Device.ReadCount[SlotIndex], PassCount, MinEmptyReadCount, MaxEmptyReadCount);
+            Result = false;
+        }
+    }
+    if (Result && (!ReconnectPass || (ReconnectPass > (ReturnPass + CONTROLLER_POLL_MAX_BACKOFF_MS))))
+    {
+        fprintf(stderr, "a controller that came back on poll %d wasn't seen until poll %d\n", ReturnPass,
+                ReconnectPass);
+        Result = false;
+    }
+
+    munmap(Poller, sizeof(controller_poller));
+    return(Result);
+}
+
+struct bench_poll_thread
+{
+    controller_poller *Poller;
+    uint32 PassCount;
+    uint32 volatile IsDone;
+};
+
+internal void *BenchPollThreadProc(void *Parameter)
+{
+    bench_poll_thread *Thread = (bench_poll_thread *)Parameter;
+    controller_poller *Poller = Thread->Poller;
+    for (uint32 Pass = 0; Pass < Thread->PassCount; ++Pass)
+    {
+        PollControllers(Poller, (uint64)Pass * Poller->PeriodClocks);
+    }
+    AtomicStoreRelease(&Thread->IsDone, 1);
+    return(0);
+}
+
+internal bool32 BenchCheckControllerSnapshotThreaded(void)
+{
+    //NOTE: The poll thread publishes as fast as it can while the frame loop takes snapshots. Every total in a
+    //  snapshot is a function of how many reads went into it, so a snapshot that mixed two publishes shows up.
+    bench_pad_device Device = {};
+    controller_poller *Poller = (controller_poller *)LinuxAllocateMemory(sizeof(controller_poller));
+    InitializeControllerPoller(Poller, BenchReadTogglingPad, &Device, 1000000000ULL, 1000,
+            CONTROLLER_POLL_DEFAULT_DEAD_ZONE);
+
+    bench_poll_thread Thread = {Poller, 2000000, 0};
+    pthread_t ThreadHandle;
+    pthread_create(&ThreadHandle, 0, BenchPollThreadProc, &Thread);
+
+    bool32 Result = true;
+    uint64 LastSampleCount = 0;
+    uint32 DistinctCount = 0;
+    for (bool32 IsDone = false; Result && !IsDone;)
+    {
+        IsDone = AtomicLoadAcquire(&Thread.IsDone);
+        controller_snapshot *Snapshot = ReadControllerSnapshot(Poller);
+        controller_slot_state *First = Snapshot->Slots + 0;
+        controller_slot_state *Second = Snapshot->Slots + 1;
+        uint64 SampleCount = First->SampleCount;
+        Result = ((Second->SampleCount == SampleCount) &&
+                (First->HalfTransitionCount[0] == (uint32)SampleCount) &&
+                (Second->HalfTransitionCount[0] == (uint32)SampleCount) &&
+                (First->StickSumX == (real64)SampleCount) && (Second->StickSumY == -(real64)SampleCount) &&
+                (First->ButtonsDown == (uint32)(SampleCount & 1)) &&
+                (!SampleCount || (First->SampleClock == (SampleCount - 1) * Poller->PeriodClocks)) &&
+                (SampleCount >= LastSampleCount) &&
+                (!IsDone || (SampleCount == Thread.PassCount)));
+        if (!Result)
+        {
+            fprintf(stderr, "controller snapshot after %llu samples was torn or went backwards\n",
+                    (unsigned long long)SampleCount);
+        }
+        DistinctCount += (SampleCount != LastSampleCount);
+        LastSampleCount = SampleCount;
+    }
+
+    pthread_join(ThreadHandle, 0);
+    printf("  %u distinct snapshots taken while %u were published\n", DistinctCount, Thread.PassCount);
+    munmap(Poller, sizeof(controller_poller));
+    return(Result);
+}
+
+internal BENCH_FUNCTION(BenchControllers)
+{
+    printf("controllers\n");
+    bool32 Result = (BenchCheckStickDeadZone() &&
+            BenchCheckControllerPoller() &&
+            BenchCheckControllerSnapshotThreaded());
+    if (!Result)
+    {
+        return(false);
+    }
+
+    //NOTE: Both ends of the snapshot, with two pads plugged in and two empty slots backed off.
+    bench_pad_device Device = {};
+    Device.IsConnected[0] = Device.IsConnected[1] = true;
+    controller_poller *Poller = (controller_poller *)LinuxAllocateMemory(sizeof(controller_poller));
+    InitializeControllerPoller(Poller, BenchReadPadDevice, &Device, 1000000000ULL, 1000,
+            CONTROLLER_POLL_DEFAULT_DEAD_ZONE);
+
+    int PassCount = 100000;
+    bench_timer PollTimer;
+    bench_timer ReadTimer;
+    BenchBeginRepeat(&PollTimer);
+    BenchBeginRepeat(&ReadTimer);
+    game_input Input = {};
+    controller_slot_state LastSlots[CONTROLLER_POLL_SLOT_COUNT] = {};
+    for (int Repeat = 0; Repeat < 10; ++Repeat)
+    {
+        uint64 Start = LinuxGetWallClock();
+        for (int Pass = 0; Pass < PassCount; ++Pass)
+        {
+            Device.Readings[0].ButtonsDown = (uint32)Pass;
+            PollControllers(Poller, (uint64)(Repeat * PassCount + Pass) * Poller->PeriodClocks);
+        }
+        BenchAddRepeat(&PollTimer, Start, LinuxGetWallClock());
+
+        Start = LinuxGetWallClock();
+        for (int Frame = 0; Frame < PassCount; ++Frame)
+        {
+            controller_snapshot *Snapshot = ReadControllerSnapshot(Poller);
+            for (int SlotIndex = 0; SlotIndex < CONTROLLER_POLL_SLOT_COUNT; ++SlotIndex)
+            {
+                ApplyControllerSlot(LastSlots + SlotIndex, Snapshot->Slots + SlotIndex,
+                        GetController(&Input, SlotIndex + 1));
+                LastSlots[SlotIndex] = Snapshot->Slots[SlotIndex];
+            }
+        }
+        BenchAddRepeat(&ReadTimer, Start, LinuxGetWallClock());
+    }
+    printf("  poll pass %.01fns, frame read %.01fns\n", 1000000.0 * PollTimer.MinMS / PassCount,
+            1000000.0 * ReadTimer.MinMS / PassCount);
+    munmap(Poller, sizeof(controller_poller));
+
+    //NOTE: The real thread against the fake pad, with frames at 60Hz. The pad taps faster than a frame, which is
+    //  what polling once a frame loses, and the latency is from each change to the frame that picked it up.
+    memory_index ArenaSize = Kilobytes(64);
+    memory_arena Arena;
+    InitializeArena(&Arena, (char *)"Controllers", ArenaSize, LinuxAllocateMemory(ArenaSize));
+    uint32 PollRates[] = {60, 250, 1000};
+    for (int RateIndex = 0; RateIndex < (int)ArrayCount(PollRates); ++RateIndex)
+    {
+        temporary_memory ThreadMemory = BeginTemporaryMemory(&Arena);
+        linux_controller_input ControllerInput;
+        if (!LinuxStartControllerThread(&ControllerInput, &Arena, PollRates[RateIndex], 7))
+        {
+            fprintf(stderr, "unable to start the controller thread\n");
+            return(false);
+        }
+
+        timespec FrameTime = {0, 16666667L};
+        for (int Frame = 0; Frame < 60; ++Frame)
+        {
+            nanosleep(&FrameTime, 0);
+            LinuxReadControllers(&ControllerInput, &Input);
+        }
+        LinuxStopControllerThread(&ControllerInput);
+
+        char Stats[512];
+        LinuxFormatControllerStats(&ControllerInput, Stats, sizeof(Stats));
+        printf("  %s", Stats);
+        EndTemporaryMemory(ThreadMemory);
+    }
+    munmap(Arena.Base, ArenaSize);
+
+    return(true);
+}
+
+// =====================================================================================================================
+//NOTE: Pixel formats
+
+internal game_offscreen_buffer BenchAllocatePixelBuffer(int Width, int Height, pixel_format Format, int PitchPadding)
+{
+    game_offscreen_buffer Result = {};
+    Result.Width = Width;
+    Result.Height = Height;
+    Result.BytesPerPixel = GetPixelFormatBytesPerPixel(Format);
+    Result.Pitch = Width * Result.BytesPerPixel + PitchPadding;
+    Result.Memory = LinuxAllocateMemory(Result.Pitch * Height);
+    return(Result);
+}
+
+internal uint32 BenchRandomColor(void)
+{
+    //NOTE: Mostly noise, but every so often a channel is pinned to an end, where rounding goes wrong first.
+    uint32 Result = BenchRandom();
+    for (int Shift = 0; Shift < 32; Shift += 8)
+    {
+        uint32 Pick = BenchRandom() % 8;
+        if (Pick < 2)
+        {
+            Result = (Result & ~(0xFFu << Shift)) | ((Pick ? 0xFFu : 0u) << Shift);
+        }
+    }
+    return(Result);
+}
+
+template <typename format> internal bool32 BenchCheckPixelFormat(pixel_format Format)
+{
+    typedef typename format::pixel pixel;
+
+    //NOTE: Every gray, then random colors, through both the 8-wide and the one-at-a-time pack.
+    bool32 Result = true;
+    for (int Batch = 0; Result && (Batch < (32 + 8192)); ++Batch)
+    {
+        uint32 Colors[8];
+        pixel Packed[8];
+        for (int Index = 0; Index < 8; ++Index)
+        {
+            uint32 Gray = (uint32)(Batch * 8 + Index);
+            Colors[Index] = (Batch < 32) ? ((BenchRandom() << 24) | (Gray << 16) | (Gray << 8) | Gray) :
+                BenchRandomColor();
+        }
+        format::Pack8(Colors, Packed);
+        for (int Index = 0; Index < 8; ++Index)
+        {
+            if (Packed[Index] != format::Pack(Colors[Index]))
+            {
+                fprintf(stderr, "%s packs %08x as %x 8 at a time, but as %x on its own\n",
+                        GetPixelFormatName(Format), Colors[Index], (uint32)Packed[Index],
+                        (uint32)format::Pack(Colors[Index]));
+                Result = false;
+                break;
+            }
+        }
+    }
+
+    //NOTE: Every pixel value survives being unpacked and packed again, and a color never lands more than half a step
+    //  away from where it started.
+    uint32 ValueCount = (sizeof(pixel) == 1) ? 256 : 65536;
+    for (uint32 Value = 0; Result && (Value < ValueCount); ++Value)
+    {
+        pixel Pixel = (pixel)((sizeof(pixel) == 4) ? (BenchRandom() & 0x00FFFFFF) : Value);
+        if (format::Pack(format::Unpack(Pixel)) != Pixel)
+        {
+            fprintf(stderr, "%s pixel %x doesn't survive a round trip\n", GetPixelFormatName(Format), (uint32)Pixel);
+            Result = false;
+        }
+    }
+    int MaxError[] = {0, 5, 43};
+    for (int Test = 0; Result && (Test < 65536); ++Test)
+    {
+        uint32 Color = BenchRandomColor();
+        uint32 RoundTrip = format::Unpack(format::Pack(Color));
+        for (int Shift = 0; Shift < 24; Shift += 8)
+        {
+            int Error = abs((int)((Color >> Shift) & 0xFF) - (int)((RoundTrip >> Shift) & 0xFF));
+            if (Error > MaxError[Format])
+            {
+                fprintf(stderr, "%s moved %08x to %08x\n", GetPixelFormatName(Format), Color, RoundTrip);
+                Result = false;
+                break;
+            }
+        }
+    }
+    return(Result);
+}
+
+internal bool32 BenchCheckChannelRounding(void)
+{
+    uint32 MaxValues[] = {3, 7, 31, 63};
+    for (int MaxIndex = 0; MaxIndex < (int)ArrayCount(MaxValues); ++MaxIndex)
+    {
+        uint32 MaxValue = MaxValues[MaxIndex];
+        for (uint32 Value = 0; Value < 256; ++Value)
+        {
+            uint32 Expected = (2 * Value * MaxValue + 255) / 510;
+            uint32 Lanes[4];
+            _mm_storeu_si128((__m128i *)Lanes, ReduceChannel4x(_mm_set1_epi32((int)Value), MaxValue));
+            if ((ReduceChannel(Value, MaxValue) != Expected) || (Lanes[0] != Expected))
+            {
+                fprintf(stderr, "%u reduced to %u levels came out as %u, not %u\n", Value, MaxValue + 1,
+                        ReduceChannel(Value, MaxValue), Expected);
+                return(false);
+            }
+        }
+    }
+    return(true);
+}
+
+internal bool32 BenchCheckPixelKernels(pixel_format Format, buffer_layout Layout)
+{
+    //NOTE: Odd sizes, padded pitches for pitched kernels, and rectangles both inside a row and spanning it, against
+    //  the generic kernels. Both sides start from the same noise, so padding and everything outside the rectangle
+    //  has to come back identical too.
+    pixel_kernels Kernels = GetPixelKernels(Format, Layout);
+    int BytesPerPixel = GetPixelFormatBytesPerPixel(Format);
+    bool32 Result = true;
+    for (int Width = 1; Result && (Width <= 70); ++Width)
+    {
+        int Height = 1 + (Width % 9);
+        int PitchPadding = (Layout == BufferLayout_Packed) ? 0 : (BytesPerPixel * (Width % 3) + (Width % 4));
+
+        game_offscreen_buffer Source = BenchAllocatePixelBuffer(Width, Height, PixelFormat_BGRX32, PitchPadding);
+        game_offscreen_buffer Expected = BenchAllocatePixelBuffer(Width, Height, Format, PitchPadding);
+        game_offscreen_buffer Actual = BenchAllocatePixelBuffer(Width, Height, Format, PitchPadding);
+        for (int Index = 0; Index < (Source.Pitch * Height) / 4; ++Index)
+        {
+            ((uint32 *)Source.Memory)[Index] = BenchRandomColor();
+        }
+
+        for (int Test = 0; Result && (Test < 20); ++Test)
+        {
+            for (int Index = 0; Index < Expected.Pitch * Height; ++Index)
+            {
+                ((uint8 *)Expected.Memory)[Index] = ((uint8 *)Actual.Memory)[Index] = (uint8)BenchRandom();
+            }
+
+            int MinX = (Test & 1) ? 0 : BenchRandomBetween(0, Width - 1);
+            int MaxX = (Test & 1) ? Width : BenchRandomBetween(MinX + 1, Width);
+            int MinY = BenchRandomBetween(0, Height - 1);
+            int MaxY = BenchRandomBetween(MinY + 1, Height);
+            bool32 Fill = (Test % 4) < 2;
+            if (Fill)
+            {
+                uint32 Color = BenchRandomColor();
+                FillPixelsGeneric(&Expected, MinX, MinY, MaxX, MaxY, Color);
+                Kernels.FillPixels(&Actual, MinX, MinY, MaxX, MaxY, Color);
+            }
+            else
+            {
+                ConvertPixelsGeneric(&Source, &Expected, MinX, MinY, MaxX, MaxY);
+                if (Test & 4)
+                {
+                    Kernels.StreamPixels(&Source, &Actual, MinX, MinY, MaxX, MaxY);
+                    _mm_sfence();
+                }
+                else
+                {
+                    Kernels.ConvertPixels(&Source, &Actual, MinX, MinY, MaxX, MaxY);
+                }
+            }
+
+            if (!BenchBuffersMatch(&Expected, &Actual))
+            {
+                char *KernelName = Fill ? (char *)"fill" : ((Test & 4) ? (char *)"stream" : (char *)"convert");
+                fprintf(stderr, "%s %s %s mismatch at %dx%d, rectangle (%d, %d)-(%d, %d)\n",
+                        GetPixelFormatName(Format), (Layout == BufferLayout_Packed) ? "packed" : "pitched",
+                        KernelName, Width, Height, MinX, MinY, MaxX, MaxY);
+                Result = false;
+            }
+        }
+
+        BenchFreeBuffer(&Source);
+        BenchFreeBuffer(&Expected);
+        BenchFreeBuffer(&Actual);
+    }
+    return(Result);
+}
+
+internal BENCH_FUNCTION(BenchPixels)
+{
+    printf("pixels\n");
+    bool32 Result = (BenchCheckChannelRounding() &&
+            BenchCheckPixelFormat<pixel_format_bgrx32>(PixelFormat_BGRX32) &&
+            BenchCheckPixelFormat<pixel_format_rgb565>(PixelFormat_RGB565) &&
+            BenchCheckPixelFormat<pixel_format_indexed8>(PixelFormat_Indexed8));
+    for (int Format = 0; Result && (Format < PixelFormat_Count); ++Format)
+    {
+        for (int Layout = 0; Result && (Layout < BufferLayout_Count); ++Layout)
+        {
+            Result = BenchCheckPixelKernels((pixel_format)Format, (buffer_layout)Layout);
+        }
+    }
+    if (!Result)
+    {
+        return(false);
+    }
+
+    //NOTE: A 720p picture, whole, and a pitched picture of the same size for the pitched kernels. Throughput is the
+    //  bytes written; converting also reads 4 bytes per pixel.
+    int Width = 1280;
+    int Height = 720;
+    game_offscreen_buffer Source = BenchAllocatePixelBuffer(Width, Height, PixelFormat_BGRX32, 0);
+    game_offscreen_buffer PitchedSource = BenchAllocatePixelBuffer(Width, Height, PixelFormat_BGRX32, 64);
+    for (int Index = 0; Index < Width * Height; ++Index)
+    {
+        ((uint32 *)Source.Memory)[Index] = BenchRandomColor();
+    }
+    for (int Y = 0; Y < Height; ++Y)
+    {
+        memcpy((uint8 *)PitchedSource.Memory + Y * PitchedSource.Pitch, (uint8 *)Source.Memory + Y * Source.Pitch,
+                Source.Pitch);
+    }
+
+    printf("  %dx%d                 fill ms    GB/s    convert ms    GB/s\n", Width, Height);
+    for (int Format = 0; Format < PixelFormat_Count; ++Format)
+    {
+        game_offscreen_buffer Packed = BenchAllocatePixelBuffer(Width, Height, (pixel_format)Format, 0);
+        game_offscreen_buffer Pitched = BenchAllocatePixelBuffer(Width, Height, (pixel_format)Format, 64);
+        real64 FrameGB = (real64)Width * Height * Packed.BytesPerPixel / (1024.0 * 1024.0 * 1024.0);
+
+        pixel_kernels Generic = {(pixel_format)Format, BufferLayout_Pitched, FillPixelsGeneric, ConvertPixelsGeneric};
+        pixel_kernels Variants[] =
+        {
+            Generic,
+            GetPixelKernels((pixel_format)Format, BufferLayout_Pitched),
+            GetPixelKernels((pixel_format)Format, BufferLayout_Packed),
+        };
+        char *VariantNames[] = {(char *)"generic", (char *)"pitched", (char *)"packed"};
+
+        real64 GenericConvertMS = 0.0;
+        for (int VariantIndex = 0; VariantIndex < (int)ArrayCount(Variants); ++VariantIndex)
+        {
+            pixel_kernels *Kernels = Variants + VariantIndex;
+            bool32 UsePacked = (VariantIndex == 2);
+            game_offscreen_buffer *Dest = UsePacked ? &Packed : &Pitched;
+            game_offscreen_buffer *From = UsePacked ? &Source : &PitchedSource;
+
+            bench_timer FillTimer;
+            bench_timer ConvertTimer;
+            BenchBeginRepeat(&FillTimer);
+            BenchBeginRepeat(&ConvertTimer);
+            for (int Repeat = 0; Repeat < 20; ++Repeat)
+            {
+                uint64 Start = LinuxGetWallClock();
+                Kernels->FillPixels(Dest, 0, 0, Width, Height, 0x00FF8040 + (uint32)Repeat);
+                BenchAddRepeat(&FillTimer, Start, LinuxGetWallClock());
+
+                Start = LinuxGetWallClock();
+                Kernels->ConvertPixels(From, Dest, 0, 0, Width, Height);
+                BenchAddRepeat(&ConvertTimer, Start, LinuxGetWallClock());
+            }
+            if (VariantIndex == 0)
+            {
+                GenericConvertMS = ConvertTimer.MinMS;
+            }
+
+            printf("  %-8s %-8s %10.03f %7.02f %13.03f %7.02f  (%.01fx)\n", GetPixelFormatName((pixel_format)Format),
+                    VariantNames[VariantIndex], FillTimer.MinMS, FrameGB / (FillTimer.MinMS / 1000.0),
+                    ConvertTimer.MinMS, FrameGB / (ConvertTimer.MinMS / 1000.0),
+                    GenericConvertMS / ConvertTimer.MinMS);
+        }
+
+        BenchFreeBuffer(&Packed);
+        BenchFreeBuffer(&Pitched);
+    }
+    BenchFreeBuffer(&Source);
+    BenchFreeBuffer(&PitchedSource);
+
+    return(true);
+}
+
+// =====================================================================================================================
+//NOTE: Capture
+
+internal uint32 BenchCaptureValue(uint32 FrameIndex, uint32 Index)
+{
+    //NOTE: Every pixel and sample of a test capture is a function of where it is, so the files can be checked without
+    //  keeping what went into them.
+    uint32 X = (FrameIndex + 1) * 0x9E3779B1u ^ (Index + 1) * 0x85EBCA77u;
+    X ^= X >> 15;
+    X *= 0x2C1B3C6Du;
+    X ^= X >> 12;
+    return(X);
+}
+
+internal void BenchMakeCaptureFrame(game_offscreen_buffer *Picture, int16 *Samples, uint32 SampleCount,
+        uint32 FrameIndex)
+{
+    for (int Y = 0; Y < Picture->Height; ++Y)
+    {
+        uint32 *Row = (uint32 *)((uint8 *)Picture->Memory + Y * Picture->Pitch);
+        for (int X = 0; X < Picture->Width; ++X)
+        {
+            Row[X] = BenchCaptureValue(FrameIndex, (uint32)(Y * Picture->Width + X));
+        }
+    }
+    for (uint32 Index = 0; Index < 2 * SampleCount; ++Index)
+    {
+        Samples[Index] = (int16)BenchCaptureValue(FrameIndex, 0x80000000u + Index);
+    }
+}
+
+internal bool32 BenchCheckCaptureSlot(capture_stream *Stream, capture_slot *Slot, game_offscreen_buffer *Expected,
+        int16 *Samples, capture_index_entry *Entry)
+{
+    bool32 Result = ((Slot->Entry.FrameIndex == Entry->FrameIndex) && (Slot->Entry.SampleCount == Entry->SampleCount) &&
+            (Slot->Entry.SampleIndex == Entry->SampleIndex) && (Slot->Entry.Clock == Entry->Clock) &&
+            (memcmp(Slot->Pixels, Expected->Memory, Stream->FrameSize) == 0) &&
+            (memcmp(Slot->Samples, Samples, Entry->SampleCount * 2 * sizeof(int16)) == 0));
+    if (!Result)
+    {
+        fprintf(stderr, "capture slot for frame %u doesn't hold what was submitted\n", Entry->FrameIndex);
+    }
+    return(Result);
+}
+
+internal bool32 BenchCheckCaptureStream(void)
+{
+    //NOTE: The pool on its own, with no writer: a picture is only queued once it is converted and published, the
+    //  pool fills, drops what doesn't fit without losing its place in the timeline, and takes frames again as slots
+    //  come back.
+    int Width = 33;
+    int Height = 7;
+    uint32 MaxSampleCount = 64;
+    pixel_format Format = PixelFormat_RGB565;
+    memory_index StorageSize = GetCaptureStorageSize(Width, Height, Format, MaxSampleCount);
+    memory_arena Arena;
+    InitializeArena(&Arena, (char *)"Capture", StorageSize, LinuxAllocateMemory(StorageSize));
+    capture_stream *Stream = InitializeCaptureStream(&Arena, Width, Height, Format, 48000, MaxSampleCount, 1000);
+
+    game_offscreen_buffer Picture = BenchAllocateBuffer(Width, Height, 12);
+    game_offscreen_buffer Expected = BenchAllocatePixelBuffer(Width, Height, Format, 0);
+    int16 Samples[2 * 64];
+
+    bool32 Result = true;
+    uint64 SampleIndex = 0;
+    capture_index_entry Entries[CAPTURE_SLOT_COUNT + 3];
+    for (uint32 FrameIndex = 0; Result && (FrameIndex < ArrayCount(Entries)); ++FrameIndex)
+    {
+        uint32 SampleCount = (FrameIndex * 7) % (MaxSampleCount + 1);
+        BenchMakeCaptureFrame(&Picture, Samples, SampleCount, FrameIndex);
+        bool32 Submitted = SubmitCaptureFrame(Stream, &Picture, Samples, SampleCount, 1000 + 10 * FrameIndex);
+
+        capture_index_entry *Entry = Entries + FrameIndex;
+        Entry->FrameIndex = FrameIndex;
+        Entry->SampleCount = SampleCount;
+        Entry->SampleIndex = SampleIndex;
+        Entry->Clock = 10 * FrameIndex;
+        SampleIndex += SampleCount;
+
+        if (Submitted != (FrameIndex < CAPTURE_SLOT_COUNT))
+        {
+            fprintf(stderr, "capture frame %u was %s with %u slots queued\n", FrameIndex,
+                    Submitted ? "taken" : "dropped", FrameIndex);
+            Result = false;
+        }
+        else if (Submitted)
+        {
+            uint32 PictureCount = 0;
+            Result = ((GetCaptureQueued(Stream) == FrameIndex) && ConvertCapturePicture(Stream, &PictureCount) &&
+                    (PictureCount == FrameIndex) && !ConvertCapturePicture(Stream, &PictureCount));
+            if (Result)
+            {
+                PublishCapturePicture(Stream);
+                ConvertPixelsGeneric(&Picture, &Expected, 0, 0, Width, Height);
+                Result = BenchCheckCaptureSlot(Stream, GetCaptureSlot(Stream, FrameIndex), &Expected, Samples, Entry);
+            }
+            else
+            {
+                fprintf(stderr, "capture frame %u was queued before it was published, or converted twice\n",
+                        FrameIndex);
+            }
+        }
+    }
+    if (Result && ((Stream->FrameCount != ArrayCount(Entries)) || (Stream->DroppedFrameCount != 3) ||
+            (Stream->SampleCount != SampleIndex) || (GetCaptureQueued(Stream) != CAPTURE_SLOT_COUNT)))
+    {
+        fprintf(stderr, "capture stream counted %u frames, %u dropped, %llu samples, %u queued\n", Stream->FrameCount,
+                Stream->DroppedFrameCount, (unsigned long long)Stream->SampleCount, GetCaptureQueued(Stream));
+        Result = false;
+    }
+
+    //NOTE: Three slots back, and the next frame goes into the oldest of them, after the frames that were dropped.
+    if (Result)
+    {
+        ReleaseCaptureSlots(Stream, 3);
+        uint32 FrameIndex = ArrayCount(Entries);
+        uint32 SampleCount = 5;
+        BenchMakeCaptureFrame(&Picture, Samples, SampleCount, FrameIndex);
+        capture_index_entry Entry = {FrameIndex, SampleCount, SampleIndex, 10 * FrameIndex};
+        uint32 PictureCount = 0;
+        Result = (SubmitCaptureFrame(Stream, &Picture, Samples, SampleCount, 1000 + 10 * FrameIndex) &&
+                ConvertCapturePicture(Stream, &PictureCount) && (PictureCount == CAPTURE_SLOT_COUNT));
+        if (Result)
+        {
+            PublishCapturePicture(Stream);
+            Result = (GetCaptureQueued(Stream) == (CAPTURE_SLOT_COUNT - 2));
+        }
+        if (Result)
+        {
+            ConvertPixelsGeneric(&Picture, &Expected, 0, 0, Width, Height);
+            Result = BenchCheckCaptureSlot(Stream, GetCaptureSlot(Stream, CAPTURE_SLOT_COUNT), &Expected, Samples,
+                    &Entry);
+        }
+        else
+        {
+            fprintf(stderr, "capture stream didn't take a frame after slots came back\n");
+        }
+    }
+
+    BenchFreeBuffer(&Picture);
+    BenchFreeBuffer(&Expected);
+    munmap(Arena.Base, StorageSize);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+//NOTE: Capture names come from LinuxBuildEXEPathFileName, so there is always room left for the extension.
+global_variable char *GlobalCaptureExtensions[] = {(char *)"raw", (char *)"wav", (char *)"idx"};
+
+internal entire_file BenchReadCaptureFile(char *Name, int FileIndex)
+{
+    char FileName[LINUX_STATE_FILE_NAME_COUNT + 8];
+    snprintf(FileName, sizeof(FileName), "%s.%s", Name, GlobalCaptureExtensions[FileIndex]);
+    entire_file Result = ReadEntireFile(FileName);
+    return(Result);
+}
+
+internal void BenchDeleteCaptureFiles(char *Name)
+{
+    for (int FileIndex = 0; FileIndex < (int)ArrayCount(GlobalCaptureExtensions); ++FileIndex)
+    {
+        char FileName[LINUX_STATE_FILE_NAME_COUNT + 8];
+        snprintf(FileName, sizeof(FileName), "%s.%s", Name, GlobalCaptureExtensions[FileIndex]);
+        unlink(FileName);
+    }
+}
+
+// =====================================================================================================================
+
+inline bool32 BenchIsCaptureWriterIdle(linux_capture *Capture)
+{
+    //NOTE: True once the writer has done everything it can without the frame loop: the picture handed over last is
+    //  converted and written, and every slot published so far is written and back.
+    capture_stream *Stream = Capture->Stream;
+    uint32 PictureState = AtomicLoadAcquire(&Stream->PictureState);
+    uint32 WrittenCount = AtomicLoadAcquire(&Stream->SubmitCount) + (PictureState == CapturePicture_Converted);
+    bool32 Result = (((PictureState == CapturePicture_None) || (PictureState == CapturePicture_Converted)) &&
+            (AtomicLoadAcquire(&Capture->WrittenAheadCount) == WrittenCount) && (GetCaptureQueued(Stream) == 0));
+    return(Result);
+}
+
+internal bool32 BenchWaitForCaptureWriter(linux_capture *Capture)
+{
+    //NOTE: Sleeps rather than spins, since the writer runs at idle priority and only gets the core when this thread
+    //  lets go of it. Gives up after a few seconds, which only a broken writer would take.
+    uint64 StartCounter = LinuxGetWallClock();
+    bool32 Result = true;
+    while (Result && !BenchIsCaptureWriterIdle(Capture))
+    {
+        usleep(100);
+        Result = (LinuxGetMSElapsed(StartCounter, LinuxGetWallClock()) < 5000.0);
+    }
+    if (!Result)
+    {
+        fprintf(stderr, "capture writer stopped making progress\n");
+    }
+    return(Result);
+}
+
+internal bool32 BenchCheckCaptureFiles(pixel_format Format, int Width, int Height, bool32 AllowIORing,
+        int IORingFaultError)
+{
+    //NOTE: A short capture through the real writer, read back from disk. The first frames are queued before the
+    //  writer starts, so the ones past the pool are dropped for certain. After that frames go out in bursts shorter
+    //  than the pool, and the writer is let catch up between bursts, so no other frame can be dropped however busy
+    //  the machine is. Within a burst the writer and the frame loop still race for the pictures, and batches of
+    //  several frames go out. With a fault, the ring keeps failing on purpose (see IORingFaultError), and everything
+    //  still has to come out right.
+    uint32 FrameCount = 200;
+    uint32 SamplesPerSecond = 48000;
+    uint32 MaxSampleCount = 1600;
+
+    linux_state LinuxState = {};
+    LinuxGetEXEFileName(&LinuxState);
+    char Name[LINUX_STATE_FILE_NAME_COUNT];
+    LinuxBuildEXEPathFileName(&LinuxState, (char *)"handmade_bench_capture", sizeof(Name), Name);
+
+    memory_index StorageSize = GetCaptureStorageSize(Width, Height, Format, MaxSampleCount);
+    memory_arena Arena;
+    InitializeArena(&Arena, (char *)"Capture", StorageSize, LinuxAllocateMemory(StorageSize));
+
+    game_offscreen_buffer Picture = BenchAllocateBuffer(Width, Height, 20);
+    game_offscreen_buffer Expected = BenchAllocatePixelBuffer(Width, Height, Format, 0);
+    int16 *Samples = (int16 *)LinuxAllocateMemory(MaxSampleCount * 2 * sizeof(int16));
+    capture_index_entry *Entries = (capture_index_entry *)LinuxAllocateMemory(FrameCount *
+            sizeof(capture_index_entry));
+    bool32 *Dropped = (bool32 *)LinuxAllocateMemory(FrameCount * sizeof(bool32));
+
+    linux_capture Capture;
+    bool32 Result = LinuxBeginCapture(&Capture, &Arena, Name, Width, Height, Format, SamplesPerSecond,
+            MaxSampleCount, AllowIORing);
+    if (!Result)
+    {
+        fprintf(stderr, "unable to capture to %s\n", Name);
+    }
+    bool32 HadIORing = Capture.UseIORing;
+    Capture.IORingFaultError = IORingFaultError;
+
+    uint64 SampleCount = 0;
+    uint32 DroppedCount = 0;
+    uint32 EarlyFrameCount = CAPTURE_SLOT_COUNT + 4;
+    uint32 BurstFrameCount = CAPTURE_SLOT_COUNT - 3;
+    for (uint32 FrameIndex = 0; Result && (FrameIndex < FrameCount); ++FrameIndex)
+    {
+        if (FrameIndex == EarlyFrameCount)
+        {
+            Result = LinuxStartCaptureThread(&Capture) && BenchWaitForCaptureWriter(&Capture);
+        }
+        else if ((FrameIndex > EarlyFrameCount) && (((FrameIndex - EarlyFrameCount) % BurstFrameCount) == 0))
+        {
+            Result = BenchWaitForCaptureWriter(&Capture);
+        }
+
+        //NOTE: The same picture buffer every frame, like the game's, so the last one has to be taken back first.
+        LinuxTakeCapturePicture(&Capture);
+        uint32 FrameSampleCount = (BenchRandom() % 8) ? (uint32)BenchRandomBetween(0, (int)MaxSampleCount) : 0;
+        BenchMakeCaptureFrame(&Picture, Samples, FrameSampleCount, FrameIndex);
+        Dropped[FrameIndex] = !LinuxCaptureFrame(&Capture, &Picture, Samples, FrameSampleCount);
+        Entries[FrameIndex].FrameIndex = FrameIndex;
+        Entries[FrameIndex].SampleCount = FrameSampleCount;
+        Entries[FrameIndex].SampleIndex = SampleCount;
+        SampleCount += FrameSampleCount;
+        DroppedCount += Dropped[FrameIndex] ? 1 : 0;
+
+        if ((FrameIndex < EarlyFrameCount) && (Dropped[FrameIndex] != (FrameIndex >= CAPTURE_SLOT_COUNT)))
+        {
+            fprintf(stderr, "capture frame %u was %s before the writer started\n", FrameIndex,
+                    Dropped[FrameIndex] ? "dropped" : "taken");
+            Result = false;
+        }
+    }
+
+    uint32 ExpectedDroppedCount = EarlyFrameCount - CAPTURE_SLOT_COUNT;
+    if (Result && (DroppedCount != ExpectedDroppedCount))
+    {
+        fprintf(stderr, "capture dropped %u frames, %u of them after the writer started\n", DroppedCount,
+                DroppedCount - ExpectedDroppedCount);
+        Result = false;
+    }
+
+    bool32 UsedIORing = Capture.UseIORing;
+    bool32 UsedDirectIO = Capture.UseDirectIO;
+    if (Result && HadIORing && (UsedIORing != (IORingFaultError != EIO)))
+    {
+        fprintf(stderr, "capture %s io_uring after it failed with %s\n", UsedIORing ? "kept using" : "gave up on",
+                strerror(IORingFaultError));
+        Result = false;
+    }
+    if (Capture.IsCapturing && !LinuxEndCapture(&Capture))
+    {
+        fprintf(stderr, "capture to %s failed to finish\n", Name);
+        Result = false;
+    }
+
+    //NOTE: The index first, since it says what the other two files should hold.
+    entire_file Files[ArrayCount(GlobalCaptureExtensions)] = {};
+    for (int FileIndex = 0; Result && (FileIndex < (int)ArrayCount(Files)); ++FileIndex)
+    {
+        Files[FileIndex] = BenchReadCaptureFile(Name, FileIndex);
+    }
+    entire_file *Video = Files + 0;
+    entire_file *Audio = Files + 1;
+    entire_file *Index = Files + 2;
+
+    uint32 FrameSize = (uint32)(Width * Height * GetPixelFormatBytesPerPixel(Format));
+    uint32 CapturedCount = FrameCount - DroppedCount;
+    if (Result)
+    {
+        capture_index_header *Header = (capture_index_header *)Index->Contents;
+        Result = (Index->Contents &&
+                (Index->ContentsSize == (sizeof(capture_index_header) + CapturedCount * sizeof(capture_index_entry))) &&
+                (Header->MagicValue == CAPTURE_MAGIC_VALUE) && (Header->Version == CAPTURE_VERSION) &&
+                (Header->Width == (uint32)Width) && (Header->Height == (uint32)Height) &&
+                (Header->PixelFormat == (uint32)Format) && (Header->FrameSize == FrameSize) &&
+                (Header->SamplesPerSecond == SamplesPerSecond) && (Header->FrameCount == FrameCount) &&
+                (Header->CapturedFrameCount == CapturedCount) && (Header->DroppedFrameCount == DroppedCount) &&
+                (Header->SampleCount == SampleCount) && (Header->EntryOffset == sizeof(capture_index_header)));
+        if (!Result)
+        {
+            fprintf(stderr, "capture index header or size is wrong\n");
+        }
+    }
+    if (Result)
+    {
+        capture_index_entry *Entry = (capture_index_entry *)(Index->Contents + sizeof(capture_index_header));
+        uint64 LastClock = 0;
+        for (uint32 FrameIndex = 0; Result && (FrameIndex < FrameCount); ++FrameIndex)
+        {
+            if (!Dropped[FrameIndex])
+            {
+                capture_index_entry *Expect = Entries + FrameIndex;
+                Result = ((Entry->FrameIndex == Expect->FrameIndex) && (Entry->SampleCount == Expect->SampleCount) &&
+                        (Entry->SampleIndex == Expect->SampleIndex) && (Entry->Clock >= LastClock));
+                if (!Result)
+                {
+                    fprintf(stderr, "capture index entry for frame %u is wrong\n", FrameIndex);
+                }
+                LastClock = Entry->Clock;
+                ++Entry;
+            }
+        }
+    }
+
+    //NOTE: Then every frame and its samples where the timeline puts them, and zeroes where a frame was dropped.
+    wav_header WAVHeader = MakeWAVHeader(SamplesPerSecond, SampleCount);
+    if (Result)
+    {
+        Result = ((Video->ContentsSize == (uint64)FrameCount * FrameSize) &&
+                (Audio->ContentsSize == sizeof(wav_header) + SampleCount * 2 * sizeof(int16)) &&
+                (memcmp(Audio->Contents, &WAVHeader, sizeof(WAVHeader)) == 0));
+        if (!Result)
+        {
+            fprintf(stderr, "capture raw video is %llu bytes and the WAV %llu, or its header is wrong\n",
+                    (unsigned long long)Video->ContentsSize, (unsigned long long)Audio->ContentsSize);
+        }
+    }
+    for (uint32 FrameIndex = 0; Result && (FrameIndex < FrameCount); ++FrameIndex)
+    {
+        capture_index_entry *Expect = Entries + FrameIndex;
+        BenchMakeCaptureFrame(&Picture, Samples, Expect->SampleCount, FrameIndex);
+        if (Dropped[FrameIndex])
+        {
+            memset(Expected.Memory, 0, FrameSize);
+            memset(Samples, 0, Expect->SampleCount * 2 * sizeof(int16));
+        }
+        else
+        {
+            ConvertPixelsGeneric(&Picture, &Expected, 0, 0, Width, Height);
+        }
+
+        uint8 *FramePixels = Video->Contents + (uint64)FrameIndex * FrameSize;
+        uint8 *FrameSamples = Audio->Contents + sizeof(wav_header) + Expect->SampleIndex * 2 * sizeof(int16);
+        Result = ((memcmp(FramePixels, Expected.Memory, FrameSize) == 0) &&
+                (memcmp(FrameSamples, Samples, Expect->SampleCount * 2 * sizeof(int16)) == 0));
+        if (!Result)
+        {
+            fprintf(stderr, "captured %s frame %u reads back wrong\n", Dropped[FrameIndex] ? "dropped" : "written",
+                    FrameIndex);
+        }
+    }
+
+    if (Result)
+    {
+        printf("  %-8s %3dx%-3d through %-8s %-6s %u frames, %u dropped (all before the writer started), %u batches "
+                "of up to %u frames, %llu writes, %u redone\n",
+                GetPixelFormatName(Format), Width, Height, UsedIORing ? "io_uring" : "pwritev",
+                UsedDirectIO ? "direct" : "", FrameCount, DroppedCount, Capture.BatchCount,
+                Capture.MaxBatchSlotCount, (unsigned long long)Capture.WriteCallCount, Capture.RetryCount);
+        if (IORingFaultError && HadIORing)
+        {
+            printf("  (io_uring_enter failing with %s on every other call)\n", strerror(IORingFaultError));
+        }
+        if (AllowIORing && !HadIORing)
+        {
+            printf("  (io_uring isn't available here, so that was pwritev too)\n");
+        }
+    }
+
+    for (int FileIndex = 0; FileIndex < (int)ArrayCount(Files); ++FileIndex)
+    {
+        FreeEntireFile(Files + FileIndex);
+    }
+    BenchDeleteCaptureFiles(Name);
+    munmap(Dropped, FrameCount * sizeof(bool32));
+    munmap(Entries, FrameCount * sizeof(capture_index_entry));
+    munmap(Samples, MaxSampleCount * 2 * sizeof(int16));
+    BenchFreeBuffer(&Picture);
+    BenchFreeBuffer(&Expected);
+    munmap(Arena.Base, StorageSize);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+struct bench_capture_scene
+{
+    //NOTE: Per frame of every round: the CPU time the whole process spent from the start of the frame to the start
+    //  of the next one, every thread included, and the frame loop's own time up to the flip by the clock. The capture
+    //  calls the frame loop makes are also timed apart.
+    uint64 *FrameCPUNanoseconds;
+    uint64 *WorkCycles;
+    uint64 *CaptureCycles;
+    uint32 MissedFrameCount;
+};
+
+struct bench_capture_run
+{
+    platform_work_queue *HighPriorityQueue;
+    platform_work_queue *LowPriorityQueue;
+    present_state *PresentState;
+    game_offscreen_buffer Display;
+
+    int RoundCount;
+    int FrameCount;
+    bench_capture_scene Off;
+    bench_capture_scene On;
+};
+
+inline uint64 BenchGetProcessCPUClock(void)
+{
+    timespec Clock;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &Clock);
+    uint64 Result = (uint64)Clock.tv_sec * 1000000000ULL + (uint64)Clock.tv_nsec;
+    return(Result);
+}
+
+internal void BenchAllocateCaptureScene(bench_capture_scene *Scene, int FrameCount)
+{
+    Scene->FrameCPUNanoseconds = (uint64 *)LinuxAllocateMemory(FrameCount * sizeof(uint64));
+    Scene->WorkCycles = (uint64 *)LinuxAllocateMemory(FrameCount * sizeof(uint64));
+    Scene->CaptureCycles = (uint64 *)LinuxAllocateMemory(FrameCount * sizeof(uint64));
+}
+
+internal void BenchFreeCaptureScene(bench_capture_scene *Scene, int FrameCount)
+{
+    munmap(Scene->FrameCPUNanoseconds, FrameCount * sizeof(uint64));
+    munmap(Scene->WorkCycles, FrameCount * sizeof(uint64));
+    munmap(Scene->CaptureCycles, FrameCount * sizeof(uint64));
+}
+
+internal void BenchRunCaptureScene(bench_capture_run *Run, bench_capture_scene *Scene, int RoundIndex,
+        linux_capture *Capture)
+{
+    //NOTE: The idle scene at 720p, paced to 60Hz like the harness, so the writer gets what is left of every frame
+    //  the way it would in the game. Every frame is redrawn and presented in full, so every picture is a new one.
+    //  Without a capture the frame loop is exactly the same, minus the capture calls. Nothing waits for the writer:
+    //  when it falls behind, pictures are late and frames are dropped, the way they would be in the game.
+    game_memory Memory = {};
+    Memory.PermanentStorageSize = Megabytes(64);
+    Memory.TransientStorageSize = Gigabytes(1);
+    memory_index MemorySize = Memory.PermanentStorageSize + Memory.TransientStorageSize;
+    Memory.PermanentStorage = LinuxReserveMemory(0, MemorySize);
+    Memory.TransientStorage = (uint8 *)Memory.PermanentStorage + Memory.PermanentStorageSize;
+    Memory.HighPriorityQueue = Run->HighPriorityQueue;
+    Memory.LowPriorityQueue = Run->LowPriorityQueue;
+    Memory.PlatformAPI.AddEntry = LinuxAddEntry;
+    Memory.PlatformAPI.CompleteAllWork = LinuxCompleteAllWork;
+    Memory.PlatformAPI.MapFile = LinuxMapFile;
+    Memory.PlatformAPI.UnmapFile = LinuxUnmapFile;
+
+    game_offscreen_buffer Buffer = BenchAllocateBuffer(1280, 720, 0);
+    Buffer.Dirty = (game_dirty_region *)LinuxAllocateMemory(sizeof(game_dirty_region));
+    Buffer.Dirty->Invalidate = true;
+
+    int SampleCount = 800;
+    int16 *Samples = (int16 *)LinuxAllocateMemory(SampleCount * 2 * sizeof(int16));
+    game_sound_output_buffer SoundBuffer = {48000, SampleCount, Samples};
+
+    game_input Input[2] = {};
+    game_input *NewInput = &Input[0];
+    game_input *OldInput = &Input[1];
+    NewInput->dtForFrame = OldInput->dtForFrame = 1.0f / 60.0f;
+    GetController(NewInput, 0)->IsConnected = true;
+
+    GameUpdateAndRender(&Memory, NewInput, &Buffer, &SoundBuffer);
+    LinuxCompleteAllWork(Run->LowPriorityQueue);
+
+    uint64 *FrameCPUNanoseconds = Scene->FrameCPUNanoseconds + RoundIndex * Run->FrameCount;
+    uint64 *WorkCycles = Scene->WorkCycles + RoundIndex * Run->FrameCount;
+    uint64 *CaptureCycles = Scene->CaptureCycles + RoundIndex * Run->FrameCount;
+    real32 TargetSecondsPerFrame = 1.0f / 60.0f;
+    uint64 FrameStartCPUClock = BenchGetProcessCPUClock();
+    for (int FrameIndex = 0; FrameIndex < Run->FrameCount; ++FrameIndex)
+    {
+        uint64 FrameStart = LinuxGetWallClock();
+        uint64 FrameStartCycleCount = __rdtsc();
+        LinuxCompleteAllWork(Run->LowPriorityQueue);
+        GetController(NewInput, 0)->IsConnected = true;
+        Buffer.Dirty->Invalidate = true;
+
+        uint64 FrameCaptureCycles = 0;
+        if (Capture)
+        {
+            uint64 TakeStartCycleCount = __rdtsc();
+            LinuxTakeCapturePicture(Capture);
+            FrameCaptureCycles += __rdtsc() - TakeStartCycleCount;
+        }
+        GameUpdateAndRender(&Memory, NewInput, &Buffer, &SoundBuffer);
+        PresentBuffer(Run->PresentState, &Buffer, &Run->Display, &Memory.PlatformAPI, Run->HighPriorityQueue);
+        if (Capture)
+        {
+            uint64 SubmitStartCycleCount = __rdtsc();
+            LinuxCaptureFrame(Capture, &Buffer, Samples, (uint32)SoundBuffer.SampleCount);
+            FrameCaptureCycles += __rdtsc() - SubmitStartCycleCount;
+        }
+        WorkCycles[FrameIndex] = __rdtsc() - FrameStartCycleCount;
+        CaptureCycles[FrameIndex] = FrameCaptureCycles;
+
+        if (LinuxWaitForFrameEnd(FrameStart, TargetSecondsPerFrame))
+        {
+            ++Scene->MissedFrameCount;
+        }
+
+        //NOTE: Whatever the writer did with this frame's picture, it did while the frame loop waited for the flip.
+        uint64 FrameEndCPUClock = BenchGetProcessCPUClock();
+        FrameCPUNanoseconds[FrameIndex] = FrameEndCPUClock - FrameStartCPUClock;
+        FrameStartCPUClock = FrameEndCPUClock;
+
+        game_input *Temp = NewInput;
+        NewInput = OldInput;
+        OldInput = Temp;
+    }
+
+    if (Capture)
+    {
+        //NOTE: The last picture handed over is still the game's buffer until it is taken back.
+        LinuxTakeCapturePicture(Capture);
+    }
+    LinuxCompleteAllWork(Run->LowPriorityQueue);
+    CloseAssetFile(&((game_state *)Memory.PermanentStorage)->Assets, &Memory.PlatformAPI);
+    munmap(Memory.PermanentStorage, MemorySize);
+    munmap(Samples, SampleCount * 2 * sizeof(int16));
+    munmap(Buffer.Dirty, sizeof(game_dirty_region));
+    BenchFreeBuffer(&Buffer);
+}
+
+// =====================================================================================================================
+
+internal BENCH_FUNCTION(BenchCapture)
+{
+    printf("capture\n");
+
+    //NOTE: Odd sizes go through the page cache, and sizes that make whole pages around it.
+    bool32 Result = (BenchCheckCaptureStream() &&
+            BenchCheckCaptureFiles(PixelFormat_RGB565, 97, 31, true, 0) &&
+            BenchCheckCaptureFiles(PixelFormat_BGRX32, 97, 31, false, 0) &&
+            BenchCheckCaptureFiles(PixelFormat_Indexed8, 97, 31, true, 0) &&
+            BenchCheckCaptureFiles(PixelFormat_BGRX32, 128, 64, true, 0) &&
+            BenchCheckCaptureFiles(PixelFormat_RGB565, 128, 64, false, 0) &&
+            BenchCheckCaptureFiles(PixelFormat_BGRX32, 128, 64, true, EAGAIN) &&
+            BenchCheckCaptureFiles(PixelFormat_RGB565, 97, 31, true, EIO));
+    if (!Result)
+    {
+        return(false);
+    }
+
+    //NOTE: The same 720p scene at 60Hz without a capture and then with a full-size BGRX32 one, in rounds. The overhead
+    //  is how much longer a frame takes with the capture on, at the p50 and at the p99, and both have to stay under
+    //  5% of a 60Hz frame. A frame is taken in the CPU time of the whole process, so the writer's conversions and
+    //  writes count against the frame they were for, wherever they ran; on a single core that is the frame time,
+    //  and it leaves out whatever other processes had the core. On a busy machine one run of a scene can be a few
+    //  percent off the next for no reason of its own, and its p99 far more than that, so the two take turns and
+    //  what is held against the budget is the median of the rounds. The writer is let finish between scenes, so the
+    //  scene without it never pays for it, but no frame ever waits on it: dropped frames and late pictures are
+    //  reported, not failed on. Queues are leaked on purpose, like every other bench queue, and the profiler is off.
+    GlobalDebugTable = 0;
+    bench_capture_run *Run = (bench_capture_run *)LinuxAllocateMemory(sizeof(bench_capture_run));
+    int ProcessorCount = LinuxGetProcessorCount();
+    Run->HighPriorityQueue = (platform_work_queue *)LinuxAllocateMemory(sizeof(platform_work_queue));
+    LinuxMakeQueue(Run->HighPriorityQueue, ProcessorCount - 1);
+    Run->LowPriorityQueue = (platform_work_queue *)LinuxAllocateMemory(sizeof(platform_work_queue));
+    LinuxMakeQueue(Run->LowPriorityQueue, 2);
+    Run->PresentState = BenchAllocatePresentState(PresentMode_Bilinear);
+    Run->Display = BenchAllocateBuffer(1920, 1080, 0);
+    Run->RoundCount = 5;
+    Run->FrameCount = 120;
+    int TotalFrameCount = Run->RoundCount * Run->FrameCount;
+    BenchAllocateCaptureScene(&Run->Off, TotalFrameCount);
+    BenchAllocateCaptureScene(&Run->On, TotalFrameCount);
+
+    linux_state LinuxState = {};
+    LinuxGetEXEFileName(&LinuxState);
+    char Name[LINUX_STATE_FILE_NAME_COUNT];
+    LinuxBuildEXEPathFileName(&LinuxState, (char *)"handmade_bench_capture", sizeof(Name), Name);
+
+    uint32 MaxSampleCount = 48000;
+    memory_index StorageSize = GetCaptureStorageSize(1280, 720, PixelFormat_BGRX32, MaxSampleCount);
+    memory_arena Arena;
+    InitializeArena(&Arena, (char *)"Capture", StorageSize, LinuxAllocateMemory(StorageSize));
+    linux_capture Capture;
+    Result = (LinuxBeginCapture(&Capture, &Arena, Name, 1280, 720, PixelFormat_BGRX32, 48000, MaxSampleCount, true) &&
+            LinuxStartCaptureThread(&Capture));
+
+    uint64 StartCounter = LinuxGetWallClock();
+    uint64 StartCycleCount = __rdtsc();
+    for (int RoundIndex = 0; Result && (RoundIndex < Run->RoundCount); ++RoundIndex)
+    {
+        BenchRunCaptureScene(Run, &Run->Off, RoundIndex, 0);
+        BenchRunCaptureScene(Run, &Run->On, RoundIndex, &Capture);
+        Result = BenchWaitForCaptureWriter(&Capture);
+    }
+    real64 CyclesPerMS = (real64)(__rdtsc() - StartCycleCount) / LinuxGetMSElapsed(StartCounter, LinuxGetWallClock());
+    if (Capture.IsCapturing && !LinuxEndCapture(&Capture))
+    {
+        Result = false;
+    }
+    BenchDeleteCaptureFiles(Name);
+
+    if (Result)
+    {
+        int FrameCount = Run->FrameCount;
+        bench_capture_scene *Off = &Run->Off;
+        bench_capture_scene *On = &Run->On;
+        real64 FrameMS = 1000.0 / 60.0;
+        real64 P50Percents[16];
+        real64 P99Percents[16];
+        Assert(Run->RoundCount <= (int)ArrayCount(P50Percents));
+        for (int RoundIndex = 0; RoundIndex < Run->RoundCount; ++RoundIndex)
+        {
+            uint64 *OffNanoseconds = Off->FrameCPUNanoseconds + RoundIndex * FrameCount;
+            uint64 *OnNanoseconds = On->FrameCPUNanoseconds + RoundIndex * FrameCount;
+            qsort(OffNanoseconds, FrameCount, sizeof(uint64), BenchCompareCycles);
+            qsort(OnNanoseconds, FrameCount, sizeof(uint64), BenchCompareCycles);
+            P50Percents[RoundIndex] = 100.0 * ((real64)BenchGetPercentile(OnNanoseconds, FrameCount, 50) -
+                    (real64)BenchGetPercentile(OffNanoseconds, FrameCount, 50)) / (1000000.0 * FrameMS);
+            P99Percents[RoundIndex] = 100.0 * ((real64)BenchGetPercentile(OnNanoseconds, FrameCount, 99) -
+                    (real64)BenchGetPercentile(OffNanoseconds, FrameCount, 99)) / (1000000.0 * FrameMS);
+        }
+        qsort(P50Percents, Run->RoundCount, sizeof(real64), BenchCompareReals);
+        qsort(P99Percents, Run->RoundCount, sizeof(real64), BenchCompareReals);
+        real64 P50Percent = P50Percents[Run->RoundCount / 2];
+        real64 P99Percent = P99Percents[Run->RoundCount / 2];
+        real64 BudgetPercent = 5.0;
+
+        qsort(Off->FrameCPUNanoseconds, TotalFrameCount, sizeof(uint64), BenchCompareCycles);
+        qsort(On->FrameCPUNanoseconds, TotalFrameCount, sizeof(uint64), BenchCompareCycles);
+        qsort(Off->WorkCycles, TotalFrameCount, sizeof(uint64), BenchCompareCycles);
+        qsort(On->WorkCycles, TotalFrameCount, sizeof(uint64), BenchCompareCycles);
+        qsort(On->CaptureCycles, TotalFrameCount, sizeof(uint64), BenchCompareCycles);
+        capture_stream *Stream = Capture.Stream;
+
+        printf("  1280x720 bgrx32 at 60Hz through %s%s, %d rounds of %d frames without it and %d with it\n",
+                Capture.UseIORing ? "io_uring" : "pwritev", Capture.UseDirectIO ? " direct" : "", Run->RoundCount,
+                FrameCount, FrameCount);
+        printf("  frame CPU %.03fms p50, %.03fms p99 without; %.03fms p50, %.03fms p99 with\n",
+                (real64)BenchGetPercentile(Off->FrameCPUNanoseconds, TotalFrameCount, 50) / 1000000.0,
+                (real64)BenchGetPercentile(Off->FrameCPUNanoseconds, TotalFrameCount, 99) / 1000000.0,
+                (real64)BenchGetPercentile(On->FrameCPUNanoseconds, TotalFrameCount, 50) / 1000000.0,
+                (real64)BenchGetPercentile(On->FrameCPUNanoseconds, TotalFrameCount, 99) / 1000000.0);
+        printf("  frame loop %.03fms p50, %.03fms p99, %u missed without; %.03fms p50, %.03fms p99, %u missed with\n",
+                (real64)BenchGetPercentile(Off->WorkCycles, TotalFrameCount, 50) / CyclesPerMS,
+                (real64)BenchGetPercentile(Off->WorkCycles, TotalFrameCount, 99) / CyclesPerMS, Off->MissedFrameCount,
+                (real64)BenchGetPercentile(On->WorkCycles, TotalFrameCount, 50) / CyclesPerMS,
+                (real64)BenchGetPercentile(On->WorkCycles, TotalFrameCount, 99) / CyclesPerMS, On->MissedFrameCount);
+        printf("  capture calls %.03fms p50, %.03fms p99, %.03fms worst; writer %.03fms/f at idle; "
+                "%u of %u dropped, %u late\n",
+                (real64)BenchGetPercentile(On->CaptureCycles, TotalFrameCount, 50) / CyclesPerMS,
+                (real64)BenchGetPercentile(On->CaptureCycles, TotalFrameCount, 99) / CyclesPerMS,
+                (real64)On->CaptureCycles[TotalFrameCount - 1] / CyclesPerMS,
+                Capture.WriterMS / (real64)Stream->FrameCount, Stream->DroppedFrameCount, Stream->FrameCount,
+                Capture.LatePictureCount);
+        printf("  overhead %.02f%% p50 (%.02f%% to %.02f%%), %.02f%% p99 (%.02f%% to %.02f%%) of a %.03fms frame "
+                "(budget %.0f%% for both)\n", P50Percent, P50Percents[0], P50Percents[Run->RoundCount - 1],
+                P99Percent, P99Percents[0], P99Percents[Run->RoundCount - 1], FrameMS, BudgetPercent);
+
+        if ((P50Percent >= BudgetPercent) || (P99Percent >= BudgetPercent))
+        {
+            fprintf(stderr, "capture overhead is over budget\n");
+            Result = false;
+        }
+    }
+    else
+    {
+        fprintf(stderr, "unable to capture to %s\n", Name);
+    }
+
+    BenchFreeCaptureScene(&Run->Off, TotalFrameCount);
+    BenchFreeCaptureScene(&Run->On, TotalFrameCount);
+    munmap(Arena.Base, StorageSize);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+global_variable bench_mode GlobalBenchModes[] =
+{
+    {(char *)"render", BenchRender},
+    {(char *)"threads", BenchThreads},
+    {(char *)"sound", BenchSound},
+    {(char *)"mixer", BenchMixer},
+    {(char *)"reload", BenchReload},
+    {(char *)"present", BenchPresent},
+    {(char *)"profiler", BenchProfiler},
+    {(char *)"assets", BenchAssets},
+    {(char *)"streaming", BenchStreaming},
+    {(char *)"sprites", BenchSprites},
+    {(char *)"commands", BenchCommands},
+    {(char *)"audiofeed", BenchAudioFeed},
+    {(char *)"world", BenchWorld},
+    {(char *)"entities", BenchEntities},
+    {(char *)"collision", BenchCollision},
+    {(char *)"dirty", BenchDirty},
+    {(char *)"frames", BenchFrames},
+    {(char *)"controllers", BenchControllers},
+    {(char *)"pixels", BenchPixels},
+    {(char *)"capture", BenchCapture},
+};
+
+internal void BenchPrintUsage(char *ProgramName)
+{
+    fprintf(stderr, "Usage: %s [all", ProgramName);
+    for (int ModeIndex = 0; ModeIndex < (int)ArrayCount(GlobalBenchModes); ++ModeIndex)
+    {
+        fprintf(stderr, "|%s", GlobalBenchModes[ModeIndex].Name);
+    }
+    fprintf(stderr, "] [-frames N] [-playback File] [-results File] [-baseline File] [-margin Percent]\n");
+}
+
+int main(int ArgCount, char **Args)
+{
+    char *ModeName = (ArgCount > 1) ? Args[1] : (char *)"all";
+
+    //NOTE: The options are for the frames mode; the other modes don't take any.
+    for (int ArgIndex = 2; ArgIndex < ArgCount; ++ArgIndex)
+    {
+        char *Arg = Args[ArgIndex];
+        if ((strcmp(Arg, "-frames") == 0) && ((ArgIndex + 1) < ArgCount))
+        {
+            GlobalFrameOptions.FrameCount = atoi(Args[++ArgIndex]);
+            if (GlobalFrameOptions.FrameCount < 1)
+            {
+                GlobalFrameOptions.FrameCount = 1;
+            }
+        }
+        else if ((strcmp(Arg, "-playback") == 0) && ((ArgIndex + 1) < ArgCount))
+        {
+            GlobalFrameOptions.PlaybackFileName = Args[++ArgIndex];
+        }
+        else if ((strcmp(Arg, "-results") == 0) && ((ArgIndex + 1) < ArgCount))
+        {
+            GlobalFrameOptions.ResultsFileName = Args[++ArgIndex];
+        }
+        else if ((strcmp(Arg, "-baseline") == 0) && ((ArgIndex + 1) < ArgCount))
+        {
+            GlobalFrameOptions.BaselineFileName = Args[++ArgIndex];
+        }
+        else if ((strcmp(Arg, "-margin") == 0) && ((ArgIndex + 1) < ArgCount))
+        {
+            GlobalFrameOptions.MarginPercent = atof(Args[++ArgIndex]);
+            if (GlobalFrameOptions.MarginPercent < 0.0)
+            {
+                GlobalFrameOptions.MarginPercent = 0.0;
+            }
+        }
+        else
+        {
+            BenchPrintUsage(Args[0]);
+            return(1);
+        }
+    }
+
+    bool32 FoundMode = false;
+    bool32 Passed = true;
+    for (int ModeIndex = 0; ModeIndex < (int)ArrayCount(GlobalBenchModes); ++ModeIndex)
+    {
+        bench_mode *Mode = &GlobalBenchModes[ModeIndex];
+        if ((strcmp(ModeName, "all") == 0) || (strcmp(ModeName, Mode->Name) == 0))
+        {
+            FoundMode = true;
+            if (!Mode->Function())
+            {
+                fprintf(stderr, "%s: FAILED\n", Mode->Name);
+                Passed = false;
+            }
+        }
+    }
+
+    if (!FoundMode)
+    {
+        BenchPrintUsage(Args[0]);
+        return(1);
+    }
+
+    return(Passed ? 0 : 1);
+}
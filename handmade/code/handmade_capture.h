@@ -0,0 +1,317 @@
+#if !defined(HANDMADE_CAPTURE_H)
+#define HANDMADE_CAPTURE_H
+
+//NOTE: Frame and audio capture, shared by the platform layers.
+//  A capture is three files. Name.raw is every frame's picture back to back with no header, in one of the formats of
+//  handmade_pixel_format.h, so anything that reads raw video can play it given the size and format from the index.
+//  Name.wav is the samples the game mixed each frame, 16-bit stereo. Name.idx is a capture_index_header followed by a
+//  capture_index_entry for every frame that made it to disk.
+//
+//  The frame loop never waits on the disk. Each frame it takes the next slot of a small pool and copies the samples
+//  into it, but leaves the picture where it is: converting a whole picture costs about as much as the rest of the
+//  capture put together, and the platform's writer thread can do it in the time the frame loop spends waiting for
+//  the flip. Before the game draws over the picture again, the frame loop publishes the slot. By then the writer has
+//  nearly always converted the picture; if it hasn't started, the frame loop does it there and then, and if it is
+//  partway through, the frame loop waits for it to finish. The writer writes every slot from where it sits, in
+//  batches, and hands it back once it has been published; a picture the writer converted itself can go out before
+//  that. Like the sound ring, the pool has one producer and one consumer, so slots come back in the order they went
+//  out and two running counts are all the bookkeeping there is.
+//
+//  Slot pictures are page-aligned, so a platform that can write straight from memory to the disk, past its file
+//  cache, can do that whenever the frame size is a whole number of pages.
+//
+//  When every slot is still waiting to be written the frame is dropped rather than stalling the game. A dropped frame
+//  still takes its place in the files: frame N is always at N * FrameSize in the raw file, and its samples are where
+//  the timeline puts them in the WAV. The writes skip over it, so it reads back as black and silent, and it has no
+//  entry in the index.
+
+#define CAPTURE_MAGIC_VALUE (((uint32)'h' << 0) | ((uint32)'m' << 8) | ((uint32)'c' << 16) | ((uint32)'p' << 24))
+#define CAPTURE_VERSION 1
+#define CAPTURE_SLOT_COUNT 8
+#define CAPTURE_PIXEL_ALIGNMENT 4096
+
+#if defined(_MSC_VER)
+inline uint32 AtomicCompareExchangeU32(uint32 volatile *Value, uint32 Expected, uint32 NewValue)
+{
+    uint32 Result = (uint32)_InterlockedCompareExchange((long volatile *)Value, (long)NewValue, (long)Expected);
+    return(Result);
+}
+#else
+inline uint32 AtomicCompareExchangeU32(uint32 volatile *Value, uint32 Expected, uint32 NewValue)
+{
+    __atomic_compare_exchange_n(Value, &Expected, NewValue, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    return(Expected);
+}
+#endif
+
+//NOTE: Where the picture of the last frame handed over is. Whichever thread moves it from pending to converting
+//  does the conversion.
+enum capture_picture_state
+{
+    CapturePicture_None,
+    CapturePicture_Pending,
+    CapturePicture_Converting,
+    CapturePicture_Converted,
+};
+
+struct capture_index_header
+{
+    uint32 MagicValue;
+    uint32 Version;
+
+    uint32 Width;
+    uint32 Height;
+    uint32 PixelFormat;
+    uint32 FrameSize;
+    uint32 SamplesPerSecond;
+
+    //NOTE: Filled in when the capture ends. FrameCount includes the dropped frames, which have no entry.
+    uint32 FrameCount;
+    uint32 CapturedFrameCount;
+    uint32 DroppedFrameCount;
+    uint64 SampleCount;
+    uint64 EntryOffset;
+};
+
+struct capture_index_entry
+{
+    //NOTE: The frame's place in the raw file, and its samples' place in the WAV, in sample frames. Clock is when the
+    //  frame loop handed it over, in nanoseconds from the start of the capture.
+    uint32 FrameIndex;
+    uint32 SampleCount;
+    uint64 SampleIndex;
+    uint64 Clock;
+};
+
+//NOTE: The canonical 44-byte header: a RIFF chunk holding a PCM format chunk and a data chunk.
+struct wav_header
+{
+    uint32 RIFFID;
+    uint32 RIFFSize;
+    uint32 WAVEID;
+
+    uint32 FormatID;
+    uint32 FormatSize;
+    uint16 FormatTag;
+    uint16 ChannelCount;
+    uint32 SamplesPerSecond;
+    uint32 BytesPerSecond;
+    uint16 BlockAlign;
+    uint16 BitsPerSample;
+
+    uint32 DataID;
+    uint32 DataSize;
+};
+
+struct capture_slot
+{
+    void *Pixels;
+    int16 *Samples;
+    capture_index_entry Entry;
+};
+
+struct capture_stream
+{
+    int Width;
+    int Height;
+    pixel_format Format;
+    uint32 FrameSize;
+    uint32 SamplesPerSecond;
+    uint32 MaxSampleCount;
+    uint64 StartClock;
+
+    capture_slot Slots[CAPTURE_SLOT_COUNT];
+
+    //NOTE: Running counts of slots, only wrapped when they are used as an index. The frame loop only ever writes
+    //  SubmitCount and the writer only ever writes WrittenCount, each on its own cache line.
+    alignas(64) uint32 volatile SubmitCount;
+    alignas(64) uint32 volatile WrittenCount;
+
+    //NOTE: The picture goes into the slot SubmitCount points at, which doesn't move until it is published.
+    alignas(64) uint32 volatile PictureState;
+    game_offscreen_buffer Picture;
+
+    //NOTE: Only the frame loop touches these.
+    alignas(64) uint32 FrameCount;
+    uint32 DroppedFrameCount;
+    uint64 SampleCount;
+};
+
+// =====================================================================================================================
+
+inline memory_index GetCaptureStorageSize(int Width, int Height, pixel_format Format, uint32 MaxSampleCount)
+{
+    memory_index FrameSize = (memory_index)Width * Height * GetPixelFormatBytesPerPixel(Format);
+    memory_index SampleSize = (memory_index)MaxSampleCount * 2 * sizeof(int16);
+    memory_index Result = sizeof(capture_stream) + 64 +
+        CAPTURE_SLOT_COUNT * (FrameSize + CAPTURE_PIXEL_ALIGNMENT + SampleSize + 64);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal capture_stream *InitializeCaptureStream(memory_arena *Arena, int Width, int Height, pixel_format Format,
+        uint32 SamplesPerSecond, uint32 MaxSampleCount, uint64 StartClock)
+{
+    capture_stream *Stream = PushStruct(Arena, capture_stream, 64);
+    Stream->Width = Width;
+    Stream->Height = Height;
+    Stream->Format = Format;
+    Stream->FrameSize = (uint32)(Width * Height * GetPixelFormatBytesPerPixel(Format));
+    Stream->SamplesPerSecond = SamplesPerSecond;
+    Stream->MaxSampleCount = MaxSampleCount;
+    Stream->StartClock = StartClock;
+    for (int SlotIndex = 0; SlotIndex < CAPTURE_SLOT_COUNT; ++SlotIndex)
+    {
+        //NOTE: Touched once up front, so the first frames through each slot don't pay for faulting it in.
+        capture_slot *Slot = Stream->Slots + SlotIndex;
+        Slot->Pixels = PushSize(Arena, Stream->FrameSize, CAPTURE_PIXEL_ALIGNMENT);
+        Slot->Samples = PushArray(Arena, 2 * MaxSampleCount, int16, 64);
+        memset(Slot->Pixels, 0, Stream->FrameSize);
+        memset(Slot->Samples, 0, 2 * MaxSampleCount * sizeof(int16));
+    }
+    return(Stream);
+}
+
+// =====================================================================================================================
+
+inline uint32 GetCaptureQueued(capture_stream *Stream)
+{
+    uint32 Result = AtomicLoadAcquire(&Stream->SubmitCount) - AtomicLoadAcquire(&Stream->WrittenCount);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline capture_slot *GetCaptureSlot(capture_stream *Stream, uint32 Count)
+{
+    capture_slot *Result = Stream->Slots + (Count % CAPTURE_SLOT_COUNT);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 SubmitCaptureFrame(capture_stream *Stream, game_offscreen_buffer *Picture, int16 *Samples,
+        uint32 SampleCount, uint64 Clock)
+{
+    //NOTE: Frame loop only. Returns false if the frame had to be dropped. Otherwise the picture has to stay as it is
+    //  until PublishCapturePicture.
+    Assert((Picture->Width == Stream->Width) && (Picture->Height == Stream->Height));
+    Assert(SampleCount <= Stream->MaxSampleCount);
+    Assert(Stream->PictureState == CapturePicture_None);
+
+    capture_index_entry Entry;
+    Entry.FrameIndex = Stream->FrameCount++;
+    Entry.SampleCount = SampleCount;
+    Entry.SampleIndex = Stream->SampleCount;
+    Entry.Clock = Clock - Stream->StartClock;
+    Stream->SampleCount += SampleCount;
+
+    uint32 SubmitCount = Stream->SubmitCount;
+    bool32 Result = ((SubmitCount - AtomicLoadAcquire(&Stream->WrittenCount)) < CAPTURE_SLOT_COUNT);
+    if (Result)
+    {
+        capture_slot *Slot = GetCaptureSlot(Stream, SubmitCount);
+        memcpy(Slot->Samples, Samples, SampleCount * 2 * sizeof(int16));
+        Slot->Entry = Entry;
+        Stream->Picture = *Picture;
+        AtomicStoreRelease(&Stream->PictureState, CapturePicture_Pending);
+    }
+    else
+    {
+        ++Stream->DroppedFrameCount;
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 ConvertCapturePicture(capture_stream *Stream, uint32 *PictureCount)
+{
+    //NOTE: Either thread. Returns true if this call did the converting, and then PictureCount is the running count of
+    //  the slot the picture went into, which the frame loop may publish as soon as this returns.
+    bool32 Result = (AtomicCompareExchangeU32(&Stream->PictureState, CapturePicture_Pending,
+                CapturePicture_Converting) == CapturePicture_Pending);
+    if (Result)
+    {
+        *PictureCount = AtomicLoadAcquire(&Stream->SubmitCount);
+        capture_slot *Slot = GetCaptureSlot(Stream, *PictureCount);
+        game_offscreen_buffer Dest = {};
+        Dest.Memory = Slot->Pixels;
+        Dest.Width = Stream->Width;
+        Dest.Height = Stream->Height;
+        Dest.BytesPerPixel = GetPixelFormatBytesPerPixel(Stream->Format);
+        Dest.Pitch = Dest.Width * Dest.BytesPerPixel;
+
+        //NOTE: Nothing reads the slot again but the disk, so the picture goes around the cache rather than pushing
+        //  the game's working set out of it. Those stores aren't ordered with the release below until fenced.
+        pixel_kernels Kernels = GetPixelKernels(Stream->Format, GetBufferLayout(&Stream->Picture));
+        Kernels.StreamPixels(&Stream->Picture, &Dest, 0, 0, Dest.Width, Dest.Height);
+        _mm_sfence();
+        AtomicStoreRelease(&Stream->PictureState, CapturePicture_Converted);
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline void PublishCapturePicture(capture_stream *Stream)
+{
+    //NOTE: Frame loop only, once the picture is converted. The slot is now the writer's.
+    Assert(AtomicLoadAcquire(&Stream->PictureState) == CapturePicture_Converted);
+    Stream->PictureState = CapturePicture_None;
+    AtomicStoreRelease(&Stream->SubmitCount, Stream->SubmitCount + 1);
+}
+
+// =====================================================================================================================
+
+inline void ReleaseCaptureSlots(capture_stream *Stream, uint32 Count)
+{
+    //NOTE: Writer only, once the oldest Count slots are on their way to disk and may be reused.
+    AtomicStoreRelease(&Stream->WrittenCount, Stream->WrittenCount + Count);
+}
+
+// =====================================================================================================================
+
+internal wav_header MakeWAVHeader(uint32 SamplesPerSecond, uint64 SampleCount)
+{
+    uint32 BlockAlign = 2 * sizeof(int16);
+    wav_header Result = {};
+    Result.RIFFID = (('R' << 0) | ('I' << 8) | ('F' << 16) | ((uint32)'F' << 24));
+    Result.RIFFSize = (uint32)(sizeof(wav_header) - 8 + SampleCount * BlockAlign);
+    Result.WAVEID = (('W' << 0) | ('A' << 8) | ('V' << 16) | ((uint32)'E' << 24));
+    Result.FormatID = (('f' << 0) | ('m' << 8) | ('t' << 16) | ((uint32)' ' << 24));
+    Result.FormatSize = 16;
+    Result.FormatTag = 1;
+    Result.ChannelCount = 2;
+    Result.SamplesPerSecond = SamplesPerSecond;
+    Result.BytesPerSecond = SamplesPerSecond * BlockAlign;
+    Result.BlockAlign = (uint16)BlockAlign;
+    Result.BitsPerSample = 16;
+    Result.DataID = (('d' << 0) | ('a' << 8) | ('t' << 16) | ((uint32)'a' << 24));
+    Result.DataSize = (uint32)(SampleCount * BlockAlign);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal capture_index_header MakeCaptureIndexHeader(capture_stream *Stream)
+{
+    //NOTE: Frame loop only, or once the writer has stopped.
+    capture_index_header Result = {};
+    Result.MagicValue = CAPTURE_MAGIC_VALUE;
+    Result.Version = CAPTURE_VERSION;
+    Result.Width = (uint32)Stream->Width;
+    Result.Height = (uint32)Stream->Height;
+    Result.PixelFormat = (uint32)Stream->Format;
+    Result.FrameSize = Stream->FrameSize;
+    Result.SamplesPerSecond = Stream->SamplesPerSecond;
+    Result.FrameCount = Stream->FrameCount;
+    Result.CapturedFrameCount = Stream->FrameCount - Stream->DroppedFrameCount;
+    Result.DroppedFrameCount = Stream->DroppedFrameCount;
+    Result.SampleCount = Stream->SampleCount;
+    Result.EntryOffset = sizeof(capture_index_header);
+    return(Result);
+}
+
+#endif
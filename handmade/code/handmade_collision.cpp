@@ -0,0 +1,526 @@
+internal void InitializeCollisionGrid(collision_grid *Grid, memory_arena *Arena, uint32 MaxEntityCount, real32 MinX,
+        real32 MinY, real32 CellSize, int32 CellCountX, int32 CellCountY, real32 HalfExtent)
+{
+    Assert((2.0f * HalfExtent) <= CellSize);
+    Assert(((int64)CellCountX * (int64)CellCountY) < (1 << 30));
+
+    *Grid = {};
+    Grid->MinX = MinX;
+    Grid->MinY = MinY;
+    Grid->CellSize = CellSize;
+    Grid->InvCellSize = 1.0f / CellSize;
+    Grid->CellCountX = CellCountX;
+    Grid->CellCountY = CellCountY;
+    Grid->HalfExtent = HalfExtent;
+
+    Grid->CellStart = PushArray(Arena, CellCountX * CellCountY + 1, uint32, 64);
+    ZeroSize((CellCountX * CellCountY + 1) * sizeof(uint32), Grid->CellStart);
+
+    uint32 MaxEntryCount = 4 * MaxEntityCount;
+    Grid->MaxEntityCount = MaxEntityCount;
+    Grid->EntryEntity = PushArray(Arena, MaxEntryCount, uint32, 64);
+    Grid->EntryMinX = PushArray(Arena, MaxEntryCount, real32, 64);
+    Grid->EntryMinY = PushArray(Arena, MaxEntryCount, real32, 64);
+    Grid->EntryMaxX = PushArray(Arena, MaxEntryCount, real32, 64);
+    Grid->EntryMaxY = PushArray(Arena, MaxEntryCount, real32, 64);
+    Grid->EntityCells = PushArray(Arena, MaxEntityCount, uint32, 64);
+}
+
+// =====================================================================================================================
+
+inline int32 GetCollisionCellX(collision_grid *Grid, real32 X)
+{
+    //NOTE: Clamped in float first, so a position too far out to fit in an int32 still lands on the border.
+    real32 Cell = floorf((X - Grid->MinX) * Grid->InvCellSize);
+    int32 Result = (Cell < 0.0f) ? 0 : ((Cell >= (real32)Grid->CellCountX) ? (Grid->CellCountX - 1) : (int32)Cell);
+    return(Result);
+}
+
+inline int32 GetCollisionCellY(collision_grid *Grid, real32 Y)
+{
+    real32 Cell = floorf((Y - Grid->MinY) * Grid->InvCellSize);
+    int32 Result = (Cell < 0.0f) ? 0 : ((Cell >= (real32)Grid->CellCountY) ? (Grid->CellCountY - 1) : (int32)Cell);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline uint32 GetEntityCells(collision_grid *Grid, real32 X, real32 Y)
+{
+    int32 MinCellX = GetCollisionCellX(Grid, X - Grid->HalfExtent);
+    int32 MinCellY = GetCollisionCellY(Grid, Y - Grid->HalfExtent);
+    int32 MaxCellX = GetCollisionCellX(Grid, X + Grid->HalfExtent);
+    int32 MaxCellY = GetCollisionCellY(Grid, Y + Grid->HalfExtent);
+    uint32 Result = (uint32)(MinCellY * Grid->CellCountX + MinCellX);
+    Result |= (MaxCellX != MinCellX) ? (1u << 30) : 0;
+    Result |= (MaxCellY != MinCellY) ? (1u << 31) : 0;
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void BuildCollisionGrid(collision_grid *Grid, real32 *PX, real32 *PY, uint32 EntityCount)
+{
+    TIMED_FUNCTION(EntityCount);
+    Assert(EntityCount <= Grid->MaxEntityCount);
+
+    //NOTE: Most frames most entities stay in the cells they were in, and then all that has to happen is moving the
+    //  boxes. Otherwise it is a counting sort: count every cell's entries, turn the counts into where each cell's run
+    //  ends, then file the entities backwards, each one stepping its cell's end down, which leaves every end where
+    //  its cell starts and keeps each cell in entity order.
+    bool32 CellsChanged = (EntityCount != Grid->EntityCount);
+    for (uint32 EntityIndex = 0; EntityIndex < EntityCount; ++EntityIndex)
+    {
+        uint32 Cells = GetEntityCells(Grid, PX[EntityIndex], PY[EntityIndex]);
+        CellsChanged |= (Cells != Grid->EntityCells[EntityIndex]);
+        Grid->EntityCells[EntityIndex] = Cells;
+    }
+    Grid->EntityCount = EntityCount;
+
+    real32 HalfExtent = Grid->HalfExtent;
+    if (!CellsChanged)
+    {
+        for (uint32 EntryIndex = 0; EntryIndex < Grid->EntryCount; ++EntryIndex)
+        {
+            uint32 EntityIndex = Grid->EntryEntity[EntryIndex];
+            Grid->EntryMinX[EntryIndex] = PX[EntityIndex] - HalfExtent;
+            Grid->EntryMinY[EntryIndex] = PY[EntityIndex] - HalfExtent;
+            Grid->EntryMaxX[EntryIndex] = PX[EntityIndex] + HalfExtent;
+            Grid->EntryMaxY[EntryIndex] = PY[EntityIndex] + HalfExtent;
+        }
+        ++Grid->RefreshCount;
+        return;
+    }
+
+    uint32 CellCount = (uint32)(Grid->CellCountX * Grid->CellCountY);
+    uint32 *CellStart = Grid->CellStart;
+    ZeroSize((CellCount + 1) * sizeof(uint32), CellStart);
+    for (uint32 EntityIndex = 0; EntityIndex < EntityCount; ++EntityIndex)
+    {
+        uint32 Cells = Grid->EntityCells[EntityIndex];
+        uint32 Cell = Cells & ((1u << 30) - 1);
+        uint32 SpillX = (Cells >> 30) & 1;
+        uint32 SpillY = (Cells >> 31) & 1;
+        ++CellStart[Cell];
+        CellStart[Cell + 1] += SpillX;
+        CellStart[Cell + Grid->CellCountX * SpillY] += SpillY;
+        CellStart[Cell + Grid->CellCountX * SpillY + 1] += SpillX & SpillY;
+    }
+
+    uint32 Total = 0;
+    for (uint32 Cell = 0; Cell < CellCount; ++Cell)
+    {
+        Total += CellStart[Cell];
+        CellStart[Cell] = Total;
+    }
+    CellStart[CellCount] = Total;
+    Grid->EntryCount = Total;
+
+    for (uint32 EntityIndex = EntityCount; EntityIndex-- > 0;)
+    {
+        uint32 Cells = Grid->EntityCells[EntityIndex];
+        uint32 FirstCell = Cells & ((1u << 30) - 1);
+        uint32 SpillX = (Cells >> 30) & 1;
+        uint32 SpillY = (Cells >> 31) & 1;
+        real32 MinX = PX[EntityIndex] - HalfExtent;
+        real32 MinY = PY[EntityIndex] - HalfExtent;
+        real32 MaxX = PX[EntityIndex] + HalfExtent;
+        real32 MaxY = PY[EntityIndex] + HalfExtent;
+        for (uint32 dY = 0; dY <= SpillY; ++dY)
+        {
+            for (uint32 dX = 0; dX <= SpillX; ++dX)
+            {
+                uint32 EntryIndex = --CellStart[FirstCell + dY * Grid->CellCountX + dX];
+                Grid->EntryEntity[EntryIndex] = EntityIndex;
+                Grid->EntryMinX[EntryIndex] = MinX;
+                Grid->EntryMinY[EntryIndex] = MinY;
+                Grid->EntryMaxX[EntryIndex] = MaxX;
+                Grid->EntryMaxY[EntryIndex] = MaxY;
+            }
+        }
+    }
+    ++Grid->RebuildCount;
+}
+
+// =====================================================================================================================
+
+inline bool32 IsPairReportedFromCell(collision_grid *Grid, int32 CellX, int32 CellY, real32 MinXA, real32 MinYA,
+        real32 MinXB, real32 MinYB)
+{
+    //NOTE: The min corner of the overlap is inside both boxes, so both were filed under its cell.
+    real32 OverlapMinX = (MinXA > MinXB) ? MinXA : MinXB;
+    real32 OverlapMinY = (MinYA > MinYB) ? MinYA : MinYB;
+    bool32 Result = ((GetCollisionCellX(Grid, OverlapMinX) == CellX) &&
+            (GetCollisionCellY(Grid, OverlapMinY) == CellY));
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal uint32 QueryCollisionBoxes(collision_grid *Grid, uint32 QueryCount, real32 *QueryMinX, real32 *QueryMinY,
+        real32 *QueryMaxX, real32 *QueryMaxY, collision_pair *Pairs, uint32 MaxPairCount)
+{
+    //NOTE: Pairs are (query, entity) for every entity whose box overlaps a query box with some area. Returns how
+    //  many were written; ones that didn't fit are counted in DroppedPairCount.
+    TIMED_FUNCTION(QueryCount);
+
+    uint32 PairCount = 0;
+    for (uint32 QueryIndex = 0; QueryIndex < QueryCount; ++QueryIndex)
+    {
+        real32 MinX = QueryMinX[QueryIndex];
+        real32 MinY = QueryMinY[QueryIndex];
+        real32 MaxX = QueryMaxX[QueryIndex];
+        real32 MaxY = QueryMaxY[QueryIndex];
+        int32 MinCellX = GetCollisionCellX(Grid, MinX);
+        int32 MinCellY = GetCollisionCellY(Grid, MinY);
+        int32 MaxCellX = GetCollisionCellX(Grid, MaxX);
+        int32 MaxCellY = GetCollisionCellY(Grid, MaxY);
+        for (int32 CellY = MinCellY; CellY <= MaxCellY; ++CellY)
+        {
+            for (int32 CellX = MinCellX; CellX <= MaxCellX; ++CellX)
+            {
+                uint32 Cell = (uint32)(CellY * Grid->CellCountX + CellX);
+                for (uint32 EntryIndex = Grid->CellStart[Cell]; EntryIndex < Grid->CellStart[Cell + 1]; ++EntryIndex)
+                {
+                    if ((MinX < Grid->EntryMaxX[EntryIndex]) && (Grid->EntryMinX[EntryIndex] < MaxX) &&
+                            (MinY < Grid->EntryMaxY[EntryIndex]) && (Grid->EntryMinY[EntryIndex] < MaxY) &&
+                            IsPairReportedFromCell(Grid, CellX, CellY, MinX, MinY, Grid->EntryMinX[EntryIndex],
+                                Grid->EntryMinY[EntryIndex]))
+                    {
+                        if (PairCount < MaxPairCount)
+                        {
+                            Pairs[PairCount].A = QueryIndex;
+                            Pairs[PairCount].B = Grid->EntryEntity[EntryIndex];
+                            ++PairCount;
+                        }
+                        else
+                        {
+                            ++Grid->DroppedPairCount;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return(PairCount);
+}
+
+// =====================================================================================================================
+
+internal uint32 FindCollidingEntities(collision_grid *Grid, collision_pair *Pairs, uint32 MaxPairCount)
+{
+    //NOTE: Every pair of entities whose boxes overlap with some area, lower entity index first.
+    TIMED_FUNCTION(Grid->EntryCount);
+
+    uint32 PairCount = 0;
+    for (int32 CellY = 0; CellY < Grid->CellCountY; ++CellY)
+    {
+        for (int32 CellX = 0; CellX < Grid->CellCountX; ++CellX)
+        {
+            uint32 Cell = (uint32)(CellY * Grid->CellCountX + CellX);
+            uint32 OnePastLast = Grid->CellStart[Cell + 1];
+            for (uint32 IndexA = Grid->CellStart[Cell]; IndexA < OnePastLast; ++IndexA)
+            {
+                for (uint32 IndexB = IndexA + 1; IndexB < OnePastLast; ++IndexB)
+                {
+                    if ((Grid->EntryMinX[IndexA] < Grid->EntryMaxX[IndexB]) &&
+                            (Grid->EntryMinX[IndexB] < Grid->EntryMaxX[IndexA]) &&
+                            (Grid->EntryMinY[IndexA] < Grid->EntryMaxY[IndexB]) &&
+                            (Grid->EntryMinY[IndexB] < Grid->EntryMaxY[IndexA]) &&
+                            IsPairReportedFromCell(Grid, CellX, CellY, Grid->EntryMinX[IndexA],
+                                Grid->EntryMinY[IndexA], Grid->EntryMinX[IndexB], Grid->EntryMinY[IndexB]))
+                    {
+                        if (PairCount < MaxPairCount)
+                        {
+                            //NOTE: Cells are filled in entity order, so A already has the lower index.
+                            Pairs[PairCount].A = Grid->EntryEntity[IndexA];
+                            Pairs[PairCount].B = Grid->EntryEntity[IndexB];
+                            ++PairCount;
+                        }
+                        else
+                        {
+                            ++Grid->DroppedPairCount;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return(PairCount);
+}
+
+// =====================================================================================================================
+
+inline bool32 IntersectRayBox(real32 OriginX, real32 OriginY, real32 DeltaX, real32 DeltaY, real32 MinX, real32 MinY,
+        real32 MaxX, real32 MaxY, real32 *tHit)
+{
+    //NOTE: Slab test over t in [0, 1]. A ray only hits if some stretch of it is inside the box, so one that just runs
+    //  along an edge or clips a corner doesn't, the same as boxes that only touch don't overlap.
+    real32 tEnter = 0.0f;
+    real32 tExit = 1.0f;
+    if (DeltaX != 0.0f)
+    {
+        real32 t0 = (MinX - OriginX) / DeltaX;
+        real32 t1 = (MaxX - OriginX) / DeltaX;
+        tEnter = fmaxf(tEnter, fminf(t0, t1));
+        tExit = fminf(tExit, fmaxf(t0, t1));
+    }
+    else if ((OriginX <= MinX) || (OriginX >= MaxX))
+    {
+        tExit = -1.0f;
+    }
+    if (DeltaY != 0.0f)
+    {
+        real32 t0 = (MinY - OriginY) / DeltaY;
+        real32 t1 = (MaxY - OriginY) / DeltaY;
+        tEnter = fmaxf(tEnter, fminf(t0, t1));
+        tExit = fminf(tExit, fmaxf(t0, t1));
+    }
+    else if ((OriginY <= MinY) || (OriginY >= MaxY))
+    {
+        tExit = -1.0f;
+    }
+
+    *tHit = tEnter;
+    bool32 Result = (tEnter < tExit);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline void TestRayAgainstCell(collision_grid *Grid, uint32 Cell, real32 OriginX, real32 OriginY, real32 DeltaX,
+        real32 DeltaY, uint32 IgnoreEntity, uint32 *HitEntity, real32 *HitT)
+{
+    for (uint32 EntryIndex = Grid->CellStart[Cell]; EntryIndex < Grid->CellStart[Cell + 1]; ++EntryIndex)
+    {
+        real32 t;
+        uint32 EntityIndex = Grid->EntryEntity[EntryIndex];
+        if ((EntityIndex != IgnoreEntity) &&
+                IntersectRayBox(OriginX, OriginY, DeltaX, DeltaY, Grid->EntryMinX[EntryIndex],
+                    Grid->EntryMinY[EntryIndex], Grid->EntryMaxX[EntryIndex], Grid->EntryMaxY[EntryIndex], &t) &&
+                ((t < *HitT) || ((t == *HitT) && (EntityIndex < *HitEntity))))
+        {
+            *HitT = t;
+            *HitEntity = EntityIndex;
+        }
+    }
+}
+
+// =====================================================================================================================
+
+internal void CastCollisionRays(collision_grid *Grid, uint32 RayCount, real32 *OriginX, real32 *OriginY,
+        real32 *DeltaX, real32 *DeltaY, uint32 *IgnoreEntity, uint32 *HitEntity, real32 *HitT)
+{
+    //NOTE: Each ray runs from its origin to origin + delta, and comes back with the first entity it hits and how far
+    //  along, or COLLISION_NO_HIT. Ties go to the lower entity index. IgnoreEntity can be 0; otherwise each ray skips
+    //  its entry in it, so an entity can cast its own move without hitting itself.
+    TIMED_FUNCTION(RayCount);
+
+    real32 GridMaxX = Grid->MinX + Grid->CellSize * (real32)Grid->CellCountX;
+    real32 GridMaxY = Grid->MinY + Grid->CellSize * (real32)Grid->CellCountY;
+    for (uint32 RayIndex = 0; RayIndex < RayCount; ++RayIndex)
+    {
+        real32 X = OriginX[RayIndex];
+        real32 Y = OriginY[RayIndex];
+        real32 dX = DeltaX[RayIndex];
+        real32 dY = DeltaY[RayIndex];
+        uint32 Ignore = IgnoreEntity ? IgnoreEntity[RayIndex] : COLLISION_NO_HIT;
+        uint32 BestEntity = COLLISION_NO_HIT;
+        real32 BestT = 2.0f;
+
+        int32 CellX = GetCollisionCellX(Grid, X);
+        int32 CellY = GetCollisionCellY(Grid, Y);
+        int32 EndCellX = GetCollisionCellX(Grid, X + dX);
+        int32 EndCellY = GetCollisionCellY(Grid, Y + dY);
+        bool32 Inside = ((fminf(X, X + dX) >= Grid->MinX) && (fmaxf(X, X + dX) < GridMaxX) &&
+                (fminf(Y, Y + dY) >= Grid->MinY) && (fmaxf(Y, Y + dY) < GridMaxY));
+        if (!Inside)
+        {
+            //NOTE: The border cells stand in for everything past them, which a walk along the ray doesn't know
+            //  about, so a ray that leaves the grid just checks every cell its bounds touch.
+            int32 MinCellX = (CellX < EndCellX) ? CellX : EndCellX;
+            int32 MinCellY = (CellY < EndCellY) ? CellY : EndCellY;
+            int32 MaxCellX = (CellX < EndCellX) ? EndCellX : CellX;
+            int32 MaxCellY = (CellY < EndCellY) ? EndCellY : CellY;
+            for (int32 TestY = MinCellY; TestY <= MaxCellY; ++TestY)
+            {
+                for (int32 TestX = MinCellX; TestX <= MaxCellX; ++TestX)
+                {
+                    TestRayAgainstCell(Grid, (uint32)(TestY * Grid->CellCountX + TestX), X, Y, dX, dY, Ignore,
+                            &BestEntity, &BestT);
+                }
+            }
+        }
+        else
+        {
+            //NOTE: Cell by cell along the ray. A hit's entry point is inside its box, so the box was filed under the
+            //  cell that point is in, and no later cell can have a hit earlier than where the ray gets to it. Once the
+            //  best hit comes before the ray leaves the current cell, the rest of the ray doesn't matter.
+            int32 StepX = (dX > 0.0f) ? 1 : -1;
+            int32 StepY = (dY > 0.0f) ? 1 : -1;
+            real32 tDeltaX = (dX != 0.0f) ? (Grid->CellSize / fabsf(dX)) : 2.0f;
+            real32 tDeltaY = (dY != 0.0f) ? (Grid->CellSize / fabsf(dY)) : 2.0f;
+            real32 tNextX = 2.0f;
+            real32 tNextY = 2.0f;
+            if (dX != 0.0f)
+            {
+                real32 BoundaryX = Grid->MinX + Grid->CellSize * (real32)(CellX + ((StepX > 0) ? 1 : 0));
+                tNextX = (BoundaryX - X) / dX;
+            }
+            if (dY != 0.0f)
+            {
+                real32 BoundaryY = Grid->MinY + Grid->CellSize * (real32)(CellY + ((StepY > 0) ? 1 : 0));
+                tNextY = (BoundaryY - Y) / dY;
+            }
+
+            for (;;)
+            {
+                TestRayAgainstCell(Grid, (uint32)(CellY * Grid->CellCountX + CellX), X, Y, dX, dY, Ignore,
+                        &BestEntity, &BestT);
+
+                real32 tLeave = (tNextX < tNextY) ? tNextX : tNextY;
+                if (((CellX == EndCellX) && (CellY == EndCellY)) || (BestT < tLeave) || (tLeave > 1.0f))
+                {
+                    break;
+                }
+
+                //NOTE: Crossing exactly through a corner visits both side cells on the way, which is one cell more
+                //  than needed but never one too few.
+                if (tNextX < tNextY)
+                {
+                    CellX += StepX;
+                    tNextX += tDeltaX;
+                }
+                else
+                {
+                    CellY += StepY;
+                    tNextY += tDeltaY;
+                }
+                if ((CellX < 0) || (CellX >= Grid->CellCountX) || (CellY < 0) || (CellY >= Grid->CellCountY))
+                {
+                    break;
+                }
+            }
+        }
+
+        HitEntity[RayIndex] = BestEntity;
+        HitT[RayIndex] = (BestEntity == COLLISION_NO_HIT) ? 1.0f : BestT;
+    }
+}
+
+// =====================================================================================================================
+
+inline void TestWall(real32 WallX, real32 RelX, real32 RelY, real32 DeltaX, real32 DeltaY, real32 MinY, real32 MaxY,
+        real32 *tMin, bool32 *Hit)
+{
+    //NOTE: One face of a wall box, the line x = WallX from MinY to MaxY, against a point at (RelX, RelY) moving by
+    //  (DeltaX, DeltaY) towards it. Called with the axes swapped for the horizontal faces. The point stops a skin's
+    //  width short of the face, in meters rather than as a fraction of the move, so rounding on a tiny move can't
+    //  carry it through; for the same reason a point that has ended up less than a skin inside still counts as
+    //  being in front of the face.
+    real32 SkinWidth = 0.001f;
+    real32 Distance = (WallX - RelX) * ((DeltaX > 0.0f) ? 1.0f : -1.0f);
+    if ((DeltaX != 0.0f) && (Distance >= -SkinWidth))
+    {
+        real32 tResult = fmaxf(0.0f, (WallX - RelX) / DeltaX);
+        real32 Y = RelY + tResult * DeltaY;
+        if ((tResult < *tMin) && (Y > MinY) && (Y < MaxY))
+        {
+            *tMin = fmaxf(0.0f, tResult - SkinWidth / fabsf(DeltaX));
+            *Hit = true;
+        }
+    }
+}
+
+// =====================================================================================================================
+
+internal world_position MoveAgainstWalls(world *World, world_position P, real32 HalfWidth, real32 HalfHeight,
+        real32 DeltaX, real32 DeltaY)
+{
+    //NOTE: Narrow phase for something the size of the player against the wall tiles: move until the first wall the
+    //  box would hit, drop the part of what's left of the move that goes into that wall, and carry on sliding along
+    //  it. Four goes are enough to get into a corner and stop there.
+    TIMED_FUNCTION();
+
+    for (int Iteration = 0; (Iteration < 4) && ((DeltaX != 0.0f) || (DeltaY != 0.0f)); ++Iteration)
+    {
+        //NOTE: Everything is relative to P's tile, so it stays small and exact however far out P is.
+        tile_position Tile = GetTilePosition(P);
+        real32 FromX = Tile.TileOffsetX;
+        real32 FromY = Tile.TileOffsetY;
+        int32 MinTileX = (int32)floorf((fminf(FromX, FromX + DeltaX) - HalfWidth) / TILE_SIDE_IN_METERS) - 1;
+        int32 MinTileY = (int32)floorf((fminf(FromY, FromY + DeltaY) - HalfHeight) / TILE_SIDE_IN_METERS) - 1;
+        int32 MaxTileX = (int32)floorf((fmaxf(FromX, FromX + DeltaX) + HalfWidth) / TILE_SIDE_IN_METERS) + 1;
+        int32 MaxTileY = (int32)floorf((fmaxf(FromY, FromY + DeltaY) + HalfHeight) / TILE_SIDE_IN_METERS) + 1;
+
+        real32 tMin = 1.0f;
+        real32 NormalX = 0.0f;
+        real32 NormalY = 0.0f;
+        for (int32 RelTileY = MinTileY; RelTileY <= MaxTileY; ++RelTileY)
+        {
+            for (int32 RelTileX = MinTileX; RelTileX <= MaxTileX; ++RelTileX)
+            {
+                if (GetTileValue(World, Tile.TileX + RelTileX, Tile.TileY + RelTileY) != TileValue_Wall)
+                {
+                    continue;
+                }
+
+                //NOTE: The wall grown by the player's half size, so the player can be treated as a point.
+                real32 MinX = (real32)RelTileX * TILE_SIDE_IN_METERS - HalfWidth;
+                real32 MinY = (real32)RelTileY * TILE_SIDE_IN_METERS - HalfHeight;
+                real32 MaxX = (real32)(RelTileX + 1) * TILE_SIDE_IN_METERS + HalfWidth;
+                real32 MaxY = (real32)(RelTileY + 1) * TILE_SIDE_IN_METERS + HalfHeight;
+
+                bool32 Hit = false;
+                if (DeltaX > 0.0f)
+                {
+                    TestWall(MinX, FromX, FromY, DeltaX, DeltaY, MinY, MaxY, &tMin, &Hit);
+                    if (Hit)
+                    {
+                        NormalX = -1.0f;
+                        NormalY = 0.0f;
+                        Hit = false;
+                    }
+                }
+                if (DeltaX < 0.0f)
+                {
+                    TestWall(MaxX, FromX, FromY, DeltaX, DeltaY, MinY, MaxY, &tMin, &Hit);
+                    if (Hit)
+                    {
+                        NormalX = 1.0f;
+                        NormalY = 0.0f;
+                        Hit = false;
+                    }
+                }
+                if (DeltaY > 0.0f)
+                {
+                    TestWall(MinY, FromY, FromX, DeltaY, DeltaX, MinX, MaxX, &tMin, &Hit);
+                    if (Hit)
+                    {
+                        NormalX = 0.0f;
+                        NormalY = -1.0f;
+                        Hit = false;
+                    }
+                }
+                if (DeltaY < 0.0f)
+                {
+                    TestWall(MaxY, FromY, FromX, DeltaY, DeltaX, MinX, MaxX, &tMin, &Hit);
+                    if (Hit)
+                    {
+                        NormalX = 0.0f;
+                        NormalY = 1.0f;
+                    }
+                }
+            }
+        }
+
+        P = MapIntoChunkSpace(P, tMin * DeltaX, tMin * DeltaY);
+
+        real32 RemainingX = (1.0f - tMin) * DeltaX;
+        real32 RemainingY = (1.0f - tMin) * DeltaY;
+        real32 IntoWall = RemainingX * NormalX + RemainingY * NormalY;
+        DeltaX = RemainingX - IntoWall * NormalX;
+        DeltaY = RemainingY - IntoWall * NormalY;
+    }
+    return(P);
+}
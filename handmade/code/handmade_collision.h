@@ -0,0 +1,55 @@
+#if !defined(HANDMADE_COLLISION_H)
+#define HANDMADE_COLLISION_H
+
+//NOTE: Collision.
+//  The broad phase is a uniform grid over a rectangle of the high set's camera-relative space. Every entity is a
+//  square box around its position, and the box is filed under every cell it touches; cells are at least twice the
+//  box's half extent across, so that is never more than four. Anything outside the grid's rectangle is filed under the
+//  nearest border cell, so the grid never loses an entity, it just gets slower out there.
+//
+//  The grid is rebuilt with a counting sort into one packed array of entries, so a cell's entries sit next to each
+//  other. When no entity has changed cells since the last build, the boxes are just rewritten in place.
+//
+//  Queries are batched: one call takes a whole array of boxes or rays. A pair that shares several cells is only
+//  reported from the one cell holding the min corner of the two boxes' overlap, so nothing is reported twice.
+
+#define COLLISION_NO_HIT 0xFFFFFFFF
+
+struct collision_pair
+{
+    uint32 A;
+    uint32 B;
+};
+
+struct collision_grid
+{
+    real32 MinX;
+    real32 MinY;
+    real32 CellSize;
+    real32 InvCellSize;
+    int32 CellCountX;
+    int32 CellCountY;
+    real32 HalfExtent;
+
+    //NOTE: CellStart has one more entry than there are cells; a cell's entries run from its start to the next one's.
+    uint32 *CellStart;
+
+    uint32 MaxEntityCount;
+    uint32 EntityCount;
+    uint32 EntryCount;
+    uint32 *EntryEntity;
+    real32 *EntryMinX;
+    real32 *EntryMinY;
+    real32 *EntryMaxX;
+    real32 *EntryMaxY;
+
+    //NOTE: Per entity, the first cell it was filed under in the last build, with bit 30 set if it also spilled into
+    //  the next column and bit 31 if it spilled into the next row.
+    uint32 *EntityCells;
+
+    uint32 RebuildCount;
+    uint32 RefreshCount;
+    uint32 DroppedPairCount;
+};
+
+#endif
@@ -0,0 +1,306 @@
+#if !defined(HANDMADE_CONTROLLER_POLL_H)
+#define HANDMADE_CONTROLLER_POLL_H
+
+//NOTE: Gamepad input shared by the platform layers.
+//  Gamepads are read on a thread of their own instead of once a frame. The thread samples every connected slot at the
+//  poll rate, runs the stick through the dead zone, and counts every button change it sees, so a tap that starts and
+//  ends inside one frame still reaches the game as two half transitions, and the stick comes out as the average of
+//  every sample taken since the last frame rather than wherever it happened to be when the frame started.
+//
+//  Asking an empty slot is the expensive case (XInput goes looking for a device every time), so each time a slot comes
+//  back empty it waits twice as long before it is asked again, up to CONTROLLER_POLL_MAX_BACKOFF_MS.
+//
+//  Everything the thread publishes is a running total: transition counts and stick sums only ever go up, so the frame
+//  loop turns the snapshot it took last frame and the one it takes now into a frame's input by subtracting, and a
+//  snapshot it never got to see loses nothing. Snapshots go through a triple buffer: the thread always has a buffer of
+//  its own to write, the frame loop always has one of its own to read, and they trade through the third with a single
+//  exchange, so neither side ever waits on the other.
+
+#if defined(_MSC_VER)
+inline uint32 AtomicExchangeU32(uint32 volatile *Value, uint32 NewValue)
+{
+    uint32 Result = (uint32)_InterlockedExchange((long volatile *)Value, (long)NewValue);
+    return(Result);
+}
+#else
+inline uint32 AtomicExchangeU32(uint32 volatile *Value, uint32 NewValue)
+{
+    uint32 Result = __atomic_exchange_n(Value, NewValue, __ATOMIC_ACQ_REL);
+    return(Result);
+}
+#endif
+
+//NOTE: Slot N shows up as controller N + 1; controller 0 is the keyboard.
+#define CONTROLLER_POLL_SLOT_COUNT 4
+
+#define CONTROLLER_POLL_DEFAULT_HZ 1000
+#define CONTROLLER_POLL_MAX_HZ 8000
+#define CONTROLLER_POLL_MAX_BACKOFF_MS 1000
+
+//NOTE: XINPUT_GAMEPAD_LEFT_THUMB_DEADZONE, for the platforms that don't have XInput's headers to take it from.
+#define CONTROLLER_POLL_DEFAULT_DEAD_ZONE 7849
+
+#define CONTROLLER_SNAPSHOT_FRESH 4
+
+//NOTE: In the order of game_controller_input::Buttons.
+enum controller_button
+{
+    ControllerButton_MoveUp,
+    ControllerButton_MoveDown,
+    ControllerButton_MoveLeft,
+    ControllerButton_MoveRight,
+
+    ControllerButton_ActionUp,
+    ControllerButton_ActionDown,
+    ControllerButton_ActionLeft,
+    ControllerButton_ActionRight,
+
+    ControllerButton_LeftShoulder,
+    ControllerButton_RightShoulder,
+
+    ControllerButton_Back,
+    ControllerButton_Start,
+
+    ControllerButton_Count,
+};
+
+//NOTE: What the platform reads off a device. Bit N of ButtonsDown is controller_button N.
+struct controller_reading
+{
+    uint32 ButtonsDown;
+    int16 StickX;
+    int16 StickY;
+};
+
+//NOTE: Returns false if there is nothing in the slot.
+#define CONTROLLER_POLL_READ(name) bool32 name(void *Context, uint32 SlotIndex, controller_reading *Reading)
+typedef CONTROLLER_POLL_READ(controller_poll_read);
+
+struct controller_slot_state
+{
+    bool32 IsConnected;
+    uint32 ButtonsDown;
+
+    //NOTE: Running totals since the poller started.
+    uint32 HalfTransitionCount[ControllerButton_Count];
+    uint64 SampleCount;
+    real64 StickSumX;
+    real64 StickSumY;
+
+    real32 StickX;
+    real32 StickY;
+
+    //NOTE: Platform clock readings: when the latest sample was taken, and when a button change was last seen.
+    uint64 SampleClock;
+    uint64 ChangeClock;
+};
+
+struct controller_snapshot
+{
+    controller_slot_state Slots[CONTROLLER_POLL_SLOT_COUNT];
+};
+
+struct controller_poller
+{
+    controller_poll_read *Read;
+    void *Context;
+    int16 DeadZone;
+    uint64 ClockFrequency;
+    uint64 PeriodClocks;
+    uint64 MaxBackoffClocks;
+
+    //NOTE: Only the poll thread touches these.
+    uint64 NextPollClock[CONTROLLER_POLL_SLOT_COUNT];
+    uint64 BackoffClocks[CONTROLLER_POLL_SLOT_COUNT];
+    controller_slot_state Working[CONTROLLER_POLL_SLOT_COUNT];
+    uint32 WriteIndex;
+
+    //NOTE: Which buffer is in the middle, with CONTROLLER_SNAPSHOT_FRESH set if the frame loop hasn't taken it yet.
+    alignas(64) uint32 volatile MiddleIndex;
+
+    //NOTE: Only the frame loop touches this.
+    alignas(64) uint32 ReadIndex;
+
+    alignas(64) controller_snapshot Snapshots[3];
+
+    //NOTE: Only the poll thread writes these, anyone may read them for a report.
+    alignas(64) uint32 volatile PassCount;
+    uint32 volatile ReadCount[CONTROLLER_POLL_SLOT_COUNT];
+    uint32 volatile EmptyReadCount;
+};
+
+// =====================================================================================================================
+
+internal real32 ProcessControllerStickValue(int16 Value, int16 DeadZoneThreshold)
+{
+    //NOTE: Inside the dead zone the stick reads exactly zero, and outside it the range is rescaled so that the edge
+    //  of the dead zone is 0 and full deflection is still 1, instead of jumping straight to the threshold value.
+    real32 Result = 0.0f;
+    if (Value < -DeadZoneThreshold)
+    {
+        Result = (real32)(Value + DeadZoneThreshold) / (32768.0f - DeadZoneThreshold);
+    }
+    else if (Value > DeadZoneThreshold)
+    {
+        Result = (real32)(Value - DeadZoneThreshold) / (32767.0f - DeadZoneThreshold);
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline void InitializeControllerPoller(controller_poller *Poller, controller_poll_read *Read, void *Context,
+        uint64 ClockFrequency, uint32 PollHz, int16 DeadZone)
+{
+    //NOTE: The clock is whatever the platform's wall clock counts in, ClockFrequency ticks a second.
+    Assert((PollHz > 0) && (PollHz <= CONTROLLER_POLL_MAX_HZ));
+    *Poller = {};
+    Poller->Read = Read;
+    Poller->Context = Context;
+    Poller->DeadZone = DeadZone;
+    Poller->ClockFrequency = ClockFrequency;
+    Poller->PeriodClocks = ClockFrequency / PollHz;
+    Poller->MaxBackoffClocks = (ClockFrequency * CONTROLLER_POLL_MAX_BACKOFF_MS) / 1000;
+    Poller->WriteIndex = 0;
+    Poller->MiddleIndex = 1;
+    Poller->ReadIndex = 2;
+}
+
+// =====================================================================================================================
+
+internal uint64 PollControllers(controller_poller *Poller, uint64 Clock)
+{
+    //NOTE: Poll thread only. Reads every slot that is due and publishes if any were, and returns the clock at which
+    //  the next slot comes due, which is always later than Clock.
+    bool32 ReadAny = false;
+    uint64 Result = (uint64)-1;
+    for (uint32 SlotIndex = 0; SlotIndex < CONTROLLER_POLL_SLOT_COUNT; ++SlotIndex)
+    {
+        if (Clock >= Poller->NextPollClock[SlotIndex])
+        {
+            controller_slot_state *Slot = Poller->Working + SlotIndex;
+            controller_reading Reading = {};
+            bool32 IsConnected = Poller->Read(Poller->Context, SlotIndex, &Reading);
+            ++Poller->ReadCount[SlotIndex];
+            ReadAny = true;
+
+            //NOTE: A controller that goes away lets go of everything it was holding.
+            uint32 ButtonsDown = IsConnected ? (Reading.ButtonsDown & ((1 << ControllerButton_Count) - 1)) : 0;
+            uint32 Changed = ButtonsDown ^ Slot->ButtonsDown;
+            if (Changed)
+            {
+                for (int ButtonIndex = 0; ButtonIndex < ControllerButton_Count; ++ButtonIndex)
+                {
+                    Slot->HalfTransitionCount[ButtonIndex] += (Changed >> ButtonIndex) & 1;
+                }
+                Slot->ButtonsDown = ButtonsDown;
+                Slot->ChangeClock = Clock;
+            }
+            Slot->IsConnected = IsConnected;
+
+            uint64 NextPollClock;
+            if (IsConnected)
+            {
+                Slot->StickX = ProcessControllerStickValue(Reading.StickX, Poller->DeadZone);
+                Slot->StickY = ProcessControllerStickValue(Reading.StickY, Poller->DeadZone);
+                Slot->StickSumX += Slot->StickX;
+                Slot->StickSumY += Slot->StickY;
+                ++Slot->SampleCount;
+                Slot->SampleClock = Clock;
+
+                //NOTE: Scheduled off the last due time so the rate doesn't drift with how late the thread woke, but a
+                //  wake that comes in late doesn't try to make up for the polls it missed.
+                Poller->BackoffClocks[SlotIndex] = 0;
+                NextPollClock = Poller->NextPollClock[SlotIndex] + Poller->PeriodClocks;
+                if (NextPollClock <= Clock)
+                {
+                    NextPollClock = Clock + Poller->PeriodClocks;
+                }
+            }
+            else
+            {
+                Slot->StickX = 0.0f;
+                Slot->StickY = 0.0f;
+                ++Poller->EmptyReadCount;
+
+                uint64 Backoff = 2 * (Poller->BackoffClocks[SlotIndex] ? Poller->BackoffClocks[SlotIndex] :
+                        Poller->PeriodClocks);
+                if (Backoff > Poller->MaxBackoffClocks)
+                {
+                    Backoff = Poller->MaxBackoffClocks;
+                }
+                Poller->BackoffClocks[SlotIndex] = Backoff;
+                NextPollClock = Clock + Backoff;
+            }
+            Poller->NextPollClock[SlotIndex] = NextPollClock;
+        }
+
+        if (Poller->NextPollClock[SlotIndex] < Result)
+        {
+            Result = Poller->NextPollClock[SlotIndex];
+        }
+    }
+
+    if (ReadAny)
+    {
+        controller_snapshot *Snapshot = Poller->Snapshots + Poller->WriteIndex;
+        for (uint32 SlotIndex = 0; SlotIndex < CONTROLLER_POLL_SLOT_COUNT; ++SlotIndex)
+        {
+            Snapshot->Slots[SlotIndex] = Poller->Working[SlotIndex];
+        }
+        Poller->WriteIndex = AtomicExchangeU32(&Poller->MiddleIndex, Poller->WriteIndex | CONTROLLER_SNAPSHOT_FRESH) &
+            (CONTROLLER_SNAPSHOT_FRESH - 1);
+    }
+    ++Poller->PassCount;
+
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal controller_snapshot *ReadControllerSnapshot(controller_poller *Poller)
+{
+    //NOTE: Frame loop only. The snapshot stays put until the next call; if nothing was published since the last
+    //  call, it is the same one again.
+    if (Poller->MiddleIndex & CONTROLLER_SNAPSHOT_FRESH)
+    {
+        Poller->ReadIndex = AtomicExchangeU32(&Poller->MiddleIndex, Poller->ReadIndex) &
+            (CONTROLLER_SNAPSHOT_FRESH - 1);
+    }
+    controller_snapshot *Result = Poller->Snapshots + Poller->ReadIndex;
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void ApplyControllerSlot(controller_slot_state *Old, controller_slot_state *New,
+        game_controller_input *Controller)
+{
+    //NOTE: Old is the slot as of the last frame. If no sample came in since then, the stick just holds.
+    Assert(ControllerButton_Count == ArrayCount(Controller->Buttons));
+    *Controller = {};
+    Controller->IsConnected = New->IsConnected;
+    Controller->IsAnalog = true;
+
+    uint64 SampleCount = New->SampleCount - Old->SampleCount;
+    if (SampleCount)
+    {
+        Controller->StickAverageX = (real32)((New->StickSumX - Old->StickSumX) / (real64)SampleCount);
+        Controller->StickAverageY = (real32)((New->StickSumY - Old->StickSumY) / (real64)SampleCount);
+    }
+    else
+    {
+        Controller->StickAverageX = New->StickX;
+        Controller->StickAverageY = New->StickY;
+    }
+
+    for (int ButtonIndex = 0; ButtonIndex < ControllerButton_Count; ++ButtonIndex)
+    {
+        game_button_state *Button = Controller->Buttons + ButtonIndex;
+        Button->EndedDown = (New->ButtonsDown >> ButtonIndex) & 1;
+        Button->HalfTransitionCount = (int)(New->HalfTransitionCount[ButtonIndex] -
+                Old->HalfTransitionCount[ButtonIndex]);
+    }
+}
+
+#endif
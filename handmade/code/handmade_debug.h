@@ -0,0 +1,497 @@
+#if !defined(HANDMADE_DEBUG_H)
+#define HANDMADE_DEBUG_H
+
+//NOTE: Profiler collation, run by the platform layer once per frame, and once more before the game module unloads.
+//  Every thread's ring (see handmade_debug_interface.h) is drained, begin and end events are paired up with a stack
+//  per thread, and each pair is charged to a node in a call tree. A node is a block as reached through one particular
+//  chain of parents, so the same block called from two places shows up twice. Blocks a worker thread runs on its own
+//  hang off the root; blocks the main thread runs while it helps out inside CompleteAllWork hang off whatever it was
+//  in at the time.
+//
+//  Paired events are also kept in a trace buffer holding the most recent MAX_DEBUG_TRACE_EVENT_COUNT blocks, which can
+//  be written out as Chrome trace JSON (chrome://tracing, or ui.perfetto.dev).
+
+#define MAX_DEBUG_NODE_COUNT 1024
+#define DEBUG_NODE_HASH_COUNT (2 * MAX_DEBUG_NODE_COUNT)
+#define MAX_DEBUG_STACK_DEPTH 64
+#define MAX_DEBUG_TRACE_EVENT_COUNT (1 << 20)
+
+struct debug_node
+{
+    //NOTE: Names are copied out of the debug_record, because the record goes away when the game module reloads.
+    char BlockName[64];
+    char FileName[32];
+    int LineNumber;
+
+    uint32 ParentIndex;
+    uint32 Depth;
+    uint32 Hash;
+
+    uint64 FrameCycles;
+    uint32 FrameHitCount;
+
+    uint64 TotalCycles;
+    uint64 TotalHitCount;
+    uint64 MaxFrameCycles;
+};
+
+struct debug_open_block
+{
+    debug_record *Record;
+    uint32 NodeIndex;
+    uint64 BeginClock;
+};
+
+struct debug_thread_state
+{
+    uint32 StackCount;
+    debug_open_block Stack[MAX_DEBUG_STACK_DEPTH];
+};
+
+struct debug_trace_event
+{
+    uint64 BeginClock;
+    uint64 EndClock;
+    uint32 NodeIndex;
+    uint32 ThreadIndex;
+};
+
+struct debug_state
+{
+    debug_table *Table;
+
+    //NOTE: Node 0 is the root, which stands for the whole frame.
+    uint32 NodeCount;
+    debug_node Nodes[MAX_DEBUG_NODE_COUNT];
+    uint32 NodeHash[DEBUG_NODE_HASH_COUNT];
+
+    debug_thread_state Threads[MAX_DEBUG_THREAD_COUNT];
+
+    //NOTE: Set once the current frame has been drained into at least once, so the per-frame counts are only reset at
+    //  the first drain of a frame and an extra drain partway through it adds to them.
+    bool32 FrameIsOpen;
+    uint32 FrameCount;
+    uint64 FirstFrameClock;
+    uint64 LastFrameClock;
+    real64 FirstFrameSeconds;
+    real64 LastFrameSeconds;
+
+    uint32 MismatchedEventCount;
+    uint32 NodeOverflowCount;
+
+    uint64 TraceEventCount;
+    debug_trace_event *TraceEvents;
+};
+
+// =====================================================================================================================
+
+internal void CopyDebugString(char *Dest, int DestCount, char *Source)
+{
+    int CharIndex = 0;
+    for (; Source[CharIndex] && (CharIndex < (DestCount - 1)); ++CharIndex)
+    {
+        Dest[CharIndex] = Source[CharIndex];
+    }
+    Dest[CharIndex] = 0;
+}
+
+// =====================================================================================================================
+
+internal void InitializeDebugState(debug_state *State, debug_table *Table, memory_arena *Arena)
+{
+    //NOTE: State and table are expected to come out of zeroed memory.
+    State->Table = Table;
+    State->TraceEvents = PushArray(Arena, MAX_DEBUG_TRACE_EVENT_COUNT, debug_trace_event, 64);
+
+    debug_node *Root = State->Nodes;
+    CopyDebugString(Root->BlockName, sizeof(Root->BlockName), (char *)"Frame");
+    CopyDebugString(Root->FileName, sizeof(Root->FileName), (char *)"");
+    State->NodeCount = 1;
+}
+
+// =====================================================================================================================
+
+internal uint32 HashDebugRecord(uint32 ParentIndex, debug_record *Record)
+{
+    uint32 Hash = 2166136261u ^ (ParentIndex * 31u) ^ ((uint32)Record->LineNumber * 65599u);
+    for (char *Scan = Record->BlockName; *Scan; ++Scan)
+    {
+        Hash = (Hash ^ (uint8)*Scan) * 16777619u;
+    }
+    for (char *Scan = Record->FileName; *Scan; ++Scan)
+    {
+        Hash = (Hash ^ (uint8)*Scan) * 16777619u;
+    }
+    return(Hash);
+}
+
+// =====================================================================================================================
+
+internal char *GetBaseFileName(char *FileName)
+{
+    char *Result = FileName;
+    for (char *Scan = FileName; *Scan; ++Scan)
+    {
+        if ((*Scan == '/') || (*Scan == '\\'))
+        {
+            Result = Scan + 1;
+        }
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal uint32 GetDebugNode(debug_state *State, uint32 ParentIndex, debug_record *Record)
+{
+    //NOTE: Nodes are identified by what the record says rather than by its address, so a block keeps its node when
+    //  a reloaded game module puts the record somewhere else. Returns the root if we run out of nodes.
+    uint32 Hash = HashDebugRecord(ParentIndex, Record);
+    char *FileName = GetBaseFileName(Record->FileName);
+
+    uint32 Result = 0;
+    for (uint32 Probe = 0; Probe < DEBUG_NODE_HASH_COUNT; ++Probe)
+    {
+        uint32 Slot = (Hash + Probe) & (DEBUG_NODE_HASH_COUNT - 1);
+        uint32 NodeIndex = State->NodeHash[Slot];
+        if (NodeIndex == 0)
+        {
+            if (State->NodeCount < MAX_DEBUG_NODE_COUNT)
+            {
+                Result = State->NodeCount++;
+                debug_node *Node = State->Nodes + Result;
+                CopyDebugString(Node->BlockName, sizeof(Node->BlockName), Record->BlockName);
+                CopyDebugString(Node->FileName, sizeof(Node->FileName), FileName);
+                Node->LineNumber = Record->LineNumber;
+                Node->ParentIndex = ParentIndex;
+                Node->Depth = State->Nodes[ParentIndex].Depth + 1;
+                Node->Hash = Hash;
+                State->NodeHash[Slot] = Result;
+            }
+            else
+            {
+                ++State->NodeOverflowCount;
+            }
+            break;
+        }
+
+        debug_node *Node = State->Nodes + NodeIndex;
+        if ((Node->Hash == Hash) && (Node->ParentIndex == ParentIndex) && (Node->LineNumber == Record->LineNumber) &&
+                (strncmp(Node->BlockName, Record->BlockName, sizeof(Node->BlockName) - 1) == 0) &&
+                (strncmp(Node->FileName, FileName, sizeof(Node->FileName) - 1) == 0))
+        {
+            Result = NodeIndex;
+            break;
+        }
+    }
+
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void CollateDebugThreadRing(debug_state *State, uint32 ThreadIndex)
+{
+    debug_thread_ring *Ring = State->Table->Rings + ThreadIndex;
+    debug_thread_state *Thread = State->Threads + ThreadIndex;
+
+    uint32 WriteIndex = Ring->WriteIndex;
+    CompletePreviousReadsBeforeFutureReads;
+
+    for (uint32 ReadIndex = Ring->ReadIndex; ReadIndex != WriteIndex; ++ReadIndex)
+    {
+        debug_event *Event = Ring->Events + (ReadIndex & (DEBUG_RING_EVENT_COUNT - 1));
+        if (Event->Type == DebugEvent_BeginBlock)
+        {
+            if (Thread->StackCount < MAX_DEBUG_STACK_DEPTH)
+            {
+                uint32 ParentIndex = Thread->StackCount ? Thread->Stack[Thread->StackCount - 1].NodeIndex : 0;
+                debug_open_block *Open = Thread->Stack + Thread->StackCount++;
+                Open->Record = Event->Record;
+                Open->NodeIndex = GetDebugNode(State, ParentIndex, Event->Record);
+                Open->BeginClock = Event->Clock;
+            }
+            else
+            {
+                ++State->MismatchedEventCount;
+            }
+        }
+        else
+        {
+            //NOTE: An end that doesn't close the innermost open block means its begin was dropped; skip it.
+            if (Thread->StackCount && (Thread->Stack[Thread->StackCount - 1].Record == Event->Record))
+            {
+                debug_open_block *Open = Thread->Stack + --Thread->StackCount;
+                debug_node *Node = State->Nodes + Open->NodeIndex;
+                Node->FrameCycles += Event->Clock - Open->BeginClock;
+                Node->FrameHitCount += Event->HitCount;
+
+                debug_trace_event *Trace = State->TraceEvents +
+                    (State->TraceEventCount++ & (MAX_DEBUG_TRACE_EVENT_COUNT - 1));
+                Trace->BeginClock = Open->BeginClock;
+                Trace->EndClock = Event->Clock;
+                Trace->NodeIndex = Open->NodeIndex;
+                Trace->ThreadIndex = ThreadIndex;
+            }
+            else
+            {
+                ++State->MismatchedEventCount;
+            }
+        }
+    }
+
+    //NOTE: The slots have to be read before the producer is allowed to reuse them.
+    CompletePreviousReadsBeforeFutureReads;
+    Ring->ReadIndex = WriteIndex;
+}
+
+// =====================================================================================================================
+
+internal void CollateDebugRings(debug_state *State)
+{
+    //NOTE: Drains every ring into the current frame without ending it. Events only point at their debug_record, and
+    //  the records of blocks in the game module go away with it, so the platform calls this right before unloading
+    //  the module, once nothing is running module code any more.
+    if (!State->FrameIsOpen)
+    {
+        for (uint32 NodeIndex = 0; NodeIndex < State->NodeCount; ++NodeIndex)
+        {
+            State->Nodes[NodeIndex].FrameCycles = 0;
+            State->Nodes[NodeIndex].FrameHitCount = 0;
+        }
+        State->FrameIsOpen = true;
+    }
+
+    uint32 RingCount = State->Table->RingCount;
+    if (RingCount > MAX_DEBUG_THREAD_COUNT)
+    {
+        RingCount = MAX_DEBUG_THREAD_COUNT;
+    }
+    for (uint32 ThreadIndex = 0; ThreadIndex < RingCount; ++ThreadIndex)
+    {
+        CollateDebugThreadRing(State, ThreadIndex);
+    }
+}
+
+// =====================================================================================================================
+
+internal void CollateDebugFrame(debug_state *State, real64 WallClockSeconds)
+{
+    //NOTE: The frame is everything since the last call. WallClockSeconds is only used to work out how fast the
+    //  timestamp counter runs, for the trace.
+    uint64 FrameClock = __rdtsc();
+    CollateDebugRings(State);
+
+    if (State->FrameCount == 0)
+    {
+        State->FirstFrameClock = FrameClock;
+        State->FirstFrameSeconds = WallClockSeconds;
+    }
+    else
+    {
+        debug_node *Root = State->Nodes;
+        Root->FrameCycles = FrameClock - State->LastFrameClock;
+        Root->FrameHitCount = 1;
+
+        debug_trace_event *Trace = State->TraceEvents +
+            (State->TraceEventCount++ & (MAX_DEBUG_TRACE_EVENT_COUNT - 1));
+        Trace->BeginClock = State->LastFrameClock;
+        Trace->EndClock = FrameClock;
+        Trace->NodeIndex = 0;
+        Trace->ThreadIndex = 0;
+    }
+    State->LastFrameClock = FrameClock;
+    State->LastFrameSeconds = WallClockSeconds;
+
+    for (uint32 NodeIndex = 0; NodeIndex < State->NodeCount; ++NodeIndex)
+    {
+        debug_node *Node = State->Nodes + NodeIndex;
+        Node->TotalCycles += Node->FrameCycles;
+        Node->TotalHitCount += Node->FrameHitCount;
+        if (Node->FrameCycles > Node->MaxFrameCycles)
+        {
+            Node->MaxFrameCycles = Node->FrameCycles;
+        }
+    }
+
+    State->FrameIsOpen = false;
+    ++State->FrameCount;
+}
+
+// =====================================================================================================================
+
+internal int FormatDebugNode(debug_state *State, uint32 NodeIndex, real64 FrameCount, real64 CyclesPerFrame,
+        char *Buffer, int BufferSize)
+{
+    //NOTE: Children are listed most expensive first.
+    int Used = 0;
+    debug_node *Node = State->Nodes + NodeIndex;
+    if (NodeIndex != 0)
+    {
+        int Indent = 2 * (int)Node->Depth;
+        char Location[48];
+        snprintf(Location, sizeof(Location), "%s(%d)", Node->FileName, Node->LineNumber);
+        Used += snprintf(Buffer + Used, BufferSize - Used,
+                "%*s%-*s %10.03f %7.02f%% %10.02f %12.01f %10.03f  %s\n", Indent, "", 44 - Indent, Node->BlockName,
+                ((real64)Node->TotalCycles / FrameCount) / 1000000.0,
+                CyclesPerFrame ? (100.0 * ((real64)Node->TotalCycles / FrameCount) / CyclesPerFrame) : 0.0,
+                (real64)Node->TotalHitCount / FrameCount,
+                Node->TotalHitCount ? ((real64)Node->TotalCycles / (real64)Node->TotalHitCount) : 0.0,
+                (real64)Node->MaxFrameCycles / 1000000.0, Location);
+    }
+
+    uint64 PreviousCycles = (uint64)-1;
+    uint32 PreviousIndex = 0;
+    for (;;)
+    {
+        uint32 BestIndex = 0;
+        for (uint32 ChildIndex = 1; ChildIndex < State->NodeCount; ++ChildIndex)
+        {
+            debug_node *Child = State->Nodes + ChildIndex;
+            if ((Child->ParentIndex == NodeIndex) &&
+                    ((Child->TotalCycles < PreviousCycles) ||
+                     ((Child->TotalCycles == PreviousCycles) && (ChildIndex > PreviousIndex))))
+            {
+                if (!BestIndex || (Child->TotalCycles > State->Nodes[BestIndex].TotalCycles))
+                {
+                    BestIndex = ChildIndex;
+                }
+            }
+        }
+
+        if (!BestIndex || (Used >= BufferSize))
+        {
+            break;
+        }
+
+        Used += FormatDebugNode(State, BestIndex, FrameCount, CyclesPerFrame, Buffer + Used, BufferSize - Used);
+        PreviousCycles = State->Nodes[BestIndex].TotalCycles;
+        PreviousIndex = BestIndex;
+    }
+
+    if (Used > BufferSize)
+    {
+        Used = BufferSize;
+    }
+    return(Used);
+}
+
+// =====================================================================================================================
+
+internal int FormatDebugReport(debug_state *State, char *Buffer, int BufferSize)
+{
+    //NOTE: Averages over every frame collated so far. Returns the number of characters written, truncating if the
+    //  buffer runs out.
+    int Used = 0;
+    if (State->FrameCount > 1)
+    {
+        //NOTE: The first collation only opens the first frame, so it doesn't count.
+        real64 FrameCount = (real64)(State->FrameCount - 1);
+        real64 CyclesPerFrame = (real64)State->Nodes[0].TotalCycles / FrameCount;
+
+        uint32 DroppedEventCount = 0;
+        uint32 RingCount = State->Table->RingCount;
+        for (uint32 RingIndex = 0; (RingIndex < RingCount) && (RingIndex < MAX_DEBUG_THREAD_COUNT); ++RingIndex)
+        {
+            DroppedEventCount += State->Table->Rings[RingIndex].DroppedEventCount;
+        }
+
+        Used += snprintf(Buffer + Used, BufferSize - Used,
+                "profile: %u frames, %.03fMc per frame, %u threads, %u dropped / %u unmatched events\n",
+                State->FrameCount - 1, CyclesPerFrame / 1000000.0, (RingCount < MAX_DEBUG_THREAD_COUNT) ?
+                RingCount : MAX_DEBUG_THREAD_COUNT, DroppedEventCount, State->MismatchedEventCount);
+        if (Used < BufferSize)
+        {
+            Used += snprintf(Buffer + Used, BufferSize - Used, "%-44s %10s %8s %10s %12s %10s\n",
+                    "  block", "Mc/frame", "frame", "hits/frame", "cycles/hit", "max Mc");
+        }
+        if (Used < BufferSize)
+        {
+            Used += FormatDebugNode(State, 0, FrameCount, CyclesPerFrame, Buffer + Used, BufferSize - Used);
+        }
+    }
+
+    if (Used > BufferSize)
+    {
+        Used = BufferSize;
+    }
+    return(Used);
+}
+
+// =====================================================================================================================
+
+internal void WriteJSONString(FILE *File, char *String)
+{
+    fputc('"', File);
+    for (char *Scan = String; *Scan; ++Scan)
+    {
+        if ((*Scan == '"') || (*Scan == '\\'))
+        {
+            fputc('\\', File);
+        }
+        fputc(*Scan, File);
+    }
+    fputc('"', File);
+}
+
+// =====================================================================================================================
+
+internal bool32 WriteDebugChromeTrace(debug_state *State, char *FileName)
+{
+    //NOTE: Writes the blocks still held in the trace buffer as Chrome "complete" events. Thread IDs are ring indices,
+    //  and ring 0 is whichever thread recorded first, normally the main thread.
+    bool32 Result = false;
+
+    FILE *File = fopen(FileName, "wb");
+    if (File)
+    {
+        real64 Seconds = State->LastFrameSeconds - State->FirstFrameSeconds;
+        uint64 Cycles = State->LastFrameClock - State->FirstFrameClock;
+        real64 MicrosecondsPerCycle = (Cycles && (Seconds > 0.0)) ? ((1000000.0 * Seconds) / (real64)Cycles) : 0.0;
+
+        uint64 FirstEvent = 0;
+        if (State->TraceEventCount > MAX_DEBUG_TRACE_EVENT_COUNT)
+        {
+            FirstEvent = State->TraceEventCount - MAX_DEBUG_TRACE_EVENT_COUNT;
+        }
+
+        uint64 BaseClock = (uint64)-1;
+        for (uint64 EventIndex = FirstEvent; EventIndex < State->TraceEventCount; ++EventIndex)
+        {
+            debug_trace_event *Trace = State->TraceEvents + (EventIndex & (MAX_DEBUG_TRACE_EVENT_COUNT - 1));
+            if (Trace->BeginClock < BaseClock)
+            {
+                BaseClock = Trace->BeginClock;
+            }
+        }
+
+        fprintf(File, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+        uint32 RingCount = State->Table->RingCount;
+        for (uint32 ThreadIndex = 0; (ThreadIndex < RingCount) && (ThreadIndex < MAX_DEBUG_THREAD_COUNT); ++ThreadIndex)
+        {
+            fprintf(File, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+                    "\"args\":{\"name\":\"thread %u\"}},\n", ThreadIndex, ThreadIndex);
+        }
+
+        for (uint64 EventIndex = FirstEvent; EventIndex < State->TraceEventCount; ++EventIndex)
+        {
+            debug_trace_event *Trace = State->TraceEvents + (EventIndex & (MAX_DEBUG_TRACE_EVENT_COUNT - 1));
+            debug_node *Node = State->Nodes + Trace->NodeIndex;
+
+            fprintf(File, "{\"name\":");
+            WriteJSONString(File, Node->BlockName);
+            fprintf(File, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.03f,\"dur\":%.03f}%s\n",
+                    Trace->ThreadIndex, MicrosecondsPerCycle * (real64)(Trace->BeginClock - BaseClock),
+                    MicrosecondsPerCycle * (real64)(Trace->EndClock - Trace->BeginClock),
+                    ((EventIndex + 1) < State->TraceEventCount) ? "," : "");
+        }
+        fprintf(File, "]}\n");
+
+        Result = (ferror(File) == 0);
+        fclose(File);
+    }
+
+    return(Result);
+}
+
+#endif
@@ -0,0 +1,220 @@
+#if !defined(HANDMADE_DEBUG_INTERFACE_H)
+#define HANDMADE_DEBUG_INTERFACE_H
+
+//NOTE: Profiler instrumentation, shared by the platform layer and the game module.
+//  TIMED_BLOCK("Name") / TIMED_FUNCTION() time the rest of the enclosing scope. Each one writes a begin and an end
+//  event, stamped with __rdtsc, into a ring buffer that belongs to the calling thread, so recording never takes a
+//  lock or an interlocked operation. Once a frame the platform drains every ring and collates the events into a
+//  call tree (see handmade_debug.h).
+//
+//  Cost: an empty block is two __rdtsc reads plus the bookkeeping for two events. The ~20 cycle budget is held for the
+//  bookkeeping only, since a block can't take fewer than two clock reads. On the 2GHz VM it was measured on
+//  ("handmade_bench profiler"), __rdtsc took 41 cycles and an empty block 89 in all: 82 for the clock, 7 for the rest.
+//
+//  The rings live in platform-owned memory so they survive the game module being reloaded. Each module keeps its own
+//  thread-local pointer to the calling thread's ring, and finds it again by thread ID after a reload.
+//
+//  In release builds (HANDMADE_INTERNAL 0) the macros expand to nothing.
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define HANDMADE_THREAD_LOCAL __declspec(thread)
+#define CompletePreviousWritesBeforeFutureWrites _WriteBarrier()
+#define CompletePreviousReadsBeforeFutureReads _ReadBarrier()
+#else
+#include <x86intrin.h>
+//NOTE: The initial-exec model keeps the ring lookup a single fs-relative load even inside the game module, instead
+//  of a call to __tls_get_addr on every event.
+#define HANDMADE_THREAD_LOCAL __thread __attribute__((tls_model("initial-exec")))
+#define CompletePreviousWritesBeforeFutureWrites asm volatile("" ::: "memory")
+#define CompletePreviousReadsBeforeFutureReads asm volatile("" ::: "memory")
+#endif
+
+#define MAX_DEBUG_THREAD_COUNT 32
+#define DEBUG_RING_EVENT_COUNT 16384
+
+struct debug_record
+{
+    char *FileName;
+    char *BlockName;
+    int LineNumber;
+};
+
+enum debug_event_type
+{
+    DebugEvent_BeginBlock,
+    DebugEvent_EndBlock,
+};
+
+struct debug_event
+{
+    uint64 Clock;
+    debug_record *Record;
+    uint32 HitCount;
+    uint8 Type;
+};
+
+struct debug_thread_ring
+{
+    //NOTE: Single producer (the thread that owns it), single consumer (the collator). The indices only ever count
+    //  up; masking them gives the slot.
+    uint32 volatile WriteIndex;
+    uint32 volatile ReadIndex;
+    uint32 DroppedEventCount;
+    uint64 volatile ThreadID;
+
+    debug_event Events[DEBUG_RING_EVENT_COUNT];
+};
+
+struct debug_table
+{
+    uint32 volatile RingCount;
+    debug_thread_ring Rings[MAX_DEBUG_THREAD_COUNT];
+};
+
+global_variable debug_table *GlobalDebugTable;
+global_variable HANDMADE_THREAD_LOCAL debug_thread_ring *GlobalDebugThreadRing;
+
+// =====================================================================================================================
+
+inline uint64 GetThreadID(void)
+{
+    //NOTE: The address of the thread's own control block, read straight out of the segment register. It is unique
+    //  per thread, the same from every module, and doesn't cost a system call.
+    uint64 ThreadID;
+#if defined(_MSC_VER)
+    ThreadID = __readgsqword(0x30);
+#else
+    asm("mov %%fs:0, %0" : "=r"(ThreadID));
+#endif
+    return(ThreadID);
+}
+
+// =====================================================================================================================
+
+inline uint32 AtomicAddU32(uint32 volatile *Value, uint32 Addend)
+{
+    //NOTE: Returns the value from before the add.
+#if defined(_MSC_VER)
+    uint32 Result = (uint32)_InterlockedExchangeAdd((long volatile *)Value, (long)Addend);
+#else
+    uint32 Result = __atomic_fetch_add(Value, Addend, __ATOMIC_SEQ_CST);
+#endif
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal debug_thread_ring *AcquireDebugThreadRing(void)
+{
+    //NOTE: Slow path, taken once per thread per module. The ring may already have been claimed by this thread from
+    //  the other module, or from before a reload.
+    debug_thread_ring *Result = 0;
+
+    debug_table *Table = GlobalDebugTable;
+    if (Table)
+    {
+        uint64 ThreadID = GetThreadID();
+        uint32 RingCount = Table->RingCount;
+        if (RingCount > MAX_DEBUG_THREAD_COUNT)
+        {
+            RingCount = MAX_DEBUG_THREAD_COUNT;
+        }
+
+        for (uint32 RingIndex = 0; RingIndex < RingCount; ++RingIndex)
+        {
+            if (Table->Rings[RingIndex].ThreadID == ThreadID)
+            {
+                Result = Table->Rings + RingIndex;
+                break;
+            }
+        }
+
+        if (!Result)
+        {
+            uint32 RingIndex = AtomicAddU32(&Table->RingCount, 1);
+            if (RingIndex < MAX_DEBUG_THREAD_COUNT)
+            {
+                Result = Table->Rings + RingIndex;
+                Result->ThreadID = ThreadID;
+            }
+        }
+
+        GlobalDebugThreadRing = Result;
+    }
+
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline void RecordDebugEvent(uint8 Type, debug_record *Record, uint32 HitCount)
+{
+    debug_thread_ring *Ring = GlobalDebugThreadRing;
+    if (!Ring)
+    {
+        Ring = AcquireDebugThreadRing();
+    }
+
+    if (Ring)
+    {
+        //NOTE: When the collator falls behind we drop events rather than wait for it; it notices the holes.
+        uint32 WriteIndex = Ring->WriteIndex;
+        if ((WriteIndex - Ring->ReadIndex) < DEBUG_RING_EVENT_COUNT)
+        {
+            debug_event *Event = Ring->Events + (WriteIndex & (DEBUG_RING_EVENT_COUNT - 1));
+            Event->Clock = __rdtsc();
+            Event->Record = Record;
+            Event->HitCount = HitCount;
+            Event->Type = Type;
+
+            CompletePreviousWritesBeforeFutureWrites;
+            Ring->WriteIndex = WriteIndex + 1;
+        }
+        else
+        {
+            ++Ring->DroppedEventCount;
+        }
+    }
+}
+
+// =====================================================================================================================
+
+struct timed_block
+{
+    debug_record *Record;
+    uint32 HitCount;
+
+    timed_block(debug_record *RecordInit, uint32 HitCountInit = 1)
+    {
+        Record = RecordInit;
+        HitCount = HitCountInit;
+        RecordDebugEvent(DebugEvent_BeginBlock, Record, 0);
+    }
+
+    ~timed_block()
+    {
+        RecordDebugEvent(DebugEvent_EndBlock, Record, HitCount);
+    }
+};
+
+#if HANDMADE_INTERNAL
+
+//NOTE: The record is a static per call site, and events only point at it. Records in the game module go away when
+//  it is unloaded, so the platform drains every ring (CollateDebugRings) before it unloads the module; after that
+//  nothing refers to them, since nodes keep their own copies of the names.
+#define TIMED_BLOCK__(Name, Number, ...) \
+    local_persist debug_record DebugRecord_##Number = {(char *)__FILE__, (char *)(Name), __LINE__}; \
+    timed_block TimedBlock_##Number(&DebugRecord_##Number, ## __VA_ARGS__)
+#define TIMED_BLOCK_(Name, Number, ...) TIMED_BLOCK__(Name, Number, ## __VA_ARGS__)
+#define TIMED_BLOCK(Name, ...) TIMED_BLOCK_(Name, __COUNTER__, ## __VA_ARGS__)
+#define TIMED_FUNCTION(...) TIMED_BLOCK_(__FUNCTION__, __COUNTER__, ## __VA_ARGS__)
+
+#else
+
+#define TIMED_BLOCK(Name, ...)
+#define TIMED_FUNCTION(...)
+
+#endif
+
+#endif
@@ -0,0 +1,312 @@
+#define INTEGRATE_HIGH_ENTITIES(name) void name(entity_store *Store, real32 dt)
+typedef INTEGRATE_HIGH_ENTITIES(integrate_high_entities);
+
+// =====================================================================================================================
+
+internal void InitializeEntityStore(entity_store *Store, memory_arena *Arena, uint32 MaxEntityCount,
+        int32 HighChunkRadius)
+{
+    *Store = {};
+    Store->MaxEntityCount = MaxEntityCount;
+    Store->Slots = PushArray(Arena, MaxEntityCount + 1, entity_slot, 64);
+    Store->NextUnusedSlot = 1;
+
+    Store->LowP = PushArray(Arena, MaxEntityCount, world_position, 64);
+    Store->LowVX = PushArray(Arena, MaxEntityCount, real32, 64);
+    Store->LowVY = PushArray(Arena, MaxEntityCount, real32, 64);
+    Store->LowFlags = PushArray(Arena, MaxEntityCount, uint32, 64);
+    Store->LowSlot = PushArray(Arena, MaxEntityCount, uint32, 64);
+    Store->LowHighIndex = PushArray(Arena, MaxEntityCount, uint32, 64);
+    Store->LowUpdatedAt = PushArray(Arena, MaxEntityCount, real64, 64);
+
+    uint32 HighCapacity = (MaxEntityCount + 3) & ~3u;
+    Store->HighPX = PushArray(Arena, HighCapacity, real32, 64);
+    Store->HighPY = PushArray(Arena, HighCapacity, real32, 64);
+    Store->HighVX = PushArray(Arena, HighCapacity, real32, 64);
+    Store->HighVY = PushArray(Arena, HighCapacity, real32, 64);
+    Store->HighLowIndex = PushArray(Arena, HighCapacity, uint32, 64);
+
+    Store->HighChunkRadius = HighChunkRadius;
+}
+
+// =====================================================================================================================
+
+internal bool32 GetEntityLowIndex(entity_store *Store, entity_handle Handle, uint32 *LowIndex)
+{
+    //NOTE: False for the null handle and for handles to entities that have since been removed.
+    bool32 Result = false;
+    if ((Handle.SlotIndex != 0) && (Handle.SlotIndex < Store->NextUnusedSlot))
+    {
+        entity_slot *Slot = Store->Slots + Handle.SlotIndex;
+        if (Slot->Generation == Handle.Generation)
+        {
+            *LowIndex = Slot->LowIndex;
+            Result = true;
+        }
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline bool32 IsInHighRegion(entity_store *Store, world_position P, int32 ChunkRadius)
+{
+    int64 dChunkX = (int64)P.ChunkX - (int64)Store->HighOrigin.ChunkX;
+    int64 dChunkY = (int64)P.ChunkY - (int64)Store->HighOrigin.ChunkY;
+    bool32 Result = ((dChunkX >= -ChunkRadius) && (dChunkX <= ChunkRadius) &&
+            (dChunkY >= -ChunkRadius) && (dChunkY <= ChunkRadius));
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void PromoteEntity(entity_store *Store, uint32 LowIndex)
+{
+    Assert(!Store->LowHighIndex[LowIndex]);
+    uint32 HighIndex = Store->HighCount++;
+    world_difference P = SubtractPositions(Store->LowP[LowIndex], Store->HighOrigin);
+    Store->HighPX[HighIndex] = P.dX;
+    Store->HighPY[HighIndex] = P.dY;
+    Store->HighVX[HighIndex] = Store->LowVX[LowIndex];
+    Store->HighVY[HighIndex] = Store->LowVY[LowIndex];
+    Store->HighLowIndex[HighIndex] = LowIndex;
+    Store->LowHighIndex[LowIndex] = HighIndex + 1;
+    ++Store->PromoteCount;
+}
+
+// =====================================================================================================================
+
+internal void RemoveHighEntity(entity_store *Store, uint32 HighIndex)
+{
+    Store->LowHighIndex[Store->HighLowIndex[HighIndex]] = 0;
+
+    uint32 LastIndex = --Store->HighCount;
+    if (HighIndex != LastIndex)
+    {
+        Store->HighPX[HighIndex] = Store->HighPX[LastIndex];
+        Store->HighPY[HighIndex] = Store->HighPY[LastIndex];
+        Store->HighVX[HighIndex] = Store->HighVX[LastIndex];
+        Store->HighVY[HighIndex] = Store->HighVY[LastIndex];
+        Store->HighLowIndex[HighIndex] = Store->HighLowIndex[LastIndex];
+        Store->LowHighIndex[Store->HighLowIndex[HighIndex]] = HighIndex + 1;
+    }
+}
+
+// =====================================================================================================================
+
+internal void DemoteEntity(entity_store *Store, uint32 HighIndex)
+{
+    //NOTE: The high copy is the current one, so it goes back into the low arrays before it is dropped.
+    uint32 LowIndex = Store->HighLowIndex[HighIndex];
+    Store->LowP[LowIndex] = MapIntoChunkSpace(Store->HighOrigin, Store->HighPX[HighIndex], Store->HighPY[HighIndex]);
+    Store->LowVX[LowIndex] = Store->HighVX[HighIndex];
+    Store->LowVY[LowIndex] = Store->HighVY[HighIndex];
+    Store->LowUpdatedAt[LowIndex] = Store->Time;
+    RemoveHighEntity(Store, HighIndex);
+    ++Store->DemoteCount;
+}
+
+// =====================================================================================================================
+
+internal entity_handle AddEntity(entity_store *Store, world_position P, real32 VX, real32 VY, uint32 Flags)
+{
+    //NOTE: Returns the null handle when the store is full. An entity added inside the camera's region goes straight
+    //  into the high set rather than waiting for its first low tick.
+    entity_handle Result = {};
+    if (Store->LowCount < Store->MaxEntityCount)
+    {
+        uint32 SlotIndex = Store->FirstFreeSlot;
+        if (SlotIndex)
+        {
+            Store->FirstFreeSlot = Store->Slots[SlotIndex].LowIndex;
+        }
+        else
+        {
+            SlotIndex = Store->NextUnusedSlot++;
+            Store->Slots[SlotIndex].Generation = 0;
+        }
+
+        uint32 LowIndex = Store->LowCount++;
+        Store->Slots[SlotIndex].LowIndex = LowIndex;
+        Store->LowP[LowIndex] = P;
+        Store->LowVX[LowIndex] = VX;
+        Store->LowVY[LowIndex] = VY;
+        Store->LowFlags[LowIndex] = Flags;
+        Store->LowSlot[LowIndex] = SlotIndex;
+        Store->LowHighIndex[LowIndex] = 0;
+        Store->LowUpdatedAt[LowIndex] = Store->Time;
+
+        if (!(Flags & EntityFlag_NeverHigh) && IsInHighRegion(Store, P, Store->HighChunkRadius))
+        {
+            PromoteEntity(Store, LowIndex);
+        }
+
+        Result.SlotIndex = SlotIndex;
+        Result.Generation = Store->Slots[SlotIndex].Generation;
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 RemoveEntity(entity_store *Store, entity_handle Handle)
+{
+    uint32 LowIndex;
+    bool32 Result = GetEntityLowIndex(Store, Handle, &LowIndex);
+    if (Result)
+    {
+        if (Store->LowHighIndex[LowIndex])
+        {
+            RemoveHighEntity(Store, Store->LowHighIndex[LowIndex] - 1);
+        }
+
+        uint32 LastIndex = --Store->LowCount;
+        if (LowIndex != LastIndex)
+        {
+            Store->LowP[LowIndex] = Store->LowP[LastIndex];
+            Store->LowVX[LowIndex] = Store->LowVX[LastIndex];
+            Store->LowVY[LowIndex] = Store->LowVY[LastIndex];
+            Store->LowFlags[LowIndex] = Store->LowFlags[LastIndex];
+            Store->LowSlot[LowIndex] = Store->LowSlot[LastIndex];
+            Store->LowHighIndex[LowIndex] = Store->LowHighIndex[LastIndex];
+            Store->LowUpdatedAt[LowIndex] = Store->LowUpdatedAt[LastIndex];
+
+            Store->Slots[Store->LowSlot[LowIndex]].LowIndex = LowIndex;
+            if (Store->LowHighIndex[LowIndex])
+            {
+                Store->HighLowIndex[Store->LowHighIndex[LowIndex] - 1] = LowIndex;
+            }
+        }
+
+        entity_slot *Slot = Store->Slots + Handle.SlotIndex;
+        ++Slot->Generation;
+        Slot->LowIndex = Store->FirstFreeSlot;
+        Store->FirstFreeSlot = Handle.SlotIndex;
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 GetEntityPosition(entity_store *Store, entity_handle Handle, world_position *P)
+{
+    //NOTE: A low entity's position is as of its last low tick, so it can be up to LOW_ENTITY_TICK_INTERVAL frames
+    //  behind; LowUpdatedAt says by how much.
+    uint32 LowIndex;
+    bool32 Result = GetEntityLowIndex(Store, Handle, &LowIndex);
+    if (Result)
+    {
+        uint32 HighIndex = Store->LowHighIndex[LowIndex];
+        if (HighIndex)
+        {
+            *P = MapIntoChunkSpace(Store->HighOrigin, Store->HighPX[HighIndex - 1], Store->HighPY[HighIndex - 1]);
+        }
+        else
+        {
+            *P = Store->LowP[LowIndex];
+        }
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+//NOTE: Scalar high entity integration, the reference for the SSE2 path.
+
+internal INTEGRATE_HIGH_ENTITIES(IntegrateHighEntitiesScalar)
+{
+    for (uint32 HighIndex = 0; HighIndex < Store->HighCount; ++HighIndex)
+    {
+        Store->HighPX[HighIndex] = Store->HighPX[HighIndex] + Store->HighVX[HighIndex] * dt;
+        Store->HighPY[HighIndex] = Store->HighPY[HighIndex] + Store->HighVY[HighIndex] * dt;
+    }
+}
+
+// =====================================================================================================================
+//NOTE: SSE2 high entity integration, 4 entities per iteration.
+
+internal INTEGRATE_HIGH_ENTITIES(IntegrateHighEntitiesSSE2)
+{
+    //NOTE: The arrays are padded out to a multiple of 4 and 64-byte aligned, so the last partial group just moves a
+    //  few lanes nobody reads.
+    __m128 dt4x = _mm_set1_ps(dt);
+    for (uint32 HighIndex = 0; HighIndex < Store->HighCount; HighIndex += 4)
+    {
+        __m128 PX = _mm_load_ps(Store->HighPX + HighIndex);
+        __m128 PY = _mm_load_ps(Store->HighPY + HighIndex);
+        __m128 VX = _mm_load_ps(Store->HighVX + HighIndex);
+        __m128 VY = _mm_load_ps(Store->HighVY + HighIndex);
+        _mm_store_ps(Store->HighPX + HighIndex, _mm_add_ps(PX, _mm_mul_ps(VX, dt4x)));
+        _mm_store_ps(Store->HighPY + HighIndex, _mm_add_ps(PY, _mm_mul_ps(VY, dt4x)));
+    }
+}
+
+// =====================================================================================================================
+
+internal void RebaseHighEntities(entity_store *Store, world_position NewOrigin)
+{
+    //NOTE: Moving every high position is a rounding step, so the origin only moves when the camera changes chunk.
+    world_difference Delta = SubtractPositions(Store->HighOrigin, NewOrigin);
+    Store->HighOrigin = NewOrigin;
+
+    __m128 dX4x = _mm_set1_ps(Delta.dX);
+    __m128 dY4x = _mm_set1_ps(Delta.dY);
+    for (uint32 HighIndex = 0; HighIndex < Store->HighCount; HighIndex += 4)
+    {
+        _mm_store_ps(Store->HighPX + HighIndex, _mm_add_ps(_mm_load_ps(Store->HighPX + HighIndex), dX4x));
+        _mm_store_ps(Store->HighPY + HighIndex, _mm_add_ps(_mm_load_ps(Store->HighPY + HighIndex), dY4x));
+    }
+}
+
+// =====================================================================================================================
+
+internal void UpdateEntities(entity_store *Store, world_position CameraP, real32 dt,
+        integrate_high_entities *IntegrateHighEntities)
+{
+    TIMED_FUNCTION(Store->HighCount);
+
+    //NOTE: High positions are relative to the min corner of the camera's chunk.
+    world_position Origin = {CameraP.ChunkX, CameraP.ChunkY, 0.0f, 0.0f};
+    if ((Origin.ChunkX != Store->HighOrigin.ChunkX) || (Origin.ChunkY != Store->HighOrigin.ChunkY))
+    {
+        RebaseHighEntities(Store, Origin);
+    }
+
+    //NOTE: Walked backwards so the entity swapped into a demoted one's place has already been looked at.
+    real32 DemoteMin = -(real32)(Store->HighChunkRadius + 1) * TILE_CHUNK_SIDE_IN_METERS;
+    real32 DemoteMax = (real32)(Store->HighChunkRadius + 2) * TILE_CHUNK_SIDE_IN_METERS;
+    for (uint32 HighIndex = Store->HighCount; HighIndex-- > 0;)
+    {
+        real32 PX = Store->HighPX[HighIndex];
+        real32 PY = Store->HighPY[HighIndex];
+        if ((PX < DemoteMin) || (PX >= DemoteMax) || (PY < DemoteMin) || (PY >= DemoteMax))
+        {
+            DemoteEntity(Store, HighIndex);
+        }
+    }
+
+    //NOTE: This frame's slice of the low set. Each entity catches up on all the time since it was last brought up to
+    //  date in one step, so it covers the same ground as it would have in the high set.
+    for (uint32 LowIndex = Store->Tick % LOW_ENTITY_TICK_INTERVAL; LowIndex < Store->LowCount;
+            LowIndex += LOW_ENTITY_TICK_INTERVAL)
+    {
+        if (Store->LowHighIndex[LowIndex])
+        {
+            continue;
+        }
+
+        real32 Elapsed = (real32)(Store->Time - Store->LowUpdatedAt[LowIndex]);
+        Store->LowP[LowIndex] = MapIntoChunkSpace(Store->LowP[LowIndex], Store->LowVX[LowIndex] * Elapsed,
+                Store->LowVY[LowIndex] * Elapsed);
+        Store->LowUpdatedAt[LowIndex] = Store->Time;
+
+        if (!(Store->LowFlags[LowIndex] & EntityFlag_NeverHigh) &&
+                IsInHighRegion(Store, Store->LowP[LowIndex], Store->HighChunkRadius))
+        {
+            PromoteEntity(Store, LowIndex);
+        }
+    }
+
+    IntegrateHighEntities(Store, dt);
+    Store->Time += dt;
+    ++Store->Tick;
+}
@@ -0,0 +1,77 @@
+#if !defined(HANDMADE_ENTITY_H)
+#define HANDMADE_ENTITY_H
+
+//NOTE: Entities.
+//  Every entity is a low entity: a world_position, a velocity and flags, each field in its own packed array, indexed
+//  the same way. The entities near the camera are also high entities, with a copy of their position relative to the
+//  camera in plain floats, again one packed array per field. The high set is simulated every frame with wide
+//  loads; the low set is walked a slice at a time, so each low entity is only touched once every
+//  LOW_ENTITY_TICK_INTERVAL frames, and that walk is where entities drifting into the camera's region get promoted.
+//
+//  Both sets are dense, and removing from the middle swaps the last entity into the hole. Handles stay valid through
+//  that because they name a slot in an indirection table, not an array index, and a slot's generation goes up every
+//  time it is reused, so a handle to a removed entity never finds whatever took its slot.
+
+#define LOW_ENTITY_TICK_INTERVAL 8
+
+//NOTE: Index 0 is never handed out, so a zeroed handle is the null handle.
+struct entity_handle
+{
+    uint32 SlotIndex;
+    uint32 Generation;
+};
+
+enum entity_flag
+{
+    //NOTE: Kept out of the high set no matter where the camera is.
+    EntityFlag_NeverHigh = (1 << 0),
+    EntityFlag_Visible = (1 << 1),
+};
+
+//NOTE: LowIndex is the entity's index in the low arrays while the slot is live, and the next free slot while it isn't.
+struct entity_slot
+{
+    uint32 Generation;
+    uint32 LowIndex;
+};
+
+struct entity_store
+{
+    uint32 MaxEntityCount;
+
+    entity_slot *Slots;
+    uint32 FirstFreeSlot;
+    uint32 NextUnusedSlot;
+
+    //NOTE: Low set, every entity. HighIndex is the index in the high arrays plus one, 0 for entities that aren't
+    //  high; UpdatedAt is the Time the entity's position was last brought up to date.
+    uint32 LowCount;
+    world_position *LowP;
+    real32 *LowVX;
+    real32 *LowVY;
+    uint32 *LowFlags;
+    uint32 *LowSlot;
+    uint32 *LowHighIndex;
+    real64 *LowUpdatedAt;
+
+    //NOTE: High set. Positions are in meters from HighOrigin. The arrays have room for a whole number of SIMD
+    //  iterations past MaxEntityCount, so the integration never needs a scalar tail.
+    uint32 HighCount;
+    world_position HighOrigin;
+    real32 *HighPX;
+    real32 *HighPY;
+    real32 *HighVX;
+    real32 *HighVY;
+    uint32 *HighLowIndex;
+
+    //NOTE: Entities whose chunk is within HighChunkRadius chunks of the camera's are promoted; high entities are only
+    //  demoted again once they are a further chunk out than that, so nothing flickers between the two on a border.
+    int32 HighChunkRadius;
+    uint32 Tick;
+    real64 Time;
+
+    uint32 PromoteCount;
+    uint32 DemoteCount;
+};
+
+#endif
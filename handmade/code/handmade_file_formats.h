@@ -0,0 +1,84 @@
+#if !defined(HANDMADE_FILE_FORMATS_H)
+#define HANDMADE_FILE_FORMATS_H
+
+//NOTE: The packed asset file (.hma), written offline by handmade_packer and memory-mapped by the game.
+//  Everything in it is already in the layout the engine uses, so loading is mapping the file and pointing into it:
+//
+//  Bitmaps are top-down, 4 bytes per pixel in the offscreen buffer's BB GG RR AA memory order, with alpha
+//    premultiplied into the color channels. Rows are packed, so the pitch is Width * 4.
+//  Sounds are 16-bit, with each channel stored contiguously one after the other (all of channel 0, then all of
+//    channel 1) since that is how loaded_sound and the mixer read them. They are not resampled; the rate they were
+//    recorded at is kept in the entry.
+//
+//  Layout: hma_header, then hma_asset[AssetCount] starting at Header.Assets, then the data. Every asset's data starts
+//  on an HMA_DATA_ALIGNMENT boundary so SIMD code can read it with aligned loads.
+
+#define HMA_MAGIC_VALUE (((uint32)'h' << 0) | ((uint32)'m' << 8) | ((uint32)'a' << 16) | ((uint32)'f' << 24))
+#define HMA_VERSION 1
+#define HMA_DATA_ALIGNMENT 64
+#define HMA_NAME_COUNT 48
+
+enum hma_asset_type
+{
+    HMAAsset_None,
+    HMAAsset_Bitmap,
+    HMAAsset_Sound,
+};
+
+#pragma pack(push, 1)
+struct hma_header
+{
+    uint32 MagicValue;
+    uint32 Version;
+    uint32 AssetCount;
+    uint32 Reserved;
+
+    uint64 Assets;
+    uint64 FileSize;
+};
+
+struct hma_bitmap
+{
+    uint32 Width;
+    uint32 Height;
+};
+
+struct hma_sound
+{
+    uint32 SampleCount;
+    uint32 ChannelCount;
+    uint32 SamplesPerSecond;
+};
+
+struct hma_asset
+{
+    //NOTE: The source file's name without its directory or extension, 0-terminated.
+    char Name[HMA_NAME_COUNT];
+    uint32 NameHash;
+    uint32 Type;
+
+    uint64 DataOffset;
+    uint64 DataSize;
+
+    union
+    {
+        hma_bitmap Bitmap;
+        hma_sound Sound;
+    };
+};
+#pragma pack(pop)
+
+// =====================================================================================================================
+
+inline uint32 HashAssetName(char *Name)
+{
+    //NOTE: FNV-1a. Only used to skip string compares when looking assets up by name.
+    uint32 Hash = 2166136261u;
+    for (char *Scan = Name; *Scan; ++Scan)
+    {
+        Hash = (Hash ^ (uint8)*Scan) * 16777619u;
+    }
+    return(Hash);
+}
+
+#endif
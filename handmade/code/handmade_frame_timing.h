@@ -0,0 +1,96 @@
+#if !defined(HANDMADE_FRAME_TIMING_H)
+#define HANDMADE_FRAME_TIMING_H
+
+//NOTE: Frame pacing statistics shared by the platform layers.
+//  Each platform does its own sleeping and spinning; this only keeps score. Jitter is how far a finished frame landed
+//  from the target frame time, bucketed so that a long session can be summarized in a few lines.
+
+#define FRAME_JITTER_BUCKET_COUNT 8
+global_variable real32 GlobalFrameJitterBucketMaxMS[FRAME_JITTER_BUCKET_COUNT] =
+{
+    0.1f, 0.25f, 0.5f, 1.0f, 2.0f, 4.0f, 8.0f, 1000000.0f,
+};
+
+struct frame_timing_stats
+{
+    real32 TargetSecondsPerFrame;
+
+    uint32 FrameCount;
+    uint32 MissedFrameCount;
+    real32 MaxJitterMS;
+    real64 TotalJitterMS;
+    uint32 JitterHistogram[FRAME_JITTER_BUCKET_COUNT];
+};
+
+// =====================================================================================================================
+
+inline void BeginFrameTimingStats(frame_timing_stats *Stats, real32 TargetSecondsPerFrame)
+{
+    *Stats = {};
+    Stats->TargetSecondsPerFrame = TargetSecondsPerFrame;
+}
+
+// =====================================================================================================================
+
+inline void RecordFrameTiming(frame_timing_stats *Stats, real32 SecondsElapsedForFrame, bool32 MissedFrame)
+{
+    real32 JitterMS = 1000.0f * (SecondsElapsedForFrame - Stats->TargetSecondsPerFrame);
+    if (JitterMS < 0.0f)
+    {
+        JitterMS = -JitterMS;
+    }
+
+    int BucketIndex = 0;
+    while ((BucketIndex < (FRAME_JITTER_BUCKET_COUNT - 1)) && (JitterMS >= GlobalFrameJitterBucketMaxMS[BucketIndex]))
+    {
+        ++BucketIndex;
+    }
+    ++Stats->JitterHistogram[BucketIndex];
+
+    if (JitterMS > Stats->MaxJitterMS)
+    {
+        Stats->MaxJitterMS = JitterMS;
+    }
+    Stats->TotalJitterMS += JitterMS;
+
+    if (MissedFrame)
+    {
+        ++Stats->MissedFrameCount;
+    }
+    ++Stats->FrameCount;
+}
+
+// =====================================================================================================================
+
+inline int FormatFrameTimingStats(frame_timing_stats *Stats, char *Buffer, int BufferSize)
+{
+    //NOTE: Returns the number of characters written, truncating if the buffer runs out.
+    int Used = snprintf(Buffer, BufferSize,
+            "frame pacing @ %.02fHz: %u frames, %u missed, jitter avg %.03fms max %.03fms\n",
+            1.0f / Stats->TargetSecondsPerFrame, Stats->FrameCount, Stats->MissedFrameCount,
+            Stats->FrameCount ? (real32)(Stats->TotalJitterMS / Stats->FrameCount) : 0.0f, Stats->MaxJitterMS);
+
+    real32 BucketMinMS = 0.0f;
+    for (int BucketIndex = 0; (BucketIndex < FRAME_JITTER_BUCKET_COUNT) && (Used < BufferSize); ++BucketIndex)
+    {
+        if (BucketIndex == (FRAME_JITTER_BUCKET_COUNT - 1))
+        {
+            Used += snprintf(Buffer + Used, BufferSize - Used, "  jitter >= %6.02fms: %u\n",
+                    BucketMinMS, Stats->JitterHistogram[BucketIndex]);
+        }
+        else
+        {
+            Used += snprintf(Buffer + Used, BufferSize - Used, "  jitter <  %6.02fms: %u\n",
+                    GlobalFrameJitterBucketMaxMS[BucketIndex], Stats->JitterHistogram[BucketIndex]);
+        }
+        BucketMinMS = GlobalFrameJitterBucketMaxMS[BucketIndex];
+    }
+
+    if (Used > BufferSize)
+    {
+        Used = BufferSize;
+    }
+    return(Used);
+}
+
+#endif
@@ -0,0 +1,84 @@
+#if !defined(HANDMADE_INTRINSICS_H)
+#define HANDMADE_INTRINSICS_H
+
+//NOTE: Compiler-specific intrinsics live here so the rest of the game doesn't have to care which compiler built it.
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#include <cpuid.h>
+#endif
+
+#include <emmintrin.h>
+#include <immintrin.h>
+
+//NOTE: MSVC lets us use any instruction set from any function, GCC/Clang want the function marked for it so that the
+//  rest of the translation unit can still run on a baseline x64 machine.
+#if defined(_MSC_VER)
+#define HANDMADE_TARGET_AVX2
+#else
+#define HANDMADE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+struct cpu_features
+{
+    bool32 SSE2;
+    bool32 AVX2;
+};
+
+// =====================================================================================================================
+
+internal void CPUID(uint32 Leaf, uint32 SubLeaf, uint32 *Registers)
+{
+#if defined(_MSC_VER)
+    __cpuidex((int *)Registers, (int)Leaf, (int)SubLeaf);
+#else
+    __cpuid_count(Leaf, SubLeaf, Registers[0], Registers[1], Registers[2], Registers[3]);
+#endif
+}
+
+// =====================================================================================================================
+
+internal uint64 ReadXCR0(void)
+{
+#if defined(_MSC_VER)
+    uint64 Result = _xgetbv(0);
+#else
+    uint32 EAX, EDX;
+    __asm__ volatile("xgetbv" : "=a"(EAX), "=d"(EDX) : "c"(0));
+    uint64 Result = ((uint64)EDX << 32) | EAX;
+#endif
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal cpu_features GetCPUFeatures(void)
+{
+    cpu_features Result = {};
+
+    uint32 Registers[4] = {}; // EAX EBX ECX EDX
+    CPUID(0, 0, Registers);
+    uint32 MaxLeaf = Registers[0];
+
+    if (MaxLeaf >= 1)
+    {
+        CPUID(1, 0, Registers);
+        Result.SSE2 = (Registers[3] & (1 << 26)) != 0;
+
+        //NOTE: AVX2 is only usable if the OS saves the YMM registers on a context switch, which it tells us through
+        //  OSXSAVE and XCR0.
+        bool32 OSXSave = (Registers[2] & (1 << 27)) != 0;
+        bool32 AVX = (Registers[2] & (1 << 28)) != 0;
+        if (OSXSave && AVX && ((ReadXCR0() & 0x6) == 0x6) && (MaxLeaf >= 7))
+        {
+            CPUID(7, 0, Registers);
+            Result.AVX2 = (Registers[1] & (1 << 5)) != 0;
+        }
+    }
+
+    return(Result);
+}
+
+#endif
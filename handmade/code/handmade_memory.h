@@ -0,0 +1,187 @@
+#if !defined(HANDMADE_MEMORY_H)
+#define HANDMADE_MEMORY_H
+
+//NOTE: Linear arenas.
+//  The platform reserves all of the memory the program will ever use once at startup; everything after that is carved
+//  out of it with these. Pushes only bump a pointer, pops and temporary memory hand space back in LIFO order, and
+//  every arena remembers the most it ever had in use so we can see how much of each budget is actually needed.
+
+struct memory_arena
+{
+    //NOTE: The name is copied in, because a string literal would dangle once the game code is reloaded.
+    char Name[32];
+    memory_index Size;
+    uint8 *Base;
+    memory_index Used;
+
+    memory_index HighWaterMark;
+    int32 TempCount;
+};
+
+struct temporary_memory
+{
+    memory_arena *Arena;
+    memory_index Used;
+};
+
+#define MAX_REGISTERED_ARENAS 32
+struct memory_arena_registry
+{
+    int ArenaCount;
+    memory_arena *Arenas[MAX_REGISTERED_ARENAS];
+};
+
+// =====================================================================================================================
+
+inline void SetArenaName(memory_arena *Arena, char *Name)
+{
+    int CharIndex = 0;
+    for (; Name[CharIndex] && (CharIndex < ((int)sizeof(Arena->Name) - 1)); ++CharIndex)
+    {
+        Arena->Name[CharIndex] = Name[CharIndex];
+    }
+    Arena->Name[CharIndex] = 0;
+}
+
+// =====================================================================================================================
+
+inline void InitializeArena(memory_arena *Arena, char *Name, memory_index Size, void *Base)
+{
+    SetArenaName(Arena, Name);
+    Arena->Size = Size;
+    Arena->Base = (uint8 *)Base;
+    Arena->Used = 0;
+    Arena->HighWaterMark = 0;
+    Arena->TempCount = 0;
+}
+
+// =====================================================================================================================
+
+inline memory_index GetAlignmentOffset(memory_arena *Arena, memory_index Alignment)
+{
+    Assert((Alignment & (Alignment - 1)) == 0);
+
+    memory_index AlignmentOffset = 0;
+    memory_index ResultPointer = (memory_index)Arena->Base + Arena->Used;
+    memory_index AlignmentMask = Alignment - 1;
+    if (ResultPointer & AlignmentMask)
+    {
+        AlignmentOffset = Alignment - (ResultPointer & AlignmentMask);
+    }
+    return(AlignmentOffset);
+}
+
+// =====================================================================================================================
+
+inline memory_index GetArenaSizeRemaining(memory_arena *Arena, memory_index Alignment = 4)
+{
+    memory_index Result = Arena->Size - (Arena->Used + GetAlignmentOffset(Arena, Alignment));
+    return(Result);
+}
+
+// =====================================================================================================================
+
+#define PushStruct(Arena, type, ...) (type *)PushSize_(Arena, sizeof(type), ## __VA_ARGS__)
+#define PushArray(Arena, Count, type, ...) (type *)PushSize_(Arena, (Count)*sizeof(type), ## __VA_ARGS__)
+#define PushSize(Arena, Size, ...) PushSize_(Arena, Size, ## __VA_ARGS__)
+inline void *PushSize_(memory_arena *Arena, memory_index SizeInit, memory_index Alignment = 4)
+{
+    memory_index AlignmentOffset = GetAlignmentOffset(Arena, Alignment);
+    memory_index Size = SizeInit + AlignmentOffset;
+
+    Assert((Arena->Used + Size) <= Arena->Size);
+    void *Result = Arena->Base + Arena->Used + AlignmentOffset;
+    Arena->Used += Size;
+
+    if (Arena->Used > Arena->HighWaterMark)
+    {
+        Arena->HighWaterMark = Arena->Used;
+    }
+
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline void PopSize(memory_arena *Arena, memory_index Size)
+{
+    //NOTE: Only the most recent push can be popped, and alignment padding stays behind.
+    Assert(Size <= Arena->Used);
+    Arena->Used -= Size;
+}
+
+// =====================================================================================================================
+
+inline temporary_memory BeginTemporaryMemory(memory_arena *Arena)
+{
+    temporary_memory Result;
+    Result.Arena = Arena;
+    Result.Used = Arena->Used;
+    ++Arena->TempCount;
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline void EndTemporaryMemory(temporary_memory TempMem)
+{
+    memory_arena *Arena = TempMem.Arena;
+    Assert(Arena->Used >= TempMem.Used);
+    Arena->Used = TempMem.Used;
+    Assert(Arena->TempCount > 0);
+    --Arena->TempCount;
+}
+
+// =====================================================================================================================
+
+inline void CheckArena(memory_arena *Arena)
+{
+    //NOTE: Call at the end of a frame; a leftover temporary scope means something forgot to end one.
+    Assert(Arena->TempCount == 0);
+}
+
+// =====================================================================================================================
+
+inline void SubArena(memory_arena *Result, memory_arena *Arena, char *Name, memory_index Size,
+        memory_index Alignment = 16)
+{
+    SetArenaName(Result, Name);
+    Result->Size = Size;
+    Result->Base = (uint8 *)PushSize_(Arena, Size, Alignment);
+    Result->Used = 0;
+    Result->HighWaterMark = 0;
+    Result->TempCount = 0;
+}
+
+// =====================================================================================================================
+
+#define ZeroStruct(Instance) ZeroSize(sizeof(Instance), &(Instance))
+inline void ZeroSize(memory_index Size, void *Ptr)
+{
+    uint8 *Byte = (uint8 *)Ptr;
+    while (Size--)
+    {
+        *Byte++ = 0;
+    }
+}
+
+// =====================================================================================================================
+
+inline void RegisterArena(memory_arena_registry *Registry, memory_arena *Arena)
+{
+    for (int ArenaIndex = 0; ArenaIndex < Registry->ArenaCount; ++ArenaIndex)
+    {
+        if (Registry->Arenas[ArenaIndex] == Arena)
+        {
+            return;
+        }
+    }
+
+    Assert(Registry->ArenaCount < MAX_REGISTERED_ARENAS);
+    if (Registry->ArenaCount < MAX_REGISTERED_ARENAS)
+    {
+        Registry->Arenas[Registry->ArenaCount++] = Arena;
+    }
+}
+
+#endif
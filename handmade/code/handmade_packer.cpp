@@ -0,0 +1,582 @@
+#include "handmade_platform.h"
+#include "handmade_file_formats.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+//NOTE: Offline asset packer. Reads .bmp and .wav files, converts them to the layout the engine draws and mixes from,
+//  and writes them all into one .hma file (see handmade_file_formats.h) that the game maps at startup.
+//
+//      handmade_packer Output.hma Source.bmp Source.wav ...
+//
+//  Every asset is named after its source file, without the directory or the extension. This is a build tool, not part
+//  of the game, so it does its allocation with malloc and its file IO with stdio.
+
+#pragma pack(push, 1)
+struct bitmap_header
+{
+    uint16 FileType;
+    uint32 FileSize;
+    uint16 Reserved1;
+    uint16 Reserved2;
+    uint32 BitmapOffset;
+
+    uint32 Size;
+    int32 Width;
+    int32 Height;
+    uint16 Planes;
+    uint16 BitsPerPixel;
+    uint32 Compression;
+    uint32 SizeOfBitmap;
+    int32 HorzResolution;
+    int32 VertResolution;
+    uint32 ColorsUsed;
+    uint32 ColorsImportant;
+};
+
+struct bitmap_masks
+{
+    //NOTE: Right after the info header when the compression is BI_BITFIELDS. Alpha is only there in the later
+    //  versions of the header.
+    uint32 RedMask;
+    uint32 GreenMask;
+    uint32 BlueMask;
+    uint32 AlphaMask;
+};
+
+struct wave_header
+{
+    uint32 RIFFID;
+    uint32 Size;
+    uint32 WAVEID;
+};
+
+struct wave_chunk
+{
+    uint32 ID;
+    uint32 Size;
+};
+
+struct wave_fmt
+{
+    uint16 wFormatTag;
+    uint16 nChannels;
+    uint32 nSamplesPerSec;
+    uint32 nAvgBytesPerSec;
+    uint16 nBlockAlign;
+    uint16 wBitsPerSample;
+};
+#pragma pack(pop)
+
+#define BITMAP_FILE_TYPE 0x4D42
+#define BITMAP_COMPRESSION_RGB 0
+#define BITMAP_COMPRESSION_BITFIELDS 3
+#define BITMAP_COMPRESSION_ALPHABITFIELDS 6
+
+#define RIFF_CODE(a, b, c, d) (((uint32)(a) << 0) | ((uint32)(b) << 8) | ((uint32)(c) << 16) | ((uint32)(d) << 24))
+#define WAVE_FORMAT_PCM 1
+
+struct entire_file
+{
+    uint64 ContentsSize;
+    uint8 *Contents;
+};
+
+struct packer_bitmap
+{
+    //NOTE: Already in .hma form: top-down, BB GG RR AA, premultiplied.
+    uint32 Width;
+    uint32 Height;
+    uint32 *Pixels;
+};
+
+struct packer_sound
+{
+    //NOTE: Already in .hma form: all of channel 0, then all of channel 1.
+    uint32 SampleCount;
+    uint32 ChannelCount;
+    uint32 SamplesPerSecond;
+    int16 *Samples;
+};
+
+// =====================================================================================================================
+
+internal entire_file ReadEntireFile(char *FileName)
+{
+    entire_file Result = {};
+    FILE *File = fopen(FileName, "rb");
+    if (File)
+    {
+        fseek(File, 0, SEEK_END);
+        long FileSize = ftell(File);
+        fseek(File, 0, SEEK_SET);
+
+        if (FileSize > 0)
+        {
+            Result.Contents = (uint8 *)malloc((size_t)FileSize);
+            if (Result.Contents && (fread(Result.Contents, 1, (size_t)FileSize, File) == (size_t)FileSize))
+            {
+                Result.ContentsSize = (uint64)FileSize;
+            }
+            else
+            {
+                free(Result.Contents);
+                Result.Contents = 0;
+            }
+        }
+        fclose(File);
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void FreeEntireFile(entire_file *File)
+{
+    free(File->Contents);
+    File->Contents = 0;
+    File->ContentsSize = 0;
+}
+
+// =====================================================================================================================
+
+internal bool32 GetByteMaskShift(uint32 Mask, uint32 *Shift)
+{
+    //NOTE: Only masks that pick out one whole byte are supported, which is every 32-bit bitmap anything writes.
+    bool32 Result = false;
+    for (uint32 Bit = 0; Bit <= 24; Bit += 8)
+    {
+        if (Mask == (0xFFu << Bit))
+        {
+            *Shift = Bit;
+            Result = true;
+            break;
+        }
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline uint32 PremultiplyChannel(uint32 Channel, uint32 Alpha)
+{
+    uint32 Result = (Channel * Alpha + 127) / 255;
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 LoadBMP(entire_file *File, packer_bitmap *Bitmap, char *FileName)
+{
+    //NOTE: Uncompressed 24-bit, and 32-bit either plain (the fourth byte is unused, so the image is opaque) or with
+    //  bitfield masks (where an alpha mask, if there is one, gives real alpha). Bottom-up and top-down both work.
+    *Bitmap = {};
+
+    bitmap_header *Header = (bitmap_header *)File->Contents;
+    if ((File->ContentsSize < sizeof(bitmap_header)) || (Header->FileType != BITMAP_FILE_TYPE) ||
+            (Header->Size < 40) || (Header->Planes != 1))
+    {
+        fprintf(stderr, "%s: not a bitmap\n", FileName);
+        return(false);
+    }
+
+    int32 Height = (Header->Height < 0) ? -Header->Height : Header->Height;
+    if ((Header->Width <= 0) || (Header->Width > 0x7FFF) || (Height <= 0) || (Height > 0x7FFF))
+    {
+        fprintf(stderr, "%s: %dx%d is not a size we can pack\n", FileName, Header->Width, Header->Height);
+        return(false);
+    }
+    bool32 TopDown = (Header->Height < 0);
+
+    uint32 RedShift = 16;
+    uint32 GreenShift = 8;
+    uint32 BlueShift = 0;
+    uint32 AlphaShift = 24;
+    bool32 HasAlpha = false;
+    uint32 BytesPerPixel = 0;
+    if ((Header->BitsPerPixel == 24) && (Header->Compression == BITMAP_COMPRESSION_RGB))
+    {
+        BytesPerPixel = 3;
+    }
+    else if ((Header->BitsPerPixel == 32) && (Header->Compression == BITMAP_COMPRESSION_RGB))
+    {
+        BytesPerPixel = 4;
+    }
+    else if ((Header->BitsPerPixel == 32) && ((Header->Compression == BITMAP_COMPRESSION_BITFIELDS) ||
+            (Header->Compression == BITMAP_COMPRESSION_ALPHABITFIELDS)))
+    {
+        BytesPerPixel = 4;
+
+        uint64 MasksOffset = 14 + 40;
+        if (File->ContentsSize < (MasksOffset + sizeof(bitmap_masks)))
+        {
+            fprintf(stderr, "%s: bitfield masks are cut off\n", FileName);
+            return(false);
+        }
+        bitmap_masks *Masks = (bitmap_masks *)(File->Contents + MasksOffset);
+        HasAlpha = ((Header->Size >= 56) || (Header->Compression == BITMAP_COMPRESSION_ALPHABITFIELDS)) &&
+                (Masks->AlphaMask != 0);
+        if (!GetByteMaskShift(Masks->RedMask, &RedShift) || !GetByteMaskShift(Masks->GreenMask, &GreenShift) ||
+                !GetByteMaskShift(Masks->BlueMask, &BlueShift) ||
+                (HasAlpha && !GetByteMaskShift(Masks->AlphaMask, &AlphaShift)))
+        {
+            fprintf(stderr, "%s: unsupported bitfield masks\n", FileName);
+            return(false);
+        }
+    }
+    else
+    {
+        fprintf(stderr, "%s: %d-bit bitmaps with compression %u aren't supported\n", FileName,
+                Header->BitsPerPixel, Header->Compression);
+        return(false);
+    }
+
+    //NOTE: Rows in the file are padded out to 4 bytes.
+    uint32 Width = (uint32)Header->Width;
+    uint64 SourcePitch = ((uint64)Width * BytesPerPixel + 3) & ~(uint64)3;
+    if ((Header->BitmapOffset > File->ContentsSize) ||
+            ((File->ContentsSize - Header->BitmapOffset) < (SourcePitch * (uint64)Height)))
+    {
+        fprintf(stderr, "%s: pixel data is cut off\n", FileName);
+        return(false);
+    }
+
+    Bitmap->Width = Width;
+    Bitmap->Height = (uint32)Height;
+    Bitmap->Pixels = (uint32 *)malloc((size_t)Width * (size_t)Height * sizeof(uint32));
+    if (!Bitmap->Pixels)
+    {
+        fprintf(stderr, "%s: out of memory\n", FileName);
+        return(false);
+    }
+
+    uint32 *DestPixel = Bitmap->Pixels;
+    for (int32 Y = 0; Y < Height; ++Y)
+    {
+        int32 SourceY = TopDown ? Y : (Height - 1 - Y);
+        uint8 *SourceRow = File->Contents + Header->BitmapOffset + (uint64)SourceY * SourcePitch;
+        for (uint32 X = 0; X < Width; ++X)
+        {
+            uint8 *Source = SourceRow + X * BytesPerPixel;
+            uint32 Red, Green, Blue;
+            uint32 Alpha = 255;
+            if (BytesPerPixel == 3)
+            {
+                Blue = Source[0];
+                Green = Source[1];
+                Red = Source[2];
+            }
+            else
+            {
+                uint32 SourceValue = ((uint32)Source[0] << 0) | ((uint32)Source[1] << 8) |
+                        ((uint32)Source[2] << 16) | ((uint32)Source[3] << 24);
+                Red = (SourceValue >> RedShift) & 0xFF;
+                Green = (SourceValue >> GreenShift) & 0xFF;
+                Blue = (SourceValue >> BlueShift) & 0xFF;
+                if (HasAlpha)
+                {
+                    Alpha = (SourceValue >> AlphaShift) & 0xFF;
+                }
+            }
+
+            Red = PremultiplyChannel(Red, Alpha);
+            Green = PremultiplyChannel(Green, Alpha);
+            Blue = PremultiplyChannel(Blue, Alpha);
+            *DestPixel++ = (Alpha << 24) | (Red << 16) | (Green << 8) | (Blue << 0);
+        }
+    }
+
+    return(true);
+}
+
+// =====================================================================================================================
+
+internal bool32 LoadWAV(entire_file *File, packer_sound *Sound, char *FileName)
+{
+    //NOTE: 16-bit PCM, mono or stereo. Chunks we don't care about are skipped.
+    *Sound = {};
+
+    wave_header *Header = (wave_header *)File->Contents;
+    if ((File->ContentsSize < sizeof(wave_header)) || (Header->RIFFID != RIFF_CODE('R', 'I', 'F', 'F')) ||
+            (Header->WAVEID != RIFF_CODE('W', 'A', 'V', 'E')))
+    {
+        fprintf(stderr, "%s: not a wave file\n", FileName);
+        return(false);
+    }
+
+    wave_fmt *Format = 0;
+    int16 *Interleaved = 0;
+    uint32 DataSize = 0;
+    uint64 ChunkOffset = sizeof(wave_header);
+    while ((ChunkOffset + sizeof(wave_chunk)) <= File->ContentsSize)
+    {
+        wave_chunk *Chunk = (wave_chunk *)(File->Contents + ChunkOffset);
+        uint64 ChunkDataOffset = ChunkOffset + sizeof(wave_chunk);
+        if (Chunk->Size > (File->ContentsSize - ChunkDataOffset))
+        {
+            fprintf(stderr, "%s: chunk is cut off\n", FileName);
+            return(false);
+        }
+
+        if ((Chunk->ID == RIFF_CODE('f', 'm', 't', ' ')) && (Chunk->Size >= sizeof(wave_fmt)))
+        {
+            Format = (wave_fmt *)(File->Contents + ChunkDataOffset);
+        }
+        else if (Chunk->ID == RIFF_CODE('d', 'a', 't', 'a'))
+        {
+            Interleaved = (int16 *)(File->Contents + ChunkDataOffset);
+            DataSize = Chunk->Size;
+        }
+
+        //NOTE: Chunks are padded to an even size.
+        ChunkOffset = ChunkDataOffset + (((uint64)Chunk->Size + 1) & ~(uint64)1);
+    }
+
+    if (!Format || !Interleaved)
+    {
+        fprintf(stderr, "%s: missing its fmt or data chunk\n", FileName);
+        return(false);
+    }
+    if ((Format->wFormatTag != WAVE_FORMAT_PCM) || (Format->wBitsPerSample != 16) ||
+            (Format->nChannels < 1) || (Format->nChannels > 2))
+    {
+        fprintf(stderr, "%s: only 16-bit PCM, mono or stereo is supported\n", FileName);
+        return(false);
+    }
+
+    Sound->ChannelCount = Format->nChannels;
+    Sound->SamplesPerSecond = Format->nSamplesPerSec;
+    Sound->SampleCount = DataSize / (Sound->ChannelCount * sizeof(int16));
+    Sound->Samples = (int16 *)malloc(((size_t)Sound->SampleCount * Sound->ChannelCount + 1) * sizeof(int16));
+    if (!Sound->Samples)
+    {
+        fprintf(stderr, "%s: out of memory\n", FileName);
+        return(false);
+    }
+
+    for (uint32 ChannelIndex = 0; ChannelIndex < Sound->ChannelCount; ++ChannelIndex)
+    {
+        int16 *Dest = Sound->Samples + (uint64)ChannelIndex * Sound->SampleCount;
+        int16 *Source = Interleaved + ChannelIndex;
+        for (uint32 SampleIndex = 0; SampleIndex < Sound->SampleCount; ++SampleIndex)
+        {
+            //NOTE: The data chunk is only 2-byte aligned, so don't read it as int16 directly.
+            memcpy(Dest + SampleIndex, Source, sizeof(int16));
+            Source += Sound->ChannelCount;
+        }
+    }
+
+    return(true);
+}
+
+// =====================================================================================================================
+
+internal bool32 HasExtension(char *FileName, char *Extension)
+{
+    //NOTE: Case-insensitive, since the art tools on Windows aren't consistent about it.
+    size_t FileNameLength = strlen(FileName);
+    size_t ExtensionLength = strlen(Extension);
+    bool32 Result = (FileNameLength > ExtensionLength);
+    for (size_t CharIndex = 0; Result && (CharIndex < ExtensionLength); ++CharIndex)
+    {
+        char A = FileName[FileNameLength - ExtensionLength + CharIndex];
+        char B = Extension[CharIndex];
+        if ((A >= 'A') && (A <= 'Z'))
+        {
+            A += 'a' - 'A';
+        }
+        Result = (A == B);
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 GetAssetName(char *FileName, char *Name)
+{
+    //NOTE: The base name with the extension taken off. Fails if it doesn't fit in HMA_NAME_COUNT with its terminator.
+    char *BaseName = FileName;
+    for (char *Scan = FileName; *Scan; ++Scan)
+    {
+        if ((*Scan == '/') || (*Scan == '\\'))
+        {
+            BaseName = Scan + 1;
+        }
+    }
+
+    char *Extension = 0;
+    for (char *Scan = BaseName; *Scan; ++Scan)
+    {
+        if (*Scan == '.')
+        {
+            Extension = Scan;
+        }
+    }
+    if (!Extension)
+    {
+        Extension = BaseName + strlen(BaseName);
+    }
+
+    size_t NameLength = (size_t)(Extension - BaseName);
+    bool32 Result = ((NameLength > 0) && (NameLength < HMA_NAME_COUNT));
+    if (Result)
+    {
+        memset(Name, 0, HMA_NAME_COUNT);
+        memcpy(Name, BaseName, NameLength);
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 PackAssets(char *OutputFileName, int SourceCount, char **SourceFileNames)
+{
+    //NOTE: The header and the asset table go in first as placeholders so the data can be streamed out behind them
+    //  one source at a time, then they are rewritten once every offset is known.
+    hma_asset *Assets = (hma_asset *)calloc((size_t)(SourceCount > 0 ? SourceCount : 1), sizeof(hma_asset));
+    FILE *Output = fopen(OutputFileName, "wb");
+    if (!Assets || !Output)
+    {
+        fprintf(stderr, "%s: couldn't open for writing\n", OutputFileName);
+        free(Assets);
+        if (Output)
+        {
+            fclose(Output);
+        }
+        return(false);
+    }
+
+    hma_header Header = {};
+    Header.MagicValue = HMA_MAGIC_VALUE;
+    Header.Version = HMA_VERSION;
+    Header.AssetCount = (uint32)SourceCount;
+    Header.Assets = sizeof(hma_header);
+
+    bool32 Result = ((fwrite(&Header, sizeof(Header), 1, Output) == 1) &&
+            (fwrite(Assets, sizeof(hma_asset), (size_t)SourceCount, Output) == (size_t)SourceCount));
+    uint64 Offset = sizeof(hma_header) + (uint64)SourceCount * sizeof(hma_asset);
+
+    for (int SourceIndex = 0; Result && (SourceIndex < SourceCount); ++SourceIndex)
+    {
+        char *FileName = SourceFileNames[SourceIndex];
+        hma_asset *Asset = Assets + SourceIndex;
+
+        if (!GetAssetName(FileName, Asset->Name))
+        {
+            fprintf(stderr, "%s: the name must be 1 to %d characters\n", FileName, HMA_NAME_COUNT - 1);
+            Result = false;
+            break;
+        }
+        Asset->NameHash = HashAssetName(Asset->Name);
+        for (int OtherIndex = 0; OtherIndex < SourceIndex; ++OtherIndex)
+        {
+            if ((Assets[OtherIndex].NameHash == Asset->NameHash) && (strcmp(Assets[OtherIndex].Name, Asset->Name) == 0))
+            {
+                fprintf(stderr, "%s: another source is already named \"%s\"\n", FileName, Asset->Name);
+                Result = false;
+            }
+        }
+        if (!Result)
+        {
+            break;
+        }
+
+        entire_file File = ReadEntireFile(FileName);
+        if (!File.Contents)
+        {
+            fprintf(stderr, "%s: couldn't read\n", FileName);
+            Result = false;
+            break;
+        }
+
+        void *Data = 0;
+        if (HasExtension(FileName, (char *)".bmp"))
+        {
+            packer_bitmap Bitmap;
+            Result = LoadBMP(&File, &Bitmap, FileName);
+            Asset->Type = HMAAsset_Bitmap;
+            Asset->Bitmap.Width = Bitmap.Width;
+            Asset->Bitmap.Height = Bitmap.Height;
+            Asset->DataSize = (uint64)Bitmap.Width * Bitmap.Height * sizeof(uint32);
+            Data = Bitmap.Pixels;
+        }
+        else if (HasExtension(FileName, (char *)".wav"))
+        {
+            packer_sound Sound;
+            Result = LoadWAV(&File, &Sound, FileName);
+            Asset->Type = HMAAsset_Sound;
+            Asset->Sound.SampleCount = Sound.SampleCount;
+            Asset->Sound.ChannelCount = Sound.ChannelCount;
+            Asset->Sound.SamplesPerSecond = Sound.SamplesPerSecond;
+            Asset->DataSize = (uint64)Sound.SampleCount * Sound.ChannelCount * sizeof(int16);
+            Data = Sound.Samples;
+        }
+        else
+        {
+            fprintf(stderr, "%s: only .bmp and .wav files can be packed\n", FileName);
+            Result = false;
+        }
+        FreeEntireFile(&File);
+
+        if (Result)
+        {
+            local_persist uint8 Padding[HMA_DATA_ALIGNMENT];
+            uint64 PaddingSize = (HMA_DATA_ALIGNMENT - (Offset % HMA_DATA_ALIGNMENT)) % HMA_DATA_ALIGNMENT;
+            Asset->DataOffset = Offset + PaddingSize;
+            Result = ((fwrite(Padding, 1, (size_t)PaddingSize, Output) == (size_t)PaddingSize) &&
+                    (fwrite(Data, 1, (size_t)Asset->DataSize, Output) == (size_t)Asset->DataSize));
+            Offset = Asset->DataOffset + Asset->DataSize;
+            if (!Result)
+            {
+                fprintf(stderr, "%s: write failed\n", OutputFileName);
+            }
+        }
+        free(Data);
+    }
+
+    if (Result)
+    {
+        Header.FileSize = Offset;
+        Result = ((fseek(Output, 0, SEEK_SET) == 0) &&
+                (fwrite(&Header, sizeof(Header), 1, Output) == 1) &&
+                (fwrite(Assets, sizeof(hma_asset), (size_t)SourceCount, Output) == (size_t)SourceCount));
+        if (!Result)
+        {
+            fprintf(stderr, "%s: write failed\n", OutputFileName);
+        }
+    }
+
+    if (fclose(Output) != 0)
+    {
+        Result = false;
+    }
+    if (!Result)
+    {
+        remove(OutputFileName);
+    }
+    free(Assets);
+
+    return(Result);
+}
+
+// =====================================================================================================================
+
+#if !defined(HANDMADE_PACKER_NO_MAIN)
+int main(int ArgCount, char **Args)
+{
+    if (ArgCount < 3)
+    {
+        fprintf(stderr, "Usage: %s Output.hma Source.bmp|Source.wav ...\n", Args[0]);
+        return(1);
+    }
+
+    int SourceCount = ArgCount - 2;
+    if (!PackAssets(Args[1], SourceCount, Args + 2))
+    {
+        return(1);
+    }
+
+    printf("%s: packed %d assets\n", Args[1], SourceCount);
+    return(0);
+}
+#endif
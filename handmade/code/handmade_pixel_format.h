@@ -0,0 +1,514 @@
+#if !defined(HANDMADE_PIXEL_FORMAT_H)
+#define HANDMADE_PIXEL_FORMAT_H
+
+//NOTE: Output pixel formats for the platform layer.
+//  The game only ever draws 32-bit BB GG RR xx: every render kernel, the present scalers and the asset format are
+//  built around it. What leaves the engine doesn't have to be that wide, though. A capture or a small 16-bit window is
+//  just as useful at half or a quarter of the bandwidth, so a finished picture can be converted into any of these:
+//
+//  BGRX32:   BB GG RR xx, the backbuffer's own layout. Converting is a copy.
+//  RGB565:   5 bits of red on top, then 6 of green and 5 of blue, in a uint16. Channels are rounded, not truncated.
+//  Indexed8: one byte into a fixed 3-3-2 palette, red in the top 3 bits, then green, then blue in the bottom 2. Being
+//            fixed, no palette has to be built or searched per frame; GetIndexed8Palette gives the color of each index.
+//
+//  A buffer's format is told apart by its BytesPerPixel alone, since every format has a different size.
+//
+//  The fills and blits are templates on the format and on the row layout: packed rows (Pitch is exactly Width pixels,
+//  so a rectangle spanning the width is one run) or pitched rows. Every instantiation has its pixel size, stride and
+//  conversion baked in, so its inner loop has no format branches and does 8 pixels per step with SSE2. The generic
+//  versions look the format up from BytesPerPixel for every pixel and read the pitch back for every row, the way this
+//  used to be done; they are only kept to check and measure the specialized ones against.
+
+enum pixel_format
+{
+    PixelFormat_BGRX32,
+    PixelFormat_RGB565,
+    PixelFormat_Indexed8,
+
+    PixelFormat_Count,
+};
+
+enum buffer_layout
+{
+    BufferLayout_Pitched,
+    BufferLayout_Packed,
+
+    BufferLayout_Count,
+};
+
+// =====================================================================================================================
+
+inline uint32 ReduceChannel(uint32 Value, uint32 MaxValue)
+{
+    //NOTE: Round(Value * MaxValue / 255) for both in 0-255, without the divide.
+    uint32 T = Value * MaxValue + 128;
+    uint32 Result = (T + (T >> 8)) >> 8;
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline uint32 ExpandChannel(uint32 Value, uint32 MaxValue)
+{
+    //NOTE: Round(Value * 255 / MaxValue), so that reducing an expanded channel gives the same value back.
+    uint32 Result = (Value * 255 + MaxValue / 2) / MaxValue;
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline __m128i ReduceChannel4x(__m128i Value, uint32 MaxValue)
+{
+    //NOTE: ReduceChannel on 4 lanes. The channel and its product fit in the low 16 bits of each lane, and the high 16
+    //  bits of both factors are 0, so a 16-bit multiply gives the same product as a 32-bit one.
+    __m128i T = _mm_add_epi32(_mm_mullo_epi16(Value, _mm_set1_epi32((int)MaxValue)), _mm_set1_epi32(128));
+    __m128i Result = _mm_srli_epi32(_mm_add_epi32(T, _mm_srli_epi32(T, 8)), 8);
+    return(Result);
+}
+
+// =====================================================================================================================
+//NOTE: One struct per format, with its pixel type and its conversions to and from BB GG RR xx. Unpacking leaves the
+//  xx byte 0. Pack8 packs 8 pixels with SSE2 and has to match Pack bit for bit; Stream8 is the same with non-temporal
+//  stores, which need Dest 16-byte aligned. Splat fills a register with a pixel.
+
+struct pixel_format_bgrx32
+{
+    typedef uint32 pixel;
+
+    static inline pixel Pack(uint32 Color)
+    {
+        return(Color);
+    }
+
+    static inline uint32 Unpack(pixel Pixel)
+    {
+        return(Pixel & 0x00FFFFFF);
+    }
+
+    static inline void Pack8(uint32 *Source, pixel *Dest)
+    {
+        _mm_storeu_si128((__m128i *)Dest, _mm_loadu_si128((__m128i *)Source));
+        _mm_storeu_si128((__m128i *)(Dest + 4), _mm_loadu_si128((__m128i *)(Source + 4)));
+    }
+
+    static inline void Stream8(uint32 *Source, pixel *Dest)
+    {
+        _mm_stream_si128((__m128i *)Dest, _mm_loadu_si128((__m128i *)Source));
+        _mm_stream_si128((__m128i *)(Dest + 4), _mm_loadu_si128((__m128i *)(Source + 4)));
+    }
+
+    static inline __m128i Splat(pixel Pixel)
+    {
+        return(_mm_set1_epi32((int)Pixel));
+    }
+};
+
+struct pixel_format_rgb565
+{
+    typedef uint16 pixel;
+
+    static inline pixel Pack(uint32 Color)
+    {
+        uint32 R = ReduceChannel((Color >> 16) & 0xFF, 31);
+        uint32 G = ReduceChannel((Color >> 8) & 0xFF, 63);
+        uint32 B = ReduceChannel(Color & 0xFF, 31);
+        return((pixel)((R << 11) | (G << 5) | B));
+    }
+
+    static inline uint32 Unpack(pixel Pixel)
+    {
+        uint32 R = ExpandChannel((Pixel >> 11) & 0x1F, 31);
+        uint32 G = ExpandChannel((Pixel >> 5) & 0x3F, 63);
+        uint32 B = ExpandChannel(Pixel & 0x1F, 31);
+        return((R << 16) | (G << 8) | B);
+    }
+
+    static inline __m128i Pack4(__m128i Color)
+    {
+        //NOTE: Sign-extended from 16 bits, so the saturating pack down to 16 bits leaves it alone.
+        __m128i ByteMask = _mm_set1_epi32(0xFF);
+        __m128i R = ReduceChannel4x(_mm_and_si128(_mm_srli_epi32(Color, 16), ByteMask), 31);
+        __m128i G = ReduceChannel4x(_mm_and_si128(_mm_srli_epi32(Color, 8), ByteMask), 63);
+        __m128i B = ReduceChannel4x(_mm_and_si128(Color, ByteMask), 31);
+        __m128i Result = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(R, 11), _mm_slli_epi32(G, 5)), B);
+        Result = _mm_srai_epi32(_mm_slli_epi32(Result, 16), 16);
+        return(Result);
+    }
+
+    static inline void Pack8(uint32 *Source, pixel *Dest)
+    {
+        __m128i Pixels0 = Pack4(_mm_loadu_si128((__m128i *)Source));
+        __m128i Pixels1 = Pack4(_mm_loadu_si128((__m128i *)(Source + 4)));
+        _mm_storeu_si128((__m128i *)Dest, _mm_packs_epi32(Pixels0, Pixels1));
+    }
+
+    static inline void Stream8(uint32 *Source, pixel *Dest)
+    {
+        __m128i Pixels0 = Pack4(_mm_loadu_si128((__m128i *)Source));
+        __m128i Pixels1 = Pack4(_mm_loadu_si128((__m128i *)(Source + 4)));
+        _mm_stream_si128((__m128i *)Dest, _mm_packs_epi32(Pixels0, Pixels1));
+    }
+
+    static inline __m128i Splat(pixel Pixel)
+    {
+        return(_mm_set1_epi16((short)Pixel));
+    }
+};
+
+struct pixel_format_indexed8
+{
+    typedef uint8 pixel;
+
+    static inline pixel Pack(uint32 Color)
+    {
+        uint32 R = ReduceChannel((Color >> 16) & 0xFF, 7);
+        uint32 G = ReduceChannel((Color >> 8) & 0xFF, 7);
+        uint32 B = ReduceChannel(Color & 0xFF, 3);
+        return((pixel)((R << 5) | (G << 2) | B));
+    }
+
+    static inline uint32 Unpack(pixel Pixel)
+    {
+        uint32 R = ExpandChannel((Pixel >> 5) & 0x7, 7);
+        uint32 G = ExpandChannel((Pixel >> 2) & 0x7, 7);
+        uint32 B = ExpandChannel(Pixel & 0x3, 3);
+        return((R << 16) | (G << 8) | B);
+    }
+
+    static inline __m128i Pack4(__m128i Color)
+    {
+        __m128i ByteMask = _mm_set1_epi32(0xFF);
+        __m128i R = ReduceChannel4x(_mm_and_si128(_mm_srli_epi32(Color, 16), ByteMask), 7);
+        __m128i G = ReduceChannel4x(_mm_and_si128(_mm_srli_epi32(Color, 8), ByteMask), 7);
+        __m128i B = ReduceChannel4x(_mm_and_si128(Color, ByteMask), 3);
+        __m128i Result = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(R, 5), _mm_slli_epi32(G, 2)), B);
+        return(Result);
+    }
+
+    static inline void Pack8(uint32 *Source, pixel *Dest)
+    {
+        __m128i Pixels0 = Pack4(_mm_loadu_si128((__m128i *)Source));
+        __m128i Pixels1 = Pack4(_mm_loadu_si128((__m128i *)(Source + 4)));
+        __m128i Words = _mm_packs_epi32(Pixels0, Pixels1);
+        _mm_storel_epi64((__m128i *)Dest, _mm_packus_epi16(Words, Words));
+    }
+
+    static inline void Stream8(uint32 *Source, pixel *Dest)
+    {
+        __m128i Pixels0 = Pack4(_mm_loadu_si128((__m128i *)Source));
+        __m128i Pixels1 = Pack4(_mm_loadu_si128((__m128i *)(Source + 4)));
+        __m128i Words = _mm_packs_epi32(Pixels0, Pixels1);
+        _mm_stream_si64((long long *)Dest, _mm_cvtsi128_si64(_mm_packus_epi16(Words, Words)));
+    }
+
+    static inline __m128i Splat(pixel Pixel)
+    {
+        return(_mm_set1_epi8((char)Pixel));
+    }
+};
+
+// =====================================================================================================================
+
+inline int GetPixelFormatBytesPerPixel(pixel_format Format)
+{
+    int Result = 4;
+    if (Format == PixelFormat_RGB565)
+    {
+        Result = 2;
+    }
+    else if (Format == PixelFormat_Indexed8)
+    {
+        Result = 1;
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline pixel_format GetBufferPixelFormat(game_offscreen_buffer *Buffer)
+{
+    pixel_format Result = PixelFormat_BGRX32;
+    if (Buffer->BytesPerPixel == 2)
+    {
+        Result = PixelFormat_RGB565;
+    }
+    else if (Buffer->BytesPerPixel == 1)
+    {
+        Result = PixelFormat_Indexed8;
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline buffer_layout GetBufferLayout(game_offscreen_buffer *Buffer)
+{
+    buffer_layout Result = BufferLayout_Pitched;
+    if (Buffer->Pitch == (Buffer->Width * Buffer->BytesPerPixel))
+    {
+        Result = BufferLayout_Packed;
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal char *GetPixelFormatName(pixel_format Format)
+{
+    char *Result = (char *)"bgrx32";
+    if (Format == PixelFormat_RGB565)
+    {
+        Result = (char *)"rgb565";
+    }
+    else if (Format == PixelFormat_Indexed8)
+    {
+        Result = (char *)"indexed8";
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 ParsePixelFormat(char *Name, pixel_format *Format)
+{
+    bool32 Result = false;
+    for (int FormatIndex = 0; FormatIndex < PixelFormat_Count; ++FormatIndex)
+    {
+        if (strcmp(Name, GetPixelFormatName((pixel_format)FormatIndex)) == 0)
+        {
+            *Format = (pixel_format)FormatIndex;
+            Result = true;
+        }
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void GetIndexed8Palette(uint32 *Palette)
+{
+    //NOTE: Palette has room for 256 colors.
+    for (uint32 Index = 0; Index < 256; ++Index)
+    {
+        Palette[Index] = pixel_format_indexed8::Unpack((uint8)Index);
+    }
+}
+
+// =====================================================================================================================
+//NOTE: Rectangles are half-open and already clipped, like the render kernels'. Converting reads a BGRX32 source and
+//  writes the same rectangle of a destination of the same size. StreamPixels converts just the same, but writes
+//  around the cache, for a destination nothing will read again soon, like a capture's; its stores are only ordered
+//  with other threads' reads after a fence.
+
+#define FILL_PIXELS_KERNEL(name) void name(game_offscreen_buffer *Buffer, int MinX, int MinY, int MaxX, int MaxY, \
+        uint32 Color)
+typedef FILL_PIXELS_KERNEL(fill_pixels_kernel);
+
+#define CONVERT_PIXELS_KERNEL(name) void name(game_offscreen_buffer *Source, game_offscreen_buffer *Dest, \
+        int MinX, int MinY, int MaxX, int MaxY)
+typedef CONVERT_PIXELS_KERNEL(convert_pixels_kernel);
+
+struct pixel_kernels
+{
+    pixel_format Format;
+    buffer_layout Layout;
+    fill_pixels_kernel *FillPixels;
+    convert_pixels_kernel *ConvertPixels;
+    convert_pixels_kernel *StreamPixels;
+};
+
+template <typename format> inline void FillPixelRow(typename format::pixel *Dest, int Count,
+        typename format::pixel Value)
+{
+    //NOTE: A whole register of pixels per store, however many that is for the format.
+    const int PerStore = 16 / (int)sizeof(typename format::pixel);
+    __m128i Value16x = format::Splat(Value);
+    int Index = 0;
+    for (; (Index + 2 * PerStore) <= Count; Index += 2 * PerStore)
+    {
+        _mm_storeu_si128((__m128i *)(Dest + Index), Value16x);
+        _mm_storeu_si128((__m128i *)(Dest + Index + PerStore), Value16x);
+    }
+    for (; Index < Count; ++Index)
+    {
+        Dest[Index] = Value;
+    }
+}
+
+template <typename format, bool32 Streaming> inline void ConvertPixelRow(uint32 *Source,
+        typename format::pixel *Dest, int Count)
+{
+    int Index = 0;
+    if (Streaming)
+    {
+        //NOTE: Pixels are whole divisors of 16 bytes, so a few plain stores reach an aligned one and every step of 8
+        //  after that stays aligned.
+        for (; (Index < Count) && ((memory_index)(Dest + Index) & 15); ++Index)
+        {
+            Dest[Index] = format::Pack(Source[Index]);
+        }
+        for (; (Index + 8) <= Count; Index += 8)
+        {
+            format::Stream8(Source + Index, Dest + Index);
+        }
+    }
+    for (; (Index + 8) <= Count; Index += 8)
+    {
+        format::Pack8(Source + Index, Dest + Index);
+    }
+    for (; Index < Count; ++Index)
+    {
+        Dest[Index] = format::Pack(Source[Index]);
+    }
+}
+
+template <typename format, buffer_layout Layout> internal FILL_PIXELS_KERNEL(FillPixels)
+{
+    typedef typename format::pixel pixel;
+    Assert(Buffer->BytesPerPixel == (int)sizeof(pixel));
+    Assert((Layout == BufferLayout_Pitched) || (GetBufferLayout(Buffer) == BufferLayout_Packed));
+
+    //NOTE: Packed rows that span the whole width are one run, however many of them there are.
+    int Pitch = (Layout == BufferLayout_Packed) ? (Buffer->Width * (int)sizeof(pixel)) : Buffer->Pitch;
+    int Count = MaxX - MinX;
+    int RowCount = MaxY - MinY;
+    if ((Layout == BufferLayout_Packed) && (Count == Buffer->Width))
+    {
+        Count *= RowCount;
+        RowCount = 1;
+    }
+
+    pixel Value = format::Pack(Color);
+    uint8 *Row = (uint8 *)Buffer->Memory + MinY * Pitch + MinX * (int)sizeof(pixel);
+    for (int RowIndex = 0; RowIndex < RowCount; ++RowIndex)
+    {
+        FillPixelRow<format>((pixel *)Row, Count, Value);
+        Row += Pitch;
+    }
+}
+
+template <typename format, buffer_layout Layout, bool32 Streaming> internal CONVERT_PIXELS_KERNEL(ConvertPixels)
+{
+    typedef typename format::pixel pixel;
+    Assert((Source->BytesPerPixel == 4) && (Dest->BytesPerPixel == (int)sizeof(pixel)));
+    Assert((Source->Width == Dest->Width) && (Source->Height == Dest->Height));
+    Assert((Layout == BufferLayout_Pitched) ||
+            ((GetBufferLayout(Source) == BufferLayout_Packed) && (GetBufferLayout(Dest) == BufferLayout_Packed)));
+
+    int SourcePitch = (Layout == BufferLayout_Packed) ? (Source->Width * 4) : Source->Pitch;
+    int DestPitch = (Layout == BufferLayout_Packed) ? (Dest->Width * (int)sizeof(pixel)) : Dest->Pitch;
+    int Count = MaxX - MinX;
+    int RowCount = MaxY - MinY;
+    if ((Layout == BufferLayout_Packed) && (Count == Dest->Width))
+    {
+        Count *= RowCount;
+        RowCount = 1;
+    }
+
+    uint8 *SourceRow = (uint8 *)Source->Memory + MinY * SourcePitch + MinX * 4;
+    uint8 *DestRow = (uint8 *)Dest->Memory + MinY * DestPitch + MinX * (int)sizeof(pixel);
+    for (int RowIndex = 0; RowIndex < RowCount; ++RowIndex)
+    {
+        ConvertPixelRow<format, Streaming>((uint32 *)SourceRow, (pixel *)DestRow, Count);
+        SourceRow += SourcePitch;
+        DestRow += DestPitch;
+    }
+}
+
+// =====================================================================================================================
+
+inline void StorePixelGeneric(uint8 *Dest, int BytesPerPixel, uint32 Color)
+{
+    switch (BytesPerPixel)
+    {
+        case 2:
+        {
+            *(uint16 *)Dest = pixel_format_rgb565::Pack(Color);
+        } break;
+
+        case 1:
+        {
+            *Dest = pixel_format_indexed8::Pack(Color);
+        } break;
+
+        default:
+        {
+            *(uint32 *)Dest = pixel_format_bgrx32::Pack(Color);
+        } break;
+    }
+}
+
+internal FILL_PIXELS_KERNEL(FillPixelsGeneric)
+{
+    for (int Y = MinY; Y < MaxY; ++Y)
+    {
+        uint8 *Row = (uint8 *)Buffer->Memory + Y * Buffer->Pitch;
+        for (int X = MinX; X < MaxX; ++X)
+        {
+            StorePixelGeneric(Row + X * Buffer->BytesPerPixel, Buffer->BytesPerPixel, Color);
+        }
+    }
+}
+
+internal CONVERT_PIXELS_KERNEL(ConvertPixelsGeneric)
+{
+    for (int Y = MinY; Y < MaxY; ++Y)
+    {
+        uint8 *SourceRow = (uint8 *)Source->Memory + Y * Source->Pitch;
+        uint8 *DestRow = (uint8 *)Dest->Memory + Y * Dest->Pitch;
+        for (int X = MinX; X < MaxX; ++X)
+        {
+            uint32 Color = *(uint32 *)(SourceRow + X * Source->BytesPerPixel);
+            StorePixelGeneric(DestRow + X * Dest->BytesPerPixel, Dest->BytesPerPixel, Color);
+        }
+    }
+}
+
+// =====================================================================================================================
+
+template <typename format> internal void GetPixelKernelsForFormat(pixel_kernels *Kernels)
+{
+    if (Kernels->Layout == BufferLayout_Packed)
+    {
+        Kernels->FillPixels = FillPixels<format, BufferLayout_Packed>;
+        Kernels->ConvertPixels = ConvertPixels<format, BufferLayout_Packed, false>;
+        Kernels->StreamPixels = ConvertPixels<format, BufferLayout_Packed, true>;
+    }
+    else
+    {
+        Kernels->FillPixels = FillPixels<format, BufferLayout_Pitched>;
+        Kernels->ConvertPixels = ConvertPixels<format, BufferLayout_Pitched, false>;
+        Kernels->StreamPixels = ConvertPixels<format, BufferLayout_Pitched, true>;
+    }
+}
+
+// =====================================================================================================================
+
+internal pixel_kernels GetPixelKernels(pixel_format Format, buffer_layout Layout)
+{
+    //NOTE: Packed kernels may only be given buffers with packed rows; converting needs both source and dest packed.
+    pixel_kernels Result = {};
+    Result.Format = Format;
+    Result.Layout = Layout;
+    switch (Format)
+    {
+        case PixelFormat_RGB565:
+        {
+            GetPixelKernelsForFormat<pixel_format_rgb565>(&Result);
+        } break;
+
+        case PixelFormat_Indexed8:
+        {
+            GetPixelKernelsForFormat<pixel_format_indexed8>(&Result);
+        } break;
+
+        default:
+        {
+            Result.Format = PixelFormat_BGRX32;
+            GetPixelKernelsForFormat<pixel_format_bgrx32>(&Result);
+        } break;
+    }
+    return(Result);
+}
+
+#endif
@@ -0,0 +1,250 @@
+#if !defined(HANDMADE_PLATFORM_H)
+#define HANDMADE_PLATFORM_H
+
+//NOTE: Everything the platform layer and the game module have to agree on. The game is built as its own shared
+//  library and loaded at runtime, so this header is the whole contract between the two; nothing else may be shared.
+
+/*
+  NOTE: Build switches.
+
+  HANDMADE_INTERNAL:
+    0 - Build for public release
+    1 - Build for developer only
+
+  HANDMADE_SLOW:
+    0 - No slow code allowed!
+    1 - Slow code welcome.
+*/
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <math.h>
+
+#define internal        static
+#define local_persist   static
+#define global_variable static
+
+#define Pi32 3.14159265359f
+
+typedef uint8_t uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+typedef uint64_t uint64;
+
+typedef int8_t int8;
+typedef int16_t int16;
+typedef int32_t int32;
+typedef int64_t int64;
+typedef int32 bool32;
+
+typedef size_t memory_index;
+
+typedef float real32;
+typedef double real64;
+
+#if HANDMADE_SLOW
+#define Assert(Expression) if(!(Expression)) {*(volatile int *)0 = 0;}
+#else
+#define Assert(Expression)
+#endif
+
+#define Kilobytes(Value) ((Value)*1024LL)
+#define Megabytes(Value) (Kilobytes(Value)*1024LL)
+#define Gigabytes(Value) (Megabytes(Value)*1024LL)
+#define Terabytes(Value) (Gigabytes(Value)*1024LL)
+
+#define ArrayCount(Array) (sizeof(Array) / sizeof((Array)[0]))
+
+inline uint32 SafeTruncateUInt64(uint64 Value)
+{
+    Assert(Value <= 0xFFFFFFFF);
+    uint32 Result = (uint32)Value;
+    return(Result);
+}
+
+#include "handmade_memory.h"
+#include "handmade_debug_interface.h"
+
+// =====================================================================================================================
+//NOTE: Services that the game provides to the platform layer.
+//  The platform layer owns the window, the sound device and the input devices; the game only ever sees these
+//  platform-independent buffers.
+
+//NOTE: Half-open, in pixels: MinX/MinY are inclusive, MaxX/MaxY are exclusive.
+struct rectangle2i
+{
+    int MinX, MinY;
+    int MaxX, MaxY;
+};
+
+//NOTE: Dirty-rectangle tracking for a backbuffer that keeps its pixels from one frame to the next.
+//  The renderer only redraws the tiles whose commands changed since the last frame and lists what it redrew here, and
+//  the present stage only scales and copies those rectangles. The platform owns this, not the game, because only the
+//  platform knows when the backbuffer stops holding the game's last frame.
+#define DIRTY_MAX_TILE_COUNT 2048
+#define DIRTY_MAX_RECT_COUNT 32
+
+struct game_dirty_region
+{
+    //NOTE: Set by the platform on the first frame, and whenever something other than the game's own last frame may be
+    //  in the backbuffer, such as a replay rewinding game memory. The renderer then redraws everything and clears it.
+    bool32 Invalidate;
+
+    //NOTE: The renderer's bookkeeping: the tiling it used last frame, and a hash of the commands each tile drew.
+    void *TileMemory;
+    int TileSize;
+    int TileCountX;
+    int TileCountY;
+    uint64 TileHash[DIRTY_MAX_TILE_COUNT];
+
+    //NOTE: How many frames in a row have been drawn whole because most tiles kept changing; 0 while tiles are being
+    //  tracked.
+    uint32 WholeFrameCount;
+
+    //NOTE: What the last frame redrew, in backbuffer pixels. The present stage empties the list once it has copied
+    //  everything on it.
+    int RectCount;
+    rectangle2i Rects[DIRTY_MAX_RECT_COUNT];
+    uint32 RenderedPixelCount;
+};
+
+struct game_offscreen_buffer
+{
+    //NOTE: The game's pixels are always 32-bits wide, Memory Order BB GG RR xx. The platform also converts finished
+    //  pictures into narrower buffers, told apart by BytesPerPixel (see handmade_pixel_format.h).
+    void *Memory;
+    int Width;
+    int Height;
+    int Pitch;
+    int BytesPerPixel;
+
+    //NOTE: May be 0, in which case every frame is drawn and presented whole.
+    game_dirty_region *Dirty;
+};
+
+struct game_sound_output_buffer
+{
+    //NOTE: Samples are interleaved 16-bit stereo, Left Right Left Right...
+    int SamplesPerSecond;
+    int SampleCount;
+    int16 *Samples;
+};
+
+struct game_button_state
+{
+    int HalfTransitionCount;
+    bool32 EndedDown;
+};
+
+struct game_controller_input
+{
+    bool32 IsConnected;
+    bool32 IsAnalog;
+
+    //NOTE: Stick values are normalized to [-1, 1].
+    real32 StickAverageX;
+    real32 StickAverageY;
+
+    union
+    {
+        game_button_state Buttons[12];
+        struct
+        {
+            game_button_state MoveUp;
+            game_button_state MoveDown;
+            game_button_state MoveLeft;
+            game_button_state MoveRight;
+
+            game_button_state ActionUp;
+            game_button_state ActionDown;
+            game_button_state ActionLeft;
+            game_button_state ActionRight;
+
+            game_button_state LeftShoulder;
+            game_button_state RightShoulder;
+
+            game_button_state Back;
+            game_button_state Start;
+        };
+    };
+};
+
+struct game_input
+{
+    //NOTE: How long this frame is meant to last: the locked frame time, not how long the last one happened to take,
+    //  so the simulation steps the same amount every frame and replays bit for bit.
+    real32 dtForFrame;
+
+    //NOTE: Controller 0 is the keyboard, 1-4 are gamepads.
+    game_controller_input Controllers[5];
+};
+
+inline game_controller_input *GetController(game_input *Input, int ControllerIndex)
+{
+    Assert(ControllerIndex < (int)ArrayCount(Input->Controllers));
+    game_controller_input *Result = &Input->Controllers[ControllerIndex];
+    return(Result);
+}
+
+//NOTE: Work queues. The platform owns the worker threads; the game hands it small self-contained jobs and then calls
+//  CompleteAllWork, which has the calling thread join in until every job it added has finished.
+struct platform_work_queue;
+#define PLATFORM_WORK_QUEUE_CALLBACK(name) void name(platform_work_queue *Queue, void *Data)
+typedef PLATFORM_WORK_QUEUE_CALLBACK(platform_work_queue_callback);
+
+typedef void platform_add_entry(platform_work_queue *Queue, platform_work_queue_callback *Callback, void *Data);
+typedef void platform_complete_all_work(platform_work_queue *Queue);
+
+//NOTE: Read-only file mappings. The platform maps the whole file and the game reads straight out of the mapping, so
+//  nothing is copied and pages only come in when they are touched. Memory is 0 if the file couldn't be opened or
+//  mapped. Names are relative to the working directory.
+struct platform_file_mapping
+{
+    void *Memory;
+    uint64 Size;
+};
+
+typedef platform_file_mapping platform_map_file(char *FileName);
+typedef void platform_unmap_file(platform_file_mapping *Mapping);
+
+struct platform_api
+{
+    platform_add_entry *AddEntry;
+    platform_complete_all_work *CompleteAllWork;
+
+    platform_map_file *MapFile;
+    platform_unmap_file *UnmapFile;
+};
+
+struct game_memory
+{
+    bool32 IsInitialized;
+
+    uint64 PermanentStorageSize;
+    void *PermanentStorage; //NOTE: REQUIRED to be cleared to zero at startup
+
+    uint64 TransientStorageSize;
+    void *TransientStorage; //NOTE: REQUIRED to be cleared to zero at startup
+
+    platform_work_queue *HighPriorityQueue;
+
+    //NOTE: For work that may take several frames, like asset loads. The game never waits on it.
+    platform_work_queue *LowPriorityQueue;
+
+    platform_api PlatformAPI;
+
+    //NOTE: Profiler rings, owned by the platform. 0 in release builds.
+    debug_table *DebugTable;
+
+    //NOTE: Every arena, the platform's and the game's, registers here so that high-water marks can be reported.
+    memory_arena_registry ArenaRegistry;
+};
+
+//NOTE: The one entry point the game module exports. The platform looks it up by name after loading the module,
+//  which is why it has to be extern "C".
+#define GAME_UPDATE_AND_RENDER(name) void name(game_memory *Memory, game_input *Input, \
+        game_offscreen_buffer *Buffer, game_sound_output_buffer *SoundBuffer)
+typedef GAME_UPDATE_AND_RENDER(game_update_and_render);
+
+#endif
@@ -0,0 +1,627 @@
+#if !defined(HANDMADE_PRESENT_H)
+#define HANDMADE_PRESENT_H
+
+//NOTE: Present stage, shared by the platform layers.
+//  The game always draws into a fixed-size backbuffer. Presenting scales it into a display buffer the size of the
+//  window's client area, letterboxed to keep the backbuffer's aspect ratio, so the copy to the window is 1:1 and the
+//  OS never has to stretch anything. There are two scalers:
+//
+//  Integer:  every backbuffer pixel becomes a Scale x Scale block, Scale being the largest whole number that fits.
+//            The output is exact. A window smaller than the backbuffer can't be done this way and gets bilinear.
+//  Bilinear: fills the largest rectangle with the right aspect ratio, sampling at pixel centers with 8-bit
+//            fixed-point weights. It filters each source row horizontally into a 16-bit row cache first, then blends
+//            two cached rows per display row, so upscaling filters every source row only about once. The SSE2 path
+//            has to match the scalar one bit for bit.
+//
+//  The bars around the picture are only cleared when the layout changes, since nothing else ever writes to them. The
+//  picture itself is split into horizontal bands that go on the platform's work queue.
+//
+//  When the backbuffer carries dirty rectangles, only the display pixels those can reach are redone, and the bands
+//  only cover the rows between the first and last of them. Any layout change redoes the whole picture.
+
+#define PRESENT_MAX_WIDTH 5120
+#define PRESENT_MAX_HEIGHT 2880
+#define PRESENT_BAND_COUNT 16
+
+enum present_mode
+{
+    PresentMode_Integer,
+    PresentMode_Bilinear,
+
+    PresentMode_Count,
+};
+
+struct present_layout
+{
+    //NOTE: Mode is what actually runs, which is bilinear whenever integer scaling doesn't fit. The picture covers
+    //  [MinX, MaxX) x [MinY, MaxY) of the display buffer.
+    present_mode Mode;
+    int Scale;
+
+    int SourceWidth;
+    int SourceHeight;
+    int DisplayWidth;
+    int DisplayHeight;
+
+    int MinX;
+    int MinY;
+    int MaxX;
+    int MaxY;
+};
+
+struct present_state;
+struct present_band_work
+{
+    present_state *State;
+    game_offscreen_buffer *Source;
+    game_offscreen_buffer *Display;
+
+    //NOTE: Display rows, inside the picture. The band redoes every one of the state's rectangles that crosses them.
+    int MinY;
+    int MaxY;
+
+    //NOTE: Two horizontally filtered source rows, 4 uint16 channels per display pixel, and which rows they hold.
+    uint16 *CachedRow[2];
+    int CachedSourceY[2];
+};
+
+struct present_state
+{
+    present_mode RequestedMode;
+    //NOTE: Only ever turned off to compare against the reference.
+    bool32 UseSSE2;
+
+    bool32 LayoutIsValid;
+    present_layout Layout;
+    void *LayoutDisplayMemory;
+
+    //NOTE: Bilinear sampling positions for each display column of the picture, rebuilt with the layout.
+    uint16 ColumnX0[PRESENT_MAX_WIDTH];
+    uint16 ColumnX1[PRESENT_MAX_WIDTH];
+    uint16 ColumnWeight[PRESENT_MAX_WIDTH];
+
+    present_band_work Bands[PRESENT_BAND_COUNT];
+
+    //NOTE: What the last present wrote, in display pixels, for the platform to copy to the window. Source rectangles
+    //  are the same areas in backbuffer pixels.
+    int RectCount;
+    rectangle2i SourceRects[DIRTY_MAX_RECT_COUNT];
+    rectangle2i Rects[DIRTY_MAX_RECT_COUNT];
+    bool32 LayoutChanged;
+    uint32 PresentedPixelCount;
+};
+
+// =====================================================================================================================
+
+inline memory_index GetPresentStorageSize(void)
+{
+    //NOTE: What InitializePresentState and the present_state itself take out of an arena, alignment included.
+    memory_index Result = sizeof(present_state) + 64 +
+        PRESENT_BAND_COUNT * 2 * (PRESENT_MAX_WIDTH * 4 * sizeof(uint16) + 64);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void InitializePresentState(present_state *State, memory_arena *Arena, present_mode Mode)
+{
+    *State = {};
+    State->RequestedMode = Mode;
+    State->UseSSE2 = true;
+
+    memory_index RowSize = PRESENT_MAX_WIDTH * 4 * sizeof(uint16);
+    for (int BandIndex = 0; BandIndex < PRESENT_BAND_COUNT; ++BandIndex)
+    {
+        present_band_work *Band = State->Bands + BandIndex;
+        Band->State = State;
+        Band->CachedRow[0] = (uint16 *)PushSize(Arena, RowSize, 64);
+        Band->CachedRow[1] = (uint16 *)PushSize(Arena, RowSize, 64);
+    }
+}
+
+// =====================================================================================================================
+
+internal present_layout ComputePresentLayout(present_mode Mode, int SourceWidth, int SourceHeight,
+        int DisplayWidth, int DisplayHeight)
+{
+    present_layout Result = {};
+    Result.SourceWidth = SourceWidth;
+    Result.SourceHeight = SourceHeight;
+    Result.DisplayWidth = DisplayWidth;
+    Result.DisplayHeight = DisplayHeight;
+
+    int ScaleX = DisplayWidth / SourceWidth;
+    int ScaleY = DisplayHeight / SourceHeight;
+    int Scale = (ScaleX < ScaleY) ? ScaleX : ScaleY;
+
+    int Width;
+    int Height;
+    if ((Mode == PresentMode_Integer) && (Scale >= 1))
+    {
+        Result.Mode = PresentMode_Integer;
+        Result.Scale = Scale;
+        Width = Scale * SourceWidth;
+        Height = Scale * SourceHeight;
+    }
+    else
+    {
+        Result.Mode = PresentMode_Bilinear;
+        if ((int64)DisplayWidth * SourceHeight >= (int64)DisplayHeight * SourceWidth)
+        {
+            //NOTE: Display is wider than the picture: bars left and right.
+            Height = DisplayHeight;
+            Width = (int)(((int64)SourceWidth * DisplayHeight + SourceHeight / 2) / SourceHeight);
+        }
+        else
+        {
+            Width = DisplayWidth;
+            Height = (int)(((int64)SourceHeight * DisplayWidth + SourceWidth / 2) / SourceWidth);
+        }
+    }
+
+    Result.MinX = (DisplayWidth - Width) / 2;
+    Result.MinY = (DisplayHeight - Height) / 2;
+    Result.MaxX = Result.MinX + Width;
+    Result.MaxY = Result.MinY + Height;
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline void GetBilinearSample(int DestIndex, int DestCount, int SourceCount, int *Index0, int *Index1, int *Weight)
+{
+    //NOTE: The center of destination pixel i lands at ((i + 0.5) * SourceCount / DestCount) - 0.5 in the source,
+    //  in 16.16 fixed point. Anything outside the source is clamped to its edge.
+    int64 Position = ((int64)(2 * DestIndex + 1) * SourceCount * 65536) / (2 * (int64)DestCount) - 32768;
+    if (Position < 0)
+    {
+        Position = 0;
+    }
+
+    int Index = (int)(Position >> 16);
+    int Fraction = (int)((Position >> 8) & 0xFF);
+    if (Index >= (SourceCount - 1))
+    {
+        Index = SourceCount - 1;
+        Fraction = 0;
+    }
+
+    *Index0 = Index;
+    *Index1 = (Index < (SourceCount - 1)) ? (Index + 1) : Index;
+    *Weight = Fraction;
+}
+
+// =====================================================================================================================
+
+internal void ClearPresentBars(present_layout *Layout, game_offscreen_buffer *Display)
+{
+    uint8 *Row = (uint8 *)Display->Memory;
+    for (int Y = 0; Y < Display->Height; ++Y)
+    {
+        uint32 *Pixel = (uint32 *)Row;
+        if ((Y < Layout->MinY) || (Y >= Layout->MaxY))
+        {
+            memset(Pixel, 0, Display->Width * sizeof(uint32));
+        }
+        else
+        {
+            memset(Pixel, 0, Layout->MinX * sizeof(uint32));
+            memset(Pixel + Layout->MaxX, 0, (Display->Width - Layout->MaxX) * sizeof(uint32));
+        }
+        Row += Display->Pitch;
+    }
+}
+
+// =====================================================================================================================
+//NOTE: Integer scaling. Each source row is expanded into the first display row it covers, and the other Scale - 1
+//  rows are copies of that one.
+
+internal void ExpandRowScalar(uint32 *Source, uint32 *Dest, int SourceCount, int Scale)
+{
+    for (int X = 0; X < SourceCount; ++X)
+    {
+        uint32 Color = *Source++;
+        for (int Repeat = 0; Repeat < Scale; ++Repeat)
+        {
+            *Dest++ = Color;
+        }
+    }
+}
+
+internal void ExpandRowBy2SSE2(uint32 *Source, uint32 *Dest, int SourceCount)
+{
+    int X = 0;
+    for (; (X + 4) <= SourceCount; X += 4)
+    {
+        __m128i Pixels = _mm_loadu_si128((__m128i *)(Source + X));
+        _mm_storeu_si128((__m128i *)(Dest + 2 * X), _mm_unpacklo_epi32(Pixels, Pixels));
+        _mm_storeu_si128((__m128i *)(Dest + 2 * X + 4), _mm_unpackhi_epi32(Pixels, Pixels));
+    }
+    ExpandRowScalar(Source + X, Dest + 2 * X, SourceCount - X, 2);
+}
+
+internal void ExpandRowSSE2(uint32 *Source, uint32 *Dest, int SourceCount, int Scale)
+{
+    //NOTE: Each pixel's stores run up to 3 pixels past its own block, into the next pixel's, which then overwrites
+    //  them. Only the last pixel can't do that without spilling out of the row, so it goes through the scalar path.
+    int X = 0;
+    for (; X < (SourceCount - 1); ++X)
+    {
+        __m128i Color4x = _mm_set1_epi32((int)Source[X]);
+        for (int Repeat = 0; Repeat < Scale; Repeat += 4)
+        {
+            _mm_storeu_si128((__m128i *)(Dest + Repeat), Color4x);
+        }
+        Dest += Scale;
+    }
+    ExpandRowScalar(Source + X, Dest, SourceCount - X, Scale);
+}
+
+internal void PresentIntegerBand(present_band_work *Band)
+{
+    present_state *State = Band->State;
+    present_layout *Layout = &State->Layout;
+    game_offscreen_buffer *Source = Band->Source;
+    game_offscreen_buffer *Display = Band->Display;
+    int Scale = Layout->Scale;
+
+    for (int RectIndex = 0; RectIndex < State->RectCount; ++RectIndex)
+    {
+        rectangle2i Rect = State->Rects[RectIndex];
+        rectangle2i SourceRect = State->SourceRects[RectIndex];
+        int MinY = (Rect.MinY > Band->MinY) ? Rect.MinY : Band->MinY;
+        int MaxY = (Rect.MaxY < Band->MaxY) ? Rect.MaxY : Band->MaxY;
+        int SourceCount = SourceRect.MaxX - SourceRect.MinX;
+        memory_index RowSize = (memory_index)(Rect.MaxX - Rect.MinX) * sizeof(uint32);
+
+        uint8 *PreviousRow = 0;
+        uint8 *DisplayRow = (uint8 *)Display->Memory + MinY * Display->Pitch + Rect.MinX * sizeof(uint32);
+        for (int Y = MinY; Y < MaxY; ++Y)
+        {
+            int PictureY = Y - Layout->MinY;
+            if (!PreviousRow || ((PictureY % Scale) == 0))
+            {
+                uint32 *SourceRow = (uint32 *)((uint8 *)Source->Memory + (PictureY / Scale) * Source->Pitch) +
+                    SourceRect.MinX;
+                if (Scale == 1)
+                {
+                    memcpy(DisplayRow, SourceRow, RowSize);
+                }
+                else if ((Scale == 2) && State->UseSSE2)
+                {
+                    ExpandRowBy2SSE2(SourceRow, (uint32 *)DisplayRow, SourceCount);
+                }
+                else if (State->UseSSE2)
+                {
+                    ExpandRowSSE2(SourceRow, (uint32 *)DisplayRow, SourceCount, Scale);
+                }
+                else
+                {
+                    ExpandRowScalar(SourceRow, (uint32 *)DisplayRow, SourceCount, Scale);
+                }
+            }
+            else
+            {
+                memcpy(DisplayRow, PreviousRow, RowSize);
+            }
+
+            PreviousRow = DisplayRow;
+            DisplayRow += Display->Pitch;
+        }
+    }
+}
+
+// =====================================================================================================================
+//NOTE: Bilinear. Channels are filtered as (A * (256 - W) + B * W) >> 8, horizontally then vertically. With 8-bit
+//  channels and weights that sum to 256 every intermediate fits in an unsigned 16-bit lane, which is what lets the SSE2
+//  path use 16-bit multiplies and still match the scalar one exactly.
+
+internal void FilterRowScalar(present_state *State, uint32 *SourceRow, uint16 *Dest, int MinX, int MaxX)
+{
+    for (int X = MinX; X < MaxX; ++X)
+    {
+        uint32 A = SourceRow[State->ColumnX0[X]];
+        uint32 B = SourceRow[State->ColumnX1[X]];
+        uint32 Weight = State->ColumnWeight[X];
+        for (int Channel = 0; Channel < 4; ++Channel)
+        {
+            uint32 ChannelA = (A >> (8 * Channel)) & 0xFF;
+            uint32 ChannelB = (B >> (8 * Channel)) & 0xFF;
+            Dest[4 * X + Channel] = (uint16)((ChannelA * (256 - Weight) + ChannelB * Weight) >> 8);
+        }
+    }
+}
+
+internal void BlendRowsScalar(uint16 *Row0, uint16 *Row1, int Weight, uint32 *Dest, int Count)
+{
+    for (int X = 0; X < Count; ++X)
+    {
+        uint32 Color = 0;
+        for (int Channel = 0; Channel < 4; ++Channel)
+        {
+            uint32 Value = ((uint32)Row0[Channel] * (256 - Weight) + (uint32)Row1[Channel] * Weight) >> 8;
+            Color |= Value << (8 * Channel);
+        }
+        *Dest++ = Color;
+        Row0 += 4;
+        Row1 += 4;
+    }
+}
+
+internal void FilterRowSSE2(present_state *State, uint32 *SourceRow, uint16 *Dest, int MinX, int MaxX)
+{
+    __m128i Zero = _mm_setzero_si128();
+    __m128i Full = _mm_set1_epi16(256);
+
+    int X = MinX;
+    for (; (X + 2) <= MaxX; X += 2)
+    {
+        //NOTE: Two display pixels at a time, one per 64-bit half, four 16-bit channels each.
+        __m128i A = _mm_unpacklo_epi32(_mm_cvtsi32_si128((int)SourceRow[State->ColumnX0[X]]),
+                _mm_cvtsi32_si128((int)SourceRow[State->ColumnX0[X + 1]]));
+        __m128i B = _mm_unpacklo_epi32(_mm_cvtsi32_si128((int)SourceRow[State->ColumnX1[X]]),
+                _mm_cvtsi32_si128((int)SourceRow[State->ColumnX1[X + 1]]));
+        A = _mm_unpacklo_epi8(A, Zero);
+        B = _mm_unpacklo_epi8(B, Zero);
+
+        __m128i WeightB = _mm_unpacklo_epi64(_mm_set1_epi16((short)State->ColumnWeight[X]),
+                _mm_set1_epi16((short)State->ColumnWeight[X + 1]));
+        __m128i WeightA = _mm_sub_epi16(Full, WeightB);
+
+        __m128i Result = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(A, WeightA), _mm_mullo_epi16(B, WeightB)), 8);
+        _mm_storeu_si128((__m128i *)(Dest + 4 * X), Result);
+    }
+    FilterRowScalar(State, SourceRow, Dest, X, MaxX);
+}
+
+internal void BlendRowsSSE2(uint16 *Row0, uint16 *Row1, int Weight, uint32 *Dest, int Count)
+{
+    __m128i WeightB = _mm_set1_epi16((short)Weight);
+    __m128i WeightA = _mm_set1_epi16((short)(256 - Weight));
+
+    int X = 0;
+    for (; (X + 4) <= Count; X += 4)
+    {
+        __m128i Low0 = _mm_loadu_si128((__m128i *)(Row0 + 4 * X));
+        __m128i High0 = _mm_loadu_si128((__m128i *)(Row0 + 4 * X + 8));
+        __m128i Low1 = _mm_loadu_si128((__m128i *)(Row1 + 4 * X));
+        __m128i High1 = _mm_loadu_si128((__m128i *)(Row1 + 4 * X + 8));
+
+        __m128i Low = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(Low0, WeightA), _mm_mullo_epi16(Low1, WeightB)), 8);
+        __m128i High = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(High0, WeightA),
+                    _mm_mullo_epi16(High1, WeightB)), 8);
+        _mm_storeu_si128((__m128i *)(Dest + X), _mm_packus_epi16(Low, High));
+    }
+    BlendRowsScalar(Row0 + 4 * X, Row1 + 4 * X, Weight, Dest + X, Count - X);
+}
+
+internal uint16 *GetFilteredSourceRow(present_band_work *Band, int SourceY, int MinX, int MaxX)
+{
+    //NOTE: Moving down one source row, the old second row becomes the new first one, so only one row gets filtered.
+    //  Only columns [MinX, MaxX) of the picture are filtered, so the cache is only good for one rectangle.
+    for (int CacheIndex = 0; CacheIndex < 2; ++CacheIndex)
+    {
+        if (Band->CachedSourceY[CacheIndex] == SourceY)
+        {
+            return(Band->CachedRow[CacheIndex]);
+        }
+    }
+
+    int CacheIndex = (Band->CachedSourceY[0] < Band->CachedSourceY[1]) ? 0 : 1;
+    uint32 *SourceRow = (uint32 *)((uint8 *)Band->Source->Memory + SourceY * Band->Source->Pitch);
+    if (Band->State->UseSSE2)
+    {
+        FilterRowSSE2(Band->State, SourceRow, Band->CachedRow[CacheIndex], MinX, MaxX);
+    }
+    else
+    {
+        FilterRowScalar(Band->State, SourceRow, Band->CachedRow[CacheIndex], MinX, MaxX);
+    }
+    Band->CachedSourceY[CacheIndex] = SourceY;
+    return(Band->CachedRow[CacheIndex]);
+}
+
+internal void PresentBilinearBand(present_band_work *Band)
+{
+    present_state *State = Band->State;
+    present_layout *Layout = &State->Layout;
+    game_offscreen_buffer *Display = Band->Display;
+    int Height = Layout->MaxY - Layout->MinY;
+
+    for (int RectIndex = 0; RectIndex < State->RectCount; ++RectIndex)
+    {
+        rectangle2i Rect = State->Rects[RectIndex];
+        int MinY = (Rect.MinY > Band->MinY) ? Rect.MinY : Band->MinY;
+        int MaxY = (Rect.MaxY < Band->MaxY) ? Rect.MaxY : Band->MaxY;
+        int MinX = Rect.MinX - Layout->MinX;
+        int MaxX = Rect.MaxX - Layout->MinX;
+
+        Band->CachedSourceY[0] = -1;
+        Band->CachedSourceY[1] = -1;
+
+        uint8 *DisplayRow = (uint8 *)Display->Memory + MinY * Display->Pitch + Rect.MinX * sizeof(uint32);
+        for (int Y = MinY; Y < MaxY; ++Y)
+        {
+            int SourceY0, SourceY1, Weight;
+            GetBilinearSample(Y - Layout->MinY, Height, Layout->SourceHeight, &SourceY0, &SourceY1, &Weight);
+
+            uint16 *Row0 = GetFilteredSourceRow(Band, SourceY0, MinX, MaxX) + 4 * MinX;
+            uint16 *Row1 = GetFilteredSourceRow(Band, SourceY1, MinX, MaxX) + 4 * MinX;
+            if (State->UseSSE2)
+            {
+                BlendRowsSSE2(Row0, Row1, Weight, (uint32 *)DisplayRow, MaxX - MinX);
+            }
+            else
+            {
+                BlendRowsScalar(Row0, Row1, Weight, (uint32 *)DisplayRow, MaxX - MinX);
+            }
+            DisplayRow += Display->Pitch;
+        }
+    }
+}
+
+// =====================================================================================================================
+
+internal PLATFORM_WORK_QUEUE_CALLBACK(DoPresentBandWork)
+{
+    present_band_work *Band = (present_band_work *)Data;
+    present_layout *Layout = &Band->State->Layout;
+    TIMED_FUNCTION((uint32)((Band->MaxY - Band->MinY) * (Layout->MaxX - Layout->MinX)));
+
+    if (Layout->Mode == PresentMode_Integer)
+    {
+        PresentIntegerBand(Band);
+    }
+    else
+    {
+        PresentBilinearBand(Band);
+    }
+}
+
+// =====================================================================================================================
+
+internal rectangle2i GetPresentRect(present_layout *Layout, rectangle2i SourceRect)
+{
+    //NOTE: The display pixels a rectangle of the backbuffer can reach. Integer scaling is exact. A bilinear display
+    //  pixel reads the two source pixels around its center, so the rectangle grows by a source pixel each way, plus a
+    //  display pixel for the rounding in GetBilinearSample, and is then clamped to the picture.
+    rectangle2i Result;
+    int Width = Layout->MaxX - Layout->MinX;
+    int Height = Layout->MaxY - Layout->MinY;
+    if (Layout->Mode == PresentMode_Integer)
+    {
+        Result.MinX = Layout->Scale * SourceRect.MinX;
+        Result.MinY = Layout->Scale * SourceRect.MinY;
+        Result.MaxX = Layout->Scale * SourceRect.MaxX;
+        Result.MaxY = Layout->Scale * SourceRect.MaxY;
+    }
+    else
+    {
+        int64 SourceWidth = Layout->SourceWidth;
+        int64 SourceHeight = Layout->SourceHeight;
+        Result.MinX = (int)(((int64)(SourceRect.MinX - 1) * Width) / SourceWidth) - 1;
+        Result.MinY = (int)(((int64)(SourceRect.MinY - 1) * Height) / SourceHeight) - 1;
+        Result.MaxX = (int)(((int64)(SourceRect.MaxX + 1) * Width + SourceWidth - 1) / SourceWidth) + 1;
+        Result.MaxY = (int)(((int64)(SourceRect.MaxY + 1) * Height + SourceHeight - 1) / SourceHeight) + 1;
+        Result.MinX = (Result.MinX < 0) ? 0 : Result.MinX;
+        Result.MinY = (Result.MinY < 0) ? 0 : Result.MinY;
+        Result.MaxX = (Result.MaxX > Width) ? Width : Result.MaxX;
+        Result.MaxY = (Result.MaxY > Height) ? Height : Result.MaxY;
+    }
+
+    Result.MinX += Layout->MinX;
+    Result.MinY += Layout->MinY;
+    Result.MaxX += Layout->MinX;
+    Result.MaxY += Layout->MinY;
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void PresentBuffer(present_state *State, game_offscreen_buffer *Source, game_offscreen_buffer *Display,
+        platform_api *PlatformAPI, platform_work_queue *Queue)
+{
+    //NOTE: Queue may be 0, in which case every band runs right here. Both buffers are 32-bit BB GG RR xx, and the
+    //  display buffer must be no bigger than PRESENT_MAX_WIDTH x PRESENT_MAX_HEIGHT. Afterwards, LayoutChanged says
+    //  the whole display buffer was rewritten, and otherwise Rects says which parts of it were.
+    TIMED_FUNCTION();
+
+    Assert((Display->Width <= PRESENT_MAX_WIDTH) && (Display->Height <= PRESENT_MAX_HEIGHT));
+    present_layout Layout = ComputePresentLayout(State->RequestedMode, Source->Width, Source->Height,
+            Display->Width, Display->Height);
+    State->LayoutChanged = (!State->LayoutIsValid || (memcmp(&Layout, &State->Layout, sizeof(Layout)) != 0) ||
+            (State->LayoutDisplayMemory != Display->Memory));
+    if (State->LayoutChanged)
+    {
+        State->Layout = Layout;
+        State->LayoutDisplayMemory = Display->Memory;
+        State->LayoutIsValid = true;
+        ClearPresentBars(&State->Layout, Display);
+
+        if (Layout.Mode == PresentMode_Bilinear)
+        {
+            int Width = Layout.MaxX - Layout.MinX;
+            for (int X = 0; X < Width; ++X)
+            {
+                int X0, X1, Weight;
+                GetBilinearSample(X, Width, Source->Width, &X0, &X1, &Weight);
+                State->ColumnX0[X] = (uint16)X0;
+                State->ColumnX1[X] = (uint16)X1;
+                State->ColumnWeight[X] = (uint16)Weight;
+            }
+        }
+    }
+
+    game_dirty_region *Dirty = Source->Dirty;
+    if (Dirty && !State->LayoutChanged)
+    {
+        State->RectCount = Dirty->RectCount;
+        for (int RectIndex = 0; RectIndex < Dirty->RectCount; ++RectIndex)
+        {
+            State->SourceRects[RectIndex] = Dirty->Rects[RectIndex];
+        }
+    }
+    else
+    {
+        rectangle2i Whole = {0, 0, Source->Width, Source->Height};
+        State->RectCount = 1;
+        State->SourceRects[0] = Whole;
+    }
+
+    State->PresentedPixelCount = 0;
+    int SpanMinY = Layout.MaxY;
+    int SpanMaxY = Layout.MinY;
+    for (int RectIndex = 0; RectIndex < State->RectCount; ++RectIndex)
+    {
+        rectangle2i Rect = GetPresentRect(&Layout, State->SourceRects[RectIndex]);
+        State->Rects[RectIndex] = Rect;
+        State->PresentedPixelCount += (uint32)((Rect.MaxX - Rect.MinX) * (Rect.MaxY - Rect.MinY));
+        SpanMinY = (Rect.MinY < SpanMinY) ? Rect.MinY : SpanMinY;
+        SpanMaxY = (Rect.MaxY > SpanMaxY) ? Rect.MaxY : SpanMaxY;
+    }
+    if (Dirty)
+    {
+        Dirty->RectCount = 0;
+    }
+
+    //NOTE: Bands split the rows the rectangles cover. Integer bands start on a whole source row so no band has to redo
+    //  another's expansion; the rectangles already do.
+    int RowStep = (Layout.Mode == PresentMode_Integer) ? Layout.Scale : 1;
+    int RowGroupCount = (SpanMaxY > SpanMinY) ? ((SpanMaxY - SpanMinY) / RowStep) : 0;
+    int BandCount = 0;
+    for (int BandIndex = 0; BandIndex < PRESENT_BAND_COUNT; ++BandIndex)
+    {
+        present_band_work *Band = State->Bands + BandIndex;
+        Band->Source = Source;
+        Band->Display = Display;
+        Band->MinY = SpanMinY + RowStep * ((RowGroupCount * BandIndex) / PRESENT_BAND_COUNT);
+        Band->MaxY = SpanMinY + RowStep * ((RowGroupCount * (BandIndex + 1)) / PRESENT_BAND_COUNT);
+        if (Band->MinY < Band->MaxY)
+        {
+            if (Queue)
+            {
+                PlatformAPI->AddEntry(Queue, DoPresentBandWork, Band);
+            }
+            else
+            {
+                DoPresentBandWork(0, Band);
+            }
+            ++BandCount;
+        }
+    }
+
+    if (Queue && BandCount)
+    {
+        PlatformAPI->CompleteAllWork(Queue);
+    }
+}
+
+// =====================================================================================================================
+
+internal char *GetPresentModeName(present_mode Mode)
+{
+    char *Result = (Mode == PresentMode_Integer) ? (char *)"integer" : (char *)"bilinear";
+    return(Result);
+}
+
+#endif
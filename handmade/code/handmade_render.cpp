@@ -0,0 +1,1058 @@
+global_variable render_kernels GlobalRenderKernels;
+
+// =====================================================================================================================
+
+internal rectangle2i ClipRectangle(game_offscreen_buffer *Buffer, int MinX, int MinY, int MaxX, int MaxY)
+{
+    rectangle2i Result;
+    Result.MinX = (MinX < 0) ? 0 : MinX;
+    Result.MinY = (MinY < 0) ? 0 : MinY;
+    Result.MaxX = (MaxX > Buffer->Width) ? Buffer->Width : MaxX;
+    Result.MaxY = (MaxY > Buffer->Height) ? Buffer->Height : MaxY;
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 HasArea(rectangle2i Rect)
+{
+    bool32 Result = ((Rect.MinX < Rect.MaxX) && (Rect.MinY < Rect.MaxY));
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal rectangle2i IntersectRectangles(rectangle2i A, rectangle2i B)
+{
+    rectangle2i Result;
+    Result.MinX = (A.MinX < B.MinX) ? B.MinX : A.MinX;
+    Result.MinY = (A.MinY < B.MinY) ? B.MinY : A.MinY;
+    Result.MaxX = (A.MaxX > B.MaxX) ? B.MaxX : A.MaxX;
+    Result.MaxY = (A.MaxY > B.MaxY) ? B.MaxY : A.MaxY;
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal rectangle2i UnionRectangles(rectangle2i A, rectangle2i B)
+{
+    rectangle2i Result;
+    Result.MinX = (A.MinX < B.MinX) ? A.MinX : B.MinX;
+    Result.MinY = (A.MinY < B.MinY) ? A.MinY : B.MinY;
+    Result.MaxX = (A.MaxX > B.MaxX) ? A.MaxX : B.MaxX;
+    Result.MaxY = (A.MaxY > B.MaxY) ? A.MaxY : B.MaxY;
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline int64 GetRectangleArea(rectangle2i Rect)
+{
+    int64 Result = (int64)(Rect.MaxX - Rect.MinX) * (int64)(Rect.MaxY - Rect.MinY);
+    return(Result);
+}
+
+// =====================================================================================================================
+//NOTE: Per-pixel compositing. The SIMD kernels do exactly these operations in exactly this order, 4 or 8 lanes at a
+//  time, and fall back to these functions for the pixels at the edges.
+
+inline uint32 MultiplyDivide255(uint32 A, uint32 B)
+{
+    //NOTE: Round(A * B / 255) for A and B in 0-255, without the divide.
+    uint32 T = A * B + 128;
+    uint32 Result = (T + (T >> 8)) >> 8;
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline uint32 LerpTexel(uint32 A, uint32 B, uint32 WeightA)
+{
+    //NOTE: (A * WeightA + B * (256 - WeightA) + 128) / 256 for each channel, with WeightA in 0-255. Two channels go
+    //  through each multiply; they top out at 255 * 256 + 128, so neither carries into the other.
+    uint32 WeightB = 256 - WeightA;
+    uint32 EvenChannels = (A & 0x00FF00FF) * WeightA + (B & 0x00FF00FF) * WeightB + 0x00800080;
+    uint32 OddChannels = ((A >> 8) & 0x00FF00FF) * WeightA + ((B >> 8) & 0x00FF00FF) * WeightB + 0x00800080;
+    uint32 Result = ((EvenChannels >> 8) & 0x00FF00FF) | (OddChannels & 0xFF00FF00);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline uint32 GetTexelOrZero(uint32 *Row, int X, int Width)
+{
+    uint32 Result = 0;
+    if (Row && (X >= 0) && (X < Width))
+    {
+        Result = Row[X];
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline uint32 SampleBitmap(bitmap_draw *Draw, uint32 *Source0, uint32 *Source1, int TexelX)
+{
+    //NOTE: Source0 and Source1 are the two texel rows the destination row sits between (the same row when there is
+    //  no vertical fraction, 0 past the top or bottom). Filters horizontally first, then vertically.
+    int Width = Draw->Bitmap->Width;
+    int TexelX0 = Draw->FractionX ? (TexelX - 1) : TexelX;
+    uint32 Row0 = LerpTexel(GetTexelOrZero(Source0, TexelX0, Width), GetTexelOrZero(Source0, TexelX, Width),
+            Draw->FractionX);
+    uint32 Row1 = LerpTexel(GetTexelOrZero(Source1, TexelX0, Width), GetTexelOrZero(Source1, TexelX, Width),
+            Draw->FractionX);
+    uint32 Result = LerpTexel(Row0, Row1, Draw->FractionY);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline uint32 BlendPixel(uint32 Dest, uint32 Source, blend_mode Mode)
+{
+    uint32 Result = Source;
+    switch (Mode)
+    {
+        case BlendMode_AlphaTest:
+        {
+            if ((Source >> 24) < 128)
+            {
+                Result = Dest;
+            }
+        } break;
+
+        case BlendMode_AlphaBlend:
+        {
+            uint32 InvAlpha = 255 - (Source >> 24);
+            Result = 0;
+            for (int Shift = 0; Shift < 32; Shift += 8)
+            {
+                uint32 Channel = ((Source >> Shift) & 0xFF) + MultiplyDivide255((Dest >> Shift) & 0xFF, InvAlpha);
+                if (Channel > 255)
+                {
+                    Channel = 255;
+                }
+                Result |= Channel << Shift;
+            }
+        } break;
+
+        case BlendMode_AlphaBlendSRGB:
+        {
+            real32 Inv255 = 1.0f / 255.0f;
+            real32 SourceAlpha = (real32)(Source >> 24) * Inv255;
+            real32 InvAlpha = 1.0f - SourceAlpha;
+            Result = 0;
+            for (int Shift = 0; Shift < 24; Shift += 8)
+            {
+                real32 SourceLinear = (real32)((Source >> Shift) & 0xFF) * Inv255;
+                SourceLinear = SourceLinear * SourceLinear;
+                real32 DestLinear = (real32)((Dest >> Shift) & 0xFF) * Inv255;
+                DestLinear = DestLinear * DestLinear;
+
+                real32 Channel = sqrtf(SourceLinear + DestLinear * InvAlpha) * 255.0f + 0.5f;
+                if (Channel > 255.0f)
+                {
+                    Channel = 255.0f;
+                }
+                Result |= (uint32)Channel << Shift;
+            }
+
+            real32 Alpha = (SourceAlpha + ((real32)(Dest >> 24) * Inv255) * InvAlpha) * 255.0f + 0.5f;
+            if (Alpha > 255.0f)
+            {
+                Alpha = 255.0f;
+            }
+            Result |= (uint32)Alpha << 24;
+        } break;
+
+        default:
+        {
+        } break;
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline uint32 *GetBitmapRowOrZero(loaded_bitmap *Bitmap, int Y)
+{
+    //NOTE: Rows off the top or bottom of the bitmap come back as 0 and read as transparent.
+    uint32 *Result = 0;
+    if ((Y >= 0) && (Y < Bitmap->Height))
+    {
+        Result = (uint32 *)((uint8 *)Bitmap->Memory + Y * Bitmap->Pitch);
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void GetInnerBitmapSpan(bitmap_draw *Draw, int MinX, int MaxX, int *InnerMinX, int *InnerMaxX)
+{
+    //NOTE: The columns where both horizontal taps land inside the bitmap, so they can be read without bounds checks.
+    int Min = Draw->OriginX + (Draw->FractionX ? 1 : 0);
+    int Max = Draw->OriginX + Draw->Bitmap->Width;
+    *InnerMinX = (Min < MinX) ? MinX : ((Min > MaxX) ? MaxX : Min);
+    *InnerMaxX = (Max > MaxX) ? MaxX : Max;
+}
+
+// =====================================================================================================================
+//NOTE: Scalar kernels. These are the reference everything else has to match bit for bit.
+
+internal FILL_RECTANGLE_KERNEL(FillRectangleScalar)
+{
+    uint8 *Row = (uint8 *)Buffer->Memory + MinX * Buffer->BytesPerPixel + MinY * Buffer->Pitch;
+    for (int Y = MinY; Y < MaxY; ++Y)
+    {
+        uint32 *Pixel = (uint32 *)Row;
+        for (int X = MinX; X < MaxX; ++X)
+        {
+            *Pixel++ = Color;
+        }
+        Row += Buffer->Pitch;
+    }
+}
+
+internal WEIRD_GRADIENT_KERNEL(RenderWeirdGradientScalar)
+{
+    uint8 *Row = (uint8 *)Buffer->Memory + MinX * Buffer->BytesPerPixel + MinY * Buffer->Pitch;
+    for (int Y = MinY; Y < MaxY; ++Y)
+    {
+        uint32 *Pixel = (uint32 *)Row;
+        for (int X = MinX; X < MaxX; ++X)
+        {
+            // Pixel Layout in Memory = BB GG RR xx
+            // Register value = xx RR GG BB
+            uint8 B = (uint8)(X + BlueOffset);
+            uint8 G = (uint8)(Y + GreenOffset);
+
+            *Pixel++ = ((G << 8) | B); // Blue assigned to smallest 2 bytes (uint8), Green moved left to its position.
+        }
+        Row += Buffer->Pitch;
+    }
+}
+
+internal DRAW_BITMAP_KERNEL(DrawBitmapScalar)
+{
+    loaded_bitmap *Bitmap = Draw->Bitmap;
+    blend_mode Mode = Draw->Mode;
+    bool32 Filtered = (Draw->FractionX || Draw->FractionY);
+    int TapX = Draw->FractionX ? 1 : 0;
+    int TapY = Draw->FractionY ? 1 : 0;
+
+    int InnerMinX;
+    int InnerMaxX;
+    GetInnerBitmapSpan(Draw, MinX, MaxX, &InnerMinX, &InnerMaxX);
+
+    uint8 *Row = (uint8 *)Buffer->Memory + MinY * Buffer->Pitch;
+    for (int Y = MinY; Y < MaxY; ++Y)
+    {
+        uint32 *Pixel = (uint32 *)Row;
+        int X = MinX;
+        uint32 *Source0 = GetBitmapRowOrZero(Bitmap, Y - Draw->OriginY - TapY);
+        uint32 *Source1 = GetBitmapRowOrZero(Bitmap, Y - Draw->OriginY);
+        for (; X < InnerMinX; ++X)
+        {
+            Pixel[X] = BlendPixel(Pixel[X], SampleBitmap(Draw, Source0, Source1, X - Draw->OriginX), Mode);
+        }
+        for (; X < InnerMaxX; ++X)
+        {
+            int TexelX = X - Draw->OriginX;
+            uint32 Texel;
+            if (Filtered)
+            {
+                uint32 Row0 = Source0 ? LerpTexel(Source0[TexelX - TapX], Source0[TexelX], Draw->FractionX) : 0;
+                uint32 Row1 = Source1 ? LerpTexel(Source1[TexelX - TapX], Source1[TexelX], Draw->FractionX) : 0;
+                Texel = LerpTexel(Row0, Row1, Draw->FractionY);
+            }
+            else
+            {
+                Texel = Source1[TexelX];
+            }
+            Pixel[X] = BlendPixel(Pixel[X], Texel, Mode);
+        }
+        for (; X < MaxX; ++X)
+        {
+            Pixel[X] = BlendPixel(Pixel[X], SampleBitmap(Draw, Source0, Source1, X - Draw->OriginX), Mode);
+        }
+        Row += Buffer->Pitch;
+    }
+}
+
+internal BLEND_RECTANGLE_KERNEL(BlendRectangleScalar)
+{
+    uint8 *Row = (uint8 *)Buffer->Memory + MinX * Buffer->BytesPerPixel + MinY * Buffer->Pitch;
+    for (int Y = MinY; Y < MaxY; ++Y)
+    {
+        uint32 *Pixel = (uint32 *)Row;
+        for (int X = MinX; X < MaxX; ++X)
+        {
+            *Pixel = BlendPixel(*Pixel, Color, Mode);
+            ++Pixel;
+        }
+        Row += Buffer->Pitch;
+    }
+}
+
+// =====================================================================================================================
+//NOTE: SSE2 kernels, 4 pixels per store. SSE2 is part of x64 so these need no target attributes.
+
+internal FILL_RECTANGLE_KERNEL(FillRectangleSSE2)
+{
+    __m128i Color4x = _mm_set1_epi32((int)Color);
+
+    uint8 *Row = (uint8 *)Buffer->Memory + MinX * Buffer->BytesPerPixel + MinY * Buffer->Pitch;
+    for (int Y = MinY; Y < MaxY; ++Y)
+    {
+        uint32 *Pixel = (uint32 *)Row;
+        int X = MinX;
+        for (; (X + 4) <= MaxX; X += 4)
+        {
+            _mm_storeu_si128((__m128i *)Pixel, Color4x);
+            Pixel += 4;
+        }
+        for (; X < MaxX; ++X)
+        {
+            *Pixel++ = Color;
+        }
+        Row += Buffer->Pitch;
+    }
+}
+
+internal WEIRD_GRADIENT_KERNEL(RenderWeirdGradientSSE2)
+{
+    __m128i ByteMask = _mm_set1_epi32(0xFF);
+    __m128i Four = _mm_set1_epi32(4);
+    __m128i StartBlue = _mm_setr_epi32(MinX + BlueOffset, MinX + 1 + BlueOffset,
+            MinX + 2 + BlueOffset, MinX + 3 + BlueOffset);
+
+    uint8 *Row = (uint8 *)Buffer->Memory + MinX * Buffer->BytesPerPixel + MinY * Buffer->Pitch;
+    for (int Y = MinY; Y < MaxY; ++Y)
+    {
+        uint32 Green = (uint32)(uint8)(Y + GreenOffset) << 8;
+        __m128i Green4x = _mm_set1_epi32((int)Green);
+        __m128i Blue4x = StartBlue;
+
+        uint32 *Pixel = (uint32 *)Row;
+        int X = MinX;
+        for (; (X + 4) <= MaxX; X += 4)
+        {
+            __m128i Out = _mm_or_si128(_mm_and_si128(Blue4x, ByteMask), Green4x);
+            _mm_storeu_si128((__m128i *)Pixel, Out);
+            Blue4x = _mm_add_epi32(Blue4x, Four);
+            Pixel += 4;
+        }
+        for (; X < MaxX; ++X)
+        {
+            *Pixel++ = Green | (uint8)(X + BlueOffset);
+        }
+        Row += Buffer->Pitch;
+    }
+}
+
+inline __m128i MultiplyDivide255SSE2(__m128i A, __m128i B)
+{
+    //NOTE: 16-bit lanes; same rounding as MultiplyDivide255.
+    __m128i T = _mm_add_epi16(_mm_mullo_epi16(A, B), _mm_set1_epi16(128));
+    __m128i Result = _mm_srli_epi16(_mm_add_epi16(T, _mm_srli_epi16(T, 8)), 8);
+    return(Result);
+}
+
+inline __m128i LerpTexelsSSE2(__m128i A, __m128i B, __m128i WeightA, __m128i WeightB)
+{
+    //NOTE: A * WeightA + B * WeightB tops out at 255 * 256, so the 16-bit lanes never wrap.
+    __m128i Zero = _mm_setzero_si128();
+    __m128i Half = _mm_set1_epi16(128);
+    __m128i Lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(A, Zero), WeightA),
+            _mm_mullo_epi16(_mm_unpacklo_epi8(B, Zero), WeightB));
+    __m128i Hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(A, Zero), WeightA),
+            _mm_mullo_epi16(_mm_unpackhi_epi8(B, Zero), WeightB));
+    Lo = _mm_srli_epi16(_mm_add_epi16(Lo, Half), 8);
+    Hi = _mm_srli_epi16(_mm_add_epi16(Hi, Half), 8);
+    __m128i Result = _mm_packus_epi16(Lo, Hi);
+    return(Result);
+}
+
+inline __m128 GetLinearChannelSSE2(__m128i Pixels, __m128 Inv255)
+{
+    //NOTE: Pixels holds one 8-bit channel in the bottom of each lane.
+    __m128 Result = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(Pixels, _mm_set1_epi32(0xFF))), Inv255);
+    Result = _mm_mul_ps(Result, Result);
+    return(Result);
+}
+
+inline __m128i PackLinearChannelSSE2(__m128 Source, __m128 Dest, __m128 InvAlpha)
+{
+    __m128 Channel = _mm_add_ps(_mm_mul_ps(_mm_sqrt_ps(_mm_add_ps(Source, _mm_mul_ps(Dest, InvAlpha))),
+                _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f));
+    __m128i Result = _mm_cvttps_epi32(_mm_min_ps(Channel, _mm_set1_ps(255.0f)));
+    return(Result);
+}
+
+inline __m128i BlendSRGBSSE2(__m128i Dest, __m128i Source)
+{
+    __m128 Inv255 = _mm_set1_ps(1.0f / 255.0f);
+    __m128 SourceAlpha = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(Source, 24)), Inv255);
+    __m128 InvAlpha = _mm_sub_ps(_mm_set1_ps(1.0f), SourceAlpha);
+
+    __m128i B = PackLinearChannelSSE2(GetLinearChannelSSE2(Source, Inv255),
+            GetLinearChannelSSE2(Dest, Inv255), InvAlpha);
+    __m128i G = PackLinearChannelSSE2(GetLinearChannelSSE2(_mm_srli_epi32(Source, 8), Inv255),
+            GetLinearChannelSSE2(_mm_srli_epi32(Dest, 8), Inv255), InvAlpha);
+    __m128i R = PackLinearChannelSSE2(GetLinearChannelSSE2(_mm_srli_epi32(Source, 16), Inv255),
+            GetLinearChannelSSE2(_mm_srli_epi32(Dest, 16), Inv255), InvAlpha);
+
+    __m128 DestAlpha = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(Dest, 24)), Inv255);
+    __m128 Alpha = _mm_add_ps(_mm_mul_ps(_mm_add_ps(SourceAlpha, _mm_mul_ps(DestAlpha, InvAlpha)),
+                _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f));
+    __m128i A = _mm_cvttps_epi32(_mm_min_ps(Alpha, _mm_set1_ps(255.0f)));
+
+    __m128i Result = _mm_or_si128(_mm_or_si128(B, _mm_slli_epi32(G, 8)),
+            _mm_or_si128(_mm_slli_epi32(R, 16), _mm_slli_epi32(A, 24)));
+    return(Result);
+}
+
+inline __m128i BlendPixelsSSE2(__m128i Dest, __m128i Source, blend_mode Mode)
+{
+    __m128i Result = Source;
+    switch (Mode)
+    {
+        case BlendMode_AlphaTest:
+        {
+            __m128i Mask = _mm_cmpgt_epi32(_mm_srli_epi32(Source, 24), _mm_set1_epi32(127));
+            Result = _mm_or_si128(_mm_and_si128(Mask, Source), _mm_andnot_si128(Mask, Dest));
+        } break;
+
+        case BlendMode_AlphaBlend:
+        {
+            __m128i Zero = _mm_setzero_si128();
+            __m128i Max = _mm_set1_epi16(255);
+            __m128i SourceLo = _mm_unpacklo_epi8(Source, Zero);
+            __m128i SourceHi = _mm_unpackhi_epi8(Source, Zero);
+            __m128i AlphaLo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(SourceLo, 0xFF), 0xFF);
+            __m128i InvAlphaLo = _mm_sub_epi16(Max, AlphaLo);
+            __m128i AlphaHi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(SourceHi, 0xFF), 0xFF);
+            __m128i InvAlphaHi = _mm_sub_epi16(Max, AlphaHi);
+            __m128i Lo = MultiplyDivide255SSE2(_mm_unpacklo_epi8(Dest, Zero), InvAlphaLo);
+            __m128i Hi = MultiplyDivide255SSE2(_mm_unpackhi_epi8(Dest, Zero), InvAlphaHi);
+            Result = _mm_adds_epu8(Source, _mm_packus_epi16(Lo, Hi));
+        } break;
+
+        case BlendMode_AlphaBlendSRGB:
+        {
+            Result = BlendSRGBSSE2(Dest, Source);
+        } break;
+
+        default:
+        {
+        } break;
+    }
+    return(Result);
+}
+
+internal DRAW_BITMAP_KERNEL(DrawBitmapSSE2)
+{
+    loaded_bitmap *Bitmap = Draw->Bitmap;
+    blend_mode Mode = Draw->Mode;
+    bool32 Filtered = (Draw->FractionX || Draw->FractionY);
+    int TapX = Draw->FractionX ? 1 : 0;
+    int TapY = Draw->FractionY ? 1 : 0;
+    __m128i Zero = _mm_setzero_si128();
+    __m128i WeightAX = _mm_set1_epi16((short)Draw->FractionX);
+    __m128i WeightBX = _mm_set1_epi16((short)(256 - Draw->FractionX));
+    __m128i WeightAY = _mm_set1_epi16((short)Draw->FractionY);
+    __m128i WeightBY = _mm_set1_epi16((short)(256 - Draw->FractionY));
+
+    int InnerMinX;
+    int InnerMaxX;
+    GetInnerBitmapSpan(Draw, MinX, MaxX, &InnerMinX, &InnerMaxX);
+
+    uint8 *Row = (uint8 *)Buffer->Memory + MinY * Buffer->Pitch;
+    for (int Y = MinY; Y < MaxY; ++Y)
+    {
+        uint32 *Pixel = (uint32 *)Row;
+        int X = MinX;
+        uint32 *Source0 = GetBitmapRowOrZero(Bitmap, Y - Draw->OriginY - TapY);
+        uint32 *Source1 = GetBitmapRowOrZero(Bitmap, Y - Draw->OriginY);
+        for (; X < InnerMinX; ++X)
+        {
+            Pixel[X] = BlendPixel(Pixel[X], SampleBitmap(Draw, Source0, Source1, X - Draw->OriginX), Mode);
+        }
+        for (; (X + 4) <= InnerMaxX; X += 4)
+        {
+            int TexelX = X - Draw->OriginX;
+            __m128i Texels;
+            if (Filtered)
+            {
+                __m128i Row0 = Zero;
+                __m128i Row1 = Zero;
+                if (Source0)
+                {
+                    Row0 = LerpTexelsSSE2(_mm_loadu_si128((__m128i *)(Source0 + TexelX - TapX)),
+                            _mm_loadu_si128((__m128i *)(Source0 + TexelX)), WeightAX, WeightBX);
+                }
+                if (Source1)
+                {
+                    Row1 = LerpTexelsSSE2(_mm_loadu_si128((__m128i *)(Source1 + TexelX - TapX)),
+                            _mm_loadu_si128((__m128i *)(Source1 + TexelX)), WeightAX, WeightBX);
+                }
+                Texels = LerpTexelsSSE2(Row0, Row1, WeightAY, WeightBY);
+            }
+            else
+            {
+                Texels = _mm_loadu_si128((__m128i *)(Source1 + TexelX));
+            }
+            __m128i Dest = _mm_loadu_si128((__m128i *)(Pixel + X));
+            _mm_storeu_si128((__m128i *)(Pixel + X), BlendPixelsSSE2(Dest, Texels, Mode));
+        }
+        for (; X < MaxX; ++X)
+        {
+            Pixel[X] = BlendPixel(Pixel[X], SampleBitmap(Draw, Source0, Source1, X - Draw->OriginX), Mode);
+        }
+        Row += Buffer->Pitch;
+    }
+}
+
+internal BLEND_RECTANGLE_KERNEL(BlendRectangleSSE2)
+{
+    __m128i Color4x = _mm_set1_epi32((int)Color);
+
+    uint8 *Row = (uint8 *)Buffer->Memory + MinX * Buffer->BytesPerPixel + MinY * Buffer->Pitch;
+    for (int Y = MinY; Y < MaxY; ++Y)
+    {
+        uint32 *Pixel = (uint32 *)Row;
+        int X = MinX;
+        for (; (X + 4) <= MaxX; X += 4)
+        {
+            __m128i Dest = _mm_loadu_si128((__m128i *)Pixel);
+            _mm_storeu_si128((__m128i *)Pixel, BlendPixelsSSE2(Dest, Color4x, Mode));
+            Pixel += 4;
+        }
+        for (; X < MaxX; ++X)
+        {
+            *Pixel = BlendPixel(*Pixel, Color, Mode);
+            ++Pixel;
+        }
+        Row += Buffer->Pitch;
+    }
+}
+
+// =====================================================================================================================
+//NOTE: AVX2 kernels, 8 pixels per store.
+
+internal HANDMADE_TARGET_AVX2 FILL_RECTANGLE_KERNEL(FillRectangleAVX2)
+{
+    __m256i Color8x = _mm256_set1_epi32((int)Color);
+
+    uint8 *Row = (uint8 *)Buffer->Memory + MinX * Buffer->BytesPerPixel + MinY * Buffer->Pitch;
+    for (int Y = MinY; Y < MaxY; ++Y)
+    {
+        uint32 *Pixel = (uint32 *)Row;
+        int X = MinX;
+        for (; (X + 8) <= MaxX; X += 8)
+        {
+            _mm256_storeu_si256((__m256i *)Pixel, Color8x);
+            Pixel += 8;
+        }
+        for (; X < MaxX; ++X)
+        {
+            *Pixel++ = Color;
+        }
+        Row += Buffer->Pitch;
+    }
+}
+
+internal HANDMADE_TARGET_AVX2 WEIRD_GRADIENT_KERNEL(RenderWeirdGradientAVX2)
+{
+    __m256i ByteMask = _mm256_set1_epi32(0xFF);
+    __m256i Eight = _mm256_set1_epi32(8);
+    __m256i StartBlue = _mm256_add_epi32(_mm256_set1_epi32(MinX + BlueOffset),
+            _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+
+    uint8 *Row = (uint8 *)Buffer->Memory + MinX * Buffer->BytesPerPixel + MinY * Buffer->Pitch;
+    for (int Y = MinY; Y < MaxY; ++Y)
+    {
+        uint32 Green = (uint32)(uint8)(Y + GreenOffset) << 8;
+        __m256i Green8x = _mm256_set1_epi32((int)Green);
+        __m256i Blue8x = StartBlue;
+
+        uint32 *Pixel = (uint32 *)Row;
+        int X = MinX;
+        for (; (X + 8) <= MaxX; X += 8)
+        {
+            __m256i Out = _mm256_or_si256(_mm256_and_si256(Blue8x, ByteMask), Green8x);
+            _mm256_storeu_si256((__m256i *)Pixel, Out);
+            Blue8x = _mm256_add_epi32(Blue8x, Eight);
+            Pixel += 8;
+        }
+        for (; X < MaxX; ++X)
+        {
+            *Pixel++ = Green | (uint8)(X + BlueOffset);
+        }
+        Row += Buffer->Pitch;
+    }
+}
+
+inline HANDMADE_TARGET_AVX2 __m256i MultiplyDivide255AVX2(__m256i A, __m256i B)
+{
+    __m256i T = _mm256_add_epi16(_mm256_mullo_epi16(A, B), _mm256_set1_epi16(128));
+    __m256i Result = _mm256_srli_epi16(_mm256_add_epi16(T, _mm256_srli_epi16(T, 8)), 8);
+    return(Result);
+}
+
+inline HANDMADE_TARGET_AVX2 __m256i LerpTexelsAVX2(__m256i A, __m256i B, __m256i WeightA, __m256i WeightB)
+{
+    __m256i Zero = _mm256_setzero_si256();
+    __m256i Half = _mm256_set1_epi16(128);
+    __m256i Lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(A, Zero), WeightA),
+            _mm256_mullo_epi16(_mm256_unpacklo_epi8(B, Zero), WeightB));
+    __m256i Hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(A, Zero), WeightA),
+            _mm256_mullo_epi16(_mm256_unpackhi_epi8(B, Zero), WeightB));
+    Lo = _mm256_srli_epi16(_mm256_add_epi16(Lo, Half), 8);
+    Hi = _mm256_srli_epi16(_mm256_add_epi16(Hi, Half), 8);
+    __m256i Result = _mm256_packus_epi16(Lo, Hi);
+    return(Result);
+}
+
+inline HANDMADE_TARGET_AVX2 __m256 GetLinearChannelAVX2(__m256i Pixels, __m256 Inv255)
+{
+    __m256 Result = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(Pixels, _mm256_set1_epi32(0xFF))), Inv255);
+    Result = _mm256_mul_ps(Result, Result);
+    return(Result);
+}
+
+inline HANDMADE_TARGET_AVX2 __m256i PackLinearChannelAVX2(__m256 Source, __m256 Dest, __m256 InvAlpha)
+{
+    __m256 Channel = _mm256_add_ps(_mm256_mul_ps(_mm256_sqrt_ps(_mm256_add_ps(Source, _mm256_mul_ps(Dest, InvAlpha))),
+                _mm256_set1_ps(255.0f)), _mm256_set1_ps(0.5f));
+    __m256i Result = _mm256_cvttps_epi32(_mm256_min_ps(Channel, _mm256_set1_ps(255.0f)));
+    return(Result);
+}
+
+inline HANDMADE_TARGET_AVX2 __m256i BlendSRGBAVX2(__m256i Dest, __m256i Source)
+{
+    __m256 Inv255 = _mm256_set1_ps(1.0f / 255.0f);
+    __m256 SourceAlpha = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(Source, 24)), Inv255);
+    __m256 InvAlpha = _mm256_sub_ps(_mm256_set1_ps(1.0f), SourceAlpha);
+
+    __m256i B = PackLinearChannelAVX2(GetLinearChannelAVX2(Source, Inv255),
+            GetLinearChannelAVX2(Dest, Inv255), InvAlpha);
+    __m256i G = PackLinearChannelAVX2(GetLinearChannelAVX2(_mm256_srli_epi32(Source, 8), Inv255),
+            GetLinearChannelAVX2(_mm256_srli_epi32(Dest, 8), Inv255), InvAlpha);
+    __m256i R = PackLinearChannelAVX2(GetLinearChannelAVX2(_mm256_srli_epi32(Source, 16), Inv255),
+            GetLinearChannelAVX2(_mm256_srli_epi32(Dest, 16), Inv255), InvAlpha);
+
+    __m256 DestAlpha = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(Dest, 24)), Inv255);
+    __m256 Alpha = _mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(SourceAlpha, _mm256_mul_ps(DestAlpha, InvAlpha)),
+                _mm256_set1_ps(255.0f)), _mm256_set1_ps(0.5f));
+    __m256i A = _mm256_cvttps_epi32(_mm256_min_ps(Alpha, _mm256_set1_ps(255.0f)));
+
+    __m256i Result = _mm256_or_si256(_mm256_or_si256(B, _mm256_slli_epi32(G, 8)),
+            _mm256_or_si256(_mm256_slli_epi32(R, 16), _mm256_slli_epi32(A, 24)));
+    return(Result);
+}
+
+inline HANDMADE_TARGET_AVX2 __m256i BlendPixelsAVX2(__m256i Dest, __m256i Source, blend_mode Mode)
+{
+    __m256i Result = Source;
+    switch (Mode)
+    {
+        case BlendMode_AlphaTest:
+        {
+            __m256i Mask = _mm256_cmpgt_epi32(_mm256_srli_epi32(Source, 24), _mm256_set1_epi32(127));
+            Result = _mm256_or_si256(_mm256_and_si256(Mask, Source), _mm256_andnot_si256(Mask, Dest));
+        } break;
+
+        case BlendMode_AlphaBlend:
+        {
+            __m256i Zero = _mm256_setzero_si256();
+            __m256i Max = _mm256_set1_epi16(255);
+            __m256i SourceLo = _mm256_unpacklo_epi8(Source, Zero);
+            __m256i SourceHi = _mm256_unpackhi_epi8(Source, Zero);
+            __m256i AlphaLo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(SourceLo, 0xFF), 0xFF);
+            __m256i InvAlphaLo = _mm256_sub_epi16(Max, AlphaLo);
+            __m256i AlphaHi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(SourceHi, 0xFF), 0xFF);
+            __m256i InvAlphaHi = _mm256_sub_epi16(Max, AlphaHi);
+            __m256i Lo = MultiplyDivide255AVX2(_mm256_unpacklo_epi8(Dest, Zero), InvAlphaLo);
+            __m256i Hi = MultiplyDivide255AVX2(_mm256_unpackhi_epi8(Dest, Zero), InvAlphaHi);
+            Result = _mm256_adds_epu8(Source, _mm256_packus_epi16(Lo, Hi));
+        } break;
+
+        case BlendMode_AlphaBlendSRGB:
+        {
+            Result = BlendSRGBAVX2(Dest, Source);
+        } break;
+
+        default:
+        {
+        } break;
+    }
+    return(Result);
+}
+
+internal HANDMADE_TARGET_AVX2 DRAW_BITMAP_KERNEL(DrawBitmapAVX2)
+{
+    loaded_bitmap *Bitmap = Draw->Bitmap;
+    blend_mode Mode = Draw->Mode;
+    bool32 Filtered = (Draw->FractionX || Draw->FractionY);
+    int TapX = Draw->FractionX ? 1 : 0;
+    int TapY = Draw->FractionY ? 1 : 0;
+    __m256i Zero = _mm256_setzero_si256();
+    __m256i WeightAX = _mm256_set1_epi16((short)Draw->FractionX);
+    __m256i WeightBX = _mm256_set1_epi16((short)(256 - Draw->FractionX));
+    __m256i WeightAY = _mm256_set1_epi16((short)Draw->FractionY);
+    __m256i WeightBY = _mm256_set1_epi16((short)(256 - Draw->FractionY));
+
+    int InnerMinX;
+    int InnerMaxX;
+    GetInnerBitmapSpan(Draw, MinX, MaxX, &InnerMinX, &InnerMaxX);
+
+    uint8 *Row = (uint8 *)Buffer->Memory + MinY * Buffer->Pitch;
+    for (int Y = MinY; Y < MaxY; ++Y)
+    {
+        uint32 *Pixel = (uint32 *)Row;
+        int X = MinX;
+        uint32 *Source0 = GetBitmapRowOrZero(Bitmap, Y - Draw->OriginY - TapY);
+        uint32 *Source1 = GetBitmapRowOrZero(Bitmap, Y - Draw->OriginY);
+        for (; X < InnerMinX; ++X)
+        {
+            Pixel[X] = BlendPixel(Pixel[X], SampleBitmap(Draw, Source0, Source1, X - Draw->OriginX), Mode);
+        }
+        for (; (X + 8) <= InnerMaxX; X += 8)
+        {
+            int TexelX = X - Draw->OriginX;
+            __m256i Texels;
+            if (Filtered)
+            {
+                __m256i Row0 = Zero;
+                __m256i Row1 = Zero;
+                if (Source0)
+                {
+                    Row0 = LerpTexelsAVX2(_mm256_loadu_si256((__m256i *)(Source0 + TexelX - TapX)),
+                            _mm256_loadu_si256((__m256i *)(Source0 + TexelX)), WeightAX, WeightBX);
+                }
+                if (Source1)
+                {
+                    Row1 = LerpTexelsAVX2(_mm256_loadu_si256((__m256i *)(Source1 + TexelX - TapX)),
+                            _mm256_loadu_si256((__m256i *)(Source1 + TexelX)), WeightAX, WeightBX);
+                }
+                Texels = LerpTexelsAVX2(Row0, Row1, WeightAY, WeightBY);
+            }
+            else
+            {
+                Texels = _mm256_loadu_si256((__m256i *)(Source1 + TexelX));
+            }
+            __m256i Dest = _mm256_loadu_si256((__m256i *)(Pixel + X));
+            _mm256_storeu_si256((__m256i *)(Pixel + X), BlendPixelsAVX2(Dest, Texels, Mode));
+        }
+        for (; X < MaxX; ++X)
+        {
+            Pixel[X] = BlendPixel(Pixel[X], SampleBitmap(Draw, Source0, Source1, X - Draw->OriginX), Mode);
+        }
+        Row += Buffer->Pitch;
+    }
+}
+
+internal HANDMADE_TARGET_AVX2 BLEND_RECTANGLE_KERNEL(BlendRectangleAVX2)
+{
+    __m256i Color8x = _mm256_set1_epi32((int)Color);
+
+    uint8 *Row = (uint8 *)Buffer->Memory + MinX * Buffer->BytesPerPixel + MinY * Buffer->Pitch;
+    for (int Y = MinY; Y < MaxY; ++Y)
+    {
+        uint32 *Pixel = (uint32 *)Row;
+        int X = MinX;
+        for (; (X + 8) <= MaxX; X += 8)
+        {
+            __m256i Dest = _mm256_loadu_si256((__m256i *)Pixel);
+            _mm256_storeu_si256((__m256i *)Pixel, BlendPixelsAVX2(Dest, Color8x, Mode));
+            Pixel += 8;
+        }
+        for (; X < MaxX; ++X)
+        {
+            *Pixel = BlendPixel(*Pixel, Color, Mode);
+            ++Pixel;
+        }
+        Row += Buffer->Pitch;
+    }
+}
+
+// =====================================================================================================================
+
+internal render_kernels GetRenderKernels(render_kernel_level Level)
+{
+    render_kernels Result = {};
+    Result.Level = Level;
+    switch (Level)
+    {
+        case RenderKernel_AVX2:
+        {
+            Result.FillRectangle = FillRectangleAVX2;
+            Result.RenderWeirdGradient = RenderWeirdGradientAVX2;
+            Result.DrawBitmap = DrawBitmapAVX2;
+            Result.BlendRectangle = BlendRectangleAVX2;
+        } break;
+
+        case RenderKernel_SSE2:
+        {
+            Result.FillRectangle = FillRectangleSSE2;
+            Result.RenderWeirdGradient = RenderWeirdGradientSSE2;
+            Result.DrawBitmap = DrawBitmapSSE2;
+            Result.BlendRectangle = BlendRectangleSSE2;
+        } break;
+
+        default:
+        {
+            Result.Level = RenderKernel_Scalar;
+            Result.FillRectangle = FillRectangleScalar;
+            Result.RenderWeirdGradient = RenderWeirdGradientScalar;
+            Result.DrawBitmap = DrawBitmapScalar;
+            Result.BlendRectangle = BlendRectangleScalar;
+        } break;
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal render_kernel_level GetBestRenderKernelLevel(void)
+{
+    cpu_features Features = GetCPUFeatures();
+
+    render_kernel_level Result = RenderKernel_Scalar;
+    if (Features.AVX2)
+    {
+        Result = RenderKernel_AVX2;
+    }
+    else if (Features.SSE2)
+    {
+        Result = RenderKernel_SSE2;
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 IsRenderKernelLevelSupported(render_kernel_level Level)
+{
+    bool32 Result = (Level <= GetBestRenderKernelLevel());
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void SetRenderKernelLevel(render_kernel_level Level)
+{
+    Assert(IsRenderKernelLevelSupported(Level));
+    GlobalRenderKernels = GetRenderKernels(Level);
+}
+
+// =====================================================================================================================
+
+inline render_kernels *GetActiveRenderKernels(void)
+{
+    //NOTE: Picked lazily so that whoever draws first gets the CPUID check done for them.
+    if (!GlobalRenderKernels.FillRectangle)
+    {
+        GlobalRenderKernels = GetRenderKernels(GetBestRenderKernelLevel());
+    }
+    return(&GlobalRenderKernels);
+}
+
+// =====================================================================================================================
+
+internal char *GetRenderKernelLevelName(render_kernel_level Level)
+{
+    char *Result = (char *)"Scalar";
+    if (Level == RenderKernel_SSE2)
+    {
+        Result = (char *)"SSE2";
+    }
+    else if (Level == RenderKernel_AVX2)
+    {
+        Result = (char *)"AVX2";
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void FillRectangle(game_offscreen_buffer *Buffer, int MinX, int MinY, int MaxX, int MaxY, uint32 Color)
+{
+    rectangle2i Clip = ClipRectangle(Buffer, MinX, MinY, MaxX, MaxY);
+    if (HasArea(Clip))
+    {
+        GetActiveRenderKernels()->FillRectangle(Buffer, Clip.MinX, Clip.MinY, Clip.MaxX, Clip.MaxY, Color);
+    }
+}
+
+// =====================================================================================================================
+
+internal void ClearBuffer(game_offscreen_buffer *Buffer, uint32 Color)
+{
+    FillRectangle(Buffer, 0, 0, Buffer->Width, Buffer->Height, Color);
+}
+
+// =====================================================================================================================
+
+inline int SnapToPixel(real32 Value, int Max)
+{
+    //NOTE: A pixel is inside an edge when its center is, so an edge at Value lands on the pixel boundary nearest to it.
+    //  Clamped before the conversion so coordinates far off the buffer can't overflow it.
+    real32 Edge = Value - 0.5f;
+    int Result = 0;
+    if (Edge > (real32)Max)
+    {
+        Result = Max;
+    }
+    else if (Edge > 0.0f)
+    {
+        Result = (int)ceilf(Edge);
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline uint32 PackPremultipliedColor(color4 Color)
+{
+    real32 A = (Color.A < 0.0f) ? 0.0f : ((Color.A > 1.0f) ? 1.0f : Color.A);
+    real32 R = (Color.R < 0.0f) ? 0.0f : ((Color.R > 1.0f) ? 1.0f : Color.R);
+    real32 G = (Color.G < 0.0f) ? 0.0f : ((Color.G > 1.0f) ? 1.0f : Color.G);
+    real32 B = (Color.B < 0.0f) ? 0.0f : ((Color.B > 1.0f) ? 1.0f : Color.B);
+
+    uint32 Result = (((uint32)(A * 255.0f + 0.5f) << 24) |
+                     ((uint32)(R * A * 255.0f + 0.5f) << 16) |
+                     ((uint32)(G * A * 255.0f + 0.5f) << 8) |
+                     ((uint32)(B * A * 255.0f + 0.5f) << 0));
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal rectangle2i GetRectanglePixels(int Width, int Height, real32 MinX, real32 MinY, real32 MaxX, real32 MaxY)
+{
+    rectangle2i Result;
+    Result.MinX = SnapToPixel(MinX, Width);
+    Result.MinY = SnapToPixel(MinY, Height);
+    Result.MaxX = SnapToPixel(MaxX, Width);
+    Result.MaxY = SnapToPixel(MaxY, Height);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void DrawRectangleClipped(game_offscreen_buffer *Buffer, rectangle2i ClipRect, real32 MinX, real32 MinY,
+        real32 MaxX, real32 MaxY, color4 Color, bool32 SRGB)
+{
+    rectangle2i Clip = IntersectRectangles(ClipRect,
+            GetRectanglePixels(Buffer->Width, Buffer->Height, MinX, MinY, MaxX, MaxY));
+
+    uint32 PackedColor = PackPremultipliedColor(Color);
+    uint32 Alpha = PackedColor >> 24;
+    if (HasArea(Clip) && (Alpha > 0))
+    {
+        render_kernels *Kernels = GetActiveRenderKernels();
+        if (Alpha == 255)
+        {
+            Kernels->FillRectangle(Buffer, Clip.MinX, Clip.MinY, Clip.MaxX, Clip.MaxY, PackedColor);
+        }
+        else
+        {
+            Kernels->BlendRectangle(Buffer, Clip.MinX, Clip.MinY, Clip.MaxX, Clip.MaxY, PackedColor,
+                    SRGB ? BlendMode_AlphaBlendSRGB : BlendMode_AlphaBlend);
+        }
+    }
+}
+
+// =====================================================================================================================
+
+internal void DrawRectangle(game_offscreen_buffer *Buffer, real32 MinX, real32 MinY, real32 MaxX, real32 MaxY,
+        color4 Color, bool32 SRGB)
+{
+    rectangle2i ClipRect = {0, 0, Buffer->Width, Buffer->Height};
+    DrawRectangleClipped(Buffer, ClipRect, MinX, MinY, MaxX, MaxY, Color, SRGB);
+}
+
+// =====================================================================================================================
+
+internal bitmap_draw MakeBitmapDraw(loaded_bitmap *Bitmap, real32 X, real32 Y, blend_mode Mode)
+{
+    //NOTE: Fractions are rounded to 1/256 of a pixel; one that rounds all the way up moves the origin over instead.
+    bitmap_draw Result = {};
+    Result.Bitmap = Bitmap;
+    Result.Mode = Mode;
+
+    real32 FloorX = floorf(X);
+    real32 FloorY = floorf(Y);
+    Result.OriginX = (int)FloorX;
+    Result.OriginY = (int)FloorY;
+    Result.FractionX = (uint32)((X - FloorX) * 256.0f + 0.5f);
+    Result.FractionY = (uint32)((Y - FloorY) * 256.0f + 0.5f);
+    if (Result.FractionX == 256)
+    {
+        ++Result.OriginX;
+        Result.FractionX = 0;
+    }
+    if (Result.FractionY == 256)
+    {
+        ++Result.OriginY;
+        Result.FractionY = 0;
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 GetBitmapPixels(int Width, int Height, loaded_bitmap *Bitmap, real32 X, real32 Y, blend_mode Mode,
+        bitmap_draw *Draw, rectangle2i *Pixels)
+{
+    //NOTE: Anything entirely off the target (or not a number) is rejected before it is converted to pixels.
+    bool32 Result = ((X < (real32)Width) && (X > -(real32)(Bitmap->Width + 1)) &&
+                     (Y < (real32)Height) && (Y > -(real32)(Bitmap->Height + 1)) &&
+                     (Bitmap->Width > 0) && (Bitmap->Height > 0));
+    if (Result)
+    {
+        *Draw = MakeBitmapDraw(Bitmap, X, Y, Mode);
+        rectangle2i Target = {0, 0, Width, Height};
+        rectangle2i Extent = {Draw->OriginX, Draw->OriginY,
+            Draw->OriginX + Bitmap->Width + (Draw->FractionX ? 1 : 0),
+            Draw->OriginY + Bitmap->Height + (Draw->FractionY ? 1 : 0)};
+        *Pixels = IntersectRectangles(Target, Extent);
+        Result = HasArea(*Pixels);
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void DrawBitmapClipped(game_offscreen_buffer *Buffer, rectangle2i ClipRect, loaded_bitmap *Bitmap,
+        real32 X, real32 Y, blend_mode Mode)
+{
+    bitmap_draw Draw;
+    rectangle2i Pixels;
+    if (GetBitmapPixels(Buffer->Width, Buffer->Height, Bitmap, X, Y, Mode, &Draw, &Pixels))
+    {
+        rectangle2i Clip = IntersectRectangles(ClipRect, Pixels);
+        if (HasArea(Clip))
+        {
+            GetActiveRenderKernels()->DrawBitmap(Buffer, Clip.MinX, Clip.MinY, Clip.MaxX, Clip.MaxY, &Draw);
+        }
+    }
+}
+
+// =====================================================================================================================
+
+internal void DrawBitmap(game_offscreen_buffer *Buffer, loaded_bitmap *Bitmap, real32 X, real32 Y, blend_mode Mode)
+{
+    rectangle2i ClipRect = {0, 0, Buffer->Width, Buffer->Height};
+    DrawBitmapClipped(Buffer, ClipRect, Bitmap, X, Y, Mode);
+}
+
+// =====================================================================================================================
+
+internal void RenderWeirdGradient(game_offscreen_buffer *Buffer, int BlueOffset, int GreenOffset)
+{
+    TIMED_FUNCTION((uint32)(Buffer->Width * Buffer->Height));
+    GetActiveRenderKernels()->RenderWeirdGradient(Buffer, 0, 0, Buffer->Width, Buffer->Height,
+            BlueOffset, GreenOffset);
+}
@@ -0,0 +1,94 @@
+#if !defined(HANDMADE_RENDER_H)
+#define HANDMADE_RENDER_H
+
+//NOTE: Pixel-fill kernels.
+//  Every primitive has a scalar, an SSE2 and an AVX2 version which must produce bit-identical output. The fastest one
+//  the CPU supports is picked the first time anything is drawn, and everything else goes through the table.
+//
+//  Rectangles are half-open in pixels: MinX/MinY are inclusive, MaxX/MaxY are exclusive. Kernels expect the rectangle
+//  to already be clipped to the buffer.
+
+enum render_kernel_level
+{
+    RenderKernel_Scalar,
+    RenderKernel_SSE2,
+    RenderKernel_AVX2,
+
+    RenderKernel_Count,
+};
+
+//NOTE: Same pixel layout as the offscreen buffer, BB GG RR AA, but with alpha premultiplied into the color channels.
+//  Memory usually points straight into the mapped asset file, so it must never be written through.
+struct loaded_bitmap
+{
+    int32 Width;
+    int32 Height;
+    int32 Pitch;
+    void *Memory;
+};
+
+//NOTE: Straight (not premultiplied) color, each channel 0 to 1.
+struct color4
+{
+    real32 R;
+    real32 G;
+    real32 B;
+    real32 A;
+};
+
+#define FILL_RECTANGLE_KERNEL(name) void name(game_offscreen_buffer *Buffer, int MinX, int MinY, int MaxX, int MaxY, \
+        uint32 Color)
+typedef FILL_RECTANGLE_KERNEL(fill_rectangle_kernel);
+
+#define WEIRD_GRADIENT_KERNEL(name) void name(game_offscreen_buffer *Buffer, int MinX, int MinY, int MaxX, int MaxY, \
+        int BlueOffset, int GreenOffset)
+typedef WEIRD_GRADIENT_KERNEL(weird_gradient_kernel);
+
+//NOTE: How a source pixel (premultiplied BB GG RR AA) lands on the buffer.
+//  Opaque copies it over whatever was there. AlphaTest copies it only where alpha is at least half. AlphaBlend is
+//  Source + Dest * (1 - SourceAlpha), in 8-bit integer math rounded to nearest. AlphaBlendSRGB is the same blend done
+//  in linear light: color channels are squared on the way in and square-rooted on the way out (gamma 2.0, close
+//  enough to sRGB that nobody can tell, and cheap enough to do 8 pixels at a time), all in single precision so every
+//  kernel level rounds identically.
+enum blend_mode
+{
+    BlendMode_Opaque,
+    BlendMode_AlphaTest,
+    BlendMode_AlphaBlend,
+    BlendMode_AlphaBlendSRGB,
+
+    BlendMode_Count,
+};
+
+//NOTE: Where a bitmap goes, already split into a whole-pixel origin and an 8-bit sub-pixel fraction per axis.
+//  With a fraction of 0 along an axis, destination pixel Origin + K is texel K. Otherwise the bitmap spills one pixel
+//  further, and destination pixel Origin + K is texel K - 1 weighted by Fraction/256 plus texel K weighted by the
+//  rest; texels off the edge of the bitmap are transparent.
+struct bitmap_draw
+{
+    loaded_bitmap *Bitmap;
+    int OriginX;
+    int OriginY;
+    uint32 FractionX;
+    uint32 FractionY;
+    blend_mode Mode;
+};
+
+#define DRAW_BITMAP_KERNEL(name) void name(game_offscreen_buffer *Buffer, int MinX, int MinY, int MaxX, int MaxY, \
+        bitmap_draw *Draw)
+typedef DRAW_BITMAP_KERNEL(draw_bitmap_kernel);
+
+#define BLEND_RECTANGLE_KERNEL(name) void name(game_offscreen_buffer *Buffer, int MinX, int MinY, int MaxX, int MaxY, \
+        uint32 Color, blend_mode Mode)
+typedef BLEND_RECTANGLE_KERNEL(blend_rectangle_kernel);
+
+struct render_kernels
+{
+    render_kernel_level Level;
+    fill_rectangle_kernel *FillRectangle;
+    weird_gradient_kernel *RenderWeirdGradient;
+    draw_bitmap_kernel *DrawBitmap;
+    blend_rectangle_kernel *BlendRectangle;
+};
+
+#endif
@@ -0,0 +1,478 @@
+internal render_group *AllocateRenderGroup(memory_arena *Arena, uint32 MaxPushBufferSize, int32 Width, int32 Height)
+{
+    //NOTE: The top of the push buffer has to line up with the sort entries that grow down from it.
+    MaxPushBufferSize -= MaxPushBufferSize % sizeof(render_sort_entry);
+
+    render_group *Result = PushStruct(Arena, render_group);
+    Result->Width = Width;
+    Result->Height = Height;
+    Result->PushBufferBase = (uint8 *)PushSize(Arena, MaxPushBufferSize, 64);
+    Result->MaxPushBufferSize = MaxPushBufferSize;
+    Result->PushBufferSize = 0;
+    Result->SortEntryCount = 0;
+    Result->CulledCommandCount = 0;
+    Result->DroppedCommandCount = 0;
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline render_sort_entry *GetSortEntries(render_group *Group)
+{
+    //NOTE: The most recently pushed entry is the lowest one in memory.
+    render_sort_entry *Result = (render_sort_entry *)(Group->PushBufferBase + Group->MaxPushBufferSize) -
+        Group->SortEntryCount;
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline uint32 GetRenderGroupBytesUsed(render_group *Group)
+{
+    uint32 Result = Group->PushBufferSize + Group->SortEntryCount * (uint32)sizeof(render_sort_entry);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+#define PushRenderCommand(Group, type, Layer, Bounds) \
+    (type *)PushRenderCommand_(Group, sizeof(type), RenderCommand_##type, Layer, Bounds)
+internal void *PushRenderCommand_(render_group *Group, uint32 Size, render_command_type Type, int32 Layer,
+        rectangle2i Bounds)
+{
+    void *Result = 0;
+
+    //NOTE: Every command is a multiple of 8 bytes so the next header stays aligned.
+    uint32 CommandSize = ((uint32)sizeof(render_command_header) + Size + 7) & ~7u;
+    uint32 SizeNeeded = GetRenderGroupBytesUsed(Group) + CommandSize + (uint32)sizeof(render_sort_entry);
+    if (!HasArea(Bounds))
+    {
+        ++Group->CulledCommandCount;
+    }
+    else if (SizeNeeded > Group->MaxPushBufferSize)
+    {
+        ++Group->DroppedCommandCount;
+    }
+    else
+    {
+        //NOTE: Zeroed so padding is always the same bytes, since tiles hash their commands whole (see
+        //  HashTileCommands).
+        render_command_header *Header = (render_command_header *)(Group->PushBufferBase + Group->PushBufferSize);
+        ZeroSize(CommandSize, Header);
+        Header->Type = Type;
+        Header->Size = CommandSize;
+
+        render_sort_entry *Entry = GetSortEntries(Group) - 1;
+        Entry->SortKey = ((uint64)((uint32)Layer ^ 0x80000000) << 32) | Group->SortEntryCount;
+        Entry->CommandOffset = Group->PushBufferSize;
+        Entry->Reserved = 0;
+        Entry->Bounds = Bounds;
+
+        Group->PushBufferSize += CommandSize;
+        ++Group->SortEntryCount;
+        Result = Header + 1;
+    }
+
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline rectangle2i GetRenderGroupBounds(render_group *Group)
+{
+    rectangle2i Result = {0, 0, Group->Width, Group->Height};
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void PushClear(render_group *Group, uint32 Color)
+{
+    render_command_clear *Command = PushRenderCommand(Group, render_command_clear, INT32_MIN,
+            GetRenderGroupBounds(Group));
+    if (Command)
+    {
+        Command->Color = Color;
+    }
+}
+
+// =====================================================================================================================
+
+internal void PushRectangle(render_group *Group, int32 Layer, real32 MinX, real32 MinY, real32 MaxX, real32 MaxY,
+        color4 Color, bool32 SRGB)
+{
+    //NOTE: Fully transparent rectangles count as culled along with the ones that are off the target.
+    rectangle2i Bounds = {};
+    if ((PackPremultipliedColor(Color) >> 24) != 0)
+    {
+        Bounds = GetRectanglePixels(Group->Width, Group->Height, MinX, MinY, MaxX, MaxY);
+    }
+
+    render_command_rectangle *Command = PushRenderCommand(Group, render_command_rectangle, Layer, Bounds);
+    if (Command)
+    {
+        Command->MinX = MinX;
+        Command->MinY = MinY;
+        Command->MaxX = MaxX;
+        Command->MaxY = MaxY;
+        Command->Color = Color;
+        Command->SRGB = SRGB;
+    }
+}
+
+// =====================================================================================================================
+
+internal void PushBitmap(render_group *Group, int32 Layer, loaded_bitmap *Bitmap, real32 X, real32 Y,
+        blend_mode Mode)
+{
+    bitmap_draw Draw;
+    rectangle2i Bounds = {};
+    GetBitmapPixels(Group->Width, Group->Height, Bitmap, X, Y, Mode, &Draw, &Bounds);
+
+    render_command_bitmap *Command = PushRenderCommand(Group, render_command_bitmap, Layer, Bounds);
+    if (Command)
+    {
+        Command->Bitmap = *Bitmap;
+        Command->X = X;
+        Command->Y = Y;
+        Command->Mode = Mode;
+    }
+}
+
+// =====================================================================================================================
+
+internal void PushWeirdGradient(render_group *Group, int32 Layer, int BlueOffset, int GreenOffset)
+{
+    render_command_weird_gradient *Command = PushRenderCommand(Group, render_command_weird_gradient, Layer,
+            GetRenderGroupBounds(Group));
+    if (Command)
+    {
+        Command->BlueOffset = BlueOffset;
+        Command->GreenOffset = GreenOffset;
+    }
+}
+
+// =====================================================================================================================
+
+internal render_sort_entry *SortRenderEntries(render_group *Group, memory_arena *TempArena)
+{
+    TIMED_FUNCTION(Group->SortEntryCount);
+
+    //NOTE: Least significant byte first radix sort. Every key is unique, so the result doesn't depend on the order
+    //  the entries start out in. A pass where every key has the same byte would leave everything where it is, so it
+    //  is skipped; most frames only have a few layers and a few thousand commands, so that is most of the passes.
+    uint32 Count = Group->SortEntryCount;
+    render_sort_entry *Source = GetSortEntries(Group);
+    render_sort_entry *Dest = PushArray(TempArena, Count, render_sort_entry, 8);
+    for (int Shift = 0; Shift < 64; Shift += 8)
+    {
+        uint32 Offsets[256] = {};
+        for (uint32 EntryIndex = 0; EntryIndex < Count; ++EntryIndex)
+        {
+            ++Offsets[(Source[EntryIndex].SortKey >> Shift) & 0xFF];
+        }
+
+        bool32 AllSame = false;
+        uint32 Total = 0;
+        for (int Digit = 0; Digit < 256; ++Digit)
+        {
+            uint32 DigitCount = Offsets[Digit];
+            AllSame = AllSame || (DigitCount == Count);
+            Offsets[Digit] = Total;
+            Total += DigitCount;
+        }
+        if (AllSame)
+        {
+            continue;
+        }
+
+        for (uint32 EntryIndex = 0; EntryIndex < Count; ++EntryIndex)
+        {
+            render_sort_entry *Entry = Source + EntryIndex;
+            Dest[Offsets[(Entry->SortKey >> Shift) & 0xFF]++] = *Entry;
+        }
+
+        render_sort_entry *Swap = Source;
+        Source = Dest;
+        Dest = Swap;
+    }
+
+    return(Source);
+}
+
+// =====================================================================================================================
+
+internal void ExecuteRenderCommands(render_group *Group, render_sort_entry *SortEntries,
+        game_offscreen_buffer *Buffer, rectangle2i ClipRect)
+{
+    render_kernels *Kernels = GetActiveRenderKernels();
+    for (uint32 EntryIndex = 0; EntryIndex < Group->SortEntryCount; ++EntryIndex)
+    {
+        render_sort_entry *Entry = SortEntries + EntryIndex;
+        rectangle2i Clip = IntersectRectangles(ClipRect, Entry->Bounds);
+        if (!HasArea(Clip))
+        {
+            continue;
+        }
+
+        render_command_header *Header = (render_command_header *)(Group->PushBufferBase + Entry->CommandOffset);
+        void *Data = Header + 1;
+        switch (Header->Type)
+        {
+            case RenderCommand_render_command_clear:
+            {
+                render_command_clear *Command = (render_command_clear *)Data;
+                Kernels->FillRectangle(Buffer, Clip.MinX, Clip.MinY, Clip.MaxX, Clip.MaxY, Command->Color);
+            } break;
+
+            case RenderCommand_render_command_rectangle:
+            {
+                render_command_rectangle *Command = (render_command_rectangle *)Data;
+                DrawRectangleClipped(Buffer, Clip, Command->MinX, Command->MinY, Command->MaxX, Command->MaxY,
+                        Command->Color, Command->SRGB);
+            } break;
+
+            case RenderCommand_render_command_bitmap:
+            {
+                render_command_bitmap *Command = (render_command_bitmap *)Data;
+                DrawBitmapClipped(Buffer, Clip, &Command->Bitmap, Command->X, Command->Y, Command->Mode);
+            } break;
+
+            case RenderCommand_render_command_weird_gradient:
+            {
+                render_command_weird_gradient *Command = (render_command_weird_gradient *)Data;
+                Kernels->RenderWeirdGradient(Buffer, Clip.MinX, Clip.MinY, Clip.MaxX, Clip.MaxY,
+                        Command->BlueOffset, Command->GreenOffset);
+            } break;
+
+            default:
+            {
+                Assert(!"Unknown render command");
+            } break;
+        }
+    }
+}
+
+// =====================================================================================================================
+
+internal uint64 HashTileCommands(render_group *Group, render_sort_entry *SortEntries, rectangle2i ClipRect)
+{
+    //NOTE: FNV-1a over every command that reaches the tile, in the order they draw. A command's data says everything
+    //  about what it draws except a bitmap's texels, which never change under the same pointer.
+    uint64 Hash = 0xcbf29ce484222325ULL;
+    for (uint32 EntryIndex = 0; EntryIndex < Group->SortEntryCount; ++EntryIndex)
+    {
+        render_sort_entry *Entry = SortEntries + EntryIndex;
+        if (!HasArea(IntersectRectangles(ClipRect, Entry->Bounds)))
+        {
+            continue;
+        }
+
+        render_command_header *Header = (render_command_header *)(Group->PushBufferBase + Entry->CommandOffset);
+        uint32 *Word = (uint32 *)Header;
+        for (uint32 WordIndex = 0; WordIndex < Header->Size / sizeof(uint32); ++WordIndex)
+        {
+            Hash = (Hash ^ *Word++) * 0x100000001b3ULL;
+        }
+    }
+    return(Hash);
+}
+
+// =====================================================================================================================
+
+internal PLATFORM_WORK_QUEUE_CALLBACK(DoTiledRenderWork)
+{
+    tile_render_work *Work = (tile_render_work *)Data;
+    rectangle2i Clip = Work->ClipRect;
+    TIMED_FUNCTION((uint32)((Clip.MaxX - Clip.MinX) * (Clip.MaxY - Clip.MinY)));
+
+    Work->WasDrawn = true;
+    if (Work->Dirty)
+    {
+        uint64 Hash = HashTileCommands(Work->Group, Work->SortEntries, Clip);
+        Work->WasDrawn = !Work->CanSkip || (Work->Dirty->TileHash[Work->TileIndex] != Hash);
+        Work->Dirty->TileHash[Work->TileIndex] = Hash;
+    }
+
+    if (Work->WasDrawn)
+    {
+        ExecuteRenderCommands(Work->Group, Work->SortEntries, Work->Buffer, Clip);
+    }
+}
+
+// =====================================================================================================================
+
+internal void MergeDirtyTiles(game_dirty_region *Dirty, tile_render_work *WorkArray, int TileCountX, int TileCountY)
+{
+    //NOTE: A run of drawn tiles along a row becomes one rectangle, or extends a rectangle from the row above that has
+    //  exactly the same columns. Once the list is full, a run is folded into whichever rectangle grows the least by
+    //  taking it in; copying a few clean pixels costs less than a long list of little copies. Folded rectangles can
+    //  overlap, which only means some pixels get presented twice.
+    Dirty->RectCount = 0;
+    Dirty->RenderedPixelCount = 0;
+    for (int TileY = 0; TileY < TileCountY; ++TileY)
+    {
+        tile_render_work *Row = WorkArray + TileY * TileCountX;
+        for (int TileX = 0; TileX < TileCountX; ++TileX)
+        {
+            if (!Row[TileX].WasDrawn)
+            {
+                continue;
+            }
+
+            rectangle2i Run = Row[TileX].ClipRect;
+            for (; (TileX + 1 < TileCountX) && Row[TileX + 1].WasDrawn; ++TileX)
+            {
+                Run.MaxX = Row[TileX + 1].ClipRect.MaxX;
+            }
+            Dirty->RenderedPixelCount += (uint32)((Run.MaxX - Run.MinX) * (Run.MaxY - Run.MinY));
+
+            bool32 Extended = false;
+            for (int RectIndex = 0; !Extended && (RectIndex < Dirty->RectCount); ++RectIndex)
+            {
+                rectangle2i *Rect = Dirty->Rects + RectIndex;
+                if ((Rect->MinX == Run.MinX) && (Rect->MaxX == Run.MaxX) && (Rect->MaxY == Run.MinY))
+                {
+                    Rect->MaxY = Run.MaxY;
+                    Extended = true;
+                }
+            }
+
+            if (!Extended && (Dirty->RectCount < DIRTY_MAX_RECT_COUNT))
+            {
+                Dirty->Rects[Dirty->RectCount++] = Run;
+            }
+            else if (!Extended)
+            {
+                int BestIndex = 0;
+                int64 BestGrowth = INT64_MAX;
+                for (int RectIndex = 0; RectIndex < Dirty->RectCount; ++RectIndex)
+                {
+                    rectangle2i Union = UnionRectangles(Dirty->Rects[RectIndex], Run);
+                    int64 Growth = GetRectangleArea(Union) - GetRectangleArea(Dirty->Rects[RectIndex]);
+                    if (Growth < BestGrowth)
+                    {
+                        BestGrowth = Growth;
+                        BestIndex = RectIndex;
+                    }
+                }
+                Dirty->Rects[BestIndex] = UnionRectangles(Dirty->Rects[BestIndex], Run);
+            }
+        }
+    }
+}
+
+// =====================================================================================================================
+
+internal void RenderGroupToOutput(render_group *Group, game_offscreen_buffer *Buffer, platform_work_queue *RenderQueue,
+        memory_arena *TempArena)
+{
+    //NOTE: Hits are the bytes of push buffer the frame used; SortRenderEntries's hits are its commands.
+    TIMED_FUNCTION(GetRenderGroupBytesUsed(Group));
+    Assert((Buffer->Width == Group->Width) && (Buffer->Height == Group->Height));
+
+    //NOTE: The kernel table has to be picked before any worker can look at it.
+    GetActiveRenderKernels();
+
+    temporary_memory SortMemory = BeginTemporaryMemory(TempArena);
+    render_sort_entry *SortEntries = SortRenderEntries(Group, TempArena);
+    tile_render_work *WorkArray = PushArray(TempArena, MAX_RENDER_TILE_COUNT, tile_render_work);
+
+    //NOTE: Tiles grow past RENDER_TILE_SIZE only if the buffer is so large that it would overflow the work array.
+    int TileSize = RENDER_TILE_SIZE;
+    int TileCountX;
+    int TileCountY;
+    for (;;)
+    {
+        TileCountX = (Buffer->Width + TileSize - 1) / TileSize;
+        TileCountY = (Buffer->Height + TileSize - 1) / TileSize;
+        if ((TileCountX * TileCountY) <= MAX_RENDER_TILE_COUNT)
+        {
+            break;
+        }
+        TileSize *= 2;
+    }
+
+    //NOTE: A tile's old pixels can only be kept if they are still there, in the same place, from the same tiling.
+    //  A probe frame hashes but draws everything, because the hashes it compares against are from the last probe, not
+    //  from the frame still in the buffer.
+    game_dirty_region *Dirty = Buffer->Dirty;
+    game_dirty_region *TileDirty = Dirty;
+    bool32 CanSkip = false;
+    if (Dirty)
+    {
+        Assert(MAX_RENDER_TILE_COUNT <= DIRTY_MAX_TILE_COUNT);
+        CanSkip = !Dirty->Invalidate && (Dirty->TileMemory == Buffer->Memory) && (Dirty->TileSize == TileSize) &&
+            (Dirty->TileCountX == TileCountX) && (Dirty->TileCountY == TileCountY);
+        Dirty->Invalidate = false;
+        Dirty->TileMemory = Buffer->Memory;
+        Dirty->TileSize = TileSize;
+        Dirty->TileCountX = TileCountX;
+        Dirty->TileCountY = TileCountY;
+
+        if (Dirty->WholeFrameCount)
+        {
+            CanSkip = false;
+            if ((Dirty->WholeFrameCount % WHOLE_FRAME_PROBE_INTERVAL) == 0)
+            {
+                Dirty->WholeFrameCount = 0;
+            }
+            else
+            {
+                TileDirty = 0;
+                ++Dirty->WholeFrameCount;
+            }
+        }
+    }
+
+    int WorkCount = 0;
+    for (int TileY = 0; TileY < TileCountY; ++TileY)
+    {
+        for (int TileX = 0; TileX < TileCountX; ++TileX)
+        {
+            tile_render_work *Work = WorkArray + WorkCount;
+            Work->Group = Group;
+            Work->SortEntries = SortEntries;
+            Work->Buffer = Buffer;
+            Work->ClipRect = ClipRectangle(Buffer, TileX * TileSize, TileY * TileSize,
+                    (TileX + 1) * TileSize, (TileY + 1) * TileSize);
+            Work->Dirty = TileDirty;
+            Work->TileIndex = WorkCount++;
+            Work->CanSkip = CanSkip;
+
+            if (RenderQueue)
+            {
+                Platform.AddEntry(RenderQueue, DoTiledRenderWork, Work);
+            }
+            else
+            {
+                DoTiledRenderWork(0, Work);
+            }
+        }
+    }
+
+    if (RenderQueue)
+    {
+        Platform.CompleteAllWork(RenderQueue);
+    }
+
+    if (Dirty)
+    {
+        MergeDirtyTiles(Dirty, WorkArray, TileCountX, TileCountY);
+
+        if (CanSkip)
+        {
+            int DrawnCount = 0;
+            for (int WorkIndex = 0; WorkIndex < WorkCount; ++WorkIndex)
+            {
+                DrawnCount += WorkArray[WorkIndex].WasDrawn ? 1 : 0;
+            }
+            if ((real32)DrawnCount > WHOLE_FRAME_DRAWN_FRACTION * (real32)WorkCount)
+            {
+                Dirty->WholeFrameCount = 1;
+            }
+        }
+    }
+
+    EndTemporaryMemory(SortMemory);
+}
@@ -0,0 +1,112 @@
+#if !defined(HANDMADE_RENDER_GROUP_H)
+#define HANDMADE_RENDER_GROUP_H
+
+//NOTE: Render commands.
+//  Game code doesn't draw; it pushes commands into a render group, and the whole group is drawn in one go at the end
+//  of the frame. Commands are appended to the bottom of the push buffer in the order they come in. Each one also gets
+//  a sort entry at the top of the buffer, growing down, holding its sort key and the pixels it can touch. At the end
+//  of the frame the entries are sorted by layer (in push order within a layer), and then every render tile walks the
+//  sorted entries and skips the commands that can't reach it, so a tile only ever touches its own pixels.
+//
+//  Commands are plain data and don't point back into the group, so other back-ends can consume the same stream.
+//
+//  When the target buffer has a dirty region, each tile also hashes the commands that reach it, and a tile whose hash
+//  matches last frame's is left alone. The tiles that were drawn are merged into the region's rectangles for the
+//  present stage.
+
+enum render_command_type
+{
+    RenderCommand_render_command_clear,
+    RenderCommand_render_command_rectangle,
+    RenderCommand_render_command_bitmap,
+    RenderCommand_render_command_weird_gradient,
+};
+
+struct render_command_header
+{
+    uint32 Type;
+    uint32 Size;
+};
+
+//NOTE: Clears always go underneath everything else in the group, whatever layer and order they were pushed in.
+struct render_command_clear
+{
+    uint32 Color;
+};
+
+struct render_command_rectangle
+{
+    real32 MinX;
+    real32 MinY;
+    real32 MaxX;
+    real32 MaxY;
+    color4 Color;
+    bool32 SRGB;
+};
+
+//NOTE: A copy of the bitmap's description; the texels themselves have to stay put until the group has been drawn.
+struct render_command_bitmap
+{
+    loaded_bitmap Bitmap;
+    real32 X;
+    real32 Y;
+    blend_mode Mode;
+};
+
+struct render_command_weird_gradient
+{
+    int32 BlueOffset;
+    int32 GreenOffset;
+};
+
+//NOTE: Layer in the top 32 bits (biased so negative layers sort first), push order in the bottom 32.
+struct render_sort_entry
+{
+    uint64 SortKey;
+    uint32 CommandOffset;
+    uint32 Reserved;
+    rectangle2i Bounds;
+};
+
+struct render_group
+{
+    int32 Width;
+    int32 Height;
+
+    uint8 *PushBufferBase;
+    uint32 MaxPushBufferSize;
+    uint32 PushBufferSize;
+    uint32 SortEntryCount;
+
+    //NOTE: Commands that landed entirely off the target are never recorded; commands that didn't fit are dropped.
+    uint32 CulledCommandCount;
+    uint32 DroppedCommandCount;
+};
+
+//NOTE: Tiled rendering. The buffer is cut into tiles small enough to stay in cache while they are being filled, and
+//  each tile is one entry on the render work queue.
+#define RENDER_TILE_SIZE 64
+#define MAX_RENDER_TILE_COUNT 2048
+
+//NOTE: When more than this share of the tiles changed on a frame that could have skipped them, hashing them costs more
+//  than it saves, so the renderer draws whole frames without hashing. Every WHOLE_FRAME_PROBE_INTERVAL frames it
+//  hashes one again, so that the next frame can find out whether the motion has stopped.
+#define WHOLE_FRAME_DRAWN_FRACTION 0.75f
+#define WHOLE_FRAME_PROBE_INTERVAL 32
+
+//NOTE: With dirty tracking, a tile whose commands hash the same as last frame's keeps last frame's pixels, unless
+//  CanSkip says the buffer can't be trusted to still hold them. WasDrawn is what the tile ended up doing.
+struct tile_render_work
+{
+    render_group *Group;
+    render_sort_entry *SortEntries;
+    game_offscreen_buffer *Buffer;
+    rectangle2i ClipRect;
+
+    game_dirty_region *Dirty;
+    uint32 TileIndex;
+    bool32 CanSkip;
+    bool32 WasDrawn;
+};
+
+#endif
@@ -0,0 +1,235 @@
+#if !defined(HANDMADE_REPLAY_H)
+#define HANDMADE_REPLAY_H
+
+//NOTE: Input recording and playback, shared by the platform layers.
+//  A recording is one file: a header, a snapshot of game memory taken the moment recording started, then one
+//  replay_frame per recorded frame. The platform maps the file and these routines read and write straight through the
+//  mapping, so recording a frame is a copy into memory and the OS does the writing.
+//
+//  Playback restores the snapshot, then feeds the recorded input back frame by frame and loops. Every recorded frame
+//  also carries a hash of the backbuffer it produced, and playback checks each frame it renders against it, so a loop
+//  that doesn't reproduce the recording bit for bit is caught on the frame it diverges.
+//
+//  The snapshot only covers the part of each storage block that has ever been written. Everything the game keeps is
+//  in registered arenas, and past the highest arena high-water mark the block is still the zeroes it started as.
+//  That keeps snapshots in the kilobytes even though transient storage is a gigabyte.
+
+#define REPLAY_MAGIC_VALUE (((uint32)'h' << 0) | ((uint32)'m' << 8) | ((uint32)'r' << 16) | ((uint32)'p' << 24))
+#define REPLAY_VERSION 2
+#define REPLAY_STORAGE_COUNT 2
+#define REPLAY_ALIGNMENT 4096
+
+struct replay_file_header
+{
+    uint32 MagicValue;
+    uint32 Version;
+
+    //NOTE: A recording is only good for the build that made it: a different input layout or a game memory block at a
+    //  different address would make it replay garbage, so we refuse it instead.
+    uint32 InputSize;
+    uint32 FrameSize;
+    uint64 GameMemoryBase;
+    uint64 StorageSize[REPLAY_STORAGE_COUNT];
+
+    uint64 SnapshotOffset[REPLAY_STORAGE_COUNT];
+    uint64 SnapshotSize[REPLAY_STORAGE_COUNT];
+
+    uint64 FrameOffset;
+    uint32 MaxFrameCount;
+    uint32 FrameCount;
+
+    uint64 FileSize;
+};
+
+struct replay_frame
+{
+    game_input Input;
+    uint64 BackbufferHash;
+};
+
+// =====================================================================================================================
+
+inline uint8 *GetReplayStorage(game_memory *Memory, int StorageIndex, uint64 *Size)
+{
+    uint8 *Result;
+    if (StorageIndex == 0)
+    {
+        Result = (uint8 *)Memory->PermanentStorage;
+        *Size = Memory->PermanentStorageSize;
+    }
+    else
+    {
+        Result = (uint8 *)Memory->TransientStorage;
+        *Size = Memory->TransientStorageSize;
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal uint64 GetStorageUsedSize(game_memory *Memory, int StorageIndex)
+{
+    //NOTE: If nothing registered an arena in this block yet we can't tell what is in use, so take all of it.
+    uint64 StorageSize;
+    uint8 *Storage = GetReplayStorage(Memory, StorageIndex, &StorageSize);
+
+    bool32 FoundArena = false;
+    uint64 Result = 0;
+    memory_arena_registry *Registry = &Memory->ArenaRegistry;
+    for (int ArenaIndex = 0; ArenaIndex < Registry->ArenaCount; ++ArenaIndex)
+    {
+        memory_arena *Arena = Registry->Arenas[ArenaIndex];
+        if ((Arena->Base >= Storage) && (Arena->Base < (Storage + StorageSize)))
+        {
+            uint64 ArenaEnd = (uint64)((Arena->Base + Arena->HighWaterMark) - Storage);
+            if (ArenaEnd > Result)
+            {
+                Result = ArenaEnd;
+            }
+            FoundArena = true;
+        }
+    }
+
+    if (!FoundArena)
+    {
+        Result = StorageSize;
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline uint64 AlignReplayOffset(uint64 Offset)
+{
+    uint64 Result = (Offset + (REPLAY_ALIGNMENT - 1)) & ~(uint64)(REPLAY_ALIGNMENT - 1);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void InitializeReplayHeader(replay_file_header *Header, game_memory *Memory, uint32 MaxFrameCount)
+{
+    //NOTE: Lays the file out for a recording of up to MaxFrameCount frames starting from the current game memory.
+    //  The platform sizes the file from Header->FileSize, maps it, and copies the header to the front.
+    *Header = {};
+    Header->MagicValue = REPLAY_MAGIC_VALUE;
+    Header->Version = REPLAY_VERSION;
+    Header->InputSize = sizeof(game_input);
+    Header->FrameSize = sizeof(replay_frame);
+    Header->GameMemoryBase = (uint64)Memory->PermanentStorage;
+
+    uint64 Offset = AlignReplayOffset(sizeof(replay_file_header));
+    for (int StorageIndex = 0; StorageIndex < REPLAY_STORAGE_COUNT; ++StorageIndex)
+    {
+        GetReplayStorage(Memory, StorageIndex, &Header->StorageSize[StorageIndex]);
+        Header->SnapshotOffset[StorageIndex] = Offset;
+        Header->SnapshotSize[StorageIndex] = GetStorageUsedSize(Memory, StorageIndex);
+        Offset = AlignReplayOffset(Offset + Header->SnapshotSize[StorageIndex]);
+    }
+
+    Header->FrameOffset = Offset;
+    Header->MaxFrameCount = MaxFrameCount;
+    Header->FrameCount = 0;
+    Header->FileSize = Header->FrameOffset + (uint64)MaxFrameCount * sizeof(replay_frame);
+}
+
+// =====================================================================================================================
+
+inline bool32 IsReplayRangeValid(uint64 FileSize, uint64 Offset, uint64 Size)
+{
+    bool32 Result = ((Offset <= FileSize) && (Size <= (FileSize - Offset)));
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 IsReplayCompatible(replay_file_header *Header, uint64 FileSize, game_memory *Memory)
+{
+    //NOTE: Everything playback later reads or writes through the header is range checked here, so a truncated or
+    //  hand-edited file is refused instead of being read past the mapping or restored past the end of storage.
+    bool32 Result = ((FileSize >= sizeof(replay_file_header)) &&
+            (Header->MagicValue == REPLAY_MAGIC_VALUE) &&
+            (Header->Version == REPLAY_VERSION) &&
+            (Header->InputSize == sizeof(game_input)) &&
+            (Header->FrameSize == sizeof(replay_frame)) &&
+            (Header->GameMemoryBase == (uint64)Memory->PermanentStorage) &&
+            (Header->StorageSize[0] == Memory->PermanentStorageSize) &&
+            (Header->StorageSize[1] == Memory->TransientStorageSize) &&
+            (Header->FrameCount > 0) &&
+            (Header->FrameCount <= Header->MaxFrameCount) &&
+            IsReplayRangeValid(FileSize, Header->FrameOffset, (uint64)Header->FrameCount * sizeof(replay_frame)));
+
+    for (int StorageIndex = 0; Result && (StorageIndex < REPLAY_STORAGE_COUNT); ++StorageIndex)
+    {
+        Result = ((Header->SnapshotSize[StorageIndex] <= Header->StorageSize[StorageIndex]) &&
+                IsReplayRangeValid(FileSize, Header->SnapshotOffset[StorageIndex],
+                        Header->SnapshotSize[StorageIndex]));
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void WriteReplaySnapshot(replay_file_header *Header, game_memory *Memory)
+{
+    for (int StorageIndex = 0; StorageIndex < REPLAY_STORAGE_COUNT; ++StorageIndex)
+    {
+        uint64 StorageSize;
+        uint8 *Storage = GetReplayStorage(Memory, StorageIndex, &StorageSize);
+        memcpy((uint8 *)Header + Header->SnapshotOffset[StorageIndex], Storage,
+                (size_t)Header->SnapshotSize[StorageIndex]);
+    }
+}
+
+// =====================================================================================================================
+
+internal void RestoreReplaySnapshot(replay_file_header *Header, game_memory *Memory)
+{
+    //NOTE: Whatever the game wrote past the snapshot since it was taken has to go back to zero as well, or the next
+    //  loop would start from different memory than the recording did. The extent has to be measured before the copy,
+    //  because the copy rolls the arenas' high-water marks back too.
+    for (int StorageIndex = 0; StorageIndex < REPLAY_STORAGE_COUNT; ++StorageIndex)
+    {
+        uint64 StorageSize;
+        uint8 *Storage = GetReplayStorage(Memory, StorageIndex, &StorageSize);
+        uint64 UsedSize = GetStorageUsedSize(Memory, StorageIndex);
+        uint64 SnapshotSize = Header->SnapshotSize[StorageIndex];
+
+        memcpy(Storage, (uint8 *)Header + Header->SnapshotOffset[StorageIndex], (size_t)SnapshotSize);
+        if (UsedSize > SnapshotSize)
+        {
+            memset(Storage + SnapshotSize, 0, (size_t)(UsedSize - SnapshotSize));
+        }
+    }
+}
+
+// =====================================================================================================================
+
+inline replay_frame *GetReplayFrame(replay_file_header *Header, uint32 FrameIndex)
+{
+    Assert(FrameIndex < Header->MaxFrameCount);
+    replay_frame *Result = (replay_frame *)((uint8 *)Header + Header->FrameOffset) + FrameIndex;
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal uint64 HashBackbuffer(game_offscreen_buffer *Buffer)
+{
+    //NOTE: FNV-1a over whole pixels rather than bytes, which is plenty to catch a frame that diverged and cheap enough
+    //  to run every frame. Row padding is skipped since nothing ever draws into it.
+    uint64 Hash = 0xcbf29ce484222325ULL;
+    uint8 *Row = (uint8 *)Buffer->Memory;
+    for (int Y = 0; Y < Buffer->Height; ++Y)
+    {
+        uint32 *Pixel = (uint32 *)Row;
+        for (int X = 0; X < Buffer->Width; ++X)
+        {
+            Hash = (Hash ^ *Pixel++) * 0x100000001b3ULL;
+        }
+        Row += Buffer->Pitch;
+    }
+    return(Hash);
+}
+
+#endif
@@ -0,0 +1,123 @@
+//NOTE: One extra entry at the end so interpolation never has to wrap the index.
+global_variable real32 GlobalSineTable[SINE_TABLE_SIZE + 1];
+global_variable bool32 GlobalSineTableInitialized;
+
+// =====================================================================================================================
+
+inline real32 *GetSineTable(void)
+{
+    if (!GlobalSineTableInitialized)
+    {
+        for (int Index = 0; Index <= SINE_TABLE_SIZE; ++Index)
+        {
+            real64 Angle = 2.0 * 3.14159265358979323846 * (real64)Index / (real64)SINE_TABLE_SIZE;
+            GlobalSineTable[Index] = (real32)sin(Angle);
+        }
+        GlobalSineTableInitialized = true;
+    }
+    return(GlobalSineTable);
+}
+
+// =====================================================================================================================
+
+internal uint32 GetPhaseStep(real32 Frequency, int SamplesPerSecond)
+{
+    //NOTE: 2^32 phase units per cycle.
+    uint32 Result = (uint32)(((real64)Frequency / (real64)SamplesPerSecond) * 4294967296.0 + 0.5);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void SetOscillatorFrequency(oscillator *Oscillator, real32 Frequency, int SamplesPerSecond)
+{
+    //NOTE: Only the step changes, so the waveform stays continuous across frequency changes.
+    Oscillator->PhaseStep = GetPhaseStep(Frequency, SamplesPerSecond);
+}
+
+// =====================================================================================================================
+
+internal void GenerateSineScalar(oscillator *Oscillator, real32 *Dest, int SampleCount)
+{
+    real32 *Table = GetSineTable();
+    real32 FractionScale = 1.0f / (real32)(1 << SINE_TABLE_FRACTION_BITS);
+
+    uint32 Phase = Oscillator->Phase;
+    for (int SampleIndex = 0; SampleIndex < SampleCount; ++SampleIndex)
+    {
+        uint32 Index = Phase >> SINE_TABLE_FRACTION_BITS;
+        real32 Fraction = (real32)(int32)(Phase & ((1 << SINE_TABLE_FRACTION_BITS) - 1)) * FractionScale;
+        real32 A = Table[Index];
+        real32 B = Table[Index + 1];
+        *Dest++ = (A + (B - A) * Fraction) * Oscillator->Volume;
+
+        Phase += Oscillator->PhaseStep;
+    }
+    Oscillator->Phase = Phase;
+}
+
+// =====================================================================================================================
+
+internal void GenerateSine(oscillator *Oscillator, real32 *Dest, int SampleCount)
+{
+    TIMED_FUNCTION((uint32)SampleCount);
+
+    real32 *Table = GetSineTable();
+
+    __m128 FractionScale = _mm_set1_ps(1.0f / (real32)(1 << SINE_TABLE_FRACTION_BITS));
+    __m128i FractionMask = _mm_set1_epi32((1 << SINE_TABLE_FRACTION_BITS) - 1);
+    __m128 Volume = _mm_set1_ps(Oscillator->Volume);
+    uint32 Step = Oscillator->PhaseStep;
+    __m128i Step4x = _mm_set1_epi32((int32)(Step * 4));
+    __m128i Phase4x = _mm_setr_epi32((int32)Oscillator->Phase, (int32)(Oscillator->Phase + Step),
+            (int32)(Oscillator->Phase + 2 * Step), (int32)(Oscillator->Phase + 3 * Step));
+
+    int SampleIndex = 0;
+    for (; (SampleIndex + 4) <= SampleCount; SampleIndex += 4)
+    {
+        //NOTE: SSE2 has no gather, so the four table lookups are done by hand.
+        __m128i Index4x = _mm_srli_epi32(Phase4x, SINE_TABLE_FRACTION_BITS);
+        alignas(16) uint32 Index[4];
+        _mm_store_si128((__m128i *)Index, Index4x);
+
+        __m128 A = _mm_setr_ps(Table[Index[0]], Table[Index[1]], Table[Index[2]], Table[Index[3]]);
+        __m128 B = _mm_setr_ps(Table[Index[0] + 1], Table[Index[1] + 1], Table[Index[2] + 1], Table[Index[3] + 1]);
+        __m128 Fraction = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(Phase4x, FractionMask)), FractionScale);
+
+        __m128 Value = _mm_add_ps(A, _mm_mul_ps(_mm_sub_ps(B, A), Fraction));
+        _mm_storeu_ps(Dest + SampleIndex, _mm_mul_ps(Value, Volume));
+
+        Phase4x = _mm_add_epi32(Phase4x, Step4x);
+    }
+
+    Oscillator->Phase += (uint32)SampleIndex * Step;
+    GenerateSineScalar(Oscillator, Dest + SampleIndex, SampleCount - SampleIndex);
+}
+
+// =====================================================================================================================
+
+internal void OutputMonoAsStereo(real32 *Source, game_sound_output_buffer *SoundBuffer)
+{
+    //NOTE: Converts with saturation, then duplicates each sample into the left and right channels.
+    int16 *Dest = SoundBuffer->Samples;
+
+    int SampleIndex = 0;
+    for (; (SampleIndex + 8) <= SoundBuffer->SampleCount; SampleIndex += 8)
+    {
+        __m128i S0 = _mm_cvtps_epi32(_mm_loadu_ps(Source + SampleIndex));
+        __m128i S1 = _mm_cvtps_epi32(_mm_loadu_ps(Source + SampleIndex + 4));
+        __m128i Mono = _mm_packs_epi32(S0, S1);
+
+        _mm_storeu_si128((__m128i *)(Dest + 2 * SampleIndex), _mm_unpacklo_epi16(Mono, Mono));
+        _mm_storeu_si128((__m128i *)(Dest + 2 * SampleIndex + 8), _mm_unpackhi_epi16(Mono, Mono));
+    }
+
+    int16 *SampleOut = Dest + 2 * SampleIndex;
+    for (; SampleIndex < SoundBuffer->SampleCount; ++SampleIndex)
+    {
+        int32 Rounded = (int32)lrintf(Source[SampleIndex]);
+        int16 SampleValue = (int16)((Rounded > 32767) ? 32767 : ((Rounded < -32768) ? -32768 : Rounded));
+        *SampleOut++ = SampleValue;
+        *SampleOut++ = SampleValue;
+    }
+}
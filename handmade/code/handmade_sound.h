@@ -0,0 +1,23 @@
+#if !defined(HANDMADE_SOUND_H)
+#define HANDMADE_SOUND_H
+
+//NOTE: Tone synthesis.
+//  Oscillators keep their phase as a 32-bit fixed-point fraction of a cycle, so the phase wraps for free and never
+//  loses precision no matter how long the game has been running. The waveform comes from a sine table with linear
+//  interpolation between entries instead of calling sinf per sample.
+
+#define SINE_TABLE_BITS 12
+#define SINE_TABLE_SIZE (1 << SINE_TABLE_BITS)
+#define SINE_TABLE_FRACTION_BITS (32 - SINE_TABLE_BITS)
+
+//NOTE: Upper bound on how many sample frames one GameUpdateAndRender may be asked for (one second at 48kHz).
+#define MAX_SOUND_SAMPLES_PER_UPDATE 48000
+
+struct oscillator
+{
+    uint32 Phase;
+    uint32 PhaseStep;
+    real32 Volume;
+};
+
+#endif
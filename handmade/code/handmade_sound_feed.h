@@ -0,0 +1,273 @@
+#if !defined(HANDMADE_SOUND_FEED_H)
+#define HANDMADE_SOUND_FEED_H
+
+//NOTE: Sound output shared by the platform layers.
+//  The frame loop never touches the sound device. Once a frame it tops a sound_ring up with freshly mixed samples, and
+//  the platform's audio thread wakes every few milliseconds, asks the device where its cursors are, and keeps the
+//  device LatencyMS of samples ahead of its write cursor out of the ring. A slow frame only drains the ring; the device
+//  doesn't notice unless the ring runs dry, and then it is given silence (an underrun) rather than stale samples.
+//
+//  The ring has exactly one producer (the frame loop) and one consumer (the audio thread), so it needs no locks: each
+//  side only ever writes its own index, and only publishes it once the samples it covers have been copied.
+
+#if defined(_MSC_VER)
+inline uint32 AtomicLoadAcquire(uint32 volatile *Value)
+{
+    uint32 Result = *Value;
+    _ReadWriteBarrier();
+    return(Result);
+}
+
+inline void AtomicStoreRelease(uint32 volatile *Value, uint32 NewValue)
+{
+    _ReadWriteBarrier();
+    *Value = NewValue;
+}
+#else
+inline uint32 AtomicLoadAcquire(uint32 volatile *Value)
+{
+    uint32 Result = __atomic_load_n(Value, __ATOMIC_ACQUIRE);
+    return(Result);
+}
+
+inline void AtomicStoreRelease(uint32 volatile *Value, uint32 NewValue)
+{
+    __atomic_store_n(Value, NewValue, __ATOMIC_RELEASE);
+}
+#endif
+
+//NOTE: About 680ms at 48kHz, far more than the largest latency target plus a frame.
+#define SOUND_RING_SAMPLE_COUNT 32768
+
+#define SOUND_FEED_DEFAULT_LATENCY_MS 40
+#define SOUND_FEED_MAX_LATENCY_MS 250
+#define SOUND_FEED_PERIOD_MS 2
+
+struct sound_ring
+{
+    //NOTE: Running counts of sample frames, only wrapped when they are used as an index. Each one sits on its own
+    //  cache line so the two threads aren't trading the line back and forth on every update.
+    alignas(64) uint32 volatile WriteIndex;
+    alignas(64) uint32 volatile ReadIndex;
+
+    //NOTE: Power of two. Samples are interleaved 16-bit stereo, like game_sound_output_buffer's.
+    alignas(64) uint32 SampleCount;
+    int16 *Samples;
+};
+
+struct sound_feed
+{
+    uint32 SamplesPerSecond;
+    uint32 DeviceSampleCount;
+    uint32 LatencySampleCount;
+    uint32 PeriodMS;
+
+    //NOTE: Device position, in sample frames, one past the last sample the audio thread wrote.
+    bool32 IsValid;
+    bool32 IsStarving;
+    uint32 WrittenUpTo;
+
+    //NOTE: Only the audio thread writes these, anyone may read them for a report. A late wake is the audio thread
+    //  itself not getting scheduled in time; an underrun is the frame loop not keeping the ring full.
+    uint32 volatile WakeCount;
+    uint32 volatile LateWakeCount;
+    uint32 volatile UnderrunCount;
+    uint32 volatile SilenceSampleCount;
+};
+
+//NOTE: One wake's worth of device writes. The first RingSampleCount samples come out of the ring, the rest are
+//  silence. The platform locks SampleCount samples at DevicePosition and hands each region to FillSoundFeedRegion.
+struct sound_feed_write
+{
+    uint32 DevicePosition;
+    uint32 SampleCount;
+    uint32 RingSampleCount;
+};
+
+// =====================================================================================================================
+
+inline void InitializeSoundRing(sound_ring *Ring, uint32 SampleCount, int16 *Samples)
+{
+    Assert((SampleCount & (SampleCount - 1)) == 0);
+    Ring->WriteIndex = 0;
+    Ring->ReadIndex = 0;
+    Ring->SampleCount = SampleCount;
+    Ring->Samples = Samples;
+}
+
+// =====================================================================================================================
+
+inline uint32 GetSoundRingQueued(sound_ring *Ring)
+{
+    //NOTE: Good from either side. The other side can only move its index in the direction that helps the caller, so
+    //  a stale value just means a conservative answer.
+    uint32 Result = AtomicLoadAcquire(&Ring->WriteIndex) - AtomicLoadAcquire(&Ring->ReadIndex);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline uint32 GetSoundRingProduceCount(sound_ring *Ring, uint32 TargetQueued, uint32 MaxCount)
+{
+    //NOTE: How many samples the producer should mix this frame to bring the ring back up to TargetQueued.
+    uint32 Queued = GetSoundRingQueued(Ring);
+    uint32 Result = (Queued < TargetQueued) ? (TargetQueued - Queued) : 0;
+    if (Result > (Ring->SampleCount - Queued))
+    {
+        Result = Ring->SampleCount - Queued;
+    }
+    if (Result > MaxCount)
+    {
+        Result = MaxCount;
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline uint32 GetSoundRingFirstCount(sound_ring *Ring, uint32 Index, uint32 Count)
+{
+    //NOTE: How much of a Count-long range starting at Index comes before the end of the ring; the rest wraps around
+    //  to the start.
+    uint32 Result = Ring->SampleCount - (Index & (Ring->SampleCount - 1));
+    if (Result > Count)
+    {
+        Result = Count;
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void WriteSoundRing(sound_ring *Ring, int16 *Source, uint32 Count)
+{
+    //NOTE: Producer only, and Count must fit; GetSoundRingProduceCount never asks for more than that.
+    uint32 WriteIndex = Ring->WriteIndex;
+    Assert(Count <= (Ring->SampleCount - (WriteIndex - AtomicLoadAcquire(&Ring->ReadIndex))));
+
+    uint32 FirstCount = GetSoundRingFirstCount(Ring, WriteIndex, Count);
+    memcpy(Ring->Samples + 2 * (WriteIndex & (Ring->SampleCount - 1)), Source, FirstCount * 2 * sizeof(int16));
+    memcpy(Ring->Samples, Source + 2 * FirstCount, (Count - FirstCount) * 2 * sizeof(int16));
+
+    AtomicStoreRelease(&Ring->WriteIndex, WriteIndex + Count);
+}
+
+// =====================================================================================================================
+
+internal void ReadSoundRing(sound_ring *Ring, int16 *Dest, uint32 Count)
+{
+    //NOTE: Consumer only, and Count must already be queued.
+    uint32 ReadIndex = Ring->ReadIndex;
+    Assert(Count <= (AtomicLoadAcquire(&Ring->WriteIndex) - ReadIndex));
+
+    uint32 FirstCount = GetSoundRingFirstCount(Ring, ReadIndex, Count);
+    memcpy(Dest, Ring->Samples + 2 * (ReadIndex & (Ring->SampleCount - 1)), FirstCount * 2 * sizeof(int16));
+    memcpy(Dest + 2 * FirstCount, Ring->Samples, (Count - FirstCount) * 2 * sizeof(int16));
+
+    AtomicStoreRelease(&Ring->ReadIndex, ReadIndex + Count);
+}
+
+// =====================================================================================================================
+
+inline void InitializeSoundFeed(sound_feed *Feed, uint32 SamplesPerSecond, uint32 DeviceSampleCount,
+        uint32 LatencyMS, uint32 PeriodMS)
+{
+    *Feed = {};
+    Feed->SamplesPerSecond = SamplesPerSecond;
+    Feed->DeviceSampleCount = DeviceSampleCount;
+    Feed->LatencySampleCount = (uint32)(((uint64)SamplesPerSecond * LatencyMS) / 1000);
+    Feed->PeriodMS = PeriodMS;
+    Assert(Feed->LatencySampleCount <= (DeviceSampleCount / 4));
+}
+
+// =====================================================================================================================
+
+internal sound_feed_write PlanSoundFeedWrite(sound_feed *Feed, sound_ring *Ring, uint32 PlayCursor,
+        uint32 WriteCursor)
+{
+    //NOTE: Cursors are positions in the device's buffer, in sample frames. Everything from the play cursor up to the
+    //  write cursor is already committed; we write from wherever we left off up to LatencySampleCount past the write
+    //  cursor. If the write cursor has already passed where we left off, we woke up too late and the device has
+    //  played whatever was sitting in its buffer, so all we can do is pick up again at the write cursor. We never
+    //  queue anywhere near half the device buffer, so a distance past that is really the cursor having gone by.
+    uint32 DeviceSampleCount = Feed->DeviceSampleCount;
+    uint32 WriteLead = (WriteCursor + DeviceSampleCount - PlayCursor) % DeviceSampleCount;
+    uint32 Queued = (Feed->WrittenUpTo + DeviceSampleCount - PlayCursor) % DeviceSampleCount;
+    if (!Feed->IsValid || (Queued < WriteLead) || (Queued > (DeviceSampleCount / 2)))
+    {
+        if (Feed->IsValid)
+        {
+            ++Feed->LateWakeCount;
+        }
+        Feed->WrittenUpTo = WriteCursor;
+        Feed->IsValid = true;
+        Queued = WriteLead;
+    }
+    ++Feed->WakeCount;
+
+    uint32 Target = WriteLead + Feed->LatencySampleCount;
+    if (Target >= DeviceSampleCount)
+    {
+        Target = DeviceSampleCount - 1;
+    }
+
+    sound_feed_write Result = {};
+    Result.DevicePosition = Feed->WrittenUpTo;
+    Result.SampleCount = (Target > Queued) ? (Target - Queued) : 0;
+    Result.RingSampleCount = GetSoundRingQueued(Ring);
+    if (Result.RingSampleCount >= Result.SampleCount)
+    {
+        Result.RingSampleCount = Result.SampleCount;
+        Feed->IsStarving = false;
+    }
+    else if (AtomicLoadAcquire(&Ring->WriteIndex) != 0)
+    {
+        //NOTE: Silence before the first samples ever show up is just the game starting, not an underrun. After
+        //  that, a run of wakes that all come up short counts as one underrun.
+        if (!Feed->IsStarving)
+        {
+            ++Feed->UnderrunCount;
+            Feed->IsStarving = true;
+        }
+        Feed->SilenceSampleCount += Result.SampleCount - Result.RingSampleCount;
+    }
+
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void FillSoundFeedRegion(sound_ring *Ring, sound_feed_write *Write, int16 *Dest, uint32 Count)
+{
+    uint32 RingCount = (Count < Write->RingSampleCount) ? Count : Write->RingSampleCount;
+    ReadSoundRing(Ring, Dest, RingCount);
+    memset(Dest + 2 * RingCount, 0, (Count - RingCount) * 2 * sizeof(int16));
+    Write->RingSampleCount -= RingCount;
+}
+
+// =====================================================================================================================
+
+inline void EndSoundFeedWrite(sound_feed *Feed, sound_feed_write *Write)
+{
+    Assert(Write->RingSampleCount == 0);
+    Feed->WrittenUpTo = (Write->DevicePosition + Write->SampleCount) % Feed->DeviceSampleCount;
+}
+
+// =====================================================================================================================
+
+inline int FormatSoundFeedStats(sound_feed *Feed, char *Buffer, int BufferSize)
+{
+    //NOTE: Returns the number of characters written, truncating if the buffer runs out.
+    int Used = snprintf(Buffer, BufferSize,
+            "audio @ %.01fms latency: %u wakes, %u late, %u underruns, %.03fms of silence\n",
+            1000.0f * (real32)Feed->LatencySampleCount / (real32)Feed->SamplesPerSecond, Feed->WakeCount,
+            Feed->LateWakeCount, Feed->UnderrunCount,
+            1000.0f * (real32)Feed->SilenceSampleCount / (real32)Feed->SamplesPerSecond);
+    if (Used > BufferSize)
+    {
+        Used = BufferSize;
+    }
+    return(Used);
+}
+
+#endif
@@ -0,0 +1,199 @@
+internal void InitializeWorld(world *World, memory_arena *Arena, uint32 MaxChunkCount)
+{
+    World->Chunks = PushArray(Arena, MaxChunkCount, tile_chunk, 64);
+    World->MaxChunkCount = MaxChunkCount;
+    World->ChunkCount = 0;
+
+    uint32 SlotCount = 1;
+    uint32 SlotShift = 64;
+    while (SlotCount < (2 * MaxChunkCount))
+    {
+        SlotCount *= 2;
+        --SlotShift;
+    }
+    World->Slots = PushArray(Arena, SlotCount, tile_chunk_slot, 64);
+    ZeroSize(SlotCount * sizeof(tile_chunk_slot), World->Slots);
+    World->SlotMask = SlotCount - 1;
+    World->SlotShift = SlotShift;
+}
+
+// =====================================================================================================================
+
+inline uint32 GetChunkHomeSlot(world *World, int32 ChunkX, int32 ChunkY)
+{
+    //NOTE: Fibonacci hashing on both coordinates packed into 64 bits. The top bits of the product are the ones that
+    //  depend on every bit of the key, so those are the ones kept.
+    uint64 Key = ((uint64)(uint32)ChunkX << 32) | (uint64)(uint32)ChunkY;
+    uint32 Result = (uint32)((Key * 0x9E3779B97F4A7C15ULL) >> World->SlotShift);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal tile_chunk *GetTileChunk(world *World, int32 ChunkX, int32 ChunkY)
+{
+    //NOTE: Linear probing. The table is never more than half full, so there is always a free slot to stop at.
+    tile_chunk *Result = 0;
+    uint32 SlotIndex = GetChunkHomeSlot(World, ChunkX, ChunkY);
+    for (;;)
+    {
+        tile_chunk_slot *Slot = World->Slots + SlotIndex;
+        if (!Slot->ChunkIndex)
+        {
+            break;
+        }
+        if ((Slot->ChunkX == ChunkX) && (Slot->ChunkY == ChunkY))
+        {
+            Result = World->Chunks + (Slot->ChunkIndex - 1);
+            break;
+        }
+        SlotIndex = (SlotIndex + 1) & World->SlotMask;
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal tile_chunk *GetOrCreateTileChunk(world *World, int32 ChunkX, int32 ChunkY)
+{
+    //NOTE: Returns 0 only when the chunk doesn't exist yet and every chunk has already been handed out.
+    tile_chunk *Result = 0;
+    uint32 SlotIndex = GetChunkHomeSlot(World, ChunkX, ChunkY);
+    for (;;)
+    {
+        tile_chunk_slot *Slot = World->Slots + SlotIndex;
+        if (!Slot->ChunkIndex)
+        {
+            if (World->ChunkCount < World->MaxChunkCount)
+            {
+                Result = World->Chunks + World->ChunkCount++;
+                Result->ChunkX = ChunkX;
+                Result->ChunkY = ChunkY;
+                ZeroSize(sizeof(Result->Tiles), Result->Tiles);
+
+                Slot->ChunkX = ChunkX;
+                Slot->ChunkY = ChunkY;
+                Slot->ChunkIndex = World->ChunkCount;
+            }
+            break;
+        }
+        if ((Slot->ChunkX == ChunkX) && (Slot->ChunkY == ChunkY))
+        {
+            Result = World->Chunks + (Slot->ChunkIndex - 1);
+            break;
+        }
+        SlotIndex = (SlotIndex + 1) & World->SlotMask;
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline uint32 *GetChunkTile(tile_chunk *Chunk, int32 TileX, int32 TileY)
+{
+    uint32 *Result = Chunk->Tiles + ((TileY & TILE_CHUNK_MASK) * TILE_CHUNK_DIM + (TileX & TILE_CHUNK_MASK));
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline uint32 GetTileValue(world *World, int32 TileX, int32 TileY)
+{
+    //NOTE: Tile coordinates are split with an arithmetic shift, so tile -1 is the last tile of chunk -1.
+    uint32 Result = TileValue_Empty;
+    tile_chunk *Chunk = GetTileChunk(World, TileX >> TILE_CHUNK_SHIFT, TileY >> TILE_CHUNK_SHIFT);
+    if (Chunk)
+    {
+        Result = *GetChunkTile(Chunk, TileX, TileY);
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 SetTileValue(world *World, int32 TileX, int32 TileY, uint32 TileValue)
+{
+    tile_chunk *Chunk = GetOrCreateTileChunk(World, TileX >> TILE_CHUNK_SHIFT, TileY >> TILE_CHUNK_SHIFT);
+    if (Chunk)
+    {
+        *GetChunkTile(Chunk, TileX, TileY) = TileValue;
+    }
+    return(Chunk != 0);
+}
+
+// =====================================================================================================================
+
+inline void RecanonicalizeCoord(int32 *Chunk, real32 *Offset)
+{
+    //NOTE: The chunk side is a power of two, so the division is exact, and so is taking whole chunks back off of a
+    //  positive offset. An offset a hair below zero can still round up to exactly one chunk side when a chunk side
+    //  is added back, so that carries into the next chunk as well.
+    real32 ChunkDelta = floorf(*Offset * (1.0f / TILE_CHUNK_SIDE_IN_METERS));
+    *Chunk += (int32)ChunkDelta;
+    *Offset -= ChunkDelta * TILE_CHUNK_SIDE_IN_METERS;
+    if (*Offset >= TILE_CHUNK_SIDE_IN_METERS)
+    {
+        *Offset -= TILE_CHUNK_SIDE_IN_METERS;
+        ++*Chunk;
+    }
+    Assert((*Offset >= 0.0f) && (*Offset < TILE_CHUNK_SIDE_IN_METERS));
+}
+
+// =====================================================================================================================
+
+inline world_position MapIntoChunkSpace(world_position Base, real32 dX, real32 dY)
+{
+    world_position Result = Base;
+    Result.OffsetX += dX;
+    Result.OffsetY += dY;
+    RecanonicalizeCoord(&Result.ChunkX, &Result.OffsetX);
+    RecanonicalizeCoord(&Result.ChunkY, &Result.OffsetY);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline world_difference SubtractPositions(world_position A, world_position B)
+{
+    //NOTE: Only as precise as the distance itself; two positions next to each other far from the origin still come
+    //  out exact.
+    world_difference Result;
+    Result.dX = (real32)((real64)A.ChunkX - (real64)B.ChunkX) * TILE_CHUNK_SIDE_IN_METERS + (A.OffsetX - B.OffsetX);
+    Result.dY = (real32)((real64)A.ChunkY - (real64)B.ChunkY) * TILE_CHUNK_SIDE_IN_METERS + (A.OffsetY - B.OffsetY);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline tile_position GetTilePosition(world_position Pos)
+{
+    //NOTE: Absolute tile coordinates only reach 2^31 tiles, so this is for the 2^27 chunks either side of the
+    //  origin. Splitting a canonical offset into a tile and an offset within it is exact, and so is putting them
+    //  back together with GetWorldPosition.
+    Assert((Pos.ChunkX >= -(1 << 27)) && (Pos.ChunkX < (1 << 27)));
+    Assert((Pos.ChunkY >= -(1 << 27)) && (Pos.ChunkY < (1 << 27)));
+
+    real32 TileInChunkX = floorf(Pos.OffsetX * (1.0f / TILE_SIDE_IN_METERS));
+    real32 TileInChunkY = floorf(Pos.OffsetY * (1.0f / TILE_SIDE_IN_METERS));
+
+    tile_position Result;
+    Result.TileX = Pos.ChunkX * TILE_CHUNK_DIM + (int32)TileInChunkX;
+    Result.TileY = Pos.ChunkY * TILE_CHUNK_DIM + (int32)TileInChunkY;
+    Result.TileOffsetX = Pos.OffsetX - TileInChunkX * TILE_SIDE_IN_METERS;
+    Result.TileOffsetY = Pos.OffsetY - TileInChunkY * TILE_SIDE_IN_METERS;
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline world_position GetWorldPosition(tile_position Pos)
+{
+    world_position Result;
+    Result.ChunkX = Pos.TileX >> TILE_CHUNK_SHIFT;
+    Result.ChunkY = Pos.TileY >> TILE_CHUNK_SHIFT;
+    Result.OffsetX = (real32)(Pos.TileX & TILE_CHUNK_MASK) * TILE_SIDE_IN_METERS + Pos.TileOffsetX;
+    Result.OffsetY = (real32)(Pos.TileY & TILE_CHUNK_MASK) * TILE_SIDE_IN_METERS + Pos.TileOffsetY;
+    RecanonicalizeCoord(&Result.ChunkX, &Result.OffsetX);
+    RecanonicalizeCoord(&Result.ChunkY, &Result.OffsetY);
+    return(Result);
+}
@@ -0,0 +1,82 @@
+#if !defined(HANDMADE_WORLD_H)
+#define HANDMADE_WORLD_H
+
+//NOTE: Tile-map world.
+//  Tiles live in fixed-size square chunks. The chunks themselves are one contiguous array, allocated once out of the
+//  permanent arena, and a chunk is found from its chunk coordinates through an open-addressing hash table, so the
+//  world can be sparse and unbounded in every direction without ever allocating after startup. Chunks are never
+//  removed, which is what keeps the table's probing simple: no tombstones.
+//
+//  Positions are a chunk coordinate plus a float offset in meters inside that chunk. The float part never grows past
+//  one chunk, so a position a billion tiles from the origin is exactly as precise as one next to it. Tile sides are a
+//  power of two in meters, so moving between chunk-relative and tile-relative offsets is exact.
+
+#define TILE_CHUNK_SHIFT 4
+#define TILE_CHUNK_DIM (1 << TILE_CHUNK_SHIFT)
+#define TILE_CHUNK_MASK (TILE_CHUNK_DIM - 1)
+
+#define TILE_SIDE_IN_METERS 1.0f
+#define TILE_CHUNK_SIDE_IN_METERS ((real32)TILE_CHUNK_DIM * TILE_SIDE_IN_METERS)
+
+//NOTE: 0 is also what every tile in a chunk that doesn't exist reads as.
+enum tile_value
+{
+    TileValue_Empty,
+    TileValue_Floor,
+    TileValue_Wall,
+};
+
+struct tile_chunk
+{
+    int32 ChunkX;
+    int32 ChunkY;
+    uint32 Tiles[TILE_CHUNK_DIM * TILE_CHUNK_DIM];
+};
+
+//NOTE: ChunkIndex is an index into world::Chunks plus one, so that 0 can mean the slot is free.
+struct tile_chunk_slot
+{
+    int32 ChunkX;
+    int32 ChunkY;
+    uint32 ChunkIndex;
+};
+
+struct world
+{
+    tile_chunk *Chunks;
+    uint32 MaxChunkCount;
+    uint32 ChunkCount;
+
+    //NOTE: Power of two, and at least twice MaxChunkCount, so the table is never more than half full. SlotShift
+    //  takes a 64-bit hash down to a slot index.
+    tile_chunk_slot *Slots;
+    uint32 SlotMask;
+    uint32 SlotShift;
+};
+
+//NOTE: Canonical when 0 <= Offset < TILE_CHUNK_SIDE_IN_METERS on both axes, measured from the chunk's min corner.
+struct world_position
+{
+    int32 ChunkX;
+    int32 ChunkY;
+    real32 OffsetX;
+    real32 OffsetY;
+};
+
+//NOTE: Absolute tile coordinates (chunk * TILE_CHUNK_DIM + tile within the chunk), plus where in that tile.
+struct tile_position
+{
+    int32 TileX;
+    int32 TileY;
+    real32 TileOffsetX;
+    real32 TileOffsetY;
+};
+
+//NOTE: Meters from one world_position to another.
+struct world_difference
+{
+    real32 dX;
+    real32 dY;
+};
+
+#endif
@@ -0,0 +1,2258 @@
+#include "handmade_platform.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <x86intrin.h>
+
+#include "handmade_replay.h"
+#include "handmade_debug.h"
+#include "handmade_present.h"
+#include "handmade_pixel_format.h"
+#include "handmade_sound_feed.h"
+#include "handmade_capture.h"
+#include "handmade_controller_poll.h"
+#include "linux_handmade.h"
+#include "handmade_frame_timing.h"
+
+//NOTE: Headless platform layer. There is no window, no sound device and no input device; by default the game core is
+//  driven at an uncapped frame rate so that the cost of a frame can be measured on its own. "-hz N" locks it to a
+//  target rate instead, to check the frame scheduler. "-display Width Height" adds the present stage, scaling every
+//  frame into a display buffer of that size the way the Win32 layer does for its window. "-audio LatencyMS" adds the
+//  audio thread and a null sound device for it to feed, and "-hitch EveryN MS" stalls every Nth frame to see whether
+//  the audio survives it.
+
+//NOTE: In internal builds, mapped files go at fixed addresses just like game memory does, so the pointers into them
+//  that end up in a looped-input snapshot are still good when the recording is played back by another run.
+global_variable uint8 *GlobalNextFileMappingAddress;
+
+// =====================================================================================================================
+
+//NOTE: What the game runs when handmade.so can't be loaded or doesn't export what we need. The frame loop keeps
+//  going, the game just doesn't do anything until a good module shows up.
+GAME_UPDATE_AND_RENDER(GameUpdateAndRenderStub)
+{
+}
+
+// =====================================================================================================================
+
+internal uint64 LinuxGetWallClock(void)
+{
+    timespec Clock;
+    clock_gettime(CLOCK_MONOTONIC, &Clock);
+    uint64 Result = (uint64)Clock.tv_sec * 1000000000ULL + (uint64)Clock.tv_nsec;
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal real64 LinuxGetMSElapsed(uint64 Start, uint64 End)
+{
+    real64 Result = (real64)(End - Start) / 1000000.0;
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 LinuxWaitForFrameEnd(uint64 FrameStart, real32 TargetSecondsPerFrame)
+{
+    //NOTE: Same scheme as the Win32 layer: sleep for all but the last millisecond, then spin. The kernel's timers are
+    //  already high resolution, so there is no timer period to raise here, but wakeups can still be late by a
+    //  scheduler tick under load. Returns true when the frame was already late before we got here.
+    TIMED_FUNCTION();
+
+    bool32 MissedFrame = false;
+
+    uint64 TargetNanoseconds = (uint64)(1000000000.0f * TargetSecondsPerFrame);
+    uint64 FrameEnd = FrameStart + TargetNanoseconds;
+    uint64 Now = LinuxGetWallClock();
+    if (Now < FrameEnd)
+    {
+        uint64 SpinNanoseconds = 1000000;
+        if ((FrameEnd - Now) > SpinNanoseconds)
+        {
+            uint64 WakeTime = FrameEnd - SpinNanoseconds;
+            timespec WakeClock;
+            WakeClock.tv_sec = (time_t)(WakeTime / 1000000000ULL);
+            WakeClock.tv_nsec = (long)(WakeTime % 1000000000ULL);
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &WakeClock, 0) != 0)
+            {
+                //NOTE: Interrupted by a signal; the wake time is absolute, so just go back to sleep.
+            }
+        }
+
+        while (LinuxGetWallClock() < FrameEnd)
+        {
+            _mm_pause();
+        }
+    }
+    else
+    {
+        MissedFrame = true;
+    }
+
+    return(MissedFrame);
+}
+
+// =====================================================================================================================
+
+internal void LinuxGetEXEFileName(linux_state *State)
+{
+    ssize_t SizeOfFileName = readlink("/proc/self/exe", State->EXEFileName, sizeof(State->EXEFileName) - 1);
+    if (SizeOfFileName < 0)
+    {
+        SizeOfFileName = 0;
+    }
+    State->EXEFileName[SizeOfFileName] = 0;
+
+    State->OnePastLastEXEFileNameSlash = State->EXEFileName;
+    for (char *Scan = State->EXEFileName; *Scan; ++Scan)
+    {
+        if (*Scan == '/')
+        {
+            State->OnePastLastEXEFileNameSlash = Scan + 1;
+        }
+    }
+}
+
+// =====================================================================================================================
+
+internal void LinuxBuildEXEPathFileName(linux_state *State, char *FileName, int DestCount, char *Dest)
+{
+    int PathCount = (int)(State->OnePastLastEXEFileNameSlash - State->EXEFileName);
+    snprintf(Dest, DestCount, "%.*s%s", PathCount, State->EXEFileName, FileName);
+}
+
+// =====================================================================================================================
+
+internal timespec LinuxGetLastWriteTime(char *FileName)
+{
+    timespec LastWriteTime = {};
+
+    struct stat Data;
+    if (stat(FileName, &Data) == 0)
+    {
+        LastWriteTime = Data.st_mtim;
+    }
+
+    return(LastWriteTime);
+}
+
+// =====================================================================================================================
+
+inline bool32 LinuxFileTimesMatch(timespec A, timespec B)
+{
+    bool32 Result = ((A.tv_sec == B.tv_sec) && (A.tv_nsec == B.tv_nsec));
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 LinuxFileExists(char *FileName)
+{
+    struct stat Data;
+    bool32 Result = (stat(FileName, &Data) == 0);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 LinuxCopyFile(char *SourceFileName, char *DestFileName)
+{
+    //NOTE: The destination is unlinked first so the copy gets a fresh inode. dlopen recognizes a library it already
+    //  has open by device and inode, and rewriting the old file in place would pull pages out from under it.
+    bool32 Result = false;
+
+    int SourceHandle = open(SourceFileName, O_RDONLY);
+    if (SourceHandle >= 0)
+    {
+        unlink(DestFileName);
+        int DestHandle = open(DestFileName, O_WRONLY|O_CREAT|O_TRUNC, 0755);
+        if (DestHandle >= 0)
+        {
+            Result = true;
+
+            char Block[65536];
+            for (;;)
+            {
+                ssize_t BytesRead = read(SourceHandle, Block, sizeof(Block));
+                if (BytesRead <= 0)
+                {
+                    Result = (BytesRead == 0);
+                    break;
+                }
+                if (write(DestHandle, Block, BytesRead) != BytesRead)
+                {
+                    Result = false;
+                    break;
+                }
+            }
+            close(DestHandle);
+        }
+        close(SourceHandle);
+    }
+
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal linux_game_code LinuxLoadGameCode(char *SourceSOName, char *TempSOName)
+{
+    //NOTE: We load a copy, never the module the build writes to, so the next build can replace it while this one
+    //  is still running.
+    linux_game_code Result = {};
+
+    Result.SOLastWriteTime = LinuxGetLastWriteTime(SourceSOName);
+    if (LinuxCopyFile(SourceSOName, TempSOName))
+    {
+        Result.GameCodeSO = dlopen(TempSOName, RTLD_NOW|RTLD_LOCAL);
+        if (Result.GameCodeSO)
+        {
+            Result.UpdateAndRender = (game_update_and_render *)dlsym(Result.GameCodeSO, "GameUpdateAndRender");
+            Result.IsValid = (Result.UpdateAndRender != 0);
+        }
+    }
+
+    if (!Result.IsValid)
+    {
+        Result.UpdateAndRender = GameUpdateAndRenderStub;
+    }
+
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void LinuxUnloadGameCode(linux_game_code *GameCode)
+{
+    if (GameCode->GameCodeSO)
+    {
+        dlclose(GameCode->GameCodeSO);
+        GameCode->GameCodeSO = 0;
+    }
+
+    GameCode->IsValid = false;
+    GameCode->UpdateAndRender = GameUpdateAndRenderStub;
+}
+
+// =====================================================================================================================
+
+internal bool32 LinuxBeginRecordingInput(linux_state *State, game_memory *Memory, char *FileName,
+        uint32 MaxFrameCount)
+{
+    //NOTE: The file is sized for the longest recording up front and cut down to what was used when recording ends.
+    replay_file_header Header;
+    InitializeReplayHeader(&Header, Memory, MaxFrameCount);
+
+    //NOTE: A load still in flight would land in game memory after the snapshot was taken.
+    if (Memory->LowPriorityQueue)
+    {
+        Memory->PlatformAPI.CompleteAllWork(Memory->LowPriorityQueue);
+    }
+
+    int FileHandle = open(FileName, O_RDWR|O_CREAT|O_TRUNC, 0644);
+    if (FileHandle >= 0)
+    {
+        if (ftruncate(FileHandle, (off_t)Header.FileSize) == 0)
+        {
+            void *Mapping = mmap(0, Header.FileSize, PROT_READ|PROT_WRITE, MAP_SHARED, FileHandle, 0);
+            if (Mapping != MAP_FAILED)
+            {
+                State->ReplayFileHandle = FileHandle;
+                State->ReplayMapping = (replay_file_header *)Mapping;
+                State->ReplayMappingSize = Header.FileSize;
+                *State->ReplayMapping = Header;
+                WriteReplaySnapshot(State->ReplayMapping, Memory);
+                State->IsRecording = true;
+            }
+        }
+
+        if (!State->IsRecording)
+        {
+            close(FileHandle);
+        }
+    }
+
+    return(State->IsRecording);
+}
+
+// =====================================================================================================================
+
+internal void LinuxEndRecordingInput(linux_state *State)
+{
+    replay_file_header *Header = State->ReplayMapping;
+    Header->FileSize = Header->FrameOffset + (uint64)Header->FrameCount * sizeof(replay_frame);
+    off_t UsedSize = (off_t)Header->FileSize;
+
+    munmap(State->ReplayMapping, State->ReplayMappingSize);
+    if (ftruncate(State->ReplayFileHandle, UsedSize) != 0)
+    {
+        //NOTE: Harmless, the file just keeps some unused frames at the end.
+    }
+    close(State->ReplayFileHandle);
+
+    State->ReplayMapping = 0;
+    State->ReplayMappingSize = 0;
+    State->IsRecording = false;
+}
+
+// =====================================================================================================================
+
+internal void LinuxRecordInput(linux_state *State, game_input *Input, game_offscreen_buffer *Buffer)
+{
+    //NOTE: Called after the frame has been rendered, so the hash is of the picture this input produced.
+    TIMED_FUNCTION();
+
+    replay_file_header *Header = State->ReplayMapping;
+    replay_frame *Frame = GetReplayFrame(Header, Header->FrameCount);
+    Frame->Input = *Input;
+    Frame->BackbufferHash = HashBackbuffer(Buffer);
+    ++Header->FrameCount;
+
+    if (Header->FrameCount == Header->MaxFrameCount)
+    {
+        LinuxEndRecordingInput(State);
+    }
+}
+
+// =====================================================================================================================
+
+internal bool32 LinuxBeginInputPlayBack(linux_state *State, game_memory *Memory, char *FileName)
+{
+    int FileHandle = open(FileName, O_RDONLY);
+    if (FileHandle >= 0)
+    {
+        struct stat FileStat;
+        if ((fstat(FileHandle, &FileStat) == 0) && (FileStat.st_size >= (off_t)sizeof(replay_file_header)))
+        {
+            uint64 FileSize = (uint64)FileStat.st_size;
+            void *Mapping = mmap(0, FileSize, PROT_READ, MAP_PRIVATE, FileHandle, 0);
+            if (Mapping != MAP_FAILED)
+            {
+                if (IsReplayCompatible((replay_file_header *)Mapping, FileSize, Memory))
+                {
+                    State->ReplayFileHandle = FileHandle;
+                    State->ReplayMapping = (replay_file_header *)Mapping;
+                    State->ReplayMappingSize = FileSize;
+                    State->PlaybackFrameIndex = 0;
+                    State->PlaybackLoopCount = 0;
+                    State->PlaybackMismatchCount = 0;
+
+                    //NOTE: Same as when recording: nothing may land in game memory after it has been restored.
+                    if (Memory->LowPriorityQueue)
+                    {
+                        Memory->PlatformAPI.CompleteAllWork(Memory->LowPriorityQueue);
+                    }
+                    RestoreReplaySnapshot(State->ReplayMapping, Memory);
+                    State->IsPlayingBack = true;
+                }
+                else
+                {
+                    munmap(Mapping, FileSize);
+                }
+            }
+        }
+
+        if (!State->IsPlayingBack)
+        {
+            close(FileHandle);
+        }
+    }
+
+    return(State->IsPlayingBack);
+}
+
+// =====================================================================================================================
+
+internal void LinuxEndInputPlayBack(linux_state *State)
+{
+    munmap(State->ReplayMapping, State->ReplayMappingSize);
+    close(State->ReplayFileHandle);
+
+    State->ReplayMapping = 0;
+    State->ReplayMappingSize = 0;
+    State->IsPlayingBack = false;
+}
+
+// =====================================================================================================================
+
+internal void LinuxPlayBackInput(linux_state *State, game_memory *Memory, game_input *NewInput)
+{
+    //NOTE: Called between frames. At the end of the recording we rewind game memory to the snapshot and go again.
+    TIMED_FUNCTION();
+
+    replay_file_header *Header = State->ReplayMapping;
+    if (State->PlaybackFrameIndex == Header->FrameCount)
+    {
+        RestoreReplaySnapshot(Header, Memory);
+        State->PlaybackFrameIndex = 0;
+        ++State->PlaybackLoopCount;
+    }
+
+    *NewInput = GetReplayFrame(Header, State->PlaybackFrameIndex)->Input;
+}
+
+// =====================================================================================================================
+
+internal bool32 LinuxCheckPlayBackFrame(linux_state *State, game_offscreen_buffer *Buffer)
+{
+    TIMED_FUNCTION();
+
+    replay_frame *Frame = GetReplayFrame(State->ReplayMapping, State->PlaybackFrameIndex);
+    bool32 Result = (HashBackbuffer(Buffer) == Frame->BackbufferHash);
+    if (!Result)
+    {
+        ++State->PlaybackMismatchCount;
+    }
+    ++State->PlaybackFrameIndex;
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void LinuxProcessKeyboardButton(game_button_state *NewState, bool32 IsDown)
+{
+    if (NewState->EndedDown != IsDown)
+    {
+        NewState->EndedDown = IsDown;
+        ++NewState->HalfTransitionCount;
+    }
+}
+
+// =====================================================================================================================
+
+internal void LinuxScriptKeyboard(game_controller_input *OldKeyboard, game_controller_input *NewKeyboard,
+        int FrameIndex)
+{
+    //NOTE: Nobody sits at the keyboard of the headless harness, so a recording gets this instead: hold right for a
+    //  second, then up for a second, and tap the blip button every three quarters of a second.
+    *NewKeyboard = {};
+    NewKeyboard->IsConnected = true;
+    for (int ButtonIndex = 0; ButtonIndex < (int)ArrayCount(NewKeyboard->Buttons); ++ButtonIndex)
+    {
+        NewKeyboard->Buttons[ButtonIndex].EndedDown = OldKeyboard->Buttons[ButtonIndex].EndedDown;
+    }
+
+    LinuxProcessKeyboardButton(&NewKeyboard->MoveRight, ((FrameIndex / 60) % 2) == 0);
+    LinuxProcessKeyboardButton(&NewKeyboard->MoveUp, ((FrameIndex / 60) % 2) == 1);
+    LinuxProcessKeyboardButton(&NewKeyboard->ActionDown, (FrameIndex % 45) == 0);
+}
+
+// =====================================================================================================================
+
+internal void *LinuxReserveMemory(void *BaseAddress, memory_index Size)
+{
+    //NOTE: Anonymous mappings come back zeroed, which the game memory requires. The base address is only a hint; if
+    //  the kernel can't honor it we still get memory, just somewhere else.
+    void *Result = mmap(BaseAddress, Size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+    if (Result == MAP_FAILED)
+    {
+        Result = 0;
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void *LinuxAllocateMemory(memory_index Size)
+{
+    void *Result = LinuxReserveMemory(0, Size);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal platform_file_mapping LinuxMapFile(char *FileName)
+{
+    //NOTE: The mapping keeps the file alive on its own, so the descriptor can go right away.
+    platform_file_mapping Result = {};
+    int FileHandle = open(FileName, O_RDONLY);
+    if (FileHandle >= 0)
+    {
+        struct stat FileStat;
+        if ((fstat(FileHandle, &FileStat) == 0) && (FileStat.st_size > 0))
+        {
+            void *Memory = mmap(GlobalNextFileMappingAddress, (size_t)FileStat.st_size, PROT_READ, MAP_PRIVATE,
+                    FileHandle, 0);
+            if (Memory != MAP_FAILED)
+            {
+                Result.Memory = Memory;
+                Result.Size = (uint64)FileStat.st_size;
+                if (GlobalNextFileMappingAddress)
+                {
+                    GlobalNextFileMappingAddress += (Result.Size + Kilobytes(64) - 1) & ~(uint64)(Kilobytes(64) - 1);
+                }
+            }
+        }
+        close(FileHandle);
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void LinuxUnmapFile(platform_file_mapping *Mapping)
+{
+    if (Mapping->Memory)
+    {
+        munmap(Mapping->Memory, (size_t)Mapping->Size);
+    }
+    Mapping->Memory = 0;
+    Mapping->Size = 0;
+}
+
+// =====================================================================================================================
+
+internal void LinuxPrintArenaStats(memory_arena_registry *Registry)
+{
+    printf("arenas\n");
+    for (int ArenaIndex = 0; ArenaIndex < Registry->ArenaCount; ++ArenaIndex)
+    {
+        memory_arena *Arena = Registry->Arenas[ArenaIndex];
+        printf("  %-12s  high water %10.03fKB of %12.03fKB (%.02f%%)\n", Arena->Name,
+                (real64)Arena->HighWaterMark / 1024.0, (real64)Arena->Size / 1024.0,
+                100.0 * (real64)Arena->HighWaterMark / (real64)Arena->Size);
+    }
+}
+
+// =====================================================================================================================
+
+internal void LinuxAddEntry(platform_work_queue *Queue, platform_work_queue_callback *Callback, void *Data)
+{
+    //TODO: Switch to __atomic_compare_exchange_n eventually so that any thread can add?
+    uint32 NewNextEntryToWrite = (Queue->NextEntryToWrite + 1) % ArrayCount(Queue->Entries);
+    Assert(NewNextEntryToWrite != Queue->NextEntryToRead);
+    platform_work_queue_entry *Entry = Queue->Entries + Queue->NextEntryToWrite;
+    Entry->Callback = Callback;
+    Entry->Data = Data;
+    ++Queue->CompletionGoal;
+
+    //NOTE: The entry has to be visible before the index that publishes it.
+    __atomic_store_n(&Queue->NextEntryToWrite, NewNextEntryToWrite, __ATOMIC_RELEASE);
+    sem_post(&Queue->SemaphoreHandle);
+}
+
+// =====================================================================================================================
+
+internal bool32 LinuxDoNextWorkQueueEntry(platform_work_queue *Queue)
+{
+    bool32 WeShouldSleep = false;
+
+    uint32 OriginalNextEntryToRead = __atomic_load_n(&Queue->NextEntryToRead, __ATOMIC_ACQUIRE);
+    uint32 NewNextEntryToRead = (OriginalNextEntryToRead + 1) % ArrayCount(Queue->Entries);
+    if (OriginalNextEntryToRead != __atomic_load_n(&Queue->NextEntryToWrite, __ATOMIC_ACQUIRE))
+    {
+        if (__atomic_compare_exchange_n(&Queue->NextEntryToRead, &OriginalNextEntryToRead, NewNextEntryToRead,
+                    false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            platform_work_queue_entry Entry = Queue->Entries[OriginalNextEntryToRead];
+            Entry.Callback(Queue, Entry.Data);
+            __atomic_fetch_add(&Queue->CompletionCount, 1, __ATOMIC_RELEASE);
+        }
+    }
+    else
+    {
+        WeShouldSleep = true;
+    }
+
+    return(WeShouldSleep);
+}
+
+// =====================================================================================================================
+
+internal void LinuxCompleteAllWork(platform_work_queue *Queue)
+{
+    TIMED_FUNCTION();
+
+    while (Queue->CompletionGoal != __atomic_load_n(&Queue->CompletionCount, __ATOMIC_ACQUIRE))
+    {
+        LinuxDoNextWorkQueueEntry(Queue);
+    }
+
+    Queue->CompletionGoal = 0;
+    Queue->CompletionCount = 0;
+}
+
+// =====================================================================================================================
+
+internal void *LinuxWorkerThreadProc(void *Parameter)
+{
+    platform_work_queue *Queue = (platform_work_queue *)Parameter;
+    for (;;)
+    {
+        if (LinuxDoNextWorkQueueEntry(Queue))
+        {
+            sem_wait(&Queue->SemaphoreHandle);
+        }
+    }
+    return(0);
+}
+
+// =====================================================================================================================
+
+internal void LinuxMakeQueue(platform_work_queue *Queue, int ThreadCount)
+{
+    //NOTE: ThreadCount is the number of workers besides the thread that calls LinuxCompleteAllWork.
+    Queue->CompletionGoal = 0;
+    Queue->CompletionCount = 0;
+    Queue->NextEntryToWrite = 0;
+    Queue->NextEntryToRead = 0;
+    Queue->ThreadCount = ThreadCount;
+    sem_init(&Queue->SemaphoreHandle, 0, 0);
+
+    for (int ThreadIndex = 0; ThreadIndex < ThreadCount; ++ThreadIndex)
+    {
+        pthread_t Thread;
+        pthread_attr_t Attributes;
+        pthread_attr_init(&Attributes);
+        pthread_attr_setdetachstate(&Attributes, PTHREAD_CREATE_DETACHED);
+        pthread_create(&Thread, &Attributes, LinuxWorkerThreadProc, Queue);
+        pthread_attr_destroy(&Attributes);
+    }
+}
+
+// =====================================================================================================================
+
+internal uint64 LinuxGetNullDevicePlayedSampleCount(linux_sound_output *SoundOutput)
+{
+    uint64 Elapsed = LinuxGetWallClock() - SoundOutput->DeviceStartClock;
+    uint64 Result = (Elapsed * (uint64)SoundOutput->SamplesPerSecond) / 1000000000ULL;
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void LinuxFlushSoundSink(linux_sound_output *SoundOutput, uint64 PlayedSampleCount)
+{
+    //NOTE: Everything the play cursor went past since the last wake. If the audio thread slept through more than a
+    //  whole device buffer the device went around more than once, and only the last time around is still there.
+    uint64 FlushStart = SoundOutput->DevicePlayedSampleCount;
+    if ((PlayedSampleCount - FlushStart) > SoundOutput->DeviceSampleCount)
+    {
+        FlushStart = PlayedSampleCount - SoundOutput->DeviceSampleCount;
+    }
+
+    if (SoundOutput->SinkFileHandle >= 0)
+    {
+        while (FlushStart < PlayedSampleCount)
+        {
+            uint32 Position = (uint32)(FlushStart % SoundOutput->DeviceSampleCount);
+            uint64 Count = SoundOutput->DeviceSampleCount - Position;
+            if (Count > (PlayedSampleCount - FlushStart))
+            {
+                Count = PlayedSampleCount - FlushStart;
+            }
+
+            ssize_t Written = write(SoundOutput->SinkFileHandle, SoundOutput->DeviceSamples + 2 * Position,
+                    Count * SoundOutput->BytesPerSample);
+            if (Written <= 0)
+            {
+                break;
+            }
+            FlushStart += (uint64)Written / SoundOutput->BytesPerSample;
+        }
+    }
+
+    SoundOutput->DevicePlayedSampleCount = PlayedSampleCount;
+}
+
+// =====================================================================================================================
+
+internal void LinuxFillSoundDevice(linux_sound_output *SoundOutput)
+{
+    TIMED_FUNCTION();
+
+    uint64 PlayedSampleCount = LinuxGetNullDevicePlayedSampleCount(SoundOutput);
+    LinuxFlushSoundSink(SoundOutput, PlayedSampleCount);
+
+    uint32 DeviceSampleCount = SoundOutput->DeviceSampleCount;
+    uint32 PlayCursor = (uint32)(PlayedSampleCount % DeviceSampleCount);
+    uint32 WriteCursor = (uint32)((PlayedSampleCount + SoundOutput->DeviceWriteLeadSampleCount) % DeviceSampleCount);
+    sound_feed_write Write = PlanSoundFeedWrite(&SoundOutput->Feed, &SoundOutput->Ring, PlayCursor, WriteCursor);
+
+    uint32 FirstCount = DeviceSampleCount - Write.DevicePosition;
+    if (FirstCount > Write.SampleCount)
+    {
+        FirstCount = Write.SampleCount;
+    }
+    FillSoundFeedRegion(&SoundOutput->Ring, &Write, SoundOutput->DeviceSamples + 2 * Write.DevicePosition,
+            FirstCount);
+    FillSoundFeedRegion(&SoundOutput->Ring, &Write, SoundOutput->DeviceSamples, Write.SampleCount - FirstCount);
+    EndSoundFeedWrite(&SoundOutput->Feed, &Write);
+}
+
+// =====================================================================================================================
+
+internal void *LinuxAudioThreadProc(void *Parameter)
+{
+    //NOTE: Wakes are scheduled off the clock rather than off the end of the last wake, so the period doesn't drift
+    //  with how long filling takes. A wake that comes in late doesn't try to make up for the ones it missed.
+    linux_sound_output *SoundOutput = (linux_sound_output *)Parameter;
+    uint64 PeriodNanoseconds = (uint64)SoundOutput->Feed.PeriodMS * 1000000ULL;
+    uint64 WakeTime = LinuxGetWallClock();
+    while (AtomicLoadAcquire(&SoundOutput->AudioThreadIsRunning))
+    {
+        LinuxFillSoundDevice(SoundOutput);
+
+        WakeTime += PeriodNanoseconds;
+        uint64 Now = LinuxGetWallClock();
+        if (WakeTime < Now)
+        {
+            WakeTime = Now;
+        }
+
+        timespec WakeClock;
+        WakeClock.tv_sec = (time_t)(WakeTime / 1000000000ULL);
+        WakeClock.tv_nsec = (long)(WakeTime % 1000000000ULL);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &WakeClock, 0) != 0)
+        {
+            //NOTE: Interrupted by a signal; the wake time is absolute, so just go back to sleep.
+        }
+    }
+    return(0);
+}
+
+// =====================================================================================================================
+
+internal bool32 LinuxStartAudioThread(linux_sound_output *SoundOutput, memory_arena *Arena, uint32 LatencyMS,
+        char *SinkFileName)
+{
+    SoundOutput->SinkFileHandle = -1;
+    if (SinkFileName)
+    {
+        SoundOutput->SinkFileHandle = open(SinkFileName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (SoundOutput->SinkFileHandle < 0)
+        {
+            return(false);
+        }
+    }
+
+    //NOTE: A second's worth of device buffer, like the DirectSound secondary buffer, and a write cursor 5ms past the
+    //  play cursor, which is about as tight as DirectSound ever reports.
+    SoundOutput->DeviceSampleCount = (uint32)SoundOutput->SamplesPerSecond;
+    SoundOutput->DeviceSamples = PushArray(Arena, 2 * SoundOutput->DeviceSampleCount, int16, 64);
+    SoundOutput->DeviceWriteLeadSampleCount = (uint32)SoundOutput->SamplesPerSecond / 200;
+
+    InitializeSoundRing(&SoundOutput->Ring, SOUND_RING_SAMPLE_COUNT,
+            PushArray(Arena, 2 * SOUND_RING_SAMPLE_COUNT, int16, 64));
+    InitializeSoundFeed(&SoundOutput->Feed, (uint32)SoundOutput->SamplesPerSecond, SoundOutput->DeviceSampleCount,
+            LatencyMS, SOUND_FEED_PERIOD_MS);
+
+    SoundOutput->DeviceStartClock = LinuxGetWallClock();
+    SoundOutput->DevicePlayedSampleCount = 0;
+    SoundOutput->AudioThreadIsRunning = 1;
+    if (pthread_create(&SoundOutput->AudioThread, 0, LinuxAudioThreadProc, SoundOutput) != 0)
+    {
+        return(false);
+    }
+
+    SoundOutput->HasAudioThread = true;
+    return(true);
+}
+
+// =====================================================================================================================
+
+internal void LinuxStopAudioThread(linux_sound_output *SoundOutput)
+{
+    AtomicStoreRelease(&SoundOutput->AudioThreadIsRunning, 0);
+    pthread_join(SoundOutput->AudioThread, 0);
+    SoundOutput->HasAudioThread = false;
+
+    if (SoundOutput->SinkFileHandle >= 0)
+    {
+        close(SoundOutput->SinkFileHandle);
+        SoundOutput->SinkFileHandle = -1;
+    }
+}
+
+// =====================================================================================================================
+
+internal CONTROLLER_POLL_READ(LinuxReadFakePad)
+{
+    linux_fake_pad *Pad = (linux_fake_pad *)Context;
+    bool32 Result = (SlotIndex == 0);
+    if (Result)
+    {
+        uint64 Elapsed = LinuxGetWallClock() - Pad->StartClock;
+        uint64 ToggleCount = Elapsed / Pad->TogglePeriod;
+        Reading->ButtonsDown = (ToggleCount & 1) ? (1 << ControllerButton_ActionDown) : 0;
+
+        uint64 SweepPeriod = 4000000000ULL;
+        real32 Sweep = (real32)(Elapsed % SweepPeriod) / (real32)(SweepPeriod / 2);
+        real32 StickX = (Sweep < 1.0f) ? (2.0f * Sweep - 1.0f) : (3.0f - 2.0f * Sweep);
+        Reading->StickX = (int16)(32767.0f * StickX);
+        Reading->StickY = 0;
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline uint64 LinuxGetFakePadChangeClock(linux_fake_pad *Pad, uint64 Clock)
+{
+    //NOTE: When the fake pad's latest button change before Clock really happened.
+    uint64 Result = Pad->StartClock + ((Clock - Pad->StartClock) / Pad->TogglePeriod) * Pad->TogglePeriod;
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void *LinuxControllerThreadProc(void *Parameter)
+{
+    linux_controller_input *Input = (linux_controller_input *)Parameter;
+    while (AtomicLoadAcquire(&Input->ThreadIsRunning))
+    {
+        uint64 WakeTime = PollControllers(Input->Poller, LinuxGetWallClock());
+
+        timespec WakeClock;
+        WakeClock.tv_sec = (time_t)(WakeTime / 1000000000ULL);
+        WakeClock.tv_nsec = (long)(WakeTime % 1000000000ULL);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &WakeClock, 0) != 0)
+        {
+            //NOTE: Interrupted by a signal; the wake time is absolute, so just go back to sleep.
+        }
+    }
+    return(0);
+}
+
+// =====================================================================================================================
+
+internal bool32 LinuxStartControllerThread(linux_controller_input *Input, memory_arena *Arena, uint32 PollHz,
+        uint32 TogglePeriodMS)
+{
+    *Input = {};
+    Input->Pad.StartClock = LinuxGetWallClock();
+    Input->Pad.TogglePeriod = (uint64)TogglePeriodMS * 1000000ULL;
+    Input->Poller = PushStruct(Arena, controller_poller, 64);
+    InitializeControllerPoller(Input->Poller, LinuxReadFakePad, &Input->Pad, 1000000000ULL, PollHz,
+            CONTROLLER_POLL_DEFAULT_DEAD_ZONE);
+
+    Input->ThreadIsRunning = 1;
+    if (pthread_create(&Input->Thread, 0, LinuxControllerThreadProc, Input) != 0)
+    {
+        return(false);
+    }
+
+    Input->HasThread = true;
+    return(true);
+}
+
+// =====================================================================================================================
+
+internal void LinuxStopControllerThread(linux_controller_input *Input)
+{
+    AtomicStoreRelease(&Input->ThreadIsRunning, 0);
+    pthread_join(Input->Thread, 0);
+    Input->HasThread = false;
+}
+
+// =====================================================================================================================
+
+internal void LinuxReadControllers(linux_controller_input *Input, game_input *NewInput)
+{
+    TIMED_FUNCTION();
+
+    uint64 FrameClock = LinuxGetWallClock();
+    controller_snapshot *Snapshot = ReadControllerSnapshot(Input->Poller);
+    for (int SlotIndex = 0; SlotIndex < CONTROLLER_POLL_SLOT_COUNT; ++SlotIndex)
+    {
+        ApplyControllerSlot(Input->LastSlots + SlotIndex, Snapshot->Slots + SlotIndex,
+                GetController(NewInput, SlotIndex + 1));
+    }
+
+    controller_slot_state *Pad = Snapshot->Slots;
+    uint32 TransitionCount = Pad->HalfTransitionCount[ControllerButton_ActionDown] -
+        Input->LastSlots[0].HalfTransitionCount[ControllerButton_ActionDown];
+    if (TransitionCount)
+    {
+        uint64 ChangeClock = LinuxGetFakePadChangeClock(&Input->Pad, Pad->ChangeClock);
+        real64 FrameLatencyMS = (real64)(FrameClock - ChangeClock) / 1000000.0;
+        Input->TotalPollLatencyMS += (real64)(Pad->ChangeClock - ChangeClock) / 1000000.0;
+        Input->TotalFrameLatencyMS += FrameLatencyMS;
+        if (FrameLatencyMS > Input->MaxFrameLatencyMS)
+        {
+            Input->MaxFrameLatencyMS = FrameLatencyMS;
+        }
+        ++Input->MeasuredChangeCount;
+    }
+
+    for (int SlotIndex = 0; SlotIndex < CONTROLLER_POLL_SLOT_COUNT; ++SlotIndex)
+    {
+        Input->LastSlots[SlotIndex] = Snapshot->Slots[SlotIndex];
+    }
+    ++Input->FrameCount;
+}
+
+// =====================================================================================================================
+
+inline int LinuxFormatControllerStats(linux_controller_input *Input, char *Buffer, int BufferSize)
+{
+    //NOTE: Returns the number of characters written, truncating if the buffer runs out. Changes the pad made that
+    //  no poll saw are missing from the seen count; they happened between two polls and undid each other.
+    controller_poller *Poller = Input->Poller;
+    controller_slot_state *Pad = Input->LastSlots;
+    uint64 ChangeCount = 0;
+    if (Pad->SampleCount)
+    {
+        ChangeCount = (Pad->SampleClock - Input->Pad.StartClock) / Input->Pad.TogglePeriod;
+    }
+    real64 MeasuredCount = Input->MeasuredChangeCount ? (real64)Input->MeasuredChangeCount : 1.0;
+    int Used = snprintf(Buffer, BufferSize,
+            "pad @ %lluHz: %u reads, %u of them empty slots; %u of %llu button changes seen, reaching a frame "
+            "%.03fms after they happened on average (%.03fms worst), %.03fms of that waiting for a poll\n",
+            (unsigned long long)(Poller->ClockFrequency / Poller->PeriodClocks),
+            Poller->ReadCount[0] + Poller->ReadCount[1] + Poller->ReadCount[2] + Poller->ReadCount[3],
+            Poller->EmptyReadCount, Pad->HalfTransitionCount[ControllerButton_ActionDown],
+            (unsigned long long)ChangeCount, Input->TotalFrameLatencyMS / MeasuredCount, Input->MaxFrameLatencyMS,
+            Input->TotalPollLatencyMS / MeasuredCount);
+    if (Used > BufferSize)
+    {
+        Used = BufferSize;
+    }
+    return(Used);
+}
+
+// =====================================================================================================================
+
+internal void LinuxCloseIORing(linux_io_ring *Ring)
+{
+    if (Ring->Submissions && (Ring->Submissions != MAP_FAILED))
+    {
+        munmap(Ring->Submissions, Ring->SubmissionsSize);
+    }
+    if (Ring->CompleteRing && (Ring->CompleteRing != MAP_FAILED) && (Ring->CompleteRing != Ring->SubmitRing))
+    {
+        munmap(Ring->CompleteRing, Ring->CompleteRingSize);
+    }
+    if (Ring->SubmitRing && (Ring->SubmitRing != MAP_FAILED))
+    {
+        munmap(Ring->SubmitRing, Ring->SubmitRingSize);
+    }
+    if (Ring->FileHandle >= 0)
+    {
+        close(Ring->FileHandle);
+    }
+
+    linux_io_ring Empty = {};
+    *Ring = Empty;
+    Ring->FileHandle = -1;
+}
+
+// =====================================================================================================================
+
+internal bool32 LinuxInitializeIORing(linux_io_ring *Ring, uint32 EntryCount)
+{
+    io_uring_params Params = {};
+    linux_io_ring Empty = {};
+    *Ring = Empty;
+    Ring->FileHandle = (int)syscall(__NR_io_uring_setup, EntryCount, &Params);
+    if (Ring->FileHandle < 0)
+    {
+        return(false);
+    }
+
+    //NOTE: Newer kernels map both rings at once; older ones need the completion ring mapped on its own.
+    bool32 SingleMapping = ((Params.features & IORING_FEAT_SINGLE_MMAP) != 0);
+    Ring->SubmitRingSize = Params.sq_off.array + Params.sq_entries * sizeof(uint32);
+    Ring->CompleteRingSize = Params.cq_off.cqes + Params.cq_entries * sizeof(io_uring_cqe);
+    if (SingleMapping)
+    {
+        if (Ring->SubmitRingSize < Ring->CompleteRingSize)
+        {
+            Ring->SubmitRingSize = Ring->CompleteRingSize;
+        }
+        Ring->CompleteRingSize = Ring->SubmitRingSize;
+    }
+    Ring->SubmissionsSize = Params.sq_entries * sizeof(io_uring_sqe);
+
+    Ring->SubmitRing = mmap(0, Ring->SubmitRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+            Ring->FileHandle, IORING_OFF_SQ_RING);
+    Ring->CompleteRing = SingleMapping ? Ring->SubmitRing : mmap(0, Ring->CompleteRingSize, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, Ring->FileHandle, IORING_OFF_CQ_RING);
+    Ring->Submissions = (io_uring_sqe *)mmap(0, Ring->SubmissionsSize, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, Ring->FileHandle, IORING_OFF_SQES);
+
+    bool32 Result = ((Ring->SubmitRing != MAP_FAILED) && (Ring->CompleteRing != MAP_FAILED) &&
+            (Ring->Submissions != MAP_FAILED));
+    if (Result)
+    {
+        uint8 *Submit = (uint8 *)Ring->SubmitRing;
+        uint8 *Complete = (uint8 *)Ring->CompleteRing;
+        Ring->SubmitHead = (uint32 volatile *)(Submit + Params.sq_off.head);
+        Ring->SubmitTail = (uint32 volatile *)(Submit + Params.sq_off.tail);
+        Ring->SubmitMask = *(uint32 *)(Submit + Params.sq_off.ring_mask);
+        Ring->SubmitArray = (uint32 *)(Submit + Params.sq_off.array);
+        Ring->CompleteHead = (uint32 volatile *)(Complete + Params.cq_off.head);
+        Ring->CompleteTail = (uint32 volatile *)(Complete + Params.cq_off.tail);
+        Ring->CompleteMask = *(uint32 *)(Complete + Params.cq_off.ring_mask);
+        Ring->Completions = (io_uring_cqe *)(Complete + Params.cq_off.cqes);
+    }
+    else
+    {
+        LinuxCloseIORing(Ring);
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline void LinuxAddCaptureWritePart(linux_capture_write *Write, void *Memory, uint64 Size)
+{
+    Assert(Write->PartCount < ArrayCount(Write->Parts));
+    Write->Parts[Write->PartCount].iov_base = Memory;
+    Write->Parts[Write->PartCount].iov_len = (size_t)Size;
+    ++Write->PartCount;
+    Write->Size += Size;
+}
+
+// =====================================================================================================================
+
+internal bool32 LinuxWriteCaptureSync(linux_capture *Capture, linux_capture_write *Write)
+{
+    //NOTE: Keeps going until everything is down, since even a regular file can take a short write.
+    iovec Parts[CAPTURE_SLOT_COUNT];
+    memcpy(Parts, Write->Parts, Write->PartCount * sizeof(iovec));
+    iovec *Part = Parts;
+    int PartCount = (int)Write->PartCount;
+    uint64 Offset = Write->Offset;
+    while (PartCount)
+    {
+        ssize_t Written = pwritev(Write->FileHandle, Part, PartCount, (off_t)Offset);
+        ++Capture->WriteCallCount;
+        if (Written <= 0)
+        {
+            if ((Written < 0) && (errno == EINTR))
+            {
+                continue;
+            }
+
+            //NOTE: Some file systems take O_DIRECT at open and only refuse it on the first write. The video is then
+            //  written through the page cache like everything else.
+            if ((Written < 0) && (errno == EINVAL) && Capture->UseDirectIO &&
+                    (Write->FileHandle == Capture->VideoFileHandle))
+            {
+                Capture->UseDirectIO = false;
+                int Flags = fcntl(Write->FileHandle, F_GETFL);
+                if ((Flags != -1) && (fcntl(Write->FileHandle, F_SETFL, Flags & ~O_DIRECT) == 0))
+                {
+                    continue;
+                }
+            }
+            return(false);
+        }
+
+        Offset += (uint64)Written;
+        while (PartCount && ((size_t)Written >= Part->iov_len))
+        {
+            Written -= (ssize_t)Part->iov_len;
+            ++Part;
+            --PartCount;
+        }
+        if (PartCount)
+        {
+            Part->iov_base = (uint8 *)Part->iov_base + Written;
+            Part->iov_len -= (size_t)Written;
+        }
+    }
+    return(true);
+}
+
+// =====================================================================================================================
+
+internal int LinuxEnterCaptureRing(linux_capture *Capture, uint32 SubmitCount, uint32 WaitCount)
+{
+    if (Capture->IORingFaultError)
+    {
+        if ((Capture->IORingEnterCount++ & 1) == 0)
+        {
+            SubmitCount = (SubmitCount + 1) / 2;
+            WaitCount = 0;
+        }
+        else
+        {
+            errno = Capture->IORingFaultError;
+            return(-1);
+        }
+    }
+
+    int Result = (int)syscall(__NR_io_uring_enter, Capture->Ring.FileHandle, SubmitCount, WaitCount,
+            IORING_ENTER_GETEVENTS, 0, 0);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void LinuxWriteCaptureRing(linux_capture *Capture, linux_capture_write *Writes, uint32 WriteCount,
+        bool32 *Done)
+{
+    //NOTE: The whole batch goes in with one call, which also waits for all of it to come back. Anything that comes
+    //  back failed or short, or that the kernel never took, is left for the caller to do over with pwritev.
+    //
+    //  Nothing returns while a write the kernel took is still outstanding, not even once the ring has broken: those
+    //  writes read straight out of the slots, which the frame loop refills as soon as they are released, and their
+    //  iovecs are on the caller's stack. So a ring that fails with writes outstanding is still reaped until they are
+    //  all back, and only the writes it never took go to pwritev. Running out of resources (EAGAIN) or completion
+    //  space (EBUSY) is waited out rather than taken as a broken ring. Every entry carries the batch it belongs to,
+    //  so a completion left over from an earlier batch can't be counted against this one.
+    linux_io_ring *Ring = &Capture->Ring;
+    uint64 BatchTag = (uint64)Capture->BatchCount << 32;
+    uint32 Tail = *Ring->SubmitTail;
+    for (uint32 WriteIndex = 0; WriteIndex < WriteCount; ++WriteIndex)
+    {
+        linux_capture_write *Write = Writes + WriteIndex;
+        uint32 Index = (Tail + WriteIndex) & Ring->SubmitMask;
+        io_uring_sqe *Submission = Ring->Submissions + Index;
+        memset(Submission, 0, sizeof(*Submission));
+        Submission->opcode = IORING_OP_WRITEV;
+        Submission->fd = Write->FileHandle;
+        Submission->addr = (uint64)Write->Parts;
+        Submission->len = Write->PartCount;
+        Submission->off = Write->Offset;
+        Submission->user_data = BatchTag | WriteIndex;
+        Ring->SubmitArray[Index] = Index;
+    }
+    AtomicStoreRelease(Ring->SubmitTail, Tail + WriteCount);
+
+    uint32 SubmitCount = WriteCount;
+    uint32 OutstandingCount = 0;
+    bool32 IsBroken = false;
+    while ((!IsBroken && SubmitCount) || OutstandingCount)
+    {
+        uint32 EnterSubmitCount = IsBroken ? 0 : SubmitCount;
+        int Entered = LinuxEnterCaptureRing(Capture, EnterSubmitCount, EnterSubmitCount + OutstandingCount);
+        ++Capture->WriteCallCount;
+        if (Entered >= 0)
+        {
+            Assert((uint32)Entered <= EnterSubmitCount);
+            SubmitCount -= (uint32)Entered;
+            OutstandingCount += (uint32)Entered;
+        }
+        else if ((errno == EAGAIN) || (errno == EBUSY))
+        {
+            //NOTE: Whatever is outstanding is reaped below, which is what makes room again.
+            timespec Wait = {0, 100000};
+            nanosleep(&Wait, 0);
+        }
+        else if (errno != EINTR)
+        {
+            //NOTE: Completions still land in the ring without entering it, so outstanding writes are waited for by
+            //  watching it.
+            if (IsBroken)
+            {
+                timespec Wait = {0, 1000000};
+                nanosleep(&Wait, 0);
+            }
+            IsBroken = true;
+        }
+
+        uint32 Head = *Ring->CompleteHead;
+        uint32 CompleteTail = AtomicLoadAcquire(Ring->CompleteTail);
+        for (; Head != CompleteTail; ++Head)
+        {
+            io_uring_cqe *Completion = Ring->Completions + (Head & Ring->CompleteMask);
+            uint64 WriteIndex = Completion->user_data & 0xFFFFFFFF;
+            if (((Completion->user_data & ~(uint64)0xFFFFFFFF) == BatchTag) && (WriteIndex < WriteCount))
+            {
+                linux_capture_write *Write = Writes + WriteIndex;
+                Done[WriteIndex] = ((Completion->res >= 0) && ((uint64)Completion->res == Write->Size));
+                --OutstandingCount;
+            }
+        }
+        AtomicStoreRelease(Ring->CompleteHead, Head);
+    }
+
+    //NOTE: This batch is finished with pwritev, and so is everything after it.
+    if (IsBroken)
+    {
+        Capture->UseIORing = false;
+    }
+}
+
+// =====================================================================================================================
+
+internal void LinuxReserveCaptureVideo(linux_capture *Capture, uint64 Size)
+{
+    //NOTE: Writer only. A second's worth of frames at a time, so the file system is asked once a second at most.
+    if (Capture->ReserveVideo && (Capture->VideoReservedSize < Size))
+    {
+        uint64 ReservedSize = Size + (uint64)LINUX_CAPTURE_RESERVE_FRAME_COUNT * Capture->Stream->FrameSize;
+        if (fallocate(Capture->VideoFileHandle, 0, (off_t)Capture->VideoReservedSize,
+                    (off_t)(ReservedSize - Capture->VideoReservedSize)) == 0)
+        {
+            Capture->VideoReservedSize = ReservedSize;
+        }
+        else
+        {
+            Capture->ReserveVideo = false;
+        }
+    }
+}
+
+// =====================================================================================================================
+
+internal void LinuxWriteCaptureBatch(linux_capture *Capture, uint32 FirstCount, uint32 SlotCount)
+{
+    //NOTE: One vectored write per run of frames that are next to each other in the raw file, the same for their
+    //  samples in the WAV, and one for all of their index entries, straight out of the slots. The slots aren't handed
+    //  back here, since the last of them may not have been published yet.
+    capture_stream *Stream = Capture->Stream;
+    uint64 SampleSize = 2 * sizeof(int16);
+
+    linux_capture_write Writes[LINUX_CAPTURE_MAX_WRITE_COUNT];
+    uint32 WriteCount = 0;
+    linux_capture_write *Index = Writes + WriteCount++;
+    Index->FileHandle = Capture->IndexFileHandle;
+    Index->Offset = sizeof(capture_index_header) + (uint64)Capture->EntryCount * sizeof(capture_index_entry);
+    Index->PartCount = 0;
+    Index->Size = 0;
+
+    linux_capture_write *Video = 0;
+    linux_capture_write *Audio = 0;
+    for (uint32 SlotIndex = 0; SlotIndex < SlotCount; ++SlotIndex)
+    {
+        capture_slot *Slot = GetCaptureSlot(Stream, FirstCount + SlotIndex);
+        capture_index_entry *Entry = &Slot->Entry;
+
+        uint64 VideoOffset = (uint64)Entry->FrameIndex * Stream->FrameSize;
+        if (!Video || ((Video->Offset + Video->Size) != VideoOffset))
+        {
+            Video = Writes + WriteCount++;
+            Video->FileHandle = Capture->VideoFileHandle;
+            Video->Offset = VideoOffset;
+            Video->PartCount = 0;
+            Video->Size = 0;
+        }
+        LinuxAddCaptureWritePart(Video, Slot->Pixels, Stream->FrameSize);
+
+        if (Entry->SampleCount)
+        {
+            uint64 AudioOffset = sizeof(wav_header) + Entry->SampleIndex * SampleSize;
+            if (!Audio || ((Audio->Offset + Audio->Size) != AudioOffset))
+            {
+                Audio = Writes + WriteCount++;
+                Audio->FileHandle = Capture->AudioFileHandle;
+                Audio->Offset = AudioOffset;
+                Audio->PartCount = 0;
+                Audio->Size = 0;
+            }
+            LinuxAddCaptureWritePart(Audio, Slot->Samples, Entry->SampleCount * SampleSize);
+        }
+
+        LinuxAddCaptureWritePart(Index, Entry, sizeof(capture_index_entry));
+    }
+    Assert(WriteCount <= ArrayCount(Writes));
+    LinuxReserveCaptureVideo(Capture, Video->Offset + Video->Size);
+
+    bool32 Done[LINUX_CAPTURE_MAX_WRITE_COUNT] = {};
+    bool32 WentToRing = Capture->UseIORing;
+    if (WentToRing)
+    {
+        LinuxWriteCaptureRing(Capture, Writes, WriteCount, Done);
+    }
+    for (uint32 WriteIndex = 0; WriteIndex < WriteCount; ++WriteIndex)
+    {
+        if (!Done[WriteIndex])
+        {
+            if (WentToRing)
+            {
+                ++Capture->RetryCount;
+            }
+            if (!LinuxWriteCaptureSync(Capture, Writes + WriteIndex))
+            {
+                ++Capture->ErrorCount;
+            }
+        }
+        Capture->ByteCount += Writes[WriteIndex].Size;
+    }
+
+    ++Capture->BatchCount;
+    if (Capture->MaxBatchSlotCount < SlotCount)
+    {
+        Capture->MaxBatchSlotCount = SlotCount;
+    }
+    Capture->EntryCount += SlotCount;
+    AtomicStoreRelease(&Capture->WrittenAheadCount, FirstCount + SlotCount);
+}
+
+// =====================================================================================================================
+
+internal void *LinuxCaptureThreadProc(void *Parameter)
+{
+    linux_capture *Capture = (linux_capture *)Parameter;
+    capture_stream *Stream = Capture->Stream;
+    for (;;)
+    {
+        //NOTE: Checked before the queue, so once it says stop, every frame submitted before that is already queued
+        //  and gets written before the thread goes. The picture comes first, since the frame loop may be waiting on
+        //  it.
+        bool32 IsRunning = AtomicLoadAcquire(&Capture->ThreadIsRunning);
+        uint32 PictureCount = 0;
+        bool32 Converted = ConvertCapturePicture(Stream, &PictureCount);
+        if (Converted)
+        {
+            sem_post(&Capture->PictureSemaphore);
+        }
+
+        //NOTE: A picture the writer converted goes out straight away, while the frame loop is still waiting for the
+        //  flip, rather than once it is published at the start of the next frame. That way the disk's side of the
+        //  write, the interrupts and the file system finishing it off, happens in the wait too instead of in the
+        //  middle of the game's next frame. Its slot only comes back once it has been published as well.
+        uint32 SubmitCount = AtomicLoadAcquire(&Stream->SubmitCount);
+        uint32 WrittenAheadCount = Capture->WrittenAheadCount;
+        if ((int32)(SubmitCount - WrittenAheadCount) > 0)
+        {
+            LinuxWriteCaptureBatch(Capture, WrittenAheadCount, SubmitCount - WrittenAheadCount);
+        }
+        if (Converted && (PictureCount == Capture->WrittenAheadCount))
+        {
+            LinuxWriteCaptureBatch(Capture, PictureCount, 1);
+        }
+
+        uint32 ReleaseCount = SubmitCount - Stream->WrittenCount;
+        if (ReleaseCount)
+        {
+            ReleaseCaptureSlots(Stream, ReleaseCount);
+        }
+        else if (Converted)
+        {
+            //NOTE: Nothing to hand back until the picture just written is published.
+        }
+        else if (!IsRunning)
+        {
+            break;
+        }
+        else
+        {
+            while (sem_wait(&Capture->Semaphore) != 0)
+            {
+                //NOTE: Interrupted by a signal.
+            }
+        }
+    }
+
+    timespec CPUTime;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &CPUTime) == 0)
+    {
+        Capture->WriterMS = (real64)CPUTime.tv_sec * 1000.0 + (real64)CPUTime.tv_nsec / 1000000.0;
+    }
+    return(0);
+}
+
+// =====================================================================================================================
+
+internal bool32 LinuxBeginCapture(linux_capture *Capture, memory_arena *Arena, char *Name, int Width, int Height,
+        pixel_format Format, uint32 SamplesPerSecond, uint32 MaxSampleCount, bool32 AllowIORing)
+{
+    //NOTE: The writer isn't started here, so frames can be queued up before it runs.
+    linux_capture Empty = {};
+    *Capture = Empty;
+    Capture->VideoFileHandle = -1;
+    Capture->AudioFileHandle = -1;
+    Capture->IndexFileHandle = -1;
+    Capture->Ring.FileHandle = -1;
+
+    //NOTE: The page cache buys a capture nothing, since nothing reads the frames back, and copying them into it and
+    //  writing it back later would cost far more processor time than the disk does straight from the slots.
+    memory_index FrameSize = (memory_index)Width * Height * GetPixelFormatBytesPerPixel(Format);
+    Capture->UseDirectIO = ((FrameSize % CAPTURE_PIXEL_ALIGNMENT) == 0);
+    Capture->ReserveVideo = true;
+    Capture->VideoReservedSize = 0;
+    Capture->WrittenAheadCount = 0;
+
+    char *Extensions[] = {(char *)"raw", (char *)"wav", (char *)"idx"};
+    int *FileHandles[] = {&Capture->VideoFileHandle, &Capture->AudioFileHandle, &Capture->IndexFileHandle};
+    bool32 Result = true;
+    for (int FileIndex = 0; Result && (FileIndex < (int)ArrayCount(Extensions)); ++FileIndex)
+    {
+        char FileName[LINUX_STATE_FILE_NAME_COUNT];
+        snprintf(FileName, sizeof(FileName), "%s.%s", Name, Extensions[FileIndex]);
+        int Flags = O_WRONLY | O_CREAT | O_TRUNC;
+        if ((FileIndex == 0) && Capture->UseDirectIO)
+        {
+            *FileHandles[FileIndex] = open(FileName, Flags | O_DIRECT, 0644);
+            Capture->UseDirectIO = (*FileHandles[FileIndex] >= 0);
+        }
+        if (*FileHandles[FileIndex] < 0)
+        {
+            *FileHandles[FileIndex] = open(FileName, Flags, 0644);
+        }
+        Result = (*FileHandles[FileIndex] >= 0);
+    }
+
+    if (Result)
+    {
+        Capture->Stream = InitializeCaptureStream(Arena, Width, Height, Format, SamplesPerSecond, MaxSampleCount,
+                LinuxGetWallClock());
+
+        //NOTE: The headers go out now with nothing counted yet, so a capture that gets cut short still opens.
+        wav_header WAVHeader = MakeWAVHeader(SamplesPerSecond, 0);
+        capture_index_header IndexHeader = MakeCaptureIndexHeader(Capture->Stream);
+        Result = ((pwrite(Capture->AudioFileHandle, &WAVHeader, sizeof(WAVHeader), 0) == sizeof(WAVHeader)) &&
+                (pwrite(Capture->IndexFileHandle, &IndexHeader, sizeof(IndexHeader), 0) == sizeof(IndexHeader)));
+    }
+
+    if (Result)
+    {
+        Capture->UseIORing = (AllowIORing && LinuxInitializeIORing(&Capture->Ring, 2 * LINUX_CAPTURE_MAX_WRITE_COUNT));
+        sem_init(&Capture->Semaphore, 0, 0);
+        sem_init(&Capture->PictureSemaphore, 0, 0);
+        Capture->IsCapturing = true;
+    }
+    else
+    {
+        for (int FileIndex = 0; FileIndex < (int)ArrayCount(FileHandles); ++FileIndex)
+        {
+            if (*FileHandles[FileIndex] >= 0)
+            {
+                close(*FileHandles[FileIndex]);
+                *FileHandles[FileIndex] = -1;
+            }
+        }
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 LinuxStartCaptureThread(linux_capture *Capture)
+{
+    Capture->ThreadIsRunning = 1;
+    Capture->HasThread = (pthread_create(&Capture->Thread, 0, LinuxCaptureThreadProc, Capture) == 0);
+    if (Capture->HasThread)
+    {
+        //NOTE: The writer only gets processor time nobody else wants. Otherwise, with the frame loop sharing its core,
+        //  every frame handed over would wake the writer straight into the middle of the frame. Frames it can't get to
+        //  pile up in the pool and go out as one batch, and past that they are dropped, never the game slowed down.
+        sched_param Param = {};
+        pthread_setschedparam(Capture->Thread, SCHED_IDLE, &Param);
+    }
+    return(Capture->HasThread);
+}
+
+// =====================================================================================================================
+
+inline void LinuxAddCaptureTime(linux_capture *Capture, uint64 StartCounter)
+{
+    real64 MSElapsed = LinuxGetMSElapsed(StartCounter, LinuxGetWallClock());
+    Capture->TotalSubmitMS += MSElapsed;
+    if (Capture->MaxSubmitMS < MSElapsed)
+    {
+        Capture->MaxSubmitMS = MSElapsed;
+    }
+}
+
+// =====================================================================================================================
+
+internal bool32 LinuxCaptureFrame(linux_capture *Capture, game_offscreen_buffer *Picture, int16 *Samples,
+        uint32 SampleCount)
+{
+    //NOTE: The picture has to be left alone until LinuxTakeCapturePicture.
+    uint64 StartCounter = LinuxGetWallClock();
+    bool32 Result = SubmitCaptureFrame(Capture->Stream, Picture, Samples, SampleCount, StartCounter);
+    if (Result)
+    {
+        sem_post(&Capture->Semaphore);
+    }
+
+    ++Capture->SubmitCallCount;
+    LinuxAddCaptureTime(Capture, StartCounter);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void LinuxTakeCapturePicture(linux_capture *Capture)
+{
+    //NOTE: Called before anything draws over the last picture handed over. Usually the writer is long done with it.
+    capture_stream *Stream = Capture->Stream;
+    if (AtomicLoadAcquire(&Stream->PictureState) != CapturePicture_None)
+    {
+        uint64 StartCounter = LinuxGetWallClock();
+        uint32 PictureCount;
+        if (ConvertCapturePicture(Stream, &PictureCount))
+        {
+            ++Capture->LatePictureCount;
+        }
+        else if (AtomicLoadAcquire(&Stream->PictureState) != CapturePicture_Converted)
+        {
+            //NOTE: Blocking rather than spinning, since the writer may only run once this thread gets off the core.
+            //  The state is checked again after clearing, in case the post for this picture went with the others.
+            ++Capture->LatePictureCount;
+            while (sem_trywait(&Capture->PictureSemaphore) == 0)
+            {
+                //NOTE: Posts for pictures the writer finished while nobody was waiting.
+            }
+            while (AtomicLoadAcquire(&Stream->PictureState) != CapturePicture_Converted)
+            {
+                sem_wait(&Capture->PictureSemaphore);
+            }
+        }
+        PublishCapturePicture(Stream);
+        sem_post(&Capture->Semaphore);
+        LinuxAddCaptureTime(Capture, StartCounter);
+    }
+}
+
+// =====================================================================================================================
+
+internal bool32 LinuxEndCapture(linux_capture *Capture)
+{
+    //NOTE: Without a writer thread, whatever is queued is written here.
+    LinuxTakeCapturePicture(Capture);
+    if (Capture->HasThread)
+    {
+        AtomicStoreRelease(&Capture->ThreadIsRunning, 0);
+        sem_post(&Capture->Semaphore);
+        pthread_join(Capture->Thread, 0);
+        Capture->HasThread = false;
+    }
+    capture_stream *Stream = Capture->Stream;
+    uint32 SubmitCount = Stream->SubmitCount;
+    if (SubmitCount != Capture->WrittenAheadCount)
+    {
+        LinuxWriteCaptureBatch(Capture, Capture->WrittenAheadCount, SubmitCount - Capture->WrittenAheadCount);
+    }
+    if (SubmitCount != Stream->WrittenCount)
+    {
+        ReleaseCaptureSlots(Stream, SubmitCount - Stream->WrittenCount);
+    }
+
+    //NOTE: Frames dropped at the very end were never written, so the files are stretched out to where they would
+    //  have ended, then the headers get their final counts.
+    wav_header WAVHeader = MakeWAVHeader(Stream->SamplesPerSecond, Stream->SampleCount);
+    capture_index_header IndexHeader = MakeCaptureIndexHeader(Stream);
+    bool32 Result = ((Capture->ErrorCount == 0) &&
+            (ftruncate(Capture->VideoFileHandle, (off_t)((uint64)Stream->FrameCount * Stream->FrameSize)) == 0) &&
+            (ftruncate(Capture->AudioFileHandle, (off_t)(sizeof(wav_header) + WAVHeader.DataSize)) == 0) &&
+            (pwrite(Capture->AudioFileHandle, &WAVHeader, sizeof(WAVHeader), 0) == sizeof(WAVHeader)) &&
+            (pwrite(Capture->IndexFileHandle, &IndexHeader, sizeof(IndexHeader), 0) == sizeof(IndexHeader)));
+
+    close(Capture->VideoFileHandle);
+    close(Capture->AudioFileHandle);
+    close(Capture->IndexFileHandle);
+    if (Capture->Ring.FileHandle >= 0)
+    {
+        LinuxCloseIORing(&Capture->Ring);
+    }
+    sem_destroy(&Capture->Semaphore);
+    sem_destroy(&Capture->PictureSemaphore);
+    Capture->IsCapturing = false;
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline int LinuxFormatCaptureStats(linux_capture *Capture, char *Buffer, int BufferSize)
+{
+    capture_stream *Stream = Capture->Stream;
+    real64 SubmitMS = Capture->SubmitCallCount ? (Capture->TotalSubmitMS / (real64)Capture->SubmitCallCount) : 0.0;
+    int Result = snprintf(Buffer, BufferSize, "capture: %u of %u frames (%u dropped), %.01fMB in %u batches of up to "
+            "%u frames, %llu %s%s calls, %u retried, %u failed; frame loop %.03fms/f, worst %.03fms, %u late; "
+            "writer %.03fms/f\n",
+            Stream->FrameCount - Stream->DroppedFrameCount, Stream->FrameCount, Stream->DroppedFrameCount,
+            (real64)Capture->ByteCount / (1024.0 * 1024.0), Capture->BatchCount, Capture->MaxBatchSlotCount,
+            (unsigned long long)Capture->WriteCallCount, Capture->UseIORing ? "io_uring" : "pwritev",
+            Capture->UseDirectIO ? " direct" : "",
+            Capture->RetryCount, Capture->ErrorCount, SubmitMS, Capture->MaxSubmitMS, Capture->LatePictureCount,
+            Stream->FrameCount ? (Capture->WriterMS / (real64)Stream->FrameCount) : 0.0);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal int LinuxGetProcessorCount(void)
+{
+    long Result = sysconf(_SC_NPROCESSORS_ONLN);
+    return((Result > 0) ? (int)Result : 1);
+}
+
+// =====================================================================================================================
+
+internal void LinuxRecordFrame(linux_frame_stats *Stats, uint64 CyclesElapsed, real64 MSElapsed)
+{
+    if (Stats->FrameCount == 0)
+    {
+        Stats->MinCycles = Stats->MaxCycles = CyclesElapsed;
+        Stats->MinMS = Stats->MaxMS = MSElapsed;
+    }
+
+    if (CyclesElapsed < Stats->MinCycles) {Stats->MinCycles = CyclesElapsed;}
+    if (CyclesElapsed > Stats->MaxCycles) {Stats->MaxCycles = CyclesElapsed;}
+    if (MSElapsed < Stats->MinMS) {Stats->MinMS = MSElapsed;}
+    if (MSElapsed > Stats->MaxMS) {Stats->MaxMS = MSElapsed;}
+
+    Stats->TotalCycles += CyclesElapsed;
+    Stats->TotalMS += MSElapsed;
+    ++Stats->FrameCount;
+}
+
+// =====================================================================================================================
+
+internal void LinuxPrintFrameStats(linux_frame_stats *Stats, game_offscreen_buffer *Buffer,
+        game_offscreen_buffer *Display)
+{
+    if (Stats->FrameCount)
+    {
+        real64 AverageMS = Stats->TotalMS / (real64)Stats->FrameCount;
+        real64 AverageMC = ((real64)Stats->TotalCycles / (real64)Stats->FrameCount) / (1000.0 * 1000.0);
+        printf("%d frames\n", Stats->FrameCount);
+        printf("  ms/f:  min %.03f  avg %.03f  max %.03f\n", Stats->MinMS, AverageMS, Stats->MaxMS);
+        printf("  mc/f:  min %.03f  avg %.03f  max %.03f\n",
+                (real64)Stats->MinCycles / (1000.0 * 1000.0), AverageMC, (real64)Stats->MaxCycles / (1000.0 * 1000.0));
+        printf("  f/s:   %.02f\n", 1000.0 / AverageMS);
+
+        real64 Rendered = (real64)Stats->TotalRenderedPixels / (real64)Stats->FrameCount;
+        printf("  px/f:  rendered %.0f (%.01f%%)", Rendered,
+                100.0 * Rendered / ((real64)Buffer->Width * (real64)Buffer->Height));
+        if (Display)
+        {
+            real64 Presented = (real64)Stats->TotalPresentedPixels / (real64)Stats->FrameCount;
+            printf("  presented %.0f (%.01f%%)", Presented,
+                    100.0 * Presented / ((real64)Display->Width * (real64)Display->Height));
+        }
+        printf("\n");
+    }
+}
+
+// =====================================================================================================================
+
+//NOTE: handmade_bench.cpp reuses this platform layer and brings its own main.
+#if !defined(LINUX_HANDMADE_NO_MAIN)
+int main(int ArgCount, char **Args)
+{
+    int FrameCount = 600;
+    int BufferWidth = 1280;
+    int BufferHeight = 720;
+    int RenderThreadCount = LinuxGetProcessorCount();
+    int GameUpdateHz = 0;
+    char *RecordFileName = 0;
+    char *PlaybackFileName = 0;
+    char *TraceFileName = 0;
+    int DisplayWidth = 0;
+    int DisplayHeight = 0;
+    present_mode PresentMode = PresentMode_Integer;
+    bool32 Quiet = false;
+    int AudioLatencyMS = 0;
+    char *AudioFileName = 0;
+    int HitchEvery = 0;
+    int HitchMS = 0;
+    int PadPollHz = 0;
+    bool32 ConvertPixelsOut = false;
+    pixel_format OutputFormat = PixelFormat_BGRX32;
+    char *CaptureName = 0;
+
+    for (int ArgIndex = 1; ArgIndex < ArgCount; ++ArgIndex)
+    {
+        char *Arg = Args[ArgIndex];
+        if ((strcmp(Arg, "-frames") == 0) && ((ArgIndex + 1) < ArgCount))
+        {
+            FrameCount = atoi(Args[++ArgIndex]);
+        }
+        else if ((strcmp(Arg, "-size") == 0) && ((ArgIndex + 2) < ArgCount))
+        {
+            BufferWidth = atoi(Args[++ArgIndex]);
+            BufferHeight = atoi(Args[++ArgIndex]);
+        }
+        else if ((strcmp(Arg, "-threads") == 0) && ((ArgIndex + 1) < ArgCount))
+        {
+            RenderThreadCount = atoi(Args[++ArgIndex]);
+            if (RenderThreadCount < 1)
+            {
+                RenderThreadCount = 1;
+            }
+        }
+        else if ((strcmp(Arg, "-hz") == 0) && ((ArgIndex + 1) < ArgCount))
+        {
+            GameUpdateHz = atoi(Args[++ArgIndex]);
+            if (GameUpdateHz < 0)
+            {
+                GameUpdateHz = 0;
+            }
+        }
+        else if ((strcmp(Arg, "-record") == 0) && ((ArgIndex + 1) < ArgCount))
+        {
+            RecordFileName = Args[++ArgIndex];
+        }
+        else if ((strcmp(Arg, "-playback") == 0) && ((ArgIndex + 1) < ArgCount))
+        {
+            PlaybackFileName = Args[++ArgIndex];
+        }
+        else if ((strcmp(Arg, "-trace") == 0) && ((ArgIndex + 1) < ArgCount))
+        {
+            TraceFileName = Args[++ArgIndex];
+        }
+        else if ((strcmp(Arg, "-display") == 0) && ((ArgIndex + 2) < ArgCount))
+        {
+            DisplayWidth = atoi(Args[++ArgIndex]);
+            DisplayHeight = atoi(Args[++ArgIndex]);
+            if ((DisplayWidth < 1) || (DisplayHeight < 1) ||
+                    (DisplayWidth > PRESENT_MAX_WIDTH) || (DisplayHeight > PRESENT_MAX_HEIGHT))
+            {
+                fprintf(stderr, "Display size must be between 1x1 and %dx%d\n", PRESENT_MAX_WIDTH, PRESENT_MAX_HEIGHT);
+                return(1);
+            }
+        }
+        else if (strcmp(Arg, "-bilinear") == 0)
+        {
+            PresentMode = PresentMode_Bilinear;
+        }
+        else if (strcmp(Arg, "-quiet") == 0)
+        {
+            Quiet = true;
+        }
+        else if ((strcmp(Arg, "-audio") == 0) && ((ArgIndex + 1) < ArgCount))
+        {
+            AudioLatencyMS = atoi(Args[++ArgIndex]);
+            if ((AudioLatencyMS < 1) || (AudioLatencyMS > SOUND_FEED_MAX_LATENCY_MS))
+            {
+                fprintf(stderr, "Audio latency must be between 1 and %dms\n", SOUND_FEED_MAX_LATENCY_MS);
+                return(1);
+            }
+        }
+        else if ((strcmp(Arg, "-audio-file") == 0) && ((ArgIndex + 1) < ArgCount))
+        {
+            AudioFileName = Args[++ArgIndex];
+        }
+        else if ((strcmp(Arg, "-hitch") == 0) && ((ArgIndex + 2) < ArgCount))
+        {
+            HitchEvery = atoi(Args[++ArgIndex]);
+            HitchMS = atoi(Args[++ArgIndex]);
+            if ((HitchEvery < 1) || (HitchMS < 0))
+            {
+                HitchEvery = 0;
+            }
+        }
+        else if ((strcmp(Arg, "-pad") == 0) && ((ArgIndex + 1) < ArgCount))
+        {
+            PadPollHz = atoi(Args[++ArgIndex]);
+            if ((PadPollHz < 1) || (PadPollHz > CONTROLLER_POLL_MAX_HZ))
+            {
+                fprintf(stderr, "Pad poll rate must be between 1 and %dHz\n", CONTROLLER_POLL_MAX_HZ);
+                return(1);
+            }
+        }
+        else if ((strcmp(Arg, "-pixels") == 0) && ((ArgIndex + 1) < ArgCount))
+        {
+            ConvertPixelsOut = ParsePixelFormat(Args[++ArgIndex], &OutputFormat);
+            if (!ConvertPixelsOut)
+            {
+                fprintf(stderr, "Pixel format must be bgrx32, rgb565 or indexed8\n");
+                return(1);
+            }
+        }
+        else if ((strcmp(Arg, "-capture") == 0) && ((ArgIndex + 1) < ArgCount))
+        {
+            CaptureName = Args[++ArgIndex];
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [-frames N] [-size Width Height] [-threads N] [-hz N] "
+                    "[-record File | -playback File] [-trace File] [-display Width Height [-bilinear]] "
+                    "[-audio LatencyMS [-audio-file File]] [-hitch EveryN MS] [-pad PollHz] [-pixels Format] "
+                    "[-capture Name] [-quiet]\n",
+                    Args[0]);
+            return(1);
+        }
+    }
+
+    //NOTE: Uncapped, we pretend to run at 60Hz as far as audio goes, so every frame asks for one 60th of a second of
+    //  samples. Locked, every frame asks for exactly one frame's worth at the target rate.
+    int AudioUpdateHz = GameUpdateHz ? GameUpdateHz : 60;
+    linux_sound_output SoundOutput = {};
+    SoundOutput.SamplesPerSecond = 48000;
+    SoundOutput.BytesPerSample = sizeof(int16) * 2;
+    SoundOutput.SamplesPerFrame = SoundOutput.SamplesPerSecond / AudioUpdateHz;
+
+    if (AudioFileName && !AudioLatencyMS)
+    {
+        AudioLatencyMS = SOUND_FEED_DEFAULT_LATENCY_MS;
+    }
+
+    int BytesPerPixel = 4;
+    memory_index BackbufferSize = (memory_index)BufferWidth * BufferHeight * BytesPerPixel;
+    memory_index SoundBufferSize = (memory_index)SoundOutput.SamplesPerSecond * SoundOutput.BytesPerSample;
+    memory_index AudioStorageSize = AudioLatencyMS ?
+        (SoundBufferSize + SOUND_RING_SAMPLE_COUNT * SoundOutput.BytesPerSample + 128) : 0;
+
+#if HANDMADE_INTERNAL
+    void *BaseAddress = (void *)Terabytes(2);
+#else
+    void *BaseAddress = 0;
+#endif
+
+    game_memory GameMemory = {};
+    GameMemory.PermanentStorageSize = Megabytes(64);
+    GameMemory.TransientStorageSize = Gigabytes(1);
+    memory_index DisplayBufferSize = (memory_index)DisplayWidth * DisplayHeight * BytesPerPixel;
+    memory_index PresentStorageSize = DisplayWidth ? GetPresentStorageSize() : 0;
+    int PictureWidth = DisplayWidth ? DisplayWidth : BufferWidth;
+    int PictureHeight = DisplayWidth ? DisplayHeight : BufferHeight;
+    memory_index OutputBufferSize = (ConvertPixelsOut && !CaptureName) ?
+        ((memory_index)PictureWidth * PictureHeight * GetPixelFormatBytesPerPixel(OutputFormat)) : 0;
+    memory_index CaptureStorageSize = CaptureName ? GetCaptureStorageSize(PictureWidth, PictureHeight, OutputFormat,
+            (uint32)SoundOutput.SamplesPerSecond) : 0;
+    memory_index PlatformStorageSize = BackbufferSize + SoundBufferSize + AudioStorageSize + DisplayBufferSize +
+        PresentStorageSize + OutputBufferSize + CaptureStorageSize + sizeof(game_dirty_region) +
+        (PadPollHz ? (sizeof(controller_poller) + 64) : 0) + Kilobytes(64);
+#if HANDMADE_INTERNAL
+    memory_index DebugStorageSize = Megabytes(64);
+#else
+    memory_index DebugStorageSize = 0;
+#endif
+
+    linux_state LinuxState = {};
+    LinuxState.TotalSize = GameMemory.PermanentStorageSize + GameMemory.TransientStorageSize + PlatformStorageSize +
+        DebugStorageSize;
+    LinuxState.GameMemoryBlock = LinuxReserveMemory(BaseAddress, LinuxState.TotalSize);
+#if HANDMADE_INTERNAL
+    GlobalNextFileMappingAddress = (uint8 *)BaseAddress + Terabytes(1);
+#endif
+    if (!LinuxState.GameMemoryBlock)
+    {
+        fprintf(stderr, "Unable to reserve memory\n");
+        return(1);
+    }
+
+    GameMemory.PermanentStorage = LinuxState.GameMemoryBlock;
+    GameMemory.TransientStorage = ((uint8 *)GameMemory.PermanentStorage + GameMemory.PermanentStorageSize);
+    InitializeArena(&LinuxState.PlatformArena, (char *)"Platform", PlatformStorageSize,
+            (uint8 *)GameMemory.TransientStorage + GameMemory.TransientStorageSize);
+    RegisterArena(&GameMemory.ArenaRegistry, &LinuxState.PlatformArena);
+
+#if HANDMADE_INTERNAL
+    //NOTE: The profiler's table has to exist before anything records into it, including the worker threads.
+    InitializeArena(&LinuxState.DebugArena, (char *)"Debug", DebugStorageSize,
+            LinuxState.PlatformArena.Base + LinuxState.PlatformArena.Size);
+    RegisterArena(&GameMemory.ArenaRegistry, &LinuxState.DebugArena);
+
+    debug_table *DebugTable = PushStruct(&LinuxState.DebugArena, debug_table, 64);
+    LinuxState.DebugState = PushStruct(&LinuxState.DebugArena, debug_state, 64);
+    InitializeDebugState(LinuxState.DebugState, DebugTable, &LinuxState.DebugArena);
+    GlobalDebugTable = DebugTable;
+    GameMemory.DebugTable = DebugTable;
+#endif
+
+    LinuxGetEXEFileName(&LinuxState);
+
+    char SourceGameCodeSOFullPath[LINUX_STATE_FILE_NAME_COUNT];
+    LinuxBuildEXEPathFileName(&LinuxState, (char *)"handmade.so",
+            sizeof(SourceGameCodeSOFullPath), SourceGameCodeSOFullPath);
+
+    char TempGameCodeSOFullPath[LINUX_STATE_FILE_NAME_COUNT];
+    LinuxBuildEXEPathFileName(&LinuxState, (char *)"handmade_temp.so",
+            sizeof(TempGameCodeSOFullPath), TempGameCodeSOFullPath);
+
+    char GameCodeLockFullPath[LINUX_STATE_FILE_NAME_COUNT];
+    LinuxBuildEXEPathFileName(&LinuxState, (char *)"lock.tmp", sizeof(GameCodeLockFullPath), GameCodeLockFullPath);
+
+    linux_game_code Game = LinuxLoadGameCode(SourceGameCodeSOFullPath, TempGameCodeSOFullPath);
+    if (!Game.IsValid)
+    {
+        fprintf(stderr, "Unable to load %s, running the stub\n", SourceGameCodeSOFullPath);
+    }
+
+    game_offscreen_buffer Buffer = {};
+    Buffer.Width = BufferWidth;
+    Buffer.Height = BufferHeight;
+    Buffer.BytesPerPixel = BytesPerPixel;
+    Buffer.Pitch = Buffer.Width * Buffer.BytesPerPixel;
+    Buffer.Memory = PushSize(&LinuxState.PlatformArena, BackbufferSize, 64);
+    Buffer.Dirty = PushStruct(&LinuxState.PlatformArena, game_dirty_region, 64);
+    Buffer.Dirty->Invalidate = true;
+
+    int16 *Samples = (int16 *)PushSize(&LinuxState.PlatformArena, SoundBufferSize, 64);
+
+    game_offscreen_buffer DisplayBuffer = {};
+    present_state *PresentState = 0;
+    if (DisplayWidth)
+    {
+        DisplayBuffer.Width = DisplayWidth;
+        DisplayBuffer.Height = DisplayHeight;
+        DisplayBuffer.BytesPerPixel = BytesPerPixel;
+        DisplayBuffer.Pitch = DisplayBuffer.Width * DisplayBuffer.BytesPerPixel;
+        DisplayBuffer.Memory = PushSize(&LinuxState.PlatformArena, DisplayBufferSize, 64);
+
+        PresentState = PushStruct(&LinuxState.PlatformArena, present_state, 64);
+        InitializePresentState(PresentState, &LinuxState.PlatformArena, PresentMode);
+    }
+
+    //NOTE: The finished picture, converted into the format a capture or a narrower window would be handed. Both
+    //  buffers have packed rows, so the whole picture goes through the converter as a single run.
+    game_offscreen_buffer *Picture = PresentState ? &DisplayBuffer : &Buffer;
+    game_offscreen_buffer OutputBuffer = {};
+    pixel_kernels OutputKernels = {};
+    if (OutputBufferSize)
+    {
+        OutputBuffer.Width = Picture->Width;
+        OutputBuffer.Height = Picture->Height;
+        OutputBuffer.BytesPerPixel = GetPixelFormatBytesPerPixel(OutputFormat);
+        OutputBuffer.Pitch = OutputBuffer.Width * OutputBuffer.BytesPerPixel;
+        OutputBuffer.Memory = PushSize(&LinuxState.PlatformArena, OutputBufferSize, 64);
+        OutputKernels = GetPixelKernels(OutputFormat, GetBufferLayout(Picture));
+    }
+
+    //NOTE: A capture takes the same picture, converted into its pool instead, along with the frame's samples.
+    linux_capture Capture = {};
+    if (CaptureName)
+    {
+        if (!LinuxBeginCapture(&Capture, &LinuxState.PlatformArena, CaptureName, Picture->Width, Picture->Height,
+                    OutputFormat, (uint32)SoundOutput.SamplesPerSecond, (uint32)SoundOutput.SamplesPerSecond, true) ||
+                !LinuxStartCaptureThread(&Capture))
+        {
+            fprintf(stderr, "Unable to capture to %s\n", CaptureName);
+            return(1);
+        }
+    }
+
+    //NOTE: The main thread joins the work in LinuxCompleteAllWork, so it counts as one of the render threads.
+    platform_work_queue HighPriorityQueue = {};
+    LinuxMakeQueue(&HighPriorityQueue, RenderThreadCount - 1);
+
+    //NOTE: Asset loads spend most of their time waiting on the disk, so they get a couple of threads of their own
+    //  rather than holding up render work.
+    platform_work_queue LowPriorityQueue = {};
+    LinuxMakeQueue(&LowPriorityQueue, 2);
+
+    GameMemory.HighPriorityQueue = &HighPriorityQueue;
+    GameMemory.LowPriorityQueue = &LowPriorityQueue;
+    GameMemory.PlatformAPI.AddEntry = LinuxAddEntry;
+    GameMemory.PlatformAPI.CompleteAllWork = LinuxCompleteAllWork;
+    GameMemory.PlatformAPI.MapFile = LinuxMapFile;
+    GameMemory.PlatformAPI.UnmapFile = LinuxUnmapFile;
+
+    if (AudioLatencyMS)
+    {
+        if (!LinuxStartAudioThread(&SoundOutput, &LinuxState.PlatformArena, (uint32)AudioLatencyMS, AudioFileName))
+        {
+            fprintf(stderr, "Unable to start the audio thread%s%s\n", AudioFileName ? " writing to " : "",
+                    AudioFileName ? AudioFileName : "");
+            return(1);
+        }
+    }
+
+    //NOTE: The fake pad flips its button every 97ms: slow enough that every change lands in a frame of its own, and
+    //  a prime number of milliseconds so the changes don't lock to the frame or poll rate and skew the latencies.
+    linux_controller_input ControllerInput = {};
+    if (PadPollHz)
+    {
+        if (!LinuxStartControllerThread(&ControllerInput, &LinuxState.PlatformArena, (uint32)PadPollHz, 97))
+        {
+            fprintf(stderr, "Unable to start the controller thread\n");
+            return(1);
+        }
+    }
+
+    game_input Input[2] = {};
+    game_input *NewInput = &Input[0];
+    game_input *OldInput = &Input[1];
+
+    linux_frame_stats Stats = {};
+    frame_timing_stats FrameStats;
+    real32 TargetSecondsPerFrame = 1.0f / (real32)AudioUpdateHz;
+    BeginFrameTimingStats(&FrameStats, TargetSecondsPerFrame);
+
+    int ReloadCount = 0;
+    real64 MaxReloadMS = 0.0;
+
+    uint64 LastCounter = LinuxGetWallClock();
+    for (int FrameIndex = 0; FrameIndex < FrameCount; ++FrameIndex)
+    {
+        //NOTE: Reloads only happen here, between frames, where the render queue is guaranteed to be empty and nothing
+        //  is still running module code. Loads still in flight on the low priority queue would be running module
+        //  code, so they get finished first. The lock file is there for as long as the build is writing the module.
+        timespec NewSOWriteTime = LinuxGetLastWriteTime(SourceGameCodeSOFullPath);
+        if (!LinuxFileTimesMatch(NewSOWriteTime, Game.SOLastWriteTime) && !LinuxFileExists(GameCodeLockFullPath))
+        {
+            TIMED_BLOCK("ReloadGameCode");
+            uint64 ReloadStart = LinuxGetWallClock();
+            LinuxCompleteAllWork(&LowPriorityQueue);
+#if HANDMADE_INTERNAL
+            CollateDebugRings(LinuxState.DebugState);
+#endif
+            LinuxUnloadGameCode(&Game);
+            Game = LinuxLoadGameCode(SourceGameCodeSOFullPath, TempGameCodeSOFullPath);
+            real64 ReloadMS = LinuxGetMSElapsed(ReloadStart, LinuxGetWallClock());
+
+            ++ReloadCount;
+            if (ReloadMS > MaxReloadMS)
+            {
+                MaxReloadMS = ReloadMS;
+            }
+            //NOTE: New code may draw the same commands differently.
+            Buffer.Dirty->Invalidate = true;
+            printf("reloaded game code in %.03fms%s%s\n", ReloadMS,
+                    (ReloadMS > (1000.0 * TargetSecondsPerFrame)) ? " (over frame budget)" : "",
+                    Game.IsValid ? "" : " (invalid, running the stub)");
+        }
+
+        //NOTE: Recording and playback both start on the second frame, once the game has initialized its memory,
+        //  so that the snapshot never has to stand in for initialization.
+        if ((FrameIndex == 1) && RecordFileName)
+        {
+            if (!LinuxBeginRecordingInput(&LinuxState, &GameMemory, RecordFileName, (uint32)FrameCount))
+            {
+                fprintf(stderr, "Unable to record to %s\n", RecordFileName);
+                return(1);
+            }
+        }
+        if ((FrameIndex == 1) && PlaybackFileName)
+        {
+            if (!LinuxBeginInputPlayBack(&LinuxState, &GameMemory, PlaybackFileName))
+            {
+                fprintf(stderr, "Unable to play back %s, or it was recorded by a different build\n",
+                        PlaybackFileName);
+                return(1);
+            }
+        }
+
+        if (RecordFileName)
+        {
+            LinuxScriptKeyboard(GetController(OldInput, 0), GetController(NewInput, 0), FrameIndex);
+        }
+        else
+        {
+            //NOTE: Nobody is holding the keyboard, but it is always plugged in.
+            GetController(NewInput, 0)->IsConnected = true;
+        }
+
+        if (ControllerInput.HasThread)
+        {
+            LinuxReadControllers(&ControllerInput, NewInput);
+        }
+        NewInput->dtForFrame = TargetSecondsPerFrame;
+
+        //NOTE: Normally a load becomes visible whenever it happens to finish. While recording or playing back they
+        //  are all finished between frames instead, so every loop sees the same assets arrive on the same frames.
+        if (LinuxState.IsRecording || LinuxState.IsPlayingBack)
+        {
+            LinuxCompleteAllWork(&LowPriorityQueue);
+        }
+
+        if (LinuxState.IsPlayingBack)
+        {
+            //NOTE: A rewind puts game memory back to the start of the recording, but the backbuffer still holds the
+            //  last frame of the loop.
+            LinuxPlayBackInput(&LinuxState, &GameMemory, NewInput);
+            if (LinuxState.PlaybackFrameIndex == 0)
+            {
+                Buffer.Dirty->Invalidate = true;
+            }
+        }
+
+        uint64 StartCounter = LinuxGetWallClock();
+        uint64 StartCycleCount = __rdtsc();
+
+        if (HitchEvery && ((FrameIndex % HitchEvery) == (HitchEvery - 1)))
+        {
+            //NOTE: Stands in for a frame whose game code ran long.
+            timespec HitchTime = {(time_t)(HitchMS / 1000), (long)(HitchMS % 1000) * 1000000L};
+            nanosleep(&HitchTime, 0);
+        }
+
+        game_sound_output_buffer SoundBuffer = {};
+        SoundBuffer.SamplesPerSecond = SoundOutput.SamplesPerSecond;
+        SoundBuffer.SampleCount = SoundOutput.SamplesPerFrame;
+        SoundBuffer.Samples = Samples;
+        if (SoundOutput.HasAudioThread)
+        {
+            //NOTE: Enough to see the device through the next frame, plus the latency target again as slack for a
+            //  frame that runs long.
+            SoundBuffer.SampleCount = (int)GetSoundRingProduceCount(&SoundOutput.Ring,
+                    (uint32)SoundOutput.SamplesPerFrame + SoundOutput.Feed.LatencySampleCount,
+                    (uint32)SoundOutput.SamplesPerSecond);
+        }
+
+        if (Capture.IsCapturing)
+        {
+            TIMED_BLOCK("TakeCapturePicture");
+            LinuxTakeCapturePicture(&Capture);
+        }
+        Game.UpdateAndRender(&GameMemory, NewInput, &Buffer, &SoundBuffer);
+
+        if (SoundOutput.HasAudioThread)
+        {
+            WriteSoundRing(&SoundOutput.Ring, Samples, (uint32)SoundBuffer.SampleCount);
+        }
+
+        uint64 EndCycleCount = __rdtsc();
+        uint64 EndCounter = LinuxGetWallClock();
+
+        uint64 CyclesElapsed = EndCycleCount - StartCycleCount;
+        real64 MSPerFrame = LinuxGetMSElapsed(StartCounter, EndCounter);
+        LinuxRecordFrame(&Stats, CyclesElapsed, MSPerFrame);
+        Stats.TotalRenderedPixels += Buffer.Dirty->RenderedPixelCount;
+
+        if (LinuxState.IsRecording)
+        {
+            LinuxRecordInput(&LinuxState, NewInput, &Buffer);
+        }
+        if (LinuxState.IsPlayingBack)
+        {
+            uint32 PlaybackFrameIndex = LinuxState.PlaybackFrameIndex;
+            if (!LinuxCheckPlayBackFrame(&LinuxState, &Buffer) && (LinuxState.PlaybackMismatchCount == 1))
+            {
+                fprintf(stderr, "playback diverged from the recording on frame %u of loop %u\n",
+                        PlaybackFrameIndex, LinuxState.PlaybackLoopCount);
+            }
+        }
+
+        //NOTE: Presenting belongs to the frame's work, so it goes before the wait just like it does on Win32.
+        if (PresentState)
+        {
+            PresentBuffer(PresentState, &Buffer, &DisplayBuffer, &GameMemory.PlatformAPI, &HighPriorityQueue);
+            Stats.TotalPresentedPixels += PresentState->PresentedPixelCount;
+        }
+        if (OutputKernels.ConvertPixels)
+        {
+            TIMED_BLOCK("ConvertPixels");
+            uint64 ConvertCounter = LinuxGetWallClock();
+            OutputKernels.ConvertPixels(Picture, &OutputBuffer, 0, 0, Picture->Width, Picture->Height);
+            Stats.TotalConvertMS += LinuxGetMSElapsed(ConvertCounter, LinuxGetWallClock());
+        }
+        if (Capture.IsCapturing)
+        {
+            TIMED_BLOCK("CaptureFrame");
+            LinuxCaptureFrame(&Capture, Picture, Samples, (uint32)SoundBuffer.SampleCount);
+        }
+
+#if HANDMADE_INTERNAL
+        {
+            //NOTE: Collating here means the wait below is charged to the next frame. It still shows up as a block of
+            //  its own, so frames that are mostly waiting are easy to spot.
+            TIMED_BLOCK("DebugCollation");
+            CollateDebugFrame(LinuxState.DebugState, (real64)LinuxGetWallClock() / 1000000000.0);
+        }
+#endif
+
+        //NOTE: The work stats above only cover the game's own frame; pacing stats cover flip to flip, where the
+        //  flip is the moment we come out of the wait.
+        bool32 MissedFrame = false;
+        if (GameUpdateHz)
+        {
+            MissedFrame = LinuxWaitForFrameEnd(LastCounter, TargetSecondsPerFrame);
+            uint64 FlipCounter = LinuxGetWallClock();
+            RecordFrameTiming(&FrameStats, (real32)(LinuxGetMSElapsed(LastCounter, FlipCounter) / 1000.0),
+                    MissedFrame);
+            LastCounter = FlipCounter;
+        }
+
+        if (!Quiet)
+        {
+            printf("%5d: %.03fms/f,  %.03fmc/f%s\n", FrameIndex, MSPerFrame, (real64)CyclesElapsed / (1000.0 * 1000.0),
+                    MissedFrame ? "  (missed)" : "");
+        }
+
+        game_input *Temp = NewInput;
+        NewInput = OldInput;
+        OldInput = Temp;
+    }
+
+    int Result = 0;
+    if (Capture.IsCapturing)
+    {
+        if (!LinuxEndCapture(&Capture))
+        {
+            fprintf(stderr, "capture to %s didn't finish cleanly\n", CaptureName);
+            Result = 1;
+        }
+
+        char CaptureStatsBuffer[512];
+        LinuxFormatCaptureStats(&Capture, CaptureStatsBuffer, sizeof(CaptureStatsBuffer));
+        fputs(CaptureStatsBuffer, stdout);
+    }
+    if (ControllerInput.HasThread)
+    {
+        LinuxStopControllerThread(&ControllerInput);
+
+        char ControllerStatsBuffer[512];
+        LinuxFormatControllerStats(&ControllerInput, ControllerStatsBuffer, sizeof(ControllerStatsBuffer));
+        fputs(ControllerStatsBuffer, stdout);
+    }
+    if (SoundOutput.HasAudioThread)
+    {
+        LinuxStopAudioThread(&SoundOutput);
+
+        char SoundStatsBuffer[256];
+        FormatSoundFeedStats(&SoundOutput.Feed, SoundStatsBuffer, sizeof(SoundStatsBuffer));
+        fputs(SoundStatsBuffer, stdout);
+    }
+    if (LinuxState.IsRecording)
+    {
+        replay_file_header *Header = LinuxState.ReplayMapping;
+        printf("recorded %u frames to %s (snapshot %.03fKB + %.03fKB)\n", Header->FrameCount, RecordFileName,
+                (real64)Header->SnapshotSize[0] / 1024.0, (real64)Header->SnapshotSize[1] / 1024.0);
+        LinuxEndRecordingInput(&LinuxState);
+    }
+    if (LinuxState.IsPlayingBack)
+    {
+        printf("played back %u frames of %s: %u full loops, %u frames with a mismatched backbuffer hash\n",
+                LinuxState.ReplayMapping->FrameCount, PlaybackFileName, LinuxState.PlaybackLoopCount,
+                LinuxState.PlaybackMismatchCount);
+        if (LinuxState.PlaybackMismatchCount)
+        {
+            Result = 1;
+        }
+        LinuxEndInputPlayBack(&LinuxState);
+    }
+
+    LinuxPrintFrameStats(&Stats, &Buffer, PresentState ? &DisplayBuffer : 0);
+    if (OutputKernels.ConvertPixels && Stats.FrameCount)
+    {
+        printf("pixels: %s, %.03fMB/f converted in %.03fms/f\n", GetPixelFormatName(OutputFormat),
+                (real64)OutputBufferSize / (1024.0 * 1024.0), Stats.TotalConvertMS / (real64)Stats.FrameCount);
+    }
+    if (ReloadCount)
+    {
+        printf("%d game code reloads, slowest %.03fms\n", ReloadCount, MaxReloadMS);
+    }
+    if (GameUpdateHz)
+    {
+        char FrameStatsBuffer[1024];
+        FormatFrameTimingStats(&FrameStats, FrameStatsBuffer, sizeof(FrameStatsBuffer));
+        fputs(FrameStatsBuffer, stdout);
+    }
+    LinuxPrintArenaStats(&GameMemory.ArenaRegistry);
+
+#if HANDMADE_INTERNAL
+    //NOTE: One more collation so the last frame's blocks make it into the report and the trace.
+    CollateDebugFrame(LinuxState.DebugState, (real64)LinuxGetWallClock() / 1000000000.0);
+
+    int ReportSize = (int)Megabytes(1);
+    char *ReportBuffer = (char *)PushSize(&LinuxState.DebugArena, ReportSize);
+    FormatDebugReport(LinuxState.DebugState, ReportBuffer, ReportSize);
+    fputs(ReportBuffer, stdout);
+    if (TraceFileName)
+    {
+        if (WriteDebugChromeTrace(LinuxState.DebugState, TraceFileName))
+        {
+            printf("wrote profiler trace to %s\n", TraceFileName);
+        }
+        else
+        {
+            fprintf(stderr, "Unable to write profiler trace to %s\n", TraceFileName);
+            Result = 1;
+        }
+    }
+#else
+    if (TraceFileName)
+    {
+        fprintf(stderr, "The profiler is compiled out of release builds, no trace written\n");
+    }
+#endif
+
+    return(Result);
+}
+#endif
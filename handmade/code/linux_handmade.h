@@ -0,0 +1,227 @@
+#if !defined(LINUX_HANDMADE_H)
+#define LINUX_HANDMADE_H
+
+struct linux_sound_output
+{
+    //NOTE: There is no sound device in the headless harness. Without "-audio" the game mixes a frame's worth of
+    //  samples every frame and they are dropped. With it, they go through the sound ring to an audio thread feeding
+    //  the null device below, exactly the way the Win32 layer feeds DirectSound.
+    int SamplesPerSecond;
+    int BytesPerSample;
+    int SamplesPerFrame;
+
+    bool32 HasAudioThread;
+    sound_ring Ring;
+    sound_feed Feed;
+    pthread_t AudioThread;
+    uint32 volatile AudioThreadIsRunning;
+
+    //NOTE: The null device. Its play cursor runs off the wall clock, its write cursor stays a few milliseconds ahead
+    //  of that the way DirectSound's does, and whatever the play cursor passes over counts as played: it is written
+    //  to the sink file as raw 16-bit stereo if there is one, and dropped if not.
+    uint32 DeviceSampleCount;
+    int16 *DeviceSamples;
+    uint32 DeviceWriteLeadSampleCount;
+    uint64 DeviceStartClock;
+    uint64 DevicePlayedSampleCount;
+    int SinkFileHandle;
+};
+
+struct linux_fake_pad
+{
+    //NOTE: There is no gamepad in the headless harness either. This one sits in the first slot and the rest are
+    //  empty. Its A button flips every TogglePeriod and its stick sweeps left to right and back every four seconds,
+    //  all off the wall clock from StartClock, so the exact moment of every button change is known and the time it
+    //  takes to reach a frame can be measured.
+    uint64 StartClock;
+    uint64 TogglePeriod;
+};
+
+struct linux_controller_input
+{
+    bool32 HasThread;
+    controller_poller *Poller;
+    linux_fake_pad Pad;
+    pthread_t Thread;
+    uint32 volatile ThreadIsRunning;
+
+    //NOTE: The slots as of the last frame, to take this frame's transitions and stick averages relative to.
+    controller_slot_state LastSlots[CONTROLLER_POLL_SLOT_COUNT];
+
+    //NOTE: Pad button changes that reached a frame: how long from the change to the poll that saw it, and from the
+    //  change to the frame that picked it up. Only the latest change of a frame is measured.
+    uint32 FrameCount;
+    uint32 MeasuredChangeCount;
+    real64 TotalPollLatencyMS;
+    real64 TotalFrameLatencyMS;
+    real64 MaxFrameLatencyMS;
+};
+
+struct linux_io_ring
+{
+    //NOTE: A bare io_uring, set up straight through the system calls since liburing can't be counted on to be
+    //  installed. Only the capture writer uses it, so there is exactly one thread on each end.
+    int FileHandle;
+    uint32 volatile *SubmitHead;
+    uint32 volatile *SubmitTail;
+    uint32 SubmitMask;
+    uint32 *SubmitArray;
+    io_uring_sqe *Submissions;
+    uint32 volatile *CompleteHead;
+    uint32 volatile *CompleteTail;
+    uint32 CompleteMask;
+    io_uring_cqe *Completions;
+
+    void *SubmitRing;
+    memory_index SubmitRingSize;
+    void *CompleteRing;
+    memory_index CompleteRingSize;
+    memory_index SubmissionsSize;
+};
+
+//NOTE: One write of a batch. Slots that sit next to each other in the file go out as a single vectored write.
+#define LINUX_CAPTURE_MAX_WRITE_COUNT (2 * CAPTURE_SLOT_COUNT + 1)
+//NOTE: How far past the last frame written the raw file has its space taken ahead of time, in frames.
+#define LINUX_CAPTURE_RESERVE_FRAME_COUNT 60
+struct linux_capture_write
+{
+    int FileHandle;
+    uint64 Offset;
+    uint32 PartCount;
+    iovec Parts[CAPTURE_SLOT_COUNT];
+    uint64 Size;
+};
+
+struct linux_capture
+{
+    bool32 IsCapturing;
+    capture_stream *Stream;
+    int VideoFileHandle;
+    int AudioFileHandle;
+    int IndexFileHandle;
+
+    //NOTE: Without io_uring (an old kernel, or a sandbox that blocks it) every write of a batch is a pwritev instead.
+    //  Video goes around the page cache when the frames are whole pages, unless the file system won't have it.
+    bool32 UseIORing;
+    linux_io_ring Ring;
+    bool32 UseDirectIO;
+
+    //NOTE: Up to where the raw file has its space already, unless the file system won't reserve it. Past that, every
+    //  write would have the file system find room for it on the way, and growing the file is far dearer than writing
+    //  into it; the capture trims the file back to its real size when it ends.
+    bool32 ReserveVideo;
+    uint64 VideoReservedSize;
+
+    //NOTE: Only the bench sets this, to see what the writer makes of a ring that fails. Every other io_uring_enter
+    //  then only submits half of what it was given and comes back without waiting, the way a wait cut short by a
+    //  signal would, and the one after it fails with this error.
+    int IORingFaultError;
+    uint32 IORingEnterCount;
+
+    bool32 HasThread;
+    pthread_t Thread;
+    sem_t Semaphore;
+    sem_t PictureSemaphore;
+    uint32 volatile ThreadIsRunning;
+
+    //NOTE: Only the writer touches these until it has been stopped. WrittenAheadCount is the running count of slots
+    //  written so far, which can be one past the last one published. A failed or short ring write is done over with
+    //  pwritev, and counted as a retry. WriterMS is the writer's own CPU time, converting pictures included.
+    uint32 volatile WrittenAheadCount;
+    uint32 EntryCount;
+    uint32 BatchCount;
+    uint32 MaxBatchSlotCount;
+    uint64 WriteCallCount;
+    uint64 ByteCount;
+    uint32 RetryCount;
+    uint32 ErrorCount;
+    real64 WriterMS;
+
+    //NOTE: Only the frame loop touches these. A picture the writer hadn't finished converting when the frame loop
+    //  needed it back counts as a late picture.
+    uint32 SubmitCallCount;
+    uint32 LatePictureCount;
+    real64 TotalSubmitMS;
+    real64 MaxSubmitMS;
+};
+
+#define LINUX_STATE_FILE_NAME_COUNT 4096
+struct linux_state
+{
+    //NOTE: One reservation for everything: game permanent storage, game transient storage, then the platform's own,
+    //  then the profiler's in internal builds.
+    uint64 TotalSize;
+    void *GameMemoryBlock;
+
+    memory_arena PlatformArena;
+    memory_arena DebugArena;
+    debug_state *DebugState;
+
+    //NOTE: The game module is looked up next to the executable, not in the working directory.
+    char EXEFileName[LINUX_STATE_FILE_NAME_COUNT];
+    char *OnePastLastEXEFileNameSlash;
+    //NOTE: Input recording and playback, see handmade_replay.h. Only one of the two runs at a time, and both go
+    //  through the one mapping.
+    int ReplayFileHandle;
+    replay_file_header *ReplayMapping;
+    uint64 ReplayMappingSize;
+    bool32 IsRecording;
+    bool32 IsPlayingBack;
+
+    uint32 PlaybackFrameIndex;
+    uint32 PlaybackLoopCount;
+    uint32 PlaybackMismatchCount;
+};
+
+struct linux_game_code
+{
+    void *GameCodeSO;
+    timespec SOLastWriteTime;
+
+    //NOTE: Never 0; this points at the stub whenever the module is missing or incomplete.
+    game_update_and_render *UpdateAndRender;
+
+    bool32 IsValid;
+};
+
+struct linux_frame_stats
+{
+    int FrameCount;
+
+    uint64 TotalCycles;
+    uint64 MinCycles;
+    uint64 MaxCycles;
+
+    real64 TotalMS;
+    real64 MinMS;
+    real64 MaxMS;
+
+    //NOTE: Backbuffer pixels the renderer redrew and display pixels the present stage rewrote.
+    uint64 TotalRenderedPixels;
+    uint64 TotalPresentedPixels;
+
+    //NOTE: Time spent converting the picture with -pixels.
+    real64 TotalConvertMS;
+};
+
+struct platform_work_queue_entry
+{
+    platform_work_queue_callback *Callback;
+    void *Data;
+};
+
+struct platform_work_queue
+{
+    //NOTE: Single producer, many consumers. Only the thread that adds entries may call LinuxCompleteAllWork.
+    uint32 volatile CompletionGoal;
+    uint32 volatile CompletionCount;
+
+    uint32 volatile NextEntryToWrite;
+    uint32 volatile NextEntryToRead;
+    sem_t SemaphoreHandle;
+
+    int ThreadCount;
+    platform_work_queue_entry Entries[4096];
+};
+
+#endif
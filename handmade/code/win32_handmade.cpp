@@ -1,51 +1,32 @@
+#include "handmade_platform.h"
+
 #include <cstdio>
+#include <cstdlib>
 #include <windows.h>
-#include <cstdint>
+#include <intrin.h>
 #include <Xinput.h>
 #include <Dsound.h>
-#include <math.h>
-
-#define internal        static
-#define local_persist   static
-#define global_variable static
-
-#define Pi32 3.14159265359f
-
-typedef uint8_t uint8;
-typedef uint16_t uint16;
-typedef uint32_t uint32;
-typedef uint64_t uint64;
 
-
-typedef int8_t int8;
-typedef int16_t int16;
-typedef int32_t int32;
-typedef int64_t int64;
-typedef int32 bool32;
-
-typedef float real32;
-typedef double real64;
-
-struct win32_offscreen_buffer
-{
-    BITMAPINFO Info;
-    void* Memory;
-    int Width;
-    int Height;
-    int BytesPerPixel;
-    int Pitch;
-};
+#include "handmade_replay.h"
+#include "handmade_debug.h"
+#include "handmade_present.h"
+#include "handmade_sound_feed.h"
+#include "handmade_controller_poll.h"
+#include "win32_handmade.h"
+#include "handmade_frame_timing.h"
 
 //TODO: This shouldn't be a global.
 global_variable bool32 GlobalRunning;
 global_variable win32_offscreen_buffer GlobalBackbuffer;
+global_variable win32_offscreen_buffer GlobalDisplayBuffer;
+global_variable present_state *GlobalPresentState;
+global_variable game_dirty_region *GlobalDirtyRegion;
 global_variable LPDIRECTSOUNDBUFFER GlobalSecondaryBuffer;
+global_variable int64 GlobalPerfCountFrequency;
 
-struct win32_window_dimension
-{
-    int Width;
-    int Height;
-};
+//NOTE: In internal builds, mapped files go at fixed addresses just like game memory does, so the pointers into them
+//  that end up in a looped-input snapshot are still good when the recording is played back by another run.
+global_variable uint8 *GlobalNextFileMappingAddress;
 
 // =====================================================================================================================
 
@@ -70,33 +51,93 @@ X_INPUT_SET_STATE(XInputSetStateStub)
 global_variable x_input_set_state *XInputSetState_ = XInputSetStateStub;
 #define XInputSetState XInputSetState_
 
+//NOTE: Same idea for the game itself. If handmade.dll is missing or doesn't export what we need, the frame loop runs
+//  this instead and picks the real one up on the next successful reload.
+GAME_UPDATE_AND_RENDER(GameUpdateAndRenderStub)
+{
+}
+
 #define DIRECT_SOUND_CREATE(name) HRESULT WINAPI name (LPCGUID pcGuidDevice, LPDIRECTSOUND *ppDS, LPUNKNOWN pUnkOuter)
 typedef DIRECT_SOUND_CREATE(direct_sound_create);
 
 // =====================================================================================================================
 
-internal void RenderWeirdGradient(win32_offscreen_buffer *Buffer, int BlueOffset, int GreenOffset)
+internal void Win32GetEXEFileName(win32_state *State)
 {
-    int Width = Buffer->Width;
-    int Height = Buffer->Height;
-
-    int Pitch = Width * Buffer->BytesPerPixel;
-    uint8 *Row = (uint8 *)Buffer->Memory;
-    for (int Y = 0; Y < Buffer->Height; ++Y) 
+    GetModuleFileNameA(0, State->EXEFileName, sizeof(State->EXEFileName));
+    State->OnePastLastEXEFileNameSlash = State->EXEFileName;
+    for (char *Scan = State->EXEFileName; *Scan; ++Scan)
     {
-        uint32 *Pixel = (uint32 *)Row;
-        for (int X = 0; X < Buffer->Width; ++X)
+        if (*Scan == '\\')
         {
-            // Pixel Layout in Memory = BB GG RR xx
-            // Register value = xx RR GG BB
-            uint8 B = (X + BlueOffset);
-            uint8 G = (Y + GreenOffset);
+            State->OnePastLastEXEFileNameSlash = Scan + 1;
+        }
+    }
+}
+
+// =====================================================================================================================
+
+internal void Win32BuildEXEPathFileName(win32_state *State, char *FileName, int DestCount, char *Dest)
+{
+    int PathCount = (int)(State->OnePastLastEXEFileNameSlash - State->EXEFileName);
+    _snprintf_s(Dest, DestCount, _TRUNCATE, "%.*s%s", PathCount, State->EXEFileName, FileName);
+}
+
+// =====================================================================================================================
+
+internal FILETIME Win32GetLastWriteTime(char *FileName)
+{
+    FILETIME LastWriteTime = {};
+
+    WIN32_FILE_ATTRIBUTE_DATA Data;
+    if (GetFileAttributesExA(FileName, GetFileExInfoStandard, &Data))
+    {
+        LastWriteTime = Data.ftLastWriteTime;
+    }
+
+    return(LastWriteTime);
+}
+
+// =====================================================================================================================
 
+internal win32_game_code Win32LoadGameCode(char *SourceDLLName, char *TempDLLName)
+{
+    //NOTE: We load a copy, never the DLL the build writes to, because Windows keeps a loaded DLL locked and the
+    //  next build would fail to overwrite it.
+    win32_game_code Result = {};
 
-            *Pixel++ = ((G << 8) | B); // Blue assigned to smallest 2 bytes (uint8), Green moved left to its position.  
+    Result.DLLLastWriteTime = Win32GetLastWriteTime(SourceDLLName);
+    if (CopyFileA(SourceDLLName, TempDLLName, FALSE))
+    {
+        Result.GameCodeDLL = LoadLibraryA(TempDLLName);
+        if (Result.GameCodeDLL)
+        {
+            Result.UpdateAndRender = (game_update_and_render *)
+                GetProcAddress(Result.GameCodeDLL, "GameUpdateAndRender");
+            Result.IsValid = (Result.UpdateAndRender != 0);
         }
-        Row += Pitch;
     }
+
+    if (!Result.IsValid)
+    {
+        Result.UpdateAndRender = GameUpdateAndRenderStub;
+    }
+
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void Win32UnloadGameCode(win32_game_code *GameCode)
+{
+    if (GameCode->GameCodeDLL)
+    {
+        FreeLibrary(GameCode->GameCodeDLL);
+        GameCode->GameCodeDLL = 0;
+    }
+
+    GameCode->IsValid = false;
+    GameCode->UpdateAndRender = GameUpdateAndRenderStub;
 }
 
 // =====================================================================================================================
@@ -204,14 +245,17 @@ internal win32_window_dimension Win32GetWindowDimension(HWND Window)
 
 // =====================================================================================================================
 
-internal void Win32ResizeDIBSection(win32_offscreen_buffer *Buffer, int Width, int Height)
+internal void Win32ResizeDIBSection(win32_offscreen_buffer *Buffer, memory_arena *PlatformArena,
+        int Width, int Height)
 {
-    //TODO: Bulletproof this.
-    // Maybe don't free first, free after, then free first if that fails.
-
-    if (Buffer->Memory)
+    //NOTE: The pixels come out of the platform arena instead of VirtualAlloc/VirtualFree, so resizing never goes to
+    //  the OS. A resize that still fits reuses the memory we already have; a bigger one takes a fresh block, and the
+    //  old one stays behind in the arena.
+    int BitmapMemorySize = Width * Height * 4;
+    if (!Buffer->Memory || (BitmapMemorySize > Buffer->MemorySize))
     {
-        VirtualFree(Buffer->Memory, 0, MEM_RELEASE);
+        Buffer->Memory = PushSize(PlatformArena, BitmapMemorySize, 64);
+        Buffer->MemorySize = BitmapMemorySize;
     }
 
     Buffer->Width = Width;
@@ -228,27 +272,90 @@ internal void Win32ResizeDIBSection(win32_offscreen_buffer *Buffer, int Width, i
     Buffer->Info.bmiHeader.biBitCount = 32; // RR + GG + BB + padding
     Buffer->Info.bmiHeader.biCompression = BI_RGB;
 
-    int BitmapMemorySize = Buffer->Width * Buffer->Height * Buffer->BytesPerPixel;
-    Buffer->Memory = VirtualAlloc(0, BitmapMemorySize, MEM_COMMIT|MEM_RESERVE, PAGE_READWRITE);
-//    RenderWeirdGradient(128, 0);
     Buffer->Pitch = Width * Buffer->BytesPerPixel;
 }
 
 // =====================================================================================================================
 
-internal void Win32DisplayBufferInWindow(win32_offscreen_buffer *Buffer, HDC DeviceContext, 
-        int WindowWidth, int WindowHeight)
+internal win32_window_dimension Win32PresentBackbuffer(HWND Window, platform_api *PlatformAPI,
+        platform_work_queue *Queue)
 {
-    //TODO: Aspect-ratio correction
-    StretchDIBits(
-            DeviceContext,
-            /*X, Y, Width, Height,
-            X, Y, Width, Height,*/
-            0, 0, WindowWidth, WindowHeight,
-            0, 0, Buffer->Width, Buffer->Height,
-            Buffer->Memory,
-            &Buffer->Info,
-            DIB_RGB_COLORS, SRCCOPY);
+    //NOTE: Scales the backbuffer into the display buffer, letterboxed, at the size of the client area (see
+    //  handmade_present.h). The display buffer was given room for the largest size up front, so resizing it here
+    //  never needs the arena. Returns the client area it presented for.
+    win32_window_dimension Dimension = Win32GetWindowDimension(Window);
+    if (GlobalPresentState && (Dimension.Width > 0) && (Dimension.Height > 0))
+    {
+        int Width = (Dimension.Width < PRESENT_MAX_WIDTH) ? Dimension.Width : PRESENT_MAX_WIDTH;
+        int Height = (Dimension.Height < PRESENT_MAX_HEIGHT) ? Dimension.Height : PRESENT_MAX_HEIGHT;
+        Win32ResizeDIBSection(&GlobalDisplayBuffer, 0, Width, Height);
+
+        game_offscreen_buffer Source = {};
+        Source.Memory = GlobalBackbuffer.Memory;
+        Source.Width = GlobalBackbuffer.Width;
+        Source.Height = GlobalBackbuffer.Height;
+        Source.Pitch = GlobalBackbuffer.Pitch;
+        Source.BytesPerPixel = GlobalBackbuffer.BytesPerPixel;
+        Source.Dirty = GlobalDirtyRegion;
+
+        game_offscreen_buffer Display = {};
+        Display.Memory = GlobalDisplayBuffer.Memory;
+        Display.Width = GlobalDisplayBuffer.Width;
+        Display.Height = GlobalDisplayBuffer.Height;
+        Display.Pitch = GlobalDisplayBuffer.Pitch;
+        Display.BytesPerPixel = GlobalDisplayBuffer.BytesPerPixel;
+
+        PresentBuffer(GlobalPresentState, &Source, &Display, PlatformAPI, Queue);
+    }
+    else if (GlobalPresentState)
+    {
+        //NOTE: Whatever the game redraws while there is no window to present to has to be presented once there is.
+        GlobalPresentState->LayoutIsValid = false;
+    }
+    return(Dimension);
+}
+
+// =====================================================================================================================
+
+internal void Win32DisplayBufferInWindow(win32_offscreen_buffer *Buffer, HDC DeviceContext,
+        int WindowWidth, int WindowHeight, rectangle2i *Rects, int RectCount)
+{
+    //NOTE: Rects, in display buffer pixels, limits the copy to just those parts of the window; 0 copies all of it.
+    TIMED_FUNCTION();
+
+    if ((Buffer->Width == WindowWidth) && (Buffer->Height == WindowHeight))
+    {
+        //NOTE: The present stage already did the scaling, so this is a straight copy. The source origin of a
+        //  top-down DIB is its top-left corner, so source and destination coordinates are the same.
+        if (!Rects)
+        {
+            SetDIBitsToDevice(DeviceContext, 0, 0, Buffer->Width, Buffer->Height, 0, 0, 0, Buffer->Height,
+                    Buffer->Memory, &Buffer->Info, DIB_RGB_COLORS);
+        }
+        for (int RectIndex = 0; Rects && (RectIndex < RectCount); ++RectIndex)
+        {
+            rectangle2i Rect = Rects[RectIndex];
+            Rect.MinX = (Rect.MinX < 0) ? 0 : Rect.MinX;
+            Rect.MinY = (Rect.MinY < 0) ? 0 : Rect.MinY;
+            Rect.MaxX = (Rect.MaxX > Buffer->Width) ? Buffer->Width : Rect.MaxX;
+            Rect.MaxY = (Rect.MaxY > Buffer->Height) ? Buffer->Height : Rect.MaxY;
+            if ((Rect.MinX < Rect.MaxX) && (Rect.MinY < Rect.MaxY))
+            {
+                SetDIBitsToDevice(DeviceContext, Rect.MinX, Rect.MinY, Rect.MaxX - Rect.MinX, Rect.MaxY - Rect.MinY,
+                        Rect.MinX, Rect.MinY, 0, Buffer->Height, Buffer->Memory, &Buffer->Info, DIB_RGB_COLORS);
+            }
+        }
+    }
+    else
+    {
+        //NOTE: Only a window bigger than PRESENT_MAX_WIDTH x PRESENT_MAX_HEIGHT gets here; GDI stretches the rest of
+        //  the way.
+        StretchDIBits(DeviceContext,
+                0, 0, WindowWidth, WindowHeight,
+                0, 0, Buffer->Width, Buffer->Height,
+                Buffer->Memory, &Buffer->Info,
+                DIB_RGB_COLORS, SRCCOPY);
+    }
 }
 
 // =====================================================================================================================
@@ -283,52 +390,9 @@ internal LRESULT CALLBACK Win32MainWindowCallback(HWND Window,
         case WM_KEYDOWN:
         case WM_KEYUP:
         {
-            uint32 VKCode = WParam;
-            bool32 WasDown = ((LParam & (1 << 30)) != 0); // bit 30 says whether the key was down. 1 is yes, 0 is no.
-            bool32 IsDown = ((LParam & (1 << 31)) == 0); // bit 31 says whether the key is currently down or not.
-
-            if (WasDown != IsDown)
-            {
-                if (VKCode == 'W')
-                {
-                }
-                else if (VKCode == 'A')
-                {
-                }
-                else if (VKCode == 'S')
-                {
-                }
-                else if (VKCode == 'D')
-                {
-                }
-                else if (VKCode == 'Q')
-                {
-                }
-                else if (VKCode == 'E')
-                {
-                }
-                else if (VKCode == VK_UP)
-                {
-                }
-                else if (VKCode == VK_LEFT)
-                {
-                }
-                else if (VKCode == VK_RIGHT)
-                {
-                }
-                else if (VKCode == VK_ESCAPE)
-                {
-                }
-                else if (VKCode == VK_SPACE)
-                {
-                }
-            }
-            bool32 AltKeyWasDown = ((LParam & (1 << 29)) != 0);
-            if ((VKCode == VK_F4) && AltKeyWasDown)
-            {
-                GlobalRunning = false;
-            }
+            Assert(!"Keyboard input came in through a non-dispatch message!");
         } break;
+
         case WM_ACTIVATEAPP:
         {
             OutputDebugStringA("WM_ACTIVATEAPP\n");
@@ -339,13 +403,15 @@ internal LRESULT CALLBACK Win32MainWindowCallback(HWND Window,
             PAINTSTRUCT Paint;
             HDC DeviceContext = BeginPaint(Window, &Paint);
 
-            int X = Paint.rcPaint.left;
-            int Y = Paint.rcPaint.top;
-            LONG Width = Paint.rcPaint.right - Paint.rcPaint.left;
-            LONG Height = Paint.rcPaint.bottom - Paint.rcPaint.top;
-
-            win32_window_dimension Dimension = Win32GetWindowDimension(Window);
-            Win32DisplayBufferInWindow(&GlobalBackbuffer, DeviceContext, Dimension.Width, Dimension.Height);
+            //NOTE: Painting can happen in the middle of a resize, outside the frame loop, so it presents on its own,
+            //  without the work queue. The frame loop has already presented everything the game drew, so unless the
+            //  window changed size that does nothing, and only the part of the window Windows asked for is copied.
+            rectangle2i PaintRect = {(int)Paint.rcPaint.left, (int)Paint.rcPaint.top, (int)Paint.rcPaint.right,
+                (int)Paint.rcPaint.bottom};
+            win32_window_dimension Dimension = Win32PresentBackbuffer(Window, 0, 0);
+            bool32 CopyAll = !GlobalPresentState || GlobalPresentState->LayoutChanged;
+            Win32DisplayBufferInWindow(&GlobalDisplayBuffer, DeviceContext, Dimension.Width, Dimension.Height,
+                    CopyAll ? 0 : &PaintRect, 1);
             EndPaint(Window, &Paint);
         } break;
 
@@ -359,61 +425,782 @@ internal LRESULT CALLBACK Win32MainWindowCallback(HWND Window,
 
 // =====================================================================================================================
 
-struct win32_sound_output
+internal bool32 Win32LockSoundBuffer(DWORD ByteToLock, DWORD BytesToWrite, win32_sound_regions *Regions)
 {
-    int SamplesPerSecond;
-    int ToneHz;
-    int16 ToneVolume;
-    uint32 RunningSampleIndex;
-    int WavePeriod;
-    int BytesPerSample;
-    int SecondaryBufferSize;
-    real32 tSine;
-    int LatencySampleCount;
-};
+    bool32 Result = SUCCEEDED(GlobalSecondaryBuffer->Lock(
+            ByteToLock,
+            BytesToWrite,
+            &Regions->Region[0], &Regions->RegionSize[0],
+            &Regions->Region[1], &Regions->RegionSize[1],
+            0));
+    return(Result);
+}
 
 // =====================================================================================================================
 
-void Win32FillSoundBuffer(win32_sound_output * SoundOutput, DWORD ByteToLock, DWORD BytesToWrite)
+internal void Win32UnlockSoundBuffer(win32_sound_regions *Regions)
 {
-    VOID *Region1;
-    DWORD Region1Size;
-    VOID *Region2;
-    DWORD Region2Size;
-    if (SUCCEEDED(GlobalSecondaryBuffer->Lock(
-            ByteToLock,
-            BytesToWrite,
-            &Region1, &Region1Size,
-            &Region2, &Region2Size,
-            0)))
-    {
-        //TODO: Assert that Region1Size/Region2Size is valid
-        int16 *SampleOut = (int16 *)Region1;
-        DWORD Region1SampleCount = Region1Size / SoundOutput->BytesPerSample;
-        for (DWORD SampleIndex = 0; SampleIndex < Region1SampleCount; ++SampleIndex)
-        {
-            real32 SineValue = sinf(SoundOutput->tSine);
-            int16 SampleValue = (int16)(SineValue * SoundOutput->ToneVolume);
-            *SampleOut++ = SampleValue;
-            *SampleOut++ = SampleValue;
-
-            SoundOutput->tSine += 2.0f * Pi32 * 1.0f / (real32)SoundOutput->WavePeriod;
-            ++SoundOutput->RunningSampleIndex;
+    GlobalSecondaryBuffer->Unlock(Regions->Region[0], Regions->RegionSize[0],
+            Regions->Region[1], Regions->RegionSize[1]);
+}
+
+// =====================================================================================================================
+
+internal void Win32ClearSoundBuffer(win32_sound_output *SoundOutput)
+{
+    win32_sound_regions Regions;
+    if (Win32LockSoundBuffer(0, SoundOutput->SecondaryBufferSize, &Regions))
+    {
+        for (int RegionIndex = 0; RegionIndex < (int)ArrayCount(Regions.Region); ++RegionIndex)
+        {
+            ZeroMemory(Regions.Region[RegionIndex], Regions.RegionSize[RegionIndex]);
+        }
+        Win32UnlockSoundBuffer(&Regions);
+    }
+}
+
+// =====================================================================================================================
+
+internal void Win32FillSoundBuffer(win32_sound_output *SoundOutput)
+{
+    TIMED_FUNCTION();
+
+    DWORD PlayCursor;
+    DWORD WriteCursor;
+    if (SUCCEEDED(GlobalSecondaryBuffer->GetCurrentPosition(&PlayCursor, &WriteCursor)))
+    {
+        DWORD BytesPerSample = (DWORD)SoundOutput->BytesPerSample;
+        sound_feed_write Write = PlanSoundFeedWrite(&SoundOutput->Feed, &SoundOutput->Ring,
+                PlayCursor / BytesPerSample, WriteCursor / BytesPerSample);
+
+        //NOTE: If the lock fails nothing is taken out of the ring, and the next wake tries again from the same spot.
+        win32_sound_regions Regions;
+        if (Write.SampleCount &&
+                Win32LockSoundBuffer(Write.DevicePosition * BytesPerSample, Write.SampleCount * BytesPerSample,
+                    &Regions))
+        {
+            for (int RegionIndex = 0; RegionIndex < (int)ArrayCount(Regions.Region); ++RegionIndex)
+            {
+                FillSoundFeedRegion(&SoundOutput->Ring, &Write, (int16 *)Regions.Region[RegionIndex],
+                        Regions.RegionSize[RegionIndex] / BytesPerSample);
+            }
+            Win32UnlockSoundBuffer(&Regions);
+            EndSoundFeedWrite(&SoundOutput->Feed, &Write);
+        }
+    }
+    else
+    {
+        SoundOutput->Feed.IsValid = false;
+    }
+}
+
+// =====================================================================================================================
+
+inline LARGE_INTEGER Win32GetWallClock(void)
+{
+    LARGE_INTEGER Result;
+    QueryPerformanceCounter(&Result);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+inline real32 Win32GetSecondsElapsed(LARGE_INTEGER Start, LARGE_INTEGER End)
+{
+    real32 Result = ((real32)(End.QuadPart - Start.QuadPart) / (real32)GlobalPerfCountFrequency);
+    return(Result);
+}
+
+// =====================================================================================================================
+
+DWORD WINAPI Win32AudioThreadProc(LPVOID lpParameter)
+{
+    //NOTE: Runs until Win32StopAudioThread. Sleep is only as good as the scheduler granularity WinMain asked for,
+    //  which is why the period is a couple of milliseconds rather than one.
+    win32_sound_output *SoundOutput = (win32_sound_output *)lpParameter;
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+    while (AtomicLoadAcquire(&SoundOutput->AudioThreadIsRunning))
+    {
+        Win32FillSoundBuffer(SoundOutput);
+        Sleep(SoundOutput->Feed.PeriodMS);
+    }
+    return(0);
+}
+
+// =====================================================================================================================
+
+internal void Win32StopAudioThread(win32_sound_output *SoundOutput)
+{
+    //NOTE: SoundOutput lives on WinMain's stack, so the thread has to be gone before WinMain returns. Once it is,
+    //  nothing refills the secondary buffer, so it is stopped rather than left looping over stale samples.
+    AtomicStoreRelease(&SoundOutput->AudioThreadIsRunning, 0);
+    WaitForSingleObject(SoundOutput->AudioThread, INFINITE);
+    CloseHandle(SoundOutput->AudioThread);
+    SoundOutput->AudioThread = 0;
+
+    if (GlobalSecondaryBuffer)
+    {
+        GlobalSecondaryBuffer->Stop();
+    }
+}
+
+// =====================================================================================================================
+
+internal CONTROLLER_POLL_READ(Win32ReadXInputController)
+{
+    XINPUT_STATE ControllerState;
+    bool32 Result = (XInputGetState(SlotIndex, &ControllerState) == ERROR_SUCCESS);
+    if (Result)
+    {
+        //NOTE: In controller_button order.
+        WORD ButtonBits[ControllerButton_Count] =
+        {
+            XINPUT_GAMEPAD_DPAD_UP, XINPUT_GAMEPAD_DPAD_DOWN, XINPUT_GAMEPAD_DPAD_LEFT, XINPUT_GAMEPAD_DPAD_RIGHT,
+            XINPUT_GAMEPAD_Y, XINPUT_GAMEPAD_A, XINPUT_GAMEPAD_X, XINPUT_GAMEPAD_B,
+            XINPUT_GAMEPAD_LEFT_SHOULDER, XINPUT_GAMEPAD_RIGHT_SHOULDER,
+            XINPUT_GAMEPAD_BACK, XINPUT_GAMEPAD_START,
+        };
+
+        XINPUT_GAMEPAD *Pad = &ControllerState.Gamepad;
+        Reading->ButtonsDown = 0;
+        for (int ButtonIndex = 0; ButtonIndex < ControllerButton_Count; ++ButtonIndex)
+        {
+            if ((Pad->wButtons & ButtonBits[ButtonIndex]) == ButtonBits[ButtonIndex])
+            {
+                Reading->ButtonsDown |= (1 << ButtonIndex);
+            }
+        }
+        Reading->StickX = Pad->sThumbLX;
+        Reading->StickY = Pad->sThumbLY;
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+DWORD WINAPI Win32ControllerThreadProc(LPVOID lpParameter)
+{
+    //NOTE: Runs until Win32StopControllerThread. Like the audio thread it can't sleep for less than the scheduler
+    //  granularity WinMain asked for, so asking for more than 1000Hz gets about 1000Hz.
+    win32_controller_input *Input = (win32_controller_input *)lpParameter;
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+    while (AtomicLoadAcquire(&Input->ThreadIsRunning))
+    {
+        uint64 WakeClock = PollControllers(Input->Poller, (uint64)Win32GetWallClock().QuadPart);
+        uint64 Now = (uint64)Win32GetWallClock().QuadPart;
+        DWORD SleepMS = 0;
+        if (WakeClock > Now)
+        {
+            SleepMS = (DWORD)(((WakeClock - Now) * 1000) / (uint64)GlobalPerfCountFrequency);
+        }
+        Sleep(SleepMS ? SleepMS : 1);
+    }
+    return(0);
+}
+
+// =====================================================================================================================
+
+internal void Win32StopControllerThread(win32_controller_input *Input)
+{
+    //NOTE: Input lives on WinMain's stack, and XInput shouldn't be called into while the process is tearing down.
+    AtomicStoreRelease(&Input->ThreadIsRunning, 0);
+    WaitForSingleObject(Input->Thread, INFINITE);
+    CloseHandle(Input->Thread);
+    Input->Thread = 0;
+}
+
+// =====================================================================================================================
+
+internal void Win32ProcessKeyboardMessage(game_button_state *NewState, bool32 IsDown)
+{
+    if (NewState->EndedDown != IsDown)
+    {
+        NewState->EndedDown = IsDown;
+        ++NewState->HalfTransitionCount;
+    }
+}
+
+// =====================================================================================================================
+
+internal bool32 Win32BeginRecordingInput(win32_state *State, game_memory *Memory, uint32 MaxFrameCount)
+{
+    //NOTE: The file is sized for the longest recording up front and cut down to what was used when recording ends.
+    //  Creating the mapping at that size is what grows the file.
+    replay_file_header Header;
+    InitializeReplayHeader(&Header, Memory, MaxFrameCount);
+
+    //NOTE: A load still in flight would land in game memory after the snapshot was taken.
+    if (Memory->LowPriorityQueue)
+    {
+        Memory->PlatformAPI.CompleteAllWork(Memory->LowPriorityQueue);
+    }
+
+    State->ReplayFileHandle = CreateFileA(State->ReplayFileName, GENERIC_READ|GENERIC_WRITE, 0, 0,
+            CREATE_ALWAYS, 0, 0);
+    if (State->ReplayFileHandle != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER MaxSize;
+        MaxSize.QuadPart = Header.FileSize;
+        State->ReplayMemoryMap = CreateFileMappingA(State->ReplayFileHandle, 0, PAGE_READWRITE,
+                MaxSize.HighPart, MaxSize.LowPart, 0);
+        if (State->ReplayMemoryMap)
+        {
+            State->ReplayMapping = (replay_file_header *)MapViewOfFile(State->ReplayMemoryMap, FILE_MAP_ALL_ACCESS,
+                    0, 0, (SIZE_T)Header.FileSize);
+            if (State->ReplayMapping)
+            {
+                *State->ReplayMapping = Header;
+                WriteReplaySnapshot(State->ReplayMapping, Memory);
+                State->IsRecording = true;
+            }
+            else
+            {
+                CloseHandle(State->ReplayMemoryMap);
+            }
+        }
+
+        if (!State->IsRecording)
+        {
+            CloseHandle(State->ReplayFileHandle);
+        }
+    }
+
+    return(State->IsRecording);
+}
+
+// =====================================================================================================================
+
+internal void Win32EndRecordingInput(win32_state *State)
+{
+    replay_file_header *Header = State->ReplayMapping;
+    Header->FileSize = Header->FrameOffset + (uint64)Header->FrameCount * sizeof(replay_frame);
+    LARGE_INTEGER UsedSize;
+    UsedSize.QuadPart = Header->FileSize;
+
+    UnmapViewOfFile(State->ReplayMapping);
+    CloseHandle(State->ReplayMemoryMap);
+    SetFilePointerEx(State->ReplayFileHandle, UsedSize, 0, FILE_BEGIN);
+    SetEndOfFile(State->ReplayFileHandle);
+    CloseHandle(State->ReplayFileHandle);
+
+    State->ReplayMapping = 0;
+    State->IsRecording = false;
+}
+
+// =====================================================================================================================
+
+internal void Win32RecordInput(win32_state *State, game_input *Input, game_offscreen_buffer *Buffer)
+{
+    //NOTE: Called after the frame has been rendered, so the hash is of the picture this input produced.
+    TIMED_FUNCTION();
+
+    replay_file_header *Header = State->ReplayMapping;
+    replay_frame *Frame = GetReplayFrame(Header, Header->FrameCount);
+    Frame->Input = *Input;
+    Frame->BackbufferHash = HashBackbuffer(Buffer);
+    ++Header->FrameCount;
+
+    if (Header->FrameCount == Header->MaxFrameCount)
+    {
+        Win32EndRecordingInput(State);
+    }
+}
+
+// =====================================================================================================================
+
+internal bool32 Win32BeginInputPlayBack(win32_state *State, game_memory *Memory)
+{
+    State->ReplayFileHandle = CreateFileA(State->ReplayFileName, GENERIC_READ, FILE_SHARE_READ, 0,
+            OPEN_EXISTING, 0, 0);
+    if (State->ReplayFileHandle != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER FileSize;
+        if (GetFileSizeEx(State->ReplayFileHandle, &FileSize) &&
+                (FileSize.QuadPart >= (LONGLONG)sizeof(replay_file_header)))
+        {
+            State->ReplayMemoryMap = CreateFileMappingA(State->ReplayFileHandle, 0, PAGE_READONLY, 0, 0, 0);
+            if (State->ReplayMemoryMap)
+            {
+                State->ReplayMapping = (replay_file_header *)MapViewOfFile(State->ReplayMemoryMap, FILE_MAP_READ,
+                        0, 0, 0);
+                if (State->ReplayMapping &&
+                        IsReplayCompatible(State->ReplayMapping, (uint64)FileSize.QuadPart, Memory))
+                {
+                    State->PlaybackFrameIndex = 0;
+                    State->PlaybackLoopCount = 0;
+                    State->PlaybackMismatchCount = 0;
+
+                    //NOTE: Same as when recording: nothing may land in game memory after it has been restored.
+                    if (Memory->LowPriorityQueue)
+                    {
+                        Memory->PlatformAPI.CompleteAllWork(Memory->LowPriorityQueue);
+                    }
+                    RestoreReplaySnapshot(State->ReplayMapping, Memory);
+                    GlobalDirtyRegion->Invalidate = true;
+                    State->IsPlayingBack = true;
+                }
+                else
+                {
+                    if (State->ReplayMapping)
+                    {
+                        UnmapViewOfFile(State->ReplayMapping);
+                        State->ReplayMapping = 0;
+                    }
+                    CloseHandle(State->ReplayMemoryMap);
+                }
+            }
+        }
+
+        if (!State->IsPlayingBack)
+        {
+            CloseHandle(State->ReplayFileHandle);
         }
+    }
+
+    return(State->IsPlayingBack);
+}
+
+// =====================================================================================================================
+
+internal void Win32EndInputPlayBack(win32_state *State)
+{
+    UnmapViewOfFile(State->ReplayMapping);
+    CloseHandle(State->ReplayMemoryMap);
+    CloseHandle(State->ReplayFileHandle);
+
+    State->ReplayMapping = 0;
+    State->IsPlayingBack = false;
+}
+
+// =====================================================================================================================
+
+internal void Win32PlayBackInput(win32_state *State, game_memory *Memory, game_input *NewInput)
+{
+    //NOTE: Called between frames. At the end of the recording we rewind game memory to the snapshot and go again.
+    TIMED_FUNCTION();
+
+    replay_file_header *Header = State->ReplayMapping;
+    if (State->PlaybackFrameIndex == Header->FrameCount)
+    {
+        char LoopBuffer[256];
+        sprintf(LoopBuffer, "playback loop %u: %u frames with a mismatched backbuffer hash\n",
+                State->PlaybackLoopCount, State->PlaybackMismatchCount);
+        OutputDebugStringA(LoopBuffer);
+
+        //NOTE: The backbuffer still holds the last frame of the loop, not the one the snapshot was taken after.
+        RestoreReplaySnapshot(Header, Memory);
+        GlobalDirtyRegion->Invalidate = true;
+        State->PlaybackFrameIndex = 0;
+        State->PlaybackMismatchCount = 0;
+        ++State->PlaybackLoopCount;
+    }
+
+    *NewInput = GetReplayFrame(Header, State->PlaybackFrameIndex)->Input;
+}
+
+// =====================================================================================================================
+
+internal void Win32CheckPlayBackFrame(win32_state *State, game_offscreen_buffer *Buffer)
+{
+    TIMED_FUNCTION();
+
+    replay_frame *Frame = GetReplayFrame(State->ReplayMapping, State->PlaybackFrameIndex);
+    if (HashBackbuffer(Buffer) != Frame->BackbufferHash)
+    {
+        if (State->PlaybackMismatchCount == 0)
+        {
+            char MismatchBuffer[256];
+            sprintf(MismatchBuffer, "playback diverged from the recording on frame %u of loop %u\n",
+                    State->PlaybackFrameIndex, State->PlaybackLoopCount);
+            OutputDebugStringA(MismatchBuffer);
+        }
+        ++State->PlaybackMismatchCount;
+    }
+    ++State->PlaybackFrameIndex;
+}
+
+// =====================================================================================================================
+
+internal void Win32ProcessPendingMessages(win32_state *State, game_memory *Memory,
+        game_controller_input *KeyboardController)
+{
+    //NOTE: Keyboard messages are handled here rather than in Win32MainWindowCallback so they can go straight into
+    //  this frame's input.
+    TIMED_FUNCTION();
 
-        DWORD Region2SampleCount = Region2Size / SoundOutput->BytesPerSample;
-        SampleOut = (int16 *)Region2;
-        for (DWORD SampleIndex = 0; SampleIndex < Region2SampleCount; ++SampleIndex)
+    MSG Message;
+    while (PeekMessage(&Message, 0, 0, 0, PM_REMOVE))
+    {
+        switch (Message.message)
         {
-            real32 SineValue = sinf(SoundOutput->tSine);
-            int16 SampleValue = (int16)(SineValue * SoundOutput->ToneVolume);
-            *SampleOut++ = SampleValue;
-            *SampleOut++ = SampleValue;
+            case WM_QUIT:
+            {
+                GlobalRunning = false;
+            } break;
+
+            case WM_SYSKEYDOWN:
+            case WM_SYSKEYUP:
+            case WM_KEYDOWN:
+            case WM_KEYUP:
+            {
+                uint32 VKCode = (uint32)Message.wParam;
+                // bit 30 says whether the key was down. 1 is yes, 0 is no.
+                bool32 WasDown = ((Message.lParam & (1 << 30)) != 0);
+                // bit 31 says whether the key is currently down or not.
+                bool32 IsDown = ((Message.lParam & (1 << 31)) == 0);
 
-            SoundOutput->tSine += 2.0f * Pi32 * 1.0f / (real32)SoundOutput->WavePeriod;
-            ++SoundOutput->RunningSampleIndex;
+                if (WasDown != IsDown)
+                {
+                    if (VKCode == 'W')
+                    {
+                        Win32ProcessKeyboardMessage(&KeyboardController->MoveUp, IsDown);
+                    }
+                    else if (VKCode == 'A')
+                    {
+                        Win32ProcessKeyboardMessage(&KeyboardController->MoveLeft, IsDown);
+                    }
+                    else if (VKCode == 'S')
+                    {
+                        Win32ProcessKeyboardMessage(&KeyboardController->MoveDown, IsDown);
+                    }
+                    else if (VKCode == 'D')
+                    {
+                        Win32ProcessKeyboardMessage(&KeyboardController->MoveRight, IsDown);
+                    }
+                    else if (VKCode == 'Q')
+                    {
+                        Win32ProcessKeyboardMessage(&KeyboardController->LeftShoulder, IsDown);
+                    }
+                    else if (VKCode == 'E')
+                    {
+                        Win32ProcessKeyboardMessage(&KeyboardController->RightShoulder, IsDown);
+                    }
+                    else if (VKCode == VK_UP)
+                    {
+                        Win32ProcessKeyboardMessage(&KeyboardController->ActionUp, IsDown);
+                    }
+                    else if (VKCode == VK_DOWN)
+                    {
+                        Win32ProcessKeyboardMessage(&KeyboardController->ActionDown, IsDown);
+                    }
+                    else if (VKCode == VK_LEFT)
+                    {
+                        Win32ProcessKeyboardMessage(&KeyboardController->ActionLeft, IsDown);
+                    }
+                    else if (VKCode == VK_RIGHT)
+                    {
+                        Win32ProcessKeyboardMessage(&KeyboardController->ActionRight, IsDown);
+                    }
+                    else if (VKCode == VK_ESCAPE)
+                    {
+                        Win32ProcessKeyboardMessage(&KeyboardController->Back, IsDown);
+                    }
+                    else if (VKCode == VK_SPACE)
+                    {
+                        Win32ProcessKeyboardMessage(&KeyboardController->Start, IsDown);
+                    }
+                    else if ((VKCode == 'P') && IsDown && GlobalPresentState)
+                    {
+                        GlobalPresentState->RequestedMode = (present_mode)((GlobalPresentState->RequestedMode + 1) %
+                                PresentMode_Count);
+                    }
+#if HANDMADE_INTERNAL
+                    else if ((VKCode == 'L') && IsDown)
+                    {
+                        //NOTE: Ten minutes at 60Hz is plenty for a profiling loop.
+                        if (State->IsPlayingBack)
+                        {
+                            Win32EndInputPlayBack(State);
+                        }
+                        else if (State->IsRecording)
+                        {
+                            Win32EndRecordingInput(State);
+                            Win32BeginInputPlayBack(State, Memory);
+                        }
+                        else
+                        {
+                            Win32BeginRecordingInput(State, Memory, 60*60*10);
+                        }
+                    }
+#endif
+                }
+
+                bool32 AltKeyWasDown = ((Message.lParam & (1 << 29)) != 0);
+                if ((VKCode == VK_F4) && AltKeyWasDown)
+                {
+                    GlobalRunning = false;
+                }
+            } break;
+
+            default:
+            {
+                TranslateMessage(&Message);
+                DispatchMessage(&Message);
+            } break;
         }
-        GlobalSecondaryBuffer->Unlock(Region1, Region1Size, Region2, Region2Size);
+    }
+}
+
+// =====================================================================================================================
+
+internal void Win32AddEntry(platform_work_queue *Queue, platform_work_queue_callback *Callback, void *Data)
+{
+    //TODO: Switch to InterlockedCompareExchange eventually so that any thread can add?
+    uint32 NewNextEntryToWrite = (Queue->NextEntryToWrite + 1) % ArrayCount(Queue->Entries);
+    Assert(NewNextEntryToWrite != Queue->NextEntryToRead);
+    platform_work_queue_entry *Entry = Queue->Entries + Queue->NextEntryToWrite;
+    Entry->Callback = Callback;
+    Entry->Data = Data;
+    ++Queue->CompletionGoal;
+
+    //NOTE: The entry has to be visible before the index that publishes it.
+    _WriteBarrier();
+    Queue->NextEntryToWrite = NewNextEntryToWrite;
+    ReleaseSemaphore(Queue->SemaphoreHandle, 1, 0);
+}
+
+// =====================================================================================================================
+
+internal bool32 Win32DoNextWorkQueueEntry(platform_work_queue *Queue)
+{
+    bool32 WeShouldSleep = false;
+
+    uint32 OriginalNextEntryToRead = Queue->NextEntryToRead;
+    uint32 NewNextEntryToRead = (OriginalNextEntryToRead + 1) % ArrayCount(Queue->Entries);
+    if (OriginalNextEntryToRead != Queue->NextEntryToWrite)
+    {
+        uint32 Index = InterlockedCompareExchange((LONG volatile *)&Queue->NextEntryToRead,
+                NewNextEntryToRead, OriginalNextEntryToRead);
+        if (Index == OriginalNextEntryToRead)
+        {
+            platform_work_queue_entry Entry = Queue->Entries[Index];
+            Entry.Callback(Queue, Entry.Data);
+            InterlockedIncrement((LONG volatile *)&Queue->CompletionCount);
+        }
+    }
+    else
+    {
+        WeShouldSleep = true;
+    }
+
+    return(WeShouldSleep);
+}
+
+// =====================================================================================================================
+
+internal void Win32CompleteAllWork(platform_work_queue *Queue)
+{
+    TIMED_FUNCTION();
+
+    while (Queue->CompletionGoal != Queue->CompletionCount)
+    {
+        Win32DoNextWorkQueueEntry(Queue);
+    }
+
+    Queue->CompletionGoal = 0;
+    Queue->CompletionCount = 0;
+}
+
+// =====================================================================================================================
+
+DWORD WINAPI Win32WorkerThreadProc(LPVOID lpParameter)
+{
+    platform_work_queue *Queue = (platform_work_queue *)lpParameter;
+    for (;;)
+    {
+        if (Win32DoNextWorkQueueEntry(Queue))
+        {
+            WaitForSingleObjectEx(Queue->SemaphoreHandle, INFINITE, FALSE);
+        }
+    }
+}
+
+// =====================================================================================================================
+
+internal void Win32MakeQueue(platform_work_queue *Queue, int ThreadCount)
+{
+    //NOTE: ThreadCount is the number of workers besides the thread that calls Win32CompleteAllWork.
+    Queue->CompletionGoal = 0;
+    Queue->CompletionCount = 0;
+    Queue->NextEntryToWrite = 0;
+    Queue->NextEntryToRead = 0;
+    Queue->ThreadCount = ThreadCount;
+
+    uint32 InitialCount = 0;
+    Queue->SemaphoreHandle = CreateSemaphoreEx(0, InitialCount, (ThreadCount > 0) ? ThreadCount : 1,
+            0, 0, SEMAPHORE_ALL_ACCESS);
+
+    for (int ThreadIndex = 0; ThreadIndex < ThreadCount; ++ThreadIndex)
+    {
+        DWORD ThreadID;
+        HANDLE ThreadHandle = CreateThread(0, 0, Win32WorkerThreadProc, Queue, 0, &ThreadID);
+        CloseHandle(ThreadHandle);
+    }
+}
+
+// =====================================================================================================================
+
+internal int Win32GetGameUpdateHz(HDC DeviceContext, char *CommandLine)
+{
+    //NOTE: "-hz N" on the command line wins, otherwise we lock to whatever the monitor refreshes at. Windows reports
+    //  0 or 1 for "hardware default", in which case we fall back to 60.
+    int Result = 60;
+    int RefreshRate = GetDeviceCaps(DeviceContext, VREFRESH);
+    if (RefreshRate > 1)
+    {
+        Result = RefreshRate;
+    }
+
+    char *HzArg = strstr(CommandLine, "-hz ");
+    if (HzArg)
+    {
+        int RequestedHz = atoi(HzArg + 4);
+        if (RequestedHz > 0)
+        {
+            Result = RequestedHz;
+        }
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal uint32 Win32GetAudioLatencyMS(char *CommandLine)
+{
+    //NOTE: "-latency N" on the command line, in milliseconds; how far ahead of the card the audio thread stays.
+    int Result = SOUND_FEED_DEFAULT_LATENCY_MS;
+    char *LatencyArg = strstr(CommandLine, "-latency ");
+    if (LatencyArg)
+    {
+        int RequestedMS = atoi(LatencyArg + 9);
+        if ((RequestedMS > 0) && (RequestedMS <= SOUND_FEED_MAX_LATENCY_MS))
+        {
+            Result = RequestedMS;
+        }
+    }
+    return((uint32)Result);
+}
+
+// =====================================================================================================================
+
+internal uint32 Win32GetControllerPollHz(char *CommandLine)
+{
+    //NOTE: "-pad N" on the command line, in Hz; how often the controller thread reads each connected gamepad.
+    int Result = CONTROLLER_POLL_DEFAULT_HZ;
+    char *PollArg = strstr(CommandLine, "-pad ");
+    if (PollArg)
+    {
+        int RequestedHz = atoi(PollArg + 5);
+        if ((RequestedHz > 0) && (RequestedHz <= CONTROLLER_POLL_MAX_HZ))
+        {
+            Result = RequestedHz;
+        }
+    }
+    return((uint32)Result);
+}
+
+// =====================================================================================================================
+
+internal bool32 Win32WaitForFrameEnd(LARGE_INTEGER FrameStart, real32 TargetSecondsPerFrame, bool32 SleepIsGranular)
+{
+    //NOTE: Sleep for all but the last millisecond, then spin the rest. Even with the scheduler at 1ms, Sleep can
+    //  overshoot by most of a tick, so we never ask it to take us all the way there. Returns true when the frame
+    //  was already late before we got here.
+    TIMED_FUNCTION();
+
+    bool32 MissedFrame = false;
+
+    real32 SecondsElapsedForFrame = Win32GetSecondsElapsed(FrameStart, Win32GetWallClock());
+    if (SecondsElapsedForFrame < TargetSecondsPerFrame)
+    {
+        if (SleepIsGranular)
+        {
+            real32 SleepSeconds = TargetSecondsPerFrame - SecondsElapsedForFrame - 0.001f;
+            if (SleepSeconds > 0.0f)
+            {
+                DWORD SleepMS = (DWORD)(1000.0f * SleepSeconds);
+                if (SleepMS > 0)
+                {
+                    Sleep(SleepMS);
+                }
+            }
+        }
+
+        while (SecondsElapsedForFrame < TargetSecondsPerFrame)
+        {
+            _mm_pause();
+            SecondsElapsedForFrame = Win32GetSecondsElapsed(FrameStart, Win32GetWallClock());
+        }
+    }
+    else
+    {
+        MissedFrame = true;
+    }
+
+    return(MissedFrame);
+}
+
+// =====================================================================================================================
+
+internal platform_file_mapping Win32MapFile(char *FileName)
+{
+    //NOTE: The view keeps the mapping and the file alive on its own, so both handles can go right away.
+    platform_file_mapping Result = {};
+    HANDLE FileHandle = CreateFileA(FileName, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, 0, 0);
+    if (FileHandle != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER FileSize;
+        if (GetFileSizeEx(FileHandle, &FileSize) && (FileSize.QuadPart > 0))
+        {
+            HANDLE MappingHandle = CreateFileMappingA(FileHandle, 0, PAGE_READONLY, 0, 0, 0);
+            if (MappingHandle)
+            {
+                Result.Memory = MapViewOfFileEx(MappingHandle, FILE_MAP_READ, 0, 0, 0, GlobalNextFileMappingAddress);
+                if (!Result.Memory && GlobalNextFileMappingAddress)
+                {
+                    Result.Memory = MapViewOfFile(MappingHandle, FILE_MAP_READ, 0, 0, 0);
+                }
+                if (Result.Memory)
+                {
+                    Result.Size = (uint64)FileSize.QuadPart;
+                    if (GlobalNextFileMappingAddress)
+                    {
+                        //NOTE: Views have to start on the 64KB allocation granularity.
+                        GlobalNextFileMappingAddress += (Result.Size + Kilobytes(64) - 1) &
+                            ~(uint64)(Kilobytes(64) - 1);
+                    }
+                }
+                CloseHandle(MappingHandle);
+            }
+        }
+        CloseHandle(FileHandle);
+    }
+    return(Result);
+}
+
+// =====================================================================================================================
+
+internal void Win32UnmapFile(platform_file_mapping *Mapping)
+{
+    if (Mapping->Memory)
+    {
+        UnmapViewOfFile(Mapping->Memory);
+    }
+    Mapping->Memory = 0;
+    Mapping->Size = 0;
+}
+
+// =====================================================================================================================
+
+internal void Win32OutputArenaStats(memory_arena_registry *Registry)
+{
+    for (int ArenaIndex = 0; ArenaIndex < Registry->ArenaCount; ++ArenaIndex)
+    {
+        memory_arena *Arena = Registry->Arenas[ArenaIndex];
+        char StatsBuffer[256];
+        sprintf(StatsBuffer, "%s: high water %.03fKB of %.03fKB\n", Arena->Name,
+                (real64)Arena->HighWaterMark / 1024.0, (real64)Arena->Size / 1024.0);
+        OutputDebugStringA(StatsBuffer);
     }
 }
 
@@ -429,7 +1216,81 @@ int CALLBACK WinMain(
     
     WNDCLASSA WindowClass = {};
 
-    Win32ResizeDIBSection(&GlobalBackbuffer, 1280, 720);
+#if HANDMADE_INTERNAL
+    LPVOID BaseAddress = (LPVOID)Terabytes(2);
+#else
+    LPVOID BaseAddress = 0;
+#endif
+
+    //NOTE: Everything the program will ever use is reserved here, up front: game permanent storage, game transient
+    //  storage, then the platform's own block for the backbuffer, the display buffer and the sound staging buffer,
+    //  then in internal builds the profiler's rings and collation state.
+    game_memory GameMemory = {};
+    GameMemory.PermanentStorageSize = Megabytes(64);
+    GameMemory.TransientStorageSize = Gigabytes(1);
+    memory_index DisplayBufferSize = (memory_index)PRESENT_MAX_WIDTH * PRESENT_MAX_HEIGHT * 4;
+    memory_index PlatformStorageSize = Megabytes(8) + DisplayBufferSize + GetPresentStorageSize();
+#if HANDMADE_INTERNAL
+    memory_index DebugStorageSize = Megabytes(64);
+#else
+    memory_index DebugStorageSize = 0;
+#endif
+
+    win32_state Win32State = {};
+    Win32State.TotalSize = GameMemory.PermanentStorageSize + GameMemory.TransientStorageSize + PlatformStorageSize +
+        DebugStorageSize;
+    Win32State.GameMemoryBlock = VirtualAlloc(BaseAddress, (size_t)Win32State.TotalSize,
+            MEM_RESERVE|MEM_COMMIT, PAGE_READWRITE);
+    if (!Win32State.GameMemoryBlock)
+    {
+        //TODO: Logging
+        return(0);
+    }
+#if HANDMADE_INTERNAL
+    GlobalNextFileMappingAddress = (uint8 *)BaseAddress + Terabytes(1);
+#endif
+
+    GameMemory.PermanentStorage = Win32State.GameMemoryBlock;
+    GameMemory.TransientStorage = ((uint8 *)GameMemory.PermanentStorage + GameMemory.PermanentStorageSize);
+    InitializeArena(&Win32State.PlatformArena, (char *)"Platform", PlatformStorageSize,
+            (uint8 *)GameMemory.TransientStorage + GameMemory.TransientStorageSize);
+    RegisterArena(&GameMemory.ArenaRegistry, &Win32State.PlatformArena);
+
+#if HANDMADE_INTERNAL
+    //NOTE: The profiler's table has to exist before anything records into it, including the worker threads.
+    InitializeArena(&Win32State.DebugArena, (char *)"Debug", DebugStorageSize,
+            Win32State.PlatformArena.Base + Win32State.PlatformArena.Size);
+    RegisterArena(&GameMemory.ArenaRegistry, &Win32State.DebugArena);
+
+    debug_table *DebugTable = PushStruct(&Win32State.DebugArena, debug_table, 64);
+    Win32State.DebugState = PushStruct(&Win32State.DebugArena, debug_state, 64);
+    InitializeDebugState(Win32State.DebugState, DebugTable, &Win32State.DebugArena);
+    GlobalDebugTable = DebugTable;
+    GameMemory.DebugTable = DebugTable;
+#endif
+
+    Win32GetEXEFileName(&Win32State);
+
+    char SourceGameCodeDLLFullPath[WIN32_STATE_FILE_NAME_COUNT];
+    Win32BuildEXEPathFileName(&Win32State, (char *)"handmade.dll",
+            sizeof(SourceGameCodeDLLFullPath), SourceGameCodeDLLFullPath);
+
+    char TempGameCodeDLLFullPath[WIN32_STATE_FILE_NAME_COUNT];
+    Win32BuildEXEPathFileName(&Win32State, (char *)"handmade_temp.dll",
+            sizeof(TempGameCodeDLLFullPath), TempGameCodeDLLFullPath);
+
+    char GameCodeLockFullPath[WIN32_STATE_FILE_NAME_COUNT];
+    Win32BuildEXEPathFileName(&Win32State, (char *)"lock.tmp", sizeof(GameCodeLockFullPath), GameCodeLockFullPath);
+
+    Win32ResizeDIBSection(&GlobalBackbuffer, &Win32State.PlatformArena, 1280, 720);
+    GlobalDirtyRegion = PushStruct(&Win32State.PlatformArena, game_dirty_region, 64);
+    GlobalDirtyRegion->Invalidate = true;
+
+    //NOTE: The display buffer is sized for the biggest window we present at, so following the window around later
+    //  never has to allocate.
+    Win32ResizeDIBSection(&GlobalDisplayBuffer, &Win32State.PlatformArena, PRESENT_MAX_WIDTH, PRESENT_MAX_HEIGHT);
+    GlobalPresentState = PushStruct(&Win32State.PlatformArena, present_state, 64);
+    InitializePresentState(GlobalPresentState, &Win32State.PlatformArena, PresentMode_Integer);
 
     //NOTE: I can specify CS_OWNDC. What that does is allow us to do is get the device context once and just own it
     //  forever, meaning the HDC DeviceContext that shows up later does not have to be released.
@@ -440,9 +1301,20 @@ int CALLBACK WinMain(
     WindowClass.hInstance = Instance;
     WindowClass.lpszClassName = "HandmadeHeroWindowClass";
 
+    Win32BuildEXEPathFileName(&Win32State, (char *)"handmade_loop.hmi",
+            sizeof(Win32State.ReplayFileName), Win32State.ReplayFileName);
+
+    char TraceFullPath[WIN32_STATE_FILE_NAME_COUNT];
+    Win32BuildEXEPathFileName(&Win32State, (char *)"handmade_trace.json", sizeof(TraceFullPath), TraceFullPath);
+
     LARGE_INTEGER PerfCountFrequencyResult;
     QueryPerformanceFrequency(&PerfCountFrequencyResult);
-    int64 PerfCountFrequency = PerfCountFrequencyResult.QuadPart; // Counts-per-second
+    GlobalPerfCountFrequency = PerfCountFrequencyResult.QuadPart; // Counts-per-second
+
+    //NOTE: Ask for a 1ms scheduler granularity so that Sleep in the frame wait is usable. If we don't get it we
+    //  spin the whole way instead.
+    UINT DesiredSchedulerMS = 1;
+    bool32 SleepIsGranular = (timeBeginPeriod(DesiredSchedulerMS) == TIMERR_NOERROR);
 
     if (RegisterClass(&WindowClass)) 
     {
@@ -457,136 +1329,267 @@ int CALLBACK WinMain(
         {
             HDC DeviceContext = GetDC(Window);
 
-            //NOTE: GraphicsTest
-            int XOffset = 0;
-            int YOffset = 0;
+            int GameUpdateHz = Win32GetGameUpdateHz(DeviceContext, CommandLine);
+            real32 TargetSecondsPerFrame = 1.0f / (real32)GameUpdateHz;
 
             //NOTE: Sound Test
             win32_sound_output SoundOutput = {};
 
             SoundOutput.SamplesPerSecond = 48000;
-            SoundOutput.ToneHz = 256;
-            SoundOutput.ToneVolume = 5000;
-            SoundOutput.RunningSampleIndex = 0;
-            SoundOutput.WavePeriod = SoundOutput.SamplesPerSecond / SoundOutput.ToneHz;
-            SoundOutput.LatencySampleCount = SoundOutput.SamplesPerSecond / 15;
             SoundOutput.BytesPerSample = sizeof(int16) * 2;
             SoundOutput.SecondaryBufferSize = SoundOutput.SamplesPerSecond * SoundOutput.BytesPerSample;
 
             Win32InitDSound(Window, SoundOutput.SamplesPerSecond, SoundOutput.SecondaryBufferSize);
-            Win32FillSoundBuffer(&SoundOutput, 0, SoundOutput.SecondaryBufferSize);
+            Win32ClearSoundBuffer(&SoundOutput);
             GlobalSecondaryBuffer->Play(0, 0, DSBPLAY_LOOPING);
 
-            GlobalRunning = true;
-
-            LARGE_INTEGER LastCounter;
-            QueryPerformanceCounter(&LastCounter);
-            uint64 LastCycleCount = __rdtsc();
-            while(GlobalRunning)
+            //NOTE: The game writes its samples here first, then we copy them into the sound ring for the audio
+            //  thread to pick up.
+            int16 *Samples = (int16 *)PushSize(&Win32State.PlatformArena, SoundOutput.SecondaryBufferSize, 64);
+
+            InitializeSoundRing(&SoundOutput.Ring, SOUND_RING_SAMPLE_COUNT,
+                    (int16 *)PushSize(&Win32State.PlatformArena,
+                        SOUND_RING_SAMPLE_COUNT * SoundOutput.BytesPerSample, 64));
+            InitializeSoundFeed(&SoundOutput.Feed, SoundOutput.SamplesPerSecond,
+                    SoundOutput.SecondaryBufferSize / SoundOutput.BytesPerSample,
+                    Win32GetAudioLatencyMS(CommandLine), SOUND_FEED_PERIOD_MS);
+            uint32 SamplesPerFrame = (uint32)(SoundOutput.SamplesPerSecond / GameUpdateHz);
+
+            DWORD AudioThreadID;
+            SoundOutput.AudioThreadIsRunning = 1;
+            SoundOutput.AudioThread = CreateThread(0, 0, Win32AudioThreadProc, &SoundOutput, 0, &AudioThreadID);
+
+            //NOTE: Only the left stick's dead zone is used. game_controller_input has one stick and no triggers, so
+            //  Win32ReadXInputController never reads sThumbRX/sThumbRY or the trigger bytes, and
+            //  XINPUT_GAMEPAD_RIGHT_THUMB_DEADZONE and XINPUT_GAMEPAD_TRIGGER_THRESHOLD have nothing to apply to.
+            //  Giving the game the right stick or the triggers means reading them there and applying those here.
+            win32_controller_input ControllerInput = {};
+            ControllerInput.Poller = PushStruct(&Win32State.PlatformArena, controller_poller, 64);
+            InitializeControllerPoller(ControllerInput.Poller, Win32ReadXInputController, 0,
+                    (uint64)GlobalPerfCountFrequency, Win32GetControllerPollHz(CommandLine),
+                    XINPUT_GAMEPAD_LEFT_THUMB_DEADZONE);
+            controller_slot_state LastControllerSlots[CONTROLLER_POLL_SLOT_COUNT] = {};
+
+            DWORD ControllerThreadID;
+            ControllerInput.ThreadIsRunning = 1;
+            ControllerInput.Thread = CreateThread(0, 0, Win32ControllerThreadProc, &ControllerInput, 0,
+                    &ControllerThreadID);
+
+            //NOTE: The main thread joins the work in Win32CompleteAllWork, so it counts as one of the render threads.
+            SYSTEM_INFO SystemInfo;
+            GetSystemInfo(&SystemInfo);
+            platform_work_queue HighPriorityQueue = {};
+            Win32MakeQueue(&HighPriorityQueue, (int)SystemInfo.dwNumberOfProcessors - 1);
+
+            //NOTE: Asset loads spend most of their time waiting on the disk, so they get a couple of threads of
+            //  their own rather than holding up render work.
+            platform_work_queue LowPriorityQueue = {};
+            Win32MakeQueue(&LowPriorityQueue, 2);
+
+            GameMemory.HighPriorityQueue = &HighPriorityQueue;
+            GameMemory.LowPriorityQueue = &LowPriorityQueue;
+            GameMemory.PlatformAPI.AddEntry = Win32AddEntry;
+            GameMemory.PlatformAPI.CompleteAllWork = Win32CompleteAllWork;
+            GameMemory.PlatformAPI.MapFile = Win32MapFile;
+            GameMemory.PlatformAPI.UnmapFile = Win32UnmapFile;
+
+            if (Samples)
             {
-                LARGE_INTEGER BeginCounter;
-                QueryPerformanceCounter(&BeginCounter);
+                game_input Input[2] = {};
+                game_input *NewInput = &Input[0];
+                game_input *OldInput = &Input[1];
 
-                MSG Message;
-                while (PeekMessage(&Message, 0, 0, 0, PM_REMOVE))
+                GlobalRunning = true;
+
+                frame_timing_stats FrameStats;
+                BeginFrameTimingStats(&FrameStats, TargetSecondsPerFrame);
+
+                win32_game_code Game = Win32LoadGameCode(SourceGameCodeDLLFullPath, TempGameCodeDLLFullPath);
+
+                LARGE_INTEGER LastCounter = Win32GetWallClock();
+                uint64 LastCycleCount = __rdtsc();
+                while(GlobalRunning)
                 {
-                    if (Message.message == WM_QUIT)
+                    //NOTE: Reloads only happen here, between frames, where the render queue is guaranteed to be empty
+                    //  and nothing is still running DLL code. Loads still in flight on the low priority queue would
+                    //  be running DLL code, so they get finished first. The lock file is there for as long as the
+                    //  build is writing the DLL. The reload is timed because it comes out of this frame's budget.
+                    FILETIME NewDLLWriteTime = Win32GetLastWriteTime(SourceGameCodeDLLFullPath);
+                    WIN32_FILE_ATTRIBUTE_DATA Ignored;
+                    if ((CompareFileTime(&NewDLLWriteTime, &Game.DLLLastWriteTime) != 0) &&
+                            !GetFileAttributesExA(GameCodeLockFullPath, GetFileExInfoStandard, &Ignored))
                     {
-                        GlobalRunning = false;
+                        TIMED_BLOCK("ReloadGameCode");
+                        LARGE_INTEGER ReloadStart = Win32GetWallClock();
+                        Win32CompleteAllWork(&LowPriorityQueue);
+#if HANDMADE_INTERNAL
+                        CollateDebugRings(Win32State.DebugState);
+#endif
+                        Win32UnloadGameCode(&Game);
+                        Game = Win32LoadGameCode(SourceGameCodeDLLFullPath, TempGameCodeDLLFullPath);
+                        GlobalDirtyRegion->Invalidate = true;
+                        real32 ReloadSeconds = Win32GetSecondsElapsed(ReloadStart, Win32GetWallClock());
+
+                        char ReloadBuffer[256];
+                        sprintf(ReloadBuffer, "reloaded game code in %.03fms%s%s\n", 1000.0f * ReloadSeconds,
+                                (ReloadSeconds > TargetSecondsPerFrame) ? " (over frame budget)" : "",
+                                Game.IsValid ? "" : " (invalid, running the stub)");
+                        OutputDebugStringA(ReloadBuffer);
                     }
-                    TranslateMessage(&Message);
-                    DispatchMessage(&Message);
-                }
-                
-                //TODO: Should we poll this more frequently??? It would make sense that we might want to poll more
-                //  often than once per frame.
-                for(DWORD ControllerIndex = 0;
-                        ControllerIndex < XUSER_MAX_COUNT;
-                        ControllerIndex++)
-                {
-                    XINPUT_STATE ControllerState;
-                    if(XInputGetState(ControllerIndex, &ControllerState) == ERROR_SUCCESS)
+
+                    //NOTE: Keys only send messages when they change, so held keys carry over from last frame.
+                    game_controller_input *OldKeyboardController = GetController(OldInput, 0);
+                    game_controller_input *NewKeyboardController = GetController(NewInput, 0);
+                    *NewKeyboardController = {};
+                    NewKeyboardController->IsConnected = true;
+                    for (int ButtonIndex = 0; ButtonIndex < (int)ArrayCount(NewKeyboardController->Buttons);
+                            ++ButtonIndex)
                     {
-                        //NOTE: This controller is available
-                        XINPUT_GAMEPAD *Pad = &ControllerState.Gamepad;
-
-                        bool32 Up = (Pad->wButtons & XINPUT_GAMEPAD_DPAD_UP);
-                        bool32 Down = (Pad->wButtons & XINPUT_GAMEPAD_DPAD_DOWN);
-                        bool32 Left = (Pad->wButtons & XINPUT_GAMEPAD_DPAD_LEFT);
-                        bool32 Right = (Pad->wButtons & XINPUT_GAMEPAD_DPAD_RIGHT);
-                        bool32 Start = (Pad->wButtons & XINPUT_GAMEPAD_START);
-                        bool32 Back = (Pad->wButtons & XINPUT_GAMEPAD_BACK);
-                        bool32 LeftShoulder = (Pad->wButtons & XINPUT_GAMEPAD_LEFT_SHOULDER);
-                        bool32 RightShoulder = (Pad->wButtons & XINPUT_GAMEPAD_RIGHT_SHOULDER);
-                        bool32 AButton = (Pad->wButtons & XINPUT_GAMEPAD_A);
-                        bool32 BButton = (Pad->wButtons & XINPUT_GAMEPAD_B);
-                        bool32 XButton = (Pad->wButtons & XINPUT_GAMEPAD_X);
-                        bool32 YButton = (Pad->wButtons & XINPUT_GAMEPAD_Y);
-
-                        int16 StickX = Pad->sThumbLX;
-                        int16 StickY = Pad->sThumbLY;
-
-                        // TODO do deadzone handling using
-                        // XINPUT_GAMEPAD_LEFT_THUMB_DEADZONE
-                        // XINPUT_GAMEPAD_RIGHT_THUMB_DEADZONE
-
-                        XOffset += StickX / 4096;
-                        YOffset += StickY / 4096;
-
-                        SoundOutput.ToneHz = 512 + (int)(256.0f * ((real32)StickY / 30000.0f));
-                        SoundOutput.WavePeriod = SoundOutput.SamplesPerSecond / SoundOutput.ToneHz;
+                        NewKeyboardController->Buttons[ButtonIndex].EndedDown =
+                            OldKeyboardController->Buttons[ButtonIndex].EndedDown;
                     }
-                    else 
+
+                    Win32ProcessPendingMessages(&Win32State, &GameMemory, NewKeyboardController);
+                    NewInput->dtForFrame = TargetSecondsPerFrame;
+
+                    //NOTE: Gamepads are read on their own thread (see handmade_controller_poll.h); the frame just takes
+                    //  whatever it has published since the last frame.
                     {
-                        //NOTE: This controller is NOT available
+                        TIMED_BLOCK("ReadControllers");
+                        controller_snapshot *Snapshot = ReadControllerSnapshot(ControllerInput.Poller);
+                        for (int SlotIndex = 0; SlotIndex < CONTROLLER_POLL_SLOT_COUNT; ++SlotIndex)
+                        {
+                            ApplyControllerSlot(LastControllerSlots + SlotIndex, Snapshot->Slots + SlotIndex,
+                                    GetController(NewInput, SlotIndex + 1));
+                            LastControllerSlots[SlotIndex] = Snapshot->Slots[SlotIndex];
+                        }
                     }
-                }
 
-                RenderWeirdGradient(&GlobalBackbuffer, XOffset, YOffset);
+                    //NOTE: The audio thread is what keeps the card fed; all the frame has to do is keep enough in the
+                    //  ring to see it through the next frame, plus the latency target again as slack for a frame that
+                    //  runs long.
+                    game_sound_output_buffer SoundBuffer = {};
+                    SoundBuffer.SamplesPerSecond = SoundOutput.SamplesPerSecond;
+                    SoundBuffer.SampleCount = (int)GetSoundRingProduceCount(&SoundOutput.Ring,
+                            SamplesPerFrame + SoundOutput.Feed.LatencySampleCount,
+                            (uint32)(SoundOutput.SecondaryBufferSize / SoundOutput.BytesPerSample));
+                    SoundBuffer.Samples = Samples;
+
+                    game_offscreen_buffer Buffer = {};
+                    Buffer.Memory = GlobalBackbuffer.Memory;
+                    Buffer.Width = GlobalBackbuffer.Width;
+                    Buffer.Height = GlobalBackbuffer.Height;
+                    Buffer.Pitch = GlobalBackbuffer.Pitch;
+                    Buffer.BytesPerPixel = GlobalBackbuffer.BytesPerPixel;
+                    Buffer.Dirty = GlobalDirtyRegion;
+
+                    //NOTE: Normally a load becomes visible whenever it happens to finish. While recording or playing
+                    //  back they are all finished between frames instead, so every loop sees the same assets arrive
+                    //  on the same frames.
+                    if (Win32State.IsRecording || Win32State.IsPlayingBack)
+                    {
+                        Win32CompleteAllWork(&LowPriorityQueue);
+                    }
 
-                //NOTE: DirectSound output test
-                DWORD PlayCursor;
-                DWORD WriteCursor;
-                if (SUCCEEDED(GlobalSecondaryBuffer->GetCurrentPosition(&PlayCursor, &WriteCursor)))
-                {
-                    DWORD ByteToLock = 
-                        (SoundOutput.RunningSampleIndex * SoundOutput.BytesPerSample) % SoundOutput.SecondaryBufferSize;
-                    DWORD TargetCursor = ((PlayCursor + 
-                            (SoundOutput.LatencySampleCount * SoundOutput.BytesPerSample)) 
-                            % SoundOutput.SecondaryBufferSize);
-                    DWORD BytesToWrite;
-                    //TODO: Should use a lower latency offset instead of the full buffer size.
-                    if (ByteToLock > TargetCursor)
+                    if (Win32State.IsPlayingBack)
                     {
-                        BytesToWrite = (SoundOutput.SecondaryBufferSize - ByteToLock) + TargetCursor;
+                        Win32PlayBackInput(&Win32State, &GameMemory, NewInput);
                     }
-                    else 
+
+                    Game.UpdateAndRender(&GameMemory, NewInput, &Buffer, &SoundBuffer);
+
+                    if (Win32State.IsRecording)
                     {
-                        BytesToWrite = TargetCursor - ByteToLock;
+                        Win32RecordInput(&Win32State, NewInput, &Buffer);
                     }
-                    
-                    Win32FillSoundBuffer(&SoundOutput, ByteToLock, BytesToWrite);
-                }
+                    if (Win32State.IsPlayingBack)
+                    {
+                        Win32CheckPlayBackFrame(&Win32State, &Buffer);
+                    }
+
+                    WriteSoundRing(&SoundOutput.Ring, Samples, (uint32)SoundBuffer.SampleCount);
+
+                    //NOTE: Scaling to the window is part of the frame's work, so it happens before the wait and only
+                    //  the 1:1 copy is left for the flip.
+                    win32_window_dimension Dimension = Win32PresentBackbuffer(Window, &GameMemory.PlatformAPI,
+                            &HighPriorityQueue);
+
+                    //NOTE: The frame's work is done; burn off what's left of its time so the flip lands on the frame
+                    //  boundary.
+                    bool32 MissedFrame = Win32WaitForFrameEnd(LastCounter, TargetSecondsPerFrame, SleepIsGranular);
+
+                    bool32 CopyAll = GlobalPresentState->LayoutChanged;
+                    Win32DisplayBufferInWindow(&GlobalDisplayBuffer, DeviceContext, Dimension.Width, Dimension.Height,
+                            CopyAll ? 0 : GlobalPresentState->Rects, GlobalPresentState->RectCount);
+
+                    LARGE_INTEGER EndCounter = Win32GetWallClock();
+                    uint64 EndCycleCount = __rdtsc();
 
-                win32_window_dimension Dimension = Win32GetWindowDimension(Window);
-                Win32DisplayBufferInWindow(&GlobalBackbuffer, DeviceContext, Dimension.Width, Dimension.Height);
+                    real32 SecondsElapsedForFrame = Win32GetSecondsElapsed(LastCounter, EndCounter);
+                    RecordFrameTiming(&FrameStats, SecondsElapsedForFrame, MissedFrame);
 
-                LARGE_INTEGER EndCounter;
-                QueryPerformanceCounter(&EndCounter);
+                    uint64 CyclesElapsed = EndCycleCount - LastCycleCount;
+                    real32 MSPerFrame = 1000.0f * SecondsElapsedForFrame;
+                    real32 FPS = 1.0f / SecondsElapsedForFrame;
+                    real32 MCPF = ((real32)CyclesElapsed / (1000.0f * 1000.0f));
 
-                uint64 EndCycleCount = __rdtsc();
+                    char FPSBuffer[256];
+                    sprintf(FPSBuffer, "%.02fms/f,  %.02ff/s,  %.02fmc/f,  %upx rendered,  %upx presented%s\n",
+                            MSPerFrame, FPS, MCPF, GlobalDirtyRegion->RenderedPixelCount,
+                            GlobalPresentState->PresentedPixelCount, MissedFrame ? "  (missed)" : "");
+                    OutputDebugStringA(FPSBuffer);
 
-                uint64 CyclesElapsed = EndCycleCount - LastCycleCount;
-                int64 CounterElapsed = EndCounter.QuadPart - LastCounter.QuadPart; // Number of Counts
-                real32 MSPerFrame = (real32)((real32)(1000.0f * CounterElapsed) / (real32)PerfCountFrequency); // seconds elapsed
-                real32 FPS = (real32)PerfCountFrequency / (real32)CounterElapsed;
-                real32 MCPF = ((real32)CyclesElapsed / (1000.0f * 1000.0f));
+#if HANDMADE_INTERNAL
+                    {
+                        TIMED_BLOCK("DebugCollation");
+                        CollateDebugFrame(Win32State.DebugState,
+                                (real64)Win32GetWallClock().QuadPart / (real64)GlobalPerfCountFrequency);
+                    }
+#endif
 
-                char Buffer[256];
-                sprintf(Buffer, "%.02fms/f,  %.02ff/s,  %.02fmc/f\n", MSPerFrame, FPS, MCPF);
-                OutputDebugStringA(Buffer);
+                    LastCounter = EndCounter;
+                    LastCycleCount = EndCycleCount;
+
+                    game_input *Temp = NewInput;
+                    NewInput = OldInput;
+                    OldInput = Temp;
+                }
 
-                LastCounter = EndCounter;
+                if (ControllerInput.Thread)
+                {
+                    Win32StopControllerThread(&ControllerInput);
+                }
+                if (SoundOutput.AudioThread)
+                {
+                    Win32StopAudioThread(&SoundOutput);
+                }
+
+                char FrameStatsBuffer[1024];
+                FormatFrameTimingStats(&FrameStats, FrameStatsBuffer, sizeof(FrameStatsBuffer));
+                OutputDebugStringA(FrameStatsBuffer);
+                char SoundStatsBuffer[256];
+                FormatSoundFeedStats(&SoundOutput.Feed, SoundStatsBuffer, sizeof(SoundStatsBuffer));
+                OutputDebugStringA(SoundStatsBuffer);
+                Win32OutputArenaStats(&GameMemory.ArenaRegistry);
+
+#if HANDMADE_INTERNAL
+                //NOTE: The report goes to the debugger output like everything else; the trace goes next to the
+                //  executable, ready to be dropped into chrome://tracing.
+                int ReportSize = (int)Megabytes(1);
+                char *ReportBuffer = (char *)PushSize(&Win32State.DebugArena, ReportSize);
+                FormatDebugReport(Win32State.DebugState, ReportBuffer, ReportSize);
+                OutputDebugStringA(ReportBuffer);
+                if (!WriteDebugChromeTrace(Win32State.DebugState, TraceFullPath))
+                {
+                    OutputDebugStringA("Unable to write the profiler trace\n");
+                }
+#endif
+            }
+            else
+            {
+                //TODO: Logging
+                Win32StopControllerThread(&ControllerInput);
+                Win32StopAudioThread(&SoundOutput);
             }
         }
         else
@@ -599,6 +1602,10 @@ int CALLBACK WinMain(
         //TODO: Logging
     }
 
+    if (SleepIsGranular)
+    {
+        timeEndPeriod(DesiredSchedulerMS);
+    }
 
     return(0);
 }
@@ -0,0 +1,112 @@
+#if !defined(WIN32_HANDMADE_H)
+#define WIN32_HANDMADE_H
+
+struct win32_offscreen_buffer
+{
+    //NOTE: Pixels are always 32-bits wide, Memory Order BB GG RR xx
+    BITMAPINFO Info;
+    void* Memory;
+    int MemorySize;
+    int Width;
+    int Height;
+    int BytesPerPixel;
+    int Pitch;
+};
+
+#define WIN32_STATE_FILE_NAME_COUNT MAX_PATH
+struct win32_state
+{
+    //NOTE: One reservation for everything: game permanent storage, game transient storage, then the platform's own,
+    //  then the profiler's in internal builds.
+    uint64 TotalSize;
+    void *GameMemoryBlock;
+
+    memory_arena PlatformArena;
+    memory_arena DebugArena;
+    debug_state *DebugState;
+
+    //NOTE: The game DLL is looked up next to the executable, not in the working directory.
+    char EXEFileName[WIN32_STATE_FILE_NAME_COUNT];
+    char *OnePastLastEXEFileNameSlash;
+    //NOTE: Input recording and playback, see handmade_replay.h. Only one of the two runs at a time, and both go
+    //  through the one mapping. 'L' cycles between recording, playing back and neither.
+    char ReplayFileName[WIN32_STATE_FILE_NAME_COUNT];
+    HANDLE ReplayFileHandle;
+    HANDLE ReplayMemoryMap;
+    replay_file_header *ReplayMapping;
+    bool32 IsRecording;
+    bool32 IsPlayingBack;
+
+    uint32 PlaybackFrameIndex;
+    uint32 PlaybackLoopCount;
+    uint32 PlaybackMismatchCount;
+};
+
+struct win32_game_code
+{
+    HMODULE GameCodeDLL;
+    FILETIME DLLLastWriteTime;
+
+    //NOTE: Never 0; this points at the stub whenever the DLL is missing or incomplete.
+    game_update_and_render *UpdateAndRender;
+
+    bool32 IsValid;
+};
+
+struct win32_window_dimension
+{
+    int Width;
+    int Height;
+};
+
+struct win32_sound_output
+{
+    int SamplesPerSecond;
+    int BytesPerSample;
+    int SecondaryBufferSize;
+
+    //NOTE: The frame loop fills the ring, the audio thread empties it into the secondary buffer. Nothing else touches
+    //  the secondary buffer once the audio thread is running.
+    sound_ring Ring;
+    sound_feed Feed;
+    HANDLE AudioThread;
+    uint32 volatile AudioThreadIsRunning;
+};
+
+struct win32_controller_input
+{
+    controller_poller *Poller;
+    HANDLE Thread;
+    uint32 volatile ThreadIsRunning;
+};
+
+//NOTE: Locking the secondary buffer hands back up to two regions, the second one only when the locked range wraps
+//  around the end of the ring buffer. Everything that writes into it goes through Win32LockSoundBuffer so that the
+//  wraparound is handled in one place.
+struct win32_sound_regions
+{
+    VOID *Region[2];
+    DWORD RegionSize[2];
+};
+
+struct platform_work_queue_entry
+{
+    platform_work_queue_callback *Callback;
+    void *Data;
+};
+
+struct platform_work_queue
+{
+    //NOTE: Single producer, many consumers. Only the thread that adds entries may call Win32CompleteAllWork.
+    uint32 volatile CompletionGoal;
+    uint32 volatile CompletionCount;
+
+    uint32 volatile NextEntryToWrite;
+    uint32 volatile NextEntryToRead;
+    HANDLE SemaphoreHandle;
+
+    int ThreadCount;
+    platform_work_queue_entry Entries[4096];
+};
+
+#endif